@@ -113,11 +113,20 @@ static std::string guishow_option = "guishow";
 static std::string nogui_option = "nogui";
 static std::string guiscale_option = "guiscale";
 static std::string privacynote_option = "privacynote";
+static std::string screenshot_threads_option = "screenshot-threads";
+static std::string screenshot_queue_option = "screenshot-queue";
+static std::string screenshot_compression_option = "screenshot-compression";
 static std::string versionnote_option = "versionnote";
 static std::string profile_log_option = "profiling-log";
 static std::string flush_frequency_option = "flush-frequency";
 static std::string profile_log_no_autostart_option = "pause-profiling";
 static std::string profile_log_include_events_option = "profiling-include-events";
+static std::string benchmark_option = "benchmark";
+static std::string benchmark_warmup_option = "benchmark-warmup";
+static std::string benchmark_frames_option = "benchmark-frames";
+static std::string benchmark_baseline_option = "benchmark-baseline";
+static std::string benchmark_threshold_option = "benchmark-threshold";
+static std::string benchmark_sweep_option = "benchmark-sweep";
 static std::string param_option = "param";
 static std::string remote_head_option = "headnode";
 static std::string remote_render_option = "rendernode";
@@ -168,6 +177,21 @@ static void privacynote_handler(
     config.screenshot_show_privacy_note = parsed_options[option_name].as<bool>();
 };
 
+static void screenshot_threads_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.screenshot_encoder_threads = parsed_options[option_name].as<unsigned int>();
+};
+
+static void screenshot_queue_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.screenshot_queue_size = parsed_options[option_name].as<unsigned int>();
+};
+
+static void screenshot_compression_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.screenshot_png_compression = parsed_options[option_name].as<int>();
+};
+
 static void versionnote_handler(
     std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
     config.show_version_note = parsed_options[option_name].as<bool>();
@@ -193,6 +217,44 @@ static void profile_log_include_events_handler(
     config.include_graph_events = parsed_options[option_name].as<bool>();
 }
 
+static void benchmark_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.benchmark_report_file = parsed_options[option_name].as<std::string>();
+}
+
+static void benchmark_warmup_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.benchmark_warmup_frames = parsed_options[option_name].as<uint32_t>();
+}
+
+static void benchmark_frames_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.benchmark_frames = parsed_options[option_name].as<uint32_t>();
+    if (config.benchmark_frames == 0) {
+        exit("benchmark-frames option needs at least one frame");
+    }
+}
+
+static void benchmark_baseline_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.benchmark_baseline_file = parsed_options[option_name].as<std::string>();
+}
+
+static void benchmark_threshold_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.benchmark_threshold = parsed_options[option_name].as<float>();
+}
+
+static void benchmark_sweep_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    for (auto const& sweep : parsed_options[option_name].as<std::vector<std::string>>()) {
+        if (sweep.find('=') == std::string::npos || sweep.front() == '=') {
+            exit("benchmark-sweep option needs to be in the following format: param=value1|value2|...");
+        }
+        config.benchmark_sweeps.push_back(sweep);
+    }
+}
+
 static void remote_head_handler(
     std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
     config.remote_headnode = parsed_options[option_name].as<bool>();
@@ -561,6 +623,13 @@ std::vector<OptionsListEntry> cli_options_list =
             cxxopts::value<float>(), guiscale_handler},
         {privacynote_option, "Show privacy note when taking screenshot, use '=false' to disable",
             cxxopts::value<bool>(), privacynote_handler},
+        {screenshot_threads_option,
+            "Number of threads encoding and writing screenshots, 0 writes them on the render thread, default: 2",
+            cxxopts::value<unsigned int>(), screenshot_threads_handler},
+        {screenshot_queue_option, "Number of screenshots waiting for encoding before rendering blocks, default: 4",
+            cxxopts::value<unsigned int>(), screenshot_queue_handler},
+        {screenshot_compression_option, "Compression level of PNG screenshots, 0 (none) to 9 (best), default: 1",
+            cxxopts::value<int>(), screenshot_compression_handler},
         {versionnote_option, "Show version warning when loading a project, use '=false' to disable",
             cxxopts::value<bool>(), versionnote_handler},
         {flush_frequency_option, "Flush logs (performance, power, ...) every that many frames",
@@ -572,7 +641,20 @@ std::vector<OptionsListEntry> cli_options_list =
         {profile_log_no_autostart_option, "Do not automatically start writing the profiling log",
             cxxopts::value<bool>(), profile_log_autostart_handler},
         {profile_log_include_events_option, "Include graph events in the profiling log", cxxopts::value<bool>(),
-            profile_log_include_events_handler}
+            profile_log_include_events_handler},
+        {benchmark_option,
+            "Run a headless benchmark after loading the project, write the report to file (.json or .csv) and quit",
+            cxxopts::value<std::string>(), benchmark_handler},
+        {benchmark_warmup_option, "Number of frames rendered before each benchmark run, default: 10",
+            cxxopts::value<uint32_t>(), benchmark_warmup_handler},
+        {benchmark_frames_option, "Number of frames measured per benchmark run, default: 100",
+            cxxopts::value<uint32_t>(), benchmark_frames_handler},
+        {benchmark_baseline_option, "Compare the benchmark to this JSON report and fail on regressions",
+            cxxopts::value<std::string>(), benchmark_baseline_handler},
+        {benchmark_threshold_option, "Relative slowdown counted as regression, default: 0.1 (10%)",
+            cxxopts::value<float>(), benchmark_threshold_handler},
+        {benchmark_sweep_option, "Benchmark each value of a parameter: --benchmark-sweep param=value1|value2|...",
+            cxxopts::value<std::vector<std::string>>(), benchmark_sweep_handler}
 
 #endif
         ,
@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <new>
+
 #include "CLIConfigParsing.h"
 #include "mmcore/LuaAPI.h"
 
@@ -48,6 +51,25 @@ static void log_error(std::string const& text) {
 
 void loadPlugins(megamol::frontend_resources::PluginsResource& pluginsRes);
 
+#ifdef MEGAMOL_USE_PROFILING
+// count the heap allocations for the benchmark reports
+void* operator new(std::size_t size) {
+    megamol::frontend::benchmark_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
 int main(const int argc, const char** argv) {
 #ifdef MEGAMOL_USE_TRACY
     ZoneScoped;
@@ -111,6 +133,9 @@ int main(const int argc, const char** argv) {
     megamol::frontend::Screenshot_Service screenshot_service;
     megamol::frontend::Screenshot_Service::Config screenshotConfig;
     screenshotConfig.show_privacy_note = config.screenshot_show_privacy_note;
+    screenshotConfig.encoder_threads = config.screenshot_encoder_threads;
+    screenshotConfig.queue_size = config.screenshot_queue_size;
+    screenshotConfig.png_compression_level = config.screenshot_png_compression;
     screenshot_service.setPriority(30);
 
     megamol::frontend::FrameStatistics_Service framestatistics_service;
@@ -170,6 +195,12 @@ int main(const int argc, const char** argv) {
     profiling_config.flush_frequency = config.flush_frequency;
     profiling_config.autostart_profiling = config.autostart_profiling;
     profiling_config.include_graph_events = config.include_graph_events;
+    profiling_config.benchmark_report_file = config.benchmark_report_file;
+    profiling_config.benchmark_warmup_frames = config.benchmark_warmup_frames;
+    profiling_config.benchmark_frames = config.benchmark_frames;
+    profiling_config.benchmark_baseline_file = config.benchmark_baseline_file;
+    profiling_config.benchmark_threshold = config.benchmark_threshold;
+    profiling_config.benchmark_sweeps = config.benchmark_sweeps;
 
 #ifdef MM_CUDA_ENABLED
     megamol::frontend::CUDA_Service cuda_service;
@@ -346,6 +377,17 @@ int main(const int argc, const char** argv) {
             }
         }
 
+#ifdef MEGAMOL_USE_PROFILING
+    // headless benchmark: render the configured runs, write the report and quit
+    if (run_megamol && !config.benchmark_report_file.empty()) {
+        if (!profiling_service.run_benchmark()) {
+            log_error("Benchmark failed or regressed");
+            ret += 16;
+        }
+        run_megamol = false;
+    }
+#endif
+
     while (run_megamol) {
 #ifdef MEGAMOL_USE_TRACY
         ZoneScopedNC("MainLoop", 0x0000FF);
@@ -225,9 +225,18 @@ public:
 
     void subscribe_to_updates(update_callback cb);
 
+    // called at the start of each frame on the render thread, e.g. to publish what worker threads measured.
+    // the manager is not thread-safe, worker threads must never call it directly
+    using frame_callback = std::function<void()>;
+    void subscribe_to_frame_start(void* owner, frame_callback cb);
+    void unsubscribe_from_frame_start(void* owner);
+
     void start_timer(handle_type h);
     void stop_timer(handle_type h);
 
+    // adds a region of a CPU timer that was measured elsewhere, e.g. on a worker thread, to the current frame
+    void add_region(handle_type h, time_point start, time_point end);
+
 private:
     friend class frontend::Profiling_Service;
 
@@ -244,6 +253,7 @@ private:
     // there can only be one PerformanceManager currently.
     inline static int64_t current_global_index = 0;
     std::vector<update_callback> subscribers;
+    std::vector<std::pair<void*, frame_callback>> frame_start_subscribers;
 
 #ifdef MEGAMOL_USE_OPENGL
     handle_type whole_frame_gl;
@@ -78,11 +78,20 @@ struct RuntimeConfig {
     bool gui_show = true;
     float gui_scale = 1.0f;
     bool screenshot_show_privacy_note = true;
+    unsigned int screenshot_encoder_threads = 2;
+    unsigned int screenshot_queue_size = 4;
+    int screenshot_png_compression = 1;
     bool show_version_note = true;
     std::string profiling_output_file;
     uint32_t flush_frequency = 1000;
     bool autostart_profiling = true;
     bool include_graph_events = false;
+    std::string benchmark_report_file;
+    uint32_t benchmark_warmup_frames = 10;
+    uint32_t benchmark_frames = 100;
+    std::string benchmark_baseline_file;
+    float benchmark_threshold = 0.1f;
+    std::vector<std::string> benchmark_sweeps;
 
     struct Tile {
         UintPair global_framebuffer_resolution; // e.g. whole powerwall resolution, needed for tiling
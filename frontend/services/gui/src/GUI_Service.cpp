@@ -8,6 +8,8 @@
 
 #include "GUI_Service.hpp"
 
+#include <future>
+
 #include "CommandRegistry.h"
 #include "FrameStatistics.h"
 #include "Framebuffer_Events.h"
@@ -54,7 +56,7 @@ bool GUI_Service::init(const Config& config) {
         "optional<MouseEvents>",                                        // 3 - mouse click
         "optional<OpenGL_Context>",                                     // 4 - graphics api for imgui context
         "FramebufferEvents",                                            // 5 - viewport size
-        "GLFrontbufferToPNG_ScreenshotTrigger",                         // 6 - trigger screenshot
+        "GLFrontbufferToPNG_AsyncScreenshotTrigger",                    // 6 - trigger screenshot
         "LuaScriptPaths",                                               // 7 - current project path
         "ProjectLoader",                                                // 8 - trigger loading of new running project
         "FrameStatistics",                                              // 9 - current fps and ms value
@@ -235,7 +237,9 @@ void GUI_Service::digestChangedRequestedResources() {
 
     /// Trigger Screenshot = resource index 6
     if (this->m_gui->GetTriggeredScreenshot()) {
-        auto& screenshot_to_file_trigger = frontend_resources->get<std::function<bool(std::filesystem::path const&)>>();
+        // the gui keeps running while the file is written, failures are logged by the screenshot service
+        auto& screenshot_to_file_trigger =
+            frontend_resources->get<std::function<std::future<bool>(std::filesystem::path const&)>>();
         screenshot_to_file_trigger(this->m_gui->GetScreenshotFileName());
     }
 
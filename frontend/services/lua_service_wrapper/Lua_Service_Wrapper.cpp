@@ -273,8 +273,10 @@ void Lua_Service_Wrapper::fill_frontend_resources_callbacks(void* callbacks_coll
     callbacks.add<VoidResult, std::string>("mmScreenshot",
         "(string filename)\n\tSave a screen shot of the GL front buffer under 'filename'.",
         {[&](std::string file) -> VoidResult {
-            m_requestedResourceReferences[1].getResource<std::function<bool(std::filesystem::path const&)>>()(
-                std::filesystem::u8path(file));
+            if (!m_requestedResourceReferences[1].getResource<std::function<bool(std::filesystem::path const&)>>()(
+                    std::filesystem::u8path(file))) {
+                return Error{"error writing screenshot into file " + file};
+            }
             return VoidResult{};
         }});
 
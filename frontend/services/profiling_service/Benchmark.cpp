@@ -0,0 +1,368 @@
+/*
+ * Benchmark.cpp
+ *
+ * Copyright (C) 2024 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include "mmcore/utility/buildinfo/BuildInfo.h"
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h needs to be included first
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace megamol::frontend {
+
+std::atomic<uint64_t> benchmark_heap_allocations{0};
+
+namespace {
+
+using PerformanceManager = frontend_resources::PerformanceManager;
+
+/** The version of the report layout */
+constexpr int report_version = 1;
+
+/** Differences of medians below this many milliseconds are noise, not regressions */
+constexpr double regression_noise_ms = 0.01;
+
+/** Answer the percentile 'q' of 'sorted' by the nearest-rank method */
+double percentile(std::vector<double> const& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/** Answer the module called by the call "::caller::slot->::callee::slot" */
+std::string callee_module(std::string const& call) {
+    const auto arrow = call.find("->");
+    if (arrow == std::string::npos) {
+        return "";
+    }
+    const auto slot = call.rfind("::");
+    if ((slot == std::string::npos) || (slot <= arrow)) {
+        return "";
+    }
+    return call.substr(arrow + 2, slot - arrow - 2);
+}
+
+double milliseconds(PerformanceManager::time_point const& duration) {
+    return std::chrono::duration<double, std::milli>(duration.time_since_epoch()).count();
+}
+
+std::string describe(std::string const& run, std::string const& what, double baseline, double current) {
+    std::ostringstream str;
+    str << run << ": " << what << " regressed from " << baseline << " to " << current << " ("
+        << (baseline > 0.0 ? (current / baseline - 1.0) * 100.0 : 100.0) << "%)";
+    return str.str();
+}
+
+} // namespace
+
+
+/*
+ * benchmark_peak_rss
+ */
+uint64_t benchmark_peak_rss() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+
+void BenchmarkRecorder::begin_run(std::string const& label, uint32_t warmup_frames,
+    std::optional<PerformanceManager::frame_type> last_warmup_frame) {
+    current_run = Run();
+    current_run.label = label;
+    current_run.warmup_frames = warmup_frames;
+    current_samples.clear();
+    timer_info.clear();
+    first_excluded_frame = last_warmup_frame;
+    last_frame.reset();
+    received_frame.reset();
+    is_recording = true;
+}
+
+void BenchmarkRecorder::end_frames(PerformanceManager::frame_type frame) {
+    last_frame = frame;
+}
+
+BenchmarkRecorder::Samples& BenchmarkRecorder::samples(Key const& key) {
+    return current_samples[key];
+}
+
+void BenchmarkRecorder::add_frame(
+    PerformanceManager::frame_info const& frame, PerformanceManager& perf_man) {
+    if (!is_recording || (first_excluded_frame.has_value() && (frame.frame <= *first_excluded_frame)) ||
+        (last_frame.has_value() && (frame.frame > *last_frame))) {
+        return;
+    }
+    received_frame = frame.frame;
+
+    std::vector<Samples*> touched;
+    const auto add = [&touched](Samples& s, double ms) {
+        if (!s.touched) {
+            s.touched = true;
+            touched.push_back(&s);
+        }
+        s.current += ms;
+        ++s.calls;
+    };
+
+    // the calls still running when the next one starts, per api, for the self time of the modules
+    struct OpenCall {
+        PerformanceManager::time_point end;
+        Samples* module;
+    };
+    std::map<PerformanceManager::query_api, std::vector<OpenCall>> open_calls;
+
+    // the entries are ordered by their start
+    for (auto const& e : frame.entries) {
+        auto info = timer_info.find(e.handle);
+        if (info == timer_info.end()) {
+            auto const conf = perf_man.lookup_config(e.handle);
+            auto const api = PerformanceManager::query_api_string(conf.api);
+            TimerInfo ti;
+            switch (conf.parent_type) {
+            case PerformanceManager::parent_type::CALL: {
+                auto const call = PerformanceManager::parent_name(conf);
+                ti.key = Key{"call", call + "::" + conf.name, api};
+                ti.module = callee_module(call);
+            } break;
+            case PerformanceManager::parent_type::USER_REGION:
+                ti.key = Key{"region", PerformanceManager::parent_name(conf) + "::" + conf.name, api};
+                break;
+            default:
+                ti.key = Key{"builtin", conf.name, api};
+                break;
+            }
+            info = timer_info.emplace(e.handle, std::move(ti)).first;
+        }
+
+        const double ms = milliseconds(e.duration);
+        add(samples(info->second.key), ms);
+
+        if (!info->second.module.empty()) {
+            auto& module = samples(Key{"module", info->second.module, std::get<2>(info->second.key)});
+            add(module, ms);
+            auto& stack = open_calls[e.api];
+            while (!stack.empty() && (stack.back().end <= e.start)) {
+                stack.pop_back();
+            }
+            if (!stack.empty() && (e.end <= stack.back().end)) {
+                // the enclosing call is charged without this one
+                stack.back().module->current -= ms;
+            }
+            stack.push_back(OpenCall{e.end, &module});
+        }
+    }
+
+    for (auto* s : touched) {
+        s->frame_sums.push_back(s->current);
+        s->current = 0.0;
+        s->touched = false;
+    }
+}
+
+void BenchmarkRecorder::add_frame_time(double milliseconds) {
+    if (!is_recording) {
+        return;
+    }
+    auto& s = samples(Key{"frame", "FrameTime", "CPU"});
+    s.frame_sums.push_back(milliseconds);
+    ++s.calls;
+    ++current_run.frames;
+}
+
+void BenchmarkRecorder::end_run(uint64_t heap_allocations, uint64_t peak_rss_bytes) {
+    if (!is_recording) {
+        return;
+    }
+    is_recording = false;
+    current_run.heap_allocations = heap_allocations;
+    current_run.peak_rss_bytes = peak_rss_bytes;
+
+    for (auto& [key, s] : current_samples) {
+        if (s.frame_sums.empty()) {
+            continue;
+        }
+        std::sort(s.frame_sums.begin(), s.frame_sums.end());
+        Entry e;
+        std::tie(e.kind, e.name, e.api) = key;
+        e.samples = s.frame_sums.size();
+        e.calls = s.calls;
+        double sum = 0.0;
+        for (auto const v : s.frame_sums) {
+            sum += v;
+        }
+        e.mean = sum / static_cast<double>(s.frame_sums.size());
+        e.min = s.frame_sums.front();
+        e.p50 = percentile(s.frame_sums, 0.5);
+        e.p90 = percentile(s.frame_sums, 0.9);
+        e.p99 = percentile(s.frame_sums, 0.99);
+        e.max = s.frame_sums.back();
+        current_run.entries.push_back(std::move(e));
+    }
+    current_samples.clear();
+    timer_info.clear();
+
+    finished_runs.push_back(std::move(current_run));
+    current_run = Run();
+}
+
+bool BenchmarkRecorder::compare(std::string const& baseline_file, double threshold,
+    std::vector<std::string>& regressions, std::string& error) const {
+    nlohmann::json baseline;
+    try {
+        std::ifstream in(baseline_file);
+        if (!in.is_open()) {
+            error = "cannot open baseline " + baseline_file;
+            return false;
+        }
+        in >> baseline;
+    } catch (nlohmann::json::exception const& ex) {
+        error = "baseline " + baseline_file + " is no JSON benchmark report: " + ex.what();
+        return false;
+    }
+    if (!baseline.contains("runs") || !baseline["runs"].is_array()) {
+        error = "baseline " + baseline_file + " is no JSON benchmark report";
+        return false;
+    }
+
+    const auto regressed = [threshold](double base, double current, double noise) {
+        return (current > base * (1.0 + threshold)) && (current - base > noise);
+    };
+
+    for (auto const& run : finished_runs) {
+        auto const base_run = std::find_if(baseline["runs"].begin(), baseline["runs"].end(),
+            [&run](nlohmann::json const& r) { return r.value("label", "") == run.label; });
+        if (base_run == baseline["runs"].end()) {
+            continue;
+        }
+
+        const double frames = std::max<double>(run.frames, 1.0);
+        const double base_frames = std::max<double>(base_run->value("frames", 1.0), 1.0);
+        const double allocs = static_cast<double>(run.heap_allocations) / frames;
+        const double base_allocs = base_run->value("heap_allocations", 0.0) / base_frames;
+        if ((run.heap_allocations > 0) && regressed(base_allocs, allocs, 1.0)) {
+            regressions.push_back(describe(run.label, "heap allocations per frame", base_allocs, allocs));
+        }
+        const double base_rss = base_run->value("peak_rss_bytes", 0.0);
+        if ((base_rss > 0.0) && regressed(base_rss, static_cast<double>(run.peak_rss_bytes), 0.0)) {
+            regressions.push_back(
+                describe(run.label, "peak RSS (bytes)", base_rss, static_cast<double>(run.peak_rss_bytes)));
+        }
+
+        if (!base_run->contains("entries")) {
+            continue;
+        }
+        for (auto const& e : run.entries) {
+            if ((e.kind != "frame") && (e.kind != "call") && (e.kind != "module")) {
+                continue;
+            }
+            for (auto const& b : (*base_run)["entries"]) {
+                if ((b.value("kind", "") == e.kind) && (b.value("name", "") == e.name) &&
+                    (b.value("api", "") == e.api)) {
+                    const double base_p50 = b.value("p50_ms", 0.0);
+                    if (regressed(base_p50, e.p50, regression_noise_ms)) {
+                        regressions.push_back(
+                            describe(run.label, e.kind + " " + e.name + " (" + e.api + ") median ms", base_p50, e.p50));
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool BenchmarkRecorder::write_report(
+    std::string const& file, std::vector<std::string> const& regressions, std::string& error) const {
+    std::ofstream out(file, std::ofstream::trunc);
+    if (!out.is_open()) {
+        error = "cannot write benchmark report " + file;
+        return false;
+    }
+
+    auto extension = std::filesystem::path(file).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".csv") {
+        // the same separator as the profiling log
+        out << "run;kind;name;api;samples;calls;mean (ms);min (ms);p50 (ms);p90 (ms);p99 (ms);max (ms);"
+               "frames;heap allocations;peak rss (bytes)"
+            << std::endl;
+        for (auto const& run : finished_runs) {
+            for (auto const& e : run.entries) {
+                out << run.label << ";" << e.kind << ";" << e.name << ";" << e.api << ";" << e.samples << ";"
+                    << e.calls << ";" << e.mean << ";" << e.min << ";" << e.p50 << ";" << e.p90 << ";" << e.p99
+                    << ";" << e.max << ";" << run.frames << ";" << run.heap_allocations << ";"
+                    << run.peak_rss_bytes << std::endl;
+            }
+        }
+        for (auto const& r : regressions) {
+            out << "# regression: " << r << std::endl;
+        }
+    } else {
+        nlohmann::json report;
+        report["version"] = report_version;
+        report["megamol_git_hash"] = megamol::core::utility::buildinfo::MEGAMOL_GIT_HASH();
+        report["runs"] = nlohmann::json::array();
+        for (auto const& run : finished_runs) {
+            nlohmann::json r;
+            r["label"] = run.label;
+            r["warmup_frames"] = run.warmup_frames;
+            r["frames"] = run.frames;
+            r["heap_allocations"] = run.heap_allocations;
+            r["peak_rss_bytes"] = run.peak_rss_bytes;
+            r["entries"] = nlohmann::json::array();
+            for (auto const& e : run.entries) {
+                r["entries"].push_back({{"kind", e.kind}, {"name", e.name}, {"api", e.api}, {"samples", e.samples},
+                    {"calls", e.calls}, {"mean_ms", e.mean}, {"min_ms", e.min}, {"p50_ms", e.p50}, {"p90_ms", e.p90},
+                    {"p99_ms", e.p99}, {"max_ms", e.max}});
+            }
+            report["runs"].push_back(std::move(r));
+        }
+        report["regressions"] = regressions;
+        out << report.dump(2) << std::endl;
+    }
+
+    if (!out) {
+        error = "cannot write benchmark report " + file;
+        return false;
+    }
+    return true;
+}
+
+} // namespace megamol::frontend
@@ -0,0 +1,172 @@
+/*
+ * Benchmark.hpp
+ *
+ * Copyright (C) 2024 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "PerformanceManager.h"
+
+namespace megamol::frontend {
+
+/**
+ * Counts the C++ heap allocations of the process. Only the executables that
+ * replace the global operator new increment it, i.e. it stays 0 otherwise.
+ */
+extern std::atomic<uint64_t> benchmark_heap_allocations;
+
+/**
+ * Answer the peak resident set size of the process in bytes, or 0 if unknown.
+ * This is the maximum over the lifetime of the process, not over a run.
+ */
+uint64_t benchmark_peak_rss();
+
+/**
+ * Collects the timings of benchmark runs and writes them as reports.
+ *
+ * A run is a number of measured frames rendered with one configuration. Per
+ * frame, the durations of each call callback, of each module and of the frame
+ * are summed up, the statistics of a run are taken over these frame sums. A
+ * module is charged the self time of the calls into it, i.e. without the
+ * calls it issues itself.
+ */
+class BenchmarkRecorder {
+public:
+    /** The statistics of one timed entity over the frames of a run, all times in milliseconds */
+    struct Entry {
+        /** "frame", "builtin", "call", "module" or "region" */
+        std::string kind;
+        std::string name;
+        std::string api;
+        /** The number of frames the entity was timed in */
+        uint64_t samples = 0;
+        /** The number of times it was timed */
+        uint64_t calls = 0;
+        double mean = 0.0;
+        double min = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    struct Run {
+        std::string label;
+        uint32_t warmup_frames = 0;
+        uint32_t frames = 0;
+        uint64_t heap_allocations = 0;
+        /** The peak RSS of the process up to the end of the run, i.e. including the runs before */
+        uint64_t peak_rss_bytes = 0;
+        std::vector<Entry> entries;
+    };
+
+    /**
+     * Starts recording the run 'label'. The timers of the frames up to and
+     * including 'last_warmup_frame' are ignored.
+     */
+    void begin_run(std::string const& label, uint32_t warmup_frames,
+        std::optional<frontend_resources::PerformanceManager::frame_type> last_warmup_frame);
+
+    /**
+     * Ignores the timers of the frames after 'frame', the last measured one.
+     */
+    void end_frames(frontend_resources::PerformanceManager::frame_type frame);
+
+    /**
+     * Answer whether the timers of the last measured frame have arrived.
+     */
+    bool frames_complete() const {
+        return last_frame.has_value() && received_frame.has_value() && (*received_frame >= *last_frame);
+    }
+
+    /**
+     * Adds the timers of a frame to the current run, unless it is a warmup
+     * frame or follows the measured frames.
+     */
+    void add_frame(frontend_resources::PerformanceManager::frame_info const& frame,
+        frontend_resources::PerformanceManager& perf_man);
+
+    /**
+     * Adds the wall-clock time of a frame to the current run.
+     */
+    void add_frame_time(double milliseconds);
+
+    /**
+     * Finishes the current run and computes its statistics.
+     */
+    void end_run(uint64_t heap_allocations, uint64_t peak_rss_bytes);
+
+    bool recording() const {
+        return is_recording;
+    }
+
+    std::vector<Run> const& runs() const {
+        return finished_runs;
+    }
+
+    void clear() {
+        finished_runs.clear();
+    }
+
+    /**
+     * Compares the runs to those of the same label in the JSON report
+     * 'baseline_file'. Frame, call and module medians as well as allocations
+     * per frame and peak RSS regress if they exceed the baseline by more than
+     * 'threshold', e.g. 0.1 for 10%.
+     *
+     * @param regressions Receives a description of each regression.
+     *
+     * @return 'true' if the baseline could be read, 'false' otherwise.
+     */
+    bool compare(std::string const& baseline_file, double threshold, std::vector<std::string>& regressions,
+        std::string& error) const;
+
+    /**
+     * Writes the runs and 'regressions' to 'file', as CSV if its extension is
+     * ".csv" and as JSON otherwise.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool write_report(
+        std::string const& file, std::vector<std::string> const& regressions, std::string& error) const;
+
+private:
+    using Key = std::tuple<std::string, std::string, std::string>;
+
+    struct Samples {
+        std::vector<double> frame_sums;
+        uint64_t calls = 0;
+        double current = 0.0;
+        bool touched = false;
+    };
+
+    /** The report key of each timer, looked up once per run as the lookups are not for free */
+    struct TimerInfo {
+        Key key;
+        std::string module;
+    };
+
+    Samples& samples(Key const& key);
+
+    bool is_recording = false;
+    std::optional<frontend_resources::PerformanceManager::frame_type> first_excluded_frame;
+    std::optional<frontend_resources::PerformanceManager::frame_type> last_frame;
+    std::optional<frontend_resources::PerformanceManager::frame_type> received_frame;
+    Run current_run;
+    std::map<Key, Samples> current_samples;
+    std::unordered_map<frontend_resources::PerformanceManager::handle_type, TimerInfo> timer_info;
+    std::vector<Run> finished_runs;
+};
+
+} // namespace megamol::frontend
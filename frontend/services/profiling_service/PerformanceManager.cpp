@@ -2,6 +2,7 @@
 
 #include "mmcore/Call.h"
 #include "mmcore/Module.h"
+#include <algorithm>
 #include <array>
 
 #ifdef MEGAMOL_USE_OPENGL
@@ -245,6 +246,29 @@ void PerformanceManager::subscribe_to_updates(update_callback cb) {
     subscribers.push_back(cb);
 }
 
+void PerformanceManager::subscribe_to_frame_start(void* owner, frame_callback cb) {
+    frame_start_subscribers.emplace_back(owner, std::move(cb));
+}
+
+void PerformanceManager::unsubscribe_from_frame_start(void* owner) {
+    frame_start_subscribers.erase(std::remove_if(frame_start_subscribers.begin(), frame_start_subscribers.end(),
+                                      [owner](auto const& s) { return s.first == owner; }),
+        frame_start_subscribers.end());
+}
+
+void PerformanceManager::add_region(handle_type h, time_point start, time_point end) {
+    const auto it = timers.find(h);
+    if (it == timers.end() || it->second->get_conf().api != query_api::CPU) {
+        core::utility::log::Log::DefaultLog.WriteError("PerformanceManager: cannot find CPU timer with handle %u", h);
+        return;
+    }
+    auto& timer = *it->second;
+    timer.start(current_frame);
+    timer.end();
+    timer.regions.back().start = start;
+    timer.regions.back().end = end;
+}
+
 void PerformanceManager::start_timer(handle_type h) {
     timers[h]->start(current_frame);
 }
@@ -277,6 +301,9 @@ void PerformanceManager::startFrame(frame_type frame) {
 #ifdef MEGAMOL_USE_OPENGL
     start_timer(whole_frame_gl);
 #endif
+    for (auto& [owner, cb] : frame_start_subscribers) {
+        cb();
+    }
 }
 
 void PerformanceManager::endFrame() {
@@ -1,6 +1,9 @@
 #include "Profiling_Service.hpp"
 
+#include <chrono>
+
 #include "mmcore/MegaMolGraph.h"
+#include "mmcore/utility/log/Log.h"
 #include "mmcore/utility/SampleCameraScenes.h"
 #include "mmcore/view/AbstractViewInterface.h"
 #include "mmcore/view/CameraSerializer.h"
@@ -23,6 +26,7 @@ bool Profiling_Service::init(void* configPtr) {
     const auto conf = static_cast<Config*>(configPtr);
     profiling_logging.active = conf->autostart_profiling;
     include_graph_events = conf->include_graph_events;
+    benchmark_config = *conf;
 
     const auto unit_name = "ns";
     using timer_ratio = std::nano;
@@ -75,6 +79,12 @@ bool Profiling_Service::init(void* configPtr) {
             }
         });
     }
+
+    _perf_man.subscribe_to_updates([&](const frontend_resources::PerformanceManager::frame_info& fi) {
+        if (benchmark.recording()) {
+            benchmark.add_frame(fi, _perf_man);
+        }
+    });
 #endif
 
     _requestedResourcesNames = {"RegisterLuaCallbacks", frontend_resources::MegaMolGraph_Req_Name, "RenderNextFrame",
@@ -177,6 +187,143 @@ void Profiling_Service::close() {
 #endif
 }
 
+bool Profiling_Service::benchmark_run(
+    std::string const& label, uint32_t warmup_frames, uint32_t frames, std::string& error) {
+#ifdef MEGAMOL_USE_PROFILING
+    if (frames == 0) {
+        error = "a benchmark run needs at least one frame";
+        return false;
+    }
+    auto& render_next_frame = _requestedResourcesReferences[2].getResource<std::function<bool()>>();
+
+    for (uint32_t f = 0; f < warmup_frames; ++f) {
+        if (!render_next_frame()) {
+            error = "MegaMol shut down during the warmup of " + label;
+            return false;
+        }
+    }
+
+    // the timers are filtered by frame number, i.e. the run records neither the timers of the warmup frames nor
+    // those of the frames rendered to drain the timers that arrive with a delay
+    benchmark.begin_run(label, warmup_frames,
+        frame_started ? std::optional<frontend_resources::PerformanceManager::frame_type>(_perf_man.current_frame)
+                      : std::nullopt);
+    const auto allocations_start = benchmark_heap_allocations.load(std::memory_order_relaxed);
+    bool running = true;
+    for (uint32_t f = 0; (f < frames) && running; ++f) {
+        const auto start = std::chrono::steady_clock::now();
+        running = render_next_frame();
+        benchmark.add_frame_time(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    const auto allocations_end = benchmark_heap_allocations.load(std::memory_order_relaxed);
+    benchmark.end_frames(_perf_man.current_frame);
+    for (uint32_t f = 0; running && !benchmark.frames_complete() && (f < max_drain_frames); ++f) {
+        running = render_next_frame();
+    }
+    if (running && !benchmark.frames_complete()) {
+        core::utility::log::Log::DefaultLog.WriteWarn(
+            "Benchmark: the timers of the last frames of %s did not arrive", label.c_str());
+    }
+    benchmark.end_run(allocations_end - allocations_start, benchmark_peak_rss());
+
+    if (!running) {
+        error = "MegaMol shut down during " + label;
+        return false;
+    }
+    return true;
+#else
+    error = "benchmarks need MegaMol to be built with MEGAMOL_USE_PROFILING";
+    return false;
+#endif
+}
+
+bool Profiling_Service::benchmark_report(std::string const& file, std::string const& baseline_file, double threshold,
+    std::vector<std::string>& regressions, std::string& error) {
+    regressions.clear();
+    if (!baseline_file.empty() && !benchmark.compare(baseline_file, threshold, regressions, error)) {
+        return false;
+    }
+    return benchmark.write_report(file, regressions, error);
+}
+
+bool Profiling_Service::run_benchmark() {
+    auto& graph = const_cast<core::MegaMolGraph&>(_requestedResourcesReferences[1].getResource<core::MegaMolGraph>());
+    auto const& conf = benchmark_config;
+
+    // the parameter sweeps as pairs of name and values
+    std::vector<std::pair<std::string, std::vector<std::string>>> sweeps;
+    for (auto const& sweep : conf.benchmark_sweeps) {
+        const auto eq = sweep.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            core::utility::log::Log::DefaultLog.WriteError(
+                "Benchmark: invalid sweep \"%s\", expected \"param=value1|value2|...\"", sweep.c_str());
+            return false;
+        }
+        std::vector<std::string> values;
+        size_t pos = eq + 1;
+        while (true) {
+            const auto bar = sweep.find('|', pos);
+            values.push_back(sweep.substr(pos, bar == std::string::npos ? std::string::npos : bar - pos));
+            if (bar == std::string::npos) {
+                break;
+            }
+            pos = bar + 1;
+        }
+        sweeps.emplace_back(sweep.substr(0, eq), std::move(values));
+    }
+
+    benchmark.clear();
+    std::vector<size_t> choice(sweeps.size(), 0);
+    bool done = false;
+    while (!done) {
+        std::string label;
+        for (size_t i = 0; i < sweeps.size(); ++i) {
+            auto const& [param, values] = sweeps[i];
+            if (!graph.SetParameter(param, values[choice[i]])) {
+                core::utility::log::Log::DefaultLog.WriteError(
+                    "Benchmark: could not set parameter %s to \"%s\"", param.c_str(), values[choice[i]].c_str());
+                return false;
+            }
+            label += (label.empty() ? "" : ",") + param + "=" + values[choice[i]];
+        }
+        if (label.empty()) {
+            label = "default";
+        }
+
+        core::utility::log::Log::DefaultLog.WriteInfo("Benchmark: running %s", label.c_str());
+        std::string error;
+        if (!benchmark_run(label, conf.benchmark_warmup_frames, conf.benchmark_frames, error)) {
+            core::utility::log::Log::DefaultLog.WriteError("Benchmark: %s", error.c_str());
+            return false;
+        }
+
+        // next combination, the last sweep varies fastest
+        done = true;
+        for (size_t i = sweeps.size(); i-- > 0;) {
+            if (++choice[i] < sweeps[i].second.size()) {
+                done = false;
+                break;
+            }
+            choice[i] = 0;
+        }
+    }
+
+    std::vector<std::string> regressions;
+    std::string error;
+    if (!benchmark_report(
+            conf.benchmark_report_file, conf.benchmark_baseline_file, conf.benchmark_threshold, regressions, error)) {
+        core::utility::log::Log::DefaultLog.WriteError("Benchmark: %s", error.c_str());
+        return false;
+    }
+    for (auto const& r : regressions) {
+        core::utility::log::Log::DefaultLog.WriteError("Benchmark: %s", r.c_str());
+    }
+    core::utility::log::Log::DefaultLog.WriteInfo("Benchmark: wrote %zu runs to %s, %zu regressions",
+        benchmark.runs().size(), conf.benchmark_report_file.c_str(), regressions.size());
+    return regressions.empty();
+}
+
 static const char* const sl_innerframe = "InnerFrame";
 
 void Profiling_Service::updateProvidedResources() {
@@ -185,6 +332,7 @@ void Profiling_Service::updateProvidedResources() {
 #endif
     _perf_man.startFrame(
         _requestedResourcesReferences[4].getResource<frontend_resources::FrameStatistics>().rendered_frames_count);
+    frame_started = true;
 }
 
 void Profiling_Service::resetProvidedResources() {
@@ -276,6 +424,43 @@ void Profiling_Service::fill_lua_callbacks() {
             return frontend_resources::LuaCallbacksCollection::StringResult{sstr.str()};
         }});
 
+    callbacks.add<frontend_resources::LuaCallbacksCollection::VoidResult, std::string, int, int>("mmBenchmark",
+        "(string label, unsigned int warmup_frames, unsigned int frames)",
+        {[&](std::string label, int warmup_frames,
+             int frames) -> frontend_resources::LuaCallbacksCollection::VoidResult {
+            if (warmup_frames < 0 || frames <= 0)
+                return frontend_resources::LuaCallbacksCollection::Error{"invalid number of frames"};
+            std::string error;
+            if (!benchmark_run(label, warmup_frames, frames, error))
+                return frontend_resources::LuaCallbacksCollection::Error{error};
+            return frontend_resources::LuaCallbacksCollection::VoidResult{};
+        }});
+
+    callbacks.add<frontend_resources::LuaCallbacksCollection::StringResult, std::string, std::string, float>(
+        "mmWriteBenchmarkReport", "(string file, string baseline_file, float threshold)",
+        {[&](std::string file, std::string baseline_file,
+             float threshold) -> frontend_resources::LuaCallbacksCollection::StringResult {
+            std::vector<std::string> regressions;
+            std::string error;
+            if (!benchmark_report(file, baseline_file, threshold, regressions, error))
+                return frontend_resources::LuaCallbacksCollection::Error{error};
+            if (!regressions.empty()) {
+                std::string message = std::to_string(regressions.size()) + " regressions";
+                for (auto const& r : regressions) {
+                    message += "\n" + r;
+                }
+                return frontend_resources::LuaCallbacksCollection::Error{message};
+            }
+            return frontend_resources::LuaCallbacksCollection::StringResult{
+                std::to_string(benchmark.runs().size()) + " runs written to " + file};
+        }});
+
+    callbacks.add<frontend_resources::LuaCallbacksCollection::VoidResult>(
+        "mmClearBenchmark", "()", {[&]() -> frontend_resources::LuaCallbacksCollection::VoidResult {
+            benchmark.clear();
+            return frontend_resources::LuaCallbacksCollection::VoidResult{};
+        }});
+
 
     auto& register_callbacks =
         _requestedResourcesReferences[0]
@@ -11,6 +11,7 @@
 #include <sstream>
 
 #include "AbstractFrontendService.hpp"
+#include "Benchmark.hpp"
 #include "FrameStatistics.h"
 #include "PerformanceManager.h"
 
@@ -23,6 +24,14 @@ public:
         uint32_t flush_frequency;
         bool autostart_profiling;
         bool include_graph_events;
+        /** Run the benchmark after loading the project and write the report here */
+        std::string benchmark_report_file;
+        uint32_t benchmark_warmup_frames = 10;
+        uint32_t benchmark_frames = 100;
+        std::string benchmark_baseline_file;
+        float benchmark_threshold = 0.1f;
+        /** Each entry sweeps a parameter, "param=value1|value2|...", the runs cover all combinations */
+        std::vector<std::string> benchmark_sweeps;
     };
 
     std::string serviceName() const override {
@@ -45,10 +54,25 @@ public:
     }
     void setRequestedResources(std::vector<FrontendResource> resources) override;
 
+    /**
+     * Runs the benchmark configured in the Config, writes its report and
+     * compares it to the baseline.
+     *
+     * @return 'true' on success, 'false' on errors or regressions.
+     */
+    bool run_benchmark();
+
 private:
     void fill_lua_callbacks();
     void log_graph_event(std::string const& parent, std::string const& name, std::string const& comment);
 
+    /** Renders 'warmup_frames' frames and records the next 'frames' frames as the run 'label'. */
+    bool benchmark_run(std::string const& label, uint32_t warmup_frames, uint32_t frames, std::string& error);
+
+    /** Writes the recorded runs to 'file' and compares them to 'baseline_file' if it is not empty. */
+    bool benchmark_report(std::string const& file, std::string const& baseline_file, double threshold,
+        std::vector<std::string>& regressions, std::string& error);
+
     std::vector<FrontendResource> _providedResourceReferences;
     std::vector<std::string> _requestedResourcesNames;
     std::vector<FrontendResource> _requestedResourcesReferences;
@@ -59,6 +83,12 @@ private:
     std::stringstream log_buffer;
     bool include_graph_events = false;
     frontend_resources::ProfilingLoggingStatus profiling_logging;
+    Config benchmark_config;
+    BenchmarkRecorder benchmark;
+    /** Whether any frame has been started yet, i.e. whether the current frame of the PerformanceManager is valid */
+    bool frame_started = false;
+    /** The most frames rendered after a benchmark run to wait for the timers of its last frames */
+    static constexpr uint32_t max_drain_frames = 16;
 };
 
 } // namespace megamol::frontend
@@ -7,6 +7,11 @@
 
 #include "Screenshot_Service.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+
 #include "GUIState.h"
 #include "OpenGL_Context.h"
 
@@ -18,7 +23,6 @@
 // to write png files
 #include "mmcore/utility/graphics/ScreenShotComments.h"
 #include "png.h"
-#include "vislib/sys/FastFile.h"
 #include "zlib.h"
 
 #include "mmcore/utility/log/Log.h"
@@ -66,27 +70,54 @@ static void PNGAPI pngWarnFunc(png_structp pngPtr, png_const_charp msg) {
 }
 
 static void PNGAPI pngWriteFileFunc(png_structp pngPtr, png_bytep buf, png_size_t size) {
-    vislib::sys::File* f = static_cast<vislib::sys::File*>(png_get_io_ptr(pngPtr));
-    f->Write(buf, size);
+    std::ofstream* f = static_cast<std::ofstream*>(png_get_io_ptr(pngPtr));
+    f->write(reinterpret_cast<const char*>(buf), size);
 }
 
 static void PNGAPI pngFlushFileFunc(png_structp pngPtr) {
-    vislib::sys::File* f = static_cast<vislib::sys::File*>(png_get_io_ptr(pngPtr));
-    f->Flush();
+    std::ofstream* f = static_cast<std::ofstream*>(png_get_io_ptr(pngPtr));
+    f->flush();
 }
 
-static bool write_png_to_file(
-    megamol::frontend_resources::ScreenshotImageData const& image, std::filesystem::path const& filename) {
-    vislib::sys::FastFile file;
-    try {
-        // open final image file
-        if (!file.Open(filename.native().c_str(), vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE,
-                vislib::sys::File::CREATE_OVERWRITE)) {
-            log("Cannot open output file" + filename.generic_u8string());
-            return false;
-        }
-    } catch (...) {
-        log("Error/Exception opening output file" + filename.generic_u8string());
+static int png_compression_level = Z_BEST_SPEED;
+
+enum class ImageFileFormat { PNG, PPM, QOI, RAW };
+
+// the format is chosen by the file extension, everything unknown is written as PNG
+static ImageFileFormat image_file_format(std::filesystem::path const& filename) {
+    std::string ext = filename.extension().generic_u8string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (ext == ".ppm")
+        return ImageFileFormat::PPM;
+    if (ext == ".qoi")
+        return ImageFileFormat::QOI;
+    if (ext == ".raw")
+        return ImageFileFormat::RAW;
+    return ImageFileFormat::PNG;
+}
+
+static std::string serialize_project() {
+    // todo: camera settings are not stored without magic knowledge about the view
+    std::string project = megamolgraph_ptr->Convenience().SerializeGraph();
+    if (guistate_resources_ptr) {
+        project.append(guistate_resources_ptr->request_gui_state(true));
+    }
+    return project;
+}
+
+static bool open_output_file(std::ofstream& file, std::filesystem::path const& filename) {
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        log_error("Cannot open output file " + filename.generic_u8string());
+        return false;
+    }
+    return true;
+}
+
+static bool write_png_to_file(megamol::frontend_resources::ScreenshotImageData const& image,
+    std::string const& project, std::filesystem::path const& filename) {
+    std::ofstream file;
+    if (!open_output_file(file, filename)) {
         return false;
     }
 
@@ -99,18 +130,14 @@ static bool write_png_to_file(
     png_infop pngInfoPtr = png_create_info_struct(pngPtr);
     if (!pngInfoPtr) {
         log("Cannot create png info");
+        png_destroy_write_struct(&pngPtr, nullptr);
         return false;
     }
 
     png_set_write_fn(pngPtr, static_cast<void*>(&file), &pngWriteFileFunc, &pngFlushFileFunc);
 
-    png_set_compression_level(pngPtr, Z_BEST_SPEED);
+    png_set_compression_level(pngPtr, png_compression_level);
 
-    // todo: camera settings are not stored without magic knowledge about the view
-    std::string project = megamolgraph_ptr->Convenience().SerializeGraph();
-    if (guistate_resources_ptr) {
-        project.append(guistate_resources_ptr->request_gui_state(true));
-    }
     megamol::core::utility::graphics::ScreenShotComments ssc(project);
     png_set_text(pngPtr, pngInfoPtr, ssc.GetComments().data(), ssc.GetComments().size());
 
@@ -124,14 +151,176 @@ static bool write_png_to_file(
 
     png_destroy_write_struct(&pngPtr, &pngInfoPtr);
 
-    file.Close();
+    return file.good();
+}
 
-    if (screenshot_show_privacy_note) {
-        megamol::core::utility::log::Log::DefaultLog.WriteWarn("Screenshot: %s", privacy_note.c_str());
-        if (service_open_popup != nullptr)
-            *service_open_popup = true;
+// binary PPM (P6), drops alpha
+static bool write_ppm_to_file(
+    megamol::frontend_resources::ScreenshotImageData const& image, std::filesystem::path const& filename) {
+    std::ofstream file;
+    if (!open_output_file(file, filename)) {
+        return false;
     }
-    return true;
+
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    std::vector<std::uint8_t> row(3 * image.width);
+    for (auto const* pixels : image.flipped_rows) {
+        for (size_t x = 0; x < image.width; ++x) {
+            row[3 * x + 0] = pixels[x].r;
+            row[3 * x + 1] = pixels[x].g;
+            row[3 * x + 2] = pixels[x].b;
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return file.good();
+}
+
+// headerless RGBA8 pixels, rows from top to bottom
+static bool write_raw_to_file(
+    megamol::frontend_resources::ScreenshotImageData const& image, std::filesystem::path const& filename) {
+    std::ofstream file;
+    if (!open_output_file(file, filename)) {
+        return false;
+    }
+
+    for (auto const* pixels : image.flipped_rows) {
+        file.write(reinterpret_cast<const char*>(pixels), image.width * sizeof(*pixels));
+    }
+
+    return file.good();
+}
+
+// the "Quite OK Image Format", see https://qoiformat.org/qoi-specification.pdf
+static bool write_qoi_to_file(
+    megamol::frontend_resources::ScreenshotImageData const& image, std::filesystem::path const& filename) {
+    using Pixel = megamol::frontend_resources::ScreenshotImageData::Pixel;
+
+    constexpr std::uint8_t QOI_OP_INDEX = 0x00;
+    constexpr std::uint8_t QOI_OP_DIFF = 0x40;
+    constexpr std::uint8_t QOI_OP_LUMA = 0x80;
+    constexpr std::uint8_t QOI_OP_RUN = 0xc0;
+    constexpr std::uint8_t QOI_OP_RGB = 0xfe;
+    constexpr std::uint8_t QOI_OP_RGBA = 0xff;
+
+    std::vector<std::uint8_t> bytes;
+    // worst case is one QOI_OP_RGBA per pixel
+    bytes.reserve(14 + image.width * image.height * 5 + 8);
+
+    auto put_u32 = [&bytes](std::uint32_t v) {
+        bytes.push_back(static_cast<std::uint8_t>(v >> 24));
+        bytes.push_back(static_cast<std::uint8_t>(v >> 16));
+        bytes.push_back(static_cast<std::uint8_t>(v >> 8));
+        bytes.push_back(static_cast<std::uint8_t>(v));
+    };
+    bytes.insert(bytes.end(), {'q', 'o', 'i', 'f'});
+    put_u32(static_cast<std::uint32_t>(image.width));
+    put_u32(static_cast<std::uint32_t>(image.height));
+    bytes.push_back(4); // RGBA
+    bytes.push_back(0); // sRGB with linear alpha
+
+    auto equal = [](Pixel const& l, Pixel const& r) {
+        return l.r == r.r && l.g == r.g && l.b == r.b && l.a == r.a;
+    };
+
+    std::array<Pixel, 64> index{};
+    for (auto& px : index) {
+        px = {0, 0, 0, 0};
+    }
+    Pixel prev = {0, 0, 0, 255};
+    int run = 0;
+    const size_t pixel_count = image.width * image.height;
+    size_t pos = 0;
+
+    for (auto const* pixels : image.flipped_rows) {
+        for (size_t x = 0; x < image.width; ++x, ++pos) {
+            Pixel const px = pixels[x];
+
+            if (equal(px, prev)) {
+                ++run;
+                if (run == 62 || pos + 1 == pixel_count) {
+                    bytes.push_back(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                bytes.push_back(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            const int hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+            if (equal(index[hash], px)) {
+                bytes.push_back(QOI_OP_INDEX | hash);
+            } else {
+                index[hash] = px;
+                if (px.a == prev.a) {
+                    const auto vr = static_cast<std::int8_t>(px.r - prev.r);
+                    const auto vg = static_cast<std::int8_t>(px.g - prev.g);
+                    const auto vb = static_cast<std::int8_t>(px.b - prev.b);
+                    const int vg_r = vr - vg;
+                    const int vg_b = vb - vg;
+
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                        bytes.push_back(QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                    } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                        bytes.push_back(QOI_OP_LUMA | (vg + 32));
+                        bytes.push_back((vg_r + 8) << 4 | (vg_b + 8));
+                    } else {
+                        bytes.insert(bytes.end(), {QOI_OP_RGB, px.r, px.g, px.b});
+                    }
+                } else {
+                    bytes.insert(bytes.end(), {QOI_OP_RGBA, px.r, px.g, px.b, px.a});
+                }
+            }
+            prev = px;
+        }
+    }
+    bytes.insert(bytes.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+
+    std::ofstream file;
+    if (!open_output_file(file, filename)) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+    return file.good();
+}
+
+static bool write_image_to_file(megamol::frontend_resources::ScreenshotImageData const& image,
+    std::string const& project, std::filesystem::path const& filename) {
+    bool success = false;
+    switch (image_file_format(filename)) {
+    case ImageFileFormat::PPM:
+        success = write_ppm_to_file(image, filename);
+        break;
+    case ImageFileFormat::QOI:
+        success = write_qoi_to_file(image, filename);
+        break;
+    case ImageFileFormat::RAW:
+        success = write_raw_to_file(image, filename);
+        break;
+    case ImageFileFormat::PNG:
+    default:
+        success = write_png_to_file(image, project, filename);
+        break;
+    }
+
+    if (!success) {
+        log_error("Failed to write screenshot " + filename.generic_u8string());
+    }
+    return success;
+}
+
+static bool needs_privacy_note(std::filesystem::path const& filename) {
+    return screenshot_show_privacy_note && image_file_format(filename) == ImageFileFormat::PNG;
+}
+
+static void show_privacy_note() {
+    megamol::core::utility::log::Log::DefaultLog.WriteWarn("Screenshot: %s", privacy_note.c_str());
+    if (service_open_popup != nullptr)
+        *service_open_popup = true;
 }
 
 megamol::frontend_resources::ImageWrapperScreenshotSource::ImageWrapperScreenshotSource(ImageWrapper const& image)
@@ -179,7 +368,11 @@ megamol::frontend_resources::ImageWrapperScreenshotSource::take_screenshot() con
 
 bool megamol::frontend_resources::ScreenshotImageDataToPNGWriter::write_image(
     ScreenshotImageData const& image, std::filesystem::path const& filename) const {
-    return write_png_to_file(image, filename);
+    const bool success = write_png_to_file(image, serialize_project(), filename);
+    if (success && needs_privacy_note(filename)) {
+        show_privacy_note();
+    }
+    return success;
 }
 
 namespace megamol::frontend {
@@ -187,6 +380,7 @@ namespace megamol::frontend {
 Screenshot_Service::Screenshot_Service() {}
 
 Screenshot_Service::~Screenshot_Service() {
+    stop_encoders();
     service_open_popup.reset();
 }
 
@@ -203,31 +397,126 @@ bool Screenshot_Service::init(const Config& config) {
         frontend_resources::MegaMolGraph_Req_Name, "optional<GUIState>", "RuntimeConfig",
         "optional<GUIRegisterWindow>"};
 
-    this->m_frontbufferToPNG_trigger = [&](std::filesystem::path const& filename) -> bool {
+    // the triggers grab the image on the render thread and leave encoding and writing to the encoder threads,
+    // the synchronous ones wait for the file so that their result tells whether it was written
+    this->m_frontbufferToPNG_asyncTrigger = [&](std::filesystem::path const& filename) -> std::future<bool> {
         log("write screenshot to " + filename.generic_u8string());
-        return m_toFileWriter_resource.write_screenshot(m_frontbufferSource_resource, filename);
+        return enqueue_screenshot(m_frontbufferSource_resource.take_screenshot(), filename);
+    };
+    this->m_frontbufferToPNG_trigger = [&](std::filesystem::path const& filename) -> bool {
+        return m_frontbufferToPNG_asyncTrigger(filename).get();
     };
 
     screenshot_show_privacy_note = config.show_privacy_note;
+    png_compression_level = std::clamp(config.png_compression_level, Z_NO_COMPRESSION, Z_BEST_COMPRESSION);
 
+    this->m_imagewrapperToPNG_asyncTrigger = [&](megamol::frontend_resources::ImageWrapper const& image,
+                                                 std::filesystem::path const& filename) -> std::future<bool> {
+        log("write screenshot to " + filename.generic_u8string());
+        return enqueue_screenshot(
+            megamol::frontend_resources::ImageWrapperScreenshotSource(image).take_screenshot(), filename);
+    };
     this->m_imagewrapperToPNG_trigger = [&](megamol::frontend_resources::ImageWrapper const& image,
                                             std::filesystem::path const& filename) -> bool {
-        log("write screenshot to " + filename.generic_u8string());
-        return m_toFileWriter_resource.write_screenshot(
-            megamol::frontend_resources::ImageWrapperScreenshotSource(image), filename);
+        return m_imagewrapperToPNG_asyncTrigger(image, filename).get();
     };
 
+    m_encoderStop = false;
+    m_encoderQueueSize = std::max(1u, config.queue_size);
+    for (unsigned int i = 0; i < config.encoder_threads; ++i) {
+        m_encoderThreads.emplace_back(&Screenshot_Service::encoder_loop, this);
+    }
+
     log("initialized successfully");
     return true;
 }
 
-void Screenshot_Service::close() {}
+void Screenshot_Service::close() {
+    stop_encoders();
+}
+
+std::future<bool> Screenshot_Service::enqueue_screenshot(
+    megamol::frontend_resources::ScreenshotImageData const& image, std::filesystem::path const& filename) {
+    // the graph may only be touched from the render thread, so the project is serialized right away
+    std::string project = (image_file_format(filename) == ImageFileFormat::PNG) ? serialize_project() : std::string();
+
+    if (m_encoderThreads.empty()) {
+        const bool success = write_image_to_file(image, project, filename);
+        if (success && needs_privacy_note(filename)) {
+            show_privacy_note();
+        }
+        std::promise<bool> written;
+        written.set_value(success);
+        return written.get_future();
+    }
+
+    // the sources hand out buffers they reuse for the next screenshot, so the pixels need to be copied
+    EncoderJob job;
+    job.image.image = image.image;
+    job.image.resize(image.width, image.height);
+    job.project = std::move(project);
+    job.filename = filename;
+    auto written = job.written.get_future();
+
+    {
+        std::unique_lock<std::mutex> lock(m_encoderMutex);
+        // back-pressure: do not let the render loop run away from the encoders
+        m_encoderQueueDrained.wait(lock, [&]() { return m_encoderQueue.size() < m_encoderQueueSize; });
+        m_encoderQueue.emplace_back(std::move(job));
+    }
+    m_encoderQueueFilled.notify_one();
+
+    // the privacy note follows once the encoder has actually written the file
+    return written;
+}
+
+void Screenshot_Service::encoder_loop() {
+    while (true) {
+        EncoderJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_encoderMutex);
+            m_encoderQueueFilled.wait(lock, [&]() { return m_encoderStop || !m_encoderQueue.empty(); });
+            if (m_encoderQueue.empty()) {
+                return; // stopped and nothing left to write
+            }
+            job = std::move(m_encoderQueue.front());
+            m_encoderQueue.pop_front();
+        }
+        m_encoderQueueDrained.notify_one();
+
+        const bool success = write_image_to_file(job.image, job.project, job.filename);
+        if (success && needs_privacy_note(job.filename)) {
+            m_privacyNotePending = true;
+        }
+        job.written.set_value(success);
+    }
+}
+
+void Screenshot_Service::stop_encoders() {
+    {
+        std::lock_guard<std::mutex> lock(m_encoderMutex);
+        m_encoderStop = true;
+    }
+    m_encoderQueueFilled.notify_all();
+    for (auto& thread : m_encoderThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    m_encoderThreads.clear();
+
+    if (m_privacyNotePending.exchange(false)) {
+        show_privacy_note();
+    }
+}
 
 std::vector<FrontendResource>& Screenshot_Service::getProvidedResources() {
     this->m_providedResourceReferences = {{"GLScreenshotSource", m_frontbufferSource_resource},
         {"ImageDataToPNGWriter", m_toFileWriter_resource},
         {"GLFrontbufferToPNG_ScreenshotTrigger", m_frontbufferToPNG_trigger},
-        {"ImageWrapperToPNG_ScreenshotTrigger", m_imagewrapperToPNG_trigger}};
+        {"ImageWrapperToPNG_ScreenshotTrigger", m_imagewrapperToPNG_trigger},
+        {"GLFrontbufferToPNG_AsyncScreenshotTrigger", m_frontbufferToPNG_asyncTrigger},
+        {"ImageWrapperToPNG_AsyncScreenshotTrigger", m_imagewrapperToPNG_asyncTrigger}};
 
 
     return m_providedResourceReferences;
@@ -255,7 +544,11 @@ void Screenshot_Service::setRequestedResources(std::vector<FrontendResource> res
     }
 }
 
-void Screenshot_Service::updateProvidedResources() {}
+void Screenshot_Service::updateProvidedResources() {
+    if (m_privacyNotePending.exchange(false)) {
+        show_privacy_note();
+    }
+}
 
 void Screenshot_Service::digestChangedRequestedResources() {
     bool need_to_shutdown = false;
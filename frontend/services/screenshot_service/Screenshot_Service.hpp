@@ -7,6 +7,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
 #include "AbstractFrontendService.hpp"
 
 // ImageData struct and interfaces for screenshot sources/writers
@@ -17,7 +24,13 @@ namespace megamol::frontend {
 class Screenshot_Service final : public AbstractFrontendService {
 public:
     struct Config {
-        bool show_privacy_note;
+        bool show_privacy_note = true;
+        // number of threads encoding and writing screenshots, 0 writes on the calling (render) thread
+        unsigned int encoder_threads = 2;
+        // maximum number of screenshots waiting for encoding before the render thread blocks
+        unsigned int queue_size = 4;
+        // zlib compression level of PNG screenshots, 0 (none) to 9 (best)
+        int png_compression_level = 1;
     };
 
     std::string serviceName() const override {
@@ -57,12 +70,46 @@ public:
     static unsigned char default_alpha_value;
 
 private:
+    /** A screenshot waiting to be encoded and written by the encoder threads */
+    struct EncoderJob {
+        megamol::frontend_resources::ScreenshotImageData image;
+        std::string project;
+        std::filesystem::path filename;
+        std::promise<bool> written;
+    };
+
+    /**
+     * Copies the image and hands it over to the encoder threads, blocks while the queue is full.
+     * The returned future becomes ready with the result of writing the file.
+     */
+    std::future<bool> enqueue_screenshot(
+        megamol::frontend_resources::ScreenshotImageData const& image, std::filesystem::path const& filename);
+
+    void encoder_loop();
+
+    /** Writes all pending screenshots and joins the encoder threads */
+    void stop_encoders();
+
     megamol::frontend_resources::GLScreenshotSource m_frontbufferSource_resource;
     megamol::frontend_resources::ScreenshotImageDataToPNGWriter m_toFileWriter_resource;
 
     std::function<bool(std::filesystem::path const&)> m_frontbufferToPNG_trigger;
     std::function<bool(megamol::frontend_resources::ImageWrapper const&, std::filesystem::path const&)>
         m_imagewrapperToPNG_trigger;
+    // the async triggers return right after handing off the image, e.g. for dumping frame sequences
+    std::function<std::future<bool>(std::filesystem::path const&)> m_frontbufferToPNG_asyncTrigger;
+    std::function<std::future<bool>(megamol::frontend_resources::ImageWrapper const&, std::filesystem::path const&)>
+        m_imagewrapperToPNG_asyncTrigger;
+
+    std::vector<std::thread> m_encoderThreads;
+    std::deque<EncoderJob> m_encoderQueue;
+    std::mutex m_encoderMutex;
+    std::condition_variable m_encoderQueueFilled;
+    std::condition_variable m_encoderQueueDrained;
+    size_t m_encoderQueueSize = 0;
+    bool m_encoderStop = false;
+    /** Set by the encoder threads once a PNG has been written, the note is shown on the render thread */
+    std::atomic<bool> m_privacyNotePending = false;
 
     std::vector<FrontendResource> m_providedResourceReferences;
     std::vector<std::string> m_requestedResourcesNames;
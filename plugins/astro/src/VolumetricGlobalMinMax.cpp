@@ -7,16 +7,69 @@
 
 #include "VolumetricGlobalMinMax.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
 #include "mmcore/utility/log/Log.h"
 
+namespace {
+
+/** Identifies statistics files. */
+constexpr char statisticsMagic[8] = {'M', 'M', 'V', 'S', 'T', 'A', 'T', 'S'};
+
+/** The version of the statistics file layout. */
+constexpr uint32_t statisticsVersion = 2;
+
+/** The number of words sampled for the fingerprint of a frame. */
+constexpr size_t fingerprintSamples = 4096;
+
+/** Folds 'value' into the FNV-1a hash 'hash'. */
+inline uint64_t fold(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/** Folds 'size' bytes at 'data' into 'hash', a word at a time */
+uint64_t foldBytes(uint64_t hash, const void* data, size_t size) {
+    const auto bytes = static_cast<const uint8_t*>(data);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
 /*
  * megamol::astro::VolumetricGlobalMinMax::VolumetricGlobalMinMax
  */
 megamol::astro::VolumetricGlobalMinMax::VolumetricGlobalMinMax()
         : Module()
-        , hash(0)
+        , slotBrickedDataIn("brickedDataIn", "Input slot for bricked volumetric data")
+        , slotBrickedDataOut("brickedDataOut", "Output slot for bricked volumetric data")
         , slotVolumetricDataIn("volumetricDataIn", "Input slot for volumetric data")
-        , slotVolumetricDataOut("volumetricDataOut", "Output slot for volumetric data") {
+        , slotVolumetricDataOut("volumetricDataOut", "Output slot for volumetric data")
+        , brickedHash(0)
+        , paramHistogramBins("histogramBins", "Number of histogram bins per frame and component")
+        , paramIgnoreInputHash("ignoreInputHash",
+              "Reuse the statistics of the statistics file even if the input hash changed, e.g. after a restart")
+        , paramStatisticsFile("statisticsFile", "File persisting the per-frame statistics, none if empty")
+        , hash(0) {
     // Publish the slots.
     this->slotVolumetricDataIn.SetCompatibleCall<geocalls::VolumetricDataCallDescription>();
     this->MakeSlotAvailable(&this->slotVolumetricDataIn);
@@ -40,6 +93,31 @@ megamol::astro::VolumetricGlobalMinMax::VolumetricGlobalMinMax()
         geocalls::VolumetricDataCall::FunctionName(geocalls::VolumetricDataCall::IDX_TRY_GET_DATA),
         &VolumetricGlobalMinMax::onUnsupportedCallback);
     this->MakeSlotAvailable(&this->slotVolumetricDataOut);
+
+    this->paramHistogramBins << new core::param::IntParam(256, 1);
+    this->MakeSlotAvailable(&this->paramHistogramBins);
+
+    this->paramIgnoreInputHash << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->paramIgnoreInputHash);
+
+    this->paramStatisticsFile << new core::param::FilePathParam(
+        "", core::param::FilePathParam::FilePathFlags_::Flag_File_ToBeCreated);
+    this->MakeSlotAvailable(&this->paramStatisticsFile);
+
+    using geocalls::BrickedVolumetricDataCall;
+    this->slotBrickedDataIn.SetCompatibleCall<geocalls::BrickedVolumetricDataCallDescription>();
+    this->MakeSlotAvailable(&this->slotBrickedDataIn);
+
+    this->slotBrickedDataOut.SetCallback(BrickedVolumetricDataCall::ClassName(),
+        BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_DATA),
+        &VolumetricGlobalMinMax::onGetBrickedData);
+    this->slotBrickedDataOut.SetCallback(BrickedVolumetricDataCall::ClassName(),
+        BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_EXTENTS),
+        &VolumetricGlobalMinMax::onGetBrickedExtents);
+    this->slotBrickedDataOut.SetCallback(BrickedVolumetricDataCall::ClassName(),
+        BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_BRICKS),
+        &VolumetricGlobalMinMax::onGetBricked);
+    this->MakeSlotAvailable(&this->slotBrickedDataOut);
 }
 
 /*
@@ -73,6 +151,18 @@ bool megamol::astro::VolumetricGlobalMinMax::onGetMetadata(megamol::core::Call&
     return pipeVolumetricDataCall(call, geocalls::VolumetricDataCall::IDX_GET_METADATA);
 }
 
+bool megamol::astro::VolumetricGlobalMinMax::onGetBricked(megamol::core::Call& call) {
+    return pipeBrickedVolumetricDataCall(call, geocalls::BrickedVolumetricDataCall::IDX_GET_BRICKS);
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::onGetBrickedData(megamol::core::Call& call) {
+    return pipeBrickedVolumetricDataCall(call, geocalls::BrickedVolumetricDataCall::IDX_GET_DATA);
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::onGetBrickedExtents(megamol::core::Call& call) {
+    return pipeBrickedVolumetricDataCall(call, geocalls::BrickedVolumetricDataCall::IDX_GET_EXTENTS);
+}
+
 bool megamol::astro::VolumetricGlobalMinMax::onUnsupportedCallback(megamol::core::Call& call) {
     return false;
 }
@@ -102,37 +192,24 @@ bool megamol::astro::VolumetricGlobalMinMax::pipeVolumetricDataCall(megamol::cor
 
         return false;
     }
-    *dst = *src;
-
-    if (src->DataHash() != this->hash || this->hash == 0) {
-        this->hash = src->DataHash();
-        this->minValues.clear();
-        this->maxValues.clear();
 
-        auto frames = src->FrameCount();
-        for (unsigned int i = 0; i < frames; ++i) {
-            src->SetFrameID(i, true);
-            VolumetricDataCall::GetMetadata(*src);
-            const auto metadata = src->GetMetadata();
-            if (i == 0) {
-                this->minValues.resize(metadata->Components, std::numeric_limits<double>::max());
-                this->maxValues.resize(metadata->Components, std::numeric_limits<double>::lowest());
-            } else {
-                if (this->minValues.size() != metadata->Components) {
-                    Log::DefaultLog.WriteError("Unexpected number of components.");
-                    return false;
-                }
-            }
+    const bool paramsDirty = this->paramHistogramBins.IsDirty() || this->paramIgnoreInputHash.IsDirty() ||
+                             this->paramStatisticsFile.IsDirty();
+    if (src->DataHash() != this->hash || this->hash == 0 || paramsDirty) {
+        const auto hash = src->DataHash();
+        if (!this->updateStatistics(*src)) {
+            return false;
+        }
+        this->hash = hash;
 
-            for (size_t j = 0; j < metadata->Components; ++j) {
-                if (metadata->MinValues[j] < this->minValues[j]) {
-                    this->minValues[j] = metadata->MinValues[j];
-                }
-                if (metadata->MaxValues[j] > this->maxValues[j]) {
-                    this->maxValues[j] = metadata->MaxValues[j];
-                }
-            }
+        // scanning the frames changed the state of the source
+        *src = *dst;
+        if (!(*src)(funcIdx)) {
+            Log::DefaultLog.WriteError("%hs failed to call %hs.", VolumetricGlobalMinMax::ClassName(),
+                VolumetricDataCall::FunctionName(funcIdx));
+            return false;
         }
+
         Log::DefaultLog.WriteInfo("Min/Max Update");
         Log::DefaultLog.WriteInfo("Min:");
         for (const auto& m : this->minValues) {
@@ -143,6 +220,10 @@ bool megamol::astro::VolumetricGlobalMinMax::pipeVolumetricDataCall(megamol::cor
             Log::DefaultLog.WriteInfo("    %f", m);
         }
     }
+    if ((funcIdx == VolumetricDataCall::IDX_GET_DATA) && !this->validateFrame(*src)) {
+        return false;
+    }
+    *dst = *src;
 
     auto metadata = dst->GetMetadata();
     if (metadata != nullptr) {
@@ -158,3 +239,465 @@ bool megamol::astro::VolumetricGlobalMinMax::pipeVolumetricDataCall(megamol::cor
 
     return true;
 }
+
+bool megamol::astro::VolumetricGlobalMinMax::pipeBrickedVolumetricDataCall(
+    megamol::core::Call& call, unsigned int funcIdx) {
+    using geocalls::BrickedVolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    auto dst = dynamic_cast<BrickedVolumetricDataCall*>(&call);
+    auto src = this->slotBrickedDataIn.CallAs<BrickedVolumetricDataCall>();
+
+    if (dst == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs received a wrong request.",
+            BrickedVolumetricDataCall::FunctionName(funcIdx), VolumetricGlobalMinMax::ClassName());
+        return false;
+    }
+    if (src == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs has a wrong source.",
+            BrickedVolumetricDataCall::FunctionName(funcIdx), VolumetricGlobalMinMax::ClassName());
+        return false;
+    }
+
+    *src = *dst;
+    if (!(*src)(funcIdx)) {
+        Log::DefaultLog.WriteError("%hs failed to call %hs.", VolumetricGlobalMinMax::ClassName(),
+            BrickedVolumetricDataCall::FunctionName(funcIdx));
+        return false;
+    }
+
+    if ((funcIdx == BrickedVolumetricDataCall::IDX_GET_DATA) &&
+        (src->DataHash() != this->brickedHash || this->brickedHash == 0)) {
+        // the ranges of the full-resolution bricks are the range of the frame
+        const auto hash = src->DataHash();
+        const auto frames = src->FrameCount();
+        this->brickedMinValues.clear();
+        this->brickedMaxValues.clear();
+
+        for (unsigned int i = 0; i < frames; ++i) {
+            src->SetFrameID(i, true);
+            if (!(*src)(BrickedVolumetricDataCall::IDX_GET_DATA) || (src->GetLevelCount() == 0)) {
+                Log::DefaultLog.WriteError("%hs failed to call %hs.", VolumetricGlobalMinMax::ClassName(),
+                    BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_DATA));
+                return false;
+            }
+            const auto components = src->GetComponents();
+            if (i == 0) {
+                this->brickedMinValues.resize(components, std::numeric_limits<double>::max());
+                this->brickedMaxValues.resize(components, std::numeric_limits<double>::lowest());
+            } else if (this->brickedMinValues.size() != components) {
+                Log::DefaultLog.WriteError("Unexpected number of components.");
+                return false;
+            }
+
+            const auto& level = src->GetLevel(0);
+            const auto bricks = level.Bricks[0] * level.Bricks[1] * level.Bricks[2];
+            for (size_t b = level.FirstBrick; b < level.FirstBrick + bricks; ++b) {
+                for (size_t j = 0; j < components; ++j) {
+                    this->brickedMinValues[j] = (std::min)(this->brickedMinValues[j], src->GetBrickMin(b, j));
+                    this->brickedMaxValues[j] = (std::max)(this->brickedMaxValues[j], src->GetBrickMax(b, j));
+                }
+            }
+        }
+        this->brickedHash = hash;
+        Log::DefaultLog.WriteInfo("Min/Max Update from %u frames of bricks", frames);
+
+        // restore the state of the requested frame
+        *src = *dst;
+        if (!(*src)(funcIdx)) {
+            Log::DefaultLog.WriteError("%hs failed to call %hs.", VolumetricGlobalMinMax::ClassName(),
+                BrickedVolumetricDataCall::FunctionName(funcIdx));
+            return false;
+        }
+    }
+    *dst = *src;
+
+    if ((funcIdx == BrickedVolumetricDataCall::IDX_GET_DATA) && (src->GetMetadata() != nullptr)) {
+        if (this->brickedMinValues.size() != src->GetComponents()) {
+            Log::DefaultLog.WriteError("Unexpected number of components.");
+            return false;
+        }
+        this->brickedMetadata = *src->GetMetadata();
+        for (size_t i = 0; i < this->brickedMinValues.size(); ++i) {
+            this->brickedMetadata.MinValues[i] = this->brickedMinValues[i];
+            this->brickedMetadata.MaxValues[i] = this->brickedMaxValues[i];
+        }
+        dst->SetMetadata(&this->brickedMetadata);
+    }
+
+    return true;
+}
+
+template<class T>
+void megamol::astro::VolumetricGlobalMinMax::computeStatistics(
+    const T* data, size_t voxels, size_t components, size_t bins, FrameStatistics& stats) {
+    const auto cnt = static_cast<int64_t>(voxels);
+    stats.minValues.assign(components, std::numeric_limits<double>::max());
+    stats.maxValues.assign(components, std::numeric_limits<double>::lowest());
+    stats.meanValues.assign(components, 0.0);
+    stats.histogram.assign(components * bins, 0);
+
+    // first pass: range and sum, reduced from thread-local partials
+#pragma omp parallel
+    {
+        std::vector<double> localMin(components, std::numeric_limits<double>::max());
+        std::vector<double> localMax(components, std::numeric_limits<double>::lowest());
+        std::vector<double> localSum(components, 0.0);
+        if (components == 1) {
+            // keep the accumulators in registers so that the loop vectorises
+            double mi = localMin[0], ma = localMax[0], sum = 0.0;
+#pragma omp for
+            for (int64_t i = 0; i < cnt; ++i) {
+                const double v = static_cast<double>(data[i]);
+                mi = (v < mi) ? v : mi;
+                ma = (v > ma) ? v : ma;
+                sum += v;
+            }
+            localMin[0] = mi;
+            localMax[0] = ma;
+            localSum[0] = sum;
+        } else {
+#pragma omp for
+            for (int64_t i = 0; i < cnt; ++i) {
+                const T* voxel = data + i * components;
+                for (size_t c = 0; c < components; ++c) {
+                    const double v = static_cast<double>(voxel[c]);
+                    localMin[c] = (v < localMin[c]) ? v : localMin[c];
+                    localMax[c] = (v > localMax[c]) ? v : localMax[c];
+                    localSum[c] += v;
+                }
+            }
+        }
+#pragma omp critical
+        for (size_t c = 0; c < components; ++c) {
+            stats.minValues[c] = (std::min)(stats.minValues[c], localMin[c]);
+            stats.maxValues[c] = (std::max)(stats.maxValues[c], localMax[c]);
+            stats.meanValues[c] += localSum[c];
+        }
+    }
+
+    std::vector<double> scale(components, 0.0);
+    for (size_t c = 0; c < components; ++c) {
+        stats.meanValues[c] /= (voxels > 0) ? static_cast<double>(voxels) : 1.0;
+        const auto range = stats.maxValues[c] - stats.minValues[c];
+        scale[c] = (range > 0.0) ? static_cast<double>(bins) / range : 0.0;
+    }
+
+    // second pass: histogram over the range of the frame
+#pragma omp parallel
+    {
+        std::vector<uint64_t> local(components * bins, 0);
+#pragma omp for
+        for (int64_t i = 0; i < cnt; ++i) {
+            const T* voxel = data + i * components;
+            for (size_t c = 0; c < components; ++c) {
+                const double v = (static_cast<double>(voxel[c]) - stats.minValues[c]) * scale[c];
+                if (v >= 0.0) {
+                    ++local[c * bins + (std::min)(static_cast<size_t>(v), bins - 1)];
+                }
+            }
+        }
+#pragma omp critical
+        for (size_t i = 0; i < local.size(); ++i) {
+            stats.histogram[i] += local[i];
+        }
+    }
+}
+
+uint64_t megamol::astro::VolumetricGlobalMinMax::fingerprint(const void* data, size_t size) {
+    // a fixed number of evenly spaced words, so the cost does not grow with the frame
+    uint64_t hash = fold(14695981039346656037ull, size);
+    if (size <= fingerprintSamples * sizeof(uint64_t)) {
+        return foldBytes(hash, data, size);
+    }
+    const auto bytes = static_cast<const uint8_t*>(data);
+    const auto stride = (size - sizeof(uint64_t)) / (fingerprintSamples - 1);
+    for (size_t i = 0; i < fingerprintSamples; ++i) {
+        hash = foldBytes(hash, bytes + i * stride, sizeof(uint64_t));
+    }
+    return hash;
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::scanFrame(const void* data,
+    const geocalls::VolumetricDataCall::Metadata& layout, size_t bins, FrameStatistics& stats) {
+    using megamol::core::utility::log::Log;
+
+    const auto components = layout.Components;
+    const auto voxels = layout.Resolution[0] * layout.Resolution[1] * layout.Resolution[2];
+    switch (layout.ScalarType) {
+    case geocalls::FLOATING_POINT:
+        if (layout.ScalarLength == 4) {
+            computeStatistics(static_cast<const float*>(data), voxels, components, bins, stats);
+        } else if (layout.ScalarLength == 8) {
+            computeStatistics(static_cast<const double*>(data), voxels, components, bins, stats);
+        } else {
+            Log::DefaultLog.WriteError("%hs cannot process %u-byte FLOATING_POINT data.", ClassName(),
+                static_cast<unsigned int>(layout.ScalarLength));
+            return false;
+        }
+        break;
+    case geocalls::SIGNED_INTEGER:
+        switch (layout.ScalarLength) {
+        case 1:
+            computeStatistics(static_cast<const int8_t*>(data), voxels, components, bins, stats);
+            break;
+        case 2:
+            computeStatistics(static_cast<const int16_t*>(data), voxels, components, bins, stats);
+            break;
+        case 4:
+            computeStatistics(static_cast<const int32_t*>(data), voxels, components, bins, stats);
+            break;
+        case 8:
+            computeStatistics(static_cast<const int64_t*>(data), voxels, components, bins, stats);
+            break;
+        default:
+            Log::DefaultLog.WriteError("%hs cannot process %u-byte SIGNED_INTEGER data.", ClassName(),
+                static_cast<unsigned int>(layout.ScalarLength));
+            return false;
+        }
+        break;
+    case geocalls::UNSIGNED_INTEGER:
+        switch (layout.ScalarLength) {
+        case 1:
+            computeStatistics(static_cast<const uint8_t*>(data), voxels, components, bins, stats);
+            break;
+        case 2:
+            computeStatistics(static_cast<const uint16_t*>(data), voxels, components, bins, stats);
+            break;
+        case 4:
+            computeStatistics(static_cast<const uint32_t*>(data), voxels, components, bins, stats);
+            break;
+        case 8:
+            computeStatistics(static_cast<const uint64_t*>(data), voxels, components, bins, stats);
+            break;
+        default:
+            Log::DefaultLog.WriteError("%hs cannot process %u-byte UNSIGNED_INTEGER data.", ClassName(),
+                static_cast<unsigned int>(layout.ScalarLength));
+            return false;
+        }
+        break;
+    default:
+        Log::DefaultLog.WriteError("%hs cannot process scalar type %d.", ClassName(), layout.ScalarType);
+        return false;
+    }
+    return true;
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::loadStatistics(
+    const std::filesystem::path& path, size_t components, size_t bins) {
+    using megamol::core::utility::log::Log;
+
+    this->frameStatistics.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char magic[8];
+    uint32_t version = 0, fileComponents = 0, fileBins = 0, frames = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&fileComponents), sizeof(fileComponents));
+    file.read(reinterpret_cast<char*>(&fileBins), sizeof(fileBins));
+    file.read(reinterpret_cast<char*>(&frames), sizeof(frames));
+    if (!file || std::memcmp(magic, statisticsMagic, sizeof(magic)) != 0 || version != statisticsVersion ||
+        fileComponents != components || fileBins != bins) {
+        Log::DefaultLog.WriteWarn(
+            "%hs: ignoring incompatible statistics file %s", ClassName(), path.generic_u8string().c_str());
+        return false;
+    }
+
+    this->frameStatistics.resize(frames);
+    for (auto& stats : this->frameStatistics) {
+        stats.minValues.resize(components);
+        stats.maxValues.resize(components);
+        stats.meanValues.resize(components);
+        stats.histogram.resize(components * bins);
+        file.read(reinterpret_cast<char*>(&stats.key), sizeof(stats.key));
+        file.read(reinterpret_cast<char*>(&stats.fingerprint), sizeof(stats.fingerprint));
+        file.read(reinterpret_cast<char*>(stats.minValues.data()), components * sizeof(double));
+        file.read(reinterpret_cast<char*>(stats.maxValues.data()), components * sizeof(double));
+        file.read(reinterpret_cast<char*>(stats.meanValues.data()), components * sizeof(double));
+        file.read(reinterpret_cast<char*>(stats.histogram.data()), components * bins * sizeof(uint64_t));
+    }
+    if (!file) {
+        Log::DefaultLog.WriteWarn("%hs: statistics file %s is truncated", ClassName(), path.generic_u8string().c_str());
+        this->frameStatistics.clear();
+        return false;
+    }
+    return true;
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::saveStatistics(
+    const std::filesystem::path& path, size_t components, size_t bins) const {
+    using megamol::core::utility::log::Log;
+
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        const uint32_t header[4] = {statisticsVersion, static_cast<uint32_t>(components), static_cast<uint32_t>(bins),
+            static_cast<uint32_t>(this->frameStatistics.size())};
+        file.write(statisticsMagic, sizeof(statisticsMagic));
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const auto& stats : this->frameStatistics) {
+            file.write(reinterpret_cast<const char*>(&stats.key), sizeof(stats.key));
+            file.write(reinterpret_cast<const char*>(&stats.fingerprint), sizeof(stats.fingerprint));
+            file.write(reinterpret_cast<const char*>(stats.minValues.data()), components * sizeof(double));
+            file.write(reinterpret_cast<const char*>(stats.maxValues.data()), components * sizeof(double));
+            file.write(reinterpret_cast<const char*>(stats.meanValues.data()), components * sizeof(double));
+            file.write(reinterpret_cast<const char*>(stats.histogram.data()), components * bins * sizeof(uint64_t));
+        }
+        if (!file) {
+            Log::DefaultLog.WriteWarn(
+                "%hs: could not write statistics file %s", ClassName(), tmpPath.generic_u8string().c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        Log::DefaultLog.WriteWarn("%hs: could not write statistics file %s: %s", ClassName(),
+            path.generic_u8string().c_str(), ec.message().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::updateStatistics(geocalls::VolumetricDataCall& src) {
+    using core::param::BoolParam;
+    using core::param::FilePathParam;
+    using core::param::IntParam;
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto dataHash = src.DataHash();
+    const auto frames = src.FrameCount();
+    const auto bins = static_cast<size_t>(this->paramHistogramBins.Param<IntParam>()->Value());
+    const auto path = this->paramStatisticsFile.Param<FilePathParam>()->Value();
+    const bool reloadFile = this->paramHistogramBins.IsDirty() || this->paramStatisticsFile.IsDirty() ||
+                            this->frameStatistics.empty();
+    this->paramHistogramBins.ResetDirty();
+    this->paramIgnoreInputHash.ResetDirty();
+    this->paramStatisticsFile.ResetDirty();
+
+    src.SetFrameID(0, true);
+    if (!VolumetricDataCall::GetMetadata(src)) {
+        return false;
+    }
+    const auto layout = *src.GetMetadata();
+    const auto components = layout.Components;
+    const auto frameSize = layout.Resolution[0] * layout.Resolution[1] * layout.Resolution[2] * components *
+                           static_cast<size_t>(layout.ScalarLength);
+
+    // records are only valid for the same source and layout and, unless told otherwise, the same input hash
+    uint64_t sourceKey = 14695981039346656037ull;
+    const auto callee = src.PeekCalleeSlot();
+    if ((callee != nullptr) && (callee->Parent() != nullptr)) {
+        const auto name = callee->Parent()->FullName();
+        sourceKey = foldBytes(sourceKey, name.PeekBuffer(), name.Length());
+    }
+    sourceKey = fold(sourceKey, components);
+    sourceKey = fold(sourceKey, layout.GridType);
+    sourceKey = fold(sourceKey, layout.ScalarType);
+    sourceKey = fold(sourceKey, layout.ScalarLength);
+    sourceKey = fold(sourceKey, layout.Resolution[0]);
+    sourceKey = fold(sourceKey, layout.Resolution[1]);
+    sourceKey = fold(sourceKey, layout.Resolution[2]);
+    sourceKey = foldBytes(sourceKey, layout.Origin, sizeof(layout.Origin));
+    sourceKey = foldBytes(sourceKey, layout.Extents, sizeof(layout.Extents));
+    sourceKey = fold(sourceKey, bins);
+    if (!this->paramIgnoreInputHash.Param<BoolParam>()->Value()) {
+        sourceKey = fold(sourceKey, dataHash);
+    }
+
+    if (reloadFile && !path.empty()) {
+        this->loadStatistics(path, components, bins);
+    }
+    this->frameStatistics.resize(frames);
+
+    unsigned int scanned = 0;
+    for (unsigned int i = 0; i < frames; ++i) {
+        auto& stats = this->frameStatistics[i];
+        const auto key = (std::max)(fold(sourceKey, i), static_cast<uint64_t>(1));
+        if (stats.key == key) {
+            // the content is checked once the frame is loaded anyway, see validateFrame
+            stats.validated = false;
+            continue;
+        }
+
+        src.SetFrameID(i, true);
+        if (!src(VolumetricDataCall::IDX_GET_DATA) || (src.GetData() == nullptr) || (src.FrameID() != i)) {
+            Log::DefaultLog.WriteError("%hs: could not get frame %u.", ClassName(), i);
+            return false;
+        }
+        if (!scanFrame(src.GetData(), layout, bins, stats)) {
+            return false;
+        }
+        stats.key = key;
+        stats.fingerprint = fingerprint(src.GetData(), frameSize);
+        stats.validated = true;
+        ++scanned;
+    }
+
+    if ((scanned > 0) && !path.empty()) {
+        this->saveStatistics(path, components, bins);
+    }
+    this->updateRange(components);
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+    Log::DefaultLog.WriteInfo(
+        "%hs: scanned %u of %u frames in %.2f s.", ClassName(), scanned, frames, duration.count());
+    return true;
+}
+
+void megamol::astro::VolumetricGlobalMinMax::updateRange(size_t components) {
+    this->minValues.assign(components, std::numeric_limits<double>::max());
+    this->maxValues.assign(components, std::numeric_limits<double>::lowest());
+    for (const auto& stats : this->frameStatistics) {
+        for (size_t c = 0; c < components; ++c) {
+            this->minValues[c] = (std::min)(this->minValues[c], stats.minValues[c]);
+            this->maxValues[c] = (std::max)(this->maxValues[c], stats.maxValues[c]);
+        }
+    }
+}
+
+bool megamol::astro::VolumetricGlobalMinMax::validateFrame(const geocalls::VolumetricDataCall& src) {
+    using core::param::FilePathParam;
+    using core::param::IntParam;
+    using megamol::core::utility::log::Log;
+
+    const auto frame = src.FrameID();
+    if ((frame >= this->frameStatistics.size()) || this->frameStatistics[frame].validated ||
+        (src.GetData() == nullptr) || (src.GetMetadata() == nullptr)) {
+        return true;
+    }
+
+    const auto& layout = *src.GetMetadata();
+    const auto components = layout.Components;
+    const auto frameSize = layout.Resolution[0] * layout.Resolution[1] * layout.Resolution[2] * components *
+                           static_cast<size_t>(layout.ScalarLength);
+    auto& stats = this->frameStatistics[frame];
+    stats.validated = true;
+    const auto current = fingerprint(src.GetData(), frameSize);
+    if (current == stats.fingerprint) {
+        return true;
+    }
+
+    // the record was stale, the voxels are at hand to replace it
+    const auto bins = static_cast<size_t>(this->paramHistogramBins.Param<IntParam>()->Value());
+    if (!scanFrame(src.GetData(), layout, bins, stats)) {
+        return false;
+    }
+    stats.fingerprint = current;
+    this->updateRange(components);
+    Log::DefaultLog.WriteInfo("%hs: frame %u changed since its statistics were stored.", ClassName(), frame);
+
+    const auto path = this->paramStatisticsFile.Param<FilePathParam>()->Value();
+    if (!path.empty()) {
+        this->saveStatistics(path, components, bins);
+    }
+    return true;
+}
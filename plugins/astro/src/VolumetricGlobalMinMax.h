@@ -8,12 +8,18 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
 
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
 
+#include "geometry_calls/BrickedVolumetricDataCall.h"
 #include "geometry_calls/VolumetricDataCall.h"
+#include "geometry_calls/VolumetricMetadataStore.h"
 
 
 namespace megamol::astro {
@@ -21,6 +27,19 @@ namespace megamol::astro {
 /// <summary>
 /// Gets min/max values on a <see cref="VolumetricDataCall" />.
 /// </summary>
+/// <remarks>
+/// The statistics of each frame (per component min/max/mean and a histogram
+/// over the range of the frame) can be persisted in a statistics file. Each
+/// record is keyed by the source module, the layout of the volume, the frame
+/// index and the input hash, so known frames are not loaded again and new
+/// frames are computed incrementally. A sampled fingerprint of the voxels is
+/// checked whenever a frame passes through the module anyway, and a frame
+/// whose content changed is computed again from the data at hand.
+///
+/// Bricked volumes are passed through as well. Their global range is
+/// gathered from the per-brick ranges of the brick tables, so no voxels are
+/// loaded.
+/// </remarks>
 class VolumetricGlobalMinMax : public core::Module {
 
 public:
@@ -53,13 +72,61 @@ protected:
 
     bool onGetMetadata(core::Call& call);
 
+    /** Statistics of one frame. */
+    struct FrameStatistics {
+        std::uint64_t key = 0;
+        std::uint64_t fingerprint = 0;
+        bool validated = false;
+        std::vector<double> minValues;
+        std::vector<double> maxValues;
+        std::vector<double> meanValues;
+        std::vector<std::uint64_t> histogram;
+    };
+
+    template<class T>
+    static void computeStatistics(
+        const T* data, size_t voxels, size_t components, size_t bins, FrameStatistics& stats);
+
+    static std::uint64_t fingerprint(const void* data, size_t size);
+
+    static bool scanFrame(const void* data, const geocalls::VolumetricDataCall::Metadata& layout, size_t bins,
+        FrameStatistics& stats);
+
+    bool loadStatistics(const std::filesystem::path& path, size_t components, size_t bins);
+
+    bool saveStatistics(const std::filesystem::path& path, size_t components, size_t bins) const;
+
+    bool updateStatistics(geocalls::VolumetricDataCall& src);
+
+    void updateRange(size_t components);
+
+    bool validateFrame(const geocalls::VolumetricDataCall& src);
+
+    bool onGetBricked(core::Call& call);
+
+    bool onGetBrickedData(core::Call& call);
+
+    bool onGetBrickedExtents(core::Call& call);
+
     bool onUnsupportedCallback(core::Call& call);
 
+    bool pipeBrickedVolumetricDataCall(core::Call& call, unsigned int funcIdx);
+
     bool pipeVolumetricDataCall(core::Call& call, unsigned int funcIdx);
 
 private:
+    core::CallerSlot slotBrickedDataIn;
+    core::CalleeSlot slotBrickedDataOut;
     core::CallerSlot slotVolumetricDataIn;
     core::CalleeSlot slotVolumetricDataOut;
+    size_t brickedHash;
+    geocalls::VolumetricMetadataStore brickedMetadata;
+    std::vector<double> brickedMinValues;
+    std::vector<double> brickedMaxValues;
+    core::param::ParamSlot paramHistogramBins;
+    core::param::ParamSlot paramIgnoreInputHash;
+    core::param::ParamSlot paramStatisticsFile;
+    std::vector<FrameStatistics> frameStatistics;
     size_t hash;
     std::vector<double> minValues;
     std::vector<double> maxValues;
@@ -37,6 +37,10 @@ public:
     inline size_t get_count() const {
         return count;
     }
+    /** Answer the number of particles used from the given list, zero for skipped lists */
+    inline size_t get_list_count(unsigned int list_idx) const {
+        return list[list_idx].count;
+    }
     inline float const* get_position(size_t idx) const {
         for (list_data* l = list; l != nullptr; l = l->next) {
             if (idx < l->count) {
@@ -0,0 +1,131 @@
+/*
+ * SpatialIndex.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "geometry_calls/MultiParticleDataCall.h"
+#include "vislib/math/Cuboid.h"
+
+namespace megamol::datatools {
+
+/**
+ * Immutable kd-tree over the positions of all particles of one frame of a
+ * MultiParticleDataCall. The positions are copied, so the index stays valid
+ * after the particle data has been unlocked and can be shared between
+ * modules. The subtrees are built in parallel.
+ *
+ * Particles are addressed by a global index running over all particle lists
+ * in order (lists without vertex data contribute zero particles).
+ */
+class SpatialIndex {
+public:
+    /** Match of a query: global particle index and squared distance */
+    typedef std::pair<size_t, float> match_t;
+
+    /**
+     * Builds the index.
+     *
+     * @param dat The particle data. Must hold valid data of one frame.
+     * @param periodic Periodic boundary conditions per axis, the period is the object space bounding box.
+     * @param maxLeafSize Maximum number of particles in a leaf of the tree.
+     */
+    SpatialIndex(geocalls::MultiParticleDataCall& dat, std::array<bool, 3> const& periodic, unsigned int maxLeafSize);
+
+    ~SpatialIndex();
+
+    SpatialIndex(SpatialIndex const& rhs) = delete;
+    SpatialIndex& operator=(SpatialIndex const& rhs) = delete;
+
+    /** Number of indexed particles */
+    inline size_t Count() const {
+        return this->positions.size() / 3;
+    }
+
+    /** Position of the particle with the given global index (three floats) */
+    inline float const* GetPosition(size_t idx) const {
+        return this->positions.data() + 3 * idx;
+    }
+
+    /** Number of particle lists of the indexed data */
+    inline unsigned int ListCount() const {
+        return static_cast<unsigned int>(this->listOffsets.size() - 1);
+    }
+
+    /** Global index of the first particle of the given list, 'ListCount()' is valid as end marker */
+    inline size_t ListOffset(unsigned int list) const {
+        return this->listOffsets[list];
+    }
+
+    /** Answer the list the particle with the given global index belongs to */
+    unsigned int ListOf(size_t idx) const;
+
+    /**
+     * Answer whether the index holds 'listCounts[l]' particles of each list
+     * 'l', i.e. whether a consumer using these particles numbers them like
+     * the index does.
+     */
+    bool Matches(std::vector<size_t> const& listCounts) const;
+
+    /** The bounding box used as period for the periodic boundary conditions */
+    inline vislib::math::Cuboid<float> const& BBox() const {
+        return this->bbox;
+    }
+
+    /** Periodic boundary conditions per axis */
+    inline std::array<bool, 3> const& Periodic() const {
+        return this->periodic;
+    }
+
+    /**
+     * Searches the 'k' nearest neighbours of 'query', honouring the periodic
+     * boundary conditions. Thread-safe.
+     *
+     * @param query The query position (three floats).
+     * @param k The number of neighbours to search.
+     * @param matches Receives the matches sorted by ascending distance.
+     *
+     * @return The number of matches found.
+     */
+    size_t FindNearest(float const* query, size_t k, std::vector<match_t>& matches) const;
+
+    /**
+     * Searches all particles within a radius around 'query', honouring the
+     * periodic boundary conditions. Thread-safe.
+     *
+     * @param query The query position (three floats).
+     * @param radiusSqr The squared search radius.
+     * @param matches Receives the matches sorted by ascending distance.
+     *
+     * @return The number of matches found.
+     */
+    size_t FindInRadius(float const* query, float radiusSqr, std::vector<match_t>& matches) const;
+
+private:
+    class Tree;
+
+    /** Calls 'f' for the query and all of its periodic images that can be closer than 'range' */
+    template<class F>
+    void forEachImage(float const* query, float range, F&& f) const;
+
+    std::vector<float> positions;
+
+    std::vector<size_t> listOffsets;
+
+    vislib::math::Cuboid<float> bbox;
+
+    std::array<bool, 3> periodic;
+
+    std::unique_ptr<Tree> tree;
+};
+
+} // namespace megamol::datatools
@@ -0,0 +1,68 @@
+/*
+ * SpatialIndexDataCall.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include <memory>
+
+#include "datatools/SpatialIndex.h"
+#include "mmcore/factories/CallAutoDescription.h"
+#include "mmstd/data/AbstractGetData3DCall.h"
+
+namespace megamol::datatools {
+
+/**
+ * Call transporting a shared spatial index over the particles of one frame,
+ * so that several modules can run neighbourhood queries on the same tree.
+ */
+class SpatialIndexDataCall : public core::AbstractGetData3DCall {
+public:
+    /** Call function names */
+    enum CallFunctionNames : int { GET_DATA = 0, GET_EXTENT = 1 };
+
+    /** factory info */
+    static const char* ClassName() {
+        return "SpatialIndexDataCall";
+    }
+    static const char* Description() {
+        return "Call to get a shared spatial index (kd-tree) over particle positions";
+    }
+    static unsigned int FunctionCount() {
+        return 2;
+    }
+    static const char* FunctionName(unsigned int idx) {
+        switch (idx) {
+        case GET_DATA:
+            return "GetData";
+        case GET_EXTENT:
+            return "GetExtent";
+        }
+        return "";
+    }
+
+    /** ctor */
+    SpatialIndexDataCall();
+    /** dtor */
+    ~SpatialIndexDataCall() override;
+
+    /** Answer the index, may be nullptr if no data is available */
+    inline std::shared_ptr<const SpatialIndex> const& GetIndex() const {
+        return index;
+    }
+
+    /** Sets the index. The call shares ownership */
+    inline void SetIndex(std::shared_ptr<const SpatialIndex> idx) {
+        index = std::move(idx);
+    }
+
+private:
+    std::shared_ptr<const SpatialIndex> index;
+};
+
+/** Description typedef */
+typedef core::factories::CallAutoDescription<SpatialIndexDataCall> SpatialIndexDataCallDescription;
+
+} // namespace megamol::datatools
@@ -0,0 +1,269 @@
+/*
+ * ColumnarTableDataCall.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "datatools/table/TableDataCall.h"
+#include "mmcore/factories/CallAutoDescription.h"
+#include "mmstd/data/AbstractGetDataCall.h"
+
+namespace megamol::datatools::table {
+
+/**
+ * Call for passing around tabular data stored column by column.
+ *
+ * In contrast to TableDataCall, every column is an individual, typed buffer
+ * that may be strided, so a row-major table can be exposed without copying.
+ * An optional selection vector maps the rows seen by the consumer to rows of
+ * the underlying columns, which allows filters and sorters to emit index
+ * vectors instead of deep copies. The call does not own any of the memory.
+ */
+class ColumnarTableDataCall : public core::AbstractGetDataCall {
+public:
+    static const char* ClassName() {
+        return "ColumnarTableDataCall";
+    }
+    static const char* Description() {
+        return "Data of a table with typed columns and an optional row selection";
+    }
+    static unsigned int FunctionCount() {
+        return 2;
+    }
+    static const char* FunctionName(unsigned int idx) {
+        switch (idx) {
+        case 0:
+            return "GetData";
+        case 1:
+            return "GetHash";
+        }
+        return nullptr;
+    }
+
+    typedef TableDataCall::ColumnType ColumnType;
+    typedef TableDataCall::ColumnInfo ColumnInfo;
+
+    /** The type of the values stored in a column */
+    enum class ScalarType { FLOAT, DOUBLE, INT32, INT64 };
+
+    /**
+     * A typed, possibly strided view of the values of one column.
+     */
+    class Column {
+    public:
+        Column() : info(), type(ScalarType::FLOAT), data(nullptr), stride(0), categories(nullptr) {}
+
+        /**
+         * Ctor.
+         *
+         * @param info   The name, semantic type and value range of the column.
+         * @param type   The type of the values.
+         * @param data   Pointer to the value of the first row.
+         * @param stride The distance between two rows in bytes, 0 for packed values.
+         */
+        Column(const ColumnInfo& info, ScalarType type, const void* data, size_t stride = 0)
+                : info(info)
+                , type(type)
+                , data(static_cast<const uint8_t*>(data))
+                , stride(stride == 0 ? ScalarSize(type) : stride)
+                , categories(nullptr) {}
+
+        inline const ColumnInfo& Info() const {
+            return info;
+        }
+        inline ScalarType Type() const {
+            return type;
+        }
+        inline const void* Data() const {
+            return data;
+        }
+        inline size_t Stride() const {
+            return stride;
+        }
+        inline bool IsPacked() const {
+            return stride == ScalarSize(type);
+        }
+
+        /** Answer the value of the given row of the underlying buffer converted to T */
+        template<class T>
+        inline T Get(size_t row) const {
+            const uint8_t* p = data + row * stride;
+            switch (type) {
+            case ScalarType::FLOAT:
+                return static_cast<T>(*reinterpret_cast<const float*>(p));
+            case ScalarType::DOUBLE:
+                return static_cast<T>(*reinterpret_cast<const double*>(p));
+            case ScalarType::INT32:
+                return static_cast<T>(*reinterpret_cast<const int32_t*>(p));
+            case ScalarType::INT64:
+                return static_cast<T>(*reinterpret_cast<const int64_t*>(p));
+            }
+            return T();
+        }
+
+        /**
+         * Sets the names of the categories of a categorical column, the values
+         * of which are indices into 'names'. The column does not own 'names'.
+         */
+        inline Column& SetCategories(const std::vector<std::string>* names) {
+            categories = names;
+            return *this;
+        }
+
+        /** Answer the name of the category of the given row, or an empty string */
+        inline std::string CategoryName(size_t row) const {
+            if (categories == nullptr) {
+                return std::string();
+            }
+            const auto code = Get<int64_t>(row);
+            return ((code >= 0) && (static_cast<size_t>(code) < categories->size())) ? (*categories)[code]
+                                                                                       : std::string();
+        }
+
+        /** Answer the size of one value of the given type in bytes */
+        static inline size_t ScalarSize(ScalarType t) {
+            switch (t) {
+            case ScalarType::FLOAT:
+            case ScalarType::INT32:
+                return 4;
+            case ScalarType::DOUBLE:
+            case ScalarType::INT64:
+                return 8;
+            }
+            return 0;
+        }
+
+    private:
+        VISLIB_MSVC_SUPPRESS_WARNING(4251)
+        ColumnInfo info;
+        ScalarType type;
+        const uint8_t* data;
+        size_t stride;
+        const std::vector<std::string>* categories;
+    };
+
+    ColumnarTableDataCall();
+    ~ColumnarTableDataCall() override;
+
+    inline size_t GetColumnsCount() const {
+        return columns_count;
+    }
+
+    /** Answer the number of visible rows, i.e. the size of the selection if there is one */
+    inline size_t GetRowsCount() const {
+        return (selection != nullptr) ? selection_count : rows_count;
+    }
+
+    /** Answer the number of rows of the underlying columns */
+    inline size_t GetBaseRowsCount() const {
+        return rows_count;
+    }
+
+    inline const Column* GetColumns() const {
+        return columns;
+    }
+
+    inline const Column& GetColumn(size_t col) const {
+        assert(col < columns_count);
+        return columns[col];
+    }
+
+    /** Answer the index of the column with the given name, or -1 */
+    inline size_t FindColumn(const std::string& name) const {
+        for (size_t i = 0; i < columns_count; ++i) {
+            if (columns[i].Info().Name() == name) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    inline bool HasSelection() const {
+        return selection != nullptr;
+    }
+
+    inline const size_t* GetSelection() const {
+        return selection;
+    }
+
+    /** Answer the row of the underlying columns a visible row refers to */
+    inline size_t BaseRow(size_t row) const {
+        assert(row < GetRowsCount());
+        return (selection != nullptr) ? selection[row] : row;
+    }
+
+    /** Answer the value of a visible cell converted to T */
+    template<class T>
+    inline T GetData(size_t col, size_t row) const {
+        return GetColumn(col).template Get<T>(BaseRow(row));
+    }
+
+    inline void Set(size_t col_cnt, size_t row_cnt, const Column* cols) {
+        columns_count = col_cnt;
+        rows_count = row_cnt;
+        columns = cols;
+    }
+
+    /**
+     * Restricts the visible rows to the given indices into the underlying
+     * columns. Passing nullptr makes all rows visible.
+     */
+    inline void SetSelection(const size_t* sel, size_t sel_cnt) {
+        selection = sel;
+        selection_count = (sel != nullptr) ? sel_cnt : 0;
+    }
+
+    inline void SetFrameCount(const unsigned int frameCount) {
+        this->frameCount = frameCount;
+    }
+
+    inline unsigned int GetFrameCount() const {
+        return this->frameCount;
+    }
+
+    inline void SetFrameID(const unsigned int frameID) {
+        this->frameID = frameID;
+    }
+
+    inline unsigned int GetFrameID() const {
+        return this->frameID;
+    }
+
+    /**
+     * Creates zero-copy column views of a row-major float table.
+     *
+     * @param src     The table, the data of which must outlive the views.
+     * @param outCols Receives one strided column per table column.
+     */
+    static void WrapTable(const TableDataCall& src, std::vector<Column>& outCols);
+
+    /**
+     * Copies the visible rows into a row-major float table as used by
+     * TableDataCall.
+     *
+     * @param outInfos  Receives the column infos.
+     * @param outValues Receives the values of the visible rows.
+     */
+    void Materialize(std::vector<ColumnInfo>& outInfos, std::vector<float>& outValues) const;
+
+private:
+    size_t columns_count;
+    size_t rows_count;
+    const Column* columns;
+    const size_t* selection;
+    size_t selection_count;
+    unsigned int frameCount;
+    unsigned int frameID;
+};
+
+typedef core::factories::CallAutoDescription<ColumnarTableDataCall> ColumnarTableDataCallDescription;
+
+} // namespace megamol::datatools::table
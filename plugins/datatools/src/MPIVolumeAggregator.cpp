@@ -8,8 +8,11 @@
 #include "cluster/mpi/MpiCall.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/IntParam.h"
 #include "vislib/sys/SystemInformation.h"
+#include <algorithm>
 #include <chrono>
+#include <limits>
 
 using namespace megamol;
 
@@ -20,7 +23,8 @@ using namespace megamol;
 datatools::MPIVolumeAggregator::MPIVolumeAggregator()
         : AbstractVolumeManipulator("outData", "indata")
         , callRequestMpi("requestMpi", "Requests initialisation of MPI and the communicator for the view.")
-        , operatorSlot("operator", "the operator to apply to the volume when aggregating") {
+        , operatorSlot("operator", "the operator to apply to the volume when aggregating")
+        , chunkSizeSlot("chunkSize", "the size of the parts of the volume that are reduced at once in MB") {
 
     this->callRequestMpi.SetCompatibleCall<core::cluster::mpi::MpiCallDescription>();
     this->MakeSlotAvailable(&this->callRequestMpi);
@@ -32,6 +36,9 @@ datatools::MPIVolumeAggregator::MPIVolumeAggregator()
     ep->SetTypePair(3, "Product");
     this->operatorSlot << ep;
     this->MakeSlotAvailable(&this->operatorSlot);
+
+    this->chunkSizeSlot << new core::param::IntParam(64, 1);
+    this->MakeSlotAvailable(&this->chunkSizeSlot);
 }
 
 
@@ -89,12 +96,9 @@ bool datatools::MPIVolumeAggregator::manipulateData(
     }
 
     const size_t numFloats = comp * metadata.Resolution[0] * metadata.Resolution[1] * metadata.Resolution[2];
-    // we need a copy of the data since we must not alter it.
-    std::vector<float> tmpVolume;
-    tmpVolume.resize(numFloats);
-    memcpy(tmpVolume.data(), inData.GetData(), numFloats * sizeof(float));
-    // and a copy to receive the result
+    // the input must not be altered, so the result is reduced in place in our own copy
     this->theVolume.resize(numFloats);
+    memcpy(this->theVolume.data(), inData.GetData(), numFloats * sizeof(float));
 
     MPI_Op op = MPI_SUM;
     const auto opVal = this->operatorSlot.Param<core::param::EnumParam>()->Value();
@@ -126,31 +130,57 @@ bool datatools::MPIVolumeAggregator::manipulateData(
     megamol::core::utility::log::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: starting Allreduce");
     const auto startTime = std::chrono::high_resolution_clock::now();
 
-    MPI_Allreduce(tmpVolume.data(), this->theVolume.data(), numFloats, MPI_FLOAT, op, this->comm);
+    // chunks hold whole voxels and stay below the int count of MPI
+    size_t chunkSize = (static_cast<size_t>(this->chunkSizeSlot.Param<core::param::IntParam>()->Value()) << 20) /
+                       sizeof(float);
+    chunkSize = std::min<size_t>(chunkSize, std::numeric_limits<int>::max());
+    chunkSize = std::max<size_t>(chunkSize - chunkSize % comp, comp);
 
-    const auto endTime = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<float, std::milli> diffMillis = endTime - startTime;
+    // each rank computes the range of its share of whole voxels, which is merged after the reduction
+    const size_t numVoxels = numFloats / comp;
+    const size_t share = ((numVoxels + this->mpiSize - 1) / this->mpiSize) * comp;
+    const size_t shareBegin = std::min(static_cast<size_t>(this->mpiRank) * share, numFloats);
+    const size_t shareEnd = std::min(shareBegin + share, numFloats);
 
-    const int chunkSize = (numFloats) / this->mpiSize + 1;
     float min = std::numeric_limits<float>::max();
-    float max = 0.0f;
-    float globalmin = min;
-    float globalmax = max;
-    const int end = std::min<int>((this->mpiRank + 1) * chunkSize, numFloats);
-    for (int x = this->mpiRank * chunkSize; x < end; x += comp) {
-        auto& d = this->theVolume.data()[x];
-        if (d < min) {
-            min = d;
+    float max = std::numeric_limits<float>::lowest();
+    auto scanChunk = [this, chunkSize, numFloats, comp, shareBegin, shareEnd, &min, &max](size_t begin) {
+        const auto end = std::min({begin + chunkSize, numFloats, shareEnd});
+        for (size_t x = std::max(begin, shareBegin); x < end; x += comp) {
+            const auto d = this->theVolume[x];
+            min = std::min(min, d);
+            max = std::max(max, d);
         }
-        if (d > max) {
-            max = d;
+    };
+
+    // the share of the reduced chunk is scanned while the next chunk is being reduced
+    MPI_Request request = MPI_REQUEST_NULL;
+    size_t pending = numFloats;
+    for (size_t begin = 0; begin < numFloats; begin += chunkSize) {
+        const auto cnt = static_cast<int>(std::min(chunkSize, numFloats - begin));
+        MPI_Request next;
+        MPI_Iallreduce(MPI_IN_PLACE, this->theVolume.data() + begin, cnt, MPI_FLOAT, op, this->comm, &next);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        if (pending < numFloats) {
+            scanChunk(pending);
         }
+        request = next;
+        pending = begin;
+    }
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    if (pending < numFloats) {
+        scanChunk(pending);
     }
 
     // now make min max global
+    float globalmin = min;
+    float globalmax = max;
     MPI_Allreduce(&min, &globalmin, 1, MPI_FLOAT, MPI_MIN, this->comm);
     MPI_Allreduce(&max, &globalmax, 1, MPI_FLOAT, MPI_MAX, this->comm);
 
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<float, std::milli> diffMillis = endTime - startTime;
+
     const auto endAllTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffAllMillis = endAllTime - startAllTime;
     megamol::core::utility::log::Log::DefaultLog.WriteInfo(
@@ -18,9 +18,10 @@ namespace megamol::datatools {
 
 /**
  * Module aggregating the density of several identically-sized volumes over MPI.
- * This should be used for gathering large in situ SUBSAMPLED (ParticleThinner) data sets:
- * Everything is collected at once and MPI cannot push that much data
- * at once.
+ * The volume is reduced in place in chunks of limited size, so neither a
+ * second copy of the volume nor a single huge collective is required. Each
+ * rank computes the value range of its share of the volume while the next
+ * chunk is reduced, the ranges are merged afterwards.
  */
 class MPIVolumeAggregator : public AbstractVolumeManipulator {
 public:
@@ -76,6 +77,8 @@ private:
 
     core::param::ParamSlot operatorSlot;
 
+    core::param::ParamSlot chunkSizeSlot;
+
     geocalls::VolumetricDataCall::Metadata metadata;
 
     int mpiRank = 0;
@@ -6,13 +6,16 @@
  */
 #include "ParticleIColGradientField.h"
 #include "datatools/MultiParticleDataAdaptor.h"
+#include "datatools/SpatialIndexDataCall.h"
 
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/utility/log/Log.h"
 #include "vislib/math/ShallowPoint.h"
 #include "vislib/math/Vector.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <nanoflann.hpp>
 #include <utility>
 
@@ -25,12 +28,16 @@ using namespace megamol;
 datatools::ParticleIColGradientField::ParticleIColGradientField()
         : AbstractParticleManipulator("outData", "indata")
         , radiusSlot("radius", "The neighbourhood radius size")
+        , inIndexSlot("inIndex", "Optionally takes a shared spatial index of the same data")
         , datahash(0)
         , time(0)
         , newColors() {
 
     this->radiusSlot.SetParameter(new core::param::FloatParam(0.05f, 0.000001f));
     this->MakeSlotAvailable(&this->radiusSlot);
+
+    this->inIndexSlot.SetCompatibleCall<SpatialIndexDataCallDescription>();
+    this->MakeSlotAvailable(&this->inIndexSlot);
 }
 
 
@@ -133,13 +140,37 @@ void datatools::ParticleIColGradientField::compute_colors(geocalls::MultiParticl
     this->newColors.resize(data.kdtree_get_point_count() /* * 3*/);
     float rad = this->radiusSlot.Param<core::param::FloatParam>()->Value();
 
+    // prefer the shared index over building our own tree. it must number the particles like the adapter and must
+    // not wrap around the boundaries, as this module does not
+    std::shared_ptr<const SpatialIndex> sharedIndex;
+    auto* indexCall = this->inIndexSlot.CallAs<SpatialIndexDataCall>();
+    if (indexCall != nullptr) {
+        std::vector<size_t> listCounts(dat.GetParticleListCount());
+        for (unsigned int pli = 0; pli < listCounts.size(); ++pli) {
+            listCounts[pli] = data.get_list_count(pli);
+        }
+        indexCall->SetFrameID(dat.FrameID(), true);
+        if ((*indexCall)(SpatialIndexDataCall::GET_DATA) && (indexCall->GetIndex() != nullptr) &&
+            indexCall->GetIndex()->Matches(listCounts) &&
+            (indexCall->GetIndex()->Periodic() == std::array<bool, 3>{false, false, false})) {
+            sharedIndex = indexCall->GetIndex();
+        } else {
+            megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                "ParticleIColGradientField: shared index unusable for frame %u, building own tree", dat.FrameID());
+        }
+    }
+
     // construct a kd-tree index:
     typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<float, DataAdapter>, DataAdapter,
         3 /* dim */, std::size_t>
         my_kd_tree_t;
 
-    my_kd_tree_t index(3 /*dim*/, data, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
-    index.buildIndex();
+    std::unique_ptr<my_kd_tree_t> index;
+    if (sharedIndex == nullptr) {
+        index = std::make_unique<my_kd_tree_t>(
+            3 /*dim*/, data, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+        index->buildIndex();
+    }
 
     double maxLen = 0.0;
 
@@ -154,7 +185,11 @@ void datatools::ParticleIColGradientField::compute_colors(geocalls::MultiParticl
         const float* query_col = data.get_color(part_i);
 
         res.clear();
-        index.radiusSearch(query_pos.PeekCoordinates(), rad, res, nanoflann::SearchParams(10, 0.01f, false));
+        if (sharedIndex != nullptr) {
+            sharedIndex->FindInRadius(query_pos.PeekCoordinates(), rad, res);
+        } else {
+            index->radiusSearch(query_pos.PeekCoordinates(), rad, res, nanoflann::SearchParams(10, 0.01f, false));
+        }
 
         vislib::math::Vector<double, 3> gradient;
 
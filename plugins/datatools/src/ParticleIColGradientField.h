@@ -8,6 +8,7 @@
 #pragma once
 
 #include "datatools/AbstractParticleManipulator.h"
+#include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
 #include <vector>
 
@@ -59,6 +60,9 @@ private:
     void set_colors(geocalls::MultiParticleDataCall& dat);
 
     core::param::ParamSlot radiusSlot;
+
+    /** The slot accessing an optional shared spatial index of the original data */
+    core::CallerSlot inIndexSlot;
     size_t datahash;
     unsigned int time;
     std::vector<float> newColors;
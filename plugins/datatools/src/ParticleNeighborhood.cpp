@@ -5,6 +5,7 @@
  * Alle Rechte vorbehalten.
  */
 #include "ParticleNeighborhood.h"
+#include "datatools/SpatialIndexDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
@@ -30,13 +31,16 @@ datatools::ParticleNeighborhood::ParticleNeighborhood()
         , particleNumberSlot("idx", "the particle to track")
         , outDataSlot("outData", "Provides colors based on local particle temperature")
         , inDataSlot("inData", "Takes the directional particle data")
+        , inIndexSlot("inIndex", "Optionally takes a shared spatial index of the same data")
         , datahash(0)
         , lastTime(-1)
         , newColors()
         , maxDist(0)
         , allParts()
         , particleTree(nullptr)
-        , myPts(nullptr) {
+        , myPts(nullptr)
+        , sharedIndex(nullptr)
+        , listOffsets() {
 
     this->cyclXSlot.SetParameter(new core::param::BoolParam(true));
     this->MakeSlotAvailable(&this->cyclXSlot);
@@ -70,6 +74,9 @@ datatools::ParticleNeighborhood::ParticleNeighborhood()
 
     this->inDataSlot.SetCompatibleCall<geocalls::MultiParticleDataCallDescription>();
     this->MakeSlotAvailable(&this->inDataSlot);
+
+    this->inIndexSlot.SetCompatibleCall<SpatialIndexDataCallDescription>();
+    this->MakeSlotAvailable(&this->inIndexSlot);
 }
 
 
@@ -163,7 +170,9 @@ bool datatools::ParticleNeighborhood::assertData(
 
         // we could now filter particles according to something. but currently we need not.
         size_t allpartcnt = 0;
+        listOffsets.assign(plc, 0);
         for (unsigned int pli = 0; pli < plc; pli++) {
+            listOffsets[pli] = allpartcnt;
             if (!isListOK(in, pli)) {
                 continue;
             }
@@ -180,9 +189,22 @@ bool datatools::ParticleNeighborhood::assertData(
         assert(allpartcnt == totalParts);
 
         this->myPts = std::make_shared<simplePointcloud>(inMpdc, allParts);
-        particleTree = std::make_shared<my_kd_tree_t>(
-            3 /* dim */, *myPts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
-        particleTree->buildIndex();
+
+        // prefer the shared index over building our own tree
+        this->sharedIndex.reset();
+        auto* indexCall = this->inIndexSlot.CallAs<SpatialIndexDataCall>();
+        if (indexCall != nullptr) {
+            indexCall->SetFrameID(time, true);
+            if ((*indexCall)(SpatialIndexDataCall::GET_DATA) && (indexCall->GetIndex() != nullptr) &&
+                (indexCall->GetIndex()->ListCount() == plc)) {
+                this->sharedIndex = indexCall->GetIndex();
+            } else {
+                megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                    "ParticleNeighborhood: shared index unusable for frame %u, building own tree", time);
+            }
+        }
+        // our own tree is built on demand, i.e. when the shared index is missing or does not fit
+        particleTree.reset();
         this->datahash = in->DataHash();
         this->lastTime = time;
         this->radiusSlot.ForceSetDirty();
@@ -226,7 +248,37 @@ bool datatools::ParticleNeighborhood::assertData(
             ret_matches.clear();
             ret_matches.reserve(100);
 
-            for (int x_s = 0; x_s < (cycl_x ? 2 : 1); ++x_s) {
+            // the shared index handles the periodic boundary conditions itself, but only its own
+            bool const useSharedIndex = (this->sharedIndex != nullptr) &&
+                                        (this->sharedIndex->Periodic() == std::array<bool, 3>{cycl_x, cycl_y, cycl_z});
+            if ((this->sharedIndex != nullptr) && !useSharedIndex) {
+                megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                    "ParticleNeighborhood: cyclic boundary conditions differ from those of the shared index, "
+                    "building own tree");
+            }
+            if (!useSharedIndex && (particleTree == nullptr)) {
+                particleTree = std::make_shared<my_kd_tree_t>(
+                    3 /* dim */, *myPts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+                particleTree->buildIndex();
+            }
+
+            if (useSharedIndex) {
+                if (theSearchType == searchTypeEnum::RADIUS) {
+                    this->sharedIndex->FindInRadius(vbase, theRadius, ret_localMatches);
+                } else {
+                    this->sharedIndex->FindNearest(vbase, theNumber, ret_localMatches);
+                }
+                // translate from the index numbering to ours, which skips unusable lists
+                for (auto const& m : ret_localMatches) {
+                    unsigned int const l = this->sharedIndex->ListOf(m.first);
+                    if (isListOK(in, l)) {
+                        size_t const localIdx = m.first - this->sharedIndex->ListOffset(l);
+                        ret_matches.emplace_back(listOffsets[l] + localIdx, m.second);
+                    }
+                }
+            }
+
+            for (int x_s = 0; !useSharedIndex && (x_s < (cycl_x ? 2 : 1)); ++x_s) {
                 for (int y_s = 0; y_s < (cycl_y ? 2 : 1); ++y_s) {
                     for (int z_s = 0; z_s < (cycl_z ? 2 : 1); ++z_s) {
 
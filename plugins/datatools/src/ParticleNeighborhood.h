@@ -8,6 +8,7 @@
 #pragma once
 
 #include "datatools/PointcloudHelpers.h"
+#include "datatools/SpatialIndex.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
@@ -93,11 +94,20 @@ private:
     std::shared_ptr<my_kd_tree_t> particleTree;
     std::shared_ptr<simplePointcloud> myPts;
 
+    /** The shared index, if one is connected */
+    std::shared_ptr<const SpatialIndex> sharedIndex;
+
+    /** Offsets of the usable lists into 'newColors', indexed by list */
+    std::vector<size_t> listOffsets;
+
     /** The slot providing access to the manipulated data */
     megamol::core::CalleeSlot outDataSlot;
 
     /** The slot accessing the original data */
     megamol::core::CallerSlot inDataSlot;
+
+    /** The optional slot accessing a shared spatial index of the same data */
+    megamol::core::CallerSlot inIndexSlot;
 };
 
 } // namespace megamol::datatools
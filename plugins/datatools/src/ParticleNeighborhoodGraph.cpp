@@ -1,12 +1,14 @@
 #include "ParticleNeighborhoodGraph.h"
 #include "datatools/GraphDataCall.h"
 #include "datatools/MultiParticleDataAdaptor.h"
+#include "datatools/SpatialIndexDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmcore/utility/log/Log.h"
 #include "vislib/math/ShallowPoint.h"
 #include "vislib/math/ShallowVector.h"
+#include <array>
 #include <cfloat>
 #include <chrono>
 #include <omp.h>
@@ -20,6 +22,7 @@ ParticleNeighborhoodGraph::ParticleNeighborhoodGraph()
         : Module()
         , outGraphDataSlot("outGraphData", "Publishes graph edge data")
         , inParticleDataSlot("inParticle", "Fetches particle data")
+        , inIndexSlot("inIndex", "Optionally takes a shared spatial index of the same data")
         , radiusSlot("radius", "The neighborhood radius")
         , autoRadiusSlot("autoRadius::detect", "Flag to automatically assess the neighborhood radius")
         , autoRadiusSamplesSlot("autoRadius::samples", "Number of samples to determine the neighborhood radius")
@@ -46,6 +49,9 @@ ParticleNeighborhoodGraph::ParticleNeighborhoodGraph()
     inParticleDataSlot.SetCompatibleCall<geocalls::MultiParticleDataCallDescription>();
     MakeSlotAvailable(&inParticleDataSlot);
 
+    inIndexSlot.SetCompatibleCall<SpatialIndexDataCallDescription>();
+    MakeSlotAvailable(&inIndexSlot);
+
     autoRadiusSlot.SetParameter(new core::param::BoolParam(true));
     MakeSlotAvailable(&autoRadiusSlot);
 
@@ -176,6 +182,32 @@ struct graph_component {
 
 } // namespace
 
+std::shared_ptr<const SpatialIndex> ParticleNeighborhoodGraph::getSharedIndex(
+    geocalls::MultiParticleDataCall* data) {
+    auto* indexCall = inIndexSlot.CallAs<SpatialIndexDataCall>();
+    if (indexCall == nullptr)
+        return nullptr;
+
+    datatools::MultiParticleDataAdaptor d(*data);
+    std::vector<size_t> listCounts(data->GetParticleListCount());
+    for (unsigned int pli = 0; pli < listCounts.size(); ++pli) {
+        listCounts[pli] = d.get_list_count(pli);
+    }
+    // the index handles the periodic boundary conditions itself, but only its own
+    std::array<bool, 3> const cyclic = {boundaryXCyclicSlot.Param<core::param::BoolParam>()->Value(),
+        boundaryYCyclicSlot.Param<core::param::BoolParam>()->Value(),
+        boundaryZCyclicSlot.Param<core::param::BoolParam>()->Value()};
+
+    indexCall->SetFrameID(data->FrameID(), true);
+    if ((*indexCall)(SpatialIndexDataCall::GET_DATA) && (indexCall->GetIndex() != nullptr) &&
+        indexCall->GetIndex()->Matches(listCounts) && (indexCall->GetIndex()->Periodic() == cyclic)) {
+        return indexCall->GetIndex();
+    }
+    megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+        "PNhG: shared index unusable for frame %u, using own search grid", data->FrameID());
+    return nullptr;
+}
+
 void ParticleNeighborhoodGraph::calcData(geocalls::MultiParticleDataCall* data) {
     datatools::MultiParticleDataAdaptor d(*data);
     if (d.get_count() < 1)
@@ -184,6 +216,8 @@ void ParticleNeighborhoodGraph::calcData(geocalls::MultiParticleDataCall* data)
     using std::chrono::high_resolution_clock;
     high_resolution_clock::time_point start = high_resolution_clock::now(), end;
 
+    auto const sharedIndex = this->getSharedIndex(data);
+
     float neiRad = this->radiusSlot.Param<core::param::FloatParam>()->Value();
     if (this->autoRadiusSlot.Param<core::param::BoolParam>()->Value()) {
         // automatically select a neighborhood radius
@@ -202,7 +236,16 @@ void ParticleNeighborhoodGraph::calcData(geocalls::MultiParticleDataCall* data)
 
             float min_dist = FLT_MAX;
 
-            for (size_t i = 0; i < d.get_count(); ++i) {
+            if (sharedIndex != nullptr) {
+                // the closest match is the sample itself
+                std::vector<SpatialIndex::match_t> matches;
+                sharedIndex->FindNearest(d.get_position(sample_idx), 2, matches);
+                for (auto const& m : matches) {
+                    if ((m.first != sample_idx) && (m.second < min_dist))
+                        min_dist = m.second;
+                }
+            }
+            for (size_t i = 0; (sharedIndex == nullptr) && (i < d.get_count()); ++i) {
                 if (i == sample_idx)
                     continue;
                 vislib::math::ShallowPoint<float, 3> pt(const_cast<float*>(d.get_position(i)));
@@ -229,6 +272,36 @@ void ParticleNeighborhoodGraph::calcData(geocalls::MultiParticleDataCall* data)
     }
     float neiRadSq = neiRad * neiRad;
 
+    if (sharedIndex != nullptr) {
+        // the index replaces the search grid, each thread collects its edges from small to large indices
+        int64_t const cnt = static_cast<int64_t>(d.get_count());
+        std::vector<std::vector<index_t>> threadEdges(omp_get_max_threads());
+#pragma omp parallel
+        {
+            auto& localEdges = threadEdges[omp_get_thread_num()];
+            std::vector<SpatialIndex::match_t> matches;
+#pragma omp for schedule(dynamic, 1024)
+            for (int64_t i = 0; i < cnt; ++i) {
+                sharedIndex->FindInRadius(d.get_position(i), neiRadSq, matches);
+                for (auto const& m : matches) {
+                    if (m.first > static_cast<size_t>(i)) {
+                        localEdges.push_back(static_cast<index_t>(i));
+                        localEdges.push_back(static_cast<index_t>(m.first));
+                    }
+                }
+            }
+        }
+        for (auto const& localEdges : threadEdges) {
+            edges.insert(edges.end(), localEdges.begin(), localEdges.end());
+        }
+        edges.shrink_to_fit();
+
+        end = high_resolution_clock::now();
+        megamol::core::utility::log::Log::DefaultLog.WriteInfo("PNhG edges computed from shared index in %u ms",
+            std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+        return;
+    }
+
     vislib::math::Cuboid<float> box(vislib::math::ShallowPoint<float, 3>(const_cast<float*>(d.get_position(0))),
         vislib::math::Dimension<float, 3>(0.0f, 0.0f, 0.0f));
     for (size_t i = 1; i < d.get_count(); ++i) {
@@ -6,6 +6,7 @@
  */
 #pragma once
 
+#include "datatools/SpatialIndex.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
@@ -48,8 +49,12 @@ protected:
 private:
     void calcData(geocalls::MultiParticleDataCall* data);
 
+    /** Answers the shared index if one is connected and numbers the particles like the adaptor does */
+    std::shared_ptr<const SpatialIndex> getSharedIndex(geocalls::MultiParticleDataCall* data);
+
     core::CalleeSlot outGraphDataSlot;
     core::CallerSlot inParticleDataSlot;
+    core::CallerSlot inIndexSlot;
     core::param::ParamSlot radiusSlot;
     core::param::ParamSlot autoRadiusSlot;
     core::param::ParamSlot autoRadiusSamplesSlot;
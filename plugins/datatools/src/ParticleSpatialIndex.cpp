@@ -0,0 +1,218 @@
+/*
+ * ParticleSpatialIndex.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#include "ParticleSpatialIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+
+#include "datatools/SpatialIndexDataCall.h"
+#include "geometry_calls/MultiParticleDataCall.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/log/Log.h"
+
+using namespace megamol;
+
+
+/*
+ * datatools::ParticleSpatialIndex::ParticleSpatialIndex
+ */
+datatools::ParticleSpatialIndex::ParticleSpatialIndex()
+        : cyclXSlot("cyclX", "Considers cyclic boundary conditions in X direction")
+        , cyclYSlot("cyclY", "Considers cyclic boundary conditions in Y direction")
+        , cyclZSlot("cyclZ", "Considers cyclic boundary conditions in Z direction")
+        , maxLeafSizeSlot("maxLeafSize", "Maximum number of particles in a leaf of the kd-tree")
+        , cacheSizeSlot("cacheSize", "Number of frames for which the index is kept")
+        , cache()
+        , inHash(std::numeric_limits<size_t>::max())
+        , outHash(0)
+        , outIndexSlot("outIndex", "Provides the spatial index")
+        , inDataSlot("inData", "Takes the particle data") {
+
+    this->cyclXSlot.SetParameter(new core::param::BoolParam(true));
+    this->MakeSlotAvailable(&this->cyclXSlot);
+
+    this->cyclYSlot.SetParameter(new core::param::BoolParam(true));
+    this->MakeSlotAvailable(&this->cyclYSlot);
+
+    this->cyclZSlot.SetParameter(new core::param::BoolParam(true));
+    this->MakeSlotAvailable(&this->cyclZSlot);
+
+    this->maxLeafSizeSlot.SetParameter(new core::param::IntParam(10, 1));
+    this->MakeSlotAvailable(&this->maxLeafSizeSlot);
+
+    this->cacheSizeSlot.SetParameter(new core::param::IntParam(2, 1));
+    this->MakeSlotAvailable(&this->cacheSizeSlot);
+
+    this->outIndexSlot.SetCallback(SpatialIndexDataCall::ClassName(),
+        SpatialIndexDataCall::FunctionName(SpatialIndexDataCall::GET_DATA), &ParticleSpatialIndex::getDataCallback);
+    this->outIndexSlot.SetCallback(SpatialIndexDataCall::ClassName(),
+        SpatialIndexDataCall::FunctionName(SpatialIndexDataCall::GET_EXTENT),
+        &ParticleSpatialIndex::getExtentCallback);
+    this->MakeSlotAvailable(&this->outIndexSlot);
+
+    this->inDataSlot.SetCompatibleCall<geocalls::MultiParticleDataCallDescription>();
+    this->MakeSlotAvailable(&this->inDataSlot);
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::~ParticleSpatialIndex
+ */
+datatools::ParticleSpatialIndex::~ParticleSpatialIndex() {
+    this->Release();
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::create
+ */
+bool datatools::ParticleSpatialIndex::create() {
+    return true;
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::release
+ */
+void datatools::ParticleSpatialIndex::release() {
+    this->cache.clear();
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::checkParams
+ */
+void datatools::ParticleSpatialIndex::checkParams() {
+    if (this->cyclXSlot.IsDirty() || this->cyclYSlot.IsDirty() || this->cyclZSlot.IsDirty() ||
+        this->maxLeafSizeSlot.IsDirty()) {
+        this->cyclXSlot.ResetDirty();
+        this->cyclYSlot.ResetDirty();
+        this->cyclZSlot.ResetDirty();
+        this->maxLeafSizeSlot.ResetDirty();
+        this->cache.clear();
+        this->outHash++;
+    }
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::updateHash
+ */
+void datatools::ParticleSpatialIndex::updateHash(size_t inDataHash) {
+    if (inDataHash != this->inHash) {
+        this->inHash = inDataHash;
+        this->cache.clear();
+        this->outHash++;
+    }
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::getExtentCallback
+ */
+bool datatools::ParticleSpatialIndex::getExtentCallback(megamol::core::Call& c) {
+    using geocalls::MultiParticleDataCall;
+
+    auto* out = dynamic_cast<SpatialIndexDataCall*>(&c);
+    if (out == nullptr)
+        return false;
+
+    auto* in = this->inDataSlot.CallAs<MultiParticleDataCall>();
+    if (in == nullptr)
+        return false;
+
+    in->SetFrameID(out->FrameID(), true);
+    if (!(*in)(1)) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "ParticleSpatialIndex: could not get current frame extents (%u)", out->FrameID());
+        return false;
+    }
+    this->checkParams();
+    this->updateHash(in->DataHash());
+
+    out->AccessBoundingBoxes().SetObjectSpaceBBox(in->GetBoundingBoxes().ObjectSpaceBBox());
+    out->AccessBoundingBoxes().SetObjectSpaceClipBox(in->GetBoundingBoxes().ObjectSpaceClipBox());
+    out->SetFrameCount(in->FrameCount());
+    out->SetDataHash(this->outHash);
+    in->Unlock();
+
+    return true;
+}
+
+
+/*
+ * datatools::ParticleSpatialIndex::getDataCallback
+ */
+bool datatools::ParticleSpatialIndex::getDataCallback(megamol::core::Call& c) {
+    using geocalls::MultiParticleDataCall;
+    using megamol::core::utility::log::Log;
+
+    auto* out = dynamic_cast<SpatialIndexDataCall*>(&c);
+    if (out == nullptr)
+        return false;
+
+    auto* in = this->inDataSlot.CallAs<MultiParticleDataCall>();
+    if (in == nullptr)
+        return false;
+
+    unsigned int const time = out->FrameID();
+    in->SetFrameID(time, true);
+    if (!(*in)(1)) {
+        Log::DefaultLog.WriteError("ParticleSpatialIndex: could not get frame extents (%u)", time);
+        return false;
+    }
+    this->checkParams();
+    this->updateHash(in->DataHash());
+
+    auto it = std::find_if(this->cache.begin(), this->cache.end(),
+        [this, time](CacheEntry const& e) { return (e.dataHash == this->inHash) && (e.frameID == time); });
+    if (it != this->cache.end()) {
+        this->cache.splice(this->cache.begin(), this->cache, it);
+    } else {
+        if (!(*in)(0)) {
+            Log::DefaultLog.WriteError("ParticleSpatialIndex: could not get frame (%u)", time);
+            in->Unlock();
+            return false;
+        }
+        if (in->DataHash() != this->inHash) {
+            this->updateHash(in->DataHash());
+        }
+
+        std::array<bool, 3> const periodic = {this->cyclXSlot.Param<core::param::BoolParam>()->Value(),
+            this->cyclYSlot.Param<core::param::BoolParam>()->Value(),
+            this->cyclZSlot.Param<core::param::BoolParam>()->Value()};
+        unsigned int const leafSize =
+            static_cast<unsigned int>(this->maxLeafSizeSlot.Param<core::param::IntParam>()->Value());
+
+        auto const start = std::chrono::high_resolution_clock::now();
+        auto index = std::make_shared<const SpatialIndex>(*in, periodic, leafSize);
+        auto const duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        Log::DefaultLog.WriteInfo("ParticleSpatialIndex: built index over %zu particles of frame %u in %lld ms",
+            index->Count(), in->FrameID(), static_cast<long long>(duration.count()));
+
+        this->cache.push_front(CacheEntry{this->inHash, time, std::move(index)});
+        size_t const maxEntries = static_cast<size_t>(this->cacheSizeSlot.Param<core::param::IntParam>()->Value());
+        while (this->cache.size() > maxEntries) {
+            this->cache.pop_back();
+        }
+    }
+
+    out->SetIndex(this->cache.front().index);
+    out->AccessBoundingBoxes().SetObjectSpaceBBox(in->GetBoundingBoxes().ObjectSpaceBBox());
+    out->AccessBoundingBoxes().SetObjectSpaceClipBox(in->GetBoundingBoxes().ObjectSpaceClipBox());
+    out->SetFrameCount(in->FrameCount());
+    out->SetFrameID(time);
+    out->SetDataHash(this->outHash);
+    // the index holds a copy of the positions, the data is not needed anymore
+    in->Unlock();
+
+    return true;
+}
@@ -0,0 +1,95 @@
+/*
+ * ParticleSpatialIndex.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+
+#include "datatools/SpatialIndex.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+
+namespace megamol::datatools {
+
+/**
+ * Module building a kd-tree over incoming particle data once per data hash
+ * and frame, and sharing it with all connected consumers.
+ */
+class ParticleSpatialIndex : public megamol::core::Module {
+public:
+    /** Return module class name */
+    static const char* ClassName() {
+        return "ParticleSpatialIndex";
+    }
+
+    /** Return module class description */
+    static const char* Description() {
+        return "Builds a shared spatial index (kd-tree) over particle positions for neighbourhood queries.";
+    }
+
+    /** Module is always available */
+    static bool IsAvailable() {
+        return true;
+    }
+
+    /** Ctor */
+    ParticleSpatialIndex();
+
+    /** Dtor */
+    ~ParticleSpatialIndex() override;
+
+protected:
+    /** Lazy initialization of the module */
+    bool create() override;
+
+    /** Resource release */
+    void release() override;
+
+private:
+    /** Cached index of one frame */
+    struct CacheEntry {
+        size_t dataHash;
+        unsigned int frameID;
+        std::shared_ptr<const SpatialIndex> index;
+    };
+
+    bool getDataCallback(megamol::core::Call& c);
+
+    bool getExtentCallback(megamol::core::Call& c);
+
+    /** Drops the cache if a parameter influencing the index changed */
+    void checkParams();
+
+    /** Updates the outgoing data hash from the incoming one */
+    void updateHash(size_t inDataHash);
+
+    core::param::ParamSlot cyclXSlot;
+    core::param::ParamSlot cyclYSlot;
+    core::param::ParamSlot cyclZSlot;
+    core::param::ParamSlot maxLeafSizeSlot;
+    core::param::ParamSlot cacheSizeSlot;
+
+    /** Most recently used entries first */
+    std::list<CacheEntry> cache;
+
+    /** The last incoming data hash */
+    size_t inHash;
+
+    /** The outgoing data hash, changes with the incoming data and the parameters */
+    size_t outHash;
+
+    /** The slot providing the index */
+    megamol::core::CalleeSlot outIndexSlot;
+
+    /** The slot accessing the particle data */
+    megamol::core::CallerSlot inDataSlot;
+};
+
+} // namespace megamol::datatools
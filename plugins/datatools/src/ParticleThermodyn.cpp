@@ -5,6 +5,7 @@
  * Alle Rechte vorbehalten.
  */
 #include "ParticleThermodyn.h"
+#include "datatools/SpatialIndexDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
@@ -55,8 +56,11 @@ datatools::ParticleThermodyn::ParticleThermodyn()
         , maxDist(0.0f)
         , particleTree(nullptr)
         , myPts(nullptr)
+        , sharedIndex(nullptr)
+        , listOffsets()
         , outDataSlot("outData", "Provides intensities based on a local particle metric")
-        , inDataSlot("inData", "Takes the directional particle data") {
+        , inDataSlot("inData", "Takes the directional particle data")
+        , inIndexSlot("inIndex", "Optionally takes a shared spatial index of the same data") {
 
     this->cyclXSlot.SetParameter(new core::param::BoolParam(true));
     this->MakeSlotAvailable(&this->cyclXSlot);
@@ -130,6 +134,9 @@ datatools::ParticleThermodyn::ParticleThermodyn()
 
     this->inDataSlot.SetCompatibleCall<geocalls::MultiParticleDataCallDescription>();
     this->MakeSlotAvailable(&this->inDataSlot);
+
+    this->inIndexSlot.SetCompatibleCall<SpatialIndexDataCallDescription>();
+    this->MakeSlotAvailable(&this->inIndexSlot);
 }
 
 
@@ -240,8 +247,10 @@ bool datatools::ParticleThermodyn::assertData(
 
         // we could now filter particles according to something. but currently we need not.
         allpartcnt = 0;
+        listOffsets.assign(plc, 0);
         for (unsigned int pli = 0; pli < plc; pli++) {
             auto& pl = in->AccessParticles(pli);
+            listOffsets[pli] = allpartcnt;
             if (!isListOK(in, pli) || !isDirOK(static_cast<metricsEnum>(theMetrics), in, pli)) {
                 megamol::core::utility::log::Log::DefaultLog.WriteWarn(
                     "ParticleThermodyn: ignoring list %d because it either has no proper positions or no velocity",
@@ -268,12 +277,29 @@ bool datatools::ParticleThermodyn::assertData(
         assert(allpartcnt == totalParts);
         this->myPts = std::make_shared<simplePointcloud>(in, allParts);
 
-        megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-            "ParticleThermodyn: building acceleration structure for frame %u...", out->FrameID());
-        particleTree = std::make_shared<my_kd_tree_t>(
-            3 /* dim */, *myPts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
-        particleTree->buildIndex();
-        megamol::core::utility::log::Log::DefaultLog.WriteInfo("ParticleThermodyn: done.");
+        // prefer the shared index over building our own tree. it must not contain particles of the lists we skip,
+        // as these would take the place of actual neighbors
+        this->sharedIndex.reset();
+        auto* indexCall = this->inIndexSlot.CallAs<SpatialIndexDataCall>();
+        if (indexCall != nullptr) {
+            indexCall->SetFrameID(time, true);
+            bool usable = (*indexCall)(SpatialIndexDataCall::GET_DATA) && (indexCall->GetIndex() != nullptr) &&
+                          (indexCall->GetIndex()->ListCount() == plc);
+            for (unsigned int pli = 0; usable && (pli < plc); ++pli) {
+                auto const& index = *indexCall->GetIndex();
+                bool const listUsed = isListOK(in, pli) && isDirOK(static_cast<metricsEnum>(theMetrics), in, pli);
+                size_t const indexed = index.ListOffset(pli + 1) - index.ListOffset(pli);
+                usable = listUsed ? (indexed == in->AccessParticles(pli).GetCount()) : (indexed == 0);
+            }
+            if (usable) {
+                this->sharedIndex = indexCall->GetIndex();
+            } else {
+                megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                    "ParticleThermodyn: shared index unusable for frame %u, building own tree", time);
+            }
+        }
+        // our own tree is built on demand, i.e. when the shared index is missing or does not fit
+        particleTree.reset();
 
         this->datahash = in->DataHash();
         this->lastTime = time;
@@ -292,6 +318,23 @@ bool datatools::ParticleThermodyn::assertData(
         // bbox.EnforcePositiveSize(); // paranoia
         auto bbox_cntr = bbox.CalcCenter();
 
+        // the shared index handles the periodic boundary conditions itself, but only its own
+        bool const useSharedIndex = (this->sharedIndex != nullptr) &&
+                                    (this->sharedIndex->Periodic() == std::array<bool, 3>{cycl_x, cycl_y, cycl_z});
+        if ((this->sharedIndex != nullptr) && !useSharedIndex) {
+            megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                "ParticleThermodyn: cyclic boundary conditions differ from those of the shared index, "
+                "building own tree");
+        }
+        if (!useSharedIndex && (particleTree == nullptr)) {
+            megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+                "ParticleThermodyn: building acceleration structure for frame %u...", out->FrameID());
+            particleTree = std::make_shared<my_kd_tree_t>(
+                3 /* dim */, *myPts, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+            particleTree->buildIndex();
+            megamol::core::utility::log::Log::DefaultLog.WriteInfo("ParticleThermodyn: done.");
+        }
+
         megamol::core::utility::log::Log::DefaultLog.WriteInfo(
             "ParticleThermodyn: calculating thermodynamics for frame %u...", out->FrameID());
         vislib::sys::ConsoleProgressBar cpb;
@@ -352,7 +395,23 @@ bool datatools::ParticleThermodyn::assertData(
                     const float* vertexBase = this->myPts->get_position(myIndex);
                     // const float *velocityBase = this->myPts->get_velocity(myIndex);
 
-                    for (int x_s = 0; x_s < (cycl_x ? 2 : 1); ++x_s) {
+                    if (useSharedIndex) {
+                        if (theSearchType == searchTypeEnum::RADIUS) {
+                            this->sharedIndex->FindInRadius(vertexBase, theSquaredRadius + eps, ret_localMatches);
+                        } else {
+                            this->sharedIndex->FindNearest(vertexBase, theNumber, ret_localMatches);
+                        }
+                        // translate from the index numbering to ours, which skips unusable lists
+                        for (auto const& m : ret_localMatches) {
+                            unsigned int const l = this->sharedIndex->ListOf(m.first);
+                            size_t const idx = listOffsets[l] + (m.first - this->sharedIndex->ListOffset(l));
+                            if (!remove_self || idx != myIndex) {
+                                ret_matches.emplace_back(idx, m.second);
+                            }
+                        }
+                    }
+
+                    for (int x_s = 0; !useSharedIndex && (x_s < (cycl_x ? 2 : 1)); ++x_s) {
                         for (int y_s = 0; y_s < (cycl_y ? 2 : 1); ++y_s) {
                             for (int z_s = 0; z_s < (cycl_z ? 2 : 1); ++z_s) {
 
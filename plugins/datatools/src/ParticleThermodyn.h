@@ -8,6 +8,7 @@
 #pragma once
 
 #include "datatools/PointcloudHelpers.h"
+#include "datatools/SpatialIndex.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
@@ -130,11 +131,20 @@ private:
     std::shared_ptr<my_kd_tree_t> particleTree;
     std::shared_ptr<simplePointcloud> myPts;
 
+    /** The shared index, if one is connected and covers exactly the usable lists */
+    std::shared_ptr<const SpatialIndex> sharedIndex;
+
+    /** Offsets of the usable lists into 'newColors', indexed by list */
+    std::vector<size_t> listOffsets;
+
     /** The slot providing access to the manipulated data */
     megamol::core::CalleeSlot outDataSlot;
 
     /** The slot accessing the original data */
     megamol::core::CallerSlot inDataSlot;
+
+    /** The slot accessing an optional shared spatial index of the original data */
+    megamol::core::CallerSlot inIndexSlot;
 };
 
 } // namespace megamol::datatools
@@ -20,8 +20,6 @@
 
 #include "simultaneous_sort/simultaneous_sort.h"
 
-#include "omp.h"
-
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -30,12 +28,32 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <utility>
 #include <vector>
 
 using namespace megamol;
 
+namespace {
+
+/** Edge length of the bricks particles are binned into, in voxels */
+constexpr int brickSize = 16;
+
+/** Edge length of the bricks of the bricked output, in voxels */
+constexpr size_t outputBrickSize = 64;
+
+/** Maximum halo around a brick that is buffered thread-locally, in voxels */
+constexpr int maxBrickHalo = 16;
+
+/** Modulo mapping negative values into [0, m) as well */
+inline int wrapIndex(int v, int m) {
+    int const r = v % m;
+    return r < 0 ? r + m : r;
+}
+
+} // namespace
+
 /*
  * datatools::ParticlesToDensity::create
  */
@@ -76,6 +94,7 @@ datatools::ParticlesToDensity::ParticlesToDensity()
         , outDataSlot("outData", "Provides a density volume for the particles")
         , outParticlesSlot("outParticles", "Provides particles forming a regular grid with the sampled values")
         , outInfoSlot("outInfo", "Provides information which can be used for visualization and filtering")
+        , outBrickedSlot("outBricked", "Provides the density volume brick by brick")
         , inDataSlot("inData", "Takes the particle data") {
 
     auto* ep = new core::param::EnumParam(0);
@@ -126,6 +145,17 @@ datatools::ParticlesToDensity::ParticlesToDensity()
         datatools::table::TableDataCall::FunctionName(1), &ParticlesToDensity::getExtentCallback);
     this->MakeSlotAvailable(&this->outInfoSlot);
 
+    this->outBrickedSlot.SetCallback(geocalls::BrickedVolumetricDataCall::ClassName(),
+        geocalls::BrickedVolumetricDataCall::FunctionName(geocalls::BrickedVolumetricDataCall::IDX_GET_DATA),
+        &ParticlesToDensity::getDataCallback);
+    this->outBrickedSlot.SetCallback(geocalls::BrickedVolumetricDataCall::ClassName(),
+        geocalls::BrickedVolumetricDataCall::FunctionName(geocalls::BrickedVolumetricDataCall::IDX_GET_EXTENTS),
+        &ParticlesToDensity::getExtentCallback);
+    this->outBrickedSlot.SetCallback(geocalls::BrickedVolumetricDataCall::ClassName(),
+        geocalls::BrickedVolumetricDataCall::FunctionName(geocalls::BrickedVolumetricDataCall::IDX_GET_BRICKS),
+        &ParticlesToDensity::getBricksCallback);
+    this->MakeSlotAvailable(&this->outBrickedSlot);
+
     this->xResSlot << new core::param::IntParam(16);
     this->MakeSlotAvailable(&this->xResSlot);
     this->yResSlot << new core::param::IntParam(16);
@@ -169,12 +199,16 @@ bool datatools::ParticlesToDensity::getExtentCallback(megamol::core::Call& c) {
     auto* out = dynamic_cast<geocalls::VolumetricDataCall*>(&c);
     auto* outGrid = dynamic_cast<geocalls::MultiParticleDataCall*>(&c);
     auto* outInfo = dynamic_cast<datatools::table::TableDataCall*>(&c);
+    auto* outBricked = dynamic_cast<geocalls::BrickedVolumetricDataCall*>(&c);
 
     auto* inMpdc = this->inDataSlot.CallAs<MultiParticleDataCall>();
     if (inMpdc == nullptr)
         return false;
 
-    auto frameID = out != nullptr ? out->FrameID() : (outGrid != nullptr ? outGrid->FrameID() : 0);
+    auto frameID = out != nullptr       ? out->FrameID()
+                   : outGrid != nullptr ? outGrid->FrameID()
+                   : outBricked != nullptr ? outBricked->FrameID()
+                                           : 0;
     //vislib::sys::Log::DefaultLog.WriteInfo(L"ParticleToDensity requests frame %u.", frameID);
     inMpdc->SetFrameID(frameID, true);
     if (!(*inMpdc)(1)) {
@@ -197,6 +231,13 @@ bool datatools::ParticlesToDensity::getExtentCallback(megamol::core::Call& c) {
         outGrid->SetFrameCount(inMpdc->FrameCount());
     }
 
+    if (outBricked != nullptr) {
+        outBricked->AccessBoundingBoxes().SetObjectSpaceBBox(inMpdc->GetBoundingBoxes().ObjectSpaceBBox());
+        outBricked->AccessBoundingBoxes().SetObjectSpaceClipBox(inMpdc->GetBoundingBoxes().ObjectSpaceClipBox());
+        outBricked->AccessBoundingBoxes().MakeScaledWorld(1.0f);
+        outBricked->SetFrameCount(inMpdc->FrameCount());
+    }
+
     if (outInfo != nullptr) {
         outInfo->SetDataHash(this->datahash);
         outInfo->SetUnlocker(nullptr);
@@ -219,9 +260,13 @@ bool datatools::ParticlesToDensity::getDataCallback(megamol::core::Call& c) {
     auto* outVol = dynamic_cast<geocalls::VolumetricDataCall*>(&c);
     auto* outGrid = dynamic_cast<geocalls::MultiParticleDataCall*>(&c);
     auto* outInfo = dynamic_cast<datatools::table::TableDataCall*>(&c);
+    auto* outBricked = dynamic_cast<geocalls::BrickedVolumetricDataCall*>(&c);
 
-    if (outVol != nullptr || outGrid != nullptr) {
-        auto frameID = outVol != nullptr ? outVol->FrameID() : (outGrid != nullptr ? outGrid->FrameID() : 0);
+    if (outVol != nullptr || outGrid != nullptr || outBricked != nullptr) {
+        auto frameID = outVol != nullptr       ? outVol->FrameID()
+                       : outGrid != nullptr ? outGrid->FrameID()
+                       : outBricked != nullptr ? outBricked->FrameID()
+                                               : 0;
         do {
             inMpdc->SetFrameID(frameID, true);
             if (!(*inMpdc)(1)) {
@@ -251,48 +296,8 @@ bool datatools::ParticlesToDensity::getDataCallback(megamol::core::Call& c) {
     // TODO set data
     if (outVol != nullptr) {
         outVol->SetFrameID(this->time);
-        outVol->SetData(this->vol[0].data());
-        metadata.Components = is_vector ? 3 : 1;
-        metadata.GridType = geocalls::GridType_t::CARTESIAN;
-        metadata.Resolution[0] = static_cast<size_t>(this->xResSlot.Param<core::param::IntParam>()->Value());
-        metadata.Resolution[1] = static_cast<size_t>(this->yResSlot.Param<core::param::IntParam>()->Value());
-        metadata.Resolution[2] = static_cast<size_t>(this->zResSlot.Param<core::param::IntParam>()->Value());
-        metadata.ScalarType = geocalls::ScalarType_t::FLOATING_POINT;
-        metadata.ScalarLength = sizeof(float);
-        metadata.MinValues = new double[is_vector ? 3 : 1];
-        metadata.MinValues[0] = this->minDens;
-        if (is_vector)
-            metadata.MinValues[1] = this->minDens;
-        if (is_vector)
-            metadata.MinValues[2] = this->minDens;
-        metadata.MaxValues = new double[is_vector ? 3 : 1];
-        metadata.MaxValues[0] = this->maxDens;
-        if (is_vector)
-            metadata.MaxValues[1] = this->maxDens;
-        if (is_vector)
-            metadata.MaxValues[2] = this->maxDens;
-        auto bbox = inMpdc->AccessBoundingBoxes().ObjectSpaceBBox();
-        metadata.Extents[0] = bbox.Width();
-        metadata.Extents[1] = bbox.Height();
-        metadata.Extents[2] = bbox.Depth();
-        metadata.NumberOfFrames = 1;
-        metadata.SliceDists[0] = new float[1];
-        metadata.SliceDists[0][0] = metadata.Extents[0] / static_cast<float>(metadata.Resolution[0] - 1);
-        metadata.SliceDists[1] = new float[1];
-        metadata.SliceDists[1][0] = metadata.Extents[1] / static_cast<float>(metadata.Resolution[1] - 1);
-        metadata.SliceDists[2] = new float[1];
-        metadata.SliceDists[2][0] = metadata.Extents[2] / static_cast<float>(metadata.Resolution[2] - 1);
-
-        metadata.Origin[0] = bbox.Left();
-        //-metadata.SliceDists[0][0] / 4.0f;
-        metadata.Origin[1] = bbox.Bottom();
-        //-metadata.SliceDists[1][0] / 4.0f;
-        metadata.Origin[2] = bbox.Back();
-        //-metadata.SliceDists[2][0] / 4.0f;
-
-        metadata.IsUniform[0] = true;
-        metadata.IsUniform[1] = true;
-        metadata.IsUniform[2] = true;
+        outVol->SetData(this->vol.data());
+        this->updateMetadata(inMpdc);
         outVol->SetMetadata(&metadata);
 
         outVol->SetDataHash(this->datahash);
@@ -302,10 +307,23 @@ bool datatools::ParticlesToDensity::getDataCallback(megamol::core::Call& c) {
         this->zResSlot.Param<core::param::IntParam>()->Value()); outVol->SetComponents(1);
         outVol->SetMinimumDensity(0.0f);
         outVol->SetMaximumDensity(this->maxDens);
-        outVol->SetVoxelMapPointer(this->vol[0].data());*/
+        outVol->SetVoxelMapPointer(this->vol.data());*/
         // inMpdc->Unlock();
     }
 
+    if (outBricked != nullptr) {
+        this->updateMetadata(inMpdc);
+        if (this->bricks_datahash != this->datahash) {
+            this->updateBrickTable();
+            this->bricks_datahash = this->datahash;
+        }
+        outBricked->SetFrameID(this->time);
+        outBricked->SetMetadata(&metadata);
+        outBricked->SetBrickTable(outputBrickSize, &this->brickLevel, 1, this->bricks.data(), this->bricks.size(),
+            this->brickMin.data(), this->brickMax.data());
+        outBricked->SetDataHash(this->datahash);
+    }
+
     if (outGrid != nullptr && is_vector) {
         outGrid->SetFrameID(this->time);
         outGrid->SetDataHash(this->datahash);
@@ -401,16 +419,9 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class geocalls::MultiParticl
 
     bool const is_vector = this->aggregatorSlot.Param<core::param::EnumParam>()->Value() == 2;
 
-    vol.resize(omp_get_max_threads());
-    std::vector<std::vector<float>> weights(omp_get_max_threads());
-#pragma omp parallel for
-    for (int init = 0; init < omp_get_max_threads(); ++init) {
-        vol[init].resize(sx * sy * sz * (is_vector ? 3 : 1));
-        std::fill(vol[init].begin(), vol[init].end(), 0.0f);
-
-        weights[init].resize(sx * sy * sz);
-        std::fill(weights[init].begin(), weights[init].end(), 0.0f);
-    }
+    int const numComp = is_vector ? 3 : 1;
+    vol.assign(static_cast<size_t>(sx) * sy * sz * numComp, 0.0f);
+    std::vector<float> weights(is_vector ? static_cast<size_t>(sx) * sy * sz : 0, 0.0f);
 
     // TODO: the whole code is wrong since we might not have the bounding box for the actual cyclic boundary conditions.
 
@@ -489,163 +500,226 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class geocalls::MultiParticl
         auto const& dzAcc = parStore.GetDZAcc();
 
         auto const sigma = this->sigmaSlot.Param<core::param::FloatParam>()->Value();
+        auto const aggregator = this->aggregatorSlot.Param<core::param::EnumParam>()->Value();
+
+        // the splatted values are interleaved per voxel, followed by the weight in the vector case
+        int const stride = numComp + (is_vector ? 1 : 0);
+        int64_t const cnt = parts.GetCount();
+
+        // bin the particles into bricks by the voxel of their centre, so that each brick can be
+        // splatted into a small thread-local tile instead of a per-thread copy of the volume
+        int const bricksX = (sx + brickSize - 1) / brickSize;
+        int const bricksY = (sy + brickSize - 1) / brickSize;
+        int const bricksZ = (sz + brickSize - 1) / brickSize;
+        int64_t const numBricks = static_cast<int64_t>(bricksX) * bricksY * bricksZ;
+
+        auto const brickAt = [&](float const px, float const py, float const pz) -> int64_t {
+            auto const x = std::clamp(static_cast<int>((px - minOSx) / sliceDistX), 0, sx - 1);
+            auto const y = std::clamp(static_cast<int>((py - minOSy) / sliceDistY), 0, sy - 1);
+            auto const z = std::clamp(static_cast<int>((pz - minOSz) / sliceDistZ), 0, sz - 1);
+            return (x / brickSize) + ((y / brickSize) + static_cast<int64_t>(z / brickSize) * bricksY) * bricksX;
+        };
 
-        std::function<void(int, int, int, int, float, float)> volOp;
-        switch (this->aggregatorSlot.Param<core::param::EnumParam>()->Value()) {
-        case 2: {
-            volOp = [this, &rbf, &weights, dxAcc, dyAcc, dzAcc, sx, sy, sigma](int const pidx, int const x, int const y,
-                        int const z, float const dis, float const rad) -> void {
-                if (rad == 0.0f)
-                    return;
-
-                auto const val_x = dxAcc->Get_f(pidx);
-                auto const val_y = dyAcc->Get_f(pidx);
-                auto const val_z = dzAcc->Get_f(pidx);
-
-                vol[omp_get_thread_num()][(x + (y + z * sy) * sx) * 3 + 0] += rbf(dis, sigma * rad) * val_x;
-                vol[omp_get_thread_num()][(x + (y + z * sy) * sx) * 3 + 1] += rbf(dis, sigma * rad) * val_y;
-                vol[omp_get_thread_num()][(x + (y + z * sy) * sx) * 3 + 2] += rbf(dis, sigma * rad) * val_z;
-
-                weights[omp_get_thread_num()][x + (y + z * sy) * sx] += rbf(dis, sigma * rad);
-            };
-        } break;
-        case 1: {
-            volOp = [this, &rbf, iAcc, sx, sy, sigma](int const pidx, int const x, int const y, int const z,
-                        float const dis, float const rad) -> void {
-                if (rad == 0.0f)
-                    return;
-
-                auto const val = iAcc->Get_f(pidx);
-                vol[omp_get_thread_num()][x + (y + z * sy) * sx] += rbf(dis, sigma * rad) * val;
-            };
-        } break;
-        default:
-        case 0: {
-            volOp = [this, &rbf, sx, sy, sigma](int const pidx, int const x, int const y, int const z, float const dis,
-                        float const rad) -> void {
-                if (rad == 0.0f)
-                    return;
-
-                vol[omp_get_thread_num()][x + (y + z * sy) * sx] += rbf(dis, sigma * rad);
-            };
-        }
+        // the positions are read through the typed view, which avoids three virtual calls per particle
+        std::vector<int64_t> brickOf(cnt);
+        bool const hasVertices = parts.VisitVertexData([&](auto const& verts) {
+#pragma omp parallel for
+            for (int64_t j = 0; j < cnt; ++j) {
+                brickOf[j] = brickAt(static_cast<float>(verts.Get(j, 0)), static_cast<float>(verts.Get(j, 1)),
+                    static_cast<float>(verts.Get(j, 2)));
+            }
+        });
+        if (!hasVertices) {
+            // without positions, all particles sit in the origin like the accessors report
+            std::fill(brickOf.begin(), brickOf.end(), brickAt(0.0f, 0.0f, 0.0f));
         }
 
-#if 0
-#pragma omp parallel for collapse(4)
-        for (int z = 0; z < sz; ++z) {
-            for (int y = 0; y < sy; ++y) {
-                for (int x = 0; x < sx; ++x) {
-                    for (int64_t j = 0; j < parts.GetCount(); ++j) {
-                        auto const x_base = xAcc->Get_f(j);
-                        auto const y_base = yAcc->Get_f(j);
-                        auto const z_base = zAcc->Get_f(j);
-                        auto rad = globRad;
-                        if (!useGlobRad) rad = rAcc->Get_f(j);
-
-                        float x_diff = static_cast<float>(x) * sliceDistX + minOSx;
-                        x_diff = std::fabs(x_diff - x_base);
-                        if (cycl_x && x_diff > halfRangeOSx) x_diff -= rangeOSx;
-                        float y_diff = static_cast<float>(y) * sliceDistY + minOSy;
-                        y_diff = std::fabs(y_diff - y_base);
-                        if (cycl_y && y_diff > halfRangeOSy) y_diff -= rangeOSy;
-                        float z_diff = static_cast<float>(z) * sliceDistZ + minOSz;
-                        z_diff = std::fabs(z_diff - z_base);
-                        if (cycl_z && z_diff > halfRangeOSz) z_diff -= rangeOSz;
-                        float const dis = std::sqrt(x_diff * x_diff + y_diff * y_diff + z_diff * z_diff);
-
-                        volOp(j, x, y, z, dis, rad);
-                    }
-                }
+        // the halo buffered around each brick covers the largest support, particles with a larger
+        // footprint than the tile write the overhanging part directly into the volume
+        float maxSupport = useGlobRad ? sigma * globRad : 0.0f;
+        std::vector<int64_t> brickStart(numBricks + 1, 0);
+        for (int64_t j = 0; j < cnt; ++j) {
+            ++brickStart[brickOf[j] + 1];
+            if (!useGlobRad) {
+                maxSupport = std::max(maxSupport, sigma * rAcc->Get_f(j));
             }
         }
-#endif
+        int const haloX = std::min(static_cast<int>(std::ceil(maxSupport / sliceDistX)), maxBrickHalo);
+        int const haloY = std::min(static_cast<int>(std::ceil(maxSupport / sliceDistY)), maxBrickHalo);
+        int const haloZ = std::min(static_cast<int>(std::ceil(maxSupport / sliceDistZ)), maxBrickHalo);
+
+        std::partial_sum(brickStart.begin(), brickStart.end(), brickStart.begin());
+        std::vector<int64_t> order(cnt);
+        {
+            std::vector<int64_t> fill(brickStart.begin(), brickStart.end() - 1);
+            for (int64_t j = 0; j < cnt; ++j) {
+                order[fill[brickOf[j]]++] = j;
+            }
+        }
+        brickOf.clear();
+        brickOf.shrink_to_fit();
+
+        int const tileX = brickSize + 2 * haloX;
+        int const tileY = brickSize + 2 * haloY;
+        int const tileZ = brickSize + 2 * haloZ;
+
+        // maps an unwrapped voxel index to the volume, or -1 if it lies outside a non-periodic volume
+        auto toVolume = [](int h, int s, bool cycl) -> int {
+            if (cycl)
+                return wrapIndex(h, s);
+            return (h < 0 || h > s - 1) ? -1 : h;
+        };
 
-#pragma omp parallel for
-        for (int64_t j = 0; j < parts.GetCount(); ++j) {
+        // evaluates the kernel of particle j over its support and hands each weighted value to 'add'
+        auto splat = [&](int64_t const j, auto&& add) -> void {
             auto const x_base = xAcc->Get_f(j);
-            auto x = static_cast<int>((x_base - minOSx) / sliceDistX);
             auto const y_base = yAcc->Get_f(j);
-            auto y = static_cast<int>((y_base - minOSy) / sliceDistY);
             auto const z_base = zAcc->Get_f(j);
-            auto z = static_cast<int>((z_base - minOSz) / sliceDistZ);
-            auto rad = globRad;
-            if (!useGlobRad)
-                rad = rAcc->Get_f(j);
+            auto const x = static_cast<int>((x_base - minOSx) / sliceDistX);
+            auto const y = static_cast<int>((y_base - minOSy) / sliceDistY);
+            auto const z = static_cast<int>((z_base - minOSz) / sliceDistZ);
+            auto const support = sigma * (useGlobRad ? globRad : rAcc->Get_f(j));
+
+            std::array<float, 3> val = {1.0f, 0.0f, 0.0f};
+            if (aggregator == 2) {
+                val = {dxAcc->Get_f(j), dyAcc->Get_f(j), dzAcc->Get_f(j)};
+            } else if (aggregator == 1) {
+                val[0] = iAcc->Get_f(j);
+            }
 
-            int const filterSizeX = static_cast<int>(std::ceil(rad / sliceDistX));
-            int const filterSizeY = static_cast<int>(std::ceil(rad / sliceDistY));
-            int const filterSizeZ = static_cast<int>(std::ceil(rad / sliceDistZ));
+            int const filterSizeX = static_cast<int>(std::ceil(support / sliceDistX));
+            int const filterSizeY = static_cast<int>(std::ceil(support / sliceDistY));
+            int const filterSizeZ = static_cast<int>(std::ceil(support / sliceDistZ));
 
             for (int hz = z - filterSizeZ; hz <= z + filterSizeZ; ++hz) {
+                if (toVolume(hz, sz, cycl_z) < 0)
+                    continue;
+                float const z_diff = static_cast<float>(hz) * sliceDistZ + minOSz - z_base;
                 for (int hy = y - filterSizeY; hy <= y + filterSizeY; ++hy) {
+                    if (toVolume(hy, sy, cycl_y) < 0)
+                        continue;
+                    float const y_diff = static_cast<float>(hy) * sliceDistY + minOSy - y_base;
                     for (int hx = x - filterSizeX; hx <= x + filterSizeX; ++hx) {
-                        auto tmp_hx = hx;
-                        auto tmp_hy = hy;
-                        auto tmp_hz = hz;
-                        if (cycl_x) {
-                            tmp_hx = (hx + 2 * sx) % sx;
-                        } else {
-                            if (hx < 0 || hx > sx - 1) {
+                        if (toVolume(hx, sx, cycl_x) < 0)
+                            continue;
+                        float const x_diff = static_cast<float>(hx) * sliceDistX + minOSx - x_base;
+                        float const dis = std::sqrt(x_diff * x_diff + y_diff * y_diff + z_diff * z_diff);
+                        float const w = rbf(dis, support);
+                        if (w == 0.0f)
+                            continue;
+                        add(hx, hy, hz, w, val);
+                    }
+                }
+            }
+        };
+
+        // accumulates directly into the shared volume
+        auto addToVolume = [&](int hx, int hy, int hz, float w, std::array<float, 3> const& val) -> void {
+            size_t const i = toVolume(hx, sx, cycl_x) +
+                             (toVolume(hy, sy, cycl_y) + static_cast<size_t>(toVolume(hz, sz, cycl_z)) * sy) * sx;
+            for (int c = 0; c < numComp; ++c) {
+#pragma omp atomic
+                vol[i * numComp + c] += w * val[c];
+            }
+            if (is_vector) {
+#pragma omp atomic
+                weights[i] += w;
+            }
+        };
+
+#pragma omp parallel
+        {
+            std::vector<float> tile(static_cast<size_t>(tileX) * tileY * tileZ * stride, 0.0f);
+
+#pragma omp for schedule(dynamic, 1)
+            for (int64_t b = 0; b < numBricks; ++b) {
+                if (brickStart[b] == brickStart[b + 1])
+                    continue;
+
+                int const ox = static_cast<int>(b % bricksX) * brickSize - haloX;
+                int const oy = static_cast<int>((b / bricksX) % bricksY) * brickSize - haloY;
+                int const oz = static_cast<int>(b / (static_cast<int64_t>(bricksX) * bricksY)) * brickSize - haloZ;
+                std::array<int, 3> touchedMin = {tileX, tileY, tileZ};
+                std::array<int, 3> touchedMax = {-1, -1, -1};
+
+                auto addToTile = [&](int hx, int hy, int hz, float w, std::array<float, 3> const& val) -> void {
+                    int const tx = hx - ox;
+                    int const ty = hy - oy;
+                    int const tz = hz - oz;
+                    if (tx < 0 || tx >= tileX || ty < 0 || ty >= tileY || tz < 0 || tz >= tileZ) {
+                        addToVolume(hx, hy, hz, w, val);
+                        return;
+                    }
+                    touchedMin = {std::min(touchedMin[0], tx), std::min(touchedMin[1], ty),
+                        std::min(touchedMin[2], tz)};
+                    touchedMax = {std::max(touchedMax[0], tx), std::max(touchedMax[1], ty),
+                        std::max(touchedMax[2], tz)};
+                    float* t = tile.data() + (tx + (ty + static_cast<size_t>(tz) * tileY) * tileX) * stride;
+                    for (int c = 0; c < numComp; ++c) {
+                        t[c] += w * val[c];
+                    }
+                    if (is_vector) {
+                        t[numComp] += w;
+                    }
+                };
+
+                for (int64_t k = brickStart[b]; k < brickStart[b + 1]; ++k) {
+                    auto const j = order[k];
+                    if ((useGlobRad ? globRad : rAcc->Get_f(j)) == 0.0f)
+                        continue;
+                    splat(j, addToTile);
+                }
+
+                // flush the touched part of the tile into the volume and clear it for the next brick
+                for (int tz = touchedMin[2]; tz <= touchedMax[2]; ++tz) {
+                    int const gz = toVolume(oz + tz, sz, cycl_z);
+                    for (int ty = touchedMin[1]; ty <= touchedMax[1]; ++ty) {
+                        int const gy = toVolume(oy + ty, sy, cycl_y);
+                        for (int tx = touchedMin[0]; tx <= touchedMax[0]; ++tx) {
+                            int const gx = toVolume(ox + tx, sx, cycl_x);
+                            float* t = tile.data() + (tx + (ty + static_cast<size_t>(tz) * tileY) * tileX) * stride;
+                            if (gx < 0 || gy < 0 || gz < 0) {
+                                std::fill(t, t + stride, 0.0f);
                                 continue;
                             }
-                        }
-                        if (cycl_y) {
-                            tmp_hy = (hy + 2 * sy) % sy;
-                        } else {
-                            if (hy < 0 || hy > sy - 1) {
-                                continue;
+                            size_t const i = gx + (gy + static_cast<size_t>(gz) * sy) * sx;
+                            for (int c = 0; c < numComp; ++c) {
+                                if (t[c] != 0.0f) {
+#pragma omp atomic
+                                    vol[i * numComp + c] += t[c];
+                                    t[c] = 0.0f;
+                                }
                             }
-                        }
-                        if (cycl_z) {
-                            tmp_hz = (hz + 2 * sz) % sz;
-                        } else {
-                            if (hz < 0 || hz > sz - 1) {
-                                continue;
+                            if (is_vector && t[numComp] != 0.0f) {
+#pragma omp atomic
+                                weights[i] += t[numComp];
+                                t[numComp] = 0.0f;
                             }
                         }
-
-                        float x_diff = static_cast<float>(hx) * sliceDistX + minOSx;
-                        x_diff = std::fabs(x_diff - x_base);
-                        // if (x_diff > halfRangeOSx) x_diff -= rangeOSx;
-                        float y_diff = static_cast<float>(hy) * sliceDistY + minOSy;
-                        y_diff = std::fabs(y_diff - y_base);
-                        // if (y_diff > halfRangeOSy) y_diff -= rangeOSy;
-                        float z_diff = static_cast<float>(hz) * sliceDistZ + minOSz;
-                        z_diff = std::fabs(z_diff - z_base);
-                        // if (z_diff > halfRangeOSz) z_diff -= rangeOSz;
-                        float const dis = std::sqrt(x_diff * x_diff + y_diff * y_diff + z_diff * z_diff);
-
-                        volOp(j, tmp_hx, tmp_hy, tmp_hz, dis, rad);
                     }
                 }
             }
         }
     }
 
-    for (int i = 1; i < omp_get_max_threads(); ++i) {
-        std::transform(vol[i].begin(), vol[i].end(), vol[0].begin(), vol[0].begin(), std::plus<>());
-        std::transform(weights[i].begin(), weights[i].end(), weights[0].begin(), weights[0].begin(), std::plus<>());
-    }
-
     if (is_vector) {
-        this->directions.resize(vol[0].size());
-        this->colors.resize(vol[0].size() / 3);
-        this->densities.resize(vol[0].size() / 3);
+        this->directions.resize(vol.size());
+        this->colors.resize(vol.size() / 3);
+        this->densities.resize(vol.size() / 3);
         maxDens = 0.0f;
         minDens = std::numeric_limits<float>::max();
-        for (std::size_t i = 0; i < vol[0].size() / 3; ++i) {
-            vol[0][i * 3 + 0] /= weights[0][i] == 0.0f ? 1.0f : weights[0][i];
-            vol[0][i * 3 + 1] /= weights[0][i] == 0.0f ? 1.0f : weights[0][i];
-            vol[0][i * 3 + 2] /= weights[0][i] == 0.0f ? 1.0f : weights[0][i];
+        for (std::size_t i = 0; i < vol.size() / 3; ++i) {
+            vol[i * 3 + 0] /= weights[i] == 0.0f ? 1.0f : weights[i];
+            vol[i * 3 + 1] /= weights[i] == 0.0f ? 1.0f : weights[i];
+            vol[i * 3 + 2] /= weights[i] == 0.0f ? 1.0f : weights[i];
 
             const float density =
-                std::sqrt(vol[0][i * 3 + 0] * vol[0][i * 3 + 0] + vol[0][i * 3 + 1] * vol[0][i * 3 + 1] +
-                          vol[0][i * 3 + 2] * vol[0][i * 3 + 2]);
+                std::sqrt(vol[i * 3 + 0] * vol[i * 3 + 0] + vol[i * 3 + 1] * vol[i * 3 + 1] +
+                          vol[i * 3 + 2] * vol[i * 3 + 2]);
 
-            this->directions[i * 3 + 0] = density == 0.0f ? 0.0f : vol[0][i * 3 + 0] / density;
-            this->directions[i * 3 + 1] = density == 0.0f ? 0.0f : vol[0][i * 3 + 1] / density;
-            this->directions[i * 3 + 2] = density == 0.0f ? 0.0f : vol[0][i * 3 + 2] / density;
+            this->directions[i * 3 + 0] = density == 0.0f ? 0.0f : vol[i * 3 + 0] / density;
+            this->directions[i * 3 + 1] = density == 0.0f ? 0.0f : vol[i * 3 + 1] / density;
+            this->directions[i * 3 + 2] = density == 0.0f ? 0.0f : vol[i * 3 + 2] / density;
 
             this->infoData[i * this->info.size() + 3] = this->directions[i * 3 + 0];
             this->infoData[i * this->info.size() + 4] = this->directions[i * 3 + 1];
@@ -654,10 +728,10 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class geocalls::MultiParticl
             maxDens = std::max(maxDens, density);
             minDens = std::min(minDens, density);
         }
-        for (std::size_t i = 0; i < vol[0].size() / 3; ++i) {
+        for (std::size_t i = 0; i < vol.size() / 3; ++i) {
             const float density =
-                std::sqrt(vol[0][i * 3 + 0] * vol[0][i * 3 + 0] + vol[0][i * 3 + 1] * vol[0][i * 3 + 1] +
-                          vol[0][i * 3 + 2] * vol[0][i * 3 + 2]);
+                std::sqrt(vol[i * 3 + 0] * vol[i * 3 + 0] + vol[i * 3 + 1] * vol[i * 3 + 1] +
+                          vol[i * 3 + 2] * vol[i * 3 + 2]);
 
             this->colors[i] = (density - minDens) / (maxDens - minDens);
             this->densities[i] = density;
@@ -669,8 +743,8 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class geocalls::MultiParticl
             }
         }
     } else {
-        maxDens = *std::max_element(vol[0].begin(), vol[0].end());
-        minDens = *std::min_element(vol[0].begin(), vol[0].end());
+        maxDens = *std::max_element(vol.begin(), vol.end());
+        minDens = *std::min_element(vol.begin(), vol.end());
     }
 
     megamol::core::utility::log::Log::DefaultLog.WriteInfo(
@@ -678,7 +752,7 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class geocalls::MultiParticl
 
     if (this->normalizeSlot.Param<core::param::BoolParam>()->Value()) {
         auto const rcpValRange = 1.0f / (maxDens - minDens);
-        std::transform(vol[0].begin(), vol[0].end(), vol[0].begin(),
+        std::transform(vol.begin(), vol.end(), vol.begin(),
             [this, rcpValRange](float const& a) { return (a - minDens) * rcpValRange; });
         minDens = 0.0f;
         maxDens = 1.0f;
@@ -732,14 +806,11 @@ bool datatools::ParticlesToDensity::createVolumeCPU(class geocalls::MultiParticl
 //#define PTD_DEBUG_OUTPUT
 #ifdef PTD_DEBUG_OUTPUT
     std::ofstream raw_file{"bolla.raw", std::ios::binary};
-    raw_file.write(reinterpret_cast<char const*>(vol[0].data()), vol[0].size() * sizeof(float));
+    raw_file.write(reinterpret_cast<char const*>(vol.data()), vol.size() * sizeof(float));
     raw_file.close();
     megamol::core::utility::log::Log::DefaultLog.WriteInfo("ParticlesToDensity: Debug file written\n");
 #endif
 
-    // Cleanup
-    vol.resize(1);
-
     const auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffMillis = endTime - startTime;
     megamol::core::utility::log::Log::DefaultLog.WriteInfo(
@@ -805,3 +876,135 @@ void datatools::ParticlesToDensity::modifyBBox(geocalls::MultiParticleDataCall*
 bool datatools::ParticlesToDensity::dummyCallback(megamol::core::Call& c) {
     return true;
 }
+
+
+bool datatools::ParticlesToDensity::getBricksCallback(megamol::core::Call& c) {
+    auto* outBricked = dynamic_cast<geocalls::BrickedVolumetricDataCall*>(&c);
+    if (outBricked == nullptr || !this->has_data || this->bricks_datahash != this->datahash)
+        return false;
+
+    const size_t res[3] = {metadata.Resolution[0], metadata.Resolution[1], metadata.Resolution[2]};
+    const size_t voxelSize = metadata.Components * sizeof(float);
+    const auto cnt = static_cast<int64_t>(outBricked->GetRequestCount());
+
+    std::vector<geocalls::BrickedVolumetricDataCall::BrickData> data(cnt);
+    bool valid = true;
+#pragma omp parallel for reduction(&& : valid)
+    for (int64_t i = 0; i < cnt; ++i) {
+        const auto idx = outBricked->GetRequestedBrick(i);
+        if (idx < this->bricks.size()) {
+            const auto& b = this->bricks[idx];
+            auto brick = std::make_shared<std::vector<uint8_t>>(
+                b.Resolution[0] * b.Resolution[1] * b.Resolution[2] * voxelSize);
+            geocalls::BrickedVolumetricDataCall::CopyGridToBrick(b, this->vol.data(), res, voxelSize, brick->data());
+            data[i] = std::move(brick);
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError("ParticlesToDensity: invalid brick requested.");
+        return false;
+    }
+
+    outBricked->SetBrickData(std::move(data));
+    outBricked->SetFrameID(this->time);
+    outBricked->SetDataHash(this->datahash);
+    return true;
+}
+
+
+void datatools::ParticlesToDensity::updateBrickTable() {
+    const size_t comps = metadata.Components;
+    for (int a = 0; a < 3; ++a) {
+        this->brickLevel.Resolution[a] = metadata.Resolution[a];
+        this->brickLevel.Bricks[a] = (metadata.Resolution[a] + outputBrickSize - 1) / outputBrickSize;
+    }
+    this->brickLevel.FirstBrick = 0;
+
+    const size_t cnt = this->brickLevel.Bricks[0] * this->brickLevel.Bricks[1] * this->brickLevel.Bricks[2];
+    this->bricks.resize(cnt);
+    this->brickMin.assign(cnt * comps, std::numeric_limits<double>::max());
+    this->brickMax.assign(cnt * comps, std::numeric_limits<double>::lowest());
+
+    // the ranges of the bricks are independent, so each thread scans whole bricks
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t i = 0; i < static_cast<int64_t>(cnt); ++i) {
+        auto& b = this->bricks[i];
+        const size_t pos[3] = {i % this->brickLevel.Bricks[0],
+            (i / this->brickLevel.Bricks[0]) % this->brickLevel.Bricks[1],
+            i / (this->brickLevel.Bricks[0] * this->brickLevel.Bricks[1])};
+        b.Level = 0;
+        for (int a = 0; a < 3; ++a) {
+            b.Origin[a] = pos[a] * outputBrickSize;
+            b.Resolution[a] = std::min(outputBrickSize, metadata.Resolution[a] - b.Origin[a]);
+        }
+
+        double* mins = this->brickMin.data() + i * comps;
+        double* maxs = this->brickMax.data() + i * comps;
+        for (size_t z = b.Origin[2]; z < b.Origin[2] + b.Resolution[2]; ++z) {
+            for (size_t y = b.Origin[1]; y < b.Origin[1] + b.Resolution[1]; ++y) {
+                const float* row = this->vol.data() +
+                                   ((z * metadata.Resolution[1] + y) * metadata.Resolution[0] + b.Origin[0]) * comps;
+                for (size_t x = 0; x < b.Resolution[0] * comps; ++x) {
+                    mins[x % comps] = std::min(mins[x % comps], static_cast<double>(row[x]));
+                    maxs[x % comps] = std::max(maxs[x % comps], static_cast<double>(row[x]));
+                }
+            }
+        }
+    }
+}
+
+
+void datatools::ParticlesToDensity::updateMetadata(geocalls::MultiParticleDataCall* c2) {
+    const bool is_vector = this->aggregatorSlot.Param<core::param::EnumParam>()->Value() == 2;
+
+    // the arrays of the previous request would leak otherwise
+    delete[] this->metadata.MinValues;
+    delete[] this->metadata.MaxValues;
+    delete[] this->metadata.SliceDists[0];
+    delete[] this->metadata.SliceDists[1];
+    delete[] this->metadata.SliceDists[2];
+
+    metadata.Components = is_vector ? 3 : 1;
+    metadata.GridType = geocalls::GridType_t::CARTESIAN;
+    metadata.Resolution[0] = static_cast<size_t>(this->xResSlot.Param<core::param::IntParam>()->Value());
+    metadata.Resolution[1] = static_cast<size_t>(this->yResSlot.Param<core::param::IntParam>()->Value());
+    metadata.Resolution[2] = static_cast<size_t>(this->zResSlot.Param<core::param::IntParam>()->Value());
+    metadata.ScalarType = geocalls::ScalarType_t::FLOATING_POINT;
+    metadata.ScalarLength = sizeof(float);
+    metadata.MinValues = new double[is_vector ? 3 : 1];
+    metadata.MinValues[0] = this->minDens;
+    if (is_vector)
+        metadata.MinValues[1] = this->minDens;
+    if (is_vector)
+        metadata.MinValues[2] = this->minDens;
+    metadata.MaxValues = new double[is_vector ? 3 : 1];
+    metadata.MaxValues[0] = this->maxDens;
+    if (is_vector)
+        metadata.MaxValues[1] = this->maxDens;
+    if (is_vector)
+        metadata.MaxValues[2] = this->maxDens;
+    auto bbox = c2->AccessBoundingBoxes().ObjectSpaceBBox();
+    metadata.Extents[0] = bbox.Width();
+    metadata.Extents[1] = bbox.Height();
+    metadata.Extents[2] = bbox.Depth();
+    metadata.NumberOfFrames = 1;
+    metadata.SliceDists[0] = new float[1];
+    metadata.SliceDists[0][0] = metadata.Extents[0] / static_cast<float>(metadata.Resolution[0] - 1);
+    metadata.SliceDists[1] = new float[1];
+    metadata.SliceDists[1][0] = metadata.Extents[1] / static_cast<float>(metadata.Resolution[1] - 1);
+    metadata.SliceDists[2] = new float[1];
+    metadata.SliceDists[2][0] = metadata.Extents[2] / static_cast<float>(metadata.Resolution[2] - 1);
+
+    metadata.Origin[0] = bbox.Left();
+    //-metadata.SliceDists[0][0] / 4.0f;
+    metadata.Origin[1] = bbox.Bottom();
+    //-metadata.SliceDists[1][0] / 4.0f;
+    metadata.Origin[2] = bbox.Back();
+    //-metadata.SliceDists[2][0] / 4.0f;
+
+    metadata.IsUniform[0] = true;
+    metadata.IsUniform[1] = true;
+    metadata.IsUniform[2] = true;
+}
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "geometry_calls/BrickedVolumetricDataCall.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "geometry_calls/VolumetricDataCall.h"
 #include "mmcore/CalleeSlot.h"
@@ -69,8 +70,23 @@ private:
      */
     bool getDataCallback(megamol::core::Call& c);
 
+    /**
+     * Delivers the requested bricks of the volume on the bricked output.
+     *
+     * @param c The incoming call
+     *
+     * @return True on success
+     */
+    bool getBricksCallback(megamol::core::Call& c);
+
     bool dummyCallback(megamol::core::Call& c);
 
+    /** Splits the current volume into bricks and computes their value ranges */
+    void updateBrickTable();
+
+    /** Describes the current volume in 'metadata' */
+    void updateMetadata(geocalls::MultiParticleDataCall* c2);
+
     bool createVolumeCPU(geocalls::MultiParticleDataCall* c2);
 
     void modifyBBox(geocalls::MultiParticleDataCall* c2);
@@ -118,7 +134,7 @@ private:
 
     core::param::ParamSlot surfaceSlot;
 
-    std::vector<std::vector<float>> vol;
+    std::vector<float> vol;
     std::vector<float> directions, colors, densities;
     std::vector<float> grid;
 
@@ -133,10 +149,17 @@ private:
 
     bool has_data;
 
+    /** The brick table of the volume on the bricked output, which only has level 0 */
+    geocalls::BrickedVolumetricDataCall::Level brickLevel;
+    std::vector<geocalls::BrickedVolumetricDataCall::Brick> bricks;
+    std::vector<double> brickMin, brickMax;
+    size_t bricks_datahash = std::numeric_limits<size_t>::max();
+
     /** The slot providing access to the manipulated data */
     megamol::core::CalleeSlot outDataSlot;
     megamol::core::CalleeSlot outParticlesSlot;
     megamol::core::CalleeSlot outInfoSlot;
+    megamol::core::CalleeSlot outBrickedSlot;
 
     /** The slot accessing the original data */
     megamol::core::CallerSlot inDataSlot;
@@ -0,0 +1,435 @@
+/*
+ * SpatialIndex.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "datatools/SpatialIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+using namespace megamol;
+
+
+/**
+ * kd-tree over the packed positions. Each node is split at the median of its
+ * longest axis, and the subtrees of large nodes are built as OpenMP tasks.
+ * The tree keeps a copy of the positions in tree order, so building and
+ * searching run over contiguous memory.
+ */
+class datatools::SpatialIndex::Tree {
+public:
+    Tree(std::vector<float> const& positions, unsigned int maxLeafSize);
+
+    /** Collects the 'k' nearest particles as a max-heap on the squared distance into 'heap' */
+    void FindNearest(float const* query, size_t k, std::vector<match_t>& heap) const;
+
+    /** Appends all particles closer than 'radiusSqr' to 'matches' */
+    void FindInRadius(float const* query, float radiusSqr, std::vector<match_t>& matches) const;
+
+private:
+    struct Entry {
+        float pos[3];
+        size_t idx;
+    };
+
+    struct Node {
+        float lo[3];
+        float hi[3];
+        size_t begin;
+        size_t end;
+        /** Index of the left child, the right one follows it. Zero for leaves, as the root is nobody's child. */
+        size_t child;
+        int axis;
+        float split;
+    };
+
+    /** Ranges larger than this have their subtrees built as tasks */
+    static constexpr size_t taskThreshold = 16 * 1024;
+
+    void build(size_t node, size_t begin, size_t end);
+
+    void nearest(size_t node, float const* query, size_t k, std::vector<match_t>& heap) const;
+
+    void inRadius(size_t node, float const* query, float radiusSqr, std::vector<match_t>& matches) const;
+
+    /** Squared distance from 'query' to the bounds of 'node', zero inside */
+    static inline float boxDistSqr(Node const& node, float const* query) {
+        float dist = 0.0f;
+        for (int a = 0; a < 3; ++a) {
+            float const d = std::max({node.lo[a] - query[a], 0.0f, query[a] - node.hi[a]});
+            dist += d * d;
+        }
+        return dist;
+    }
+
+    /** Squared distance from 'query' to 'entry' */
+    static inline float distSqr(Entry const& entry, float const* query) {
+        float const dx = entry.pos[0] - query[0];
+        float const dy = entry.pos[1] - query[1];
+        float const dz = entry.pos[2] - query[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    size_t const maxLeafSize;
+    std::vector<Node> nodes;
+    std::atomic<size_t> nodeCount;
+    /** The particles in tree order */
+    std::vector<Entry> entries;
+};
+
+
+/*
+ * datatools::SpatialIndex::Tree::Tree
+ */
+datatools::SpatialIndex::Tree::Tree(std::vector<float> const& positions, unsigned int maxLeafSize)
+        : maxLeafSize(maxLeafSize)
+        , nodes()
+        , nodeCount(1)
+        , entries(positions.size() / 3) {
+    int64_t const cnt = static_cast<int64_t>(this->entries.size());
+#pragma omp parallel for
+    for (int64_t i = 0; i < cnt; ++i) {
+        auto& e = this->entries[i];
+        e.pos[0] = positions[3 * i + 0];
+        e.pos[1] = positions[3 * i + 1];
+        e.pos[2] = positions[3 * i + 2];
+        e.idx = static_cast<size_t>(i);
+    }
+
+    // every leaf holds more than half of the leaf size, which bounds the number of nodes
+    size_t const minLeaf = std::max<size_t>(1, (this->maxLeafSize + 1) / 2);
+    this->nodes.resize(2 * (this->entries.size() / minLeaf) + 1);
+#pragma omp parallel
+#pragma omp single
+    this->build(0, 0, this->entries.size());
+    this->nodes.resize(this->nodeCount);
+}
+
+
+/*
+ * datatools::SpatialIndex::Tree::build
+ */
+void datatools::SpatialIndex::Tree::build(size_t node, size_t begin, size_t end) {
+    auto& n = this->nodes[node];
+    n.begin = begin;
+    n.end = end;
+    n.child = 0;
+    n.axis = 0;
+    n.split = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        n.lo[a] = std::numeric_limits<float>::max();
+        n.hi[a] = std::numeric_limits<float>::lowest();
+    }
+    for (size_t i = begin; i < end; ++i) {
+        float const* pos = this->entries[i].pos;
+        for (int a = 0; a < 3; ++a) {
+            n.lo[a] = std::min(n.lo[a], pos[a]);
+            n.hi[a] = std::max(n.hi[a], pos[a]);
+        }
+    }
+    if (end - begin <= this->maxLeafSize) {
+        return;
+    }
+
+    for (int a = 1; a < 3; ++a) {
+        if (n.hi[a] - n.lo[a] > n.hi[n.axis] - n.lo[n.axis]) {
+            n.axis = a;
+        }
+    }
+    size_t const mid = begin + (end - begin) / 2;
+    int const axis = n.axis;
+    std::nth_element(this->entries.begin() + begin, this->entries.begin() + mid, this->entries.begin() + end,
+        [axis](Entry const& l, Entry const& r) { return l.pos[axis] < r.pos[axis]; });
+    n.split = this->entries[mid].pos[axis];
+    size_t const child = this->nodeCount.fetch_add(2);
+    n.child = child;
+
+    if (end - begin > taskThreshold) {
+#pragma omp task
+        this->build(child, begin, mid);
+#pragma omp task
+        this->build(child + 1, mid, end);
+    } else {
+        this->build(child, begin, mid);
+        this->build(child + 1, mid, end);
+    }
+}
+
+
+/*
+ * datatools::SpatialIndex::Tree::FindNearest
+ */
+void datatools::SpatialIndex::Tree::FindNearest(float const* query, size_t k, std::vector<match_t>& heap) const {
+    heap.clear();
+    if (!this->entries.empty()) {
+        this->nearest(0, query, k, heap);
+    }
+}
+
+
+/*
+ * datatools::SpatialIndex::Tree::FindInRadius
+ */
+void datatools::SpatialIndex::Tree::FindInRadius(
+    float const* query, float radiusSqr, std::vector<match_t>& matches) const {
+    if (!this->entries.empty()) {
+        this->inRadius(0, query, radiusSqr, matches);
+    }
+}
+
+
+/*
+ * datatools::SpatialIndex::Tree::nearest
+ */
+void datatools::SpatialIndex::Tree::nearest(
+    size_t node, float const* query, size_t k, std::vector<match_t>& heap) const {
+    auto const byDist = [](match_t const& l, match_t const& r) { return l.second < r.second; };
+    auto const& n = this->nodes[node];
+    if ((heap.size() == k) && (boxDistSqr(n, query) > heap.front().second)) {
+        return;
+    }
+
+    if (n.child == 0) {
+        for (size_t i = n.begin; i < n.end; ++i) {
+            float const dist = distSqr(this->entries[i], query);
+            if (heap.size() < k) {
+                heap.emplace_back(this->entries[i].idx, dist);
+                std::push_heap(heap.begin(), heap.end(), byDist);
+            } else if (dist < heap.front().second) {
+                std::pop_heap(heap.begin(), heap.end(), byDist);
+                heap.back() = match_t(this->entries[i].idx, dist);
+                std::push_heap(heap.begin(), heap.end(), byDist);
+            }
+        }
+        return;
+    }
+
+    // the side of the query first, it shrinks the search radius for the other one
+    bool const left = query[n.axis] < n.split;
+    this->nearest(left ? n.child : n.child + 1, query, k, heap);
+    this->nearest(left ? n.child + 1 : n.child, query, k, heap);
+}
+
+
+/*
+ * datatools::SpatialIndex::Tree::inRadius
+ */
+void datatools::SpatialIndex::Tree::inRadius(
+    size_t node, float const* query, float radiusSqr, std::vector<match_t>& matches) const {
+    auto const& n = this->nodes[node];
+    if (boxDistSqr(n, query) >= radiusSqr) {
+        return;
+    }
+
+    if (n.child == 0) {
+        for (size_t i = n.begin; i < n.end; ++i) {
+            float const dist = distSqr(this->entries[i], query);
+            if (dist < radiusSqr) {
+                matches.emplace_back(this->entries[i].idx, dist);
+            }
+        }
+        return;
+    }
+
+    this->inRadius(n.child, query, radiusSqr, matches);
+    this->inRadius(n.child + 1, query, radiusSqr, matches);
+}
+
+
+/*
+ * datatools::SpatialIndex::SpatialIndex
+ */
+datatools::SpatialIndex::SpatialIndex(
+    geocalls::MultiParticleDataCall& dat, std::array<bool, 3> const& periodic, unsigned int maxLeafSize)
+        : positions()
+        , listOffsets()
+        , bbox(dat.AccessBoundingBoxes().ObjectSpaceBBox())
+        , periodic(periodic)
+        , tree(nullptr) {
+    using geocalls::SimpleSphericalParticles;
+
+    unsigned int const plc = dat.GetParticleListCount();
+    this->listOffsets.resize(plc + 1, 0);
+    for (unsigned int pli = 0; pli < plc; ++pli) {
+        auto const& pl = dat.AccessParticles(pli);
+        bool const hasPositions = pl.GetVertexDataType() != SimpleSphericalParticles::VERTDATA_NONE;
+        size_t const cnt = hasPositions ? static_cast<size_t>(pl.GetCount()) : 0;
+        this->listOffsets[pli + 1] = this->listOffsets[pli] + cnt;
+    }
+    this->positions.resize(3 * this->listOffsets[plc]);
+
+    // gather the positions chunk-wise in parallel, using the batch accessors
+    constexpr int64_t chunk_size = 1024;
+    for (unsigned int pli = 0; pli < plc; ++pli) {
+        auto const& store = dat.AccessParticles(pli).GetParticleStore();
+        int64_t const cnt = static_cast<int64_t>(this->listOffsets[pli + 1] - this->listOffsets[pli]);
+        int64_t const num_chunks = (cnt + chunk_size - 1) / chunk_size;
+        float* out = this->positions.data() + 3 * this->listOffsets[pli];
+#pragma omp parallel for
+        for (int64_t c = 0; c < num_chunks; ++c) {
+            std::array<float, chunk_size> x, y, z;
+            int64_t const first = c * chunk_size;
+            int64_t const n = std::min(chunk_size, cnt - first);
+            store.GetPositions(first, n, x.data(), y.data(), z.data());
+            for (int64_t i = 0; i < n; ++i) {
+                out[3 * (first + i) + 0] = x[i];
+                out[3 * (first + i) + 1] = y[i];
+                out[3 * (first + i) + 2] = z[i];
+            }
+        }
+    }
+
+    this->tree = std::make_unique<Tree>(this->positions, std::max(1u, maxLeafSize));
+}
+
+
+/*
+ * datatools::SpatialIndex::~SpatialIndex
+ */
+datatools::SpatialIndex::~SpatialIndex() = default;
+
+
+/*
+ * datatools::SpatialIndex::ListOf
+ */
+unsigned int datatools::SpatialIndex::ListOf(size_t idx) const {
+    auto const it = std::upper_bound(this->listOffsets.begin(), this->listOffsets.end(), idx);
+    return static_cast<unsigned int>(std::distance(this->listOffsets.begin(), it) - 1);
+}
+
+
+/*
+ * datatools::SpatialIndex::Matches
+ */
+bool datatools::SpatialIndex::Matches(std::vector<size_t> const& listCounts) const {
+    if (listCounts.size() != this->ListCount()) {
+        return false;
+    }
+    for (unsigned int l = 0; l < this->ListCount(); ++l) {
+        if (this->listOffsets[l + 1] - this->listOffsets[l] != listCounts[l]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * datatools::SpatialIndex::forEachImage
+ */
+template<class F>
+void datatools::SpatialIndex::forEachImage(float const* query, float range, F&& f) const {
+    float const low[3] = {this->bbox.Left(), this->bbox.Bottom(), this->bbox.Back()};
+    float const high[3] = {this->bbox.Right(), this->bbox.Top(), this->bbox.Front()};
+
+    // per axis: no shift, and shifts across the boundaries the query is close to
+    std::array<std::array<float, 3>, 3> shifts;
+    std::array<int, 3> shift_cnt;
+    for (int a = 0; a < 3; ++a) {
+        float const period = high[a] - low[a];
+        shifts[a][0] = 0.0f;
+        shift_cnt[a] = 1;
+        if (!this->periodic[a]) {
+            continue;
+        }
+        if (query[a] - low[a] < range) {
+            shifts[a][shift_cnt[a]++] = period;
+        }
+        if (high[a] - query[a] < range) {
+            shifts[a][shift_cnt[a]++] = -period;
+        }
+    }
+
+    float image[3];
+    for (int x = 0; x < shift_cnt[0]; ++x) {
+        for (int y = 0; y < shift_cnt[1]; ++y) {
+            for (int z = 0; z < shift_cnt[2]; ++z) {
+                if ((x == 0) && (y == 0) && (z == 0)) {
+                    continue; // the original query is handled by the caller
+                }
+                image[0] = query[0] + shifts[0][x];
+                image[1] = query[1] + shifts[1][y];
+                image[2] = query[2] + shifts[2][z];
+                f(image);
+            }
+        }
+    }
+}
+
+
+/**
+ * Sorts matches by distance and removes duplicates found through several
+ * periodic images, keeping the closest one.
+ */
+static void sortAndUnique(std::vector<datatools::SpatialIndex::match_t>& matches) {
+    std::sort(matches.begin(), matches.end(), [](auto const& l, auto const& r) {
+        return (l.first < r.first) || ((l.first == r.first) && (l.second < r.second));
+    });
+    matches.erase(std::unique(matches.begin(), matches.end(),
+                      [](auto const& l, auto const& r) { return l.first == r.first; }),
+        matches.end());
+    std::sort(matches.begin(), matches.end(), [](auto const& l, auto const& r) { return l.second < r.second; });
+}
+
+
+/*
+ * datatools::SpatialIndex::FindNearest
+ */
+size_t datatools::SpatialIndex::FindNearest(float const* query, size_t k, std::vector<match_t>& matches) const {
+    matches.clear();
+    if ((k == 0) || (this->Count() == 0)) {
+        return 0;
+    }
+
+    std::vector<match_t> heap;
+    heap.reserve(k);
+    auto search = [&](float const* q) {
+        this->tree->FindNearest(q, k, heap);
+        matches.insert(matches.end(), heap.begin(), heap.end());
+    };
+
+    search(query);
+    if (this->periodic[0] || this->periodic[1] || this->periodic[2]) {
+        // images only matter if they can be closer than the current k-th neighbour
+        float range = std::numeric_limits<float>::max();
+        if (matches.size() >= k) {
+            float maxDistSqr = 0.0f;
+            for (auto const& m : matches) {
+                maxDistSqr = std::max(maxDistSqr, m.second);
+            }
+            range = std::sqrt(maxDistSqr);
+        }
+        this->forEachImage(query, range, search);
+    }
+
+    sortAndUnique(matches);
+    if (matches.size() > k) {
+        matches.resize(k);
+    }
+    return matches.size();
+}
+
+
+/*
+ * datatools::SpatialIndex::FindInRadius
+ */
+size_t datatools::SpatialIndex::FindInRadius(float const* query, float radiusSqr, std::vector<match_t>& matches) const {
+    matches.clear();
+    if (this->Count() == 0) {
+        return 0;
+    }
+
+    this->tree->FindInRadius(query, radiusSqr, matches);
+    if (this->periodic[0] || this->periodic[1] || this->periodic[2]) {
+        this->forEachImage(query, std::sqrt(radiusSqr),
+            [&](float const* q) { this->tree->FindInRadius(q, radiusSqr, matches); });
+    }
+
+    sortAndUnique(matches);
+    return matches.size();
+}
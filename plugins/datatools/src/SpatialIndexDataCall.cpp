@@ -0,0 +1,18 @@
+/*
+ * SpatialIndexDataCall.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#include "datatools/SpatialIndexDataCall.h"
+
+using namespace megamol;
+using namespace megamol::datatools;
+
+SpatialIndexDataCall::SpatialIndexDataCall() : core::AbstractGetData3DCall(), index(nullptr) {
+    // intentionally empty
+}
+
+SpatialIndexDataCall::~SpatialIndexDataCall() {
+    index.reset();
+}
@@ -52,6 +52,7 @@
 #include "ParticleNeighborhoodGraph.h"
 #include "ParticleRelaxationModule.h"
 #include "ParticleSortFixHack.h"
+#include "ParticleSpatialIndex.h"
 #include "ParticleThermodyn.h"
 #include "ParticleThinner.h"
 #include "ParticleTranslateRotateScale.h"
@@ -66,12 +67,15 @@
 #include "datatools/GraphDataCall.h"
 #include "datatools/MultiIndexListDataCall.h"
 #include "datatools/ParticleFilterMapDataCall.h"
+#include "datatools/SpatialIndexDataCall.h"
 #include "datatools/clustering/ParticleIColClustering.h"
+#include "datatools/table/ColumnarTableDataCall.h"
 #include "datatools/table/TableDataCall.h"
 #include "io/CPERAWDataSource.h"
 #include "io/MMGDDDataSource.h"
 #include "io/MMGDDWriter.h"
 #include "table/CSVDataSource.h"
+#include "table/ColumnarToTable.h"
 #include "table/MMFTDataSource.h"
 #include "table/MMFTDataWriter.h"
 #include "table/ParticlesToTable.h"
@@ -87,6 +91,7 @@
 #include "table/TableSelectionTx.h"
 #include "table/TableSort.h"
 #include "table/TableSplit.h"
+#include "table/TableToColumnar.h"
 #include "table/TableToLines.h"
 #include "table/TableToParticles.h"
 #include "table/TableWhere.h"
@@ -177,6 +182,8 @@ public:
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::ParticleInstantiator>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::MPDCGrid>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::table::TableSplit>();
+        this->module_descriptions.RegisterAutoDescription<megamol::datatools::table::TableToColumnar>();
+        this->module_descriptions.RegisterAutoDescription<megamol::datatools::table::ColumnarToTable>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::CSVWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::clustering::ParticleIColClustering>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::AddParticleColors>();
@@ -186,11 +193,14 @@ public:
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::TableInspector>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::ParticleListFilter>();
         this->module_descriptions.RegisterAutoDescription<megamol::datatools::SiffCSplineFitter>();
+        this->module_descriptions.RegisterAutoDescription<megamol::datatools::ParticleSpatialIndex>();
         // register calls
         this->call_descriptions.RegisterAutoDescription<megamol::datatools::table::TableDataCall>();
+        this->call_descriptions.RegisterAutoDescription<megamol::datatools::table::ColumnarTableDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::datatools::ParticleFilterMapDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::datatools::GraphDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::datatools::MultiIndexListDataCall>();
+        this->call_descriptions.RegisterAutoDescription<megamol::datatools::SpatialIndexDataCall>();
     }
 };
 } // namespace megamol::datatools
@@ -14,16 +14,32 @@
 #include "mmcore/param/IntParam.h"
 #include "mmcore/param/StringParam.h"
 
-#include "vislib/StringTokeniser.h"
-#include "vislib/sys/ASCIIFileBuffer.h"
+#include "MMFTFormat.h"
+#include "mmcore/utility/log/Log.h"
+#include "vislib/Exception.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <omp.h>
 #include <random>
 #include <sstream>
 #include <vector>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 using namespace megamol::datatools;
 using namespace megamol::datatools::table;
 using namespace megamol;
@@ -78,6 +94,122 @@ double parseValue(const char* tokenStart, const char* tokenEnd) {
     return NAN;
 }
 
+namespace {
+
+/** Size of the blocks the file is read and parsed in */
+constexpr std::size_t ChunkSize = 64 * 1024 * 1024;
+
+/** Identifies the key appended to the binary cache of a CSV file */
+constexpr char CacheMagic[4] = {'C', 'S', 'V', 'C'};
+
+/** Identifies the CSV file and parser configuration a binary cache was made from */
+struct CacheKey {
+    uint64_t fileSize;
+    int64_t fileTime;
+    uint64_t settingsHash;
+
+    bool operator==(const CacheKey& rhs) const {
+        return (fileSize == rhs.fileSize) && (fileTime == rhs.fileTime) && (settingsHash == rhs.settingsHash);
+    }
+};
+
+/** A private, writable mapping of a file, empty if mapping failed */
+struct MappedFile {
+    std::shared_ptr<char> data;
+    std::size_t size = 0;
+};
+
+/**
+ * Maps 'path' copy-on-write, so that the parser may modify the content in
+ * place without touching the file.
+ */
+MappedFile mapFile(const std::filesystem::path& path) {
+    MappedFile mapped;
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec || (size == 0)) {
+        return mapped;
+    }
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return mapped;
+    }
+    HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (mapping == nullptr) {
+        return mapped;
+    }
+    // the view keeps the mapping object alive
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (view == nullptr) {
+        return mapped;
+    }
+    mapped.data = std::shared_ptr<char>(static_cast<char*>(view), [](char* p) { ::UnmapViewOfFile(p); });
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return mapped;
+    }
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return mapped;
+    }
+    const auto len = static_cast<std::size_t>(size);
+    ::madvise(view, len, MADV_SEQUENTIAL);
+    mapped.data = std::shared_ptr<char>(static_cast<char*>(view), [len](char* p) { ::munmap(p, len); });
+#endif
+    mapped.size = static_cast<std::size_t>(size);
+    return mapped;
+}
+
+/**
+ * Parses a number, trying the locale-independent std::from_chars first and
+ * falling back to 'parseValue' for everything it does not accept (e.g. timestamps).
+ */
+double parseNumber(const char* tokenStart, const char* tokenEnd) {
+    while ((tokenStart != tokenEnd) && std::isspace(static_cast<unsigned char>(*tokenStart))) {
+        ++tokenStart;
+    }
+#ifdef __cpp_lib_to_chars
+    double number;
+    auto const res = std::from_chars(tokenStart, tokenEnd, number);
+    if ((res.ec == std::errc()) && (res.ptr == tokenEnd)) {
+        return number;
+    }
+#endif
+    return parseValue(tokenStart, tokenEnd);
+}
+
+/** Finds the next column separator in [start, end), or returns end */
+inline char* findSeparator(char* start, char* end, const std::string& sep) {
+    if (sep.size() == 1) {
+        // memchr is vectorised by all relevant C libraries
+        auto* e = static_cast<char*>(std::memchr(start, sep[0], end - start));
+        return (e != nullptr) ? e : end;
+    }
+    return std::search(start, end, sep.begin(), sep.end());
+}
+
+std::vector<std::string> splitLine(const std::string& line, const std::string& sep) {
+    std::vector<std::string> tokens;
+    std::string::size_type start = 0;
+    while (true) {
+        auto const end = line.find(sep, start);
+        tokens.push_back(line.substr(start, end - start));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + sep.size();
+    }
+    return tokens;
+}
+
+} // namespace
+
 CSVDataSource::CSVDataSource()
         : core::Module()
         , filenameSlot("filename", "Filename to read from")
@@ -89,10 +221,14 @@ CSVDataSource::CSVDataSource()
         , colSepSlot("colSep", "The column separator (detected if empty)")
         , decSepSlot("decSep", "The decimal point parser format type")
         , shuffleSlot("shuffle", "Shuffle data points")
+        , useCacheSlot("useCache", "Reads and writes a binary cache (<filename>.mmft) of the parsed data")
+        , backgroundSlot("loadInBackground", "Parses the file without blocking, providing an empty table until done")
         , getDataSlot("getData", "Slot providing the data")
         , dataHash(0)
         , columns()
-        , values() {
+        , values()
+        , loaderCancel(false)
+        , loaderDone(false) {
     this->filenameSlot << new core::param::FilePathParam("");
     this->MakeSlotAvailable(&this->filenameSlot);
 
@@ -125,6 +261,12 @@ CSVDataSource::CSVDataSource()
     this->shuffleSlot.SetParameter(new core::param::BoolParam(false));
     this->MakeSlotAvailable(&this->shuffleSlot);
 
+    this->useCacheSlot.SetParameter(new core::param::BoolParam(false));
+    this->MakeSlotAvailable(&this->useCacheSlot);
+
+    this->backgroundSlot.SetParameter(new core::param::BoolParam(false));
+    this->MakeSlotAvailable(&this->backgroundSlot);
+
     this->getDataSlot.SetCallback(TableDataCall::ClassName(), "GetData", &CSVDataSource::getDataCallback);
     this->getDataSlot.SetCallback(TableDataCall::ClassName(), "GetHash", &CSVDataSource::getHashCallback);
     this->MakeSlotAvailable(&this->getDataSlot);
@@ -140,11 +282,32 @@ bool CSVDataSource::create() {
 }
 
 void CSVDataSource::release() {
+    this->stopLoader();
     this->columns.clear();
     this->values.clear();
 }
 
+void CSVDataSource::stopLoader() {
+    if (this->loader.joinable()) {
+        this->loaderCancel = true;
+        this->loader.join();
+    }
+    this->pendingColumns.clear();
+    this->pendingValues.clear();
+}
+
 void CSVDataSource::assertData() {
+    if (this->loader.joinable() && this->loaderDone) {
+        // the background load finished, publish its results
+        this->loader.join();
+        this->columns = std::move(this->pendingColumns);
+        this->values = std::move(this->pendingValues);
+        this->pendingColumns.clear();
+        this->pendingValues.clear();
+        shuffleData();
+        this->dataHash++;
+    }
+
     if (!this->filenameSlot.IsDirty() && !this->skipPrefaceSlot.IsDirty() && !this->headerNamesSlot.IsDirty() &&
         !this->headerTypesSlot.IsDirty() && !this->commentPrefixSlot.IsDirty() && !this->colSepSlot.IsDirty() &&
         !this->decSepSlot.IsDirty()) {
@@ -165,68 +328,190 @@ void CSVDataSource::assertData() {
     this->decSepSlot.ResetDirty();
     this->shuffleSlot.ResetDirty();
 
+    this->stopLoader();
     this->columns.clear();
     this->values.clear();
 
-    auto filename = this->filenameSlot.Param<core::param::FilePathParam>()->Value();
+    LoadSettings settings;
+    settings.filename = this->filenameSlot.Param<core::param::FilePathParam>()->Value();
+    settings.skipPreface = this->skipPrefaceSlot.Param<core::param::IntParam>()->Value();
+    settings.headerNames = this->headerNamesSlot.Param<core::param::BoolParam>()->Value();
+    settings.headerTypes = this->headerTypesSlot.Param<core::param::BoolParam>()->Value();
+    settings.commentPrefix = this->commentPrefixSlot.Param<core::param::StringParam>()->Value();
+    settings.colSep = this->colSepSlot.Param<core::param::StringParam>()->Value();
+    settings.decType = this->decSepSlot.Param<core::param::EnumParam>()->Value();
+    settings.useCache = this->useCacheSlot.Param<core::param::BoolParam>()->Value();
+
+    if (this->backgroundSlot.Param<core::param::BoolParam>()->Value()) {
+        this->loaderCancel = false;
+        this->loaderDone = false;
+        this->loader = std::thread([this, settings]() {
+            if (!loadFile(settings, this->pendingColumns, this->pendingValues, this->loaderCancel)) {
+                this->pendingColumns.clear();
+                this->pendingValues.clear();
+            }
+            this->loaderDone = true;
+        });
+        this->dataHash++;
+        return;
+    }
 
-    try {
-        vislib::sys::ASCIIFileBuffer file;
+    std::atomic<bool> noCancel(false);
+    if (!loadFile(settings, this->columns, this->values, noCancel)) {
+        this->columns.clear();
+        this->values.clear();
+    }
 
-        // 1. Load the whole file into memory (FAST!)
-        //////////////////////////////////////////////////////////////////////
-        if (!file.LoadFile(filename.native().c_str(), vislib::sys::ASCIIFileBuffer::PARSING_LINES))
-            throw vislib::Exception(__FILE__, __LINE__);
-        if (file.Count() < 2)
-            throw vislib::Exception("No data in CSV file", __FILE__, __LINE__);
+    shuffleData();
+
+    this->dataHash++;
+}
 
-        // 2. Determine the first row, column separator, and decimal point
+bool CSVDataSource::loadFile(const LoadSettings& settings, std::vector<TableDataCall::ColumnInfo>& columns,
+    std::vector<float>& values, const std::atomic<bool>& cancel) {
+    using megamol::core::utility::log::Log;
+
+    const auto& filename = settings.filename;
+    columns.clear();
+    values.clear();
+
+    try {
+        // 0. Use the binary cache if it was made from this very file and configuration
         //////////////////////////////////////////////////////////////////////
-        int firstHeaRow = this->skipPrefaceSlot.Param<core::param::IntParam>()->Value();
-        int firstDatRow = this->skipPrefaceSlot.Param<core::param::IntParam>()->Value();
-        if (headerNamesSlot.Param<core::param::BoolParam>()->Value())
-            firstDatRow++;
-        if (headerTypesSlot.Param<core::param::BoolParam>()->Value())
-            firstDatRow++;
-
-        auto comment = vislib::StringA(this->commentPrefixSlot.Param<core::param::StringParam>()->Value().c_str());
-        if (!comment.IsEmpty()) {
-            // Skip comments at the beginning of the file.
-            while (firstHeaRow < file.Count()) {
-                if (!vislib::StringA(file[firstHeaRow]).StartsWith(comment)) {
-                    break;
+        CacheKey key;
+        key.fileSize = static_cast<uint64_t>(std::filesystem::file_size(filename));
+        key.fileTime = static_cast<int64_t>(std::filesystem::last_write_time(filename).time_since_epoch().count());
+        {
+            std::stringstream ss;
+            ss << settings.skipPreface << '|' << settings.headerNames << '|' << settings.headerTypes << '|'
+               << settings.commentPrefix << '|' << settings.colSep << '|' << settings.decType;
+            key.settingsHash = static_cast<uint64_t>(std::hash<std::string>()(ss.str()));
+        }
+        auto cachePath = filename;
+        cachePath += ".mmft";
+
+        if (settings.useCache && std::filesystem::exists(cachePath)) {
+            try {
+                // check the table header and the trailing key before reading the whole table
+                const auto cacheSize = std::filesystem::file_size(cachePath);
+                constexpr std::size_t trailerSize = sizeof(CacheMagic) + sizeof(CacheKey);
+                std::ifstream cache(cachePath, std::ios::binary);
+                char header[6] = {};
+                char magic[4] = {};
+                CacheKey cacheKey;
+                if (cacheSize > sizeof(header) + trailerSize) {
+                    cache.read(header, sizeof(header));
+                    cache.seekg(static_cast<std::streamoff>(cacheSize - trailerSize));
+                    cache.read(magic, sizeof(magic));
+                    cache.read(reinterpret_cast<char*>(&cacheKey), sizeof(CacheKey));
+                }
+                if (cache.good() && (std::memcmp(header, "MMFTD", sizeof(header)) == 0) &&
+                    (std::memcmp(magic, CacheMagic, sizeof(magic)) == 0) && (cacheKey == key)) {
+                    cache.seekg(0);
+                    mmft::ReadTable(cache, columns, values);
+                    if (static_cast<uint64_t>(cache.tellg()) == cacheSize - trailerSize) {
+                        Log::DefaultLog.WriteInfo("Tabular data loaded from cache \"%s\": %u dimensions; %u samples\n",
+                            cachePath.generic_u8string().c_str(), static_cast<unsigned int>(columns.size()),
+                            static_cast<unsigned int>(columns.empty() ? 0 : values.size() / columns.size()));
+                        return true;
+                    }
                 }
-                firstHeaRow++;
-                firstDatRow++;
+            } catch (const std::exception&) {
+                // fall through and parse the CSV file
             }
+            columns.clear();
+            values.clear();
         }
 
-        vislib::StringA colSep(this->colSepSlot.Param<core::param::StringParam>()->Value().c_str());
-        if (colSep.IsEmpty()) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+            throw vislib::Exception("Unable to open file", __FILE__, __LINE__);
+
+        auto readLine = [&file](std::string& line) -> bool {
+            if (!std::getline(file, line))
+                return false;
+            if (!line.empty() && (line.back() == '\r'))
+                line.pop_back();
+            return true;
+        };
+
+        // 1. Determine the first row, column separator, and decimal point
+        //////////////////////////////////////////////////////////////////////
+        std::string firstLine;
+        for (int i = 0; i < settings.skipPreface; ++i) {
+            if (!readLine(firstLine))
+                throw vislib::Exception("No data in CSV file", __FILE__, __LINE__);
+        }
+
+        // Skip comments at the beginning of the file.
+        std::streampos dataPos;
+        do {
+            dataPos = file.tellg();
+            if (!readLine(firstLine))
+                throw vislib::Exception("No data in CSV file", __FILE__, __LINE__);
+        } while (!settings.commentPrefix.empty() && (firstLine.compare(0, settings.commentPrefix.size(),
+                                                         settings.commentPrefix) == 0));
+
+        std::string colSep = settings.colSep;
+        if (colSep.empty()) {
             // Detect column separator
             const char ColSepCanidates[] = {'\t', ';', ',', '|'};
-            vislib::StringA l1(file[firstHeaRow]);
-            vislib::StringA l2(file[firstHeaRow]);
             for (int i = 0; i < sizeof(ColSepCanidates) / sizeof(char); ++i) {
-                SIZE_T c1 = l1.Count(ColSepCanidates[i]);
-                if ((c1 > 0) && (c1 == l2.Count(ColSepCanidates[i]))) {
-                    colSep.Append(ColSepCanidates[i]);
+                if (std::count(firstLine.begin(), firstLine.end(), ColSepCanidates[i]) > 0) {
+                    colSep.push_back(ColSepCanidates[i]);
                     break;
                 }
             }
-            if (colSep.IsEmpty()) {
+            if (colSep.empty()) {
                 throw vislib::Exception("Failed to detect column separator", __FILE__, __LINE__);
             }
         }
 
-        DecimalSeparator decType =
-            static_cast<DecimalSeparator>(this->decSepSlot.Param<core::param::EnumParam>()->Value());
+        // 2. Table layout is now clear... determine column headers.
+        //////////////////////////////////////////////////////////////////////
+        std::vector<std::string> dimNames = splitLine(firstLine, colSep);
+        if (settings.headerNames) {
+            dataPos = file.tellg();
+        } else {
+            for (std::size_t i = 0; i < dimNames.size(); ++i) {
+                dimNames[i] = "Dim " + std::to_string(i);
+            }
+        }
+        columns.resize(dimNames.size());
+
+        bool hasCatDims = false;
+        std::vector<std::string> types;
+        if (settings.headerTypes) {
+            std::string typeLine;
+            if (settings.headerNames) {
+                readLine(typeLine);
+                dataPos = file.tellg();
+            } else {
+                // without names, the types are given in the first row
+                typeLine = firstLine;
+                dataPos = file.tellg();
+            }
+            types = splitLine(typeLine, colSep);
+        }
+        for (std::size_t i = 0; i < dimNames.size(); i++) {
+            TableDataCall::ColumnType type = TableDataCall::ColumnType::QUANTITATIVE;
+            if ((types.size() > i) && vislib::StringA(types[i].c_str()).Equals("CATEGORICAL", true)) {
+                type = TableDataCall::ColumnType::CATEGORICAL;
+                hasCatDims = true;
+            }
+            columns[i].SetName(dimNames[i]).SetType(type).SetMinimumValue(0.0f).SetMaximumValue(1.0f);
+        }
+
+        DecimalSeparator decType = static_cast<DecimalSeparator>(settings.decType);
         if (decType == DecimalSeparator::Unknown) {
-            // Detect decimal type
-            vislib::Array<vislib::StringA> tokens(vislib::StringTokeniserA::Split(file[firstDatRow], colSep, false));
-            for (SIZE_T i = 0; i < tokens.Count(); i++) {
-                bool hasDot = tokens[i].Contains('.');
-                bool hasComma = tokens[i].Contains(',');
+            // Detect decimal type from the first data row
+            std::string dataLine;
+            file.clear();
+            file.seekg(dataPos);
+            readLine(dataLine);
+            for (auto const& token : splitLine(dataLine, colSep)) {
+                bool hasDot = token.find('.') != std::string::npos;
+                bool hasComma = token.find(',') != std::string::npos;
                 if (hasDot && !hasComma) {
                     decType = DecimalSeparator::US;
                     break;
@@ -240,144 +525,159 @@ void CSVDataSource::assertData() {
                 decType = DecimalSeparator::US;
             }
         }
+        file.clear();
+        file.seekg(dataPos);
 
-        // 3. Table layout is now clear... determine column headers.
+        // 3. Data format is now clear... parse the actual data chunk by chunk
         //////////////////////////////////////////////////////////////////////
-        vislib::Array<vislib::StringA> dimNames;
-        if (headerNamesSlot.Param<core::param::BoolParam>()->Value()) {
-            dimNames = vislib::StringTokeniserA::Split(file[firstHeaRow], colSep, false);
-            firstHeaRow++;
-        } else {
-            dimNames = vislib::StringTokeniserA::Split(file[firstHeaRow], colSep, false);
-            for (SIZE_T i = 0; i < dimNames.Count(); ++i) {
-                dimNames[i].Format("Dim %d", static_cast<int>(i));
+        const std::size_t colCnt = columns.size();
+        const int thCnt = omp_get_max_threads();
+        std::vector<std::map<std::string, float>> catMaps(colCnt * thCnt);
+        int invalidCnt = 0;
+
+        const auto dataBytes = key.fileSize - static_cast<uint64_t>(dataPos);
+        uint64_t bytesDone = 0;
+        int nextProgress = 10;
+
+        // Parse the chunks right in a mapping of the file, reading them into a buffer only if mapping fails.
+        const MappedFile mapped = mapFile(filename);
+        std::size_t mappedPos = static_cast<std::size_t>(dataPos);
+
+        std::vector<char> buf;
+        std::vector<std::pair<char*, char*>> lines;
+        std::size_t carry = 0;
+        bool isLast = false;
+        while (!isLast) {
+            if (cancel) {
+                return false;
             }
-        }
-        this->columns.resize(dimNames.Count());
-        this->values.clear();
 
-        bool hasCatDims = false;
-        if (headerTypesSlot.Param<core::param::BoolParam>()->Value()) {
-            vislib::Array<vislib::StringA> tokens(vislib::StringTokeniserA::Split(file[firstHeaRow], colSep, false));
-            for (SIZE_T i = 0; i < dimNames.Count(); i++) {
-                TableDataCall::ColumnType type = TableDataCall::ColumnType::QUANTITATIVE;
-                if (tokens.Count() > i && tokens[i].Equals("CATEGORICAL", true)) {
-                    type = TableDataCall::ColumnType::CATEGORICAL;
-                    hasCatDims = true;
-                }
-                this->columns[i]
-                    .SetName(dimNames[i].PeekBuffer())
-                    .SetType(type)
-                    .SetMinimumValue(0.0f)
-                    .SetMaximumValue(1.0f);
-            }
-        } else {
-            for (SIZE_T i = 0; i < dimNames.Count(); i++) {
-                this->columns[i]
-                    .SetName(dimNames[i].PeekBuffer())
-                    .SetType(TableDataCall::ColumnType::QUANTITATIVE)
-                    .SetMinimumValue(0.0f)
-                    .SetMaximumValue(1.0f);
+            char* chunk;
+            std::size_t len;
+            if (mapped.data != nullptr) {
+                chunk = mapped.data.get() + mappedPos;
+                len = std::min(carry + ChunkSize, mapped.size - mappedPos);
+                isLast = (mappedPos + len == mapped.size);
+            } else {
+                buf.resize(carry + ChunkSize);
+                file.read(buf.data() + carry, ChunkSize);
+                const auto got = static_cast<std::size_t>(file.gcount());
+                chunk = buf.data();
+                len = carry + got;
+                isLast = (got < ChunkSize);
             }
-        }
 
-        // 4. Data format is now clear... finally parse actual data
-        //////////////////////////////////////////////////////////////////////
-        size_t colCnt = static_cast<size_t>(this->columns.size());
-        size_t rowCnt = static_cast<size_t>(file.Count() - firstDatRow);
-        int colSepEnd = colSep.Length() - 1;
-
-        // Test for empty lines at the end
-        for (; rowCnt > 0; --rowCnt) {
-            const char* start = file[firstDatRow + rowCnt - 1];
-            const char* end = start;
-            size_t col = 0;
-            while ((*end != '\0') && (col < colCnt)) {
-                int colSepPos = 0;
-                while ((*end != '\0') && ((*end != colSep[colSepEnd]) || (colSepEnd != colSepPos))) {
-                    if (*end == colSep[colSepPos])
-                        colSepPos++;
-                    else
-                        colSepPos = 0;
-                    ++end;
+            // The chunk ends after its last line break, the rest is carried over.
+            std::size_t end = len;
+            if (!isLast) {
+                while ((end > 0) && (chunk[end - 1] != '\n'))
+                    --end;
+                if (end == 0) {
+                    carry = len; // a single line spans the whole chunk, read on
+                    continue;
                 }
-                col++;
             }
-            if (col >= colCnt)
-                break; // we found the last line containing a full data set
-        }
 
-        // Parse in parallel, assuming all lines will work
-        std::vector<std::map<std::string, float>> catMaps;
-        int thCnt = omp_get_max_threads();
-        catMaps.resize(colCnt * thCnt);
-        values.resize(colCnt * rowCnt);
-        bool hasInvalids = false;
-
-#pragma omp parallel for
-        for (long long idx = 0; idx < static_cast<long long>(rowCnt); ++idx) {
-            int thId = omp_get_thread_num();
-            const char* start = file[static_cast<size_t>(firstDatRow + idx)];
-            const char* end = start;
-            size_t col = 0;
-            while ((*end != '\0') && (col < colCnt)) {
-                std::map<std::string, float>& catMap = catMaps[thId + col * thCnt];
-                int colSepPos = 0;
-                while ((*end != '\0') && ((*end != colSep[colSepEnd]) || (colSepEnd != colSepPos))) {
-                    if (*end == colSep[colSepPos])
-                        colSepPos++;
-                    else
-                        colSepPos = 0;
-                    ++end;
-                }
+            lines.clear();
+            char* p = chunk;
+            char* const stop = chunk + end;
+            while (p < stop) {
+                auto* e = static_cast<char*>(std::memchr(p, '\n', stop - p));
+                if (e == nullptr)
+                    e = stop;
+                char* le = e;
+                if ((le > p) && (le[-1] == '\r'))
+                    --le;
+                if (le > p)
+                    lines.emplace_back(p, le); // empty lines are skipped
+                p = e + 1;
+            }
 
-                if (this->columns[col].Type() == TableDataCall::ColumnType::QUANTITATIVE) {
-                    if (decType == DecimalSeparator::DE) {
-                        for (char* ez = const_cast<char*>(start); ez != end; ++ez)
-                            if (*ez == ',')
-                                *ez = '.';
-                    }
-                    double value = parseValue(start, end);
-                    values[static_cast<size_t>(idx * colCnt + col)] = static_cast<float>(value);
-                    if (std::isnan(value)) {
-                        hasInvalids = true;
+            // Reserve the estimated final size after the first chunk, to avoid repeated regrowth.
+            const std::size_t rowBase = values.size() / std::max<std::size_t>(colCnt, 1);
+            if ((rowBase == 0) && !isLast && (end > 0)) {
+                values.reserve(static_cast<std::size_t>(1.05 * dataBytes / end * lines.size()) * colCnt);
+            }
+            values.resize(values.size() + lines.size() * colCnt);
+
+#pragma omp parallel for reduction(+ : invalidCnt)
+            for (long long idx = 0; idx < static_cast<long long>(lines.size()); ++idx) {
+                int thId = omp_get_thread_num();
+                char* start = lines[idx].first;
+                char* const lineEnd = lines[idx].second;
+                float* row = values.data() + (rowBase + idx) * colCnt;
+                std::size_t col = 0;
+                while (col < colCnt) {
+                    char* tokenEnd = findSeparator(start, lineEnd, colSep);
+
+                    if (columns[col].Type() == TableDataCall::ColumnType::QUANTITATIVE) {
+                        if (decType == DecimalSeparator::DE) {
+                            std::replace(start, tokenEnd, ',', '.');
+                        }
+                        double value = parseNumber(start, tokenEnd);
+                        row[col] = static_cast<float>(value);
+                        if (std::isnan(value)) {
+                            ++invalidCnt;
+                        }
+                    } else if (columns[col].Type() == TableDataCall::ColumnType::CATEGORICAL) {
+                        assert(hasCatDims);
+                        std::map<std::string, float>& catMap = catMaps[thId + col * thCnt];
+                        std::string token(start, tokenEnd);
+                        auto cmi = catMap.find(token);
+                        if (cmi == catMap.end()) {
+                            cmi = catMap
+                                      .insert(std::pair<std::string, float>(
+                                          token, static_cast<float>(thId + thCnt * catMap.size())))
+                                      .first;
+                        }
+                        row[col] = cmi->second;
+                    } else {
+                        assert(false);
                     }
-                } else if (this->columns[col].Type() == TableDataCall::ColumnType::CATEGORICAL) {
-                    assert(hasCatDims);
-                    std::map<std::string, float>::iterator cmi = catMap.find(start);
-                    if (cmi == catMap.end()) {
-                        cmi = catMap
-                                  .insert(std::pair<std::string, float>(
-                                      start, static_cast<float>(thId + thCnt * catMap.size())))
-                                  .first;
+
+                    col++;
+                    if (tokenEnd == lineEnd) {
+                        break;
                     }
-                    values[static_cast<size_t>(idx * colCnt + col)] = cmi->second;
-                } else {
-                    assert(false);
+                    start = tokenEnd + colSep.size();
                 }
-
-                col++;
-                if (*end != '\0') {
-                    start = end + 1;
-                    end = start;
+                for (; col < colCnt; ++col) {
+                    row[col] = std::numeric_limits<float>::quiet_NaN();
+                    ++invalidCnt;
                 }
             }
-            for (; col < colCnt; ++col) {
-                values[static_cast<size_t>(idx * colCnt + col)] = std::numeric_limits<float>::quiet_NaN();
-                hasInvalids = true;
+
+            if (mapped.data != nullptr) {
+                mappedPos += end;
+                carry = 0;
+            } else {
+                carry = len - end;
+                std::memmove(buf.data(), buf.data() + end, carry);
+            }
+
+            bytesDone += end;
+            while ((dataBytes > 0) && (nextProgress < 100) && (bytesDone * 100 >= nextProgress * dataBytes)) {
+                Log::DefaultLog.WriteInfo(
+                    "CSVDataSource: parsed %d%% of \"%s\"", nextProgress, filename.generic_u8string().c_str());
+                nextProgress += 10;
             }
         }
+        buf.clear();
+        buf.shrink_to_fit();
+
+        const std::size_t rowCnt = values.size() / std::max<std::size_t>(colCnt, 1);
+        const bool hasInvalids = (invalidCnt > 0);
 
         // Report invalid data if present (note: do not drop data!)
         if (hasInvalids) {
-            megamol::core::utility::log::Log::DefaultLog.WriteWarn("CSV file contains invalid data:");
+            Log::DefaultLog.WriteWarn("CSV file contains invalid data (data rows, not counting headers):");
             for (size_t c = 0; c < colCnt; ++c) {
                 std::stringstream ss;
                 bool invalidColumn = true;
                 for (size_t r = 0; r < rowCnt; ++r) {
                     float value = values[r * colCnt + c];
                     if (std::isnan(value)) {
-                        size_t line = 1 + firstDatRow + r;
+                        size_t line = 1 + r;
                         ss << line << " ";
                     } else {
                         invalidColumn = false;
@@ -437,32 +737,64 @@ void CSVDataSource::assertData() {
             columns[c].SetMinimumValue(minVals[c]).SetMaximumValue(maxVals[c]);
         }
 
-        // 5. All done... report summary
+        // 4. All done... report summary
         //////////////////////////////////////////////////////////////////////
         megamol::core::utility::log::Log::DefaultLog.WriteInfo("Tabular data loaded: %u dimensions; %u samples\n",
             static_cast<unsigned int>(colCnt), static_cast<unsigned int>(rowCnt));
 
+        // 5. Store the binary cache for the next time
+        //////////////////////////////////////////////////////////////////////
+        if (settings.useCache) {
+            // write to a temporary file first, so that an interrupted write never leaves a truncated cache behind
+            auto tmpPath = cachePath;
+            tmpPath += ".tmp";
+            bool written = false;
+            {
+                std::ofstream cache(tmpPath, std::ios::binary);
+                if (cache.is_open()) {
+                    mmft::WriteTable(cache, colCnt, columns.data(), rowCnt, values.data());
+                    cache.write(CacheMagic, sizeof(CacheMagic));
+                    cache.write(reinterpret_cast<const char*>(&key), sizeof(CacheKey));
+                    cache.close();
+                    written = !cache.fail();
+                }
+            }
+            std::error_code ec;
+            if (written) {
+                std::filesystem::rename(tmpPath, cachePath, ec);
+            }
+            if (!written || ec) {
+                std::filesystem::remove(tmpPath, ec);
+                Log::DefaultLog.WriteWarn(
+                    "CSVDataSource: could not write cache \"%s\"", cachePath.generic_u8string().c_str());
+            }
+        }
+
     } catch (const vislib::Exception& ex) {
-        megamol::core::utility::log::Log::DefaultLog.WriteError("Could not load \"%s\": %s [%s, %d]",
-            filename.generic_u8string().c_str(), ex.GetMsgA(), ex.GetFile(), ex.GetLine());
-        this->columns.clear();
-        this->values.clear();
+        Log::DefaultLog.WriteError("Could not load \"%s\": %s [%s, %d]", filename.generic_u8string().c_str(),
+            ex.GetMsgA(), ex.GetFile(), ex.GetLine());
+        return false;
+    } catch (const std::exception& ex) {
+        Log::DefaultLog.WriteError("Could not load \"%s\": %s", filename.generic_u8string().c_str(), ex.what());
+        return false;
     } catch (...) {
-        this->columns.clear();
-        this->values.clear();
+        return false;
     }
 
-    shuffleData();
-
-    this->dataHash++;
+    return true;
 }
 
+
 void CSVDataSource::shuffleData() {
     if (!this->shuffleSlot.Param<core::param::BoolParam>()->Value()) {
         // Do not shuffle, unless requested
         return;
     }
 
+    if (columns.empty()) {
+        return;
+    }
+
     std::default_random_engine eng(static_cast<unsigned int>(dataHash));
     size_t numCols = columns.size();
     size_t numRows = values.size() / numCols;
@@ -510,6 +842,7 @@ bool CSVDataSource::getHashCallback(core::Call& caller) {
 }
 
 bool CSVDataSource::clearData(core::param::ParamSlot& caller) {
+    this->stopLoader();
     this->columns.clear();
     this->values.clear();
 
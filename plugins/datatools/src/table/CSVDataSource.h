@@ -12,6 +12,10 @@
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace megamol::datatools::table {
@@ -36,6 +40,34 @@ protected:
     void release() override;
 
 private:
+    /** The parser configuration, captured from the parameters on the calling thread */
+    struct LoadSettings {
+        std::filesystem::path filename;
+        int skipPreface;
+        bool headerNames;
+        bool headerTypes;
+        std::string commentPrefix;
+        std::string colSep;
+        int decType;
+        bool useCache;
+    };
+
+    /**
+     * Parses a CSV file chunk by chunk or loads its binary cache.
+     *
+     * @param settings The parser configuration.
+     * @param columns  Receives the column infos.
+     * @param values   Receives the row-major values.
+     * @param cancel   Stops parsing early if set by another thread.
+     *
+     * @return True on success.
+     */
+    static bool loadFile(const LoadSettings& settings, std::vector<TableDataCall::ColumnInfo>& columns,
+        std::vector<float>& values, const std::atomic<bool>& cancel);
+
+    /** Stops a background load, if any, and discards its results */
+    void stopLoader();
+
     inline void assertData();
     bool getDataCallback(core::Call& caller);
     bool getHashCallback(core::Call& caller);
@@ -52,6 +84,8 @@ private:
     core::param::ParamSlot colSepSlot;
     core::param::ParamSlot decSepSlot;
     core::param::ParamSlot shuffleSlot;
+    core::param::ParamSlot useCacheSlot;
+    core::param::ParamSlot backgroundSlot;
 
     core::CalleeSlot getDataSlot;
 
@@ -59,6 +93,13 @@ private:
 
     std::vector<TableDataCall::ColumnInfo> columns;
     std::vector<float> values;
+
+    /** The background loader and the results it produces */
+    std::thread loader;
+    std::atomic<bool> loaderCancel;
+    std::atomic<bool> loaderDone;
+    std::vector<TableDataCall::ColumnInfo> pendingColumns;
+    std::vector<float> pendingValues;
 };
 
 } // namespace megamol::datatools::table
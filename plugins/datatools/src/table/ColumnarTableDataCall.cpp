@@ -0,0 +1,59 @@
+/*
+ * ColumnarTableDataCall.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#include "datatools/table/ColumnarTableDataCall.h"
+
+using namespace megamol::datatools;
+using namespace megamol::datatools::table;
+using namespace megamol;
+
+
+ColumnarTableDataCall::ColumnarTableDataCall()
+        : core::AbstractGetDataCall()
+        , columns_count(0)
+        , rows_count(0)
+        , columns(nullptr)
+        , selection(nullptr)
+        , selection_count(0)
+        , frameCount(0)
+        , frameID(0) {
+    // intentionally empty
+}
+
+ColumnarTableDataCall::~ColumnarTableDataCall() {
+    columns = nullptr;   // do not delete, since we do not own the memory of the objects
+    selection = nullptr; // do not delete, since we do not own the memory of the objects
+}
+
+void ColumnarTableDataCall::WrapTable(const TableDataCall& src, std::vector<Column>& outCols) {
+    const auto colCnt = src.GetColumnsCount();
+    const auto stride = colCnt * sizeof(float);
+    outCols.clear();
+    outCols.reserve(colCnt);
+    for (size_t c = 0; c < colCnt; ++c) {
+        outCols.emplace_back(src.GetColumnsInfos()[c], ScalarType::FLOAT, src.GetData() + c, stride);
+    }
+}
+
+void ColumnarTableDataCall::Materialize(std::vector<ColumnInfo>& outInfos, std::vector<float>& outValues) const {
+    const auto colCnt = static_cast<int64_t>(this->columns_count);
+    const auto rowCnt = static_cast<int64_t>(this->GetRowsCount());
+
+    outInfos.resize(colCnt);
+    for (int64_t c = 0; c < colCnt; ++c) {
+        outInfos[c] = this->columns[c].Info();
+    }
+
+    outValues.resize(colCnt * rowCnt);
+#pragma omp parallel for
+    for (int64_t r = 0; r < rowCnt; ++r) {
+        const auto baseRow = this->BaseRow(r);
+        float* dst = outValues.data() + r * colCnt;
+        for (int64_t c = 0; c < colCnt; ++c) {
+            dst[c] = this->columns[c].Get<float>(baseRow);
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * ColumnarToTable.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "ColumnarToTable.h"
+
+#include "mmcore/utility/log/Log.h"
+
+using namespace megamol::datatools;
+using namespace megamol::datatools::table;
+using namespace megamol;
+
+
+/*
+ * ColumnarToTable::ColumnarToTable
+ */
+ColumnarToTable::ColumnarToTable()
+        : core::Module()
+        , slotOutput("output", "Provides the row-major table")
+        , slotInput("input", "Takes the columnar table") {
+
+    this->slotInput.SetCompatibleCall<ColumnarTableDataCallDescription>();
+    this->MakeSlotAvailable(&this->slotInput);
+
+    this->slotOutput.SetCallback(
+        TableDataCall::ClassName(), TableDataCall::FunctionName(0), &ColumnarToTable::getData);
+    this->slotOutput.SetCallback(
+        TableDataCall::ClassName(), TableDataCall::FunctionName(1), &ColumnarToTable::getHash);
+    this->MakeSlotAvailable(&this->slotOutput);
+}
+
+
+/*
+ * ColumnarToTable::~ColumnarToTable
+ */
+ColumnarToTable::~ColumnarToTable() {
+    this->Release();
+}
+
+
+/*
+ * ColumnarToTable::create
+ */
+bool ColumnarToTable::create() {
+    return true;
+}
+
+
+/*
+ * ColumnarToTable::release
+ */
+void ColumnarToTable::release() {
+    this->columns.clear();
+    this->values.clear();
+}
+
+
+/*
+ * ColumnarToTable::getData
+ */
+bool ColumnarToTable::getData(core::Call& c) {
+    using megamol::core::utility::log::Log;
+
+    auto* out = dynamic_cast<TableDataCall*>(&c);
+    if (out == nullptr)
+        return false;
+
+    auto* in = this->slotInput.CallAs<ColumnarTableDataCall>();
+    if (in == nullptr)
+        return false;
+
+    in->SetFrameID(out->GetFrameID());
+    if (!(*in)(0)) {
+        Log::DefaultLog.WriteError("ColumnarToTable: The call to %s of %s failed.",
+            ColumnarTableDataCall::FunctionName(0), ColumnarTableDataCall::ClassName());
+        return false;
+    }
+
+    if ((this->inputHash != in->DataHash()) || (this->frameID != in->GetFrameID())) {
+        in->Materialize(this->columns, this->values);
+        this->inputHash = in->DataHash();
+        this->frameID = in->GetFrameID();
+    }
+
+    out->Set(this->columns.size(), this->columns.empty() ? 0 : this->values.size() / this->columns.size(),
+        this->columns.data(), this->values.data());
+    out->SetFrameCount(in->GetFrameCount());
+    out->SetFrameID(this->frameID);
+    out->SetDataHash(this->inputHash);
+    out->SetUnlocker(nullptr);
+
+    return true;
+}
+
+
+/*
+ * ColumnarToTable::getHash
+ */
+bool ColumnarToTable::getHash(core::Call& c) {
+    using megamol::core::utility::log::Log;
+
+    auto* out = dynamic_cast<TableDataCall*>(&c);
+    if (out == nullptr)
+        return false;
+
+    auto* in = this->slotInput.CallAs<ColumnarTableDataCall>();
+    if (in == nullptr)
+        return false;
+
+    in->SetFrameID(out->GetFrameID());
+    if (!(*in)(1)) {
+        Log::DefaultLog.WriteError("ColumnarToTable: The call to %s of %s failed.",
+            ColumnarTableDataCall::FunctionName(1), ColumnarTableDataCall::ClassName());
+        return false;
+    }
+
+    out->SetFrameCount(in->GetFrameCount());
+    out->SetDataHash(in->DataHash());
+    out->SetUnlocker(nullptr);
+
+    return true;
+}
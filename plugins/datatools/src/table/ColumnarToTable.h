@@ -0,0 +1,80 @@
+/*
+ * ColumnarToTable.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+
+#include "datatools/table/ColumnarTableDataCall.h"
+#include "datatools/table/TableDataCall.h"
+
+namespace megamol::datatools::table {
+
+/**
+ * Materializes the visible rows of a columnar table into a row-major table
+ * for modules consuming TableDataCall.
+ */
+class ColumnarToTable : public core::Module {
+public:
+    /** Return module class name */
+    static const char* ClassName() {
+        return "ColumnarToTable";
+    }
+
+    /** Return module class description */
+    static const char* Description() {
+        return "Converts a columnar table into a row-major table of floats";
+    }
+
+    /** Module is always available */
+    static bool IsAvailable() {
+        return true;
+    }
+
+    /** Ctor */
+    ColumnarToTable();
+
+    /** Dtor */
+    ~ColumnarToTable() override;
+
+protected:
+    /** Lazy initialization of the module */
+    bool create() override;
+
+    /** Resource release */
+    void release() override;
+
+private:
+    bool getData(core::Call& c);
+
+    bool getHash(core::Call& c);
+
+    /** The slot providing the row-major table */
+    core::CalleeSlot slotOutput;
+
+    /** The slot accessing the columnar table */
+    core::CallerSlot slotInput;
+
+    /** The materialized column infos */
+    std::vector<TableDataCall::ColumnInfo> columns;
+
+    /** The materialized values */
+    std::vector<float> values;
+
+    /** The hash of the materialized data */
+    size_t inputHash = std::numeric_limits<size_t>::max();
+
+    /** The frame of the materialized data */
+    unsigned int frameID = std::numeric_limits<unsigned int>::max();
+};
+
+} // namespace megamol::datatools::table
@@ -5,6 +5,7 @@
  */
 
 #include "MMFTDataSource.h"
+#include "MMFTFormat.h"
 
 #include <fstream>
 
@@ -14,41 +15,6 @@
 using namespace megamol::datatools::table;
 using namespace megamol;
 
-namespace {
-template<typename T>
-T read(std::istream& stream) {
-    T value;
-    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
-    if (!stream.good()) {
-        throw std::runtime_error("Error reading from stream!");
-    }
-    return value;
-}
-
-template<typename T>
-std::vector<T> read_vector(std::istream& stream, std::size_t size) {
-    std::vector<T> vec(size);
-    stream.read(reinterpret_cast<char*>(vec.data()), size * sizeof(T));
-    if (!stream.good()) {
-        throw std::runtime_error("Error reading from stream!");
-    }
-    return vec;
-}
-
-std::string read_string(std::istream& stream, std::size_t size, bool trim_null = true) {
-    std::string str(size, '\0');
-    stream.read(str.data(), size * sizeof(std::string::value_type));
-    if (!stream.good()) {
-        throw std::runtime_error("Error reading from stream!");
-    }
-    if (trim_null) {
-        str.erase(std::find(str.begin(), str.end(), '\0'), str.end());
-    }
-    return str;
-}
-
-} // namespace
-
 MMFTDataSource::MMFTDataSource()
         : core::Module()
         , getDataSlot_("getData", "Slot providing the data")
@@ -106,31 +72,7 @@ void MMFTDataSource::assertData() {
     }
 
     try {
-        if (!(read_string(file, 6, false) == "MMFTD\0"s)) {
-            throw std::runtime_error("Wrong file format magic ID!");
-        }
-
-        auto version = read<uint16_t>(file);
-        if (version != 0) {
-            throw std::runtime_error("Wrong file format version number");
-        }
-
-        auto colCount = read<uint32_t>(file);
-        columns_.resize(colCount);
-
-        for (uint32_t c = 0; c < colCount; ++c) {
-            TableDataCall::ColumnInfo& ci = columns_[c];
-            auto nameLen = read<uint16_t>(file);
-            ci.SetName(read_string(file, nameLen));
-            auto type = read<uint8_t>(file);
-            ci.SetType((type == 1) ? TableDataCall::ColumnType::CATEGORICAL : TableDataCall::ColumnType::QUANTITATIVE);
-            ci.SetMinimumValue(read<float>(file));
-            ci.SetMaximumValue(read<float>(file));
-        }
-
-        auto rowCount = read<uint64_t>(file);
-
-        values_ = read_vector<float>(file, rowCount * colCount);
+        mmft::ReadTable(file, columns_, values_);
 
         dataHash_++;
 
@@ -5,6 +5,7 @@
  */
 
 #include "MMFTDataWriter.h"
+#include "MMFTFormat.h"
 
 #include <filesystem>
 #include <fstream>
@@ -73,34 +74,8 @@ bool MMFTDataWriter::run() {
     try {
         file.exceptions(std::ios::failbit);
 
-        std::string magicID("MMFTD");
-        file.write(magicID.data(), 6);
-
-        uint16_t version = 0;
-        file.write(reinterpret_cast<const char*>(&version), sizeof(uint16_t));
-
-        uint32_t colCnt = static_cast<uint32_t>(cftd->GetColumnsCount());
-        file.write(reinterpret_cast<const char*>(&colCnt), sizeof(uint32_t));
-
-        for (uint32_t c = 0; c < colCnt; ++c) {
-            const TableDataCall::ColumnInfo& ci = cftd->GetColumnsInfos()[c];
-            uint16_t nameLen = static_cast<uint16_t>(ci.Name().size());
-            file.write(reinterpret_cast<const char*>(&nameLen), sizeof(uint16_t));
-            file.write(ci.Name().data(), nameLen);
-
-            uint8_t type = (ci.Type() == TableDataCall::ColumnType::CATEGORICAL) ? 1 : 0;
-            file.write(reinterpret_cast<const char*>(&type), sizeof(uint8_t));
-
-            float f = ci.MinimumValue();
-            file.write(reinterpret_cast<const char*>(&f), sizeof(float));
-            f = ci.MaximumValue();
-            file.write(reinterpret_cast<const char*>(&f), sizeof(float));
-        }
-
-        uint64_t rowCnt = static_cast<uint64_t>(cftd->GetRowsCount());
-        file.write(reinterpret_cast<const char*>(&rowCnt), sizeof(uint64_t));
-
-        file.write(reinterpret_cast<const char*>(cftd->GetData()), rowCnt * colCnt * sizeof(float));
+        mmft::WriteTable(
+            file, cftd->GetColumnsCount(), cftd->GetColumnsInfos(), cftd->GetRowsCount(), cftd->GetData());
 
     } catch (...) {
         Log::DefaultLog.WriteError("Write error \"%s\".", filename.generic_u8string().c_str());
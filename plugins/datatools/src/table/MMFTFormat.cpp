@@ -0,0 +1,107 @@
+/*
+ * MegaMol
+ * Copyright (c) 2024, MegaMol Dev Team
+ * All rights reserved.
+ */
+
+#include "MMFTFormat.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using namespace megamol::datatools::table;
+
+namespace {
+template<typename T>
+T read(std::istream& stream) {
+    T value;
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (!stream.good()) {
+        throw std::runtime_error("Error reading from stream!");
+    }
+    return value;
+}
+
+template<typename T>
+std::vector<T> read_vector(std::istream& stream, std::size_t size) {
+    std::vector<T> vec(size);
+    stream.read(reinterpret_cast<char*>(vec.data()), size * sizeof(T));
+    if (!stream.good()) {
+        throw std::runtime_error("Error reading from stream!");
+    }
+    return vec;
+}
+
+std::string read_string(std::istream& stream, std::size_t size, bool trim_null = true) {
+    std::string str(size, '\0');
+    stream.read(str.data(), size * sizeof(std::string::value_type));
+    if (!stream.good()) {
+        throw std::runtime_error("Error reading from stream!");
+    }
+    if (trim_null) {
+        str.erase(std::find(str.begin(), str.end(), '\0'), str.end());
+    }
+    return str;
+}
+
+template<typename T>
+void write(std::ostream& stream, T value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+void mmft::WriteTable(std::ostream& stream, std::size_t colCnt, const TableDataCall::ColumnInfo* columns,
+    std::size_t rowCnt, const float* values) {
+    std::string magicID("MMFTD");
+    stream.write(magicID.data(), 6);
+
+    write<uint16_t>(stream, 0); // version
+    write<uint32_t>(stream, static_cast<uint32_t>(colCnt));
+
+    for (std::size_t c = 0; c < colCnt; ++c) {
+        const TableDataCall::ColumnInfo& ci = columns[c];
+        uint16_t nameLen = static_cast<uint16_t>(ci.Name().size());
+        write<uint16_t>(stream, nameLen);
+        stream.write(ci.Name().data(), nameLen);
+        write<uint8_t>(stream, (ci.Type() == TableDataCall::ColumnType::CATEGORICAL) ? 1 : 0);
+        write<float>(stream, ci.MinimumValue());
+        write<float>(stream, ci.MaximumValue());
+    }
+
+    write<uint64_t>(stream, static_cast<uint64_t>(rowCnt));
+    stream.write(reinterpret_cast<const char*>(values), rowCnt * colCnt * sizeof(float));
+}
+
+void mmft::ReadTable(
+    std::istream& stream, std::vector<TableDataCall::ColumnInfo>& columns, std::vector<float>& values) {
+    using namespace std::string_literals;
+
+    if (!(read_string(stream, 6, false) == "MMFTD\0"s)) {
+        throw std::runtime_error("Wrong file format magic ID!");
+    }
+
+    auto version = read<uint16_t>(stream);
+    if (version != 0) {
+        throw std::runtime_error("Wrong file format version number");
+    }
+
+    auto colCount = read<uint32_t>(stream);
+    columns.resize(colCount);
+
+    for (uint32_t c = 0; c < colCount; ++c) {
+        TableDataCall::ColumnInfo& ci = columns[c];
+        auto nameLen = read<uint16_t>(stream);
+        ci.SetName(read_string(stream, nameLen));
+        auto type = read<uint8_t>(stream);
+        ci.SetType((type == 1) ? TableDataCall::ColumnType::CATEGORICAL : TableDataCall::ColumnType::QUANTITATIVE);
+        ci.SetMinimumValue(read<float>(stream));
+        ci.SetMaximumValue(read<float>(stream));
+    }
+
+    auto rowCount = read<uint64_t>(stream);
+
+    values = read_vector<float>(stream, rowCount * colCount);
+}
@@ -0,0 +1,33 @@
+/*
+ * MegaMol
+ * Copyright (c) 2024, MegaMol Dev Team
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "datatools/table/TableDataCall.h"
+
+namespace megamol::datatools::table::mmft {
+
+/**
+ * Writes a table in the MMFTD binary format (version 0).
+ *
+ * @throws std::ios_base::failure on write errors.
+ */
+void WriteTable(std::ostream& stream, std::size_t colCnt, const TableDataCall::ColumnInfo* columns,
+    std::size_t rowCnt, const float* values);
+
+/**
+ * Reads a table in the MMFTD binary format (version 0). The stream is left
+ * positioned right after the table, so that trailing data can be read.
+ *
+ * @throws std::runtime_error on read errors or a wrong format.
+ */
+void ReadTable(std::istream& stream, std::vector<TableDataCall::ColumnInfo>& columns, std::vector<float>& values);
+
+} // namespace megamol::datatools::table::mmft
@@ -101,22 +101,28 @@ bool ParticlesToTable::assertMPDC(geocalls::MultiParticleDataCall* in, table::Ta
 
             everything.resize(column_names.size() * total_particles);
             uint32_t particle_idx = 0;
+            // gather in batches to avoid per-element virtual calls
+            constexpr size_t batch_size = 4096;
+            std::array<std::vector<float>, 11> batch;
+            for (auto& b : batch) {
+                b.resize(batch_size);
+            }
             for (auto l = 0; l < in->GetParticleListCount(); ++l) {
                 auto pl = in->AccessParticles(l);
                 const auto& store = pl.GetParticleStore();
-                for (auto idx = 0; idx < pl.GetCount(); ++idx) {
-                    store_and_compute_extents(particle_idx, 0, store.GetXAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 1, store.GetYAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 2, store.GetZAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 3, store.GetRAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 4, store.GetCRAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 5, store.GetCGAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 6, store.GetCBAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 7, store.GetCRAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 8, store.GetDXAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 9, store.GetDYAcc()->Get_f(idx));
-                    store_and_compute_extents(particle_idx, 10, store.GetDZAcc()->Get_f(idx));
-                    particle_idx++;
+                for (size_t first = 0; first < pl.GetCount(); first += batch_size) {
+                    auto const count = std::min<size_t>(batch_size, pl.GetCount() - first);
+                    store.GetPositions(first, count, batch[0].data(), batch[1].data(), batch[2].data());
+                    store.GetRadii(first, count, batch[3].data());
+                    store.GetColors(
+                        first, count, batch[4].data(), batch[5].data(), batch[6].data(), batch[7].data());
+                    store.GetDirections(first, count, batch[8].data(), batch[9].data(), batch[10].data());
+                    for (size_t idx = 0; idx < count; ++idx) {
+                        for (uint32_t col = 0; col < batch.size(); ++col) {
+                            store_and_compute_extents(particle_idx, col, batch[col][idx]);
+                        }
+                        particle_idx++;
+                    }
                 }
             }
 
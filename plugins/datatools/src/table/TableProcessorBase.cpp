@@ -7,7 +7,9 @@
 
 #include "TableProcessorBase.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <limits>
 
 #include "mmcore/utility/log/Log.h"
@@ -16,11 +18,15 @@
  * megamol::datatools::table::TableProcessorBase::TableProcessorBase
  */
 megamol::datatools::table::TableProcessorBase::TableProcessorBase()
-        : frameID((std::numeric_limits<unsigned int>::max)())
+        : isAllRows(true)
+        , frameID((std::numeric_limits<unsigned int>::max)())
         , inputHash(0)
         , localHash(0)
         , slotInput("input", "The input slot providing the unfiltered data.")
-        , slotOutput("output", "The input slot for the filtered data.") {
+        , slotOutput("output", "The input slot for the filtered data.")
+        , slotOutputView("outputView", "The slot providing the filtered data as view of the unfiltered data.")
+        , valuesHash(0)
+        , valuesFrameID((std::numeric_limits<unsigned int>::max)()) {
     /* Export the calls. */
     this->slotInput.SetCompatibleCall<TableDataCallDescription>();
     this->MakeSlotAvailable(&this->slotInput);
@@ -30,6 +36,12 @@ megamol::datatools::table::TableProcessorBase::TableProcessorBase()
     this->slotOutput.SetCallback(
         TableDataCall::ClassName(), TableDataCall::FunctionName(1), &TableProcessorBase::getHash);
     this->MakeSlotAvailable(&this->slotOutput);
+
+    this->slotOutputView.SetCallback(ColumnarTableDataCall::ClassName(), ColumnarTableDataCall::FunctionName(0),
+        &TableProcessorBase::getView);
+    this->slotOutputView.SetCallback(ColumnarTableDataCall::ClassName(), ColumnarTableDataCall::FunctionName(1),
+        &TableProcessorBase::getViewHash);
+    this->MakeSlotAvailable(&this->slotOutputView);
 }
 
 
@@ -58,11 +70,13 @@ bool megamol::datatools::table::TableProcessorBase::getData(core::Call& call) {
         return false;
     }
 
+    this->materialise(*src);
+
     dst->SetFrameCount(src->GetFrameCount());
     dst->SetFrameID(this->frameID);
     dst->SetDataHash(this->getHash());
-    dst->Set(
-        this->columns.size(), this->values.size() / this->columns.size(), this->columns.data(), this->values.data());
+    dst->Set(this->columns.size(), this->columns.empty() ? 0 : this->values.size() / this->columns.size(),
+        this->columns.data(), this->values.data());
 
     return true;
 }
@@ -107,3 +121,116 @@ bool megamol::datatools::table::TableProcessorBase::getHash(core::Call& call) {
 
     return true;
 }
+
+
+/*
+ * megamol::datatools::table::TableProcessorBase::getView
+ */
+bool megamol::datatools::table::TableProcessorBase::getView(core::Call& call) {
+    using megamol::core::utility::log::Log;
+
+    auto src = this->slotInput.CallAs<TableDataCall>();
+    auto dst = dynamic_cast<ColumnarTableDataCall*>(&call);
+
+    /* Sanity checks. */
+    if (src == nullptr) {
+        Log::DefaultLog.WriteError(_T("The input slot of %hs is invalid"), TableDataCall::ClassName());
+        return false;
+    }
+
+    if (dst == nullptr) {
+        Log::DefaultLog.WriteError(_T("The output slot of %hs is invalid"), ColumnarTableDataCall::ClassName());
+        return false;
+    }
+
+    if (!this->prepareData(*src, dst->GetFrameID())) {
+        return false;
+    }
+
+    /* Expose the input columns, but with our (possibly updated) column infos. */
+    ColumnarTableDataCall::WrapTable(*src, this->viewColumns);
+    assert(this->viewColumns.size() == this->columns.size());
+    for (std::size_t c = 0; c < this->viewColumns.size(); ++c) {
+        const auto& col = this->viewColumns[c];
+        this->viewColumns[c] = ColumnarTableDataCall::Column(this->columns[c], col.Type(), col.Data(), col.Stride());
+    }
+
+    dst->SetFrameCount(src->GetFrameCount());
+    dst->SetFrameID(this->frameID);
+    dst->SetDataHash(this->getHash());
+    dst->Set(this->viewColumns.size(), src->GetRowsCount(), this->viewColumns.data());
+    if (this->isAllRows) {
+        dst->SetSelection(nullptr, 0);
+    } else {
+        dst->SetSelection(this->selection.data(), this->selection.size());
+    }
+    dst->SetUnlocker(nullptr);
+
+    return true;
+}
+
+
+/*
+ * megamol::datatools::table::TableProcessorBase::getViewHash
+ */
+bool megamol::datatools::table::TableProcessorBase::getViewHash(core::Call& call) {
+    using megamol::core::utility::log::Log;
+    auto src = this->slotInput.CallAs<TableDataCall>();
+    auto dst = dynamic_cast<ColumnarTableDataCall*>(&call);
+
+    /* Sanity checks. */
+    if (src == nullptr) {
+        Log::DefaultLog.WriteError("The input slot of type %hs is invalid", TableDataCall::ClassName());
+        return false;
+    }
+
+    if (dst == nullptr) {
+        Log::DefaultLog.WriteError("The output slot of type %hs is invalid", ColumnarTableDataCall::ClassName());
+        return false;
+    }
+
+    /* Obtain extents and hash of the source data. */
+    src->SetFrameID(dst->GetFrameID());
+    if (!(*src)(1)) {
+        Log::DefaultLog.WriteError(
+            "The call to %hs of %hs failed.", TableDataCall::FunctionName(1), TableDataCall::ClassName());
+        return false;
+    }
+
+    dst->SetFrameCount(src->GetFrameCount());
+    dst->SetDataHash(this->getHash());
+    dst->SetUnlocker(nullptr);
+
+    return true;
+}
+
+
+/*
+ * megamol::datatools::table::TableProcessorBase::materialise
+ */
+void megamol::datatools::table::TableProcessorBase::materialise(const TableDataCall& src) {
+    if ((this->valuesHash == this->getHash()) && (this->valuesFrameID == this->frameID) && !this->values.empty()) {
+        return;
+    }
+
+    const auto colCnt = this->columns.size();
+    const auto data = src.GetData();
+
+    if (this->isAllRows) {
+        this->values.resize(src.GetRowsCount() * colCnt);
+        std::copy(data, data + this->values.size(), this->values.begin());
+
+    } else {
+        const auto rowCnt = static_cast<std::int64_t>(this->selection.size());
+        this->values.resize(rowCnt * colCnt);
+        auto dst = this->values.data();
+#pragma omp parallel for
+        for (std::int64_t r = 0; r < rowCnt; ++r) {
+            const auto s = this->selection[r];
+            std::copy(data + s * colCnt, data + (s + 1) * colCnt, dst + r * colCnt);
+        }
+    }
+
+    this->valuesHash = this->getHash();
+    this->valuesFrameID = this->frameID;
+}
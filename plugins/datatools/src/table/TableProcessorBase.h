@@ -13,13 +13,19 @@
 
 #include "mmcore/param/ParamSlot.h"
 
+#include "datatools/table/ColumnarTableDataCall.h"
 #include "datatools/table/TableDataCall.h"
 
 
 namespace megamol::datatools::table {
 
 /**
- * A base class for modules processing table data.
+ * A base class for modules processing table data by selecting and reordering
+ * rows of the input.
+ *
+ * Subclasses only compute the row selection. The base class provides the
+ * result as a view of the input (input columns plus selection) and
+ * materialises a row-major copy only if the classic table output is used.
  */
 class TableProcessorBase : public core::Module {
 
@@ -62,6 +68,15 @@ protected:
     /** Holds the columns of the (filtered) table. */
     std::vector<ColumnInfo> columns;
 
+    /**
+     * Holds the rows of the input forming the output, in output order.
+     * Ignored if 'isAllRows' is set.
+     */
+    std::vector<std::size_t> selection;
+
+    /** Indicates that the output comprises all input rows in input order. */
+    bool isAllRows;
+
     /** Holds the ID of the current frame. */
     unsigned int frameID;
 
@@ -77,13 +92,37 @@ protected:
     /** The slot allowing for retrieval of the output data. */
     core::CalleeSlot slotOutput;
 
-    /** The actual values. */
+    /** The slot allowing for retrieval of the output as a view of the input. */
+    core::CalleeSlot slotOutputView;
+
+    /** The actual values, only materialised on request of 'slotOutput'. */
     std::vector<float> values;
 
 private:
     bool getData(core::Call& call);
 
     bool getHash(core::Call& call);
+
+    bool getView(core::Call& call);
+
+    bool getViewHash(core::Call& call);
+
+    /**
+     * Copies the selected rows of 'src' into 'values' unless they are
+     * already up to date.
+     *
+     * @param src The call providing the current input data.
+     */
+    void materialise(const TableDataCall& src);
+
+    /** The column views of the input handed out via 'slotOutputView'. */
+    std::vector<ColumnarTableDataCall::Column> viewColumns;
+
+    /** The hash of the data in 'values'. */
+    std::size_t valuesHash;
+
+    /** The frame of the data in 'values'. */
+    unsigned int valuesFrameID;
 };
 
 } // namespace megamol::datatools::table
@@ -13,6 +13,8 @@
 #include <limits>
 #include <numeric>
 
+#include <tbb/parallel_sort.h>
+
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FlexEnumParam.h"
 
@@ -107,31 +109,29 @@ bool megamol::datatools::table::TableSort::prepareData(TableDataCall& src, const
             }
         }
 
-        /* Sort the index proxy. */
+        /* Sort the index proxy, which is all we hand out. */
         std::iota(proxy.begin(), proxy.end(), 0);
 
-        const auto isDesc = this->paramIsDescending.Param<BoolParam>()->Value();
-        auto pred = [this, column, data, isDesc](const std::size_t l, const std::size_t r) {
-            auto lhs = data[l * this->columns.size() + column];
-            auto rhs = data[r * this->columns.size() + column];
-            return isDesc ? (rhs < lhs) : (lhs < rhs);
-        };
-
-        if (this->paramIsStable.Param<BoolParam>()->Value()) {
-            std::stable_sort(proxy.begin(), proxy.end(), pred);
-        } else {
-            std::sort(proxy.begin(), proxy.end(), pred);
-        }
-
-        /* Copy the data in sorted order. */
-        this->values.resize(src.GetRowsCount() * src.GetColumnsCount());
-        auto dst = this->values.data();
+        if (column < this->columns.size()) {
+            const auto isDesc = this->paramIsDescending.Param<BoolParam>()->Value();
+            const auto isStable = this->paramIsStable.Param<BoolParam>()->Value();
+            const auto stride = this->columns.size();
+            auto pred = [stride, column, data, isDesc, isStable](const std::size_t l, const std::size_t r) {
+                auto lhs = data[l * stride + column];
+                auto rhs = data[r * stride + column];
+                if (isStable && !(lhs < rhs) && !(rhs < lhs)) {
+                    // Breaking ties by the original position makes the parallel sort stable.
+                    return (l < r);
+                }
+                return isDesc ? (rhs < lhs) : (lhs < rhs);
+            };
 
-        for (auto r : proxy) {
-            std::copy(data + r * this->columns.size(), data + (r + 1) * this->columns.size(), dst);
-            dst += this->columns.size();
+            tbb::parallel_sort(proxy.begin(), proxy.end(), pred);
         }
 
+        this->selection = std::move(proxy);
+        this->isAllRows = false;
+
         /* Persist the state of the data. */
         this->frameID = frameID;
         this->inputHash = src.DataHash();
@@ -0,0 +1,121 @@
+/*
+ * TableToColumnar.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "TableToColumnar.h"
+
+#include "mmcore/utility/log/Log.h"
+
+using namespace megamol::datatools;
+using namespace megamol::datatools::table;
+using namespace megamol;
+
+
+/*
+ * TableToColumnar::TableToColumnar
+ */
+TableToColumnar::TableToColumnar()
+        : core::Module()
+        , slotOutput("output", "Provides the columnar table")
+        , slotInput("input", "Takes the row-major table") {
+
+    this->slotInput.SetCompatibleCall<TableDataCallDescription>();
+    this->MakeSlotAvailable(&this->slotInput);
+
+    this->slotOutput.SetCallback(ColumnarTableDataCall::ClassName(), ColumnarTableDataCall::FunctionName(0),
+        &TableToColumnar::getData);
+    this->slotOutput.SetCallback(ColumnarTableDataCall::ClassName(), ColumnarTableDataCall::FunctionName(1),
+        &TableToColumnar::getHash);
+    this->MakeSlotAvailable(&this->slotOutput);
+}
+
+
+/*
+ * TableToColumnar::~TableToColumnar
+ */
+TableToColumnar::~TableToColumnar() {
+    this->Release();
+}
+
+
+/*
+ * TableToColumnar::create
+ */
+bool TableToColumnar::create() {
+    return true;
+}
+
+
+/*
+ * TableToColumnar::release
+ */
+void TableToColumnar::release() {
+    this->columns.clear();
+}
+
+
+/*
+ * TableToColumnar::getData
+ */
+bool TableToColumnar::getData(core::Call& c) {
+    using megamol::core::utility::log::Log;
+
+    auto* out = dynamic_cast<ColumnarTableDataCall*>(&c);
+    if (out == nullptr)
+        return false;
+
+    auto* in = this->slotInput.CallAs<TableDataCall>();
+    if (in == nullptr)
+        return false;
+
+    in->SetFrameID(out->GetFrameID());
+    if (!(*in)(0)) {
+        Log::DefaultLog.WriteError("TableToColumnar: The call to %s of %s failed.", TableDataCall::FunctionName(0),
+            TableDataCall::ClassName());
+        return false;
+    }
+
+    // the views are cheap to rebuild and must follow the pointer of the input anyway
+    ColumnarTableDataCall::WrapTable(*in, this->columns);
+
+    out->Set(this->columns.size(), in->GetRowsCount(), this->columns.data());
+    out->SetSelection(nullptr, 0);
+    out->SetFrameCount(in->GetFrameCount());
+    out->SetFrameID(in->GetFrameID());
+    out->SetDataHash(in->DataHash());
+    out->SetUnlocker(nullptr);
+
+    return true;
+}
+
+
+/*
+ * TableToColumnar::getHash
+ */
+bool TableToColumnar::getHash(core::Call& c) {
+    using megamol::core::utility::log::Log;
+
+    auto* out = dynamic_cast<ColumnarTableDataCall*>(&c);
+    if (out == nullptr)
+        return false;
+
+    auto* in = this->slotInput.CallAs<TableDataCall>();
+    if (in == nullptr)
+        return false;
+
+    in->SetFrameID(out->GetFrameID());
+    if (!(*in)(1)) {
+        Log::DefaultLog.WriteError("TableToColumnar: The call to %s of %s failed.", TableDataCall::FunctionName(1),
+            TableDataCall::ClassName());
+        return false;
+    }
+
+    out->SetFrameCount(in->GetFrameCount());
+    out->SetDataHash(in->DataHash());
+    out->SetUnlocker(nullptr);
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * TableToColumnar.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+
+#include "datatools/table/ColumnarTableDataCall.h"
+#include "datatools/table/TableDataCall.h"
+
+namespace megamol::datatools::table {
+
+/**
+ * Exposes a row-major table as columnar table without copying the values.
+ */
+class TableToColumnar : public core::Module {
+public:
+    /** Return module class name */
+    static const char* ClassName() {
+        return "TableToColumnar";
+    }
+
+    /** Return module class description */
+    static const char* Description() {
+        return "Provides a table as columnar table (zero-copy)";
+    }
+
+    /** Module is always available */
+    static bool IsAvailable() {
+        return true;
+    }
+
+    /** Ctor */
+    TableToColumnar();
+
+    /** Dtor */
+    ~TableToColumnar() override;
+
+protected:
+    /** Lazy initialization of the module */
+    bool create() override;
+
+    /** Resource release */
+    void release() override;
+
+private:
+    bool getData(core::Call& c);
+
+    bool getHash(core::Call& c);
+
+    /** The slot providing the columnar table */
+    core::CalleeSlot slotOutput;
+
+    /** The slot accessing the row-major table */
+    core::CallerSlot slotInput;
+
+    /** The column views into the data of the input */
+    std::vector<ColumnarTableDataCall::Column> columns;
+};
+
+} // namespace megamol::datatools::table
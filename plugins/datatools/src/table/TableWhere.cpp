@@ -13,6 +13,8 @@
 #include <limits>
 #include <numeric>
 
+#include <tbb/parallel_sort.h>
+
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FlexEnumParam.h"
@@ -248,12 +250,14 @@ bool megamol::datatools::table::TableWhere::prepareData(TableDataCall& src, cons
                 selection.resize(src.GetRowsCount());
                 std::iota(selection.begin(), selection.end(), 0);
 
-                std::stable_sort(
-                    selection.begin(), selection.end(), [this, data, column](const std::size_t l, const std::size_t r) {
-                        auto lhs = data[l * this->columns.size() + column];
-                        auto rhs = data[r * this->columns.size() + column];
-                        return (lhs < rhs);
-                    });
+                // Ties are broken by the original position to retain stable order.
+                const auto stride = this->columns.size();
+                auto pred = [stride, data, column](const std::size_t l, const std::size_t r) {
+                    auto lhs = data[l * stride + column];
+                    auto rhs = data[r * stride + column];
+                    return (lhs < rhs) || (!(rhs < lhs) && (l < r));
+                };
+                tbb::parallel_sort(selection.begin(), selection.end(), pred);
 
                 // Compute the number of elements we want to retain.
                 const auto cnt = static_cast<std::size_t>(static_cast<double>(r) * src.GetRowsCount());
@@ -299,41 +303,39 @@ bool megamol::datatools::table::TableWhere::prepareData(TableDataCall& src, cons
                 }
             }
 
-            /* Copy the data. */
-            this->values.resize(selection.size() * this->columns.size());
-            auto d = this->values.data();
-            for (auto r : selection) {
-                std::copy(data + r * this->columns.size(), data + (r + 1) * this->columns.size(), d);
-                d += this->columns.size();
-            }
-
             /* Update the min/max range if requested. */
             if (this->paramUpdateRange.Param<BoolParam>()->Value()) {
-                const auto rows = this->values.size() / this->columns.size();
+                const auto stride = this->columns.size();
 
                 for (std::size_t c = 0; c < this->columns.size(); ++c) {
                     auto minimum = (std::numeric_limits<float>::max)();
                     auto maximum = (std::numeric_limits<float>::min)();
 
-                    for (std::size_t r = 0; r < rows; ++r) {
-                        auto value = this->values[r * this->columns.size() + c];
+                    for (auto r : selection) {
+                        auto value = data[r * stride + c];
                         if (value < minimum) {
                             minimum = value;
                         }
                         if (value > maximum) {
                             maximum = value;
                         }
+                    }
 
+                    if (!selection.empty()) {
                         this->columns[c].SetMinimumValue(minimum);
                         this->columns[c].SetMaximumValue(maximum);
                     }
                 }
             } /* end if (this->paramUpdateRange.Param<BoolParam>()->Value()) */
 
+            /* Only the selection is retained, the base class materialises on demand. */
+            this->selection = std::move(selection);
+            this->isAllRows = false;
+
         } else {
-            // Copy everything.
-            this->values.resize(src.GetRowsCount() * this->columns.size());
-            std::copy(src.GetData(), src.GetData() + this->values.size(), this->values.begin());
+            // Pass through everything.
+            this->selection.clear();
+            this->isAllRows = true;
         } /* end if (selector || isSort) */
 
         /* Persist the state of the data. */
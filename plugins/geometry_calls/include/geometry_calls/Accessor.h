@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 
@@ -27,6 +30,34 @@ T const* access(char const* ptr, size_t idx, size_t stride) {
 }
 
 
+/**
+ * Typed view into a strided array of N-component elements. Used by the
+ * typed visitors of SimpleSphericalParticles, which dispatch on the data
+ * type once per list so that the loops over the elements can be inlined.
+ */
+template<class T, unsigned int N>
+class StridedView {
+public:
+    using value_type = T;
+
+    static constexpr unsigned int Components = N;
+
+    StridedView(char const* ptr, size_t stride) : ptr_{ptr}, stride_{stride} {}
+
+    T Get(size_t const idx, unsigned int const comp = 0) const {
+        return access<T>(ptr_, idx, stride_)[comp];
+    }
+
+    T const* operator[](size_t const idx) const {
+        return access<T>(ptr_, idx, stride_);
+    }
+
+private:
+    char const* ptr_;
+    size_t stride_;
+};
+
+
 /**
  * Interface for accessor classes.
  */
@@ -43,6 +74,14 @@ public:
     virtual unsigned int Get_u32(size_t idx) const = 0;
     virtual unsigned short Get_u16(size_t idx) const = 0;
     virtual unsigned char Get_u8(size_t idx) const = 0;
+
+    /**
+     * Copies 'count' consecutive elements starting at 'first' into 'out'.
+     * Costs a single virtual call for the whole range.
+     */
+    virtual void Gather_f(size_t first, size_t count, float* out) const = 0;
+    virtual void Gather_d(size_t first, size_t count, double* out) const = 0;
+
     virtual ~Accessor() = default;
 };
 
@@ -109,9 +148,33 @@ public:
         return Get<unsigned char>(idx);
     }
 
+    void Gather_f(size_t first, size_t count, float* out) const override {
+        Gather<float>(first, count, out);
+    }
+
+    void Gather_d(size_t first, size_t count, double* out) const override {
+        Gather<double>(first, count, out);
+    }
+
     ~Accessor_Impl() override = default;
 
 private:
+    template<class R>
+    void Gather(size_t const first, size_t const count, R* out) const {
+        if (stride_ == sizeof(T)) {
+            // tightly packed, let the compiler vectorize the conversion
+            T const* src = access<T>(ptr_, first, stride_);
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = static_cast<R>(src[i]);
+            }
+        } else {
+            char const* src = ptr_ + first * stride_;
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = static_cast<R>(*reinterpret_cast<T const*>(src + i * stride_));
+            }
+        }
+    }
+
     char const* ptr_;
     size_t stride_;
 };
@@ -167,6 +230,14 @@ public:
         return Get<unsigned char>();
     }
 
+    void Gather_f(size_t first, size_t count, float* out) const override {
+        std::fill(out, out + count, Get<float>());
+    }
+
+    void Gather_d(size_t first, size_t count, double* out) const override {
+        std::fill(out, out + count, Get<double>());
+    }
+
     ~Accessor_Val() override = default;
 
 private:
@@ -213,6 +284,14 @@ public:
         return static_cast<unsigned char>(0);
     }
 
+    void Gather_f(size_t first, size_t count, float* out) const override {
+        std::fill(out, out + count, 0.0f);
+    }
+
+    void Gather_d(size_t first, size_t count, double* out) const override {
+        std::fill(out, out + count, 0.0);
+    }
+
     ~Accessor_0() override = default;
 
 private:
@@ -258,6 +337,18 @@ public:
         return static_cast<unsigned char>(idx);
     }
 
+    void Gather_f(size_t first, size_t count, float* out) const override {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(first + i);
+        }
+    }
+
+    void Gather_d(size_t first, size_t count, double* out) const override {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<double>(first + i);
+        }
+    }
+
     ~Accessor_Idx() override = default;
 
 private:
@@ -0,0 +1,418 @@
+/*
+ * BrickedVolumetricDataCall.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geometry_calls/VolumetricDataCall.h"
+#include "mmcore/factories/CallAutoDescription.h"
+#include "mmstd/data/AbstractGetData3DCall.h"
+
+
+namespace megamol::geocalls {
+
+/**
+ * Provides volumetric data that is split into bricks of equal edge length
+ * on several levels of detail.
+ *
+ * The data call (IDX_GET_DATA) provides the metadata of the full-resolution
+ * volume and the brick table of the requested frame, which lists all bricks
+ * of all levels together with their per-component value ranges. Voxels are
+ * only transferred by the bricks call (IDX_GET_BRICKS) for the bricks the
+ * caller requested via SetRequest(). This allows for sources that page
+ * bricks from disk on demand and consumers that skip bricks based on their
+ * value range or refine coarse levels progressively.
+ *
+ * Level 0 is the full resolution, each following level halves the
+ * resolution of the previous one along all axes (rounding up). Bricks do
+ * not overlap, the bricks at the upper border of a level may be smaller
+ * than the brick size. The voxels of a brick are stored x-fastest with the
+ * components of a voxel interleaved, just like a dense VolumetricDataCall.
+ */
+class BrickedVolumetricDataCall : public core::AbstractGetData3DCall {
+
+public:
+    /** Structure containing the metadata of the full-resolution volume. */
+    typedef VolumetricDataCall::Metadata Metadata;
+
+    /** Shared ownership of the voxels of a single brick. */
+    typedef std::shared_ptr<const std::vector<uint8_t>> BrickData;
+
+    /** Describes one level of detail. */
+    struct Level {
+        /** The number of voxels along each axis. */
+        size_t Resolution[3];
+        /** The number of bricks along each axis. */
+        size_t Bricks[3];
+        /** The index of the first brick of the level in the brick table. */
+        size_t FirstBrick;
+    };
+
+    /** Entry of the brick table. */
+    struct Brick {
+        /** The level the brick belongs to. */
+        unsigned int Level;
+        /** The first voxel of the brick in the grid of its level. */
+        size_t Origin[3];
+        /** The number of voxels of the brick along each axis. */
+        size_t Resolution[3];
+    };
+
+    /**
+     * Answer the name of this call.
+     *
+     * @return The name of this call.
+     */
+    static inline const char* ClassName() {
+        return "BrickedVolumetricDataCall";
+    }
+
+    /**
+     * Answer a human readable description of this call.
+     *
+     * @return A human readable description of this call.
+     */
+    static inline const char* Description() {
+        return "Transports bricked volumetric data with levels of detail.";
+    }
+
+    /**
+     * Answer the number of functions used for this call.
+     *
+     * @return The number of functions used for this call.
+     */
+    static unsigned int FunctionCount();
+
+    /**
+     * Answer the name of the function used for this call.
+     *
+     * @param idx The index of the function to return it's name.
+     *
+     * @return The name of the requested function.
+     */
+    static const char* FunctionName(unsigned int idx);
+
+    /**
+     * Copies the voxels of a brick into a dense grid of the level of the
+     * brick.
+     *
+     * @param brick      The brick table entry.
+     * @param src        The voxels of the brick.
+     * @param voxelSize  The size of a voxel in bytes.
+     * @param dst        The dense grid.
+     * @param resolution The resolution of the dense grid.
+     */
+    static void CopyBrickToGrid(
+        const Brick& brick, const void* src, size_t voxelSize, void* dst, const size_t resolution[3]);
+
+    /**
+     * Copies the voxels of a brick out of a dense grid of the level of the
+     * brick.
+     *
+     * @param brick      The brick table entry.
+     * @param src        The dense grid.
+     * @param resolution The resolution of the dense grid.
+     * @param voxelSize  The size of a voxel in bytes.
+     * @param dst        Receives the voxels of the brick.
+     */
+    static void CopyGridToBrick(
+        const Brick& brick, const void* src, const size_t resolution[3], size_t voxelSize, void* dst);
+
+    /** Index of the function retrieving the bounding box. */
+    static const unsigned int IDX_GET_EXTENTS;
+
+    /** Index of the function retrieving the metadata and the brick table. */
+    static const unsigned int IDX_GET_DATA;
+
+    /** Index of the function retrieving the voxels of the requested bricks. */
+    static const unsigned int IDX_GET_BRICKS;
+
+    /**
+     * Initialises a new instance.
+     */
+    BrickedVolumetricDataCall();
+
+    /**
+     * Clone 'rhs'.
+     *
+     * @param rhs The object to be cloned.
+     */
+    BrickedVolumetricDataCall(const BrickedVolumetricDataCall& rhs);
+
+    /**
+     * Finalises an instance.
+     */
+    ~BrickedVolumetricDataCall() override;
+
+    /**
+     * Gets the edge length of the bricks in voxels.
+     *
+     * @return The brick size.
+     */
+    inline size_t GetBrickSize() const {
+        return this->brickSize;
+    }
+
+    /**
+     * Gets the table entry of a brick.
+     *
+     * @param idx The index of the brick.
+     *
+     * @return The brick table entry.
+     */
+    inline const Brick& GetBrick(size_t idx) const {
+        assert(idx < this->brickCount);
+        return this->bricks[idx];
+    }
+
+    /**
+     * Gets the number of bricks of all levels.
+     *
+     * @return The number of bricks.
+     */
+    inline size_t GetBrickCount() const {
+        return this->brickCount;
+    }
+
+    /**
+     * Gets the voxels of the 'idx'th requested brick after the bricks call.
+     *
+     * @param idx The index into the request.
+     *
+     * @return The voxels, or nullptr if the source could not provide them.
+     */
+    inline const BrickData& GetBrickData(size_t idx) const {
+        assert(idx < this->brickData.size());
+        return this->brickData[idx];
+    }
+
+    /**
+     * Gets the largest value of a component within a brick.
+     */
+    inline double GetBrickMax(size_t idx, size_t component = 0) const {
+        assert(idx < this->brickCount);
+        return this->maxValues[idx * this->GetComponents() + component];
+    }
+
+    /**
+     * Gets the smallest value of a component within a brick.
+     */
+    inline double GetBrickMin(size_t idx, size_t component = 0) const {
+        assert(idx < this->brickCount);
+        return this->minValues[idx * this->GetComponents() + component];
+    }
+
+    /**
+     * Gets the number of components per voxel.
+     *
+     * @return The number of components.
+     */
+    inline size_t GetComponents() const {
+        return (this->metadata != nullptr) ? this->metadata->Components : 0;
+    }
+
+    /**
+     * Gets a level of detail.
+     *
+     * @param level The level, 0 being the full resolution.
+     *
+     * @return The description of the level.
+     */
+    inline const Level& GetLevel(unsigned int level) const {
+        assert(level < this->levelCount);
+        return this->levels[level];
+    }
+
+    /**
+     * Gets the number of levels of detail.
+     *
+     * @return The number of levels.
+     */
+    inline unsigned int GetLevelCount() const {
+        return this->levelCount;
+    }
+
+    /**
+     * Gets the metadata of the full-resolution volume.
+     *
+     * @return The metadata if available.
+     */
+    inline const Metadata* GetMetadata() const {
+        return this->metadata;
+    }
+
+    /**
+     * Gets the number of bricks the source should prefetch.
+     */
+    inline size_t GetPrefetchCount() const {
+        return this->prefetchCount;
+    }
+
+    /**
+     * Gets the index of the 'idx'th brick the source should prefetch.
+     */
+    inline size_t GetPrefetchBrick(size_t idx) const {
+        assert(idx < this->prefetchCount);
+        return this->prefetch[idx];
+    }
+
+    /**
+     * Gets the number of requested bricks.
+     */
+    inline size_t GetRequestCount() const {
+        return this->requestCount;
+    }
+
+    /**
+     * Gets the index of the 'idx'th requested brick.
+     */
+    inline size_t GetRequestedBrick(size_t idx) const {
+        assert(idx < this->requestCount);
+        return this->request[idx];
+    }
+
+    /**
+     * Gets the size of a single voxel in bytes.
+     *
+     * @return The size of a voxel.
+     */
+    inline size_t GetVoxelSize() const {
+        return (this->metadata != nullptr) ? this->metadata->ScalarLength * this->metadata->Components : 0;
+    }
+
+    /**
+     * Answer the index of a brick from its position in the brick grid of
+     * its level.
+     */
+    inline size_t BrickIndex(unsigned int level, size_t x, size_t y, size_t z) const {
+        const auto& l = this->GetLevel(level);
+        return l.FirstBrick + x + (y + z * l.Bricks[1]) * l.Bricks[0];
+    }
+
+    /**
+     * Update the brick table. The call does not take ownership of any of the
+     * arrays, which must live as long as the data of the frame is valid.
+     *
+     * @param brickSize  The edge length of the bricks in voxels.
+     * @param levels     The levels of detail.
+     * @param levelCount The number of levels.
+     * @param bricks     The bricks of all levels.
+     * @param brickCount The number of bricks.
+     * @param minValues  'brickCount' times the number of components minima.
+     * @param maxValues  'brickCount' times the number of components maxima.
+     */
+    inline void SetBrickTable(size_t brickSize, const Level* levels, unsigned int levelCount, const Brick* bricks,
+        size_t brickCount, const double* minValues, const double* maxValues) {
+        this->brickSize = brickSize;
+        this->levels = levels;
+        this->levelCount = levelCount;
+        this->bricks = bricks;
+        this->brickCount = brickCount;
+        this->minValues = minValues;
+        this->maxValues = maxValues;
+    }
+
+    /**
+     * Sets the voxels of the requested bricks, in the order of the request.
+     */
+    inline void SetBrickData(std::vector<BrickData>&& data) {
+        this->brickData = std::move(data);
+    }
+
+    /**
+     * Update the metadata.
+     *
+     * @param metadata Pointer to the metadata records, which the caller
+     *                 must provide as long as this call exists.
+     */
+    inline void SetMetadata(const Metadata* metadata) {
+        this->metadata = metadata;
+    }
+
+    /**
+     * Sets the bricks to be delivered by the next bricks call and,
+     * optionally, bricks that will probably be requested soon. The call
+     * does not take ownership of the arrays.
+     *
+     * @param request       The indices of the requested bricks.
+     * @param requestCount  The number of requested bricks.
+     * @param prefetch      The indices of the bricks to be prefetched.
+     * @param prefetchCount The number of bricks to be prefetched.
+     */
+    inline void SetRequest(const size_t* request, size_t requestCount, const size_t* prefetch = nullptr,
+        size_t prefetchCount = 0) {
+        this->request = request;
+        this->requestCount = requestCount;
+        this->prefetch = prefetch;
+        this->prefetchCount = (prefetch != nullptr) ? prefetchCount : 0;
+        this->brickData.clear();
+    }
+
+    /**
+     * Assignment.
+     *
+     * @param rhs The right hand side operator.
+     *
+     * @return *this.
+     */
+    BrickedVolumetricDataCall& operator=(const BrickedVolumetricDataCall& rhs);
+
+private:
+    /** The base class. */
+    typedef AbstractGetData3DCall Base;
+
+    /** The functions that are provided by the call. */
+    static const char* FUNCTIONS[3];
+
+    /** The edge length of the bricks in voxels. */
+    size_t brickSize;
+
+    /** The voxels of the requested bricks. */
+    std::vector<BrickData> brickData;
+
+    /** The brick table. The call does not own this memory! */
+    const Brick* bricks;
+
+    /** The number of entries in the brick table. */
+    size_t brickCount;
+
+    /** The levels of detail. The call does not own this memory! */
+    const Level* levels;
+
+    /** The number of levels of detail. */
+    unsigned int levelCount;
+
+    /** Per-brick and per-component maxima. The call does not own this memory! */
+    const double* maxValues;
+
+    /** Pointer to the metadata descriptor of the data set. */
+    const Metadata* metadata;
+
+    /** Per-brick and per-component minima. The call does not own this memory! */
+    const double* minValues;
+
+    /** The bricks to be prefetched. The call does not own this memory! */
+    const size_t* prefetch;
+
+    /** The number of bricks to be prefetched. */
+    size_t prefetchCount;
+
+    /** The requested bricks. The call does not own this memory! */
+    const size_t* request;
+
+    /** The number of requested bricks. */
+    size_t requestCount;
+};
+
+/** Call Descriptor.  */
+typedef core::factories::CallAutoDescription<BrickedVolumetricDataCall> BrickedVolumetricDataCallDescription;
+
+} // namespace megamol::geocalls
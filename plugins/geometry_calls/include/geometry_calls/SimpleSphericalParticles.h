@@ -254,6 +254,49 @@ public:
             return this->id_acc_;
         }
 
+        /**
+         * Gathers the positions of 'count' particles starting at 'first'
+         * into caller-provided SoA buffers.
+         */
+        void GetPositions(size_t const first, size_t const count, float* x, float* y, float* z) const {
+            this->x_acc_->Gather_f(first, count, x);
+            this->y_acc_->Gather_f(first, count, y);
+            this->z_acc_->Gather_f(first, count, z);
+        }
+
+        /**
+         * Gathers the radii of 'count' particles starting at 'first'.
+         */
+        void GetRadii(size_t const first, size_t const count, float* r) const {
+            this->r_acc_->Gather_f(first, count, r);
+        }
+
+        /**
+         * Gathers the colours of 'count' particles starting at 'first'
+         * into caller-provided SoA buffers. Any of the buffers may be
+         * nullptr if the component is not needed.
+         */
+        void GetColors(size_t const first, size_t const count, float* r, float* g, float* b, float* a) const {
+            if (r != nullptr)
+                this->cr_acc_->Gather_f(first, count, r);
+            if (g != nullptr)
+                this->cg_acc_->Gather_f(first, count, g);
+            if (b != nullptr)
+                this->cb_acc_->Gather_f(first, count, b);
+            if (a != nullptr)
+                this->ca_acc_->Gather_f(first, count, a);
+        }
+
+        /**
+         * Gathers the directions of 'count' particles starting at 'first'
+         * into caller-provided SoA buffers.
+         */
+        void GetDirections(size_t const first, size_t const count, float* dx, float* dy, float* dz) const {
+            this->dx_acc_->Gather_f(first, count, dx);
+            this->dy_acc_->Gather_f(first, count, dy);
+            this->dz_acc_->Gather_f(first, count, dz);
+        }
+
     private:
         std::shared_ptr<Accessor> x_acc_ = std::make_shared<Accessor_0>();
         std::shared_ptr<Accessor> y_acc_ = std::make_shared<Accessor_0>();
@@ -605,6 +648,78 @@ public:
         this->par_store_->SetIDData(t, reinterpret_cast<char const*>(p), this->idStride);
     }
 
+    /**
+     * Calls 'f' once with a typed view of the vertex data, i.e.
+     * StridedView<float, 3>, StridedView<float, 4> (XYZR),
+     * StridedView<unsigned short, 3> or StridedView<double, 3>. Allows
+     * loops over all particles without per-element virtual calls.
+     *
+     * @param f The generic callable receiving the view.
+     *
+     * @return 'false' if there is no vertex data, 'true' otherwise.
+     */
+    template<class F>
+    bool VisitVertexData(F&& f) const {
+        auto const ptr = reinterpret_cast<char const*>(this->vertPtr);
+        switch (this->vertDataType) {
+        case VERTDATA_FLOAT_XYZ:
+            f(StridedView<float, 3>(ptr, this->vertStride));
+            return true;
+        case VERTDATA_FLOAT_XYZR:
+            f(StridedView<float, 4>(ptr, this->vertStride));
+            return true;
+        case VERTDATA_SHORT_XYZ:
+            f(StridedView<unsigned short, 3>(ptr, this->vertStride));
+            return true;
+        case VERTDATA_DOUBLE_XYZ:
+            f(StridedView<double, 3>(ptr, this->vertStride));
+            return true;
+        case VERTDATA_NONE:
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Calls 'f' once with a typed view of the colour data. The view has
+     * one component for intensities and three or four for RGB(A).
+     *
+     * @param f The generic callable receiving the view.
+     *
+     * @return 'false' if there is no colour data (global colour), 'true'
+     *         otherwise.
+     */
+    template<class F>
+    bool VisitColourData(F&& f) const {
+        auto const ptr = reinterpret_cast<char const*>(this->colPtr);
+        switch (this->colDataType) {
+        case COLDATA_UINT8_RGB:
+            f(StridedView<unsigned char, 3>(ptr, this->colStride));
+            return true;
+        case COLDATA_UINT8_RGBA:
+            f(StridedView<unsigned char, 4>(ptr, this->colStride));
+            return true;
+        case COLDATA_FLOAT_RGB:
+            f(StridedView<float, 3>(ptr, this->colStride));
+            return true;
+        case COLDATA_FLOAT_RGBA:
+            f(StridedView<float, 4>(ptr, this->colStride));
+            return true;
+        case COLDATA_FLOAT_I:
+            f(StridedView<float, 1>(ptr, this->colStride));
+            return true;
+        case COLDATA_USHORT_RGBA:
+            f(StridedView<unsigned short, 4>(ptr, this->colStride));
+            return true;
+        case COLDATA_DOUBLE_I:
+            f(StridedView<double, 1>(ptr, this->colStride));
+            return true;
+        case COLDATA_NONE:
+        default:
+            return false;
+        }
+    }
+
     /**
      * Reports existence of IDs.
      *
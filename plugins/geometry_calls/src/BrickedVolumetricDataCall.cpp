@@ -0,0 +1,154 @@
+/*
+ * BrickedVolumetricDataCall.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "geometry_calls/BrickedVolumetricDataCall.h"
+
+#include <cstring>
+
+
+#define STATIC_ARRAY_COUNT(ary) (sizeof(ary) / sizeof(*(ary)))
+
+namespace megamol::geocalls {
+
+/*
+ * BrickedVolumetricDataCall::FunctionCount
+ */
+unsigned int BrickedVolumetricDataCall::FunctionCount() {
+    return STATIC_ARRAY_COUNT(BrickedVolumetricDataCall::FUNCTIONS);
+}
+
+
+/*
+ * BrickedVolumetricDataCall::FunctionName
+ */
+const char* BrickedVolumetricDataCall::FunctionName(unsigned int idx) {
+    if (idx < BrickedVolumetricDataCall::FunctionCount()) {
+        return BrickedVolumetricDataCall::FUNCTIONS[idx];
+    } else {
+        return "";
+    }
+}
+
+
+/*
+ * BrickedVolumetricDataCall::CopyBrickToGrid
+ */
+void BrickedVolumetricDataCall::CopyBrickToGrid(
+    const Brick& brick, const void* src, size_t voxelSize, void* dst, const size_t resolution[3]) {
+    const auto* s = static_cast<const uint8_t*>(src);
+    auto* d = static_cast<uint8_t*>(dst);
+    const size_t row = brick.Resolution[0] * voxelSize;
+    for (size_t z = 0; z < brick.Resolution[2]; ++z) {
+        for (size_t y = 0; y < brick.Resolution[1]; ++y) {
+            const size_t gy = brick.Origin[1] + y;
+            const size_t gz = brick.Origin[2] + z;
+            std::memcpy(d + ((gz * resolution[1] + gy) * resolution[0] + brick.Origin[0]) * voxelSize,
+                s + (z * brick.Resolution[1] + y) * row, row);
+        }
+    }
+}
+
+
+/*
+ * BrickedVolumetricDataCall::CopyGridToBrick
+ */
+void BrickedVolumetricDataCall::CopyGridToBrick(
+    const Brick& brick, const void* src, const size_t resolution[3], size_t voxelSize, void* dst) {
+    const auto* s = static_cast<const uint8_t*>(src);
+    auto* d = static_cast<uint8_t*>(dst);
+    const size_t row = brick.Resolution[0] * voxelSize;
+    for (size_t z = 0; z < brick.Resolution[2]; ++z) {
+        for (size_t y = 0; y < brick.Resolution[1]; ++y) {
+            const size_t gy = brick.Origin[1] + y;
+            const size_t gz = brick.Origin[2] + z;
+            std::memcpy(d + (z * brick.Resolution[1] + y) * row,
+                s + ((gz * resolution[1] + gy) * resolution[0] + brick.Origin[0]) * voxelSize, row);
+        }
+    }
+}
+
+
+/*
+ * BrickedVolumetricDataCall::IDX_GET_EXTENTS
+ */
+const unsigned int BrickedVolumetricDataCall::IDX_GET_EXTENTS = 0;
+
+
+/*
+ * BrickedVolumetricDataCall::IDX_GET_DATA
+ */
+const unsigned int BrickedVolumetricDataCall::IDX_GET_DATA = 1;
+
+
+/*
+ * BrickedVolumetricDataCall::IDX_GET_BRICKS
+ */
+const unsigned int BrickedVolumetricDataCall::IDX_GET_BRICKS = 2;
+
+
+/*
+ * BrickedVolumetricDataCall::BrickedVolumetricDataCall
+ */
+BrickedVolumetricDataCall::BrickedVolumetricDataCall()
+        : brickSize(0)
+        , bricks(nullptr)
+        , brickCount(0)
+        , levels(nullptr)
+        , levelCount(0)
+        , maxValues(nullptr)
+        , metadata(nullptr)
+        , minValues(nullptr)
+        , prefetch(nullptr)
+        , prefetchCount(0)
+        , request(nullptr)
+        , requestCount(0) {}
+
+
+/*
+ * BrickedVolumetricDataCall::BrickedVolumetricDataCall
+ */
+BrickedVolumetricDataCall::BrickedVolumetricDataCall(const BrickedVolumetricDataCall& rhs)
+        : BrickedVolumetricDataCall() {
+    *this = rhs;
+}
+
+
+/*
+ * BrickedVolumetricDataCall::~BrickedVolumetricDataCall
+ */
+BrickedVolumetricDataCall::~BrickedVolumetricDataCall() {}
+
+
+/*
+ * BrickedVolumetricDataCall::operator =
+ */
+BrickedVolumetricDataCall& BrickedVolumetricDataCall::operator=(const BrickedVolumetricDataCall& rhs) {
+    if (this != &rhs) {
+        Base::operator=(rhs);
+        this->brickSize = rhs.brickSize;
+        this->brickData = rhs.brickData;
+        this->bricks = rhs.bricks;
+        this->brickCount = rhs.brickCount;
+        this->levels = rhs.levels;
+        this->levelCount = rhs.levelCount;
+        this->maxValues = rhs.maxValues;
+        this->metadata = rhs.metadata;
+        this->minValues = rhs.minValues;
+        this->prefetch = rhs.prefetch;
+        this->prefetchCount = rhs.prefetchCount;
+        this->request = rhs.request;
+        this->requestCount = rhs.requestCount;
+    }
+    return *this;
+}
+
+
+/*
+ * BrickedVolumetricDataCall::FUNCTIONS
+ */
+const char* BrickedVolumetricDataCall::FUNCTIONS[] = {"GetExtents", "GetData", "GetBricks"};
+} // namespace megamol::geocalls
@@ -8,6 +8,7 @@
 #include "mmcore/factories/PluginRegister.h"
 
 #include "geometry_calls/BezierCurvesListDataCall.h"
+#include "geometry_calls/BrickedVolumetricDataCall.h"
 #include "geometry_calls/CalloutImageCall.h"
 #include "geometry_calls/EllipsoidalDataCall.h"
 #include "geometry_calls/LinesDataCall.h"
@@ -35,6 +36,7 @@ public:
         this->call_descriptions.RegisterAutoDescription<megamol::geocalls::EllipsoidalParticleDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::geocalls::ParticleRelistCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::geocalls::VolumetricDataCall>();
+        this->call_descriptions.RegisterAutoDescription<megamol::geocalls::BrickedVolumetricDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::geocalls::BezierCurvesListDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::geocalls::QRCodeDataCall>();
         this->call_descriptions.RegisterAutoDescription<megamol::geocalls::CalloutImageCall>();
@@ -0,0 +1,564 @@
+/**
+ * MegaMol
+ * Copyright (c) 2024, MegaMol Dev Team
+ * All rights reserved.
+ */
+
+#include "BarnesHutTSNE.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <utility>
+
+
+using namespace megamol;
+using namespace megamol::infovis;
+
+
+namespace {
+
+/**
+ * Vantage-point tree over the rows of a row-major point set.
+ */
+class VpTree {
+public:
+    VpTree(std::vector<double> const& points, size_t rows, size_t columns, uint32_t seed)
+            : points(points)
+            , columns(columns)
+            , items(rows) {
+        std::iota(this->items.begin(), this->items.end(), 0);
+        this->nodes.reserve(rows);
+        std::mt19937 rng(seed);
+        build(0, rows, rng);
+    }
+
+    /** Fills 'heap' with the 'k' nearest neighbours of point 'query', excluding the point itself. */
+    void Search(uint32_t query, size_t k, std::priority_queue<std::pair<double, uint32_t>>& heap) const {
+        double tau = std::numeric_limits<double>::max();
+        if (!this->nodes.empty()) {
+            search(0, query, k, heap, tau);
+        }
+    }
+
+private:
+    struct Node {
+        uint32_t item;
+        double threshold;
+        int32_t left;
+        int32_t right;
+    };
+
+    double distance(uint32_t a, uint32_t b) const {
+        double const* pa = &this->points[a * this->columns];
+        double const* pb = &this->points[b * this->columns];
+        double sum = 0.0;
+        for (size_t c = 0; c < this->columns; ++c) {
+            double const d = pa[c] - pb[c];
+            sum += d * d;
+        }
+        return std::sqrt(sum);
+    }
+
+    int32_t build(size_t lower, size_t upper, std::mt19937& rng) {
+        if (lower >= upper) {
+            return -1;
+        }
+        int32_t const idx = static_cast<int32_t>(this->nodes.size());
+        this->nodes.push_back({this->items[lower], 0.0, -1, -1});
+        if (upper - lower > 1) {
+            std::swap(this->items[lower], this->items[lower + rng() % (upper - lower)]);
+            uint32_t const vp = this->items[lower];
+            size_t const median = (lower + upper) / 2;
+            std::nth_element(this->items.begin() + lower + 1, this->items.begin() + median,
+                this->items.begin() + upper,
+                [this, vp](uint32_t a, uint32_t b) { return distance(vp, a) < distance(vp, b); });
+            this->nodes[idx].item = vp;
+            this->nodes[idx].threshold = distance(vp, this->items[median]);
+            int32_t const left = build(lower + 1, median, rng);
+            int32_t const right = build(median, upper, rng);
+            this->nodes[idx].left = left;
+            this->nodes[idx].right = right;
+        }
+        return idx;
+    }
+
+    void search(int32_t node, uint32_t query, size_t k, std::priority_queue<std::pair<double, uint32_t>>& heap,
+        double& tau) const {
+        if (node < 0) {
+            return;
+        }
+        Node const& n = this->nodes[node];
+        double const dist = distance(n.item, query);
+        if (n.item != query && dist < tau) {
+            if (heap.size() == k) {
+                heap.pop();
+            }
+            heap.push(std::make_pair(dist, n.item));
+            if (heap.size() == k) {
+                tau = heap.top().first;
+            }
+        }
+        if (dist < n.threshold) {
+            if (dist - tau <= n.threshold)
+                search(n.left, query, k, heap, tau);
+            if (dist + tau >= n.threshold)
+                search(n.right, query, k, heap, tau);
+        } else {
+            if (dist + tau >= n.threshold)
+                search(n.right, query, k, heap, tau);
+            if (dist - tau <= n.threshold)
+                search(n.left, query, k, heap, tau);
+        }
+    }
+
+    std::vector<double> const& points;
+    size_t columns;
+    std::vector<uint32_t> items;
+    std::vector<Node> nodes;
+};
+
+/**
+ * Space-partitioning tree with 2^d children per node over an embedding of
+ * up to three dimensions, summarizing the points below each node by their
+ * number and center of mass.
+ */
+class SpaceTree {
+public:
+    static constexpr int maxDims = 3;
+
+    SpaceTree(std::vector<double> const& Y, size_t rows, int dims) : Y(Y), dims(dims) {
+        Node root;
+        double extent = 0.0;
+        for (int d = 0; d < dims; ++d) {
+            double lo = std::numeric_limits<double>::max();
+            double hi = std::numeric_limits<double>::lowest();
+            for (size_t i = 0; i < rows; ++i) {
+                lo = std::min(lo, Y[i * dims + d]);
+                hi = std::max(hi, Y[i * dims + d]);
+            }
+            root.center[d] = 0.5 * (lo + hi);
+            root.halfWidth[d] = 0.5 * (hi - lo) + 1e-5;
+            extent = std::max(extent, root.halfWidth[d]);
+        }
+        this->minWidth = extent * 1e-12;
+        this->nodes.reserve(2 * rows + 1);
+        this->nodes.push_back(root);
+        for (size_t i = 0; i < rows; ++i) {
+            insert(static_cast<uint32_t>(i));
+        }
+    }
+
+    /** Accumulates the repulsive force on 'point' into 'negF' and its contribution to the normalization. */
+    void Repulsion(uint32_t point, double theta, double* negF, double& sumQ) const {
+        repulsion(0, point, &this->Y[point * this->dims], theta * theta, negF, sumQ);
+    }
+
+private:
+    struct Node {
+        double center[maxDims] = {};
+        double halfWidth[maxDims] = {};
+        double centerOfMass[maxDims] = {};
+        uint32_t count = 0;
+        int32_t point = -1;
+        int32_t firstChild = -1;
+    };
+
+    int childOf(Node const& n, double const* y) const {
+        int child = 0;
+        for (int d = 0; d < this->dims; ++d) {
+            if (y[d] > n.center[d]) {
+                child |= 1 << d;
+            }
+        }
+        return child;
+    }
+
+    void subdivide(size_t node) {
+        int32_t const first = static_cast<int32_t>(this->nodes.size());
+        for (int c = 0; c < (1 << this->dims); ++c) {
+            Node child;
+            for (int d = 0; d < this->dims; ++d) {
+                Node const& parent = this->nodes[node];
+                child.halfWidth[d] = 0.5 * parent.halfWidth[d];
+                child.center[d] = parent.center[d] + ((c >> d) & 1 ? child.halfWidth[d] : -child.halfWidth[d]);
+            }
+            this->nodes.push_back(child);
+        }
+        this->nodes[node].firstChild = first;
+    }
+
+    void insert(uint32_t point) {
+        double const* y = &this->Y[point * this->dims];
+        size_t node = 0;
+        for (;;) {
+            {
+                Node& n = this->nodes[node];
+                double const cnt = static_cast<double>(n.count);
+                for (int d = 0; d < this->dims; ++d) {
+                    n.centerOfMass[d] = (n.centerOfMass[d] * cnt + y[d]) / (cnt + 1.0);
+                }
+                ++n.count;
+                if (n.firstChild < 0) {
+                    if (n.point < 0) {
+                        n.point = static_cast<int32_t>(point);
+                        return;
+                    }
+                    // Duplicates and points closer than the precision are kept as one leaf.
+                    double const* occupant = &this->Y[n.point * this->dims];
+                    bool same = true;
+                    bool tiny = false;
+                    for (int d = 0; d < this->dims; ++d) {
+                        same = same && occupant[d] == y[d];
+                        tiny = tiny || n.halfWidth[d] < this->minWidth;
+                    }
+                    if (same || tiny) {
+                        return;
+                    }
+                    subdivide(node);
+                    Node& m = this->nodes[node];
+                    Node& c = this->nodes[m.firstChild + childOf(m, occupant)];
+                    c.point = m.point;
+                    c.count = m.count - 1;
+                    std::copy(occupant, occupant + this->dims, c.centerOfMass);
+                    m.point = -1;
+                }
+            }
+            Node const& n = this->nodes[node];
+            node = n.firstChild + childOf(n, y);
+        }
+    }
+
+    void repulsion(size_t node, uint32_t point, double const* y, double theta2, double* negF, double& sumQ) const {
+        Node const& n = this->nodes[node];
+        if (n.count == 0) {
+            return;
+        }
+        bool const leaf = n.firstChild < 0;
+        double cnt = static_cast<double>(n.count);
+        if (leaf && n.point == static_cast<int32_t>(point)) {
+            cnt -= 1.0;
+            if (cnt <= 0.0) {
+                return;
+            }
+        }
+
+        double diff[maxDims];
+        double D = 0.0;
+        double maxWidth = 0.0;
+        for (int d = 0; d < this->dims; ++d) {
+            diff[d] = y[d] - n.centerOfMass[d];
+            D += diff[d] * diff[d];
+            maxWidth = std::max(maxWidth, n.halfWidth[d]);
+        }
+
+        if (leaf || maxWidth * maxWidth < theta2 * D) {
+            double const q = 1.0 / (1.0 + D);
+            double mult = cnt * q;
+            sumQ += mult;
+            mult *= q;
+            for (int d = 0; d < this->dims; ++d) {
+                negF[d] += mult * diff[d];
+            }
+        } else {
+            for (int c = 0; c < (1 << this->dims); ++c) {
+                repulsion(n.firstChild + c, point, y, theta2, negF, sumQ);
+            }
+        }
+    }
+
+    std::vector<double> const& Y;
+    int dims;
+    double minWidth;
+    std::vector<Node> nodes;
+};
+
+} // namespace
+
+
+bool BarnesHutTSNE::Run(float const* data, size_t rows, size_t columns, Parameters const& params,
+    std::vector<double>& result, ProgressCallback const& progress) {
+    int const dims = params.outputDimension;
+    if (data == nullptr || rows < 2 || columns == 0 || dims < 1 || params.perplexity <= 0.0) {
+        return false;
+    }
+    int const k = static_cast<int>(std::min<double>(static_cast<double>(rows - 1), 3.0 * params.perplexity));
+    int64_t const n = static_cast<int64_t>(rows);
+
+    // Center the data and scale it into [-1, 1]
+    std::vector<double> points(data, data + rows * columns);
+    double maxAbs = 0.0;
+    for (size_t c = 0; c < columns; ++c) {
+        double mean = 0.0;
+        for (size_t i = 0; i < rows; ++i) {
+            mean += points[i * columns + c];
+        }
+        mean /= static_cast<double>(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            points[i * columns + c] -= mean;
+            maxAbs = std::max(maxAbs, std::abs(points[i * columns + c]));
+        }
+    }
+    if (maxAbs > 0.0) {
+        for (auto& p : points) {
+            p /= maxAbs;
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    std::vector<double> sqDistances;
+    nearestNeighbours(points, rows, columns, k, indices, sqDistances);
+    points = std::vector<double>();
+    SparseMatrix const P = inputAffinities(indices, sqDistances, rows, k, params.perplexity);
+    indices = std::vector<uint32_t>();
+    sqDistances = std::vector<double>();
+
+    std::vector<double> Y(rows * dims);
+    std::mt19937 rng(params.randomSeed);
+    std::normal_distribution<double> normal(0.0, 1e-4);
+    for (auto& y : Y) {
+        y = normal(rng);
+    }
+
+    std::vector<double> grad(rows * dims);
+    std::vector<double> update(rows * dims, 0.0);
+    std::vector<double> gains(rows * dims, 1.0);
+    int64_t const elements = static_cast<int64_t>(Y.size());
+
+    for (int iter = 0; iter < params.maxIter; ++iter) {
+        double const exaggeration = iter < params.stopLyingIter ? params.exaggeration : 1.0;
+        double const momentum = iter < params.momentumSwitchIter ? 0.5 : 0.8;
+
+        gradient(P, exaggeration, Y, rows, dims, params.theta, grad);
+
+#pragma omp parallel for
+        for (int64_t e = 0; e < elements; ++e) {
+            gains[e] = (grad[e] > 0.0) != (update[e] > 0.0) ? gains[e] + 0.2 : gains[e] * 0.8;
+            gains[e] = std::max(gains[e], 0.01);
+            update[e] = momentum * update[e] - params.learningRate * gains[e] * grad[e];
+            Y[e] += update[e];
+        }
+
+        // Keep the embedding centered
+        for (int d = 0; d < dims; ++d) {
+            double mean = 0.0;
+            for (int64_t i = 0; i < n; ++i) {
+                mean += Y[i * dims + d];
+            }
+            mean /= static_cast<double>(rows);
+            for (int64_t i = 0; i < n; ++i) {
+                Y[i * dims + d] -= mean;
+            }
+        }
+
+        if (progress && !progress(iter, Y)) {
+            return false;
+        }
+    }
+
+    result = std::move(Y);
+    return true;
+}
+
+
+void BarnesHutTSNE::nearestNeighbours(std::vector<double> const& points, size_t rows, size_t columns, int k,
+    std::vector<uint32_t>& indices, std::vector<double>& sqDistances) {
+    VpTree const tree(points, rows, columns, 0);
+    indices.resize(rows * k);
+    sqDistances.resize(rows * k);
+
+    int64_t const n = static_cast<int64_t>(rows);
+#pragma omp parallel
+    {
+        std::priority_queue<std::pair<double, uint32_t>> heap;
+#pragma omp for schedule(dynamic, 64)
+        for (int64_t i = 0; i < n; ++i) {
+            tree.Search(static_cast<uint32_t>(i), k, heap);
+            // the heap pops the farthest neighbour first
+            for (int m = static_cast<int>(heap.size()) - 1; m >= 0; --m) {
+                indices[i * k + m] = heap.top().second;
+                sqDistances[i * k + m] = heap.top().first * heap.top().first;
+                heap.pop();
+            }
+        }
+    }
+}
+
+
+BarnesHutTSNE::SparseMatrix BarnesHutTSNE::inputAffinities(std::vector<uint32_t> const& indices,
+    std::vector<double> const& sqDistances, size_t rows, int k, double perplexity) {
+    int64_t const n = static_cast<int64_t>(rows);
+    double const targetEntropy = std::log(perplexity);
+
+    // Conditional probabilities p_j|i, each row sorted by column
+    std::vector<std::pair<uint32_t, double>> conditional(rows * k);
+#pragma omp parallel
+    {
+        std::vector<double> p(k);
+#pragma omp for schedule(dynamic, 64)
+        for (int64_t i = 0; i < n; ++i) {
+            double const* D = &sqDistances[i * k];
+            // the entropy does not change if all distances are shifted, which avoids underflow
+            double const nearest = D[0];
+            double beta = 1.0;
+            double minBeta = -DBL_MAX;
+            double maxBeta = DBL_MAX;
+            double sum = DBL_MIN;
+            for (int iter = 0; iter < 200; ++iter) {
+                sum = DBL_MIN;
+                double weighted = 0.0;
+                for (int m = 0; m < k; ++m) {
+                    p[m] = std::exp(-beta * (D[m] - nearest));
+                    sum += p[m];
+                    weighted += beta * (D[m] - nearest) * p[m];
+                }
+                double const diff = weighted / sum + std::log(sum) - targetEntropy;
+                if (std::abs(diff) < 1e-5) {
+                    break;
+                }
+                if (diff > 0.0) {
+                    minBeta = beta;
+                    beta = maxBeta == DBL_MAX ? beta * 2.0 : 0.5 * (beta + maxBeta);
+                } else {
+                    maxBeta = beta;
+                    beta = minBeta == -DBL_MAX ? beta * 0.5 : 0.5 * (beta + minBeta);
+                }
+            }
+            auto* row = &conditional[i * k];
+            for (int m = 0; m < k; ++m) {
+                row[m] = std::make_pair(indices[i * k + m], p[m] / sum);
+            }
+            std::sort(row, row + k);
+        }
+    }
+
+    // Transpose by counting, rows of the transpose come out sorted
+    std::vector<size_t> tOffsets(rows + 1, 0);
+    for (auto const& e : conditional) {
+        ++tOffsets[e.first + 1];
+    }
+    std::partial_sum(tOffsets.begin(), tOffsets.end(), tOffsets.begin());
+    std::vector<std::pair<uint32_t, double>> transposed(conditional.size());
+    {
+        std::vector<size_t> fill(tOffsets.begin(), tOffsets.end() - 1);
+        for (size_t i = 0; i < rows; ++i) {
+            for (int m = 0; m < k; ++m) {
+                auto const& e = conditional[i * k + m];
+                transposed[fill[e.first]++] = std::make_pair(static_cast<uint32_t>(i), e.second);
+            }
+        }
+    }
+
+    // P = (P_cond + P_cond^T) / sum by merging the sorted rows, first counting then filling
+    SparseMatrix P;
+    P.rowOffsets.resize(rows + 1, 0);
+    auto merge = [&](int64_t i, uint32_t* columnsOut, double* valuesOut) {
+        auto a = conditional.begin() + i * k;
+        auto const aEnd = a + k;
+        auto b = transposed.begin() + tOffsets[i];
+        auto const bEnd = transposed.begin() + tOffsets[i + 1];
+        size_t count = 0;
+        while (a != aEnd || b != bEnd) {
+            uint32_t col;
+            double val = 0.0;
+            if (b == bEnd || (a != aEnd && a->first < b->first)) {
+                col = a->first;
+                val = (a++)->second;
+            } else if (a == aEnd || b->first < a->first) {
+                col = b->first;
+                val = (b++)->second;
+            } else {
+                col = a->first;
+                val = (a++)->second + (b++)->second;
+            }
+            if (columnsOut != nullptr) {
+                columnsOut[count] = col;
+                valuesOut[count] = val;
+            }
+            ++count;
+        }
+        return count;
+    };
+#pragma omp parallel for
+    for (int64_t i = 0; i < n; ++i) {
+        P.rowOffsets[i + 1] = merge(i, nullptr, nullptr);
+    }
+    std::partial_sum(P.rowOffsets.begin(), P.rowOffsets.end(), P.rowOffsets.begin());
+    P.columns.resize(P.rowOffsets.back());
+    P.values.resize(P.rowOffsets.back());
+#pragma omp parallel for
+    for (int64_t i = 0; i < n; ++i) {
+        merge(i, &P.columns[P.rowOffsets[i]], &P.values[P.rowOffsets[i]]);
+    }
+
+    double const total = std::accumulate(P.values.begin(), P.values.end(), 0.0);
+    for (auto& v : P.values) {
+        v /= total;
+    }
+    return P;
+}
+
+
+void BarnesHutTSNE::gradient(SparseMatrix const& P, double exaggeration, std::vector<double> const& Y, size_t rows,
+    int dims, double theta, std::vector<double>& grad) {
+    int64_t const n = static_cast<int64_t>(rows);
+    std::vector<double> negF(rows * dims, 0.0);
+    double sumQ = 0.0;
+
+    if (theta > 0.0 && dims <= SpaceTree::maxDims) {
+        SpaceTree const tree(Y, rows, dims);
+#pragma omp parallel for schedule(dynamic, 256) reduction(+ : sumQ)
+        for (int64_t i = 0; i < n; ++i) {
+            tree.Repulsion(static_cast<uint32_t>(i), theta, &negF[i * dims], sumQ);
+        }
+    } else {
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : sumQ)
+        for (int64_t i = 0; i < n; ++i) {
+            double const* yi = &Y[i * dims];
+            std::vector<double> force(dims, 0.0);
+            double rowQ = 0.0;
+            for (int64_t j = 0; j < n; ++j) {
+                if (j == i)
+                    continue;
+                double const* yj = &Y[j * dims];
+                double D = 0.0;
+                for (int d = 0; d < dims; ++d) {
+                    D += (yi[d] - yj[d]) * (yi[d] - yj[d]);
+                }
+                double const q = 1.0 / (1.0 + D);
+                rowQ += q;
+                for (int d = 0; d < dims; ++d) {
+                    force[d] += q * q * (yi[d] - yj[d]);
+                }
+            }
+            std::copy(force.begin(), force.end(), &negF[i * dims]);
+            sumQ += rowQ;
+        }
+    }
+
+    // Attractive forces along the edges of the neighbourhood graph
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int64_t i = 0; i < n; ++i) {
+        double const* yi = &Y[i * dims];
+        double* gi = &grad[i * dims];
+        std::fill(gi, gi + dims, 0.0);
+        for (size_t e = P.rowOffsets[i]; e < P.rowOffsets[i + 1]; ++e) {
+            double const* yj = &Y[static_cast<size_t>(P.columns[e]) * dims];
+            double D = 1.0;
+            for (int d = 0; d < dims; ++d) {
+                D += (yi[d] - yj[d]) * (yi[d] - yj[d]);
+            }
+            double const mult = exaggeration * P.values[e] / D;
+            for (int d = 0; d < dims; ++d) {
+                gi[d] += mult * (yi[d] - yj[d]);
+            }
+        }
+        for (int d = 0; d < dims; ++d) {
+            gi[d] -= negF[i * dims + d] / sumQ;
+        }
+    }
+}
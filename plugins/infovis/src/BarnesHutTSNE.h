@@ -0,0 +1,80 @@
+/**
+ * MegaMol
+ * Copyright (c) 2024, MegaMol Dev Team
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+namespace megamol::infovis {
+
+/**
+ * Multi-threaded Barnes-Hut t-SNE (van der Maaten, 2014).
+ *
+ * The input affinities are computed from the 3 * perplexity nearest
+ * neighbours of each point, which are found with a vantage-point tree.
+ * Repulsive forces are approximated with a 2^d-tree over the embedding for
+ * up to three output dimensions and computed exactly otherwise or if theta
+ * is zero. All per-point work, i.e. the neighbour queries, the perplexity
+ * calibration and the force computation, runs in parallel.
+ */
+class BarnesHutTSNE {
+public:
+    struct Parameters {
+        int outputDimension = 2;
+        double perplexity = 30.0;
+        double theta = 0.5;
+        int maxIter = 1000;
+        int stopLyingIter = 250;
+        int momentumSwitchIter = 250;
+        double learningRate = 200.0;
+        double exaggeration = 12.0;
+        uint32_t randomSeed = 42;
+    };
+
+    /**
+     * Called after every iteration with the iteration number and the
+     * current embedding (row-major, outputDimension values per point).
+     * Returning 'false' stops the optimization.
+     */
+    using ProgressCallback = std::function<bool(int, std::vector<double> const&)>;
+
+    /**
+     * Embeds the 'rows' points of the row-major 'data'.
+     *
+     * @param result   Receives the row-major embedding.
+     * @param progress Optional callback, see ProgressCallback.
+     *
+     * @return 'true' if all iterations ran, 'false' if the input is invalid or the optimization was stopped.
+     */
+    static bool Run(float const* data, size_t rows, size_t columns, Parameters const& params,
+        std::vector<double>& result, ProgressCallback const& progress = nullptr);
+
+private:
+    /** Symmetric input affinities in compressed sparse row format */
+    struct SparseMatrix {
+        std::vector<size_t> rowOffsets;
+        std::vector<uint32_t> columns;
+        std::vector<double> values;
+    };
+
+    /** Answer the 'k' nearest neighbours of every point and their squared distances. */
+    static void nearestNeighbours(std::vector<double> const& points, size_t rows, size_t columns, int k,
+        std::vector<uint32_t>& indices, std::vector<double>& sqDistances);
+
+    /** Calibrates the Gaussian kernel of every point to the perplexity and symmetrizes the result. */
+    static SparseMatrix inputAffinities(std::vector<uint32_t> const& indices,
+        std::vector<double> const& sqDistances, size_t rows, int k, double perplexity);
+
+    /** Computes the gradient of the Kullback-Leibler divergence for the embedding 'Y'. */
+    static void gradient(SparseMatrix const& P, double exaggeration, std::vector<double> const& Y, size_t rows,
+        int dims, double theta, std::vector<double>& grad);
+};
+
+} // namespace megamol::infovis
@@ -2,11 +2,14 @@
 
 #include "datatools/table/TableDataCall.h"
 #include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/IntParam.h"
 
 #include "MDSProjection.h"
 #include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
 #include <Eigen/SVD>
+#include <limits>
 #include <set>
 #include <sstream>
 
@@ -15,12 +18,15 @@ using namespace megamol;
 using namespace megamol::infovis;
 using namespace Eigen;
 
+enum MDSMode { CLASSIC_MDS = 0, LANDMARK_MDS };
 
 MDSProjection::MDSProjection()
         : megamol::core::Module()
         , dataOutSlot("dataOut", "Ouput")
         , dataInSlot("dataIn", "Input")
         , reduceToNSlot("nComponents", "Number of components (dimensions) to keep")
+        , modeSlot("mode", "Classic MDS needs O(n^2) memory, landmark MDS approximates it for large tables")
+        , landmarkCountSlot("landmarks", "Number of landmarks of landmark MDS")
         , datahash(0)
         , dataInHash(0)
         , columnInfos() {
@@ -36,6 +42,15 @@ MDSProjection::MDSProjection()
 
     reduceToNSlot << new ::megamol::core::param::IntParam(2);
     this->MakeSlotAvailable(&reduceToNSlot);
+
+    auto modes = new ::megamol::core::param::EnumParam(CLASSIC_MDS);
+    modes->SetTypePair(CLASSIC_MDS, "Classic");
+    modes->SetTypePair(LANDMARK_MDS, "Landmark");
+    modeSlot << modes;
+    this->MakeSlotAvailable(&modeSlot);
+
+    landmarkCountSlot << new ::megamol::core::param::IntParam(1000, 3);
+    this->MakeSlotAvailable(&landmarkCountSlot);
 }
 
 MDSProjection::~MDSProjection() {
@@ -116,7 +131,7 @@ bool MDSProjection::getHashCallback(core::Call& c) {
 bool megamol::infovis::MDSProjection::dataProjection(megamol::datatools::table::TableDataCall* inCall) {
     // Test if inData has changed and if slots have changed
     if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty()) {
+        if (!reduceToNSlot.IsDirty() && !modeSlot.IsDirty() && !landmarkCountSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
@@ -134,18 +149,27 @@ bool megamol::infovis::MDSProjection::dataProjection(megamol::datatools::table::
     }
 
     // Load data in a Matrix
-    Eigen::MatrixXd inDataMat = Eigen::MatrixXd(rowsCount, columnCount);
-    for (int row = 0; row < rowsCount; row++) {
-        for (int col = 0; col < columnCount; col++) {
-            inDataMat(row, col) = inData[row * columnCount + col];
+    Eigen::MatrixXd inDataMat =
+        Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> const>(
+            inData, rowsCount, columnCount)
+            .cast<double>();
+
+    Eigen::MatrixXd result;
+    if (this->modeSlot.Param<core::param::EnumParam>()->Value() == LANDMARK_MDS) {
+        int landmarkCount = this->landmarkCountSlot.Param<core::param::IntParam>()->Value();
+        if (landmarkCount <= outputDimCount) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError(
+                _T("%hs: Landmark MDS needs more landmarks than dimensions\n"), ClassName());
+            return false;
         }
+        result = landmarkMds(inDataMat, outputDimCount, landmarkCount);
+    } else {
+        // generate dissimilarity Matrix( squared euclidean Distance matrix)
+        Eigen::MatrixXd delta2 = euclideanDissimilarityMatrix(inDataMat).array().pow(2);
+        // compute MDS
+        result = classicMds(delta2, outputDimCount);
     }
 
-    // generate dissimilarity Matrix( squared euclidean Distance matrix)
-    Eigen::MatrixXd delta2 = euclideanDissimilarityMatrix(inDataMat).array().pow(2);
-    // compute MDS
-    Eigen::MatrixXd result = classicMds(delta2, outputDimCount);
-
     // generate new columns
     this->columnInfos.clear();
     this->columnInfos.resize(outputDimCount);
@@ -170,6 +194,8 @@ bool megamol::infovis::MDSProjection::dataProjection(megamol::datatools::table::
     this->dataInHash = inCall->DataHash();
     this->datahash++;
     reduceToNSlot.ResetDirty();
+    modeSlot.ResetDirty();
+    landmarkCountSlot.ResetDirty();
 
     return true;
 }
@@ -178,6 +204,7 @@ Eigen::MatrixXd megamol::infovis::MDSProjection::euclideanDissimilarityMatrix(Ei
     // generate euclidean Distance matrix
     int rowsCount = dataMatrix.rows();
     Eigen::MatrixXd distanceMatrix = Eigen::MatrixXd::Zero(rowsCount, rowsCount);
+#pragma omp parallel for schedule(dynamic, 16)
     for (int row = 1; row < rowsCount; row++) {
         for (int col = 0; col < row; col++) {
             double distance = (dataMatrix.row(row) - dataMatrix.row(col)).norm();
@@ -228,6 +255,60 @@ Eigen::MatrixXd megamol::infovis::MDSProjection::classicMds(
     return result;
 }
 
+Eigen::MatrixXd megamol::infovis::MDSProjection::landmarkMds(
+    Eigen::MatrixXd const& dataMatrix, int outputDimension, int landmarkCount) {
+    int rowsCount = dataMatrix.rows();
+    landmarkCount = std::min(landmarkCount, rowsCount);
+
+    // MaxMin selection: each landmark is the row farthest from all previous ones.
+    // The squared distances of all rows to the landmarks are kept for the triangulation.
+    Eigen::MatrixXd delta2(landmarkCount, rowsCount);
+    Eigen::VectorXd minDistance = Eigen::VectorXd::Constant(rowsCount, std::numeric_limits<double>::max());
+    std::vector<int> landmarks(landmarkCount, 0);
+    for (int l = 0; l < landmarkCount; l++) {
+        Eigen::RowVectorXd landmark = dataMatrix.row(landmarks[l]);
+#pragma omp parallel for
+        for (int row = 0; row < rowsCount; row++) {
+            double distance = (dataMatrix.row(row) - landmark).squaredNorm();
+            delta2(l, row) = distance;
+            minDistance(row) = std::min(minDistance(row), distance);
+        }
+        if (l + 1 < landmarkCount) {
+            minDistance.maxCoeff(&landmarks[l + 1]);
+        }
+    }
+
+    // Classic MDS of the landmarks
+    Eigen::MatrixXd landmarkDelta2(landmarkCount, landmarkCount);
+    for (int l = 0; l < landmarkCount; l++) {
+        landmarkDelta2.col(l) = delta2.col(landmarks[l]);
+    }
+    Eigen::VectorXd meanDelta2 = landmarkDelta2.rowwise().mean();
+    Eigen::MatrixXd J = Eigen::MatrixXd::Identity(landmarkCount, landmarkCount) -
+                        (1.0 / (double)landmarkCount) * Eigen::MatrixXd::Ones(landmarkCount, landmarkCount);
+    Eigen::MatrixXd B = -0.5 * J * landmarkDelta2 * J;
+
+    // the matrix is symmetric, eigenvalues come out ascending
+    SelfAdjointEigenSolver<MatrixXd> eigSolver(B);
+    VectorXd eigVal = eigSolver.eigenvalues();
+    MatrixXd eigVec = eigSolver.eigenvectors();
+
+    // Pseudo-inverse transpose of the landmark coordinates, directions without variance are dropped
+    Eigen::MatrixXd pseudoInverse = Eigen::MatrixXd::Zero(outputDimension, landmarkCount);
+    for (int i = 0; i < outputDimension; ++i) {
+        double lambda = eigVal(landmarkCount - 1 - i);
+        if (lambda > std::numeric_limits<double>::epsilon() * std::abs(eigVal(landmarkCount - 1))) {
+            pseudoInverse.row(i) = eigVec.col(landmarkCount - 1 - i).transpose() / sqrt(lambda);
+        }
+    }
+
+    // Triangulation: x = -1/2 L# (delta2 - mean(delta2))
+    delta2.colwise() -= meanDelta2;
+    Eigen::MatrixXd result = (-0.5 * pseudoInverse * delta2).transpose();
+
+    return result;
+}
+
 Eigen::MatrixXd megamol::infovis::MDSProjection::bMatrix(
     Eigen::MatrixXd X, Eigen::MatrixXd W, Eigen::MatrixXd dissimilarityMatrix) {
     assert(X.rows() == W.rows());
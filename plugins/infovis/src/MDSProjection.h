@@ -41,6 +41,13 @@ public:
 
     static Eigen::MatrixXd classicMds(Eigen::MatrixXd squaredDissimilarityMatrix, int outputDimension);
 
+    /**
+     * Landmark MDS (de Silva and Tenenbaum): classic MDS of 'landmarkCount'
+     * MaxMin-selected rows, all rows are placed by distance-based
+     * triangulation against them. Needs O(n * landmarkCount) memory.
+     */
+    static Eigen::MatrixXd landmarkMds(Eigen::MatrixXd const& dataMatrix, int outputDimension, int landmarkCount);
+
     static Eigen::MatrixXd smacofMds(Eigen::MatrixXd squaredDissimilarityMatrix, int outputDimension = 2,
         int countSteps = 100, Eigen::MatrixXd weightsMatrix = Eigen::MatrixXd::Ones(1, 1), double tolerance = 1e-3);
 
@@ -78,6 +85,12 @@ private:
     /** Parameter slot for target number of dimensions */
     ::megamol::core::param::ParamSlot reduceToNSlot;
 
+    /** Parameter slot for the MDS variant */
+    ::megamol::core::param::ParamSlot modeSlot;
+
+    /** Parameter slot for the number of landmarks of landmark MDS */
+    ::megamol::core::param::ParamSlot landmarkCountSlot;
+
     /** ID of the current frame */
     // int frameID; //TODO: unknown
 
@@ -2,10 +2,13 @@
 
 #include "datatools/table/TableDataCall.h"
 #include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/IntParam.h"
 
 #include <Eigen/Dense>
+#include <Eigen/QR>
 #include <Eigen/SVD>
+#include <random>
 #include <sstream>
 
 
@@ -13,6 +16,7 @@ using namespace megamol;
 using namespace megamol::infovis;
 using namespace Eigen;
 
+enum PCAMethod { EXACT_PCA = 0, RANDOMIZED_PCA };
 
 PCAProjection::PCAProjection()
         : megamol::core::Module()
@@ -21,6 +25,8 @@ PCAProjection::PCAProjection()
         , reduceToNSlot("nComponents", "Number of components (dimensions) to keep")
         , scaleSlot("scale", "Set to scale each column to unit variance")
         , centerSlot("center", "Set to shift the mean centroid to the origin")
+        , methodSlot("method", "Randomized PCA scales to many columns, exact PCA solves the covariance matrix")
+        , powerIterationsSlot("powerIterations", "Number of subspace iterations of randomized PCA")
         , datahash(0)
         , dataInHash(0)
         , columnInfos() {
@@ -42,6 +48,15 @@ PCAProjection::PCAProjection()
 
     scaleSlot << new ::megamol::core::param::BoolParam(false);
     this->MakeSlotAvailable(&scaleSlot);
+
+    auto methods = new ::megamol::core::param::EnumParam(EXACT_PCA);
+    methods->SetTypePair(EXACT_PCA, "Exact");
+    methods->SetTypePair(RANDOMIZED_PCA, "Randomized");
+    methodSlot << methods;
+    this->MakeSlotAvailable(&methodSlot);
+
+    powerIterationsSlot << new ::megamol::core::param::IntParam(2, 0);
+    this->MakeSlotAvailable(&powerIterationsSlot);
 }
 
 
@@ -125,7 +140,8 @@ bool megamol::infovis::PCAProjection::project(megamol::datatools::table::TableDa
 
     // check if inData has changed and if Slots have changed
     if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty() && !scaleSlot.IsDirty() && !centerSlot.IsDirty()) {
+        if (!reduceToNSlot.IsDirty() && !scaleSlot.IsDirty() && !centerSlot.IsDirty() && !methodSlot.IsDirty() &&
+            !powerIterationsSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
@@ -148,12 +164,10 @@ bool megamol::infovis::PCAProjection::project(megamol::datatools::table::TableDa
     }
 
     // Load data in a Matrix
-    Eigen::MatrixXd inDataMat = Eigen::MatrixXd(rowsCount, columnCount);
-    for (int row = 0; row < rowsCount; row++) {
-        for (int col = 0; col < columnCount; col++) {
-            inDataMat(row, col) = inData[row * columnCount + col];
-        }
-    }
+    Eigen::MatrixXd inDataMat =
+        Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> const>(
+            inData, rowsCount, columnCount)
+            .cast<double>();
 
     // calculate mean for each column
     Eigen::VectorXd mean_vector(columnCount);
@@ -179,40 +193,46 @@ bool megamol::infovis::PCAProjection::project(megamol::datatools::table::TableDa
     }
 
 
-    // calculate CovarianceMatrix
-    MatrixXd covarianceMatrix = inDataMat;
+    MatrixXd eigVecBasis;
+    if (this->methodSlot.Param<core::param::EnumParam>()->Value() == RANDOMIZED_PCA) {
+        int powerIterations = this->powerIterationsSlot.Param<core::param::IntParam>()->Value();
+        eigVecBasis = randomizedBasis(inDataMat, outputDimCount, powerIterations);
+    } else {
+        // calculate CovarianceMatrix
+        MatrixXd covarianceMatrix = inDataMat;
 
-    /** if center is off: "R ggfortify" doesn't substract mean for the covariance matrix
-    //substract mean for cov Matrix
-    mean_vector = inDataMat.colwise().mean();
-    for (int col = 0; col < columnCount; col++) {
-        covarianceMatrix.col(col) -= Eigen::VectorXd::Constant(rowsCount, mean_vector(col));
-    }*/
+        /** if center is off: "R ggfortify" doesn't substract mean for the covariance matrix
+        //substract mean for cov Matrix
+        mean_vector = inDataMat.colwise().mean();
+        for (int col = 0; col < columnCount; col++) {
+            covarianceMatrix.col(col) -= Eigen::VectorXd::Constant(rowsCount, mean_vector(col));
+        }*/
 
 
-    covarianceMatrix = covarianceMatrix.transpose() * covarianceMatrix;
-    covarianceMatrix = covarianceMatrix / (float)(rowsCount - 1);
+        covarianceMatrix = covarianceMatrix.transpose() * covarianceMatrix;
+        covarianceMatrix = covarianceMatrix / (float)(rowsCount - 1);
 
 
-    // calculate Eigenvalues and Eigenvectors
-    EigenSolver<MatrixXd> eigSolver(covarianceMatrix);
+        // calculate Eigenvalues and Eigenvectors
+        EigenSolver<MatrixXd> eigSolver(covarianceMatrix);
 
-    VectorXd eigVal = eigSolver.eigenvalues().real();
-    MatrixXd eigVec = eigSolver.eigenvectors().real();
+        VectorXd eigVal = eigSolver.eigenvalues().real();
+        MatrixXd eigVec = eigSolver.eigenvectors().real();
 
-    // sort eigenvalues (with index): descending
-    // each eigenvalue represents the variance
-    typedef std::pair<float, int> eigenPair;
-    std::vector<eigenPair> sorted;
-    for (unsigned int i = 0; i < columnCount; ++i) {
-        sorted.push_back(std::make_pair(eigVal(i), i));
-    }
-    std::sort(sorted.begin(), sorted.end(), [&sorted](eigenPair& a, eigenPair& b) { return a.first > b.first; });
+        // sort eigenvalues (with index): descending
+        // each eigenvalue represents the variance
+        typedef std::pair<float, int> eigenPair;
+        std::vector<eigenPair> sorted;
+        for (unsigned int i = 0; i < columnCount; ++i) {
+            sorted.push_back(std::make_pair(eigVal(i), i));
+        }
+        std::sort(sorted.begin(), sorted.end(), [&sorted](eigenPair& a, eigenPair& b) { return a.first > b.first; });
 
-    // create Matrix out of sorted (and selected) eigenvectors
-    MatrixXd eigVecBasis = MatrixXd(columnCount, outputDimCount);
-    for (unsigned int i = 0; i < outputDimCount; ++i) {
-        eigVecBasis.col(i) = eigVec.col(sorted[i].second);
+        // create Matrix out of sorted (and selected) eigenvectors
+        eigVecBasis = MatrixXd(columnCount, outputDimCount);
+        for (unsigned int i = 0; i < outputDimCount; ++i) {
+            eigVecBasis.col(i) = eigVec.col(sorted[i].second);
+        }
     }
 
 
@@ -228,11 +248,6 @@ bool megamol::infovis::PCAProjection::project(megamol::datatools::table::TableDa
     //}
 
 
-    std::stringstream debug;
-    debug << std::endl << result << std::endl;
-
-    megamol::core::utility::log::Log::DefaultLog.WriteInfo(debug.str().c_str());
-
     // generate new columns
     this->columnInfos.clear();
     this->columnInfos.resize(outputDimCount);
@@ -260,6 +275,35 @@ bool megamol::infovis::PCAProjection::project(megamol::datatools::table::TableDa
     reduceToNSlot.ResetDirty();
     scaleSlot.ResetDirty();
     centerSlot.ResetDirty();
+    methodSlot.ResetDirty();
+    powerIterationsSlot.ResetDirty();
 
     return true;
 }
+
+Eigen::MatrixXd megamol::infovis::PCAProjection::randomizedBasis(
+    Eigen::MatrixXd const& A, int k, int powerIterations) {
+    // oversampling improves the accuracy of the trailing components
+    int sketchSize = std::min<int>(k + 10, A.cols());
+
+    std::mt19937 rng(42);
+    std::normal_distribution<double> normal;
+    MatrixXd omega(A.cols(), sketchSize);
+    for (int i = 0; i < omega.size(); ++i) {
+        omega.data()[i] = normal(rng);
+    }
+
+    // orthonormal basis of the range of A, refined by subspace iteration
+    auto orthonormalize = [](MatrixXd const& M) -> MatrixXd {
+        HouseholderQR<MatrixXd> qr(M);
+        return qr.householderQ() * MatrixXd::Identity(M.rows(), M.cols());
+    };
+    MatrixXd Q = orthonormalize(A * omega);
+    for (int i = 0; i < powerIterations; ++i) {
+        Q = orthonormalize(A * orthonormalize(A.transpose() * Q));
+    }
+
+    // the right singular vectors of the small matrix Q^T A are those of A
+    JacobiSVD<MatrixXd> svd(Q.transpose() * A, ComputeThinV);
+    return svd.matrixV().leftCols(k);
+}
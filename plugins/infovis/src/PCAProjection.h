@@ -5,6 +5,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
+#include <Eigen/Dense>
 
 
 namespace megamol::infovis {
@@ -49,6 +50,13 @@ private:
 
     bool project(megamol::datatools::table::TableDataCall* inCall);
 
+    /**
+     * Randomized PCA (Halko et al.): answers the 'k' leading right singular
+     * vectors of 'A' from a Gaussian sketch with 'powerIterations' rounds of
+     * subspace iteration, which avoids forming the covariance matrix.
+     */
+    static Eigen::MatrixXd randomizedBasis(Eigen::MatrixXd const& A, int k, int powerIterations);
+
     /** Data output slot */
     CalleeSlot dataOutSlot;
 
@@ -59,6 +67,8 @@ private:
     ::megamol::core::param::ParamSlot reduceToNSlot;
     ::megamol::core::param::ParamSlot scaleSlot;
     ::megamol::core::param::ParamSlot centerSlot;
+    ::megamol::core::param::ParamSlot methodSlot;
+    ::megamol::core::param::ParamSlot powerIterationsSlot;
 
     /** ID of the current frame */
     // int frameID; //TODO: unknown
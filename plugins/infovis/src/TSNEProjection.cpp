@@ -1,12 +1,13 @@
 #include "TSNEProjection.h"
 
+#include "BarnesHutTSNE.h"
 #include "datatools/table/TableDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 
+#include <ctime>
 #include <sstream>
-#include <tsne.h>
 
 using namespace megamol;
 using namespace megamol::infovis;
@@ -21,9 +22,14 @@ TSNEProjection::TSNEProjection()
               "theta = 0 corresponds to standard, slow t-SNE, while theta = 1 corresponds to very crude approximations")
         , maxIterSlot("maxIter", "Set the maximum Iterations")
         , perplexitySlot("perplexity", "Set the Perplexity")
+        , progressiveSlot("progressive", "Optimize in the background and publish intermediate embeddings")
+        , updateIntervalSlot("updateInterval", "Number of iterations between intermediate embeddings")
         , datahash(0)
         , dataInHash(0)
-        , columnInfos() {
+        , columnInfos()
+        , outputColumnCount(0)
+        , cancelWorker(false)
+        , pendingIteration(-1) {
 
     this->dataInSlot.SetCompatibleCall<megamol::datatools::table::TableDataCallDescription>();
     this->MakeSlotAvailable(&this->dataInSlot);
@@ -48,6 +54,12 @@ TSNEProjection::TSNEProjection()
 
     thetaSlot << new ::megamol::core::param::FloatParam(0.5);
     this->MakeSlotAvailable(&thetaSlot);
+
+    progressiveSlot << new ::megamol::core::param::BoolParam(true);
+    this->MakeSlotAvailable(&progressiveSlot);
+
+    updateIntervalSlot << new ::megamol::core::param::IntParam(25, 1);
+    this->MakeSlotAvailable(&updateIntervalSlot);
 }
 
 TSNEProjection::~TSNEProjection() {
@@ -58,7 +70,9 @@ bool TSNEProjection::create() {
     return true;
 }
 
-void TSNEProjection::release() {}
+void TSNEProjection::release() {
+    this->stopWorker();
+}
 
 bool TSNEProjection::getDataCallback(core::Call& c) {
     try {
@@ -78,6 +92,7 @@ bool TSNEProjection::getDataCallback(core::Call& c) {
         bool finished = project(inCall);
         if (finished == false)
             return false;
+        this->collectResult();
 
         outCall->SetFrameCount(inCall->GetFrameCount());
         outCall->SetDataHash(this->datahash);
@@ -114,8 +129,15 @@ bool TSNEProjection::getHashCallback(core::Call& c) {
         if (!(*inCall)(1))
             return false;
 
+        // An embedding published in the meantime is collected by the next data call.
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(this->resultMutex);
+            pending = this->pendingIteration >= 0;
+        }
+
         outCall->SetFrameCount(inCall->GetFrameCount());
-        outCall->SetDataHash(this->datahash);
+        outCall->SetDataHash(this->datahash + (pending ? 1 : 0));
     } catch (...) {
         megamol::core::utility::log::Log::DefaultLog.WriteError(
             _T("Failed to execute %hs::getHashCallback\n"), ClassName());
@@ -129,13 +151,12 @@ bool megamol::infovis::TSNEProjection::project(megamol::datatools::table::TableD
     // check if inData has changed and if Slots have changed
     if (this->dataInHash == inCall->DataHash()) {
         if (!reduceToNSlot.IsDirty() && !maxIterSlot.IsDirty() && !thetaSlot.IsDirty() && !perplexitySlot.IsDirty() &&
-            !randomSeedSlot.IsDirty()) {
+            !randomSeedSlot.IsDirty() && !progressiveSlot.IsDirty() && !updateIntervalSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
 
     auto columnCount = inCall->GetColumnsCount();
-    auto column_infos = inCall->GetColumnsInfos();
     auto rowsCount = inCall->GetRowsCount();
     auto inData = inCall->GetData();
 
@@ -144,6 +165,8 @@ bool megamol::infovis::TSNEProjection::project(megamol::datatools::table::TableD
     int randomSeed = this->randomSeedSlot.Param<core::param::IntParam>()->Value();
     double theta = this->thetaSlot.Param<core::param::FloatParam>()->Value();
     double perplexity = this->perplexitySlot.Param<core::param::FloatParam>()->Value();
+    bool progressive = this->progressiveSlot.Param<core::param::BoolParam>()->Value();
+    int updateInterval = this->updateIntervalSlot.Param<core::param::IntParam>()->Value();
 
 
     if (outputColumnCount <= 0 || outputColumnCount > columnCount) {
@@ -152,31 +175,108 @@ bool megamol::infovis::TSNEProjection::project(megamol::datatools::table::TableD
         return false;
     }
 
-    // Load data in a double Array
-    double* inputData = (double*)malloc(columnCount * rowsCount * sizeof(double));
-    for (int col = 0; col < columnCount; col++) {
-        for (int row = 0; row < rowsCount; row++) {
-            inputData[row * columnCount + col] = inData[row * columnCount + col];
-            // inputData[col*rowsCount + row] = inData[row * columnCount + col];
+    if (perplexity <= 0.0 || rowsCount < 2 || static_cast<double>(rowsCount - 1) < 3.0 * perplexity) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            _T("%hs: Perplexity too large for the number of rows\n"), ClassName());
+        return false;
+    }
+
+    this->stopWorker();
+
+    BarnesHutTSNE::Parameters params;
+    params.outputDimension = outputColumnCount;
+    params.perplexity = perplexity;
+    params.theta = theta;
+    params.maxIter = maxIter;
+    params.randomSeed = randomSeed < 0 ? static_cast<uint32_t>(std::time(nullptr)) : static_cast<uint32_t>(randomSeed);
+
+    // Intermediate embeddings replace the current output, which is emptied until the first one arrives
+    this->outputColumnCount = outputColumnCount;
+    this->columnInfos.clear();
+    this->data.clear();
+    {
+        std::lock_guard<std::mutex> lock(this->resultMutex);
+        this->pendingResult.clear();
+        this->pendingIteration = -1;
+    }
+
+    this->dataInHash = inCall->DataHash();
+    this->datahash++;
+    reduceToNSlot.ResetDirty();
+    maxIterSlot.ResetDirty();
+    randomSeedSlot.ResetDirty();
+    thetaSlot.ResetDirty();
+    perplexitySlot.ResetDirty();
+    progressiveSlot.ResetDirty();
+    updateIntervalSlot.ResetDirty();
+
+    if (!progressive) {
+        std::vector<double> result;
+        if (!BarnesHutTSNE::Run(inData, rowsCount, columnCount, params, result)) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError(_T("%hs: t-SNE failed\n"), ClassName());
+            return false;
         }
+        this->publishResult(result, maxIter);
+        return true;
     }
 
-    double* result = (double*)malloc(rowsCount * outputColumnCount * sizeof(double));
-    // void run(double* X, int N, int D, double* Y, int no_dims, double perplexity, double theta, int rand_seed,
-    // bool skip_random_init, int max_iter = 1000, int stop_lying_iter = 250, int mom_switch_iter = 250);
-    TSNE::run(inputData, rowsCount, columnCount, result, outputColumnCount, perplexity, theta, randomSeed, false,
-        maxIter, 250, 250);
+    // The table may change once this call returns, so the worker gets its own copy
+    std::vector<float> input(inData, inData + rowsCount * columnCount);
+    this->cancelWorker = false;
+    this->worker = std::thread([this, input = std::move(input), rowsCount, columnCount, params, updateInterval]() {
+        std::vector<double> result;
+        bool finished = BarnesHutTSNE::Run(input.data(), rowsCount, columnCount, params, result,
+            [this, &params, updateInterval](int iter, std::vector<double> const& Y) {
+                if (this->cancelWorker) {
+                    return false;
+                }
+                if ((iter + 1) % updateInterval == 0 && iter + 1 < params.maxIter) {
+                    this->publishResult(Y, iter + 1);
+                }
+                return true;
+            });
+        if (finished) {
+            this->publishResult(result, params.maxIter);
+        } else if (!this->cancelWorker) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError(_T("%hs: t-SNE failed\n"), ClassName());
+        }
+    });
+
+    return true;
+}
 
-    double* maximas = new double[outputColumnCount];
-    double* minimas = new double[outputColumnCount];
+void megamol::infovis::TSNEProjection::stopWorker() {
+    if (this->worker.joinable()) {
+        this->cancelWorker = true;
+        this->worker.join();
+    }
+}
+
+void megamol::infovis::TSNEProjection::publishResult(std::vector<double> const& result, int iteration) {
+    std::lock_guard<std::mutex> lock(this->resultMutex);
+    this->pendingResult = result;
+    this->pendingIteration = iteration;
+}
 
-    for (int col = 0; col < outputColumnCount; col++) {
-        maximas[col] = result[col];
-        minimas[col] = result[col];
+void megamol::infovis::TSNEProjection::collectResult() {
+    std::vector<double> result;
+    {
+        std::lock_guard<std::mutex> lock(this->resultMutex);
+        if (this->pendingIteration < 0) {
+            return;
+        }
+        result.swap(this->pendingResult);
+        this->pendingIteration = -1;
     }
 
-    for (int col = 0; col < outputColumnCount; col++) {
-        for (int row = 1; row < rowsCount; row++) {
+    size_t const outputColumnCount = this->outputColumnCount;
+    size_t const rowsCount = result.size() / outputColumnCount;
+
+    std::vector<double> maximas(result.begin(), result.begin() + outputColumnCount);
+    std::vector<double> minimas(result.begin(), result.begin() + outputColumnCount);
+
+    for (size_t row = 1; row < rowsCount; row++) {
+        for (size_t col = 0; col < outputColumnCount; col++) {
             double value = result[row * outputColumnCount + col];
             if (maximas[col] < value)
                 maximas[col] = value;
@@ -185,16 +285,11 @@ bool megamol::infovis::TSNEProjection::project(megamol::datatools::table::TableD
         }
     }
 
-
-    // std::stringstream debug;
-    // debug << std::endl << result << std::endl;
-    // megamol::core::utility::log::Log::DefaultLog.WriteInfo(debug.str().c_str());
-
     // generate new columns
     this->columnInfos.clear();
     this->columnInfos.resize(outputColumnCount);
 
-    for (int indexX = 0; indexX < outputColumnCount; indexX++) {
+    for (size_t indexX = 0; indexX < outputColumnCount; indexX++) {
         this->columnInfos[indexX]
             .SetName("TSNE" + std::to_string(indexX))
             .SetType(megamol::datatools::table::TableDataCall::ColumnType::QUANTITATIVE)
@@ -203,30 +298,7 @@ bool megamol::infovis::TSNEProjection::project(megamol::datatools::table::TableD
     }
 
     // Result Matrix into Output
-    this->data.clear();
-    this->data.reserve(rowsCount * outputColumnCount);
+    this->data.assign(result.begin(), result.end());
 
-
-    for (size_t row = 0; row < rowsCount; row++) {
-        for (size_t col = 0; col < outputColumnCount; col++)
-            this->data.push_back(result[row * outputColumnCount + col]);
-    }
-
-
-    this->dataInHash = inCall->DataHash();
     this->datahash++;
-    reduceToNSlot.ResetDirty();
-    maxIterSlot.ResetDirty();
-    randomSeedSlot.ResetDirty();
-    thetaSlot.ResetDirty();
-    perplexitySlot.ResetDirty();
-
-    free(result);
-    result = NULL;
-    free(inputData);
-    inputData = NULL;
-    delete[] maximas;
-    delete[] minimas;
-
-    return true;
 }
@@ -6,6 +6,10 @@
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 
 namespace megamol::infovis {
 
@@ -21,7 +25,7 @@ public:
     /** Return module class description */
     static inline const char* Description() {
         return "t-Distributed Stochastic Neighbor Embedding (t-SNE), i.e., a nonlinear dimensionality reduction "
-               "technique";
+               "technique, computed with multi-threaded Barnes-Hut t-SNE";
     }
 
     /** Module is always available */
@@ -50,6 +54,15 @@ private:
 
     bool project(megamol::datatools::table::TableDataCall* inCall);
 
+    /** Stops the background optimization, if any. */
+    void stopWorker();
+
+    /** Moves the latest embedding published by the optimization into the output. */
+    void collectResult();
+
+    /** Hands an embedding over to collectResult. */
+    void publishResult(std::vector<double> const& result, int iteration);
+
     /** Data output slot */
     CalleeSlot dataOutSlot;
 
@@ -62,6 +75,8 @@ private:
     ::megamol::core::param::ParamSlot thetaSlot;
     ::megamol::core::param::ParamSlot perplexitySlot;
     ::megamol::core::param::ParamSlot maxIterSlot;
+    ::megamol::core::param::ParamSlot progressiveSlot;
+    ::megamol::core::param::ParamSlot updateIntervalSlot;
 
     /** ID of the current frame */
     // int frameID; //TODO: unknown
@@ -75,6 +90,24 @@ private:
 
     /** Vector stroing the actual float data */
     std::vector<float> data;
+
+    /** Number of components of the current optimization */
+    unsigned int outputColumnCount;
+
+    /** Thread running the optimization if the projection is progressive */
+    std::thread worker;
+
+    /** Asks the worker to stop */
+    std::atomic<bool> cancelWorker;
+
+    /** Guards the published embedding */
+    std::mutex resultMutex;
+
+    /** Embedding published by the optimization, but not yet collected */
+    std::vector<double> pendingResult;
+
+    /** Iteration of the pending embedding, or -1 if there is none */
+    int pendingIteration;
 };
 
 } // namespace megamol::infovis
@@ -1,14 +1,175 @@
 #include "WavefrontObjLoader.h"
 
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/utility/log/Log.h"
+
+#include "tiny_obj_loader.h"
+
+namespace {
+
+/** Identifies a mesh cache file */
+constexpr char cacheMagic[8] = {'M', 'M', 'O', 'B', 'J', 'C', 'A', 'C'};
+
+/** Increment whenever the parsing, welding or the layout of the cache changes */
+constexpr uint32_t cacheVersion = 1;
+
+/** The sections of the cache are aligned to this many bytes */
+constexpr uint64_t cacheAlignment = 16;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t mesh_cnt;
+    uint64_t key;
+    float bbox[6];
+};
+
+/** Followed by the name, padded to 8 bytes. The data starts at 'data_offset' of the file. */
+struct CacheMesh {
+    uint32_t name_length;
+    uint32_t lines;
+    uint32_t has_normals;
+    uint32_t has_texcoords;
+    uint64_t vertex_cnt;
+    uint64_t index_cnt;
+    uint64_t data_offset;
+};
+
+static_assert(sizeof(CacheHeader) == 48, "The cache header must not be padded");
+static_assert(sizeof(CacheMesh) == 40, "The cache mesh record must not be padded");
+
+inline uint64_t alignUp(uint64_t size, uint64_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/** Answer the size of the data sections of 'mesh' in the cache */
+inline uint64_t cacheDataSize(const CacheMesh& mesh) {
+    uint64_t size = alignUp(12 * mesh.vertex_cnt, cacheAlignment);
+    size += mesh.has_normals ? alignUp(12 * mesh.vertex_cnt, cacheAlignment) : 0;
+    size += mesh.has_texcoords ? alignUp(8 * mesh.vertex_cnt, cacheAlignment) : 0;
+    size += alignUp(4 * mesh.index_cnt, cacheAlignment);
+    return size;
+}
+
+/** Folds the eight bytes of 'value' into the FNV-1a hash 'hash'. */
+inline uint64_t fold(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/** Folds the characters of 'str' into the FNV-1a hash 'hash'. */
+inline uint64_t fold(uint64_t hash, const std::string& str) {
+    hash = fold(hash, static_cast<uint64_t>(str.size()));
+    for (char c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Loads 'filename' with tinyobjloader, which is slower but more lenient than
+ * the own parser.
+ */
+bool loadTinyObj(const std::filesystem::path& filename, megamol::mesh::obj::ObjData& data) {
+    using megamol::core::utility::log::Log;
+    using megamol::mesh::obj::Corner;
+
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn;
+    std::string err;
+
+    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.generic_u8string().c_str());
+
+    if (!warn.empty()) {
+        Log::DefaultLog.WriteWarn("%s", warn.c_str());
+    }
+
+    if (!err.empty()) {
+        Log::DefaultLog.WriteError("%s", err.c_str());
+    }
+
+    if (!ret) {
+        return false;
+    }
+
+    data = megamol::mesh::obj::ObjData();
+    data.positions.assign(attrib.vertices.begin(), attrib.vertices.end());
+    data.normals.assign(attrib.normals.begin(), attrib.normals.end());
+    data.texcoords.assign(attrib.texcoords.begin(), attrib.texcoords.end());
+
+    const auto corner = [](const tinyobj::index_t& idx) {
+        return Corner{idx.vertex_index, idx.texcoord_index, idx.normal_index};
+    };
+
+    // shapes of the same name are merged like the own parser does
+    std::unordered_map<std::string, size_t> shape_index;
+    for (auto const& shape : shapes) {
+        std::vector<Corner> triangles;
+        size_t index_offset = 0;
+        for (auto const fv : shape.mesh.num_face_vertices) {
+            for (size_t v = 2; v < fv; ++v) {
+                triangles.push_back(corner(shape.mesh.indices[index_offset]));
+                triangles.push_back(corner(shape.mesh.indices[index_offset + v - 1]));
+                triangles.push_back(corner(shape.mesh.indices[index_offset + v]));
+            }
+            index_offset += fv;
+        }
+
+        std::vector<Corner> lines;
+        index_offset = 0;
+        for (auto const lv : shape.lines.num_line_vertices) {
+            for (size_t v = 1; v < lv; ++v) {
+                lines.push_back(corner(shape.lines.indices[index_offset + v - 1]));
+                lines.push_back(corner(shape.lines.indices[index_offset + v]));
+            }
+            index_offset += lv;
+        }
+
+        if (triangles.empty() && lines.empty()) {
+            continue;
+        }
+        auto const query = shape_index.emplace(shape.name, data.shapes.size());
+        if (query.second) {
+            data.shapes.emplace_back();
+            data.shapes.back().name = shape.name;
+        }
+        auto& target = data.shapes[query.first->second];
+        if (!triangles.empty()) {
+            target.triangles.push_back(std::move(triangles));
+        }
+        if (!lines.empty()) {
+            target.lines.push_back(std::move(lines));
+        }
+    }
+
+    return true;
+}
+
+} // namespace
 
 megamol::mesh::WavefrontObjLoader::WavefrontObjLoader()
         : AbstractMeshDataSource()
         , m_version(0)
         , m_meta_data()
-        , m_filename_slot("Wavefront OBJ filename", "The name of the obj file to load") {
+        , m_filename_slot("Wavefront OBJ filename", "The name of the obj file to load")
+        , m_use_cache_slot("useCache", "Reads and writes a binary cache (<filename>.mmobj) of the welded meshes") {
     this->m_filename_slot << new core::param::FilePathParam("");
     this->MakeSlotAvailable(&this->m_filename_slot);
+
+    this->m_use_cache_slot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->m_use_cache_slot);
 }
 
 megamol::mesh::WavefrontObjLoader::~WavefrontObjLoader() {}
@@ -44,36 +205,12 @@ bool megamol::mesh::WavefrontObjLoader::getMeshDataCallback(core::Call& caller)
 
         ++m_version;
 
-        auto vislib_filename = m_filename_slot.Param<core::param::FilePathParam>()->Value();
-        std::string filename(vislib_filename.generic_u8string());
-
-        m_obj_model = std::make_shared<TinyObjModel>();
+        auto filename = m_filename_slot.Param<core::param::FilePathParam>()->Value();
 
-        std::string warn;
-        std::string err;
-
-        bool ret = tinyobj::LoadObj(
-            &m_obj_model->attrib, &m_obj_model->shapes, &m_obj_model->materials, &warn, &err, filename.c_str());
-
-        if (!warn.empty()) {
-            std::cout << warn << std::endl;
-        }
-
-        if (!err.empty()) {
-            std::cerr << err << std::endl;
-        }
-
-        if (!ret) {
-            return false;
-        }
-
-        const bool has_normals = !m_obj_model->attrib.normals.empty();
-        const bool has_texcoords = !m_obj_model->attrib.texcoords.empty();
-
-        // size_t vertex_cnt = m_obj_model->shapes.size() * 3;
-        this->m_positions.clear();
-        this->m_normals.clear();
-        this->m_texcoords.clear();
+        // the mesh accesses point into the buffers released here
+        clearMeshAccessCollection();
+        m_meshes.clear();
+        m_cache = obj::MappedFile();
 
         std::array<float, 6> bbox;
         bbox[0] = std::numeric_limits<float>::max();
@@ -83,153 +220,18 @@ bool megamol::mesh::WavefrontObjLoader::getMeshDataCallback(core::Call& caller)
         bbox[4] = -std::numeric_limits<float>::max();
         bbox[5] = -std::numeric_limits<float>::max();
 
-        m_indices.resize(m_obj_model->shapes.size());
-        m_positions.resize(m_obj_model->shapes.size());
-        if (has_normals) {
-            this->m_normals.resize(m_obj_model->shapes.size());
-        }
-        if (has_texcoords) {
-            this->m_texcoords.resize(m_obj_model->shapes.size());
-        }
-
-        // Loop over shapes
-        for (size_t s = 0; s < m_obj_model->shapes.size(); s++) {
-            auto& mesh = m_obj_model->shapes[s].mesh;
-            auto& lines = m_obj_model->shapes[s].lines;
-
-            uint64_t vertex_cnt = 0;
-            if (!mesh.indices.empty()) {
-                // Loop over faces(polygon)
-                size_t index_offset = 0;
-
-                m_indices[s].resize(mesh.num_face_vertices.size() * 3);
-                m_positions[s].reserve(mesh.num_face_vertices.size() * 3 * 3);
-                if (has_normals) {
-                    this->m_normals[s].reserve(mesh.num_face_vertices.size() * 3 * 3);
-                }
-                if (has_texcoords) {
-                    this->m_texcoords[s].reserve(mesh.num_face_vertices.size() * 3 * 2);
-                }
-
-                for (size_t f = 0; f < mesh.num_face_vertices.size(); f++) {
-                    int fv = mesh.num_face_vertices[f];
-
-                    assert(fv == 3); // assume that triangulation was forced
-
-                    // Loop over vertices in the face.
-                    for (size_t v = 0; v < fv; v++) {
-                        // access to vertex
-                        tinyobj::index_t idx = mesh.indices[index_offset + v];
-                        tinyobj::real_t vx = m_obj_model->attrib.vertices[3 * idx.vertex_index + 0];
-                        tinyobj::real_t vy = m_obj_model->attrib.vertices[3 * idx.vertex_index + 1];
-                        tinyobj::real_t vz = m_obj_model->attrib.vertices[3 * idx.vertex_index + 2];
-
-                        bbox[0] = std::min(bbox[0], static_cast<float>(vx));
-                        bbox[1] = std::min(bbox[1], static_cast<float>(vy));
-                        bbox[2] = std::min(bbox[2], static_cast<float>(vz));
-                        bbox[3] = std::max(bbox[3], static_cast<float>(vx));
-                        bbox[4] = std::max(bbox[4], static_cast<float>(vy));
-                        bbox[5] = std::max(bbox[5], static_cast<float>(vz));
-
-                        m_indices[s][index_offset + v] = index_offset + v;
-
-                        auto current_position_ptr = &(m_obj_model->attrib.vertices[3 * idx.vertex_index]);
-                        m_positions[s].insert(m_positions[s].end(), current_position_ptr, current_position_ptr + 3);
-
-                        if (has_normals && idx.normal_index >= 0) {
-                            auto current_normal_ptr = &(m_obj_model->attrib.normals[3 * idx.normal_index]);
-                            m_normals[s].insert(m_normals[s].end(), current_normal_ptr, current_normal_ptr + 3);
-                        }
-
-                        if (has_texcoords && idx.texcoord_index >= 0) {
-                            auto current_texcoords_ptr = &(m_obj_model->attrib.texcoords[2 * idx.texcoord_index]);
-                            m_texcoords[s].insert(
-                                m_texcoords[s].end(), current_texcoords_ptr, current_texcoords_ptr + 2);
-                        }
-                    }
-                    index_offset += fv;
-                    // per-face material
-                    // m_obj_model->shapes[s].mesh.material_ids[f];
-                }
-
-                vertex_cnt = mesh.num_face_vertices.size() * 3;
-
-            } else {
-                // Loop over line
-                size_t index_offset = 0;
-
-                m_indices[s].resize(lines.num_line_vertices.size() * 2);
-                m_positions[s].reserve(lines.num_line_vertices.size() * 3);
-
-                for (size_t f = 0; f < lines.num_line_vertices.size(); f++) {
-                    // access to vertex
-                    tinyobj::index_t idx = lines.indices[index_offset];
-                    tinyobj::real_t vx = m_obj_model->attrib.vertices[3 * idx.vertex_index + 0];
-                    tinyobj::real_t vy = m_obj_model->attrib.vertices[3 * idx.vertex_index + 1];
-                    tinyobj::real_t vz = m_obj_model->attrib.vertices[3 * idx.vertex_index + 2];
-
-                    bbox[0] = std::min(bbox[0], static_cast<float>(vx));
-                    bbox[1] = std::min(bbox[1], static_cast<float>(vy));
-                    bbox[2] = std::min(bbox[2], static_cast<float>(vz));
-                    bbox[3] = std::max(bbox[3], static_cast<float>(vx));
-                    bbox[4] = std::max(bbox[4], static_cast<float>(vy));
-                    bbox[5] = std::max(bbox[5], static_cast<float>(vz));
-
-                    auto current_position_ptr = &(m_obj_model->attrib.vertices[3 * idx.vertex_index]);
-                    m_positions[s].insert(m_positions[s].end(), current_position_ptr, current_position_ptr + 3);
-
-                    // Loop over line segments
-                    int fv = lines.num_line_vertices[f];
-                    for (size_t v = 0; v < fv; v++) {
-                        m_indices[s][index_offset + v] = lines.indices[index_offset + v].vertex_index;
-                    }
-                    index_offset += fv;
-                    // per-face material
-                    // m_obj_model->shapes[s].mesh.material_ids[f];
-                }
-
-                vertex_cnt = lines.num_line_vertices.size();
-            }
-
-            const auto pos_ptr = m_positions[s].data();
-            std::vector<MeshDataAccessCollection::VertexAttribute> mesh_attributes;
+        const bool use_cache = m_use_cache_slot.Param<core::param::BoolParam>()->Value();
+        const uint64_t key = use_cache ? cacheKey(filename) : 0;
+        auto cache_path = filename;
+        cache_path += ".mmobj";
 
-            mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{reinterpret_cast<uint8_t*>(pos_ptr),
-                3 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 3,
-                MeshDataAccessCollection::FLOAT, 12, 0, MeshDataAccessCollection::AttributeSemanticType::POSITION});
-
-            if (has_normals) {
-                const auto normal_ptr = m_normals[s].data();
-
-                mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{
-                    reinterpret_cast<uint8_t*>(normal_ptr),
-                    3 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 3,
-                    MeshDataAccessCollection::FLOAT, 12, 0, MeshDataAccessCollection::AttributeSemanticType::NORMAL});
-            }
-
-            if (has_texcoords) {
-                const auto texcoord_ptr = m_texcoords[s].data();
-                mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{
-                    reinterpret_cast<uint8_t*>(texcoord_ptr),
-                    2 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 2,
-                    MeshDataAccessCollection::FLOAT, 8, 0, MeshDataAccessCollection::AttributeSemanticType::TEXCOORD});
+        if ((key == 0) || !loadCache(cache_path, key, bbox)) {
+            if (!loadObj(filename, bbox)) {
+                return false;
             }
-
-            MeshDataAccessCollection::IndexData mesh_indices;
-            mesh_indices.data = reinterpret_cast<uint8_t*>(m_indices[s].data());
-            mesh_indices.byte_size =
-                m_indices[s].size() * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::UNSIGNED_INT);
-            mesh_indices.type = MeshDataAccessCollection::UNSIGNED_INT;
-
-            // TODO add file name?
-            std::string identifier = m_obj_model->shapes[s].name;
-            if (!mesh.indices.empty()) {
-                m_mesh_access_collection.first->addMesh(
-                    identifier, mesh_attributes, mesh_indices, MeshDataAccessCollection::PrimitiveType::TRIANGLES);
-            } else {
-                m_mesh_access_collection.first->addMesh(identifier, mesh_attributes, mesh_indices);
+            if (key != 0) {
+                saveCache(cache_path, key, bbox);
             }
-            m_mesh_access_collection.second.push_back(identifier);
         }
 
         m_meta_data.m_bboxs.SetBoundingBox(bbox[0], bbox[1], bbox[2], bbox[3], bbox[4], bbox[5]);
@@ -253,3 +255,243 @@ bool megamol::mesh::WavefrontObjLoader::getMeshMetaDataCallback(core::Call& call
 }
 
 void megamol::mesh::WavefrontObjLoader::release() {}
+
+bool megamol::mesh::WavefrontObjLoader::loadObj(const std::filesystem::path& filename, std::array<float, 6>& bbox) {
+    using megamol::core::utility::log::Log;
+
+    obj::ObjData data;
+    std::string error;
+
+    auto const file = obj::MapFile(filename);
+    if ((file.data == nullptr) || !obj::Parse(file.data.get(), file.data.get() + file.size, data, error)) {
+        if (!error.empty()) {
+            Log::DefaultLog.WriteWarn("%hs: %s in %s, retrying with tinyobjloader", ClassName(), error.c_str(),
+                filename.generic_u8string().c_str());
+        }
+        if (!loadTinyObj(filename, data)) {
+            return false;
+        }
+    }
+
+    // the shapes are welded independently of each other
+    const auto shape_cnt = static_cast<long long>(data.shapes.size());
+    std::vector<std::string> errors(data.shapes.size());
+    m_meshes.resize(data.shapes.size());
+#pragma omp parallel for schedule(dynamic)
+    for (long long s = 0; s < shape_cnt; ++s) {
+        obj::Weld(data, data.shapes[s], m_meshes[s], errors[s]);
+    }
+    for (auto const& e : errors) {
+        if (!e.empty()) {
+            Log::DefaultLog.WriteError("%hs: %s in %s", ClassName(), e.c_str(), filename.generic_u8string().c_str());
+            m_meshes.clear();
+            return false;
+        }
+    }
+    data = obj::ObjData();
+
+    for (auto& mesh : m_meshes) {
+        for (size_t i = 0; i < mesh.positions.size(); i += 3) {
+            for (size_t c = 0; c < 3; ++c) {
+                bbox[c] = std::min(bbox[c], mesh.positions[i + c]);
+                bbox[c + 3] = std::max(bbox[c + 3], mesh.positions[i + c]);
+            }
+        }
+        addMesh(mesh.name, mesh.lines, mesh.positions.size() / 3, mesh.positions.data(),
+            mesh.normals.empty() ? nullptr : mesh.normals.data(),
+            mesh.texcoords.empty() ? nullptr : mesh.texcoords.data(), mesh.indices.size(), mesh.indices.data());
+    }
+
+    return true;
+}
+
+uint64_t megamol::mesh::WavefrontObjLoader::cacheKey(const std::filesystem::path& filename) const {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filename, ec);
+    if (ec) {
+        return 0;
+    }
+    const auto time = std::filesystem::last_write_time(filename, ec);
+    if (ec) {
+        return 0;
+    }
+
+    uint64_t key = 14695981039346656037ull;
+    key = fold(key, std::filesystem::absolute(filename, ec).generic_u8string());
+    key = fold(key, static_cast<uint64_t>(size));
+    key = fold(key, static_cast<uint64_t>(time.time_since_epoch().count()));
+    return key;
+}
+
+bool megamol::mesh::WavefrontObjLoader::loadCache(
+    const std::filesystem::path& path, uint64_t key, std::array<float, 6>& bbox) {
+    using megamol::core::utility::log::Log;
+
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+    auto file = obj::MapFile(path);
+    CacheHeader header = {};
+    if (file.size >= sizeof(header)) {
+        std::memcpy(&header, file.data.get(), sizeof(header));
+    }
+    if ((std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0) || (header.version != cacheVersion) ||
+        (header.key != key)) {
+        Log::DefaultLog.WriteWarn("%hs: ignoring outdated mesh cache %s", ClassName(), path.generic_u8string().c_str());
+        return false;
+    }
+
+    // check the whole table before adding any mesh
+    std::vector<std::pair<std::string, CacheMesh>> meshes;
+    uint64_t offset = sizeof(header);
+    for (uint32_t m = 0; m < header.mesh_cnt; ++m) {
+        CacheMesh record;
+        if (offset + sizeof(record) > file.size) {
+            break;
+        }
+        std::memcpy(&record, file.data.get() + offset, sizeof(record));
+        offset += sizeof(record);
+        if ((record.name_length > file.size - offset) || (record.vertex_cnt > file.size) ||
+            (record.index_cnt > file.size) || (record.data_offset % cacheAlignment != 0) ||
+            (record.data_offset > file.size) || (cacheDataSize(record) > file.size - record.data_offset)) {
+            break;
+        }
+        meshes.emplace_back(std::string(file.data.get() + offset, record.name_length), record);
+        offset += alignUp(record.name_length, 8);
+    }
+    if (meshes.size() != header.mesh_cnt) {
+        Log::DefaultLog.WriteWarn("%hs: mesh cache %s is truncated", ClassName(), path.generic_u8string().c_str());
+        return false;
+    }
+
+    // the meshes reference the mapping directly
+    for (auto& [name, record] : meshes) {
+        char* data = file.data.get() + record.data_offset;
+        auto* positions = reinterpret_cast<float*>(data);
+        data += alignUp(12 * record.vertex_cnt, cacheAlignment);
+        float* normals = nullptr;
+        if (record.has_normals) {
+            normals = reinterpret_cast<float*>(data);
+            data += alignUp(12 * record.vertex_cnt, cacheAlignment);
+        }
+        float* texcoords = nullptr;
+        if (record.has_texcoords) {
+            texcoords = reinterpret_cast<float*>(data);
+            data += alignUp(8 * record.vertex_cnt, cacheAlignment);
+        }
+        auto* indices = reinterpret_cast<uint32_t*>(data);
+        addMesh(name, record.lines != 0, record.vertex_cnt, positions, normals, texcoords, record.index_cnt, indices);
+    }
+
+    std::copy_n(header.bbox, 6, bbox.begin());
+    m_cache = std::move(file);
+    return true;
+}
+
+bool megamol::mesh::WavefrontObjLoader::saveCache(
+    const std::filesystem::path& path, uint64_t key, const std::array<float, 6>& bbox) const {
+    using megamol::core::utility::log::Log;
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.mesh_cnt = static_cast<uint32_t>(m_meshes.size());
+    header.key = key;
+    std::copy_n(bbox.begin(), 6, header.bbox);
+
+    // the data follows the table of all meshes
+    std::vector<CacheMesh> records(m_meshes.size());
+    uint64_t offset = sizeof(header);
+    for (auto const& mesh : m_meshes) {
+        offset += sizeof(CacheMesh) + alignUp(mesh.name.size(), 8);
+    }
+    offset = alignUp(offset, cacheAlignment);
+    for (size_t m = 0; m < m_meshes.size(); ++m) {
+        auto const& mesh = m_meshes[m];
+        auto& record = records[m];
+        record.name_length = static_cast<uint32_t>(mesh.name.size());
+        record.lines = mesh.lines ? 1 : 0;
+        record.has_normals = mesh.normals.empty() ? 0 : 1;
+        record.has_texcoords = mesh.texcoords.empty() ? 0 : 1;
+        record.vertex_cnt = mesh.positions.size() / 3;
+        record.index_cnt = mesh.indices.size();
+        record.data_offset = offset;
+        offset += cacheDataSize(record);
+    }
+
+    const char padding[cacheAlignment] = {};
+    const auto write_padded = [&padding](std::ofstream& file, const void* data, uint64_t size, uint64_t alignment) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        file.write(padding, static_cast<std::streamsize>(alignUp(size, alignment) - size));
+    };
+
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        uint64_t written = sizeof(header);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (size_t m = 0; m < m_meshes.size(); ++m) {
+            file.write(reinterpret_cast<const char*>(&records[m]), sizeof(CacheMesh));
+            write_padded(file, m_meshes[m].name.data(), m_meshes[m].name.size(), 8);
+            written += sizeof(CacheMesh) + alignUp(m_meshes[m].name.size(), 8);
+        }
+        file.write(padding, static_cast<std::streamsize>(alignUp(written, cacheAlignment) - written));
+        for (auto const& mesh : m_meshes) {
+            write_padded(file, mesh.positions.data(), 4 * mesh.positions.size(), cacheAlignment);
+            if (!mesh.normals.empty()) {
+                write_padded(file, mesh.normals.data(), 4 * mesh.normals.size(), cacheAlignment);
+            }
+            if (!mesh.texcoords.empty()) {
+                write_padded(file, mesh.texcoords.data(), 4 * mesh.texcoords.size(), cacheAlignment);
+            }
+            write_padded(file, mesh.indices.data(), 4 * mesh.indices.size(), cacheAlignment);
+        }
+        if (!file) {
+            Log::DefaultLog.WriteWarn(
+                "%hs: could not write mesh cache %s", ClassName(), tmp_path.generic_u8string().c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        Log::DefaultLog.WriteWarn("%hs: could not write mesh cache %s: %s", ClassName(),
+            path.generic_u8string().c_str(), ec.message().c_str());
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+void megamol::mesh::WavefrontObjLoader::addMesh(std::string const& identifier, bool lines, size_t vertex_cnt,
+    float* positions, float* normals, float* texcoords, size_t index_cnt, uint32_t* indices) {
+    std::vector<MeshDataAccessCollection::VertexAttribute> mesh_attributes;
+
+    mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{reinterpret_cast<uint8_t*>(positions),
+        3 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 3,
+        MeshDataAccessCollection::FLOAT, 12, 0, MeshDataAccessCollection::AttributeSemanticType::POSITION});
+
+    if (normals != nullptr) {
+        mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{reinterpret_cast<uint8_t*>(normals),
+            3 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 3,
+            MeshDataAccessCollection::FLOAT, 12, 0, MeshDataAccessCollection::AttributeSemanticType::NORMAL});
+    }
+
+    if (texcoords != nullptr) {
+        mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{reinterpret_cast<uint8_t*>(texcoords),
+            2 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 2,
+            MeshDataAccessCollection::FLOAT, 8, 0, MeshDataAccessCollection::AttributeSemanticType::TEXCOORD});
+    }
+
+    MeshDataAccessCollection::IndexData mesh_indices;
+    mesh_indices.data = reinterpret_cast<uint8_t*>(indices);
+    mesh_indices.byte_size = index_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::UNSIGNED_INT);
+    mesh_indices.type = MeshDataAccessCollection::UNSIGNED_INT;
+
+    // TODO add file name?
+    m_mesh_access_collection.first->addMesh(identifier, mesh_attributes, mesh_indices,
+        lines ? MeshDataAccessCollection::PrimitiveType::LINES : MeshDataAccessCollection::PrimitiveType::TRIANGLES);
+    m_mesh_access_collection.second.push_back(identifier);
+}
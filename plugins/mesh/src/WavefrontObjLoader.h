@@ -14,7 +14,10 @@
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
 
-#include "tiny_obj_loader.h"
+#include "WavefrontObjParser.h"
+
+#include <array>
+#include <filesystem>
 
 namespace megamol::mesh {
 
@@ -75,38 +78,56 @@ protected:
     void release() override;
 
 private:
-    struct TinyObjModel {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-    };
+    /**
+     * Parses the obj file 'filename' and welds its shapes into indexed meshes.
+     *
+     * @param bbox Receives the bounding box of the meshes.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool loadObj(const std::filesystem::path& filename, std::array<float, 6>& bbox);
 
-    uint32_t m_version;
+    /**
+     * Answer the key identifying the obj file 'filename' in its mesh cache,
+     * which is 0 if the file cannot be accessed.
+     */
+    uint64_t cacheKey(const std::filesystem::path& filename) const;
 
     /**
-     * Representation of obj model as loaded by tinyobjloader
+     * Maps the mesh cache 'path' into memory and adds its meshes.
+     *
+     * @param key The expected key of the cache
+     * @param bbox Receives the bounding box of the meshes.
+     *
+     * @return 'true' on success, 'false' if the cache is missing or outdated
      */
-    std::shared_ptr<TinyObjModel> m_obj_model;
+    bool loadCache(const std::filesystem::path& path, uint64_t key, std::array<float, 6>& bbox);
 
     /**
-     * Internal storage for unpacked positions, i.e one position per vertex, three vertices per triangle
+     * Writes the welded meshes to the mesh cache 'path'.
+     *
+     * @return 'true' on success, 'false' otherwise
      */
-    std::vector<std::vector<float>> m_positions;
+    bool saveCache(const std::filesystem::path& path, uint64_t key, const std::array<float, 6>& bbox) const;
 
     /**
-     * Internal storage for unpacked normals, i.e one normal per vertex, three vertices per triangle
+     * Adds a mesh referencing the given buffers to the mesh access collection.
+     * 'normals' and 'texcoords' may be nullptr.
      */
-    std::vector<std::vector<float>> m_normals;
+    void addMesh(std::string const& identifier, bool lines, size_t vertex_cnt, float* positions, float* normals,
+        float* texcoords, size_t index_cnt, uint32_t* indices);
+
+    uint32_t m_version;
 
     /**
-     * Internal storage for unpacked texcoords, i.e one texcoord per vertex, three vertices per triangle
+     * The welded meshes, i.e. one vertex per distinct corner, unless they are taken from the cache
      */
-    std::vector<std::vector<float>> m_texcoords;
+    std::vector<obj::IndexedMesh> m_meshes;
 
     /**
-     *
+     * The mapped mesh cache the mesh accesses point into, if it was used
      */
-    std::vector<std::vector<unsigned int>> m_indices;
+    obj::MappedFile m_cache;
 
     /**
      * Meta data for communicating data updates, as well as data size
@@ -115,6 +136,9 @@ private:
 
     /** The gltf file name */
     core::param::ParamSlot m_filename_slot;
+
+    /** Whether to keep the welded meshes in a binary file next to the obj file */
+    core::param::ParamSlot m_use_cache_slot;
 };
 
 } // namespace megamol::mesh
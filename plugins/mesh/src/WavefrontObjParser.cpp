@@ -0,0 +1,613 @@
+/*
+ * WavefrontObjParser.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "WavefrontObjParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace megamol::mesh::obj {
+
+namespace {
+
+/** Marks a vertex slot that is not used yet */
+constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+/**
+ * Maps corners to vertices by open addressing, which is several times faster
+ * than std::unordered_map for the millions of corners of scanned meshes.
+ */
+class CornerMap {
+public:
+    explicit CornerMap(size_t expected) {
+        size_t capacity = 16;
+        while (capacity < 2 * expected)
+            capacity *= 2;
+        slots.resize(capacity, Slot{Corner{-1, -1, -1}, NO_VERTEX});
+    }
+
+    /**
+     * Answer the vertex of 'c', which is set to 'vertex' if 'c' is new.
+     */
+    uint32_t findOrInsert(const Corner& c, uint32_t vertex) {
+        if (2 * (used + 1) > slots.size()) {
+            grow();
+        }
+        Slot* slot = find(c);
+        if (slot->vertex == NO_VERTEX) {
+            *slot = Slot{c, vertex};
+            ++used;
+        }
+        return slot->vertex;
+    }
+
+private:
+    struct Slot {
+        Corner corner;
+        uint32_t vertex;
+    };
+
+    static size_t hash(const Corner& c) {
+        uint64_t h = static_cast<uint32_t>(c.v);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c.t);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c.n);
+        h *= 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    Slot* find(const Corner& c) {
+        const size_t mask = slots.size() - 1;
+        size_t i = hash(c) & mask;
+        while ((slots[i].vertex != NO_VERTEX) && !(slots[i].corner == c)) {
+            i = (i + 1) & mask;
+        }
+        return &slots[i];
+    }
+
+    void grow() {
+        std::vector<Slot> old(2 * slots.size(), Slot{Corner{-1, -1, -1}, NO_VERTEX});
+        old.swap(slots);
+        for (const auto& slot : old) {
+            if (slot.vertex != NO_VERTEX) {
+                *find(slot.corner) = slot;
+            }
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t used = 0;
+};
+
+/** The corners parsed since the last object or group name of a line range */
+struct Segment {
+    /** Continues the shape of the previous range if 'false' */
+    bool named = false;
+    std::string name;
+    std::vector<Corner> triangles;
+    std::vector<Corner> lines;
+};
+
+/** The result of parsing one line range */
+struct Range {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    size_t positions = 0;
+    size_t normals = 0;
+    size_t texcoords = 0;
+    std::vector<Segment> segments;
+    std::string error;
+};
+
+/** The record types that matter here */
+enum class Record { NONE, POSITION, NORMAL, TEXCOORD, FACE, LINE, OBJECT };
+
+inline bool isBlank(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while ((p < end) && isBlank(*p))
+        ++p;
+    return p;
+}
+
+inline const char* nextLine(const char* p, const char* end) {
+    if (p >= end)
+        return end;
+    const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return (nl == nullptr) ? end : static_cast<const char*>(nl) + 1;
+}
+
+/**
+ * Answer the type of the record at 'p', which is advanced past its keyword.
+ */
+inline Record keyword(const char*& p, const char* end) {
+    const char* k = p;
+    while ((p < end) && (*p != '\n') && !isBlank(*p))
+        ++p;
+    const auto len = p - k;
+    if (len == 1) {
+        switch (k[0]) {
+        case 'v':
+            return Record::POSITION;
+        case 'f':
+            return Record::FACE;
+        case 'l':
+            return Record::LINE;
+        case 'o':
+        case 'g':
+            return Record::OBJECT;
+        default:
+            return Record::NONE;
+        }
+    }
+    if ((len == 2) && (k[0] == 'v')) {
+        if (k[1] == 'n')
+            return Record::NORMAL;
+        if (k[1] == 't')
+            return Record::TEXCOORD;
+    }
+    return Record::NONE;
+}
+
+/**
+ * Parses the floating-point number at 'p' like std::from_chars does, but
+ * accepting a leading '+'.
+ */
+bool parseFloat(const char*& p, const char* end, float& value) {
+    const char* s = p;
+    if ((s < end) && (*s == '+'))
+        ++s;
+    const char* tokEnd = s;
+    while ((tokEnd < end) && (*tokEnd != '\n') && !isBlank(*tokEnd))
+        ++tokEnd;
+#ifdef __cpp_lib_to_chars
+    auto const res = std::from_chars(s, tokEnd, value);
+    if ((res.ec == std::errc()) && (res.ptr == tokEnd)) {
+        p = tokEnd;
+        return true;
+    }
+#endif
+    char buf[64];
+    const auto len = static_cast<size_t>(tokEnd - s);
+    if ((len == 0) || (len >= sizeof(buf)))
+        return false;
+    std::memcpy(buf, s, len);
+    buf[len] = 0;
+    char* parsedEnd = nullptr;
+    value = std::strtof(buf, &parsedEnd);
+    if (parsedEnd != buf + len)
+        return false;
+    p = tokEnd;
+    return true;
+}
+
+/**
+ * Parses up to 'maxCnt' numbers of the current line into 'out'.
+ *
+ * @return The number of values parsed, or -1 on a malformed number.
+ */
+int parseFloats(const char*& p, const char* end, float* out, int maxCnt) {
+    int cnt = 0;
+    p = skipBlanks(p, end);
+    while ((cnt < maxCnt) && (p < end) && (*p != '\n')) {
+        if (!parseFloat(p, end, out[cnt]))
+            return -1;
+        ++cnt;
+        p = skipBlanks(p, end);
+    }
+    return cnt;
+}
+
+/**
+ * Parses the index at 'p' and resolves it against the 'cnt' values defined
+ * before, i.e. one-based indices and negative ones relative to the end.
+ */
+bool parseIndex(const char*& p, const char* end, size_t cnt, int32_t& index) {
+    const char* s = p;
+    const bool negative = (s < end) && (*s == '-');
+    if (negative || ((s < end) && (*s == '+')))
+        ++s;
+    int64_t value = 0;
+    const char* digits = s;
+    while ((s < end) && (*s >= '0') && (*s <= '9') && (s - digits < 12)) {
+        value = value * 10 + (*s - '0');
+        ++s;
+    }
+    if ((s == digits) || (value == 0))
+        return false;
+    value = negative ? static_cast<int64_t>(cnt) - value : value - 1;
+    if ((value < 0) || (value > std::numeric_limits<int32_t>::max()))
+        return false;
+    index = static_cast<int32_t>(value);
+    p = s;
+    return true;
+}
+
+/**
+ * Parses the corner "v", "v/t", "v//n" or "v/t/n" at 'p'.
+ */
+bool parseCorner(const char*& p, const char* end, const size_t counts[3], Corner& corner) {
+    corner.t = -1;
+    corner.n = -1;
+    if (!parseIndex(p, end, counts[0], corner.v))
+        return false;
+    if ((p < end) && (*p == '/')) {
+        ++p;
+        if ((p < end) && (*p != '/')) {
+            if (!parseIndex(p, end, counts[1], corner.t))
+                return false;
+        }
+        if ((p < end) && (*p == '/')) {
+            ++p;
+            if (!parseIndex(p, end, counts[2], corner.n))
+                return false;
+        }
+    }
+    return (p >= end) || (*p == '\n') || isBlank(*p);
+}
+
+/**
+ * Counts the vertex records of 'range'.
+ */
+void countRange(Range& range) {
+    for (const char* line = range.begin; line < range.end; line = nextLine(line, range.end)) {
+        const char* p = skipBlanks(line, range.end);
+        if ((p >= range.end) || (*p != 'v'))
+            continue;
+        switch (keyword(p, range.end)) {
+        case Record::POSITION:
+            ++range.positions;
+            break;
+        case Record::NORMAL:
+            ++range.normals;
+            break;
+        case Record::TEXCOORD:
+            ++range.texcoords;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * Parses 'range', which starts after the given numbers of vertex records. The
+ * vertex data is written to its place in 'data'.
+ */
+bool parseRange(Range& range, size_t positionBase, size_t normalBase, size_t texcoordBase, ObjData& data) {
+    // the vertex records defined before the current line, i.e. what relative indices refer to
+    size_t counts[3] = {positionBase, texcoordBase, normalBase};
+    range.segments.emplace_back();
+    std::vector<Corner> polygon;
+
+    for (const char* line = range.begin; line < range.end; line = nextLine(line, range.end)) {
+        const char* p = skipBlanks(line, range.end);
+        if ((p >= range.end) || (*p == '#') || (*p == '\n'))
+            continue;
+        const auto record = keyword(p, range.end);
+        switch (record) {
+        case Record::POSITION: {
+            // ignores the optional weight or color
+            float* out = &data.positions[3 * counts[0]];
+            if (parseFloats(p, range.end, out, 3) != 3) {
+                range.error = "malformed vertex position";
+                return false;
+            }
+            ++counts[0];
+        } break;
+        case Record::TEXCOORD: {
+            float* out = &data.texcoords[2 * counts[1]];
+            out[1] = 0.0f;
+            if (parseFloats(p, range.end, out, 2) < 1) {
+                range.error = "malformed texture coordinate";
+                return false;
+            }
+            ++counts[1];
+        } break;
+        case Record::NORMAL: {
+            float* out = &data.normals[3 * counts[2]];
+            if (parseFloats(p, range.end, out, 3) != 3) {
+                range.error = "malformed normal";
+                return false;
+            }
+            ++counts[2];
+        } break;
+        case Record::FACE:
+        case Record::LINE: {
+            polygon.clear();
+            p = skipBlanks(p, range.end);
+            while ((p < range.end) && (*p != '\n')) {
+                Corner c;
+                if (!parseCorner(p, range.end, counts, c)) {
+                    range.error = (record == Record::FACE) ? "malformed face" : "malformed line";
+                    return false;
+                }
+                polygon.push_back(c);
+                p = skipBlanks(p, range.end);
+            }
+            auto& segment = range.segments.back();
+            if (record == Record::FACE) {
+                for (size_t i = 2; i < polygon.size(); ++i) {
+                    segment.triangles.push_back(polygon[0]);
+                    segment.triangles.push_back(polygon[i - 1]);
+                    segment.triangles.push_back(polygon[i]);
+                }
+            } else {
+                for (size_t i = 1; i < polygon.size(); ++i) {
+                    segment.lines.push_back(polygon[i - 1]);
+                    segment.lines.push_back(polygon[i]);
+                }
+            }
+        } break;
+        case Record::OBJECT: {
+            p = skipBlanks(p, range.end);
+            const char* nameEnd = nextLine(p, range.end);
+            while ((nameEnd > p) && ((nameEnd[-1] == '\n') || isBlank(nameEnd[-1])))
+                --nameEnd;
+            range.segments.emplace_back();
+            range.segments.back().named = true;
+            range.segments.back().name.assign(p, nameEnd);
+        } break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+
+/*
+ * MapFile
+ */
+MappedFile MapFile(const std::filesystem::path& path) {
+    MappedFile mapped;
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec || (size == 0)) {
+        return mapped;
+    }
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return mapped;
+    }
+    HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (mapping == nullptr) {
+        return mapped;
+    }
+    // the view keeps the mapping object alive
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (view == nullptr) {
+        return mapped;
+    }
+    mapped.data = std::shared_ptr<char>(static_cast<char*>(view), [](char* p) { ::UnmapViewOfFile(p); });
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return mapped;
+    }
+    void* view = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return mapped;
+    }
+    const auto len = static_cast<size_t>(size);
+    mapped.data = std::shared_ptr<char>(static_cast<char*>(view), [len](char* p) { ::munmap(p, len); });
+#endif
+    mapped.size = static_cast<size_t>(size);
+    return mapped;
+}
+
+
+/*
+ * Parse
+ */
+bool Parse(const char* begin, const char* end, ObjData& data, std::string& error) {
+    data = ObjData();
+
+    // split into line ranges, several per thread to even out dense and sparse parts
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    const size_t minRangeSize = 1 << 20;
+    const size_t size = static_cast<size_t>(end - begin);
+    const size_t parts = std::max<size_t>(1, std::min<size_t>(4 * threads, size / minRangeSize));
+    std::vector<Range> ranges;
+    const char* rangeBegin = begin;
+    for (size_t i = 1; i <= parts; ++i) {
+        // starting one character early keeps a split point that already is a line start
+        const char* cut = (i == parts) ? end : nextLine(begin + (size * i) / parts - 1, end);
+        if (cut > rangeBegin) {
+            ranges.emplace_back();
+            ranges.back().begin = rangeBegin;
+            ranges.back().end = cut;
+            rangeBegin = cut;
+        }
+    }
+    const auto rangeCnt = static_cast<long long>(ranges.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (long long r = 0; r < rangeCnt; ++r) {
+        countRange(ranges[r]);
+    }
+
+    std::vector<size_t> positionBase(ranges.size() + 1, 0);
+    std::vector<size_t> normalBase(ranges.size() + 1, 0);
+    std::vector<size_t> texcoordBase(ranges.size() + 1, 0);
+    for (size_t r = 0; r < ranges.size(); ++r) {
+        positionBase[r + 1] = positionBase[r] + ranges[r].positions;
+        normalBase[r + 1] = normalBase[r] + ranges[r].normals;
+        texcoordBase[r + 1] = texcoordBase[r] + ranges[r].texcoords;
+    }
+    data.positions.resize(3 * positionBase.back());
+    data.normals.resize(3 * normalBase.back());
+    data.texcoords.resize(2 * texcoordBase.back());
+
+    bool ok = true;
+#pragma omp parallel for schedule(dynamic) reduction(&& : ok)
+    for (long long r = 0; r < rangeCnt; ++r) {
+        ok = parseRange(ranges[r], positionBase[r], normalBase[r], texcoordBase[r], data) && ok;
+    }
+    if (!ok) {
+        for (size_t r = 0; r < ranges.size(); ++r) {
+            if (!ranges[r].error.empty()) {
+                const auto offset = static_cast<size_t>(ranges[r].begin - begin);
+                error = ranges[r].error + " in the line range starting at byte " + std::to_string(offset);
+                break;
+            }
+        }
+        data = ObjData();
+        return false;
+    }
+
+    // hand the corner lists over to the shapes, in order of their first appearance
+    std::unordered_map<std::string, size_t> shapeIndex;
+    size_t current = 0;
+    data.shapes.emplace_back();
+    shapeIndex[""] = 0;
+    for (auto& range : ranges) {
+        for (auto& segment : range.segments) {
+            if (segment.named) {
+                auto const it = shapeIndex.find(segment.name);
+                if (it != shapeIndex.end()) {
+                    current = it->second;
+                } else {
+                    current = data.shapes.size();
+                    shapeIndex[segment.name] = current;
+                    data.shapes.emplace_back();
+                    data.shapes.back().name = segment.name;
+                }
+            }
+            auto& shape = data.shapes[current];
+            if (!segment.triangles.empty()) {
+                shape.triangles.push_back(std::move(segment.triangles));
+            }
+            if (!segment.lines.empty()) {
+                shape.lines.push_back(std::move(segment.lines));
+            }
+        }
+        range.segments.clear();
+    }
+    data.shapes.erase(std::remove_if(data.shapes.begin(), data.shapes.end(),
+                          [](const ObjData::Shape& s) { return s.triangles.empty() && s.lines.empty(); }),
+        data.shapes.end());
+
+    return true;
+}
+
+
+/*
+ * Weld
+ */
+bool Weld(const ObjData& data, const ObjData::Shape& shape, IndexedMesh& mesh, std::string& error) {
+    mesh = IndexedMesh();
+    mesh.name = shape.name;
+    mesh.lines = shape.triangles.empty();
+    const auto& parts = mesh.lines ? shape.lines : shape.triangles;
+
+    const size_t positionCnt = data.positions.size() / 3;
+    const size_t normalCnt = data.normals.size() / 3;
+    const size_t texcoordCnt = data.texcoords.size() / 2;
+    size_t cornerCnt = 0;
+    bool hasNormals = false;
+    bool hasTexcoords = false;
+    for (const auto& part : parts) {
+        cornerCnt += part.size();
+        for (const auto& c : part) {
+            if ((static_cast<size_t>(c.v) >= positionCnt) || ((c.n >= 0) && (static_cast<size_t>(c.n) >= normalCnt)) ||
+                ((c.t >= 0) && (static_cast<size_t>(c.t) >= texcoordCnt))) {
+                error = "index out of range in shape \"" + shape.name + "\"";
+                return false;
+            }
+            hasNormals = hasNormals || (c.n >= 0);
+            hasTexcoords = hasTexcoords || (c.t >= 0);
+        }
+    }
+    if (cornerCnt >= NO_VERTEX) {
+        error = "too many corners in shape \"" + shape.name + "\"";
+        return false;
+    }
+
+    // most corners of a position share one texcoord and normal, so the first
+    // vertex of each position is found directly, all others are hashed
+    const bool dense = cornerCnt * 4 >= positionCnt;
+    std::vector<uint32_t> firstVertex(dense ? positionCnt : 0, NO_VERTEX);
+    std::vector<Corner> vertexCorner;
+    CornerMap otherVertices(dense ? 0 : cornerCnt / 2);
+    vertexCorner.reserve(dense ? std::min(cornerCnt, positionCnt) : cornerCnt);
+    mesh.indices.reserve(cornerCnt);
+
+    for (const auto& part : parts) {
+        for (const auto& c : part) {
+            uint32_t vertex = NO_VERTEX;
+            if (dense) {
+                vertex = firstVertex[c.v];
+                if (vertex == NO_VERTEX) {
+                    vertex = static_cast<uint32_t>(vertexCorner.size());
+                    firstVertex[c.v] = vertex;
+                    vertexCorner.push_back(c);
+                } else if (!(vertexCorner[vertex] == c)) {
+                    vertex = NO_VERTEX;
+                }
+            }
+            if (vertex == NO_VERTEX) {
+                vertex = otherVertices.findOrInsert(c, static_cast<uint32_t>(vertexCorner.size()));
+                if (vertex == vertexCorner.size()) {
+                    vertexCorner.push_back(c);
+                }
+            }
+            mesh.indices.push_back(vertex);
+        }
+    }
+
+    const size_t vertexCnt = vertexCorner.size();
+    mesh.positions.resize(3 * vertexCnt);
+    if (hasNormals) {
+        mesh.normals.resize(3 * vertexCnt, 0.0f);
+    }
+    if (hasTexcoords) {
+        mesh.texcoords.resize(2 * vertexCnt, 0.0f);
+    }
+    for (size_t i = 0; i < vertexCnt; ++i) {
+        const auto& c = vertexCorner[i];
+        std::copy_n(&data.positions[3 * static_cast<size_t>(c.v)], 3, &mesh.positions[3 * i]);
+        if (hasNormals && (c.n >= 0)) {
+            std::copy_n(&data.normals[3 * static_cast<size_t>(c.n)], 3, &mesh.normals[3 * i]);
+        }
+        if (hasTexcoords && (c.t >= 0)) {
+            std::copy_n(&data.texcoords[2 * static_cast<size_t>(c.t)], 2, &mesh.texcoords[2 * i]);
+        }
+    }
+
+    return true;
+}
+
+} // namespace megamol::mesh::obj
@@ -0,0 +1,106 @@
+/*
+ * WavefrontObjParser.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace megamol::mesh::obj {
+
+/**
+ * A face or line corner, i.e. zero-based indices into the position, texcoord
+ * and normal arrays. Missing texcoords and normals are -1.
+ */
+struct Corner {
+    int32_t v;
+    int32_t t;
+    int32_t n;
+
+    bool operator==(const Corner& rhs) const {
+        return (v == rhs.v) && (t == rhs.t) && (n == rhs.n);
+    }
+};
+
+/**
+ * The content of an obj file. The corners of a shape are kept in the parts
+ * they were parsed in, three per triangle and two per line segment.
+ */
+struct ObjData {
+    struct Shape {
+        std::string name;
+        std::vector<std::vector<Corner>> triangles;
+        std::vector<std::vector<Corner>> lines;
+    };
+
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+    std::vector<Shape> shapes;
+};
+
+/**
+ * A shape with one vertex per distinct corner. Normals and texcoords are empty
+ * if no corner of the shape has them.
+ */
+struct IndexedMesh {
+    std::string name;
+    bool lines = false;
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+    std::vector<uint32_t> indices;
+};
+
+/**
+ * A file mapped into memory copy-on-write, i.e. writing to the data does not
+ * change the file. The mapping lives as long as any copy of 'data'.
+ */
+struct MappedFile {
+    std::shared_ptr<char> data;
+    size_t size = 0;
+};
+
+/**
+ * Maps the file 'path' into memory.
+ *
+ * @return The mapping, which is empty if the file could not be mapped.
+ */
+MappedFile MapFile(const std::filesystem::path& path);
+
+/**
+ * Parses the obj file content [begin, end). Polygons are triangulated as fans,
+ * polylines are split into segments. Objects and groups of the same name are
+ * merged into one shape, faces before the first one go to the shape "".
+ * Materials, points and free-form geometry are ignored.
+ *
+ * The content is split into line ranges that are parsed in parallel. A first
+ * pass counts the vertex records of each range, so the second one resolves
+ * relative indices right away and writes the vertex data to its final place.
+ *
+ * @param error Receives a message if parsing fails.
+ *
+ * @return 'true' on success, 'false' on malformed numbers or indices.
+ */
+bool Parse(const char* begin, const char* end, ObjData& data, std::string& error);
+
+/**
+ * Welds the corners of 'shape' into an indexed mesh, i.e. corners with the
+ * same position, texcoord and normal index share a vertex. The triangles are
+ * used if there are any, the lines otherwise. Vertices are numbered in the
+ * order their corners appear.
+ *
+ * @param error Receives a message if welding fails.
+ *
+ * @return 'true' on success, 'false' on indices out of range.
+ */
+bool Weld(const ObjData& data, const ObjData::Shape& shape, IndexedMesh& mesh, std::string& error);
+
+} // namespace megamol::mesh::obj
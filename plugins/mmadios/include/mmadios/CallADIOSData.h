@@ -14,8 +14,14 @@
 #include "mmcore/utility/log/Log.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
 namespace megamol::adios {
@@ -26,6 +32,149 @@ struct adios2Params {
     bool isAttribute = false;
 };
 
+/**
+ * Restricts the read of a variable to a part of it. An empty selection
+ * reads the whole variable.
+ */
+struct adiosSelection {
+    /** Start and count of a box in the global shape, both empty for the whole shape. */
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    /**
+     * The written blocks to read, e.g. those of a subset of the writer ranks,
+     * concatenated in the given order. Empty for all blocks. Takes precedence
+     * over the box.
+     */
+    std::vector<size_t> blocks;
+
+    bool empty() const {
+        return start.empty() && count.empty() && blocks.empty();
+    }
+    bool operator==(const adiosSelection& rhs) const {
+        return start == rhs.start && count == rhs.count && blocks == rhs.blocks;
+    }
+    bool operator!=(const adiosSelection& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * Non-owning, read-only view of size() values of type T that lie stride()
+ * elements apart. A view stays valid as long as the container it was
+ * obtained from is neither modified nor destroyed.
+ */
+template<typename T>
+class TypedView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+        const_iterator(const T* ptr, size_t stride) : ptr(ptr), stride(stride) {}
+
+        reference operator*() const {
+            return *ptr;
+        }
+        pointer operator->() const {
+            return ptr;
+        }
+        const_iterator& operator++() {
+            ptr += stride;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ptr += stride;
+            return old;
+        }
+        bool operator==(const const_iterator& rhs) const {
+            return ptr == rhs.ptr;
+        }
+        bool operator!=(const const_iterator& rhs) const {
+            return ptr != rhs.ptr;
+        }
+
+    private:
+        const T* ptr = nullptr;
+        size_t stride = 1;
+    };
+
+    TypedView() = default;
+    TypedView(const T* data, size_t count, size_t stride = 1) : ptr(data), count(count), step(stride) {}
+
+    const T* data() const {
+        return ptr;
+    }
+    size_t size() const {
+        return count;
+    }
+    /** Answer the distance between two consecutive values in elements of T. */
+    size_t stride() const {
+        return step;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+    const T& operator[](size_t idx) const {
+        return ptr[idx * step];
+    }
+    const T& front() const {
+        return ptr[0];
+    }
+    const_iterator begin() const {
+        return const_iterator(ptr, step);
+    }
+    const_iterator end() const {
+        return const_iterator(ptr + count * step, step);
+    }
+
+    /** Answer the view of at most 'num' values starting at value 'first'. */
+    TypedView Subview(size_t first, size_t num) const {
+        if (first >= count) {
+            return TypedView(ptr, 0, step);
+        }
+        return TypedView(ptr + first * step, std::min(num, count - first), step);
+    }
+
+    /**
+     * Answer the view of every 'every'-th value starting at value 'first',
+     * e.g. Strided(1, 3) selects the y components of interleaved positions.
+     */
+    TypedView Strided(size_t first, size_t every) const {
+        if (first >= count || every == 0) {
+            return TypedView(ptr, 0, step);
+        }
+        return TypedView(ptr + first * step, (count - first + every - 1) / every, step * every);
+    }
+
+    /**
+     * Calls 'func(chunk, first)' for consecutive subviews of at most
+     * 'chunkSize' values, 'first' being the index of the chunk's first value.
+     */
+    template<typename F>
+    void ForEachChunk(size_t chunkSize, F&& func) const {
+        chunkSize = std::max<size_t>(chunkSize, 1);
+        for (size_t first = 0; first < count; first += chunkSize) {
+            func(Subview(first, chunkSize), first);
+        }
+    }
+
+    /** Answer a copy of the viewed values. */
+    std::vector<T> ToVector() const {
+        return std::vector<T>(begin(), end());
+    }
+
+private:
+    const T* ptr = nullptr;
+    size_t count = 0;
+    size_t step = 1;
+};
+
 class abstractContainer {
 public:
     virtual ~abstractContainer() = default;
@@ -42,6 +191,48 @@ public:
     virtual const std::string getType() = 0;
     virtual const size_t getTypeSize() = 0;
     virtual size_t size() = 0;
+
+    /** Answer the address of the stored values. */
+    virtual const void* rawData() = 0;
+    /** Answer the type of the stored values. */
+    virtual const std::type_info& valueType() = 0;
+
+    /**
+     * Answer the stored values as raw bytes without copying them, i.e.
+     * getTypeSize() bytes per value. Empty for strings.
+     */
+    TypedView<unsigned char> Bytes() {
+        if (valueType() == typeid(std::string)) {
+            return TypedView<unsigned char>();
+        }
+        return TypedView<unsigned char>(static_cast<const unsigned char*>(rawData()), size() * getTypeSize());
+    }
+
+    /**
+     * Answer the values as T. If T is the stored type, the view refers to the
+     * stored values, otherwise the values are converted once and the result
+     * is kept until the stored values are reallocated or InvalidateViews()
+     * is called. Not thread-safe for concurrent first calls of a new T.
+     */
+    template<typename T>
+    TypedView<T> View() {
+        if (valueType() == typeid(T)) {
+            return TypedView<T>(static_cast<const T*>(rawData()), size());
+        }
+        auto& cached = conversions[std::type_index(typeid(T))];
+        if (cached.values == nullptr || cached.source != rawData() || cached.count != size()) {
+            cached.values = std::make_shared<std::vector<T>>(convertTo<T>());
+            cached.source = rawData();
+            cached.count = size();
+        }
+        auto const& vec = *std::static_pointer_cast<std::vector<T>>(cached.values);
+        return TypedView<T>(vec.data(), vec.size());
+    }
+
+    /** Drops the converted values, must be called after modifying the stored values in place. */
+    void InvalidateViews() {
+        conversions.clear();
+    }
     std::vector<size_t> getShape() {
         if (shape.empty()) {
             std::vector<size_t> size_vec = {size()};
@@ -52,6 +243,37 @@ public:
 
     std::vector<size_t> shape;
     bool singleValue = false;
+
+private:
+    struct ConvertedValues {
+        std::shared_ptr<void> values;
+        const void* source = nullptr;
+        size_t count = 0;
+    };
+
+    template<typename T>
+    std::vector<T> convertTo() {
+        if constexpr (std::is_same_v<T, float>) {
+            return GetAsFloat();
+        } else if constexpr (std::is_same_v<T, double>) {
+            return GetAsDouble();
+        } else if constexpr (std::is_same_v<T, int32_t>) {
+            return GetAsInt32();
+        } else if constexpr (std::is_same_v<T, uint64_t>) {
+            return GetAsUInt64();
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            return GetAsUInt32();
+        } else if constexpr (std::is_same_v<T, char>) {
+            return GetAsChar();
+        } else if constexpr (std::is_same_v<T, unsigned char>) {
+            return GetAsUChar();
+        } else {
+            static_assert(std::is_same_v<T, std::string>, "Unsupported type");
+            return GetAsString();
+        }
+    }
+
+    std::map<std::type_index, ConvertedValues> conversions;
 };
 
 template<typename value_type>
@@ -136,6 +358,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class FloatContainer : public abstractContainer, public containerInterface<float> {
@@ -176,6 +404,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class Int32Container : public abstractContainer, public containerInterface<int32_t> {
@@ -216,6 +450,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(int32_t);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class UInt64Container : public abstractContainer, public containerInterface<uint64_t> {
@@ -256,6 +496,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class UInt32Container : public abstractContainer, public containerInterface<uint32_t> {
@@ -296,6 +542,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class UCharContainer : public abstractContainer, public containerInterface<unsigned char> {
@@ -336,6 +588,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class CharContainer : public abstractContainer, public containerInterface<char> {
@@ -376,6 +634,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 class StringContainer : public abstractContainer, public containerInterface<std::string> {
@@ -446,6 +710,12 @@ public:
     const size_t getTypeSize() override {
         return sizeof(value_type);
     }
+    const void* rawData() override {
+        return getVec().data();
+    }
+    const std::type_info& valueType() override {
+        return typeid(value_type);
+    }
 };
 
 
@@ -524,6 +794,13 @@ public:
     std::map<std::string, std::string> getVarProperties(std::string var) const;
     void setAvailableVars(const std::vector<std::string>& avars);
 
+    /**
+     * Restricts the read of an inquired variable, an empty selection resets
+     * it to the whole variable.
+     */
+    void setSelection(const std::string& varname, const adiosSelection& sel);
+    std::map<std::string, adiosSelection> getSelections() const;
+
     bool inquireAttr(const std::string& attrname);
     std::vector<std::string> getAttributesToInquire() const;
     std::vector<std::string> getAvailableAttributes() const;
@@ -572,6 +849,7 @@ private:
     std::vector<std::string> inqVars;
     std::vector<std::string> availableVars;
     std::map<std::string, std::map<std::string, std::string>> allVars;
+    std::map<std::string, adiosSelection> selections;
     std::vector<std::string> inqAttributes;
     std::vector<std::string> availableAttributes;
 
@@ -117,13 +117,14 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
                 return false;
             }
 
-            std::vector<unsigned char> X;
-            std::vector<unsigned char> Y;
-            std::vector<unsigned char> Z;
+            // the particle attributes are copied byte-wise, so they are viewed in their stored types
+            TypedView<unsigned char> X;
+            TypedView<unsigned char> Y;
+            TypedView<unsigned char> Z;
 
             stride = 0;
             if (cad->isInVars("xyz")) {
-                X = cad->getData("xyz")->GetAsUChar();
+                X = cad->getData("xyz")->Bytes();
                 stride += 3 * cad->getData("xyz")->getTypeSize();
                 if (cad->getData("xyz")->getTypeSize() == 4) {
                     vertType = geocalls::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ;
@@ -131,9 +132,9 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
                     vertType = geocalls::SimpleSphericalParticles::VERTDATA_DOUBLE_XYZ;
                 }
             } else if (cad->isInVars("x") && cad->isInVars("y") && cad->isInVars("z")) {
-                X = cad->getData("x")->GetAsUChar();
-                Y = cad->getData("y")->GetAsUChar();
-                Z = cad->getData("z")->GetAsUChar();
+                X = cad->getData("x")->Bytes();
+                Y = cad->getData("y")->Bytes();
+                Z = cad->getData("z")->Bytes();
                 stride += 3 * cad->getData("x")->getTypeSize();
                 if (cad->getData("x")->getTypeSize() == 4) {
                     vertType = geocalls::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ;
@@ -145,40 +146,35 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
                     "ADIOStoMultiParticle: No particle positions found");
                 return false;
             }
-            std::vector<float> box = cad->getData("global_box")->GetAsFloat();
+            auto const box = cad->getData("global_box")->View<float>();
 
-            auto p_count = cad->getData("count")->GetAsUInt64();
-            std::vector<unsigned char> radius;
-            std::vector<unsigned char> r;
-            std::vector<unsigned char> g;
-            std::vector<unsigned char> b;
-            std::vector<unsigned char> a;
-            std::vector<unsigned char> id;
-            std::vector<unsigned char> intensity;
+            auto const p_count = cad->getData("count")->View<uint64_t>();
+            TypedView<unsigned char> radius;
+            TypedView<unsigned char> r;
+            TypedView<unsigned char> g;
+            TypedView<unsigned char> b;
+            TypedView<unsigned char> a;
+            TypedView<unsigned char> id;
+            TypedView<unsigned char> intensity;
 
             // list_box
             if (cad->isInVars("list_box")) {
-                list_box = cad->getData("list_box")->GetAsFloat();
+                list_box = cad->getData("list_box")->View<float>().ToVector();
             }
             // Radius
             if (cad->isInVars("radius")) {
-                radius = cad->getData("radius")->GetAsUChar();
-                stride += 3 * cad->getData("radius")->getTypeSize();
+                radius = cad->getData("radius")->Bytes();
+                stride += cad->getData("radius")->getTypeSize();
             }
             // Colors
             if (cad->isInVars("r")) {
-                r = cad->getData("r")->GetAsUChar();
-                g = cad->getData("g")->GetAsUChar();
-                b = cad->getData("b")->GetAsUChar();
-                a = cad->getData("a")->GetAsUChar();
+                r = cad->getData("r")->Bytes();
+                g = cad->getData("g")->Bytes();
+                b = cad->getData("b")->Bytes();
+                a = cad->getData("a")->Bytes();
                 stride += 4 * cad->getData("r")->getTypeSize();
-            } else if (cad->isInVars("global_r")) {
-                r = cad->getData("global_r")->GetAsUChar();
-                g = cad->getData("global_g")->GetAsUChar();
-                b = cad->getData("global_b")->GetAsUChar();
-                a = cad->getData("global_a")->GetAsUChar();
             } else if (cad->isInVars("i")) {
-                intensity = cad->getData("i")->GetAsUChar();
+                intensity = cad->getData("i")->Bytes();
                 stride += cad->getData("i")->getTypeSize();
                 // normalizing intentsity to [0,1]
                 // std::vector<float>::iterator minIt = std::min_element(std::begin(intensity), std::end(intensity));
@@ -191,7 +187,7 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
             }
             // ID
             if (cad->isInVars("id")) {
-                id = cad->getData("id")->GetAsUChar();
+                id = cad->getData("id")->Bytes();
                 stride += cad->getData("id")->getTypeSize();
             }
 
@@ -201,7 +197,7 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
             mpdc->AccessBoundingBoxes().SetObjectSpaceClipBox(cubo);
 
             // ParticeList offset
-            plist_offset = cad->getData("list_offset")->GetAsUInt64();
+            plist_offset = cad->getData("list_offset")->View<uint64_t>().ToVector();
 
             // merge node offsets
             size_t count_index = 0;
@@ -239,19 +235,19 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
                 idType = geocalls::SimpleSphericalParticles::IDDATA_NONE;
 
                 if (cad->isInVars("global_radius")) {
-                    auto flt_radius = cad->getData("global_radius")->GetAsFloat();
-                    mpdc->AccessParticles(k).SetGlobalRadius(flt_radius[0]);
+                    mpdc->AccessParticles(k).SetGlobalRadius(cad->getData("global_radius")->View<float>()[0]);
                 } else if (cad->isInVars("radius")) {
                     vertType = geocalls::SimpleSphericalParticles::VERTDATA_FLOAT_XYZR;
                 } else {
                     mpdc->AccessParticles(k).SetGlobalRadius(1.0f);
                 }
                 if (cad->isInVars("global_r")) {
-                    auto flt_r = reinterpret_cast<std::vector<float>&>(r);
-                    auto flt_g = reinterpret_cast<std::vector<float>&>(g);
-                    auto flt_b = reinterpret_cast<std::vector<float>&>(b);
-                    auto flt_a = reinterpret_cast<std::vector<float>&>(a);
-                    mpdc->AccessParticles(k).SetGlobalColour(r[0] * 255, g[0] * 255, b[0] * 255, a[0] * 255);
+                    auto const flt_r = cad->getData("global_r")->View<float>();
+                    auto const flt_g = cad->getData("global_g")->View<float>();
+                    auto const flt_b = cad->getData("global_b")->View<float>();
+                    auto const flt_a = cad->getData("global_a")->View<float>();
+                    mpdc->AccessParticles(k).SetGlobalColour(
+                        flt_r[0] * 255, flt_g[0] * 255, flt_b[0] * 255, flt_a[0] * 255);
                 } else if (cad->isInVars("r")) {
                     if (cad->getData("r")->getType() == "float") {
                         colType = geocalls::SimpleSphericalParticles::COLDATA_FLOAT_RGBA;
@@ -278,7 +274,7 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
                 // Fill mmpld byte array
                 mix[k].clear();
                 mix[k].shrink_to_fit();
-                mix[k].reserve(stride * p_count[k]);
+                mix[k].reserve(stride * particleCount);
 
                 const bool have_interleaved_pos = cad->isInVars("xyz");
                 const bool have_radius = cad->isInVars("radius");
@@ -295,29 +291,28 @@ bool ADIOStoMultiParticle::getDataCallback(core::Call& call) {
                 for (size_t i = plist_offset[k]; i < (plist_offset[k] + particleCount); i++) {
 
                     if (have_interleaved_pos) {
-                        mix[k].insert(mix[k].end(), X.begin() + 3 * interleaved_pos_size * i,
-                            X.begin() + 3 * interleaved_pos_size * (i + 1));
+                        mix[k].insert(mix[k].end(), X.data() + 3 * interleaved_pos_size * i,
+                            X.data() + 3 * interleaved_pos_size * (i + 1));
                     } else {
-                        mix[k].insert(mix[k].end(), X.begin() + pos_size * i, X.begin() + pos_size * (i + 1));
-                        mix[k].insert(mix[k].end(), Y.begin() + pos_size * i, Y.begin() + pos_size * (i + 1));
-                        mix[k].insert(mix[k].end(), Z.begin() + pos_size * i, Z.begin() + pos_size * (i + 1));
+                        mix[k].insert(mix[k].end(), X.data() + pos_size * i, X.data() + pos_size * (i + 1));
+                        mix[k].insert(mix[k].end(), Y.data() + pos_size * i, Y.data() + pos_size * (i + 1));
+                        mix[k].insert(mix[k].end(), Z.data() + pos_size * i, Z.data() + pos_size * (i + 1));
                     }
                     if (have_radius) {
-                        std::vector<unsigned char> tmp_radius = reinterpret_cast<std::vector<unsigned char>&>(radius);
-                        mix[k].insert(mix[k].end(), tmp_radius.begin() + radius_size * i,
-                            tmp_radius.begin() + radius_size * (i + 1));
+                        mix[k].insert(mix[k].end(), radius.data() + radius_size * i,
+                            radius.data() + radius_size * (i + 1));
                     }
                     if (have_colors) {
-                        mix[k].insert(mix[k].end(), r.begin() + col_size * i, r.begin() + col_size * (i + 1));
-                        mix[k].insert(mix[k].end(), g.begin() + col_size * i, g.begin() + col_size * (i + 1));
-                        mix[k].insert(mix[k].end(), b.begin() + col_size * i, b.begin() + col_size * (i + 1));
-                        mix[k].insert(mix[k].end(), a.begin() + col_size * i, a.begin() + col_size * (i + 1));
+                        mix[k].insert(mix[k].end(), r.data() + col_size * i, r.data() + col_size * (i + 1));
+                        mix[k].insert(mix[k].end(), g.data() + col_size * i, g.data() + col_size * (i + 1));
+                        mix[k].insert(mix[k].end(), b.data() + col_size * i, b.data() + col_size * (i + 1));
+                        mix[k].insert(mix[k].end(), a.data() + col_size * i, a.data() + col_size * (i + 1));
                     } else if (have_intensity) {
-                        mix[k].insert(mix[k].end(), intensity.begin() + intensity_size * i,
-                            intensity.begin() + intensity_size * (i + 1));
+                        mix[k].insert(mix[k].end(), intensity.data() + intensity_size * i,
+                            intensity.data() + intensity_size * (i + 1));
                     }
                     if (have_ids) {
-                        mix[k].insert(mix[k].end(), id.begin() + id_size * i, id.begin() + id_size * (i + 1));
+                        mix[k].insert(mix[k].end(), id.data() + id_size * i, id.data() + id_size * (i + 1));
                     }
                 }
             }
@@ -83,10 +83,10 @@ bool ADIOStoTable::getData(core::Call& call) {
 
         _cols = availVars.size();
         _colinfo.resize(_cols);
-        std::vector<std::vector<float>> raw_data(_cols);
+        std::vector<TypedView<float>> raw_data(_cols);
         for (int i = 0; i < availVars.size(); ++i) {
             _rows = std::max(_rows, cad->getData(availVars[i])->size());
-            raw_data[i] = cad->getData(availVars[i])->GetAsFloat();
+            raw_data[i] = cad->getData(availVars[i])->View<float>();
             auto prop = cad->getVarProperties(availVars[i]);
             float min = std::numeric_limits<float>::max();
             float max = std::numeric_limits<float>::lowest();
@@ -94,7 +94,7 @@ bool ADIOStoTable::getData(core::Call& call) {
                 min = std::stof(prop["Min"]);
                 max = std::stof(prop["Max"]);
             } else {
-                for (float& j : raw_data[i]) {
+                for (float const j : raw_data[i]) {
                     min = std::min(min, j);
                     max = std::max(max, j);
                 }
@@ -84,6 +84,18 @@ void CallADIOSData::setAvailableVars(const std::vector<std::string>& avars) {
     this->availableVars = avars;
 }
 
+void CallADIOSData::setSelection(const std::string& varname, const adiosSelection& sel) {
+    if (sel.empty()) {
+        this->selections.erase(varname);
+    } else {
+        this->selections[varname] = sel;
+    }
+}
+
+std::map<std::string, adiosSelection> CallADIOSData::getSelections() const {
+    return selections;
+}
+
 bool CallADIOSData::inquireAttr(const std::string& attrname) {
     if (!this->availableVars.empty()) {
         if (std::find(this->availableAttributes.begin(), this->availableAttributes.end(), attrname) !=
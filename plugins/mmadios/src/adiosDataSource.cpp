@@ -1,5 +1,7 @@
 #include "adiosDataSource.h"
 #include "cluster/mpi/MpiCall.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/utility/log/Log.h"
 #include "vislib/StringConverter.h"
@@ -15,12 +17,32 @@ namespace megamol::adios {
 adiosDataSource::adiosDataSource()
         : callRequestMpi("requestMpi", "Requests initialization of MPI and the communicator for the view.")
         , getData("getdata", "Slot to request data from this data source.")
-        , filenameSlot("filename", "The path to the ADIOS-based file to load.") {
+        , filenameSlot("filename", "The path to the ADIOS-based file to load.")
+        , streamingSlot("streaming", "Reads the steps in order with BeginStep/EndStep instead of random access. "
+                                     "Steps that have been passed cannot be read again.")
+        , prefetchSlot("prefetch", "Reads the next step in the background while the current one is used. "
+                                   "When streaming, this passes the current step right after it has been read.")
+        , blockDistributionSlot("blockDistribution", "Reads only the blocks of this MPI rank of variables "
+                                                     "without an explicit selection.") {
 
     this->filenameSlot.SetParameter(new core::param::FilePathParam("", core::param::FilePathParam::Flag_Any));
     this->filenameSlot.SetUpdateCallback(&adiosDataSource::filenameChanged);
     this->MakeSlotAvailable(&this->filenameSlot);
 
+    this->streamingSlot.SetParameter(new core::param::BoolParam(false));
+    this->streamingSlot.SetUpdateCallback(&adiosDataSource::filenameChanged);
+    this->MakeSlotAvailable(&this->streamingSlot);
+
+    this->prefetchSlot.SetParameter(new core::param::BoolParam(true));
+    this->MakeSlotAvailable(&this->prefetchSlot);
+
+    auto distribution = new core::param::EnumParam(0);
+    distribution->SetTypePair(0, "all blocks");
+    distribution->SetTypePair(1, "blocks by rank");
+    this->blockDistributionSlot.SetParameter(distribution);
+    this->blockDistributionSlot.SetUpdateCallback(&adiosDataSource::distributionChanged);
+    this->MakeSlotAvailable(&this->blockDistributionSlot);
+
 
     this->getData.SetCallback("CallADIOSData", "GetData", &adiosDataSource::getDataCallback);
     this->getData.SetCallback("CallADIOSData", "GetHeader", &adiosDataSource::getHeaderCallback);
@@ -95,7 +117,8 @@ bool adiosDataSource::create() {
 /*
  * adiosDataSource::release
  */
-void adiosDataSource::release() { /* empty */
+void adiosDataSource::release() {
+    this->dropPrefetch();
 }
 
 
@@ -107,109 +130,88 @@ bool adiosDataSource::getDataCallback(core::Call& caller) {
     if (cad == nullptr)
         return false;
 
-    if (!this->dataMap.empty()) {
-        auto inqV = cad->getVarsToInquire();
-        for (auto var : inqV) {
-            this->inquireChanged = this->inquireChanged || this->dataMap.find(var) == this->dataMap.end();
-        }
-        auto inqA = cad->getAttributesToInquire();
-        for (auto attr : inqA) {
-            this->inquireChanged = this->inquireChanged || this->dataMap.find(attr) == this->dataMap.end();
-        }
-    } else {
-        if (!cad->getVarsToInquire().empty() || !cad->getAttributesToInquire().empty()) {
-            this->inquireChanged = true;
+    ReadRequest req;
+    req.names = cad->getVarsToInquire();
+    auto attrsToInquire = cad->getAttributesToInquire();
+    req.names.insert(req.names.end(), attrsToInquire.begin(), attrsToInquire.end());
+    auto const selections = cad->getSelections();
+    for (auto const& name : req.names) {
+        auto const sel = selections.find(name);
+        if (sel != selections.end()) {
+            req.selections[name] = sel->second;
         }
     }
+    req.distributeBlocks = this->blockDistributionSlot.Param<core::param::EnumParam>()->Value() == 1;
 
-    if (dataHashChanged || inquireChanged || loadedFrameID != cad->getFrameIDtoLoad()) {
+    this->inquireChanged = !req.names.empty() && !this->isLoaded(req);
+    auto frameIDtoLoad = std::min(frameCount - 1, cad->getFrameIDtoLoad());
+    if (this->streamingOpened && static_cast<long long int>(frameIDtoLoad) < dataFrameID) {
+        // a stream cannot go back, keep the current step
+        frameIDtoLoad = dataFrameID;
+    }
+
+    if (dataHashChanged || inquireChanged || dataFrameID != static_cast<long long int>(frameIDtoLoad)) {
 
         try {
-            auto fname = this->filenameSlot.Param<core::param::FilePathParam>()->Value().generic_u8string();
-#ifdef _WIN32
-            std::replace(fname.begin(), fname.end(), '/', '\\');
-#endif
             if (!this->reader) {
                 megamol::core::utility::log::Log::DefaultLog.WriteError(
                     "[adiosDataSource] Header callback not called yet.");
                 return false;
             }
 
-
-            //megamol::core::utility::log::Log::DefaultLog.WriteInfo("[adiosDataSource] Beginning step");
-            //const adios2::StepStatus status = reader->BeginStep();
-            //if (status != adios2::StepStatus::OK) {
-            //    megamol::core::utility::log::Log::DefaultLog.WriteError("[adiosDataSource] BeginStep returned an error.");
-            //    return false;
-            //}
-
-
-            auto toInquire = cad->getVarsToInquire();
-            auto attrsToInquire = cad->getAttributesToInquire();
-            toInquire.insert(toInquire.end(), attrsToInquire.begin(), attrsToInquire.end());
-            if (toInquire.empty()) {
+            if (req.names.empty()) {
                 megamol::core::utility::log::Log::DefaultLog.WriteError(
                     "[adiosDataSource] Nothing inquired ... exiting");
                 return false;
             }
 
-            auto const frameIDtoLoad = std::min(frameCount - 1, cad->getFrameIDtoLoad());
             if (frameIDtoLoad != cad->getFrameIDtoLoad()) {
                 megamol::core::utility::log::Log::DefaultLog.WriteError(
                     "[adiosDataSource] Could not load frame %u, returning last frame (%u) instead",
                     cad->getFrameIDtoLoad(), frameIDtoLoad);
             }
-            std::vector<adios2Params> content = variables;
-            content.insert(content.end(), attributes.begin(), attributes.end());
-
-            for (auto toInq : toInquire) {
-                for (auto var : content) {
-                    if (var.name == toInq) {
-                        std::vector<size_t> shape(1);
-                        bool singleValue = true;
-                        if (var.params["SingleValue"] != std::string("true")) {
-                            // num = std::stoi(var.second["Shape"]);
-                            singleValue = false;
-                        }
-                        if (var.params["Type"] == "float") {
-                            auto fc = std::make_shared<FloatContainer>(FloatContainer());
-                            inquireRead<float>(fc, var, frameIDtoLoad, singleValue);
-                        } else if (var.params["Type"] == "double") {
-                            auto fc = std::make_shared<DoubleContainer>(DoubleContainer());
-                            inquireRead<double>(fc, var, frameIDtoLoad, singleValue);
-                        } else if (var.params["Type"] == "int32_t") {
-                            auto fc = std::make_shared<Int32Container>(Int32Container());
-                            inquireRead<int32_t>(fc, var, frameIDtoLoad, singleValue);
-                        } else if (var.params["Type"] == "int8_t" || var.params["Type"] == "char") {
-                            auto fc = std::make_shared<CharContainer>(CharContainer());
-                            inquireRead<char>(fc, var, frameIDtoLoad, singleValue);
-                        } else if (var.params["Type"] == "uint64_t") {
-                            auto fc = std::make_shared<UInt64Container>(UInt64Container());
-                            inquireRead<uint64_t>(fc, var, frameIDtoLoad, singleValue);
-                        } else if ((var.params["Type"] == "unsigned char") || (var.params["Type"] == "uint8_t")) {
-                            auto fc = std::make_shared<UCharContainer>(UCharContainer());
-                            inquireRead<unsigned char>(fc, var, frameIDtoLoad, singleValue);
-                        } else if (var.params["Type"] == "uint32_t") {
-                            auto fc = std::make_shared<UInt32Container>(UInt32Container());
-                            inquireRead<uint32_t>(fc, var, frameIDtoLoad, singleValue);
-                        } else if (var.params["Type"] == "string") {
-                            auto fc = std::make_shared<StringContainer>(StringContainer());
-                            inquireRead<std::string>(fc, var, frameIDtoLoad, singleValue);
-                        }
-                    }
+
+            // the engine is free again afterwards, the prefetched step may already be the requested one
+            this->finishPrefetch(req, frameIDtoLoad);
+
+            if (this->streamingOpened) {
+                if (frameIDtoLoad < this->streamStep) {
+                    megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                        "[adiosDataSource] Step %zu has already been passed, returning step %zu instead",
+                        frameIDtoLoad, this->streamStep.load());
+                    frameIDtoLoad = this->streamStep;
+                } else if (!this->advanceStream(frameIDtoLoad)) {
+                    // without an open step nothing new can be read, keep serving the last step that was read
+                    frameIDtoLoad = (this->stepOpen || dataFrameID < 0) ? this->streamStep.load()
+                                                                         : static_cast<size_t>(dataFrameID);
+                    megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                        "[adiosDataSource] Stream ended before step %zu, returning step %zu instead",
+                        cad->getFrameIDtoLoad(), frameIDtoLoad);
                 }
             }
-            megamol::core::utility::log::Log::DefaultLog.WriteInfo("[adiosDataSource] PerformGets");
-            const auto t1 = std::chrono::high_resolution_clock::now();
-            reader->PerformGets();
-            const auto t2 = std::chrono::high_resolution_clock::now();
-            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-            megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-                "[adiosDataSource] Time spent for reading frame: %d ms", duration);
+
+            if (dataFrameID != static_cast<long long int>(frameIDtoLoad)) {
+                this->dataMap.clear();
+                this->dataSelections.clear();
+            }
+            if (!this->streamingOpened || this->stepOpen) {
+                this->readStep(req, frameIDtoLoad, this->dataMap, this->dataSelections);
+            } else if (!this->isLoaded(req)) {
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    "[adiosDataSource] Stream has ended, cannot read further variables.");
+            }
+            dataFrameID = frameIDtoLoad;
 
             loadedFrameID = frameIDtoLoad;
             cad->setLoadedFrameID(loadedFrameID);
             // here data is loaded
+
+            if (this->prefetchSlot.Param<core::param::BoolParam>()->Value()) {
+                if (this->streamingOpened ? (this->stepOpen && !this->endOfStream)
+                                          : (frameIDtoLoad + 1 < frameCount)) {
+                    this->startPrefetch(req, frameIDtoLoad + 1);
+                }
+            }
         } catch (std::invalid_argument& e) {
 #ifdef MEGAMOL_USE_MPI
             megamol::core::utility::log::Log::DefaultLog.WriteError(
@@ -248,6 +250,194 @@ bool adiosDataSource::getDataCallback(core::Call& caller) {
 }
 
 
+/*
+ * adiosDataSource::isLoaded
+ */
+bool adiosDataSource::isLoaded(const ReadRequest& req) const {
+    for (auto const& name : req.names) {
+        if (this->dataMap.find(name) == this->dataMap.end()) {
+            return false;
+        }
+        auto const sel = req.selections.find(name);
+        auto const loaded = this->dataSelections.find(name);
+        auto const requested = sel != req.selections.end() ? sel->second : adiosSelection();
+        if (loaded == this->dataSelections.end() || loaded->second != requested) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * adiosDataSource::readStep
+ */
+bool adiosDataSource::readStep(const ReadRequest& req, size_t step, adiosDataMap& target,
+    std::map<std::string, adiosSelection>& targetSelections) {
+    std::vector<adios2Params> content = variables;
+    content.insert(content.end(), attributes.begin(), attributes.end());
+
+    bool requested = false;
+    for (auto const& toInq : req.names) {
+        auto const selIt = req.selections.find(toInq);
+        auto const sel = selIt != req.selections.end() ? selIt->second : adiosSelection();
+        auto const loaded = targetSelections.find(toInq);
+        if (target.find(toInq) != target.end() && loaded != targetSelections.end() && loaded->second == sel) {
+            continue;
+        }
+        for (auto var : content) {
+            if (var.name == toInq) {
+                bool singleValue = true;
+                if (var.params["SingleValue"] != std::string("true")) {
+                    singleValue = false;
+                }
+                auto const& type = var.params["Type"];
+                auto const dist = req.distributeBlocks;
+                if (type == "float") {
+                    auto fc = std::make_shared<FloatContainer>(FloatContainer());
+                    inquireRead<float>(fc, var, step, singleValue, sel, dist, target);
+                } else if (type == "double") {
+                    auto fc = std::make_shared<DoubleContainer>(DoubleContainer());
+                    inquireRead<double>(fc, var, step, singleValue, sel, dist, target);
+                } else if (type == "int32_t") {
+                    auto fc = std::make_shared<Int32Container>(Int32Container());
+                    inquireRead<int32_t>(fc, var, step, singleValue, sel, dist, target);
+                } else if (type == "int8_t" || type == "char") {
+                    auto fc = std::make_shared<CharContainer>(CharContainer());
+                    inquireRead<char>(fc, var, step, singleValue, sel, dist, target);
+                } else if (type == "uint64_t") {
+                    auto fc = std::make_shared<UInt64Container>(UInt64Container());
+                    inquireRead<uint64_t>(fc, var, step, singleValue, sel, dist, target);
+                } else if ((type == "unsigned char") || (type == "uint8_t")) {
+                    auto fc = std::make_shared<UCharContainer>(UCharContainer());
+                    inquireRead<unsigned char>(fc, var, step, singleValue, sel, dist, target);
+                } else if (type == "uint32_t") {
+                    auto fc = std::make_shared<UInt32Container>(UInt32Container());
+                    inquireRead<uint32_t>(fc, var, step, singleValue, sel, dist, target);
+                } else if (type == "string") {
+                    auto fc = std::make_shared<StringContainer>(StringContainer());
+                    inquireRead<std::string>(fc, var, step, singleValue, sel, dist, target);
+                } else {
+                    continue;
+                }
+                targetSelections[toInq] = sel;
+                requested = true;
+            }
+        }
+    }
+    if (!requested) {
+        return true;
+    }
+
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo("[adiosDataSource] PerformGets");
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    reader->PerformGets();
+    const auto t2 = std::chrono::high_resolution_clock::now();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "[adiosDataSource] Time spent for reading frame %zu: %d ms", step, duration);
+    return true;
+}
+
+
+/*
+ * adiosDataSource::beginStream
+ */
+void adiosDataSource::beginStream() {
+    this->stepOpen = this->reader->BeginStep() == adios2::StepStatus::OK;
+    this->endOfStream = !this->stepOpen;
+    this->streamStep = this->stepOpen ? this->reader->CurrentStep() : 0;
+}
+
+
+/*
+ * adiosDataSource::advanceStream
+ */
+bool adiosDataSource::advanceStream(size_t step) {
+    while (this->stepOpen && this->streamStep < step) {
+        this->reader->EndStep();
+        this->stepOpen = false;
+        if (this->reader->BeginStep() != adios2::StepStatus::OK) {
+            this->endOfStream = true;
+            return false;
+        }
+        this->stepOpen = true;
+        this->streamStep = this->reader->CurrentStep();
+    }
+    return this->stepOpen && this->streamStep == step;
+}
+
+
+/*
+ * adiosDataSource::startPrefetch
+ */
+void adiosDataSource::startPrefetch(const ReadRequest& req, size_t step) {
+    this->prefetchStep = step;
+    this->prefetchDistributed = req.distributeBlocks;
+    this->prefetchMap.clear();
+    this->prefetchSelections.clear();
+    // the engine belongs to the background read until finishPrefetch or dropPrefetch
+    this->prefetch = std::async(std::launch::async, [this, req, step]() {
+        try {
+            if (this->streamingOpened && !this->advanceStream(step)) {
+                return false;
+            }
+            return this->readStep(req, step, this->prefetchMap, this->prefetchSelections);
+        } catch (std::exception& e) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError(
+                "[adiosDataSource] Reading step %zu in the background failed: %s", step, e.what());
+            return false;
+        }
+    });
+}
+
+
+/*
+ * adiosDataSource::finishPrefetch
+ */
+void adiosDataSource::finishPrefetch(const ReadRequest& req, size_t step) {
+    if (!this->prefetch.valid()) {
+        return;
+    }
+    const bool ok = this->prefetch.get();
+    // a stream is at the prefetched step now, so it serves all steps before as well
+    const bool matches = this->streamingOpened ? (step <= this->prefetchStep) : (step == this->prefetchStep);
+    if (ok && matches && (req.distributeBlocks == this->prefetchDistributed)) {
+        this->dataMap.swap(this->prefetchMap);
+        this->dataSelections.swap(this->prefetchSelections);
+        this->dataFrameID = this->prefetchStep;
+    }
+    this->prefetchMap.clear();
+    this->prefetchSelections.clear();
+}
+
+
+/*
+ * adiosDataSource::dropPrefetch
+ */
+void adiosDataSource::dropPrefetch() {
+    if (this->prefetch.valid()) {
+        this->prefetch.wait();
+        this->prefetch = std::future<bool>();
+    }
+    this->prefetchMap.clear();
+    this->prefetchSelections.clear();
+}
+
+
+/*
+ * adiosDataSource::distributionChanged
+ */
+bool adiosDataSource::distributionChanged(core::param::ParamSlot& slot) {
+    this->dropPrefetch();
+    this->dataMap.clear();
+    this->dataSelections.clear();
+    this->dataFrameID = -1;
+
+    return true;
+}
+
+
 /*
  * adiosDataSource::filenameChanged
  */
@@ -266,8 +456,18 @@ bool adiosDataSource::getHeaderCallback(core::Call& caller) {
 
     if (dataHashChanged || loadedFrameID != cad->getFrameIDtoLoad() || this->filenameSlot.IsDirty()) {
         this->filenameSlot.ResetDirty();
-        if (loadedFrameID != cad->getFrameIDtoLoad())
+        // the engine must not be used while the background read runs
+        if (dataHashChanged) {
+            this->dropPrefetch();
+        } else if (this->prefetch.valid()) {
+            this->prefetch.wait();
+        }
+        // a stream cannot seek back, its last step has to stay available until the data callback moves on
+        if (!this->streamingOpened && loadedFrameID != cad->getFrameIDtoLoad()) {
             this->dataMap.clear();
+            this->dataSelections.clear();
+            this->dataFrameID = -1;
+        }
 
         try {
             megamol::core::utility::log::Log::DefaultLog.WriteInfo("[adiosDataSource] Setting Engine");
@@ -287,13 +487,25 @@ bool adiosDataSource::getHeaderCallback(core::Call& caller) {
                 megamol::core::utility::log::Log::DefaultLog.WriteError("[adiosDataSource] File does not exist.");
                 return false;
             }
+            const bool reopen = !this->reader || dataHashChanged;
             if (this->reader && dataHashChanged) {
+                if (this->stepOpen) {
+                    this->reader->EndStep();
+                    this->stepOpen = false;
+                }
                 this->reader->Close();
                 io->RemoveAllVariables();
                 io->RemoveAllAttributes();
+            }
+            if (reopen) {
                 this->reader = std::make_shared<adios2::Engine>(io->Open(fname, adios2::Mode::Read));
-            } else if (!this->reader) {
-                this->reader = std::make_shared<adios2::Engine>(io->Open(fname, adios2::Mode::Read));
+                this->dataMap.clear();
+                this->dataSelections.clear();
+                this->dataFrameID = -1;
+                this->streamingOpened = this->streamingSlot.Param<core::param::BoolParam>()->Value();
+                if (this->streamingOpened) {
+                    this->beginStream();
+                }
             }
 
 
@@ -387,6 +599,15 @@ bool adiosDataSource::getHeaderCallback(core::Call& caller) {
     } else {
         frameCount = timesteps[0];
     }
+    if (this->streamingOpened) {
+        // the length of a stream is unknown, offer the step after the current one until it has ended
+        if (!this->endOfStream) {
+            frameCount = this->streamStep + 2;
+        } else {
+            // steps skipped on the way to the end cannot be read anymore, the last one read stays the final frame
+            frameCount = this->dataFrameID >= 0 ? this->dataFrameID + 1 : this->streamStep + 1;
+        }
+    }
     cad->setFrameCount(frameCount);
 
     cad->setDataHash(this->data_hash);
@@ -9,6 +9,10 @@
 #include "vislib/String.h"
 #include "vislib/math/Cuboid.h"
 #include <adios2.h>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <numeric>
 #ifdef MEGAMOL_USE_MPI
 #include <mpi.h>
 #endif
@@ -86,9 +90,48 @@ private:
 
     vislib::StringA getCommandLine();
     bool filenameChanged(core::param::ParamSlot& slot);
+    bool distributionChanged(core::param::ParamSlot& slot);
+
+    /** The variables and attributes to read for a step */
+    struct ReadRequest {
+        std::vector<std::string> names;
+        std::map<std::string, adiosSelection> selections;
+        /** Read only the blocks of this rank of variables without selection */
+        bool distributeBlocks = false;
+    };
+
+    /** Answer whether all of 'req' is in the data map with the requested selections. */
+    bool isLoaded(const ReadRequest& req) const;
+
+    /**
+     * Reads the variables of 'req' that are not in 'target' with the same
+     * selection yet. All of them are requested deferred and transferred by a
+     * single PerformGets.
+     */
+    bool readStep(const ReadRequest& req, size_t step, adiosDataMap& target,
+        std::map<std::string, adiosSelection>& targetSelections);
+
+    /** Begins the first step of a freshly opened stream. */
+    void beginStream();
+
+    /** Moves the stream forward to 'step', answer 'false' if the stream ends before. */
+    bool advanceStream(size_t step);
+
+    /** Starts reading 'step' for 'req' in the background. */
+    void startPrefetch(const ReadRequest& req, size_t step);
+
+    /**
+     * Waits for the background read. If it read 'step' for the same block
+     * distribution, its data becomes the data map, otherwise it is dropped.
+     */
+    void finishPrefetch(const ReadRequest& req, size_t step);
+
+    /** Drops the background read, e.g. before reopening the file. */
+    void dropPrefetch();
 
     template<typename T, typename C>
-    void inquireRead(C container, const adios2Params var, const size_t frameIDtoLoad, const bool singleValue);
+    void inquireRead(C container, const adios2Params var, const size_t frameIDtoLoad, const bool singleValue,
+        const adiosSelection& sel, const bool distributeBlocks, adiosDataMap& target);
 
     /** The slot for requesting data */
     core::CalleeSlot getData;
@@ -104,6 +147,15 @@ private:
     /** The file name */
     core::param::ParamSlot filenameSlot;
 
+    /** Read the steps in order with BeginStep/EndStep instead of random access */
+    core::param::ParamSlot streamingSlot;
+
+    /** Read the next step in the background */
+    core::param::ParamSlot prefetchSlot;
+
+    /** Distribute the written blocks over the MPI ranks */
+    core::param::ParamSlot blockDistributionSlot;
+
     size_t frameCount = 0;
     long long int loadedFrameID = -1;
 
@@ -115,6 +167,23 @@ private:
     std::map<std::string, std::map<std::string, std::string>> allVariables;
     std::vector<adios2Params> attributes;
     adiosDataMap dataMap;
+    /** The selections the entries of dataMap were read with */
+    std::map<std::string, adiosSelection> dataSelections;
+    /** The step dataMap belongs to */
+    long long int dataFrameID = -1;
+
+    /** Streaming state, updated by the background read while it runs */
+    bool streamingOpened = false;
+    bool stepOpen = false;
+    std::atomic<bool> endOfStream = false;
+    std::atomic<size_t> streamStep = 0;
+
+    /** The background read of the next step */
+    std::future<bool> prefetch;
+    size_t prefetchStep = 0;
+    bool prefetchDistributed = false;
+    adiosDataMap prefetchMap;
+    std::map<std::string, adiosSelection> prefetchSelections;
 
     std::vector<std::size_t> timesteps;
     std::vector<std::string> availVars;
@@ -122,30 +191,89 @@ private:
 };
 
 template<typename T, typename C>
-void adiosDataSource::inquireRead(
-    C container, const adios2Params var, const size_t frameIDtoLoad, const bool singleValue) {
+void adiosDataSource::inquireRead(C container, const adios2Params var, const size_t frameIDtoLoad,
+    const bool singleValue, const adiosSelection& sel, const bool distributeBlocks, adiosDataMap& target) {
     container->singleValue = singleValue;
     std::vector<T>& tmp_vec = container->getVec();
     size_t num = 1;
+    auto const elements = [](const adios2::Dims& dims) {
+        return std::accumulate(dims.begin(), dims.end(), size_t(1), std::multiplies<size_t>());
+    };
 
     if (var.isAttribute) {
         auto advar = io->InquireAttribute<T>(var.name);
         tmp_vec = advar.Data();
     } else {
         auto advar = io->InquireVariable<T>(var.name);
-        advar.SetStepSelection({frameIDtoLoad, 1});
-        container->shape = advar.Shape(frameIDtoLoad);
+        // a stream only offers its current step
+        if (!streamingOpened) {
+            advar.SetStepSelection({frameIDtoLoad, 1});
+        }
+        const size_t step = streamingOpened ? reader->CurrentStep() : frameIDtoLoad;
+        container->shape = streamingOpened ? advar.Shape() : advar.Shape(frameIDtoLoad);
         if (container->shape.empty()) {
             container->shape = {advar.Count()};
         }
-        if (!singleValue) {
-            advar.SetSelection({advar.Start(), container->shape});
+
+        std::vector<size_t> blocks = sel.blocks;
+#ifdef MEGAMOL_USE_MPI
+        if (blocks.empty() && sel.count.empty() && distributeBlocks && !singleValue && mpiSize > 1) {
+            auto const blockCount = reader->BlocksInfo(advar, step).size();
+            for (size_t b = mpiRank; b < blockCount; b += mpiSize) {
+                blocks.push_back(b);
+            }
+            if (blocks.empty()) {
+                container->shape = {0};
+                tmp_vec.clear();
+                target[var.name] = std::move(container);
+                return;
+            }
         }
-        std::for_each(container->shape.begin(), container->shape.end(), [&](decltype(num) n) { num *= n; });
-        tmp_vec.resize(num);
+#endif
 
-        reader->Get<T>(advar, tmp_vec);
+        if (!blocks.empty() && !singleValue) {
+            // the blocks are concatenated into one flat array
+            auto const info = reader->BlocksInfo(advar, step);
+            size_t total = 0;
+            for (auto const id : blocks) {
+                if (id < info.size()) {
+                    total += info[id].IsValue ? 1 : elements(info[id].Count);
+                }
+            }
+            tmp_vec.resize(total);
+            container->shape = {tmp_vec.size()};
+            size_t offset = 0;
+            for (auto const id : blocks) {
+                if (id >= info.size()) {
+                    megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                        "[adiosDataSource] Variable %s has no block %zu", var.name.c_str(), id);
+                    continue;
+                }
+                advar.SetBlockSelection(id);
+                reader->Get<T>(advar, tmp_vec.data() + offset, adios2::Mode::Deferred);
+                offset += info[id].IsValue ? 1 : elements(info[id].Count);
+            }
+        } else {
+            if (!singleValue) {
+                if (!sel.count.empty() && sel.start.size() == container->shape.size() &&
+                    sel.count.size() == container->shape.size()) {
+                    advar.SetSelection({sel.start, sel.count});
+                    container->shape = sel.count;
+                } else {
+                    if (!sel.count.empty()) {
+                        megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                            "[adiosDataSource] Selection of %s does not match its dimensions, reading all of it",
+                            var.name.c_str());
+                    }
+                    advar.SetSelection({advar.Start(), container->shape});
+                }
+            }
+            num = elements(container->shape);
+            tmp_vec.resize(num);
+
+            reader->Get<T>(advar, tmp_vec, adios2::Mode::Deferred);
+        }
     }
-    dataMap[var.name] = std::move(container);
+    target[var.name] = std::move(container);
 }
 } // namespace megamol::adios
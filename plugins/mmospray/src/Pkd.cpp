@@ -4,23 +4,57 @@
  */
 
 #include "Pkd.h"
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <stdint.h>
-#include <thread>
 
-#define POS(idx, dim) pos(idx, dim)
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/utility/log/Log.h"
 
 using namespace megamol;
 
+namespace {
+
+//! subtrees with more particles than this are built in parallel tasks
+constexpr size_t parallelGrainSize = 1 << 15;
+
+//! particles per task when computing the fingerprint
+constexpr size_t fingerprintChunkSize = 1 << 20;
+
+constexpr uint64_t fnvOffsetBasis = 0xcbf29ce484222325ull;
+constexpr uint64_t fnvPrime = 0x100000001b3ull;
+
+inline uint64_t fnvMix(uint64_t h, uint64_t v) {
+    return (h ^ v) * fnvPrime;
+}
+
+constexpr char mmpldMagic[6] = {'M', 'M', 'P', 'L', 'D', '\0'};
+constexpr uint16_t mmpldVersion = 100;
+
+} // namespace
+
 
 ospray::PkdBuilder::PkdBuilder()
         : megamol::datatools::AbstractParticleManipulator("outData", "inData")
+        , sidecarDirectorySlot("sidecarDirectory",
+              "Directory for PKD-sorted MMPLD files of processed frames, which are loaded instead of rebuilding the "
+              "tree. Leave empty to always build.")
         , inDataHash(std::numeric_limits<size_t>::max())
         , outDataHash(0)
+        , frameID(std::numeric_limits<unsigned int>::max())
 /*, numParticles(0)
 , numInnerNodes(0)*/
 {
     //model = std::make_shared<ParticleModel>();
+    this->sidecarDirectorySlot << new core::param::FilePathParam(
+        "", core::param::FilePathParam::Flag_Directory_ToBeCreated);
+    this->MakeSlotAvailable(&this->sidecarDirectorySlot);
 }
 
 ospray::PkdBuilder::~PkdBuilder() {
@@ -29,34 +63,58 @@ ospray::PkdBuilder::~PkdBuilder() {
 
 bool ospray::PkdBuilder::manipulateData(
     geocalls::MultiParticleDataCall& outData, geocalls::MultiParticleDataCall& inData) {
+    using megamol::core::utility::log::Log;
 
-    if ((inData.DataHash() != inDataHash) || (inData.FrameID() != frameID)) {
+    if ((inData.DataHash() != inDataHash) || (inData.FrameID() != frameID) || sidecarDirectorySlot.IsDirty()) {
         inDataHash = inData.DataHash();
         //outDataHash++;
         frameID = inData.FrameID();
+        sidecarDirectorySlot.ResetDirty();
 
         outData = inData;
 
         models.resize(inData.GetParticleListCount());
 
+        for (unsigned int i = 0; i < inData.GetParticleListCount(); ++i) {
+            // empty the model and put the data into it
+            models[i].position.clear();
+            models[i].fill(inData.AccessParticles(i));
+        }
+
+        std::filesystem::path sidecar;
+        if (!sidecarDirectorySlot.Param<core::param::FilePathParam>()->Value().empty()) {
+            sidecar = sidecarPath(fingerprint(models));
+        }
+
+        if (sidecar.empty() || !readSidecar(sidecar, models)) {
+            // build the pkd trees
+            for (auto& model : models) {
+                if (model.position.empty()) {
+                    continue;
+                }
+                Pkd pkd;
+                pkd.model = &model;
+                pkd.build();
+            }
+            if (!sidecar.empty()) {
+                writeSidecar(sidecar, inData, models);
+            }
+        } else {
+            Log::DefaultLog.WriteInfo(
+                "PkdBuilder: loaded frame %u from %s", frameID, sidecar.generic_u8string().c_str());
+        }
+
         for (unsigned int i = 0; i < inData.GetParticleListCount(); ++i) {
             auto& parts = inData.AccessParticles(i);
             auto& out = outData.AccessParticles(i);
 
-            // empty the model
-            // this->model->position.clear();
-            models[i].position.clear();
-
-            // put data the data into the model
-            // and build the pkd tree
-            // this->model->fill(parts);
-            models[i].fill(parts);
-            // this->build();
-            Pkd pkd;
-            pkd.model = &models[i];
-            pkd.build();
+            if (models[i].position.empty()) {
+                out.SetCount(0);
+                out.SetVertexData(megamol::geocalls::SimpleSphericalParticles::VERTDATA_NONE, nullptr);
+                continue;
+            }
 
-            out.SetCount(parts.GetCount());
+            out.SetCount(models[i].position.size());
             out.SetVertexData(
                 megamol::geocalls::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ, &models[i].position[0].x, 16);
             out.SetColourData(
@@ -71,6 +129,174 @@ bool ospray::PkdBuilder::manipulateData(
 }
 
 
+uint64_t ospray::PkdBuilder::fingerprint(std::vector<ParticleModel> const& models) {
+    uint64_t fp = fnvOffsetBasis;
+    for (auto const& model : models) {
+        const size_t cnt = model.position.size();
+        fp = fnvMix(fp, cnt);
+
+        // FNV-1a over 64 bit words, chunk-wise in parallel and combined in order
+        std::vector<uint64_t> chunkHashes((cnt + fingerprintChunkSize - 1) / fingerprintChunkSize);
+        tbb::parallel_for(size_t(0), chunkHashes.size(), [&](size_t c) {
+            const size_t first = c * fingerprintChunkSize;
+            const size_t last = std::min(cnt, first + fingerprintChunkSize);
+            uint64_t h = fnvOffsetBasis;
+            for (size_t i = first; i < last; ++i) {
+                uint64_t words[2];
+                std::memcpy(words, &model.position[i], sizeof(words));
+                h = fnvMix(fnvMix(h, words[0]), words[1]);
+            }
+            chunkHashes[c] = h;
+        });
+        for (auto const h : chunkHashes) {
+            fp = fnvMix(fp, h);
+        }
+    }
+    return fp;
+}
+
+
+std::filesystem::path ospray::PkdBuilder::sidecarPath(uint64_t fp) const {
+    std::ostringstream name;
+    name << "pkd_" << std::hex << std::setw(16) << std::setfill('0') << fp << ".mmpld";
+    return sidecarDirectorySlot.Param<core::param::FilePathParam>()->Value() / name.str();
+}
+
+
+bool ospray::PkdBuilder::readSidecar(std::filesystem::path const& path, std::vector<ParticleModel>& models) const {
+    using megamol::core::utility::log::Log;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char magic[6];
+    uint16_t version = 0;
+    uint32_t frameCnt = 0;
+    file.read(magic, 6);
+    file.read(reinterpret_cast<char*>(&version), 2);
+    file.read(reinterpret_cast<char*>(&frameCnt), 4);
+    // skip the bounding boxes and the seek table
+    file.seekg(2 * 6 * 4 + 2 * 8, std::ios::cur);
+    uint32_t listCnt = 0;
+    file.read(reinterpret_cast<char*>(&listCnt), 4);
+    if (!file || std::memcmp(magic, mmpldMagic, 6) != 0 || version != mmpldVersion || frameCnt != 1 ||
+        listCnt != models.size()) {
+        Log::DefaultLog.WriteWarn("PkdBuilder: ignoring invalid sidecar %s", path.generic_u8string().c_str());
+        return false;
+    }
+
+    // read into scratch buffers first, so a broken file leaves the models untouched
+    std::vector<std::vector<rkcommon::math::vec4f>> positions(listCnt);
+    for (uint32_t i = 0; i < listCnt; ++i) {
+        uint8_t vt = 0, ct = 0;
+        float radius = 0.0f;
+        uint8_t colour[4];
+        uint64_t cnt = 0;
+        file.read(reinterpret_cast<char*>(&vt), 1);
+        file.read(reinterpret_cast<char*>(&ct), 1);
+        if (vt == 1) {
+            file.read(reinterpret_cast<char*>(&radius), 4);
+        }
+        if (ct == 0) {
+            file.read(reinterpret_cast<char*>(colour), 4);
+        }
+        file.read(reinterpret_cast<char*>(&cnt), 8);
+        const bool layoutMatches = (vt == 1 && ct == 2) || (vt == 0 && cnt == 0);
+        if (!file || !layoutMatches || cnt != models[i].position.size()) {
+            Log::DefaultLog.WriteWarn(
+                "PkdBuilder: sidecar %s does not match the data", path.generic_u8string().c_str());
+            return false;
+        }
+        positions[i].resize(cnt);
+        file.read(reinterpret_cast<char*>(positions[i].data()), cnt * sizeof(rkcommon::math::vec4f));
+        if (!file) {
+            Log::DefaultLog.WriteWarn("PkdBuilder: sidecar %s is truncated", path.generic_u8string().c_str());
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < listCnt; ++i) {
+        models[i].position.swap(positions[i]);
+    }
+    return true;
+}
+
+
+bool ospray::PkdBuilder::writeSidecar(std::filesystem::path const& path, geocalls::MultiParticleDataCall& data,
+    std::vector<ParticleModel> const& models) const {
+    using megamol::core::utility::log::Log;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // write to a temporary file first, so concurrent readers never see a partial sidecar
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            Log::DefaultLog.WriteError("PkdBuilder: cannot create sidecar %s", tmpPath.generic_u8string().c_str());
+            return false;
+        }
+
+        const uint32_t frameCnt = 1;
+        file.write(mmpldMagic, 6);
+        file.write(reinterpret_cast<const char*>(&mmpldVersion), 2);
+        file.write(reinterpret_cast<const char*>(&frameCnt), 4);
+        auto const& bboxes = data.AccessBoundingBoxes();
+        file.write(reinterpret_cast<const char*>(bboxes.ObjectSpaceBBox().PeekBounds()), 6 * 4);
+        file.write(reinterpret_cast<const char*>(bboxes.ObjectSpaceClipBox().PeekBounds()), 6 * 4);
+
+        const uint64_t seekTable = static_cast<uint64_t>(file.tellp());
+        uint64_t frameOffset = seekTable + 2 * 8;
+        file.write(reinterpret_cast<const char*>(&frameOffset), 8);
+        file.write(reinterpret_cast<const char*>(&frameOffset), 8); // end of frame, patched below
+
+        const uint32_t listCnt = static_cast<uint32_t>(models.size());
+        file.write(reinterpret_cast<const char*>(&listCnt), 4);
+        for (uint32_t i = 0; i < listCnt; ++i) {
+            const uint64_t cnt = models[i].position.size();
+            const uint8_t vt = (cnt > 0) ? 1 : 0; // VERTDATA_FLOAT_XYZ, the colour is packed into w
+            const uint8_t ct = (cnt > 0) ? 2 : 0; // COLDATA_UINT8_RGBA
+            file.write(reinterpret_cast<const char*>(&vt), 1);
+            file.write(reinterpret_cast<const char*>(&ct), 1);
+            if (vt == 1) {
+                const float radius = data.AccessParticles(i).GetGlobalRadius();
+                file.write(reinterpret_cast<const char*>(&radius), 4);
+            }
+            if (ct == 0) {
+                const uint8_t colour[4] = {255, 255, 255, 255};
+                file.write(reinterpret_cast<const char*>(colour), 4);
+            }
+            file.write(reinterpret_cast<const char*>(&cnt), 8);
+            file.write(reinterpret_cast<const char*>(models[i].position.data()), cnt * sizeof(rkcommon::math::vec4f));
+        }
+
+        frameOffset = static_cast<uint64_t>(file.tellp());
+        file.seekp(seekTable + 8);
+        file.write(reinterpret_cast<const char*>(&frameOffset), 8);
+
+        if (!file) {
+            Log::DefaultLog.WriteError("PkdBuilder: writing sidecar %s failed", tmpPath.generic_u8string().c_str());
+            file.close();
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        Log::DefaultLog.WriteError(
+            "PkdBuilder: cannot move sidecar to %s: %s", path.generic_u8string().c_str(), ec.message().c_str());
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+
 void ospray::Pkd::setDim(size_t ID, int dim) const {
 #if DIM_FROM_DEPTH
     return;
@@ -96,8 +322,13 @@ inline size_t ospray::Pkd::maxDim(const rkcommon::math::vec3f& v) const {
 }
 
 
-inline void ospray::Pkd::swap(const size_t a, const size_t b) const {
-    std::swap(model->position[a], model->position[b]);
+size_t ospray::Pkd::subtreeSize(const size_t nodeID) const {
+    // the nodes of a subtree form one contiguous run per level
+    size_t size = 0;
+    for (size_t first = nodeID, width = 1; isValidNode(first); first = leftChildOf(first), width *= 2) {
+        size += std::min(width, numParticles - first);
+    }
+    return size;
 }
 
 
@@ -110,15 +341,6 @@ void ospray::Pkd::build() {
     numParticles = model->position.size();
     assert(numParticles <= (1ULL << 31));
 
-#if 0
-    cout << "#osp:pkd: TEST: RANDOMIZING PARTICLES" << endl;
-    for (size_t i = numParticles - 1; i>0; --i) {
-        size_t j = size_t(drand48()*i);
-        if (i != j) swap(i, j);
-    }
-    cout << "#osp:pkd: RANDOMIZED" << endl;
-#endif
-
     numInnerNodes = numInnerNodesOf(numParticles);
 
     // determine num levels
@@ -130,123 +352,49 @@ void ospray::Pkd::build() {
     }
     // PRINT(numLevels);
 
-    const rkcommon::math::box3f& bounds = model->getBounds();
-    /*std::cout << "#osp:pkd: bounds of model " << bounds << std::endl;
-    std::cout << "#osp:pkd: number of input particles " << numParticles << std::endl;*/
-    this->buildRec(0, bounds, 0);
+    const rkcommon::math::box3f bounds = model->getBounds();
+
+    // the particles are partitioned in a scratch copy, each median is moved to its final node in the model
+    std::vector<rkcommon::math::vec4f> particles;
+    particles.swap(model->position);
+    model->position.resize(numParticles);
+
+    this->buildRec(0, particles.data(), particles.data() + numParticles, bounds);
 }
 
 
-void ospray::Pkd::buildRec(const size_t nodeID, const rkcommon::math::box3f& bounds, const size_t depth) const {
-    // if (depth < 4)
-    // std::cout << "#osp:pkd: building subtree " << nodeID << std::endl;
-    if (!hasLeftChild(nodeID))
-        // has no children -> it's a valid kd-tree already :-)
+void ospray::Pkd::buildRec(const size_t nodeID, rkcommon::math::vec4f* begin, rkcommon::math::vec4f* end,
+    const rkcommon::math::box3f& bounds) const {
+    if (begin == end) {
         return;
+    }
+    assert(static_cast<size_t>(end - begin) == subtreeSize(nodeID));
 
-    // we have at least one child.
-    const size_t dim = this->maxDim(bounds.size());
-    // if (depth < 4) { PRINT(bounds); printf("depth %ld-> dim %ld\n",depth,dim); }
-    const size_t N = numParticles;
-
-    if (!hasRightChild(nodeID)) {
-        // no right child, but not a leaf emtpy. must have exactly one
-        // child on the left. see if we have to swap, but otherwise
-        // nothing to do.
-        size_t lChild = leftChildOf(nodeID);
-        if (POS(lChild, dim) > POS(nodeID, dim))
-            swap(nodeID, lChild);
-        // and done
-        setDim(nodeID, dim);
+    if (!hasLeftChild(nodeID)) {
+        // has no children -> it's a valid kd-tree already :-)
+        model->position[nodeID] = *begin;
         return;
     }
 
-    {
-
-        // we have a left and a right subtree, each of at least 1 node.
-        SubtreeIterator l0(leftChildOf(nodeID));
-        SubtreeIterator r0(rightChildOf(nodeID));
-
-        SubtreeIterator l((size_t)l0); //(leftChildOf(nodeID));
-        SubtreeIterator r((size_t)r0); //(rightChildOf(nodeID));
-
-        // size_t numSwaps = 0, numComps = 0;
-        float rootPos = POS(nodeID, dim);
-        while (1) {
-
-            while (isValidNode(l, N) && (POS(l, dim) <= rootPos))
-                ++l;
-            while (isValidNode(r, N) && (POS(r, dim) >= rootPos))
-                ++r;
+    // the left subtree gets the particles below the median, the right one those above
+    const size_t dim = this->maxDim(bounds.size());
+    rkcommon::math::vec4f* median = begin + subtreeSize(leftChildOf(nodeID));
+    std::nth_element(begin, median, end,
+        [dim](rkcommon::math::vec4f const& a, rkcommon::math::vec4f const& b) { return a[dim] < b[dim]; });
 
-            if (isValidNode(l, N)) {
-                if (isValidNode(r, N)) {
-                    // both mis-mathces valid, just swap them and go on
-                    swap(l, r);
-                    ++l;
-                    ++r;
-                    continue;
-                } else {
-                    // mis-match on left side, but nothing on right side to swap with: swap with root
-                    // --> can't go on on right side any more, but can still compact matches on left
-                    l0 = l;
-                    ++l;
-                    while (isValidNode(l, N)) {
-                        if (POS(l, dim) <= rootPos) {
-                            swap(l0, l);
-                            ++l0;
-                        }
-                        ++l;
-                    }
-                    swap(nodeID, l0);
-                    ++l0;
-                    rootPos = POS(nodeID, dim);
-
-                    l = l0;
-                    r = r0;
-                    continue;
-                }
-            } else {
-                if (isValidNode(r, N)) {
-                    // mis-match on left side, but nothing on right side to swap with: swap with root
-                    // --> can't go on on right side any more, but can still compact matches on left
-                    r0 = r;
-                    ++r;
-                    while (isValidNode(r, N)) {
-                        if (POS(r, dim) >= rootPos) {
-                            swap(r0, r);
-                            ++r0;
-                        }
-                        ++r;
-                    }
-                    swap(nodeID, r0);
-                    ++r0;
-                    rootPos = POS(nodeID, dim);
-
-                    l = l0;
-                    r = r0;
-                    continue;
-                } else {
-                    // no mis-match on either side ... done.
-                    break;
-                }
-            }
-        }
-    }
+    model->position[nodeID] = *median;
+    setDim(nodeID, dim);
 
     rkcommon::math::box3f lBounds = bounds;
     rkcommon::math::box3f rBounds = bounds;
-
-    setDim(nodeID, dim);
-
     lBounds.upper[dim] = rBounds.lower[dim] = pos(nodeID, dim);
 
-    if ((numLevels - depth) > 20) {
-        std::thread lThread(&pkdBuildThread, new PKDBuildJob(this, leftChildOf(nodeID), lBounds, depth + 1));
-        buildRec(rightChildOf(nodeID), rBounds, depth + 1);
-        lThread.join();
+    // subtrees occupy disjoint ranges of the scratch buffer and disjoint nodes of the model
+    if (static_cast<size_t>(end - begin) > parallelGrainSize) {
+        tbb::parallel_invoke([&]() { buildRec(leftChildOf(nodeID), begin, median, lBounds); },
+            [&]() { buildRec(rightChildOf(nodeID), median + 1, end, rBounds); });
     } else {
-        buildRec(leftChildOf(nodeID), lBounds, depth + 1);
-        buildRec(rightChildOf(nodeID), rBounds, depth + 1);
+        buildRec(leftChildOf(nodeID), begin, median, lBounds);
+        buildRec(rightChildOf(nodeID), median + 1, end, rBounds);
     }
 }
@@ -8,8 +8,10 @@
 #include "datatools/AbstractParticleManipulator.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CallerSlot.h"
+#include "mmcore/param/ParamSlot.h"
 #include "rkcommon/math/box.h"
 #include "rkcommon/math/vec.h"
+#include <filesystem>
 #include <map>
 
 
@@ -48,6 +50,21 @@ protected:
     bool manipulateData(geocalls::MultiParticleDataCall& outData, geocalls::MultiParticleDataCall& inData) override;
 
 private:
+    /** Fingerprint of the unsorted particles of all lists, names the sidecar file */
+    static uint64_t fingerprint(std::vector<ParticleModel> const& models);
+
+    std::filesystem::path sidecarPath(uint64_t fp) const;
+
+    /** Replaces the particles of the models by the PKD-sorted ones from the sidecar if it matches */
+    bool readSidecar(std::filesystem::path const& path, std::vector<ParticleModel>& models) const;
+
+    /** Writes the PKD-sorted particles as single-frame MMPLD (v1.0) */
+    bool writeSidecar(std::filesystem::path const& path, geocalls::MultiParticleDataCall& data,
+        std::vector<ParticleModel> const& models) const;
+
+    /** Directory holding PKD-sorted MMPLD files of already processed frames, empty disables the cache */
+    core::param::ParamSlot sidecarDirectorySlot;
+
     size_t inDataHash;
     size_t outDataHash;
     unsigned int frameID;
@@ -89,65 +106,19 @@ struct Pkd {
         return model->position[nodeID][dim];
     }
 
-    //! helper function for building - swap two particles in the model
-    inline void swap(const size_t a, const size_t b) const;
-
     // save the given particle's split dimension
     void setDim(size_t ID, int dim) const;
     inline size_t maxDim(const rkcommon::math::vec3f& v) const;
 
+    //! number of nodes in the subtree below (and including) the given node
+    size_t subtreeSize(const size_t nodeID) const;
+
     //! build particle tree over given model. WILL REORDER THE MODEL'S ELEMENTS
     void build();
 
-    void buildRec(const size_t nodeID, const rkcommon::math::box3f& bounds, const size_t depth) const;
+    //! places the particles in [begin, end) into the subtree of nodeID, reorders the range
+    void buildRec(const size_t nodeID, rkcommon::math::vec4f* begin, rkcommon::math::vec4f* end,
+        const rkcommon::math::box3f& bounds) const;
 };
 
-
-struct SubtreeIterator {
-    size_t curInLevel;
-    size_t maxInLevel;
-    size_t current;
-
-    __forceinline SubtreeIterator(size_t root) : curInLevel(0), maxInLevel(1), current(root) {}
-
-    __forceinline operator size_t() const {
-        return current;
-    }
-
-    __forceinline void operator++() {
-        ++current;
-        ++curInLevel;
-        if (curInLevel == maxInLevel) {
-            current = leftChildOf(current - maxInLevel);
-            maxInLevel += maxInLevel;
-            curInLevel = 0;
-        }
-    }
-
-    __forceinline SubtreeIterator& operator=(const SubtreeIterator& other) {
-        curInLevel = other.curInLevel;
-        maxInLevel = other.maxInLevel;
-        current = other.current;
-        return *this;
-    }
-};
-
-struct PKDBuildJob {
-    const Pkd* const pkd;
-    const size_t nodeID;
-    const rkcommon::math::box3f bounds;
-    const size_t depth;
-    __forceinline PKDBuildJob(const Pkd* pkd, size_t nodeID, rkcommon::math::box3f bounds, size_t depth)
-            : pkd(pkd)
-            , nodeID(nodeID)
-            , bounds(bounds)
-            , depth(depth){};
-};
-
-static void pkdBuildThread(void* arg) {
-    PKDBuildJob* job = (PKDBuildJob*)arg;
-    job->pkd->buildRec(job->nodeID, job->bounds, job->depth);
-    delete job;
-}
-
 } // namespace megamol::ospray
@@ -7,6 +7,11 @@
 
 #include "mmcore/utility/log/Log.h"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <type_traits>
+
 using namespace megamol;
 
 
@@ -71,32 +76,56 @@ void megamol::ospray::ParticleModel::fill(geocalls::SimpleSphericalParticles par
         vertexLength = 4;
     }
 
-    auto const& parStore = parts.GetParticleStore();
-    auto const& xAcc = parStore.GetXAcc();
-    auto const& yAcc = parStore.GetYAcc();
-    auto const& zAcc = parStore.GetZAcc();
-    auto const& rAcc = parStore.GetCRAcc();
-    auto const& gAcc = parStore.GetCGAcc();
-    auto const& bAcc = parStore.GetCBAcc();
-    auto const& aAcc = parStore.GetCAAcc();
-
-    for (size_t loop = 0; loop < parts.GetCount(); ++loop) {
-
-        rkcommon::math::vec3f pos;
-
-        pos.x = xAcc->Get_f(loop);
-        pos.y = yAcc->Get_f(loop);
-        pos.z = zAcc->Get_f(loop);
-
-        rkcommon::math::vec4uc col;
-
-        col.x = rAcc->Get_u8(loop);
-        col.y = gAcc->Get_u8(loop);
-        col.z = bAcc->Get_u8(loop);
-        col.w = aAcc->Get_u8(loop);
-
-        float const color = encodeColorToFloat(col);
+    const size_t offset = this->position.size();
+    this->position.resize(offset + parts.GetCount());
+
+    // the data is read through the typed views, i.e. the type dispatch happens once per list and the
+    // particles are filled chunk-wise in parallel
+    auto const range = tbb::blocked_range<size_t>(0, parts.GetCount());
+
+    bool const hasColours = parts.VisitColourData([&](auto const& cols) {
+        using View = std::decay_t<decltype(cols)>;
+        using T = typename View::value_type;
+        tbb::parallel_for(range, [&](tbb::blocked_range<size_t> const& r) {
+            for (size_t loop = r.begin(); loop < r.end(); ++loop) {
+                rkcommon::math::vec4uc col(0);
+                col.x = static_cast<unsigned char>(cols.Get(loop, 0));
+                if constexpr (View::Components >= 3) {
+                    col.y = static_cast<unsigned char>(cols.Get(loop, 1));
+                    col.z = static_cast<unsigned char>(cols.Get(loop, 2));
+                    if constexpr (View::Components == 4) {
+                        col.w = static_cast<unsigned char>(cols.Get(loop, 3));
+                    } else {
+                        // opaque, like the accessors of the particle store report it
+                        col.w = static_cast<unsigned char>(std::is_same_v<T, unsigned char> ? T(255) : T(1));
+                    }
+                }
+                this->position[offset + loop].w = encodeColorToFloat(col);
+            }
+        });
+    });
+    if (!hasColours) {
+        auto const* glob = parts.GetGlobalColour();
+        float const color = encodeColorToFloat(rkcommon::math::vec4uc(glob[0], glob[1], glob[2], glob[3]));
+        for (size_t loop = 0; loop < parts.GetCount(); ++loop) {
+            this->position[offset + loop].w = color;
+        }
+    }
 
-        this->position.emplace_back(pos, color);
+    bool const hasVertices = parts.VisitVertexData([&](auto const& verts) {
+        tbb::parallel_for(range, [&](tbb::blocked_range<size_t> const& r) {
+            for (size_t loop = r.begin(); loop < r.end(); ++loop) {
+                auto& pos = this->position[offset + loop];
+                pos.x = static_cast<float>(verts.Get(loop, 0));
+                pos.y = static_cast<float>(verts.Get(loop, 1));
+                pos.z = static_cast<float>(verts.Get(loop, 2));
+            }
+        });
+    });
+    if (!hasVertices) {
+        for (size_t loop = 0; loop < parts.GetCount(); ++loop) {
+            auto& pos = this->position[offset + loop];
+            pos.x = pos.y = pos.z = 0.0f;
+        }
     }
 }
@@ -6,10 +6,26 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd/data/DataWriterCtrlCall.h"
+#include "vislib/sys/File.h"
+
+#ifdef MEGAMOL_USE_PROFILING
+#include "PerformanceManager.h"
+#endif
 
 
 namespace megamol::core {
@@ -19,6 +35,13 @@ namespace megamol::core {
  */
 class AbstractDataWriter : public Module {
 public:
+#ifdef MEGAMOL_USE_PROFILING
+    static void requested_lifetime_resources(frontend_resources::ResourceRequest& req) {
+        Module::requested_lifetime_resources(req);
+        req.require<frontend_resources::PerformanceManager>();
+    }
+#endif
+
     /** Ctor. */
     AbstractDataWriter();
 
@@ -26,6 +49,99 @@ public:
     ~AbstractDataWriter() override;
 
 protected:
+    /**
+     * Writes buffers to a file on a dedicated I/O thread, in the order they
+     * are pushed. Buffers are coalesced into large blocks, so a writer can
+     * fetch and serialize the next frame while the previous ones are written.
+     */
+    class PipelinedFileWriter {
+    public:
+        /**
+         * Ctor. Starts the I/O thread, which writes from the current position
+         * of 'file' on. 'file' must not be used until Finish returned.
+         *
+         * @param file       The opened output file.
+         * @param maxPending The number of buffers that may wait for the I/O thread.
+         * @param blockSize  The size of the blocks written at once in bytes.
+         */
+        PipelinedFileWriter(vislib::sys::File& file, size_t maxPending, size_t blockSize = 8u << 20);
+
+        /** Dtor. Finishes writing. */
+        ~PipelinedFileWriter();
+
+        /**
+         * Enqueues a buffer, blocking while 'maxPending' buffers are waiting.
+         *
+         * @return False if a previous write failed.
+         */
+        bool Push(std::vector<uint8_t>&& buffer);
+
+        /**
+         * Writes all pending data and stops the I/O thread.
+         *
+         * @return True if all data has been written.
+         */
+        bool Finish();
+
+        /** Answer the file position following all pushed buffers */
+        inline uint64_t Position() const {
+            return this->position;
+        }
+
+    private:
+        void ioLoop();
+
+        vislib::sys::File& file;
+        size_t const maxPending;
+        size_t const blockSize;
+        uint64_t position;
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable pushed;
+        std::condition_variable popped;
+        std::deque<std::vector<uint8_t>> pending;
+        bool finishing;
+        bool failed;
+    };
+
+    /** The stages of an export, reported to the profiling service */
+    enum class ExportStage : unsigned int { FETCH = 0, SERIALIZE = 1, WAIT = 2 };
+
+    /**
+     * Registers the timers of the export stages with the profiling service.
+     * Writers using the export reports call this from 'create', as the
+     * profiling service must only be used from the render thread.
+     */
+    void registerExportTimers();
+
+    /** Removes the timers of the export stages, called from 'release' */
+    void releaseExportTimers();
+
+    /**
+     * Starts the progress report of an export.
+     *
+     * @param frameCount The number of frames to be written.
+     */
+    void beginExport(unsigned int frameCount);
+
+    /** Starts timing an export stage, may be called from any thread */
+    void beginExportStage(ExportStage stage);
+
+    /** Stops timing an export stage, may be called from any thread */
+    void endExportStage(ExportStage stage);
+
+    /**
+     * Reports that one more frame has been handed to the output. Progress and
+     * throughput are logged about once per second.
+     *
+     * @param bytes The size of the frame in bytes.
+     */
+    void reportExportProgress(uint64_t bytes);
+
+    /** Ends the progress report of an export and logs the summary */
+    void endExport();
+
     /**
      * The main function
      *
@@ -89,6 +205,28 @@ private:
 
     /** Triggers execution of the 'run' method */
     param::ParamSlot manualRunSlot;
+
+    /** Progress of the current export */
+    std::chrono::steady_clock::time_point exportStart, exportLastReport;
+    unsigned int exportFrameCount, exportFramesDone;
+    uint64_t exportBytes;
+
+    /** Start of the running export stages */
+    std::array<std::chrono::steady_clock::time_point, 3> exportStageStart;
+
+#ifdef MEGAMOL_USE_PROFILING
+    /** Publishes the stage times and the progress measured since the last frame, on the render thread */
+    void publishExportStats();
+
+    frontend_resources::PerformanceManager* perfManager = nullptr;
+    frontend_resources::PerformanceManager::handle_vector exportTimers;
+
+    /** Stage times and progress handed from the exporting thread to the render thread */
+    std::mutex exportStatsMutex;
+    std::vector<std::tuple<ExportStage, std::chrono::steady_clock::time_point, std::chrono::steady_clock::time_point>>
+        exportStageTimes;
+    std::string exportComment;
+#endif
 };
 
 } // namespace megamol::core
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "mmcore/Module.h"
-#include "vislib/sys/CriticalSection.h"
-#include "vislib/sys/Thread.h"
 
 
 namespace megamol::core::view {
@@ -175,6 +177,24 @@ protected:
      */
     void setFrameCount(unsigned int cnt);
 
+    /**
+     * Sets the number of loader threads. Must not be called after the
+     * frame cache has been initialised! Values larger than one must only
+     * be used if 'loadFrame' can safely be invoked concurrently for
+     * different frame objects. The default is one loader thread.
+     *
+     * @param cnt The number of loader threads. Must not be zero.
+     */
+    void setLoaderThreadCount(unsigned int cnt);
+
+    /**
+     * Sets the number of frames the loader threads prefetch in playback
+     * direction. Zero (the default) uses the whole frame cache.
+     *
+     * @param cnt The number of frames to prefetch.
+     */
+    void setPrefetchWindow(unsigned int cnt);
+
     /** frame is a friend to be able to call 'unlock' */
     friend class ::megamol::core::view::AnimDataModule::Frame;
 
@@ -182,11 +202,37 @@ private:
     /**
      * The loader thread function.
      *
-     * @param userData Pointer to this object.
+     * @param worker The zero-based index of the loader thread.
+     */
+    void loaderFunction(unsigned int worker);
+
+    /**
+     * Answer the cached frame holding the given frame index. Must be
+     * called with 'stateLock' held.
+     *
+     * @param idx The frame index.
+     * @param includeLoading If 'true', frames currently being loaded are
+     *                       also reported.
      *
-     * @return The return value.
+     * @return The cached frame or NULL if the frame is not cached.
      */
-    static DWORD loaderFunction(void* userData);
+    Frame* findCachedFrame(unsigned int idx, bool includeLoading) const;
+
+    /**
+     * Searches the next frame to be loaded within the prefetch window and
+     * a cache slot to load it into. Must be called with 'stateLock' held.
+     *
+     * @param outIdx Receives the index of the frame to be loaded.
+     *
+     * @return The cache slot to load the frame into, or NULL if there is
+     *         nothing to be loaded right now.
+     */
+    Frame* nextFrameToLoad(unsigned int& outIdx) const;
+
+    /**
+     * Stops and joins all loader threads.
+     */
+    void stopLoaders();
 
     /**
      * Unlocks the given frame
@@ -200,8 +246,14 @@ private:
     /** The number of time frames of the dataset */
     unsigned int frameCnt;
 
-    /** The loading thread */
-    vislib::sys::Thread loader;
+    /** The loading threads */
+    std::vector<std::thread> loaders;
+
+    /** The number of loading threads to be started */
+    unsigned int loaderCnt;
+
+    /** The number of frames to prefetch, zero for the whole cache */
+    unsigned int prefetchWindow;
 
     /** The frame cache */
     Frame** frameCache;
@@ -210,14 +262,19 @@ private:
     unsigned int cacheSize;
 
     /**
-     * The critical section to synchornise the state changes of the
-     * cached frames.
+     * The lock to synchornise the state changes of the cached frames.
      */
-    vislib::sys::CriticalSection stateLock;
+    std::mutex stateLock;
+
+    /** Signals changes of the frame states and of the requested frame */
+    std::condition_variable stateChanged;
 
     /** The frame number requested the last time 'requestLockedFrame' was called */
     unsigned int lastRequested;
 
+    /** The playback step between the last two requests (sign is the direction) */
+    int requestStep;
+
     /** TODO: The Mueller shalt document his stuff */
     std::atomic_bool isRunning;
 #ifdef _WIN32
@@ -6,6 +6,10 @@
  */
 
 #include "mmstd/data/AbstractDataWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "mmcore/param/ButtonParam.h"
 #include "mmcore/utility/log/Log.h"
 #include "mmstd/data/DataWriterCtrlCall.h"
@@ -19,7 +23,10 @@ using namespace megamol::core;
 AbstractDataWriter::AbstractDataWriter()
         : Module()
         , controlSlot("control", "Slot for incoming control commands")
-        , manualRunSlot("manualRun", "Slot fopr manual triggering of the run method.") {
+        , manualRunSlot("manualRun", "Slot fopr manual triggering of the run method.")
+        , exportFrameCount(0)
+        , exportFramesDone(0)
+        , exportBytes(0) {
 
     this->controlSlot.SetCallback(DataWriterCtrlCall::ClassName(),
         DataWriterCtrlCall::FunctionName(DataWriterCtrlCall::CALL_RUN), &AbstractDataWriter::onCallRun);
@@ -92,3 +99,249 @@ bool AbstractDataWriter::triggerManualRun(param::ParamSlot& slot) {
 
     return true;
 }
+
+
+/*
+ * AbstractDataWriter::PipelinedFileWriter::PipelinedFileWriter
+ */
+AbstractDataWriter::PipelinedFileWriter::PipelinedFileWriter(
+    vislib::sys::File& file, size_t maxPending, size_t blockSize)
+        : file(file)
+        , maxPending(std::max<size_t>(maxPending, 1))
+        , blockSize(std::max<size_t>(blockSize, 4096))
+        , position(static_cast<uint64_t>(file.Tell()))
+        , finishing(false)
+        , failed(false) {
+    this->thread = std::thread(&PipelinedFileWriter::ioLoop, this);
+}
+
+
+/*
+ * AbstractDataWriter::PipelinedFileWriter::~PipelinedFileWriter
+ */
+AbstractDataWriter::PipelinedFileWriter::~PipelinedFileWriter() {
+    this->Finish();
+}
+
+
+/*
+ * AbstractDataWriter::PipelinedFileWriter::Push
+ */
+bool AbstractDataWriter::PipelinedFileWriter::Push(std::vector<uint8_t>&& buffer) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->popped.wait(lock, [this]() { return (this->pending.size() < this->maxPending) || this->failed; });
+    if (this->failed || this->finishing) {
+        return false;
+    }
+    this->position += buffer.size();
+    this->pending.push_back(std::move(buffer));
+    this->pushed.notify_one();
+    return true;
+}
+
+
+/*
+ * AbstractDataWriter::PipelinedFileWriter::Finish
+ */
+bool AbstractDataWriter::PipelinedFileWriter::Finish() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->finishing = true;
+    }
+    this->pushed.notify_one();
+    if (this->thread.joinable()) {
+        this->thread.join();
+    }
+    return !this->failed;
+}
+
+
+/*
+ * AbstractDataWriter::PipelinedFileWriter::ioLoop
+ */
+void AbstractDataWriter::PipelinedFileWriter::ioLoop() {
+    // small frames are gathered in the staging buffer, so the file only sees large block writes
+    std::vector<uint8_t> staging;
+    staging.reserve(2 * this->blockSize);
+
+    auto write = [this](const uint8_t* data, size_t size) {
+        if (this->file.Write(data, size) != size) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->failed = true;
+            this->popped.notify_all();
+            return false;
+        }
+        return true;
+    };
+
+    while (true) {
+        std::vector<uint8_t> buffer;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->pushed.wait(lock, [this]() { return !this->pending.empty() || this->finishing; });
+            if (this->pending.empty()) {
+                break;
+            }
+            buffer = std::move(this->pending.front());
+            this->pending.pop_front();
+        }
+        this->popped.notify_one();
+
+        if (staging.empty() && (buffer.size() >= this->blockSize)) {
+            // large frames go to the file directly, only the tail is staged
+            size_t const direct = buffer.size() - (buffer.size() % this->blockSize);
+            if (!write(buffer.data(), direct)) {
+                return;
+            }
+            staging.insert(staging.end(), buffer.begin() + direct, buffer.end());
+        } else {
+            staging.insert(staging.end(), buffer.begin(), buffer.end());
+        }
+        if (staging.size() >= this->blockSize) {
+            size_t const full = staging.size() - (staging.size() % this->blockSize);
+            if (!write(staging.data(), full)) {
+                return;
+            }
+            staging.erase(staging.begin(), staging.begin() + full);
+        }
+    }
+
+    if (!staging.empty()) {
+        write(staging.data(), staging.size());
+    }
+}
+
+
+/*
+ * AbstractDataWriter::registerExportTimers
+ */
+void AbstractDataWriter::registerExportTimers() {
+#ifdef MEGAMOL_USE_PROFILING
+    if (this->perfManager == nullptr) {
+        this->perfManager = const_cast<frontend_resources::PerformanceManager*>(
+            &this->frontend_resources.get<frontend_resources::PerformanceManager>());
+        frontend_resources::PerformanceManager::basic_timer_config fetch, serialize, wait;
+        fetch.name = "export_fetch";
+        serialize.name = "export_serialize";
+        wait.name = "export_wait_io";
+        this->exportTimers = this->perfManager->add_timers(this, {fetch, serialize, wait});
+        this->perfManager->subscribe_to_frame_start(this, [this]() { this->publishExportStats(); });
+    }
+#endif
+}
+
+
+/*
+ * AbstractDataWriter::releaseExportTimers
+ */
+void AbstractDataWriter::releaseExportTimers() {
+#ifdef MEGAMOL_USE_PROFILING
+    if (this->perfManager != nullptr) {
+        this->perfManager->unsubscribe_from_frame_start(this);
+        this->perfManager->remove_timers(this->exportTimers);
+        this->exportTimers.clear();
+        this->perfManager = nullptr;
+    }
+#endif
+}
+
+
+/*
+ * AbstractDataWriter::beginExport
+ */
+void AbstractDataWriter::beginExport(unsigned int frameCount) {
+    this->exportFrameCount = frameCount;
+    this->exportFramesDone = 0;
+    this->exportBytes = 0;
+    this->exportStart = std::chrono::steady_clock::now();
+    this->exportLastReport = this->exportStart;
+}
+
+
+/*
+ * AbstractDataWriter::beginExportStage
+ */
+void AbstractDataWriter::beginExportStage(ExportStage stage) {
+    this->exportStageStart[static_cast<unsigned int>(stage)] = std::chrono::steady_clock::now();
+}
+
+
+/*
+ * AbstractDataWriter::endExportStage
+ */
+void AbstractDataWriter::endExportStage(ExportStage stage) {
+#ifdef MEGAMOL_USE_PROFILING
+    auto const end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(this->exportStatsMutex);
+    // nobody publishes them without a render loop, so only the most recent ones are kept
+    if (this->exportStageTimes.size() >= 1024) {
+        this->exportStageTimes.erase(this->exportStageTimes.begin());
+    }
+    this->exportStageTimes.emplace_back(stage, this->exportStageStart[static_cast<unsigned int>(stage)], end);
+#endif
+}
+
+
+#ifdef MEGAMOL_USE_PROFILING
+/*
+ * AbstractDataWriter::publishExportStats
+ */
+void AbstractDataWriter::publishExportStats() {
+    decltype(this->exportStageTimes) times;
+    std::string comment;
+    {
+        std::lock_guard<std::mutex> lock(this->exportStatsMutex);
+        times.swap(this->exportStageTimes);
+        comment.swap(this->exportComment);
+    }
+    for (auto const& [stage, start, end] : times) {
+        this->perfManager->add_region(this->exportTimers[static_cast<unsigned int>(stage)], start, end);
+    }
+    if (!comment.empty()) {
+        this->perfManager->set_transient_comment(
+            this->exportTimers[static_cast<unsigned int>(ExportStage::FETCH)], comment);
+    }
+}
+#endif
+
+
+/*
+ * AbstractDataWriter::reportExportProgress
+ */
+void AbstractDataWriter::reportExportProgress(uint64_t bytes) {
+    using megamol::core::utility::log::Log;
+    this->exportFramesDone++;
+    this->exportBytes += bytes;
+
+    auto const now = std::chrono::steady_clock::now();
+    if ((now - this->exportLastReport < std::chrono::seconds(1)) &&
+        (this->exportFramesDone < this->exportFrameCount)) {
+        return;
+    }
+    this->exportLastReport = now;
+    double const seconds = std::chrono::duration<double>(now - this->exportStart).count();
+    double const mbPerSecond = (seconds > 0.0) ? (static_cast<double>(this->exportBytes) / (1 << 20)) / seconds : 0.0;
+    double const framesPerSecond = (seconds > 0.0) ? this->exportFramesDone / seconds : 0.0;
+    Log::DefaultLog.WriteInfo("%s: frame %u of %u, %.1f frames/s, %.1f MB/s", this->Name().PeekBuffer(),
+        this->exportFramesDone, this->exportFrameCount, framesPerSecond, mbPerSecond);
+
+#ifdef MEGAMOL_USE_PROFILING
+    char comment[128];
+    snprintf(comment, sizeof(comment), "%u/%u frames, %.1f MB/s", this->exportFramesDone, this->exportFrameCount,
+        mbPerSecond);
+    std::lock_guard<std::mutex> lock(this->exportStatsMutex);
+    this->exportComment = comment;
+#endif
+}
+
+
+/*
+ * AbstractDataWriter::endExport
+ */
+void AbstractDataWriter::endExport() {
+    using megamol::core::utility::log::Log;
+    double const seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - this->exportStart).count();
+    Log::DefaultLog.WriteInfo("%s: wrote %u frames (%.1f MB) in %.2f s", this->Name().PeekBuffer(),
+        this->exportFramesDone, static_cast<double>(this->exportBytes) / (1 << 20), seconds);
+}
@@ -8,8 +8,10 @@
 #include "mmstd/data/AnimDataModule.h"
 #include "mmcore/utility/log/Log.h"
 #include "vislib/assert.h"
-#include "vislib/sys/Thread.h"
+#include "vislib/String.h"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 
 using namespace megamol::core;
 
@@ -22,11 +24,15 @@ using namespace megamol::core;
 view::AnimDataModule::AnimDataModule()
         : Module()
         , frameCnt(0)
-        , loader(loaderFunction)
+        , loaders()
+        , loaderCnt(1)
+        , prefetchWindow(0)
         , frameCache(NULL)
         , cacheSize(0)
         , stateLock()
-        , lastRequested(0) {
+        , stateChanged()
+        , lastRequested(0)
+        , requestStep(1) {
     this->isRunning.store(false);
 }
 
@@ -38,11 +44,7 @@ view::AnimDataModule::~AnimDataModule() {
     this->Release();
 
     Frame** frames = this->frameCache;
-    //    this->frameCache = NULL;
-    this->isRunning.store(false);
-    if (this->loader.IsRunning()) {
-        this->loader.Join();
-    }
+    this->stopLoaders();
     this->frameCache = NULL;
     if (frames != NULL) {
         for (unsigned int i = 0; i < this->cacheSize; i++) {
@@ -57,7 +59,7 @@ view::AnimDataModule::~AnimDataModule() {
  * view::AnimDataModule::initframeCache
  */
 void view::AnimDataModule::initFrameCache(unsigned int cacheSize) {
-    ASSERT(this->loader.IsRunning() == false);
+    ASSERT(this->loaders.empty());
     ASSERT(cacheSize > 0);
     ASSERT(this->frameCnt > 0);
 
@@ -90,12 +92,14 @@ void view::AnimDataModule::initFrameCache(unsigned int cacheSize) {
         this->loadFrame(this->frameCache[0], 0); // load first frame directly.
         this->frameCache[0]->state = Frame::STATE_AVAILABLE;
         this->lastRequested = 0;
+        this->requestStep = 1;
 
         this->isRunning.store(true);
-        this->loader.Start(this);
-        // XXX Is there a race condition that requires higher sleep time (value originally was 250)?
-        // XXX Reduced for faster module creation, because called in ctor.
-        vislib::sys::Thread::Sleep(10);
+        // more loaders than cache slots would never have anything to do
+        unsigned int cnt = (this->loaderCnt < this->cacheSize) ? this->loaderCnt : this->cacheSize;
+        for (unsigned int i = 0; i < cnt; i++) {
+            this->loaders.emplace_back(&AnimDataModule::loaderFunction, this, i);
+        }
     } else {
         megamol::core::utility::log::Log::DefaultLog.WriteError(
             "Unable to create frame data cache ('constructFrame' returned 'NULL').");
@@ -111,13 +115,27 @@ view::AnimDataModule::Frame* view::AnimDataModule::requestLockedFrame(unsigned i
     int dist, minDist = this->frameCnt;
     static bool deadlockwarning = true;
 
-    this->stateLock.Lock();
-    this->lastRequested = idx; // TODO: choose better caching strategy!!!
+    std::unique_lock<std::mutex> lock(this->stateLock);
+    if ((idx != this->lastRequested) && (this->frameCnt > 0) && (idx < this->frameCnt)) {
+        // estimate playback direction and stride, wrapping around the end of the data set
+        int delta = static_cast<int>(idx) - static_cast<int>(this->lastRequested);
+        int const half = static_cast<int>(this->frameCnt / 2);
+        if (delta > half) {
+            delta -= static_cast<int>(this->frameCnt);
+        } else if (delta < -half) {
+            delta += static_cast<int>(this->frameCnt);
+        }
+        // large jumps are seeks and do not change the playback pattern
+        if ((delta != 0) && (static_cast<unsigned int>(std::abs(delta)) < this->cacheSize)) {
+            this->requestStep = delta;
+        }
+    }
+    this->lastRequested = idx;
     for (unsigned int i = 0; i < this->cacheSize; i++) {
         if ((this->frameCache[i]->state == Frame::STATE_AVAILABLE) ||
             (this->frameCache[i]->state == Frame::STATE_INUSE)) {
             // note: do not wrap distance around!
-            dist = labs(this->frameCache[i]->frame - idx);
+            dist = labs(static_cast<long>(this->frameCache[i]->frame) - static_cast<long>(idx));
             if (dist == 0) {
                 retval = this->frameCache[i];
                 break;
@@ -130,7 +148,9 @@ view::AnimDataModule::Frame* view::AnimDataModule::requestLockedFrame(unsigned i
     if (retval != NULL) {
         retval->state = Frame::STATE_INUSE;
     }
-    this->stateLock.Unlock();
+    lock.unlock();
+    // the loaders need to re-evaluate their prefetch window
+    this->stateChanged.notify_all();
 
     if (deadlockwarning
 #if !(defined(DEBUG) || defined(_DEBUG))
@@ -178,8 +198,13 @@ view::AnimDataModule::Frame* view::AnimDataModule::requestLockedFrame(unsigned i
         f->Unlock();
 
         // HAZARD: This will wait for all eternity if the requested frame is never loaded
+        {
+            std::unique_lock<std::mutex> lock(this->stateLock);
+            // the timeout only guards against the loaders being stopped while we wait
+            this->stateChanged.wait_for(lock, std::chrono::milliseconds(100),
+                [this, idx]() { return (this->findCachedFrame(idx, false) != NULL) || !this->isRunning.load(); });
+        }
 
-        vislib::sys::Thread::Sleep(100); // time for the loader thread to load
         f = this->requestLockedFrame(idx);
     }
 
@@ -192,11 +217,7 @@ view::AnimDataModule::Frame* view::AnimDataModule::requestLockedFrame(unsigned i
  */
 void view::AnimDataModule::resetFrameCache() {
     Frame** frames = this->frameCache;
-    //    this->frameCache = NULL;
-    this->isRunning.store(false);
-    if (this->loader.IsRunning()) {
-        this->loader.Join();
-    }
+    this->stopLoaders();
     this->frameCache = NULL;
     if (frames != NULL) {
         for (unsigned int i = 0; i < this->cacheSize; i++) {
@@ -207,6 +228,7 @@ void view::AnimDataModule::resetFrameCache() {
     this->frameCnt = 0;
     this->cacheSize = 0;
     this->lastRequested = 0;
+    this->requestStep = 1;
 }
 
 
@@ -214,154 +236,224 @@ void view::AnimDataModule::resetFrameCache() {
  * view::AnimDataModule::setFrameCount
  */
 void view::AnimDataModule::setFrameCount(unsigned int cnt) {
-    ASSERT(this->loader.IsRunning() == false);
+    ASSERT(this->loaders.empty());
     ASSERT(cnt > 0);
     this->frameCnt = cnt;
 }
 
 
+/*
+ * view::AnimDataModule::setLoaderThreadCount
+ */
+void view::AnimDataModule::setLoaderThreadCount(unsigned int cnt) {
+    ASSERT(this->loaders.empty());
+    ASSERT(cnt > 0);
+    this->loaderCnt = (cnt > 0) ? cnt : 1;
+}
+
+
+/*
+ * view::AnimDataModule::setPrefetchWindow
+ */
+void view::AnimDataModule::setPrefetchWindow(unsigned int cnt) {
+    std::lock_guard<std::mutex> lock(this->stateLock);
+    this->prefetchWindow = cnt;
+}
+
+
+/*
+ * view::AnimDataModule::findCachedFrame
+ */
+view::AnimDataModule::Frame* view::AnimDataModule::findCachedFrame(unsigned int idx, bool includeLoading) const {
+    for (unsigned int i = 0; i < this->cacheSize; i++) {
+        Frame* f = this->frameCache[i];
+        if ((f->frame == idx) && ((f->state == Frame::STATE_AVAILABLE) || (f->state == Frame::STATE_INUSE) ||
+                                     (includeLoading && (f->state == Frame::STATE_LOADING)))) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+
+/*
+ * view::AnimDataModule::nextFrameToLoad
+ */
+view::AnimDataModule::Frame* view::AnimDataModule::nextFrameToLoad(unsigned int& outIdx) const {
+    if ((this->frameCache == NULL) || (this->frameCnt == 0)) {
+        return NULL;
+    }
+
+    // the prefetch window follows the playback direction and stride of the last requests
+    long const cnt = static_cast<long>(this->frameCnt);
+    long const step = static_cast<long>(this->requestStep);
+    unsigned int window = this->cacheSize;
+    if ((this->prefetchWindow > 0) && (this->prefetchWindow < window)) {
+        window = this->prefetchWindow;
+    }
+    long const stride = std::abs(step);
+    auto windowIndex = [&](unsigned int k) -> unsigned int {
+        long i = (static_cast<long>(this->lastRequested) + static_cast<long>(k) * step) % cnt;
+        return static_cast<unsigned int>((i < 0) ? (i + cnt) : i);
+    };
+    // position of a frame inside the prefetch window, or 'window' if outside
+    auto windowPosition = [&](unsigned int idx) -> unsigned int {
+        long d = (static_cast<long>(idx) - static_cast<long>(this->lastRequested)) * ((step < 0) ? -1 : 1);
+        d = ((d % cnt) + cnt) % cnt;
+        if ((d % stride) != 0) {
+            return window;
+        }
+        long k = d / stride;
+        return (k < static_cast<long>(window)) ? static_cast<unsigned int>(k) : window;
+    };
+
+    // sorted list of the frames which are cached or being loaded
+    std::vector<unsigned int> cached;
+    cached.reserve(this->cacheSize);
+    for (unsigned int i = 0; i < this->cacheSize; i++) {
+        if (this->frameCache[i]->state != Frame::STATE_INVALID) {
+            cached.push_back(this->frameCache[i]->frame);
+        }
+    }
+    std::sort(cached.begin(), cached.end());
+
+    // 1. search for the most important frame to be loaded.
+    unsigned int pos = 0;
+    for (; pos < window; pos++) {
+        outIdx = windowIndex(pos);
+        if (!std::binary_search(cached.begin(), cached.end(), outIdx)) {
+            break;
+        }
+    }
+    if (pos >= window) {
+        return NULL; // everything within the window is loaded or being loaded
+    }
+
+    // 2. search for the best cached frame to be overwritten: free slots first,
+    //    then frames outside of the window (farthest first), then frames at the
+    //    far end of the window, but never a frame more important than the new one.
+    Frame* frame = NULL;
+    long bestScore = static_cast<long>(pos);
+    for (unsigned int i = 0; i < this->cacheSize; i++) {
+        Frame* f = this->frameCache[i];
+        if (f->state == Frame::STATE_INVALID) {
+            return f;
+        } else if (f->state == Frame::STATE_AVAILABLE) {
+            long score = static_cast<long>(windowPosition(f->frame));
+            if (score >= static_cast<long>(window)) {
+                long d = static_cast<long>(f->frame) - static_cast<long>(this->lastRequested);
+                score = static_cast<long>(window) + std::abs(d);
+            }
+            if (score > bestScore) {
+                frame = f;
+                bestScore = score;
+            }
+        }
+    }
+
+    return frame;
+}
+
+
+/*
+ * view::AnimDataModule::stopLoaders
+ */
+void view::AnimDataModule::stopLoaders() {
+    {
+        std::lock_guard<std::mutex> lock(this->stateLock);
+        this->isRunning.store(false);
+    }
+    this->stateChanged.notify_all();
+    for (auto& l : this->loaders) {
+        if (l.joinable()) {
+            l.join();
+        }
+    }
+    this->loaders.clear();
+}
+
+
 /*
  * view::AnimDataModule::loaderFunction
  */
-DWORD view::AnimDataModule::loaderFunction(void* userData) {
-    AnimDataModule* This = static_cast<AnimDataModule*>(userData);
-    ASSERT(This != NULL);
-    unsigned int index, i, j, req;
-#ifdef _LOADING_REPORTING
-    unsigned int l;
-#endif /* _LOADING_REPORTING */
+void view::AnimDataModule::loaderFunction(unsigned int worker) {
+    unsigned int index;
     Frame* frame;
-    vislib::StringA fullName(This->FullName());
+    vislib::StringA fullName(this->FullName());
 
     std::chrono::high_resolution_clock::duration accumDuration = std::chrono::seconds(0);
     unsigned int accumCount = 0;
     std::chrono::system_clock::time_point lastReportTime = std::chrono::system_clock::now();
     const std::chrono::system_clock::duration lastReportDistance = std::chrono::seconds(3);
 
-    while (This->isRunning.load()) {
-        // sleep to enforce thread changes
-        vislib::sys::Thread::Sleep(1);
-        if (!This->isRunning.load())
-            break;
+    while (this->isRunning.load()) {
+        std::unique_lock<std::mutex> lock(this->stateLock);
 
-        // idea:
-        //  1. search for the most important frame to be loaded.
-        //  2. search for the best cached frame to be overwritten.
-        //  3. load the frame
-
-        // 1.
-        // Note: we do not need to lock here, because we won't change the frame
-        // state now, and the different states that can be set outside this
-        // thread are aquivalent for us.
-        index = req = This->lastRequested;
-        for (j = 0; j < This->cacheSize; j++) {
-            for (i = 0; i < This->cacheSize; i++) {
-                if (!This->isRunning.load())
-                    break;
-                if (((This->frameCache[i]->state == Frame::STATE_AVAILABLE) ||
-                        (This->frameCache[i]->state == Frame::STATE_INUSE)) &&
-                    (This->frameCache[i]->frame == index)) {
-                    break;
+        if ((this->cacheSize >= this->frameCnt) && (this->frameCache != NULL)) {
+            // cached frames are always distinct, so counting them is sufficient
+            unsigned int loadedCnt = 0;
+            for (unsigned int i = 0; i < this->cacheSize; i++) {
+                if ((this->frameCache[i]->state == Frame::STATE_AVAILABLE) ||
+                    (this->frameCache[i]->state == Frame::STATE_INUSE)) {
+                    loadedCnt++;
                 }
             }
-            if (!This->isRunning.load())
-                break;
-            if (i >= This->cacheSize) {
-                break;
-            }
-            index = (index + 1) % This->frameCnt;
-        }
-        if (!This->isRunning.load())
-            break;
-        if (j >= This->cacheSize) {
-            if (j >= This->frameCnt) {
-                ASSERT(This->frameCnt == This->cacheSize);
-                megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-                    "All frames of the dataset loaded into cache. Terminating loading Thread.");
+            if (loadedCnt >= this->frameCnt) {
+                if (worker == 0) {
+                    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+                        "All frames of the dataset loaded into cache. Terminating loading Thread.");
+                }
                 break;
             }
-            continue;
         }
 
-        // 2.
-        // Note: We now need to lock, because we must synchronise against
-        // frames changing from 'STATE_AVAILABLE' to 'STATE_INUSE'.
-        This->stateLock.Lock();
-        // core idea: search for the frame with the largest distance to the requested frame
-        frame = NULL; // the frame to be overwritten
-        j = 0;        // the distance to the found frame to be overwritten
-        for (i = 0; i < This->cacheSize; i++) {
-            if (This->frameCache[i]->state == Frame::STATE_INVALID) {
-                frame = This->frameCache[i];
-                // j = UINT_MAX; // not required, since we instantly leave the loop
-#ifdef _LOADING_REPORTING
-                l = i;
-#endif /* _LOADING_REPORTING */
-                break;
-            } else if (This->frameCache[i]->state == Frame::STATE_AVAILABLE) {
-                // distance to the frame[i];
-                long ld = static_cast<long>(This->frameCache[i]->frame) - static_cast<long>(req);
-                if (ld < 0) {
-                    if (ld < (static_cast<long>(This->frameCnt)) / 10) {
-                        ld += static_cast<long>(This->frameCnt);
-                        if (ld < 0)
-                            ld = 0; // should never happen
-                    } else {
-                        ld = -10 * ld;
-                    }
-                }
-
-                if (j < static_cast<unsigned int>(ld)) {
-                    frame = This->frameCache[i];
-                    j = static_cast<unsigned int>(ld);
-#ifdef _LOADING_REPORTING
-                    l = i;
-#endif /* _LOADING_REPORTING */
-                }
+        // wait until there is something to load: a new request, or a frame
+        // being unlocked or finished by another loader
+        frame = NULL;
+        this->stateChanged.wait(lock, [this, &frame, &index]() {
+            if (!this->isRunning.load()) {
+                return true;
             }
-            if (!This->isRunning.load())
-                break;
+            frame = this->nextFrameToLoad(index);
+            return frame != NULL;
+        });
+        if ((frame == NULL) || !this->isRunning.load()) {
+            break;
         }
 
-        // 3.
-        if (frame != NULL) {
-            frame->state = Frame::STATE_LOADING;
-        }
-        // if frame is NULL no suitable cache buffer found for loading. This is
-        // mostly the case if the cache is too small or if the data source
-        // locks too much frames.
-        This->stateLock.Unlock();
+        // 3. load the frame
+        frame->state = Frame::STATE_LOADING;
+        frame->frame = index; // reserves the index against the other loaders
+        lock.unlock();
 
-        if ((frame != NULL) && This->isRunning.load()) {
 #ifdef _LOADING_REPORTING
-            printf("Loading frame %i into cache %i\n", index, l);
+        printf("Loader %u loading frame %u\n", worker, index);
 #endif /* _LOADING_REPORTING */
 
-            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
-            This->loadFrame(frame, index);
+        this->loadFrame(frame, index);
 
-            std::chrono::high_resolution_clock::duration duration = std::chrono::high_resolution_clock::now() - start;
-            accumDuration += duration;
-            accumCount++;
+        std::chrono::high_resolution_clock::duration duration = std::chrono::high_resolution_clock::now() - start;
+        accumDuration += duration;
+        accumCount++;
 
-            std::chrono::system_clock::time_point reportTime = std::chrono::system_clock::now();
-            if ((reportTime - lastReportTime) > lastReportDistance) {
-                lastReportTime = reportTime;
-                if (accumCount > 0) {
-                    megamol::core::utility::log::Log::DefaultLog.WriteInfo("[%s] Loading speed: %f ms/f (%u)",
-                        fullName.PeekBuffer(),
-                        1000.0 * std::chrono::duration_cast<std::chrono::duration<double>>(accumDuration).count() /
-                            static_cast<double>(accumCount),
-                        static_cast<unsigned int>(accumCount));
-                }
+        std::chrono::system_clock::time_point reportTime = std::chrono::system_clock::now();
+        if ((reportTime - lastReportTime) > lastReportDistance) {
+            lastReportTime = reportTime;
+            if (accumCount > 0) {
+                megamol::core::utility::log::Log::DefaultLog.WriteInfo("[%s] Loading speed: %f ms/f (%u)",
+                    fullName.PeekBuffer(),
+                    1000.0 * std::chrono::duration_cast<std::chrono::duration<double>>(accumDuration).count() /
+                        static_cast<double>(accumCount),
+                    static_cast<unsigned int>(accumCount));
             }
-
-            // we no not need to lock here, because this transition from
-            // 'STATE_LOADING' to 'STATE_AVAILABLE' is safe for the using
-            // thread.
-            frame->state = Frame::STATE_AVAILABLE;
         }
+
+        lock.lock();
+        frame->state = Frame::STATE_AVAILABLE;
+        lock.unlock();
+        this->stateChanged.notify_all();
     }
 
     if (accumCount > 0) {
@@ -373,7 +465,6 @@ DWORD view::AnimDataModule::loaderFunction(void* userData) {
     }
 
     megamol::core::utility::log::Log::DefaultLog.WriteInfo("The loader thread is exiting.");
-    return 0;
 }
 
 
@@ -383,7 +474,10 @@ DWORD view::AnimDataModule::loaderFunction(void* userData) {
 void view::AnimDataModule::unlock(view::AnimDataModule::Frame* frame) {
     ASSERT(&frame->owner == this);
     ASSERT(frame->state == Frame::STATE_INUSE);
-    this->stateLock.Lock();
-    frame->state = Frame::STATE_AVAILABLE;
-    this->stateLock.Unlock();
+    {
+        std::lock_guard<std::mutex> lock(this->stateLock);
+        frame->state = Frame::STATE_AVAILABLE;
+    }
+    // an unlocked frame may be overwritten by the loaders
+    this->stateChanged.notify_all();
 }
@@ -6,6 +6,7 @@
  */
 
 #include "io/IMDAtomDataSource.h"
+#include "io/TextScanner.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/ButtonParam.h"
@@ -28,694 +29,308 @@
 #include "vislib/sys/FastFile.h"
 #include "vislib/sys/SystemMessage.h"
 #include "vislib/sys/sysfunctions.h"
+#include <algorithm>
 #include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
 
+#include <omp.h>
 
-namespace {
-
-/**
- * Abstract base class for IMDAtom readers.
- *
- * Note: that no method is virtual. This allows for inline functions for
- * faster data reading.
- */
-class AbstractAtomReader {
-public:
-    // No public methods are defined here (see note in class description)
-
-protected:
-    /**
-     * Ctor
-     *
-     * @param file The file to read from
-     */
-    AbstractAtomReader(vislib::sys::File& file) : file(file), buf(NULL), validBufSize(0), pos(0) {
-        this->buf = new unsigned char[BUFSIZE];
-    }
-
-    /**
-     * Dtor
-     */
-    ~AbstractAtomReader() {
-        // Do not close, delete, etc. the file
-        ARY_SAFE_DELETE(this->buf);
-    }
-
-    /**
-     * Copies a number of bytes from the input buffer to 'dst'.
-     *
-     * @param dst Pointer to the memory to receive the data
-     * @param size The number of bytes to read
-     *
-     * @return 'true' on success
-     */
-    VISLIB_FORCEINLINE bool copyData(void* dst, unsigned int size) {
-        if (this->validBufSize - this->pos >= size) {
-            ::memcpy(dst, this->buf + this->pos, size);
-            this->pos += size;
-            return true;
-        } else {
-            return this->loadData(static_cast<unsigned char*>(dst), size);
-        }
-    }
-
-    /**
-     * Skips 'size' bytes from the input buffer
-     *
-     * @param size The number of bytes to skip
-     *
-     * @return 'true' on success
-     */
-    VISLIB_FORCEINLINE bool skipData(unsigned int size) {
-        if (this->validBufSize - this->pos >= size) {
-            this->pos += size;
-            return true;
-        } else {
-            return this->skipDataEx(size);
-        }
-    }
-
-    /**
-     * Switches four bytes (endianess)
-     *
-     * @param ptr The pointer to the memory
-     */
-    VISLIB_FORCEINLINE void switch4Bytes(void* ptr) {
-        char* cp = static_cast<char*>(ptr);
-        char c = cp[0];
-        cp[0] = cp[3];
-        cp[3] = c;
-        c = cp[1];
-        cp[1] = cp[2];
-        cp[2] = c;
-    }
-
-    /**
-     * Switches eight bytes (endianess)
-     *
-     * @param ptr The pointer to the memory
-     */
-    VISLIB_FORCEINLINE void switch8Bytes(void* ptr) {
-        char* cp = static_cast<char*>(ptr);
-        char c = cp[0];
-        cp[0] = cp[7];
-        cp[7] = c;
-        c = cp[1];
-        cp[1] = cp[6];
-        cp[6] = c;
-        c = cp[2];
-        cp[2] = cp[5];
-        cp[5] = c;
-        c = cp[3];
-        cp[3] = cp[4];
-        cp[4] = c;
-    }
-
-    /**
-     * sifts the next ascii block
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The next ascii block
-     */
-    const char* sift(bool& fail) {
-        static vislib::StringA ebuf;
-        char* cbuf = reinterpret_cast<char*>(this->buf);
-
-        // do we need new data?
-        if (this->pos == this->validBufSize) {
-            try {
-                this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-            } catch (...) {
-                this->pos = this->validBufSize = 0;
-                fail = true;
-                return NULL;
-            }
-            this->pos = 0;
-            if (this->validBufSize == 0) { // eof
-                fail = true;
-                return NULL;
-            }
-        }
-
-        // skip white-spaces
-        if (cbuf[this->pos] == 0) {
-            cbuf[this->pos] = ' '; // because this 0 was proably from a
-                                   // previous sift
-        }
-        while (vislib::CharTraitsA::IsSpace(cbuf[this->pos])) {
-            this->pos++;
-            if (this->pos == this->validBufSize) {
-                try {
-                    this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-                } catch (...) {
-                    this->pos = this->validBufSize = 0;
-                    fail = true;
-                    return NULL;
-                }
-                this->pos = 0;
-                if (this->validBufSize == 0) { // eof
-                    fail = true;
-                    return NULL;
-                }
-            }
-        }
-
-        // collect token
-        unsigned int start = this->pos; // start of the new token
-        while (!vislib::CharTraitsA::IsSpace(cbuf[this->pos])) {
-            this->pos++;
-            if (this->pos == this->validBufSize) {
-                // running out of buffer, so we need to copy!
-                ebuf = vislib::StringA(cbuf + start, this->pos - start);
-
-                while (!this->file.IsEOF()) {
-                    try {
-                        this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-                    } catch (...) {
-                        this->pos = this->validBufSize = 0;
-                        break;
-                    }
-                    this->pos = 0;
-                    if (this->validBufSize == 0) { // eof
-                        break;
-                    }
 
-                    while (!vislib::CharTraitsA::IsSpace(cbuf[this->pos]) && (this->pos < this->validBufSize)) {
-                        this->pos++;
-                    }
-
-                    ebuf += vislib::StringA(cbuf, this->pos);
-                    if (this->pos < this->validBufSize) {
-                        // we did not run out of buffer -> os it's the end of the token
-                        break;
-                    }
-                }
-
-                return ebuf.PeekBuffer();
-            }
-        }
-
-        // token complete in buffer (and there are remaining whitspaces)
-        ASSERT(vislib::CharTraitsA::IsSpace(cbuf[this->pos]));
-        this->buf[this->pos] = 0;
-        return cbuf + start;
-    }
-
-private:
-    /** The size of the input buffer */
-    static const unsigned int BUFSIZE = 4 * 1024;
-
-    /**
-     * Copies a number of bytes from the input buffer to 'dst'.
-     *
-     * @param dst Pointer to the memory to receive the data
-     * @param size The number of bytes to read
-     *
-     * @return 'true' on success
-     */
-    bool loadData(unsigned char* dst, unsigned int size) {
-        unsigned int rem = this->validBufSize - this->pos;
-        ASSERT(size >= rem);
-
-        ::memcpy(dst, this->buf + this->pos, rem);
-        dst += rem;
-        size -= rem;
-
-        if (size > BUFSIZE) { // direct feed
-            this->validBufSize = 0;
-            this->pos = 0;
-            try {
-                return (this->file.Read(dst, size) == size);
-            } catch (...) {
-                return false;
-            }
-        }
-
-        try {
-            this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
+namespace {
 
-        } catch (...) {
-            this->pos = this->validBufSize = 0;
-            return false;
-        }
+/** Identifies particle cache files. */
+constexpr char cacheMagic[8] = {'M', 'M', 'I', 'M', 'D', 'C', 'A', 'C'};
 
-        if (size > this->validBufSize) { // eof
-            this->pos = this->validBufSize;
-            return false;
-        }
+/** The version of the particle cache file layout. */
+constexpr uint32_t cacheVersion = 1;
 
-        ::memcpy(dst, this->buf, size);
-        this->pos = size;
-        return true;
+/** Folds 'value' into the FNV-1a hash 'hash'. */
+inline uint64_t fold(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 1099511628211ull;
     }
+    return hash;
+}
 
-    /**
-     * Skips 'size' bytes from the input buffer
-     *
-     * @param size The number of bytes to skip
-     *
-     * @return 'true' on success
-     */
-    bool skipDataEx(unsigned int size) {
-        unsigned int rem = this->validBufSize - this->pos;
-        ASSERT(size >= rem);
-        size -= rem;
-        this->pos = this->validBufSize;
-
-        if (size > BUFSIZE) { // direct seek
-            try {
-                this->file.Seek(size, vislib::sys::File::CURRENT);
-                return true;
-            } catch (...) {
-                return false;
-            }
-        }
-
-        try { // read into buffer
-            this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-        } catch (...) {
-            this->pos = this->validBufSize = 0;
-            return false;
-        }
-
-        if (size > this->validBufSize) { // eof
-            this->pos = this->validBufSize;
-            return false;
-        }
-
-        this->pos = size;
-        return true;
+/** Folds the characters of 'str' into the FNV-1a hash 'hash'. */
+inline uint64_t fold(uint64_t hash, const std::string& str) {
+    hash = fold(hash, static_cast<uint64_t>(str.size()));
+    for (char c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
     }
+    return hash;
+}
 
-    /** The file to read from */
-    vislib::sys::File& file;
-
-    /** The input buffer */
-    unsigned char* buf;
+/** The number of bytes read and parsed at once */
+constexpr SIZE_T blockSize = 64 * 1024 * 1024;
 
-    /** The number of bytes of the input buffer that are valid */
-    unsigned int validBufSize;
+/** The per-atom values a data column can be stored to */
+enum AtomValue { VALUE_X = 0, VALUE_Y, VALUE_Z, VALUE_C, VALUE_DC, VALUE_DX, VALUE_DY, VALUE_DZ, VALUE_T, VALUE_COUNT };
 
-    /** The reading position in the input buffer */
-    unsigned int pos;
+/**
+ * How to read a data column and where to store its value
+ */
+struct AtomColumn {
+    bool isInt;           //< id and type columns are integers
+    unsigned int targets; //< bit mask of the AtomValues receiving the value
 };
 
-
 /**
- * IMD Atom file reader class for the ASCII file format
+ * The parameters deciding which atoms are stored how
  */
-class AtomReaderASCII : public AbstractAtomReader {
-public:
-    /**
-     * Ctor
-     *
-     * @param file The file to read from
-     */
-    AtomReaderASCII(vislib::sys::File& file) : AbstractAtomReader(file) {
-        // Intentionally empty
-    }
-
-    /**
-     * Dtor
-     */
-    ~AtomReaderASCII() {
-        // Intentionally empty
-    }
-
-    /**
-     * Reads an integer from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read integer
-     */
-    VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
-        const char* c = this->sift(fail);
-        try {
-            return static_cast<UINT32>(vislib::CharTraitsA::ParseInt(c));
-        } catch (...) {
-            fail = true;
-        }
-        return 0;
-    }
-
-    /**
-     * Reads a float from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read float
-     */
-    VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
-        const char* c = this->sift(fail);
-        try {
-            return static_cast<float>(vislib::CharTraitsA::ParseDouble(c));
-        } catch (...) {
-            fail = true;
-        }
-        return 0.0f;
-    }
-
-    /**
-     * Skips an integer in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipInt(bool& fail) { /*const char *c =*/
-        this->sift(fail);
-    }
-
-    /**
-     * Skips an float in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipFloat(bool& fail) { /*const char *c =*/
-        this->sift(fail);
-    }
+struct AtomSettings {
+    bool useC;         //< the colour column is valid
+    bool useDC;        //< the dir colour column is valid
+    bool loadDir;      //< directional data is loaded
+    bool splitDir;     //< atoms with zero direction are stored as plain atoms
+    bool normaliseDir; //< the directions are normalised
+    int dircolMode;    //< the dir colouring mode
+    bool bbox;         //< the bounding box filter is enabled
+    float bboxMin[3];  //< the minimum of the bounding box filter
+    float bboxMax[3];  //< the maximum of the bounding box filter
 };
 
-
 /**
- * IMD Atom file reader class for the float file format
+ * The atoms of one type parsed from one part of the data
  */
-class AtomReaderFloat : public AbstractAtomReader {
-public:
-    /**
-     * Ctor
-     *
-     * @param file The file to read from
-     */
-    AtomReaderFloat(vislib::sys::File& file) : AbstractAtomReader(file) {
-        // Intentionally empty
-    }
-
-    /**
-     * Dtor
-     */
-    ~AtomReaderFloat() {
-        // Intentionally empty
-    }
-
-    /**
-     * Reads an integer from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read integer
-     */
-    VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
-        UINT32 i;
-        if (!this->copyData(&i, 4)) {
-            fail = true;
-        }
-        return i;
-    }
-
-    /**
-     * Reads a float from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read float
-     */
-    VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
-        float f;
-        if (!this->copyData(&f, 4)) {
-            fail = true;
+struct AtomBucket {
+    unsigned int type;
+    std::vector<float> pos, col, dir;
+    bool hasRange = false;
+    float minC = 0.0f, maxC = 0.0f;
+
+    /** Includes 'c' into the colour value range */
+    inline void Include(float c) {
+        if (!this->hasRange) {
+            this->minC = this->maxC = c;
+            this->hasRange = true;
+        } else if (this->minC > c) {
+            this->minC = c;
+        } else if (this->maxC < c) {
+            this->maxC = c;
         }
-        return f;
-    }
-
-    /**
-     * Skips an integer in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipInt(bool& fail) {
-        if (!this->skipData(4))
-            fail = true;
-    }
-
-    /**
-     * Skips an float in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipFloat(bool& fail) {
-        if (!this->skipData(4))
-            fail = true;
     }
 };
 
-
 /**
- * IMD Atom file reader class for the double file format
+ * The atoms parsed from one part of the data. Parts are parsed
+ * independently and merged in file order afterwards.
  */
-class AtomReaderDouble : public AbstractAtomReader {
-public:
-    /**
-     * Ctor
-     *
-     * @param file The file to read from
-     */
-    AtomReaderDouble(vislib::sys::File& file) : AbstractAtomReader(file) {
-        // Intentionally empty
-    }
-
-    /**
-     * Dtor
-     */
-    ~AtomReaderDouble() {
-        // Intentionally empty
-    }
-
-    /**
-     * Reads an integer from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read integer
-     */
-    VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
-        UINT32 i;
-        if (!this->copyData(&i, 4)) {
-            fail = true;
+struct AtomPart {
+    std::vector<AtomBucket> buckets; //< in the order the types first appear
+    SIZE_T count = 0;                //< the number of stored atoms
+    float firstC = 0.0f;             //< the colour value of the first stored atom
+    float minX = 0.0f, minY = 0.0f, minZ = 0.0f, maxX = 0.0f, maxY = 0.0f, maxZ = 0.0f;
+    bool failed = false; //< parsing stopped at a malformed record
+    size_t lastBucket = 0;
+
+    /** Answer the bucket of 'type', creating it if required */
+    inline AtomBucket& Bucket(unsigned int type) {
+        if ((this->lastBucket < this->buckets.size()) && (this->buckets[this->lastBucket].type == type)) {
+            return this->buckets[this->lastBucket];
         }
-        return i;
-    }
-
-    /**
-     * Reads a float from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read float
-     */
-    VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
-        double d;
-        if (!this->copyData(&d, 8)) {
-            fail = true;
+        for (size_t i = 0; i < this->buckets.size(); ++i) {
+            if (this->buckets[i].type == type) {
+                this->lastBucket = i;
+                return this->buckets[i];
+            }
         }
-        return static_cast<float>(d);
-    }
-
-    /**
-     * Skips an integer in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipInt(bool& fail) {
-        if (!this->skipData(4))
-            fail = true;
-    }
-
-    /**
-     * Skips an float in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipFloat(bool& fail) {
-        if (!this->skipData(8))
-            fail = true;
+        this->lastBucket = this->buckets.size();
+        this->buckets.emplace_back();
+        this->buckets.back().type = type;
+        return this->buckets.back();
     }
 };
 
-
 /**
- * IMD Atom file reader class for the float file format with byte switch
+ * Stores the atom 'v' into 'part', unless it is filtered out.
  */
-class AtomReaderFloatSwitched : public AbstractAtomReader {
-public:
-    /**
-     * Ctor
-     *
-     * @param file The file to read from
-     */
-    AtomReaderFloatSwitched(vislib::sys::File& file) : AbstractAtomReader(file) {
-        // Intentionally empty
+void storeAtom(AtomPart& part, float* v, const AtomSettings& s) {
+    const float x = v[VALUE_X], y = v[VALUE_Y], z = v[VALUE_Z];
+    const float c = v[VALUE_C], dc = v[VALUE_DC];
+    if (s.bbox && ((x < s.bboxMin[0]) || (y < s.bboxMin[1]) || (z < s.bboxMin[2]) || (x > s.bboxMax[0]) ||
+                      (y > s.bboxMax[1]) || (z > s.bboxMax[2]))) {
+        return;
     }
 
-    /**
-     * Dtor
-     */
-    ~AtomReaderFloatSwitched() {
-        // Intentionally empty
+    AtomBucket& bucket = part.Bucket(static_cast<unsigned int>(v[VALUE_T]));
+    if (part.count == 0) {
+        part.firstC = c;
+        part.minX = part.maxX = x;
+        part.minY = part.maxY = y;
+        part.minZ = part.maxZ = z;
+    } else {
+        part.minX = std::min(part.minX, x);
+        part.maxX = std::max(part.maxX, x);
+        part.minY = std::min(part.minY, y);
+        part.maxY = std::max(part.maxY, y);
+        part.minZ = std::min(part.minZ, z);
+        part.maxZ = std::max(part.maxZ, z);
     }
-
-    /**
-     * Reads an integer from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read integer
-     */
-    VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
-        UINT32 i;
-        if (!this->copyData(&i, 4)) {
-            fail = true;
-        } else {
-            this->switch4Bytes(&i);
-        }
-        return i;
+    part.count++;
+    if (s.useC)
+        bucket.Include(c);
+    if (s.useDC)
+        bucket.Include(dc);
+
+    if (!s.loadDir) {
+        bucket.pos.insert(bucket.pos.end(), {x, y, z});
+        if (s.useC)
+            bucket.col.push_back(c);
+        return;
     }
 
-    /**
-     * Reads a float from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read float
-     */
-    VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
-        float f;
-        if (!this->copyData(&f, 4)) {
-            fail = true;
-        } else {
-            this->switch4Bytes(&f);
-        }
-        return f;
+    float dx = v[VALUE_DX], dy = v[VALUE_DY], dz = v[VALUE_DZ];
+    if (s.normaliseDir) {
+        vislib::math::Vector<float, 3> dv(dx, dy, dz);
+        dv.Normalise();
+        dx = dv.X();
+        dy = dv.Y();
+        dz = dv.Z();
     }
-
-    /**
-     * Skips an integer in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipInt(bool& fail) {
-        if (!this->skipData(4))
-            fail = true;
+    if (s.splitDir && vislib::math::IsEqual(dx, 0.0f) && vislib::math::IsEqual(dy, 0.0f) &&
+        vislib::math::IsEqual(dz, 0.0f)) {
+        bucket.pos.insert(bucket.pos.end(), {x, y, z});
+        if (s.useC)
+            bucket.col.push_back(c);
+        return;
     }
 
-    /**
-     * Skips an float in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipFloat(bool& fail) {
-        if (!this->skipData(4))
-            fail = true;
+    bucket.dir.insert(bucket.dir.end(), {x, y, z});
+    if (s.dircolMode == 2) {
+        // colour from direction: the squared components blend the axis colours, negative axes are inverted
+        vislib::math::Vector<float, 3> dv(dx, dy, dz);
+        dv.Normalise();
+        float xr = 1.0f, xg = 0.0f, xb = 0.0f, yr = 0.0f, yg = 1.0f, yb = 0.0f, zr = 0.0f, zg = 0.0f, zb = 1.0f;
+        if (dv.X() < 0.0f) {
+            xr = 1.0f - xr;
+            xg = 1.0f - xg;
+            xb = 1.0f - xb;
+        }
+        if (dv.Y() < 0.0f) {
+            yr = 1.0f - yr;
+            yg = 1.0f - yg;
+            yb = 1.0f - yb;
+        }
+        if (dv.Z() < 0.0f) {
+            zr = 1.0f - zr;
+            zg = 1.0f - zg;
+            zb = 1.0f - zb;
+        }
+        dv.Set(dv.X() * dv.X(), dv.Y() * dv.Y(), dv.Z() * dv.Z());
+        bucket.dir.insert(bucket.dir.end(), {xr * dv.X() + yr * dv.Y() + zr * dv.Z(),
+                                                xg * dv.X() + yg * dv.Y() + zg * dv.Z(),
+                                                xb * dv.X() + yb * dv.Y() + zb * dv.Z()});
+    } else if (s.useDC) {
+        bucket.dir.push_back(dc);
+    } else if (s.useC) {
+        bucket.dir.push_back(c);
     }
-};
-
+    bucket.dir.insert(bucket.dir.end(), {dx, dy, dz});
+}
 
 /**
- * IMD Atom file reader class for the double file format with byte switch
+ * Assigns 'value' to all targets of 'column'.
  */
-class AtomReaderDoubleSwitched : public AbstractAtomReader {
-public:
-    /**
-     * Ctor
-     *
-     * @param file The file to read from
-     */
-    AtomReaderDoubleSwitched(vislib::sys::File& file) : AbstractAtomReader(file) {
-        // Intentionally empty
-    }
-
-    /**
-     * Dtor
-     */
-    ~AtomReaderDoubleSwitched() {
-        // Intentionally empty
-    }
-
-    /**
-     * Reads an integer from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read integer
-     */
-    VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
-        UINT32 i;
-        if (!this->copyData(&i, 4)) {
-            fail = true;
-        } else {
-            this->switch4Bytes(&i);
+VISLIB_FORCEINLINE void assignColumn(float* v, const AtomColumn& column, float value) {
+    for (unsigned int t = 0; t < VALUE_COUNT; ++t) {
+        if ((column.targets & (1u << t)) != 0) {
+            v[t] = value;
         }
-        return i;
     }
+}
 
-    /**
-     * Reads a float from the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The read float
-     */
-    VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
-        double d;
-        if (!this->copyData(&d, 8)) {
-            fail = true;
-        } else {
-            this->switch8Bytes(&d);
+/**
+ * Parses the ASCII atoms in [begin, end), one per line, which must start at
+ * the beginning of a line. Parsing stops at the first malformed line.
+ */
+void parseAsciiAtoms(const char* begin, const char* end, const std::vector<AtomColumn>& columns,
+    const AtomSettings& settings, AtomPart& part) {
+    using namespace megamol::moldyn::io::text;
+    float v[VALUE_COUNT];
+    const char* p = begin;
+    while (p < end) {
+        const char* lineEnd = NextLine(p, end);
+        p = SkipSpace(p, lineEnd);
+        if (p == lineEnd) {
+            continue; // empty line
         }
-        return static_cast<float>(d);
-    }
-
-    /**
-     * Skips an integer in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipInt(bool& fail) {
-        if (!this->skipData(4))
-            fail = true;
+        std::fill(v, v + VALUE_COUNT, 0.0f);
+        for (const AtomColumn& column : columns) {
+            p = SkipSpace(p, lineEnd);
+            if (p == lineEnd) {
+                part.failed = true;
+                return;
+            }
+            if (column.targets == 0) {
+                p = SkipToken(p, lineEnd);
+                continue;
+            }
+            float f;
+            if (column.isInt) {
+                INT64 i;
+                if (!ParseInt(p, lineEnd, i)) {
+                    part.failed = true;
+                    return;
+                }
+                f = static_cast<float>(static_cast<UINT32>(i));
+            } else if (!ParseFloat(p, lineEnd, f)) {
+                part.failed = true;
+                return;
+            }
+            assignColumn(v, column, f);
+        }
+        storeAtom(part, v, settings);
+        p = lineEnd;
     }
+}
 
-    /**
-     * Skips an float in the input data
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     */
-    VISLIB_FORCEINLINE void SkipFloat(bool& fail) {
-        if (!this->skipData(8))
-            fail = true;
+/**
+ * Parses the binary atoms in [begin, end), which must hold complete records.
+ *
+ * @param floatSize The size of the floating-point values, 4 or 8 bytes
+ * @param swap Whether the byte order of the values must be switched
+ */
+void parseBinaryAtoms(const char* begin, const char* end, const std::vector<AtomColumn>& columns,
+    unsigned int floatSize, bool swap, const AtomSettings& settings, AtomPart& part) {
+    float v[VALUE_COUNT];
+    char bytes[8];
+    const char* p = begin;
+    while (p < end) {
+        std::fill(v, v + VALUE_COUNT, 0.0f);
+        for (const AtomColumn& column : columns) {
+            const unsigned int size = column.isInt ? 4 : floatSize;
+            if (column.targets != 0) {
+                ::memcpy(bytes, p, size);
+                if (swap) {
+                    std::reverse(bytes, bytes + size);
+                }
+                float f;
+                if (column.isInt) {
+                    UINT32 i;
+                    ::memcpy(&i, bytes, 4);
+                    f = static_cast<float>(i);
+                } else if (size == 4) {
+                    ::memcpy(&f, bytes, 4);
+                } else {
+                    double d;
+                    ::memcpy(&d, bytes, 8);
+                    f = static_cast<float>(d);
+                }
+                assignColumn(v, column, f);
+            }
+            p += size;
+        }
+        storeAtom(part, v, settings);
     }
-};
+}
 
 } /* end anonymous namespace */
 
@@ -785,6 +400,7 @@ IMDAtomDataSource::IMDAtomDataSource()
         , dirmaxColumnValSlot("dir::maxColumnValue", "The maximum value for the colour mapping of the column")
         , dirradiusSlot("dir::radius", "The radius to be used for the data")
         , dirNormDirSlot("dir::normalise", "")
+        , cacheSlot("cache", "Keeps the loaded particles in a binary file next to the data file for faster reloading")
         , posData()
         , colData()
         , headerMinX(0.0f)
@@ -893,6 +509,9 @@ IMDAtomDataSource::IMDAtomDataSource()
     this->MakeSlotAvailable(&this->dirradiusSlot);
     this->dirNormDirSlot << new core::param::BoolParam(false);
     this->MakeSlotAvailable(&this->dirNormDirSlot);
+
+    this->cacheSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->cacheSlot);
 }
 
 
@@ -1155,6 +774,17 @@ void IMDAtomDataSource::assertData() {
         return;
     }
 
+    const bool useCache = this->cacheSlot.Param<core::param::BoolParam>()->Value();
+    const uint64_t key = useCache ? this->cacheKey(filename) : 0;
+    auto cachePath = filename;
+    cachePath += ".mmcache";
+    if ((key != 0) && this->loadCache(cachePath, key)) {
+        file.Close();
+        this->datahash++;
+        this->posXFilterUpdate(this->posXFilterNow);
+        return;
+    }
+
     //    Log::DefaultLog.WriteInfo(
     //        "IMDAtom with %d data colums:\n", static_cast<int>(header.captions.Count()));
     //    for (SIZE_T i = 0; i < header.captions.Count(); i++) {
@@ -1179,25 +809,14 @@ void IMDAtomDataSource::assertData() {
     bool splitLoadDir = this->splitLoadDiredDataSlot.Param<core::param::BoolParam>()->Value();
 
     bool retval = false;
+    bool complete = true;
     switch (header.format) {
     case 'A': // ASCII
-        retval = this->readData<AtomReaderASCII>(file, header, loadDir, splitLoadDir);
-        break;
     case 'B': // binary, big endian, double
-        retval = (machineLittleEndian) ? this->readData<AtomReaderDoubleSwitched>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderDouble>(file, header, loadDir, splitLoadDir);
-        break;
     case 'b': // binary, big endian, float
-        retval = (machineLittleEndian) ? this->readData<AtomReaderFloatSwitched>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderFloat>(file, header, loadDir, splitLoadDir);
-        break;
     case 'L': // binary, little endian, double
-        retval = (machineLittleEndian) ? this->readData<AtomReaderDouble>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderDoubleSwitched>(file, header, loadDir, splitLoadDir);
-        break;
     case 'l': // binary, little endian float
-        retval = (machineLittleEndian) ? this->readData<AtomReaderFloat>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderFloatSwitched>(file, header, loadDir, splitLoadDir);
+        retval = this->readData(file, header, loadDir, splitLoadDir, machineLittleEndian, complete);
         break;
     default:
         Log::DefaultLog.WriteError("Unable to read imd file: Illegal format\n");
@@ -1232,6 +851,11 @@ void IMDAtomDataSource::assertData() {
 
         // All parameters must influence the data hash
 
+        // a partially read file must not be served from the cache
+        if (key != 0 && complete) {
+            this->saveCache(cachePath, key);
+        }
+
     } else {
         // error already logged
         // this->posData.EnforceSize(0, true);
@@ -1420,67 +1044,15 @@ bool IMDAtomDataSource::readHeader(vislib::sys::File& file, IMDAtomDataSource::H
     return false;
 }
 
-template<typename T>
-void IMDAtomDataSource::readToIntColumn(T& reader, bool& fail, unsigned int* column, ...) {
-    const int numKnownColumns = 6;
-    float* out;
-    unsigned int col;
-    va_list vl;
-    va_start(vl, column);
-    for (int i = 0; i < numKnownColumns; i++) {
-        col = va_arg(vl, unsigned int);
-        out = va_arg(vl, float*);
-        if (col == *column) {
-            *out = static_cast<float>(reader.ReadInt(fail));
-            va_end(vl);
-            (*column)++;
-            return;
-        }
-    }
-    va_end(vl);
-    reader.SkipInt(fail);
-    (*column)++;
-}
-
-template<typename T>
-void IMDAtomDataSource::readToFloatColumn(T& reader, bool& fail, unsigned int* column, ...) {
-    const int numKnownColumns = 6;
-    float* out;
-    unsigned int col;
-    va_list vl;
-    va_start(vl, column);
-    for (int i = 0; i < numKnownColumns; i++) {
-        col = va_arg(vl, unsigned int);
-        out = va_arg(vl, float*);
-        if (col == *column) {
-            *out = static_cast<float>(reader.ReadFloat(fail));
-            va_end(vl);
-            (*column)++;
-            return;
-        }
-    }
-    va_end(vl);
-    reader.SkipFloat(fail);
-    (*column)++;
-}
-
 /*
  * IMDAtomDataSource::readData
  */
-template<typename T>
-bool IMDAtomDataSource::readData(
-    vislib::sys::File& file, const IMDAtomDataSource::HeaderData& header, bool loadDir, bool splitDir) {
-    T reader(file);
-    bool fail = false;
-    float x = 0.0f, y = 0.0f, z = 0.0f;
-    bool first = true;
-    float c = 0.0f, dc = 0.0f, t = 0.0f;
-    float dx = 0.0f, dy = 0.0f, dz = 0.0f;
-    unsigned int column;
+bool IMDAtomDataSource::readData(vislib::sys::File& file, const IMDAtomDataSource::HeaderData& header, bool loadDir,
+    bool splitDir, bool machineLittleEndian, bool& complete) {
+    using megamol::core::utility::log::Log;
     unsigned int colcolumn = UINT_MAX;
     unsigned int dircolcolumn = UINT_MAX;
     unsigned int typecolumn = UINT_MAX;
-    // TODO type column
 
     this->typeData.Clear();
     this->minC.Clear();
@@ -1493,7 +1065,6 @@ bool IMDAtomDataSource::readData(
     vislib::PtrArray<vislib::RawStorageWriter> colWriters;
     vislib::PtrArray<vislib::RawStorageWriter> dirWriters;
 
-    bool normaliseDir = this->dirNormDirSlot.Param<core::param::BoolParam>()->Value();
     vislib::StringA dirXColName = this->dirXColNameSlot.Param<core::param::StringParam>()->Value().c_str();
     vislib::StringA dirYColName = this->dirYColNameSlot.Param<core::param::StringParam>()->Value().c_str();
     vislib::StringA dirZColName = this->dirZColNameSlot.Param<core::param::StringParam>()->Value().c_str();
@@ -1504,7 +1075,6 @@ bool IMDAtomDataSource::readData(
     ASSERT(!loadDir || (dirYCol >= 0));
     ASSERT(!loadDir || (dirZCol >= 0));
     int dircolMode = this->dircolourModeSlot.Param<core::param::EnumParam>()->Value();
-
     if (true) {
         // type from column
         vislib::StringA typecolname(this->typeColumnSlot.Param<core::param::StringParam>()->Value().c_str());
@@ -1630,283 +1200,357 @@ bool IMDAtomDataSource::readData(
         }
     }
 
-    while (!fail) {
-        column = 0;
-
-        if (header.id) {
-            // these columns can be filled from anything you put into the respective parameters (by column name)
-            // problem: type does not exist!
-            // TODO  refactor, add type column
-            this->readToIntColumn(reader, fail, &column, colcolumn, &c, dirXCol, &dx, dirYCol, &dy, dirZCol, &dz,
-                dircolcolumn, &dc, typecolumn, &t);
-            // if ((column == colcolumn) || (column == dirXCol) || (column == dirYCol) || (column == dirZCol) || (column
-            // == dircolcolumn)){
-            //    float f = static_cast<float>(reader.ReadInt(fail));
-            //    if (column == colcolumn) c = f;
-            //    if (column == dirXCol) dx = f;
-            //    if (column == dirYCol) dy = f;
-            //    if (column == dirZCol) dz = f;
-            //    if (column == dircolcolumn) dc = f;
-            //} else {
-            //    reader.SkipInt(fail);
-            //}
-            // column++;
+    // the data columns in file order and the values they are stored to
+    std::vector<AtomColumn> columns;
+    auto addColumn = [&](bool isInt) {
+        const unsigned int index = static_cast<unsigned int>(columns.size());
+        unsigned int targets = 0;
+        if (index == colcolumn)
+            targets |= 1u << VALUE_C;
+        if (index == dircolcolumn)
+            targets |= 1u << VALUE_DC;
+        if (static_cast<INT_PTR>(index) == dirXCol)
+            targets |= 1u << VALUE_DX;
+        if (static_cast<INT_PTR>(index) == dirYCol)
+            targets |= 1u << VALUE_DY;
+        if (static_cast<INT_PTR>(index) == dirZCol)
+            targets |= 1u << VALUE_DZ;
+        if (index == typecolumn)
+            targets |= 1u << VALUE_T;
+        columns.push_back({isInt, targets});
+    };
+    if (header.id)
+        addColumn(true);
+    if (header.type)
+        addColumn(true);
+    if (header.mass)
+        addColumn(false);
+    for (int i = 0; i < header.pos; i++) {
+        addColumn(false);
+        if (i < 3)
+            columns.back().targets |= 1u << (VALUE_X + i);
+    }
+    for (int i = 0; i < header.vel + header.dat; i++) {
+        addColumn(false);
+    }
+
+    AtomSettings settings;
+    settings.useC = (colcolumn != UINT_MAX);
+    settings.useDC = (dircolcolumn != UINT_MAX);
+    settings.loadDir = loadDir;
+    settings.splitDir = splitDir;
+    settings.normaliseDir = this->dirNormDirSlot.Param<core::param::BoolParam>()->Value();
+    settings.dircolMode = dircolMode;
+    settings.bbox = this->bboxEnabledSlot.Param<core::param::BoolParam>()->Value();
+    const auto& bboxMin = this->bboxMinSlot.Param<core::param::Vector3fParam>()->Value();
+    const auto& bboxMax = this->bboxMaxSlot.Param<core::param::Vector3fParam>()->Value();
+    for (int i = 0; i < 3; i++) {
+        settings.bboxMin[i] = bboxMin[i];
+        settings.bboxMax[i] = bboxMax[i];
+    }
+
+    const bool ascii = (header.format == 'A');
+    const unsigned int floatSize = ((header.format == 'B') || (header.format == 'L')) ? 8 : 4;
+    const bool swap = ((header.format == 'B') || (header.format == 'b')) == machineLittleEndian;
+    SIZE_T recordSize = 0;
+    for (const AtomColumn& column : columns) {
+        recordSize += column.isInt ? 4 : floatSize;
+    }
+    if (recordSize == 0) {
+        Log::DefaultLog.WriteError("Unable to read imd file: no data columns\n");
+        return false;
+    }
+
+    // Blocks are split into parts at record boundaries, which are parsed in parallel and merged in file order, so
+    // types are numbered in the order they first appear. The next block is read while the current one is parsed.
+    auto readBlock = [&file](std::vector<char>& buf, SIZE_T offset) -> SIZE_T {
+        buf.resize(offset + blockSize);
+        try {
+            return offset + static_cast<SIZE_T>(file.Read(buf.data() + offset, blockSize));
+        } catch (...) {
+            return offset;
         }
-        if (header.type) {
-            this->readToIntColumn(reader, fail, &column, colcolumn, &c, dirXCol, &dx, dirYCol, &dy, dirZCol, &dz,
-                dircolcolumn, &dc, typecolumn, &t);
-            // if ((column == colcolumn) || (column == dirXCol) || (column == dirYCol) || (column == dirZCol) || (column
-            // == dircolcolumn)){
-            //    float f = static_cast<float>(reader.ReadInt(fail));
-            //    if (column == colcolumn) c = f;
-            //    if (column == dirXCol) dx = f;
-            //    if (column == dirYCol) dy = f;
-            //    if (column == dirZCol) dz = f;
-            //    if (column == dircolcolumn) dc = f;
-            //} else {
-            //    reader.SkipInt(fail);
-            //}
-            // column++;
+    };
+    const int partCnt = 4 * omp_get_max_threads();
+    std::vector<AtomPart> parts;
+    std::vector<char> cur, next;
+    SIZE_T curSize = readBlock(cur, 0);
+    bool first = true;
+    bool failed = false;
+    while (true) {
+        const bool isLast = (curSize < cur.size());
+
+        // the block ends after its last complete record, the rest is carried over
+        SIZE_T end = curSize;
+        if (ascii) {
+            if (!isLast) {
+                while ((end > 0) && (cur[end - 1] != '\n'))
+                    --end;
+            }
+        } else {
+            end -= end % recordSize;
         }
-        if (header.mass) {
-            this->readToFloatColumn(reader, fail, &column, colcolumn, &c, dirXCol, &dx, dirYCol, &dy, dirZCol, &dz,
-                dircolcolumn, &dc, typecolumn, &t);
-            // if ((column == colcolumn) || (column == dirXCol) || (column == dirYCol) || (column == dirZCol) || (column
-            // == dircolcolumn)){
-            //    float f = reader.ReadFloat(fail);
-            //    if (column == colcolumn) c = f;
-            //    if (column == dirXCol) dx = f;
-            //    if (column == dirYCol) dy = f;
-            //    if (column == dirZCol) dz = f;
-            //    if (column == dircolcolumn) dc = f;
-            //} else {
-            //    reader.SkipFloat(fail);
-            //}
-            // column++;
+        std::future<SIZE_T> pending;
+        if (!isLast) {
+            const SIZE_T carry = curSize - end;
+            next.resize(carry);
+            ::memcpy(next.data(), cur.data() + end, carry);
+            pending = std::async(std::launch::async, readBlock, std::ref(next), carry);
         }
-        for (int i = 0; i < header.pos; i++) {
-            if (i == 0) {
-                x = reader.ReadFloat(fail);
-                if (column == colcolumn)
-                    c = x;
-                if (column == dirXCol)
-                    dx = x;
-                if (column == dirYCol)
-                    dy = x;
-                if (column == dirZCol)
-                    dz = x;
-                if (column == dircolcolumn)
-                    dc = x;
-            }
-            if (i == 1) {
-                y = reader.ReadFloat(fail);
-                if (column == colcolumn)
-                    c = y;
-                if (column == dirXCol)
-                    dx = y;
-                if (column == dirYCol)
-                    dy = y;
-                if (column == dirZCol)
-                    dz = y;
-                if (column == dircolcolumn)
-                    dc = y;
+
+        std::vector<const char*> bounds;
+        if (ascii) {
+            bounds = text::SplitLines(cur.data(), cur.data() + end, partCnt);
+        } else {
+            const SIZE_T records = end / recordSize;
+            bounds.push_back(cur.data());
+            for (int i = 1; i < partCnt; i++) {
+                const char* cut = cur.data() + (records * i / partCnt) * recordSize;
+                if (cut > bounds.back())
+                    bounds.push_back(cut);
             }
-            if (i == 2) {
-                z = reader.ReadFloat(fail);
-                if (column == colcolumn)
-                    c = z;
-                if (column == dirXCol)
-                    dx = z;
-                if (column == dirYCol)
-                    dy = z;
-                if (column == dirZCol)
-                    dz = z;
-                if (column == dircolcolumn)
-                    dc = z;
+            bounds.push_back(cur.data() + end);
+        }
+        parts.clear();
+        parts.resize(bounds.size() - 1);
+#pragma omp parallel for schedule(dynamic)
+        for (long long i = 0; i < static_cast<long long>(parts.size()); i++) {
+            if (ascii) {
+                parseAsciiAtoms(bounds[i], bounds[i + 1], columns, settings, parts[i]);
+            } else {
+                parseBinaryAtoms(bounds[i], bounds[i + 1], columns, floatSize, swap, settings, parts[i]);
             }
-            if (i >= 3) {
-                if ((column == colcolumn) || (column == dirXCol) || (column == dirYCol) || (column == dirZCol) ||
-                    (column == dircolcolumn)) {
-                    float f = reader.ReadFloat(fail);
-                    if (column == colcolumn)
-                        c = f;
-                    if (column == dirXCol)
-                        dx = f;
-                    if (column == dirYCol)
-                        dy = f;
-                    if (column == dirZCol)
-                        dz = f;
-                    if (column == dircolcolumn)
-                        dc = f;
+        }
+
+        for (AtomPart& part : parts) {
+            if (part.count > 0) {
+                if (first) {
+                    first = false;
+                    this->minX = part.minX;
+                    this->maxX = part.maxX;
+                    this->minY = part.minY;
+                    this->maxY = part.maxY;
+                    this->minZ = part.minZ;
+                    this->maxZ = part.maxZ;
                 } else {
-                    reader.SkipFloat(fail);
+                    this->minX = std::min(this->minX, part.minX);
+                    this->maxX = std::max(this->maxX, part.maxX);
+                    this->minY = std::min(this->minY, part.minY);
+                    this->maxY = std::max(this->maxY, part.maxY);
+                    this->minZ = std::min(this->minZ, part.minZ);
+                    this->maxZ = std::max(this->maxZ, part.maxZ);
                 }
             }
-            column++;
-        }
-        for (int i = 0; i < header.vel; i++) {
-            this->readToFloatColumn(reader, fail, &column, colcolumn, &c, dirXCol, &dx, dirYCol, &dy, dirZCol, &dz,
-                dircolcolumn, &dc, typecolumn, &t);
-            // if ((column == colcolumn) || (column == dirXCol) || (column == dirYCol) || (column == dirZCol) || (column
-            // == dircolcolumn)){
-            //    float f = reader.ReadFloat(fail);
-            //    if (column == colcolumn) c = f;
-            //    if (column == dirXCol) dx = f;
-            //    if (column == dirYCol) dy = f;
-            //    if (column == dirZCol) dz = f;
-            //    if (column == dircolcolumn) dc = f;
-            //} else {
-            //    reader.SkipFloat(fail);
-            //}
-            // column++;
+            for (const AtomBucket& bucket : part.buckets) {
+                int rawIdx = static_cast<int>(this->typeData.IndexOf(bucket.type));
+                if (rawIdx == static_cast<int>(vislib::Array<unsigned int>::INVALID_POS)) {
+                    this->typeData.Append(bucket.type);
+                    rawIdx = static_cast<int>(this->typeData.Count() - 1);
+                    this->posData.Append(new vislib::RawStorage());
+                    this->colData.Append(new vislib::RawStorage());
+                    this->allDirData.Append(new vislib::RawStorage());
+                    // the range of the very first atom's type starts at its value, the others at [0, 1]
+                    const bool firstType = (this->typeData.Count() == 1);
+                    this->minC.Append(firstType ? part.firstC : 0.0f);
+                    this->maxC.Append(firstType ? part.firstC : 1.0f);
+                    posWriters.Append(new vislib::RawStorageWriter(*(this->posData[rawIdx]), 0, 0, 10 * 1024 * 1024));
+                    colWriters.Append(new vislib::RawStorageWriter(*(this->colData[rawIdx]), 0, 0, 10 * 1024 * 1024));
+                    dirWriters.Append(
+                        new vislib::RawStorageWriter(*(this->allDirData[rawIdx]), 0, 0, 10 * 1024 * 1024));
+                }
+                if (bucket.hasRange) {
+                    this->minC[rawIdx] = std::min(this->minC[rawIdx], bucket.minC);
+                    this->maxC[rawIdx] = std::max(this->maxC[rawIdx], bucket.maxC);
+                }
+                posWriters[rawIdx]->Write(bucket.pos.data(), bucket.pos.size() * sizeof(float));
+                colWriters[rawIdx]->Write(bucket.col.data(), bucket.col.size() * sizeof(float));
+                dirWriters[rawIdx]->Write(bucket.dir.data(), bucket.dir.size() * sizeof(float));
+            }
+            if (part.failed) {
+                failed = true;
+                break;
+            }
         }
-        for (int i = 0; i < header.dat; i++) {
-            this->readToFloatColumn(reader, fail, &column, colcolumn, &c, dirXCol, &dx, dirYCol, &dy, dirZCol, &dz,
-                dircolcolumn, &dc, typecolumn, &t);
-            // if ((column == colcolumn) || (column == dirXCol) || (column == dirYCol) || (column == dirZCol) || (column
-            // == dircolcolumn)){
-            //    float f = reader.ReadFloat(fail);
-            //    if (column == colcolumn) c = f;
-            //    if (column == dirXCol) dx = f;
-            //    if (column == dirYCol) dy = f;
-            //    if (column == dirZCol) dz = f;
-            //    if (column == dircolcolumn) dc = f;
-            //} else {
-            //    reader.SkipFloat(fail);
-            //}
-            // column++;
+
+        if (failed || isLast) {
+            if (pending.valid())
+                pending.wait();
+            break;
         }
+        curSize = pending.get();
+        std::swap(cur, next);
+    }
+    if (failed) {
+        Log::DefaultLog.WriteWarn("Stopped reading imd file at a malformed atom record\n");
+    }
+    complete = !failed;
 
-        if (!fail) {
+    for (int i = 0; i < static_cast<int>(posData.Count()); i++) {
+        this->posData[i]->EnforceSize(first ? 0 : posWriters[i]->End(), true);
+        this->colData[i]->EnforceSize(first ? 0 : colWriters[i]->End(), true);
+        this->allDirData[i]->EnforceSize(first ? 0 : dirWriters[i]->End(), true);
+    }
+    return !first;
+}
 
-            if (this->bboxEnabledSlot.Param<core::param::BoolParam>()->Value()) {
-                vislib::math::Vector<float, 3> p(x, y, z),
-                    minP(this->bboxMinSlot.Param<core::param::Vector3fParam>()->Value()),
-                    maxP(this->bboxMaxSlot.Param<core::param::Vector3fParam>()->Value());
-                if ((p.GetX() < minP.GetX() || p.GetY() < minP.GetY() || p.GetZ() < minP.GetZ()) ||
-                    (p.GetX() > maxP.GetX() || p.GetY() > maxP.GetY() || p.GetZ() > maxP.GetZ()))
-                    continue;
-            }
 
+/*
+ * IMDAtomDataSource::cacheKey
+ */
+uint64_t IMDAtomDataSource::cacheKey(const std::filesystem::path& filename) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filename, ec);
+    if (ec) {
+        return 0;
+    }
+    const auto time = std::filesystem::last_write_time(filename, ec);
+    if (ec) {
+        return 0;
+    }
 
-            int rawIdx = 0;
-            if ((rawIdx = static_cast<int>(typeData.IndexOf(static_cast<unsigned int>(t)))) ==
-                static_cast<int>(vislib::Array<unsigned int>::INVALID_POS)) {
-                typeData.Append(static_cast<unsigned int>(t));
-                rawIdx = static_cast<int>(typeData.Count() - 1);
-                this->posData.Append(new vislib::RawStorage());
-                this->colData.Append(new vislib::RawStorage());
-                this->allDirData.Append(new vislib::RawStorage());
-                this->minC.Append(0.0f);
-                this->maxC.Append(1.0f);
-                posWriters.Append(new vislib::RawStorageWriter(*(this->posData[rawIdx]), 0, 0, 10 * 1024 * 1024));
-                colWriters.Append(new vislib::RawStorageWriter(*(this->colData[rawIdx]), 0, 0, 10 * 1024 * 1024));
-                dirWriters.Append(new vislib::RawStorageWriter(*(this->allDirData[rawIdx]), 0, 0, 10 * 1024 * 1024));
-            }
+    // everything deciding which atoms are stored how
+    uint64_t key = 14695981039346656037ull;
+    key = fold(key, static_cast<uint64_t>(size));
+    key = fold(key, static_cast<uint64_t>(time.time_since_epoch().count()));
+    key = fold(key, static_cast<uint64_t>(this->colourModeSlot.Param<core::param::EnumParam>()->Value()));
+    key = fold(key, this->colourColumnSlot.Param<core::param::StringParam>()->Value());
+    key = fold(key, this->typeColumnSlot.Param<core::param::StringParam>()->Value());
+    key = fold(key, static_cast<uint64_t>(this->splitLoadDiredDataSlot.Param<core::param::BoolParam>()->Value()));
+    key = fold(key, this->dirXColNameSlot.Param<core::param::StringParam>()->Value());
+    key = fold(key, this->dirYColNameSlot.Param<core::param::StringParam>()->Value());
+    key = fold(key, this->dirZColNameSlot.Param<core::param::StringParam>()->Value());
+    key = fold(key, static_cast<uint64_t>(this->dircolourModeSlot.Param<core::param::EnumParam>()->Value()));
+    key = fold(key, this->dircolourColumnSlot.Param<core::param::StringParam>()->Value());
+    key = fold(key, static_cast<uint64_t>(this->dirNormDirSlot.Param<core::param::BoolParam>()->Value()));
+    const bool bbox = this->bboxEnabledSlot.Param<core::param::BoolParam>()->Value();
+    key = fold(key, static_cast<uint64_t>(bbox));
+    if (bbox) {
+        const auto& bboxMin = this->bboxMinSlot.Param<core::param::Vector3fParam>()->Value();
+        const auto& bboxMax = this->bboxMaxSlot.Param<core::param::Vector3fParam>()->Value();
+        for (int i = 0; i < 3; i++) {
+            uint32_t bits;
+            ::memcpy(&bits, &bboxMin[i], sizeof(bits));
+            key = fold(key, bits);
+            ::memcpy(&bits, &bboxMax[i], sizeof(bits));
+            key = fold(key, bits);
+        }
+    }
+    return key;
+}
 
-            if (!first) {
-                if (this->minX > x)
-                    this->minX = x;
-                else if (this->maxX < x)
-                    this->maxX = x;
-                if (this->minY > y)
-                    this->minY = y;
-                else if (this->maxY < y)
-                    this->maxY = y;
-                if (this->minZ > z)
-                    this->minZ = z;
-                else if (this->maxZ < z)
-                    this->maxZ = z;
-            } else {
-                first = false;
-                this->minX = this->maxX = x;
-                this->minY = this->maxY = y;
-                this->minZ = this->maxZ = z;
-                this->minC[rawIdx] = this->maxC[rawIdx] = c;
-            }
-            if (colcolumn != UINT_MAX) {
-                if (this->minC[rawIdx] > c)
-                    this->minC[rawIdx] = c;
-                else if (this->maxC[rawIdx] < c)
-                    this->maxC[rawIdx] = c;
-            }
-            if (dircolcolumn != UINT_MAX) {
-                if (this->minC[rawIdx] > dc)
-                    this->minC[rawIdx] = dc;
-                else if (this->maxC[rawIdx] < dc)
-                    this->maxC[rawIdx] = dc;
-            }
 
-            if (loadDir) {
-                if (normaliseDir) {
-                    vislib::math::Vector<float, 3> dv(dx, dy, dz);
-                    dv.Normalise();
-                    dx = dv.X();
-                    dy = dv.Y();
-                    dz = dv.Z();
-                }
-                if (splitDir && vislib::math::IsEqual(dx, 0.0f) && vislib::math::IsEqual(dy, 0.0f) &&
-                    vislib::math::IsEqual(dz, 0.0f)) {
-                    *posWriters[rawIdx] << x << y << z;
-                    if (colcolumn != UINT_MAX)
-                        *colWriters[rawIdx] << c;
-                    // TODO type column??? vermutlich net
-                } else {
-                    *dirWriters[rawIdx] << x << y << z;
-                    if (dircolMode == 2) {
-                        vislib::math::Vector<float, 3> dv(dx, dy, dz);
-                        dv.Normalise();
-                        float xr = 1.0f, xg = 0.0f, xb = 0.0f, yr = 0.0f, yg = 1.0f, yb = 0.0f, zr = 0.0f, zg = 0.0f,
-                              zb = 1.0f;
-                        if (dv.X() < 0.0f) {
-                            xr = 1.0f - xr;
-                            xg = 1.0f - xg;
-                            xb = 1.0f - xb;
-                        }
-                        if (dv.Y() < 0.0f) {
-                            yr = 1.0f - yr;
-                            yg = 1.0f - yg;
-                            yb = 1.0f - yb;
-                        }
-                        if (dv.Z() < 0.0f) {
-                            zr = 1.0f - zr;
-                            zg = 1.0f - zg;
-                            zb = 1.0f - zb;
-                        }
-                        dv.Set(dv.X() * dv.X(), dv.Y() * dv.Y(), dv.Z() * dv.Z());
+/*
+ * IMDAtomDataSource::loadCache
+ */
+bool IMDAtomDataSource::loadCache(const std::filesystem::path& path, uint64_t key) {
+    using megamol::core::utility::log::Log;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
 
-                        *dirWriters[rawIdx] << (xr * dv.X() + yr * dv.Y() + zr * dv.Z());
-                        *dirWriters[rawIdx] << (xg * dv.X() + yg * dv.Y() + zg * dv.Z());
-                        *dirWriters[rawIdx] << (xb * dv.X() + yb * dv.Y() + zb * dv.Z());
+    char magic[8];
+    uint32_t version = 0, types = 0;
+    uint64_t fileKey = 0;
+    float bbox[6];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&types), sizeof(types));
+    file.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+    file.read(reinterpret_cast<char*>(bbox), sizeof(bbox));
+    if (!file || (std::memcmp(magic, cacheMagic, sizeof(magic)) != 0) || (version != cacheVersion) ||
+        (fileKey != key)) {
+        Log::DefaultLog.WriteWarn(
+            "%hs: ignoring outdated particle cache %s", ClassName(), path.generic_u8string().c_str());
+        return false;
+    }
 
-                    } else if (dircolcolumn != UINT_MAX)
-                        *dirWriters[rawIdx] << dc;
-                    else if (colcolumn != UINT_MAX)
-                        *dirWriters[rawIdx] << c;
-                    *dirWriters[rawIdx] << dx << dy << dz;
-                }
-            } else {
-                *posWriters[rawIdx] << x << y << z;
-                if (colcolumn != UINT_MAX)
-                    *colWriters[rawIdx] << c;
+    this->typeData.Clear();
+    this->minC.Clear();
+    this->maxC.Clear();
+    this->posData.Clear();
+    this->colData.Clear();
+    this->allDirData.Clear();
+    for (uint32_t i = 0; i < types; i++) {
+        uint32_t type = 0;
+        float range[2] = {0.0f, 1.0f};
+        file.read(reinterpret_cast<char*>(&type), sizeof(type));
+        file.read(reinterpret_cast<char*>(range), sizeof(range));
+        this->typeData.Append(type);
+        this->minC.Append(range[0]);
+        this->maxC.Append(range[1]);
+        for (auto* data : {&this->posData, &this->colData, &this->allDirData}) {
+            uint64_t size = 0;
+            file.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!file) {
+                break;
             }
+            data->Append(new vislib::RawStorage(static_cast<SIZE_T>(size)));
+            file.read(data->Last()->As<char>(), static_cast<std::streamsize>(size));
         }
     }
+    if (!file) {
+        Log::DefaultLog.WriteWarn("%hs: particle cache %s is truncated", ClassName(), path.generic_u8string().c_str());
+        this->typeData.Clear();
+        this->minC.Clear();
+        this->maxC.Clear();
+        this->posData.Clear();
+        this->colData.Clear();
+        this->allDirData.Clear();
+        return false;
+    }
+
+    this->minX = bbox[0];
+    this->minY = bbox[1];
+    this->minZ = bbox[2];
+    this->maxX = bbox[3];
+    this->maxY = bbox[4];
+    this->maxZ = bbox[5];
+    return true;
+}
 
-    if (!first) {
-        for (int i = 0; i < static_cast<int>(posData.Count()); i++) {
-            this->posData[i]->EnforceSize(posWriters[i]->End(), true);
-            this->colData[i]->EnforceSize(colWriters[i]->End(), true);
-            this->allDirData[i]->EnforceSize(dirWriters[i]->End(), true);
+
+/*
+ * IMDAtomDataSource::saveCache
+ */
+bool IMDAtomDataSource::saveCache(const std::filesystem::path& path, uint64_t key) const {
+    using megamol::core::utility::log::Log;
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        const uint32_t header[2] = {cacheVersion, static_cast<uint32_t>(this->typeData.Count())};
+        const float bbox[6] = {this->minX, this->minY, this->minZ, this->maxX, this->maxY, this->maxZ};
+        file.write(cacheMagic, sizeof(cacheMagic));
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        file.write(reinterpret_cast<const char*>(bbox), sizeof(bbox));
+        for (SIZE_T i = 0; i < this->typeData.Count(); i++) {
+            const uint32_t type = this->typeData[i];
+            const float range[2] = {this->minC[i], this->maxC[i]};
+            file.write(reinterpret_cast<const char*>(&type), sizeof(type));
+            file.write(reinterpret_cast<const char*>(range), sizeof(range));
+            for (const auto* data : {this->posData[i], this->colData[i], this->allDirData[i]}) {
+                const uint64_t size = data->GetSize();
+                file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                file.write(data->As<char>(), static_cast<std::streamsize>(size));
+            }
         }
-    } else {
-        for (int i = 0; i < static_cast<int>(posData.Count()); i++) {
-            this->posData[i]->EnforceSize(0, true);
-            this->colData[i]->EnforceSize(0, true);
-            this->allDirData[i]->EnforceSize(0, true);
+        if (!file) {
+            Log::DefaultLog.WriteWarn(
+                "%hs: could not write particle cache %s", ClassName(), tmpPath.generic_u8string().c_str());
+            return false;
         }
     }
-    return !first;
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        Log::DefaultLog.WriteWarn("%hs: could not write particle cache %s: %s", ClassName(),
+            path.generic_u8string().c_str(), ec.message().c_str());
+        return false;
+    }
+    return true;
 }
 
 // TODO das ist eigentlich kruscht, das sollte wenn dann ein region-filter sein, aber na gut...
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
@@ -167,33 +170,57 @@ private:
      */
     bool readHeader(vislib::sys::File& file, HeaderData& header);
 
-    // TODO: document
-    // read a value and ADVANCE column
-    template<typename T>
-    void readToIntColumn(T& reader, bool& fail, unsigned int* column, ...);
-    template<typename T>
-    void readToFloatColumn(T& reader, bool& fail, unsigned int* column, ...);
-
     /**
      * Reads the data of the imd file. This method also calculated the
      * data bounding box and sets the corresponding members.
      *
-     * Use a imdinternal::AtomReader* class as template type.
+     * The data is read in blocks, each of which is split into parts at
+     * record boundaries that are parsed in parallel and merged in file order.
      *
      * @param file The file object to read from
      * @param header The struct holding the header data
-     * @param pos The writer receiving the read position data
-     * @param col The writer receiving the read colour data
-     * @param dir The writer receiving all directed particle data
-     * @param loadDir Flag to activate the use of 'dir'
+     * @param loadDir Flag to activate the loading of directed particles
      * @param splitDir Particles with direction NULL vector will be stored
      *                 in pos and col, while all others will be stored in
      *                 dir if (loadDir==true)
+     * @param machineLittleEndian Flag whether this machine is little endian
+     * @param complete Receives 'false' if reading stopped at a malformed
+     *                 record, i.e. only the atoms before it were loaded
      *
      * @return 'true' on success
      */
-    template<typename T>
-    bool readData(vislib::sys::File& file, const HeaderData& header, bool loadDir, bool splitDir);
+    bool readData(vislib::sys::File& file, const HeaderData& header, bool loadDir, bool splitDir,
+        bool machineLittleEndian, bool& complete);
+
+    /**
+     * Answer the key identifying the particles loaded from 'filename' with
+     * the current parameters in the particle cache.
+     *
+     * @param filename The data file
+     *
+     * @return The key, or zero if the data file cannot be accessed
+     */
+    uint64_t cacheKey(const std::filesystem::path& filename);
+
+    /**
+     * Loads the particles from the cache file 'path'.
+     *
+     * @param path The cache file
+     * @param key The expected key of the cache
+     *
+     * @return 'true' on success, 'false' if the cache is missing or outdated
+     */
+    bool loadCache(const std::filesystem::path& path, uint64_t key);
+
+    /**
+     * Writes the loaded particles to the cache file 'path'.
+     *
+     * @param path The cache file
+     * @param key The key of the cache
+     *
+     * @return 'true' on success
+     */
+    bool saveCache(const std::filesystem::path& path, uint64_t key) const;
 
     /**
      * Updates the posX filter data (decrese only!)
@@ -260,6 +287,9 @@ private:
     core::param::ParamSlot dirradiusSlot;
     core::param::ParamSlot dirNormDirSlot;
 
+    /** Whether to keep the loaded particles in a cache file */
+    core::param::ParamSlot cacheSlot;
+
     /** The xyz position data */
     //vislib::RawStorage posData;
     vislib::PtrArray<vislib::RawStorage> posData;
@@ -0,0 +1,196 @@
+/*
+ * MMPLDCodec.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MMPLDCodec.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "snappy.h"
+#include "zfp.h"
+
+namespace megamol::moldyn::io::mmpld {
+
+
+/**
+ * Configures a zfp stream for the codec of a block.
+ */
+static zfp_stream* openZfp(Codec codec, float tolerance) {
+    zfp_stream* zfp = zfp_stream_open(nullptr);
+    if (codec == Codec::ZFP_REVERSIBLE) {
+        zfp_stream_set_reversible(zfp);
+    } else {
+        zfp_stream_set_accuracy(zfp, tolerance);
+    }
+    return zfp;
+}
+
+
+/*
+ * EncodeBlock
+ */
+void EncodeBlock(Codec codec, float tolerance, const UINT8* src, UINT64 count, unsigned int elemSize,
+    unsigned int stride, std::vector<UINT8>& out) {
+    if ((codec == Codec::ZFP_ACCURACY) && (tolerance <= 0.0f)) {
+        codec = Codec::ZFP_REVERSIBLE;
+    }
+    bool const zfpCodec = (codec == Codec::ZFP_ACCURACY) || (codec == Codec::ZFP_REVERSIBLE);
+    if (zfpCodec && (elemSize != 4) && (elemSize != 8)) {
+        codec = Codec::SHUFFLE_SNAPPY;
+    }
+
+    // gather the elements, zfp and the shuffle both work on packed data
+    std::vector<UINT8> packed(count * elemSize);
+    for (UINT64 i = 0; i < count; ++i) {
+        std::memcpy(packed.data() + i * elemSize, src + i * stride, elemSize);
+    }
+
+    BlockHeader header;
+    header.codec = static_cast<UINT8>(codec);
+    header.elemSize = static_cast<UINT8>(elemSize);
+    header.reserved = 0;
+    header.tolerance = tolerance;
+    header.size = 0;
+
+    size_t const headerPos = out.size();
+    out.resize(headerPos + sizeof(BlockHeader));
+    size_t const payloadPos = out.size();
+
+    switch (codec) {
+    case Codec::ZFP_REVERSIBLE:
+    case Codec::ZFP_ACCURACY: {
+        zfp_field* field = zfp_field_1d(
+            packed.data(), (elemSize == 4) ? zfp_type_float : zfp_type_double, static_cast<size_t>(count));
+        zfp_stream* zfp = openZfp(codec, tolerance);
+        out.resize(payloadPos + zfp_stream_maximum_size(zfp, field));
+        bitstream* stream = stream_open(out.data() + payloadPos, out.size() - payloadPos);
+        zfp_stream_set_bit_stream(zfp, stream);
+        zfp_stream_rewind(zfp);
+        header.size = zfp_compress(zfp, field);
+        zfp_field_free(field);
+        zfp_stream_close(zfp);
+        stream_close(stream);
+    } break;
+    case Codec::SHUFFLE_SNAPPY: {
+        // byte planes: all first bytes, then all second bytes, ...
+        std::vector<UINT8> planes(packed.size());
+        for (unsigned int b = 0; b < elemSize; ++b) {
+            UINT8* plane = planes.data() + b * count;
+            for (UINT64 i = 0; i < count; ++i) {
+                plane[i] = packed[i * elemSize + b];
+            }
+        }
+        out.resize(payloadPos + snappy::MaxCompressedLength(planes.size()));
+        size_t compressedSize = 0;
+        snappy::RawCompress(reinterpret_cast<const char*>(planes.data()), planes.size(),
+            reinterpret_cast<char*>(out.data() + payloadPos), &compressedSize);
+        header.size = compressedSize;
+    } break;
+    case Codec::RAW:
+    default:
+        header.codec = static_cast<UINT8>(Codec::RAW);
+        out.insert(out.end(), packed.begin(), packed.end());
+        header.size = packed.size();
+        break;
+    }
+
+    out.resize(payloadPos + static_cast<size_t>(header.size));
+    std::memcpy(out.data() + headerPos, &header, sizeof(BlockHeader));
+}
+
+
+/*
+ * BlockSize
+ */
+UINT64 BlockSize(const UINT8* block, UINT64 avail) {
+    if (avail < sizeof(BlockHeader)) {
+        return 0;
+    }
+    BlockHeader header;
+    std::memcpy(&header, block, sizeof(BlockHeader));
+    UINT64 const size = sizeof(BlockHeader) + header.size;
+    return (size <= avail) ? size : 0;
+}
+
+
+/*
+ * DecodeBlock
+ */
+bool DecodeBlock(const UINT8* block, UINT8* dst, UINT64 count, unsigned int elemSize, unsigned int stride) {
+    BlockHeader header;
+    std::memcpy(&header, block, sizeof(BlockHeader));
+    if (header.elemSize != elemSize) {
+        return false;
+    }
+    const UINT8* payload = block + sizeof(BlockHeader);
+
+    // writes packed elements to the strided destination
+    auto scatter = [dst, count, elemSize, stride](const UINT8* packed) {
+        for (UINT64 i = 0; i < count; ++i) {
+            std::memcpy(dst + i * stride, packed + i * elemSize, elemSize);
+        }
+    };
+
+    switch (static_cast<Codec>(header.codec)) {
+    case Codec::RAW:
+        if (header.size != count * elemSize) {
+            return false;
+        }
+        scatter(payload);
+        return true;
+    case Codec::ZFP_REVERSIBLE:
+    case Codec::ZFP_ACCURACY: {
+        if ((elemSize != 4) && (elemSize != 8)) {
+            return false;
+        }
+        // aligned destinations are decoded in place, zfp strides are counted in scalars
+        bool const inPlace = ((stride % elemSize) == 0) && ((reinterpret_cast<uintptr_t>(dst) % elemSize) == 0);
+        std::vector<UINT8> packed(inPlace ? 0 : count * elemSize);
+        zfp_field* field = zfp_field_1d(inPlace ? static_cast<void*>(dst) : static_cast<void*>(packed.data()),
+            (elemSize == 4) ? zfp_type_float : zfp_type_double, static_cast<size_t>(count));
+        if (inPlace) {
+            zfp_field_set_stride_1d(field, static_cast<ptrdiff_t>(stride / elemSize));
+        }
+        zfp_stream* zfp = openZfp(static_cast<Codec>(header.codec), header.tolerance);
+        bitstream* stream = stream_open(const_cast<UINT8*>(payload), static_cast<size_t>(header.size));
+        zfp_stream_set_bit_stream(zfp, stream);
+        zfp_stream_rewind(zfp);
+        bool const ok = (zfp_decompress(zfp, field) != 0);
+        zfp_field_free(field);
+        zfp_stream_close(zfp);
+        stream_close(stream);
+        if (ok && !inPlace) {
+            scatter(packed.data());
+        }
+        return ok;
+    }
+    case Codec::SHUFFLE_SNAPPY: {
+        size_t rawSize = 0;
+        const char* compressed = reinterpret_cast<const char*>(payload);
+        if (!snappy::GetUncompressedLength(compressed, static_cast<size_t>(header.size), &rawSize) ||
+            (rawSize != count * elemSize)) {
+            return false;
+        }
+        std::vector<UINT8> planes(rawSize);
+        if (!snappy::RawUncompress(
+                compressed, static_cast<size_t>(header.size), reinterpret_cast<char*>(planes.data()))) {
+            return false;
+        }
+        for (unsigned int b = 0; b < elemSize; ++b) {
+            const UINT8* plane = planes.data() + b * count;
+            for (UINT64 i = 0; i < count; ++i) {
+                dst[i * stride + b] = plane[i];
+            }
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+} // namespace megamol::moldyn::io::mmpld
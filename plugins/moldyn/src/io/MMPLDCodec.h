@@ -0,0 +1,91 @@
+/*
+ * MMPLDCodec.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "vislib/types.h"
+
+
+namespace megamol::moldyn::io::mmpld {
+
+/** The first MMPLD file version storing compressed frames */
+constexpr unsigned short COMPRESSED_VERSION = 104;
+
+/** The default number of particles per compressed block */
+constexpr UINT32 DEFAULT_CHUNK_SIZE = 1u << 18;
+
+/**
+ * The compression methods of the blocks of a compressed MMPLD frame.
+ */
+enum class Codec : UINT8 {
+    /** Uncompressed, packed elements */
+    RAW = 0,
+    /** zfp reversible (lossless) mode on float or double scalars */
+    ZFP_REVERSIBLE = 1,
+    /** zfp fixed-accuracy mode on float or double scalars */
+    ZFP_ACCURACY = 2,
+    /** Byte planes of the elements compressed with snappy (lossless) */
+    SHUFFLE_SNAPPY = 3
+};
+
+/**
+ * Header preceding the payload of each block.
+ */
+#pragma pack(push, 1)
+struct BlockHeader {
+    /** The Codec of the payload */
+    UINT8 codec;
+    /** The size of one element in bytes */
+    UINT8 elemSize;
+    UINT16 reserved;
+    /** The absolute error bound for ZFP_ACCURACY */
+    float tolerance;
+    /** The size of the payload in bytes */
+    UINT64 size;
+};
+#pragma pack(pop)
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must be packed");
+
+/**
+ * Compresses a strided stream of elements and appends the block to 'out'.
+ *
+ * zfp codecs require elemSize to be 4 (float) or 8 (double), a tolerance of
+ * zero selects the reversible mode.
+ *
+ * @param codec     The requested codec, either ZFP_ACCURACY or SHUFFLE_SNAPPY.
+ * @param tolerance The absolute error bound for ZFP_ACCURACY.
+ * @param src       Pointer to the first element.
+ * @param count     The number of elements.
+ * @param elemSize  The size of one element in bytes.
+ * @param stride    The distance between two elements in bytes.
+ * @param out       Receives the block.
+ */
+void EncodeBlock(Codec codec, float tolerance, const UINT8* src, UINT64 count, unsigned int elemSize,
+    unsigned int stride, std::vector<UINT8>& out);
+
+/**
+ * Answer the size of the block starting at 'block' including its header,
+ * or zero if the block does not fit into 'avail' bytes.
+ */
+UINT64 BlockSize(const UINT8* block, UINT64 avail);
+
+/**
+ * Decompresses a block into a strided stream of elements.
+ *
+ * @param block    Pointer to the block header.
+ * @param dst      Pointer to the first element to be written.
+ * @param count    The number of elements.
+ * @param elemSize The size of one element in bytes.
+ * @param stride   The distance between two elements in bytes.
+ *
+ * @return 'true' on success, 'false' if the block is corrupt.
+ */
+bool DecodeBlock(const UINT8* block, UINT8* dst, UINT64 count, unsigned int elemSize, unsigned int stride);
+
+} // namespace megamol::moldyn::io::mmpld
@@ -6,6 +6,7 @@
  */
 
 #include "MMPLDDataSource.h"
+#include "MMPLDCodec.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
@@ -15,6 +16,15 @@
 #include "vislib/sys/FastFile.h"
 #include "vislib/sys/SystemInformation.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else /* _WIN32 */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
 namespace megamol::moldyn::io {
 
 
@@ -28,10 +38,76 @@ namespace megamol::moldyn::io {
 
 /*****************************************************************************/
 
+/**
+ * Answer the size in bytes and the call data type of an MMPLD vertex type.
+ */
+static SIZE_T vertexLayout(UINT8 vrtType, geocalls::MultiParticleDataCall::Particles::VertexDataType& type) {
+    switch (vrtType) {
+    case 1:
+        type = geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ;
+        return 12;
+    case 2:
+        type = geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR;
+        return 16;
+    case 3:
+        type = geocalls::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ;
+        return 6;
+    case 4:
+        type = geocalls::MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ;
+        return 24;
+    case 0:
+    default:
+        type = geocalls::MultiParticleDataCall::Particles::VERTDATA_NONE;
+        return 0;
+    }
+}
+
+
+/**
+ * Answer the size in bytes and the call data type of an MMPLD colour type.
+ */
+static SIZE_T colourLayout(UINT8 colType, geocalls::MultiParticleDataCall::Particles::ColourDataType& type) {
+    switch (colType) {
+    case 1:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB;
+        return 3;
+    case 2:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA;
+        return 4;
+    case 3:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_FLOAT_I;
+        return 4;
+    case 4:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB;
+        return 12;
+    case 5:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA;
+        return 16;
+    case 6:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_USHORT_RGBA;
+        return 8;
+    case 7:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_DOUBLE_I;
+        return 8;
+    case 0:
+    default:
+        type = geocalls::MultiParticleDataCall::Particles::COLDATA_NONE;
+        return 0;
+    }
+}
+
+/*****************************************************************************/
+
 /*
  * MMPLDDataSource::Frame::Frame
  */
-MMPLDDataSource::Frame::Frame(AnimDataModule& owner) : AnimDataModule::Frame(owner), dat() {
+MMPLDDataSource::Frame::Frame(AnimDataModule& owner)
+        : AnimDataModule::Frame(owner)
+        , dat()
+        , mapped(nullptr)
+        , mappedSize(0)
+        , fileVersion(0)
+        , lists() {
     // intentionally empty
 }
 
@@ -50,17 +126,211 @@ MMPLDDataSource::Frame::~Frame() {
 bool MMPLDDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int idx, UINT64 size, unsigned int version) {
     this->frame = idx;
     this->fileVersion = version;
+    this->mapped = nullptr;
+    this->mappedSize = 0;
+    this->lists.clear();
+    if (version >= mmpld::COMPRESSED_VERSION) {
+        std::vector<UINT8> compressed(static_cast<size_t>(size));
+        if (file->Read(compressed.data(), size) != size) {
+            return false;
+        }
+        if (!this->decodeFrame(compressed.data(), size)) {
+            this->Clear();
+            return false;
+        }
+        return true;
+    }
     this->dat.EnforceSize(static_cast<SIZE_T>(size));
     return (file->Read(this->dat, size) == size);
 }
 
 
+/*
+ * MMPLDDataSource::Frame::MapFrame
+ */
+bool MMPLDDataSource::Frame::MapFrame(const UINT8* data, unsigned int idx, UINT64 size, unsigned int version) {
+    this->frame = idx;
+    this->fileVersion = version;
+    this->lists.clear();
+    if (version >= mmpld::COMPRESSED_VERSION) {
+        // compressed frames are decoded straight from the mapping into the local copy
+        this->mapped = nullptr;
+        this->mappedSize = 0;
+        if (!this->decodeFrame(data, size)) {
+            this->Clear();
+            return false;
+        }
+        return true;
+    }
+    this->dat.EnforceSize(0);
+    this->mapped = data;
+    this->mappedSize = size;
+    return true;
+}
+
+
+/*
+ * MMPLDDataSource::Frame::decodeFrame
+ */
+bool MMPLDDataSource::Frame::decodeFrame(const UINT8* src, UINT64 size) {
+    // frame header: time stamp, list count, particles per block, decoded size, list offsets
+    SIZE_T const headerSize = sizeof(float) + 2 * sizeof(UINT32) + sizeof(UINT64);
+    if (size < headerSize) {
+        return false;
+    }
+    UINT32 plc = 0, chunkSize = 0;
+    UINT64 decodedSize = 0;
+    ::memcpy(&plc, src + sizeof(float), sizeof(UINT32));
+    ::memcpy(&chunkSize, src + sizeof(float) + sizeof(UINT32), sizeof(UINT32));
+    ::memcpy(&decodedSize, src + sizeof(float) + 2 * sizeof(UINT32), sizeof(UINT64));
+    if ((chunkSize == 0) || (size < headerSize + sizeof(UINT64) * (static_cast<UINT64>(plc) + 1))) {
+        return false;
+    }
+    std::vector<UINT64> listOffsets(plc + 1);
+    ::memcpy(listOffsets.data(), src + headerSize, sizeof(UINT64) * listOffsets.size());
+
+    this->lists.resize(plc);
+
+    /** One block to be decoded, 'dst' is the offset into the decoded data */
+    struct Task {
+        const UINT8* block;
+        SIZE_T dst;
+        UINT64 count;
+        unsigned int elemSize;
+        unsigned int stride;
+    };
+    std::vector<Task> tasks;
+
+    // walk the list headers and block headers, the payloads are decoded afterwards
+    SIZE_T out = 0;
+    for (UINT32 li = 0; li < plc; ++li) {
+        UINT64 p = listOffsets[li];
+        UINT64 const end = listOffsets[li + 1];
+        if ((p > end) || (end > size) || (end - p < 4)) {
+            return false;
+        }
+        auto read = [&](void* dst, SIZE_T s) {
+            if (end - p < s) {
+                return false;
+            }
+            ::memcpy(dst, src + p, s);
+            p += s;
+            return true;
+        };
+
+        ListInfo& l = this->lists[li];
+        UINT8 reserved = 0;
+        read(&l.vrtType, 1);
+        read(&l.colType, 1);
+        read(&l.idType, 1);
+        read(&reserved, 1);
+        l.globalRadius = 0.05f;
+        l.globalColour[0] = l.globalColour[1] = l.globalColour[2] = 192;
+        l.globalColour[3] = 255;
+        l.minColourIndex = 0.0f;
+        l.maxColourIndex = 1.0f;
+        if (l.vrtType == 0) {
+            l.colType = 0;
+        }
+        if (((l.vrtType == 1) || (l.vrtType == 3) || (l.vrtType == 4)) && !read(&l.globalRadius, 4)) {
+            return false;
+        }
+        if ((l.colType == 0) && !read(l.globalColour, 4)) {
+            return false;
+        }
+        if (((l.colType == 3) || (l.colType == 7)) && !(read(&l.minColourIndex, 4) && read(&l.maxColourIndex, 4))) {
+            return false;
+        }
+        if (!read(&l.count, 8) || !read(l.bbox, 24)) {
+            return false;
+        }
+
+        geocalls::MultiParticleDataCall::Particles::VertexDataType vrtDatType;
+        geocalls::MultiParticleDataCall::Particles::ColourDataType colDatType;
+        unsigned int const vrtSize = static_cast<unsigned int>(vertexLayout(l.vrtType, vrtDatType));
+        unsigned int const colSize = static_cast<unsigned int>(colourLayout(l.colType, colDatType));
+        unsigned int const idSize = (l.idType == 1) ? 4 : ((l.idType == 2) ? 8 : 0);
+        unsigned int const stride = vrtSize + colSize;
+        if (vrtSize == 0) {
+            l.count = 0;
+        }
+        // the counts are read from the file, check them before they size anything
+        if ((stride + idSize > 0) && (l.count > (decodedSize - out) / (stride + idSize))) {
+            return false;
+        }
+
+        l.dataOffset = out;
+        out += static_cast<SIZE_T>(stride * l.count);
+        l.idOffset = out;
+        out += static_cast<SIZE_T>(idSize * l.count);
+
+        for (UINT64 first = 0; first < l.count; first += chunkSize) {
+            UINT64 const n = vislib::math::Min<UINT64>(chunkSize, l.count - first);
+            SIZE_T const base = l.dataOffset + static_cast<SIZE_T>(first * stride);
+            auto addBlock = [&](SIZE_T dst, unsigned int elemSize, unsigned int elemStride) {
+                UINT64 const blockSize = mmpld::BlockSize(src + p, end - p);
+                if (blockSize == 0) {
+                    return false;
+                }
+                tasks.push_back(Task{src + p, dst, n, elemSize, elemStride});
+                p += blockSize;
+                return true;
+            };
+
+            bool ok = true;
+            switch (l.vrtType) {
+            case 1:
+            case 2:
+            case 4: {
+                // one block per coordinate (and radius)
+                unsigned int const scalarSize = (l.vrtType == 4) ? 8 : 4;
+                for (unsigned int c = 0; ok && (c < vrtSize / scalarSize); ++c) {
+                    ok = addBlock(base + c * scalarSize, scalarSize, stride);
+                }
+            } break;
+            default:
+                ok = addBlock(base, vrtSize, stride);
+                break;
+            }
+            if (ok && (colSize > 0)) {
+                ok = addBlock(base + vrtSize, colSize, stride);
+            }
+            if (ok && (idSize > 0)) {
+                ok = addBlock(l.idOffset + static_cast<SIZE_T>(first * idSize), idSize, idSize);
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+    }
+
+    // all blocks are in place, i.e. the decoded size is backed by the frame
+    this->dat.EnforceSize(out);
+    UINT8* const dst = this->dat.As<UINT8>();
+
+    bool failed = false;
+#pragma omp parallel for schedule(dynamic) reduction(|| : failed)
+    for (int64_t t = 0; t < static_cast<int64_t>(tasks.size()); ++t) {
+        auto const& task = tasks[t];
+        if (!mmpld::DecodeBlock(task.block, dst + task.dst, task.count, task.elemSize, task.stride)) {
+            failed = true;
+        }
+    }
+
+    return !failed;
+}
+
+
 /*
  * MMPLDDataSource::Frame::SetData
  */
 void MMPLDDataSource::Frame::SetData(
     geocalls::MultiParticleDataCall& call, vislib::math::Cuboid<float> const& bbox, bool overrideBBox) {
-    if (this->dat.IsEmpty()) {
+    if (this->fileVersion >= mmpld::COMPRESSED_VERSION) {
+        this->setDecodedData(call, bbox, overrideBBox);
+        return;
+    }
+    if ((this->mapped == nullptr) ? this->dat.IsEmpty() : (this->mappedSize == 0)) {
         call.SetParticleListCount(0);
         return;
     }
@@ -70,89 +340,27 @@ void MMPLDDataSource::Frame::SetData(
     // HAZARD for megamol up to fc4e784dae531953ad4cd3180f424605474dd18b this reads == 102
     // which means that many MMPLDs out there with version 103 are written wrongly (no timestamp)!
     if (this->fileVersion >= 102) {
-        timestamp = *this->dat.AsAt<float>(p);
+        timestamp = *this->at<float>(p);
         p += sizeof(float);
     }
-    UINT32 plc = *this->dat.AsAt<UINT32>(p);
+    UINT32 plc = *this->at<UINT32>(p);
     p += sizeof(UINT32);
     call.SetParticleListCount(plc);
     for (UINT32 i = 0; i < plc; i++) {
         geocalls::MultiParticleDataCall::Particles& pts = call.AccessParticles(i);
 
-        UINT8 vrtType = *this->dat.AsAt<UINT8>(p);
+        UINT8 vrtType = *this->at<UINT8>(p);
         p += 1;
-        UINT8 colType = *this->dat.AsAt<UINT8>(p);
+        UINT8 colType = *this->at<UINT8>(p);
         p += 1;
         geocalls::MultiParticleDataCall::Particles::VertexDataType vrtDatType;
         geocalls::MultiParticleDataCall::Particles::ColourDataType colDatType;
         SIZE_T vrtSize = 0;
         SIZE_T colSize = 0;
 
-        switch (vrtType) {
-        case 0:
-            vrtSize = 0;
-            vrtDatType = geocalls::MultiParticleDataCall::Particles::VERTDATA_NONE;
-            break;
-        case 1:
-            vrtSize = 12;
-            vrtDatType = geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ;
-            break;
-        case 2:
-            vrtSize = 16;
-            vrtDatType = geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR;
-            break;
-        case 3:
-            vrtSize = 6;
-            vrtDatType = geocalls::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ;
-            break;
-        case 4:
-            vrtSize = 24;
-            vrtDatType = geocalls::MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ;
-            break;
-        default:
-            vrtSize = 0;
-            vrtDatType = geocalls::MultiParticleDataCall::Particles::VERTDATA_NONE;
-            break;
-        }
+        vrtSize = vertexLayout(vrtType, vrtDatType);
         if (vrtType != 0) {
-            switch (colType) {
-            case 0:
-                colSize = 0;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_NONE;
-                break;
-            case 1:
-                colSize = 3;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_UINT8_RGB;
-                break;
-            case 2:
-                colSize = 4;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA;
-                break;
-            case 3:
-                colSize = 4;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_FLOAT_I;
-                break;
-            case 4:
-                colSize = 12;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB;
-                break;
-            case 5:
-                colSize = 16;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA;
-                break;
-            case 6:
-                colSize = 8;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_USHORT_RGBA;
-                break;
-            case 7:
-                colSize = 8;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_DOUBLE_I;
-                break;
-            default:
-                colSize = 0;
-                colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_NONE;
-                break;
-            }
+            colSize = colourLayout(colType, colDatType);
         } else {
             colDatType = geocalls::MultiParticleDataCall::Particles::COLDATA_NONE;
             colSize = 0;
@@ -160,7 +368,7 @@ void MMPLDDataSource::Frame::SetData(
         unsigned int stride = static_cast<unsigned int>(vrtSize + colSize);
 
         if ((vrtType == 1) || (vrtType == 3) || (vrtType == 4)) {
-            pts.SetGlobalRadius(*this->dat.AsAt<float>(p));
+            pts.SetGlobalRadius(*this->at<float>(p));
             p += 4;
         } else {
             pts.SetGlobalRadius(0.05f);
@@ -168,23 +376,23 @@ void MMPLDDataSource::Frame::SetData(
 
         if (colType == 0) {
             pts.SetGlobalColour(
-                *this->dat.AsAt<UINT8>(p), *this->dat.AsAt<UINT8>(p + 1), *this->dat.AsAt<UINT8>(p + 2));
+                *this->at<UINT8>(p), *this->at<UINT8>(p + 1), *this->at<UINT8>(p + 2));
             p += 4;
         } else {
             pts.SetGlobalColour(192, 192, 192);
             if (colType == 3 || colType == 7) {
-                pts.SetColourMapIndexValues(*this->dat.AsAt<float>(p), *this->dat.AsAt<float>(p + 4));
+                pts.SetColourMapIndexValues(*this->at<float>(p), *this->at<float>(p + 4));
                 p += 8;
             } else {
                 pts.SetColourMapIndexValues(0.0f, 1.0f);
             }
         }
 
-        pts.SetCount(*this->dat.AsAt<UINT64>(p));
+        pts.SetCount(*this->at<UINT64>(p));
         p += 8;
 
         if (this->fileVersion >= 103) {
-            auto const box = this->dat.AsAt<float>(p);
+            auto const box = this->at<float>(p);
             vislib::math::Cuboid<float> bbox;
             bbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
             pts.SetBBox(bbox);
@@ -194,8 +402,8 @@ void MMPLDDataSource::Frame::SetData(
             pts.SetBBox(bbox);
         }
 
-        pts.SetVertexData(vrtDatType, this->dat.At(p), stride);
-        pts.SetColourData(colDatType, this->dat.At(p + vrtSize), stride);
+        pts.SetVertexData(vrtDatType, this->data() + p, stride);
+        pts.SetColourData(colDatType, this->data() + p + vrtSize, stride);
 
         p += static_cast<SIZE_T>(stride * pts.GetCount());
 
@@ -203,18 +411,59 @@ void MMPLDDataSource::Frame::SetData(
             // TODO: who deletes this?
             geocalls::SimpleSphericalParticles::ClusterInfos* ci =
                 new geocalls::SimpleSphericalParticles::ClusterInfos();
-            ci->numClusters = *this->dat.AsAt<unsigned int>(p);
+            ci->numClusters = *this->at<unsigned int>(p);
             p += sizeof(unsigned int);
-            ci->sizeofPlainData = *this->dat.AsAt<size_t>(p);
+            ci->sizeofPlainData = *this->at<size_t>(p);
             p += sizeof(size_t);
             ci->plainData = (unsigned int*)malloc(ci->sizeofPlainData);
-            memcpy(ci->plainData, this->dat.At(p), ci->sizeofPlainData);
+            memcpy(ci->plainData, this->data() + p, ci->sizeofPlainData);
             p += ci->sizeofPlainData;
             pts.SetClusterInfos(ci);
         }
     }
 }
 
+
+/*
+ * MMPLDDataSource::Frame::setDecodedData
+ */
+void MMPLDDataSource::Frame::setDecodedData(
+    geocalls::MultiParticleDataCall& call, vislib::math::Cuboid<float> const& bbox, bool overrideBBox) {
+    call.SetParticleListCount(static_cast<unsigned int>(this->lists.size()));
+    for (size_t i = 0; i < this->lists.size(); ++i) {
+        auto const& l = this->lists[i];
+        geocalls::MultiParticleDataCall::Particles& pts = call.AccessParticles(static_cast<unsigned int>(i));
+
+        geocalls::MultiParticleDataCall::Particles::VertexDataType vrtDatType;
+        geocalls::MultiParticleDataCall::Particles::ColourDataType colDatType;
+        SIZE_T const vrtSize = vertexLayout(l.vrtType, vrtDatType);
+        SIZE_T const colSize = colourLayout(l.colType, colDatType);
+
+        pts.SetGlobalRadius(l.globalRadius);
+        pts.SetGlobalColour(l.globalColour[0], l.globalColour[1], l.globalColour[2]);
+        pts.SetColourMapIndexValues(l.minColourIndex, l.maxColourIndex);
+        pts.SetCount(l.count);
+        vislib::math::Cuboid<float> listBox;
+        listBox.Set(l.bbox[0], l.bbox[1], l.bbox[2], l.bbox[3], l.bbox[4], l.bbox[5]);
+        pts.SetBBox(overrideBBox ? bbox : listBox);
+
+        unsigned int const stride = static_cast<unsigned int>(vrtSize + colSize);
+        pts.SetVertexData(vrtDatType, this->dat.At(l.dataOffset), stride);
+        pts.SetColourData(colDatType, this->dat.At(l.dataOffset + vrtSize), stride);
+        switch (l.idType) {
+        case 1:
+            pts.SetIDData(geocalls::SimpleSphericalParticles::IDDATA_UINT32, this->dat.At(l.idOffset));
+            break;
+        case 2:
+            pts.SetIDData(geocalls::SimpleSphericalParticles::IDDATA_UINT64, this->dat.At(l.idOffset));
+            break;
+        default:
+            pts.SetIDData(geocalls::SimpleSphericalParticles::IDDATA_NONE, nullptr);
+            break;
+        }
+    }
+}
+
 /*****************************************************************************/
 
 
@@ -227,9 +476,18 @@ MMPLDDataSource::MMPLDDataSource()
         , limitMemorySlot("limitMemory", "Limits the memory cache size")
         , limitMemorySizeSlot("limitMemorySize", "Specifies the size limit (in MegaBytes) of the memory cache")
         , overrideBBoxSlot("overrideLocalBBox", "Override local bbox")
+        , useMemoryMappingSlot("useMemoryMapping", "Map the file into memory and hand out the frame data without copying")
+        , readAheadSlot("readAheadFrames", "Number of subsequent frames to prefetch when using memory mapping")
+        , loaderThreadsSlot("loaderThreads", "Number of threads loading frames concurrently when using memory mapping")
         , getData("getdata", "Slot to request data from this data source.")
         , file(NULL)
         , frameIdx(NULL)
+        , mappedData(nullptr)
+        , mappedSize(0)
+#ifdef _WIN32
+        , mappedFileHandle(INVALID_HANDLE_VALUE)
+        , mappingHandle(NULL)
+#endif /* _WIN32 */
         , bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f)
         , clipbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f)
         , data_hash(0) {
@@ -254,6 +512,18 @@ MMPLDDataSource::MMPLDDataSource()
     this->overrideBBoxSlot << new core::param::BoolParam(false);
     this->MakeSlotAvailable(&this->overrideBBoxSlot);
 
+    this->useMemoryMappingSlot << new core::param::BoolParam(false);
+    this->useMemoryMappingSlot.SetUpdateCallback(&MMPLDDataSource::filenameChanged);
+    this->MakeSlotAvailable(&this->useMemoryMappingSlot);
+
+    this->readAheadSlot << new core::param::IntParam(2, 0);
+    this->readAheadSlot.SetUpdateCallback(&MMPLDDataSource::readAheadChanged);
+    this->MakeSlotAvailable(&this->readAheadSlot);
+
+    this->loaderThreadsSlot << new core::param::IntParam(1, 1);
+    this->loaderThreadsSlot.SetUpdateCallback(&MMPLDDataSource::filenameChanged);
+    this->MakeSlotAvailable(&this->loaderThreadsSlot);
+
     this->getData.SetCallback(geocalls::MultiParticleDataCall::ClassName(),
         geocalls::MultiParticleDataCall::FunctionName(0), &MMPLDDataSource::getDataCallback);
     this->getData.SetCallback(geocalls::MultiParticleDataCall::ClassName(),
@@ -306,6 +576,15 @@ void MMPLDDataSource::loadFrame(AnimDataModule::Frame* frame, unsigned int idx)
     //printf("Requesting frame %u of %u frames\n", idx, this->FrameCount());
     //Log::DefaultLog.WriteInfo( "Requesting frame %u of %u frames\n", idx, this->FrameCount());
     ASSERT(idx < this->FrameCount());
+    if (this->mappedData != nullptr) {
+        if (!f->MapFrame(this->mappedData + this->frameIdx[idx], idx, this->frameIdx[idx + 1] - this->frameIdx[idx],
+                this->fileVersion)) {
+            Log::DefaultLog.WriteError("Unable to decode frame %d from MMPLD file\n", idx);
+        }
+        // the loader threads walk the prefetch window, so advising this frame reads ahead
+        this->adviseFrames(idx, 1);
+        return;
+    }
     this->file->Seek(this->frameIdx[idx]);
     if (!f->LoadFrame(this->file, idx, this->frameIdx[idx + 1] - this->frameIdx[idx], this->fileVersion)) {
         // failed
@@ -319,6 +598,7 @@ void MMPLDDataSource::loadFrame(AnimDataModule::Frame* frame, unsigned int idx)
  */
 void MMPLDDataSource::release() {
     this->resetFrameCache();
+    this->unmapFile();
     if (this->file != NULL) {
         vislib::sys::File* f = this->file;
         this->file = NULL;
@@ -336,6 +616,8 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
     using megamol::core::utility::log::Log;
     using vislib::sys::File;
     this->resetFrameCache();
+    this->unmapFile();
+    this->setLoaderThreadCount(1);
     this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
     this->clipbox = this->bbox;
     this->data_hash++;
@@ -379,7 +661,7 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
     }
     unsigned short ver;
     _ASSERT_READFILE(&ver, 2);
-    if (ver < 100 || ver > 103) {
+    if (ver < 100 || ver > mmpld::COMPRESSED_VERSION) {
         _ERROR_OUT("MMPLD file header version wrong");
     }
     this->fileVersion = ver;
@@ -404,8 +686,31 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
         size += static_cast<double>(this->frameIdx[i + 1] - this->frameIdx[i]);
     }
     size /= static_cast<double>(frmCnt);
+    if (ver >= mmpld::COMPRESSED_VERSION) {
+        // the cache holds decoded frames, estimate their size from the ratio of the first frame
+        UINT64 decodedSize = 0;
+        UINT64 const firstSize = this->frameIdx[1] - this->frameIdx[0];
+        this->file->Seek(this->frameIdx[0] + sizeof(float) + 2 * sizeof(UINT32));
+        _ASSERT_READFILE(&decodedSize, 8);
+        if (firstSize > 0) {
+            size *= static_cast<double>(decodedSize) / static_cast<double>(firstSize);
+        }
+    }
     size *= CACHE_FRAME_FACTOR;
 
+    if (this->useMemoryMappingSlot.Param<core::param::BoolParam>()->Value()) {
+        // the frame index table must not point beyond the mapped file
+        if (this->mapFile() && (this->frameIdx[frmCnt] > this->mappedSize)) {
+            this->unmapFile();
+        }
+        if (this->mappedData != nullptr) {
+            Log::DefaultLog.WriteInfo("MMPLD file mapped into memory (%llu bytes).",
+                static_cast<unsigned long long>(this->mappedSize));
+        } else {
+            Log::DefaultLog.WriteWarn("Unable to map MMPLD file into memory. Falling back to copying reads.");
+        }
+    }
+
     UINT64 mem = vislib::sys::SystemInformation::AvailableMemorySize();
     if (this->limitMemorySlot.Param<core::param::BoolParam>()->Value()) {
         mem = vislib::math::Min(
@@ -428,6 +733,12 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
     }
 
     this->setFrameCount(frmCnt);
+    this->readAheadChanged(this->readAheadSlot);
+    // mapped frames are decoded independently of each other, the copying reads share the file handle
+    if (this->mappedData != nullptr) {
+        int const loaderThreads = this->loaderThreadsSlot.Param<core::param::IntParam>()->Value();
+        this->setLoaderThreadCount(static_cast<unsigned int>(vislib::math::Max(1, loaderThreads)));
+    }
     this->initFrameCache(cacheSize);
 
 #undef _ASSERT_READFILE
@@ -437,6 +748,135 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
 }
 
 
+/*
+ * MMPLDDataSource::readAheadChanged
+ */
+bool MMPLDDataSource::readAheadChanged(core::param::ParamSlot& slot) {
+    // mapped frames are cheap to hold, so the cache would otherwise prefetch far too much
+    if (this->mappedData != nullptr) {
+        int const readAhead = this->readAheadSlot.Param<core::param::IntParam>()->Value();
+        this->setPrefetchWindow(1 + static_cast<unsigned int>(vislib::math::Max(0, readAhead)));
+    } else {
+        this->setPrefetchWindow(0);
+    }
+    return true;
+}
+
+
+/*
+ * MMPLDDataSource::mapFile
+ */
+bool MMPLDDataSource::mapFile() {
+    this->unmapFile();
+    auto const& path = this->filename.Param<core::param::FilePathParam>()->Value();
+
+#ifdef _WIN32
+    HANDLE fh = ::CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (fh == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fs;
+    if (!::GetFileSizeEx(fh, &fs) || (fs.QuadPart == 0)) {
+        ::CloseHandle(fh);
+        return false;
+    }
+    HANDLE mh = ::CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mh == NULL) {
+        ::CloseHandle(fh);
+        return false;
+    }
+    void* ptr = ::MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    if (ptr == NULL) {
+        ::CloseHandle(mh);
+        ::CloseHandle(fh);
+        return false;
+    }
+    this->mappedFileHandle = fh;
+    this->mappingHandle = mh;
+    this->mappedSize = static_cast<UINT64>(fs.QuadPart);
+#else  /* _WIN32 */
+    int fd = ::open(path.native().c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if ((::fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+        ::close(fd);
+        return false;
+    }
+    void* ptr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(ptr, static_cast<size_t>(st.st_size), MADV_RANDOM);
+    this->mappedSize = static_cast<UINT64>(st.st_size);
+#endif /* _WIN32 */
+
+    this->mappedData = static_cast<UINT8*>(ptr);
+
+    return true;
+}
+
+
+/*
+ * MMPLDDataSource::unmapFile
+ */
+void MMPLDDataSource::unmapFile() {
+    if (this->mappedData != nullptr) {
+#ifdef _WIN32
+        ::UnmapViewOfFile(this->mappedData);
+#else  /* _WIN32 */
+        ::munmap(this->mappedData, static_cast<size_t>(this->mappedSize));
+#endif /* _WIN32 */
+    }
+#ifdef _WIN32
+    if (this->mappingHandle != NULL) {
+        ::CloseHandle(this->mappingHandle);
+        this->mappingHandle = NULL;
+    }
+    if (this->mappedFileHandle != INVALID_HANDLE_VALUE) {
+        ::CloseHandle(this->mappedFileHandle);
+        this->mappedFileHandle = INVALID_HANDLE_VALUE;
+    }
+#endif /* _WIN32 */
+    this->mappedData = nullptr;
+    this->mappedSize = 0;
+}
+
+
+/*
+ * MMPLDDataSource::adviseFrames
+ */
+void MMPLDDataSource::adviseFrames(unsigned int idx, unsigned int cnt) {
+    if ((this->mappedData == nullptr) || (cnt == 0) || (idx >= this->FrameCount())) {
+        return;
+    }
+    unsigned int last = vislib::math::Min(idx + cnt, this->FrameCount());
+    UINT64 begin = this->frameIdx[idx];
+    UINT64 end = this->frameIdx[last];
+    if (end <= begin) {
+        return;
+    }
+
+#ifdef _WIN32
+#if (defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0602))
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = this->mappedData + begin;
+    range.NumberOfBytes = static_cast<SIZE_T>(end - begin);
+    ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+#endif /* (defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0602)) */
+#else  /* _WIN32 */
+    // madvise requires a page-aligned start address
+    static const UINT64 pageSize = static_cast<UINT64>(::sysconf(_SC_PAGESIZE));
+    UINT64 alignedBegin = begin - (begin % pageSize);
+    ::madvise(this->mappedData + alignedBegin, static_cast<size_t>(end - alignedBegin), MADV_WILLNEED);
+#endif /* _WIN32 */
+}
+
+
 /*
  * MMPLDDataSource::getDataCallback
  */
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
@@ -108,6 +110,9 @@ protected:
          */
         inline void Clear() {
             this->dat.EnforceSize(0);
+            this->mapped = nullptr;
+            this->mappedSize = 0;
+            this->lists.clear();
         }
 
         /**
@@ -123,6 +128,20 @@ protected:
          */
         bool LoadFrame(vislib::sys::File* file, unsigned int idx, UINT64 size, unsigned int version);
 
+        /**
+         * Points this object to frame data residing in a memory-mapped file
+         * instead of copying it. The memory must stay valid until the frame
+         * is cleared or reloaded.
+         *
+         * @param data Pointer to the first byte of the frame data
+         * @param idx The zero-based index of the frame
+         * @param size The size of the frame data in bytes
+         * @param version File version (100 = standard, 101 with clusterInfos)
+         *
+         * @return True on success
+         */
+        bool MapFrame(const UINT8* data, unsigned int idx, UINT64 size, unsigned int version);
+
         /**
          * Sets the data into the call
          *
@@ -131,11 +150,76 @@ protected:
         void SetData(geocalls::MultiParticleDataCall& call, vislib::math::Cuboid<float> const& bbox, bool overrideBBox);
 
     private:
+        /** Layout of one decoded particle list of a compressed frame */
+        struct ListInfo {
+            UINT8 vrtType;
+            UINT8 colType;
+            UINT8 idType;
+            float globalRadius;
+            UINT8 globalColour[4];
+            float minColourIndex;
+            float maxColourIndex;
+            UINT64 count;
+            float bbox[6];
+            /** offset of the interleaved vertex and colour data in 'dat' */
+            SIZE_T dataOffset;
+            /** offset of the packed ids in 'dat' */
+            SIZE_T idOffset;
+        };
+
+        /**
+         * Decompresses a compressed frame (version 104) into 'dat', decoding
+         * the blocks of all lists in parallel.
+         *
+         * @param src  Pointer to the first byte of the compressed frame
+         * @param size The size of the compressed frame in bytes
+         *
+         * @return True on success
+         */
+        bool decodeFrame(const UINT8* src, UINT64 size);
+
+        /**
+         * Sets the data of a decoded compressed frame into the call
+         */
+        void setDecodedData(
+            geocalls::MultiParticleDataCall& call, vislib::math::Cuboid<float> const& bbox, bool overrideBBox);
+
+        /**
+         * Answer the frame data, either from the mapped file or from the
+         * local copy.
+         *
+         * @return Pointer to the first byte of the frame data
+         */
+        inline const UINT8* data() const {
+            return (this->mapped != nullptr) ? this->mapped : this->dat.As<UINT8>();
+        }
+
+        /**
+         * Answer a typed pointer into the frame data.
+         *
+         * @param p The byte offset into the frame data
+         *
+         * @return Pointer to the data at 'p'
+         */
+        template<class T>
+        inline const T* at(SIZE_T p) const {
+            return reinterpret_cast<const T*>(this->data() + p);
+        }
+
         /** position data per type */
         vislib::RawStorage dat;
 
+        /** frame data inside the memory-mapped file, or nullptr if 'dat' is used */
+        const UINT8* mapped;
+
+        /** size of the memory-mapped frame data in bytes */
+        UINT64 mappedSize;
+
         /** file version */
         unsigned int fileVersion;
+
+        /** the lists of a decoded compressed frame */
+        std::vector<ListInfo> lists;
     };
 
     /**
@@ -181,6 +265,37 @@ protected:
      */
     bool filenameChanged(core::param::ParamSlot& slot);
 
+    /**
+     * Callback receiving the update of the read-ahead parameter.
+     *
+     * @param slot The updated ParamSlot.
+     *
+     * @return Always 'true' to reset the dirty flag.
+     */
+    bool readAheadChanged(core::param::ParamSlot& slot);
+
+    /**
+     * Maps the whole opened data file into memory.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool mapFile();
+
+    /**
+     * Unmaps the data file, if it is mapped. All frames referencing the
+     * mapping must have been released before.
+     */
+    void unmapFile();
+
+    /**
+     * Hints the operating system to read the data of the given frames into
+     * the page cache.
+     *
+     * @param idx The index of the first frame
+     * @param cnt The number of frames
+     */
+    void adviseFrames(unsigned int idx, unsigned int cnt);
+
     /**
      * Gets the data from the source.
      *
@@ -211,6 +326,15 @@ protected:
     /** Override local bbox */
     core::param::ParamSlot overrideBBoxSlot;
 
+    /** Use memory-mapped zero-copy access to the frame data */
+    core::param::ParamSlot useMemoryMappingSlot;
+
+    /** Number of frames to read ahead when using memory-mapped access */
+    core::param::ParamSlot readAheadSlot;
+
+    /** Number of loader threads when using memory-mapped access */
+    core::param::ParamSlot loaderThreadsSlot;
+
     /** The slot for requesting data */
     core::CalleeSlot getData;
 
@@ -220,6 +344,20 @@ protected:
     /** The frame index table */
     UINT64* frameIdx;
 
+    /** The memory-mapped data file, or nullptr if not mapped */
+    UINT8* mappedData;
+
+    /** The size of the memory-mapped data file in bytes */
+    UINT64 mappedSize;
+
+#ifdef _WIN32
+    /** The file handle used for the mapping */
+    void* mappedFileHandle;
+
+    /** The mapping object handle */
+    void* mappingHandle;
+#endif /* _WIN32 */
+
     /** The data set bounding box */
     vislib::math::Cuboid<float> bbox;
 
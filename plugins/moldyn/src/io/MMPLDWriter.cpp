@@ -6,12 +6,16 @@
  */
 
 #include "MMPLDWriter.h"
+#include "MMPLDCodec.h"
 #include "mmcore/BoundingBoxes.h"
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmcore/utility/log/Log.h"
 #include "vislib/String.h"
@@ -27,10 +31,16 @@ MMPLDWriter::MMPLDWriter()
         : AbstractDataWriter()
         , filenameSlot("filename", "The path to the MMPLD file to be written")
         , versionSlot("version", "The file format version to be written")
+        , positionToleranceSlot("positionTolerance",
+              "Absolute error bound of positions and radii in compressed files (1.4), 0 for lossless")
+        , colourToleranceSlot("colourTolerance",
+              "Absolute error bound of colour intensities in compressed files (1.4), 0 for lossless")
+        , pipelineDepthSlot("pipelineDepth", "Number of serialized frames that may wait for being written")
         , dataSlot("data", "The slot requesting the data to be written")
         , startFrameSlot("startFrame", "the first frame to write")
         , endFrameSlot("endFrame", "the last frame to write")
-        , subsetSlot("writeSubset", "use the specified start and end") {
+        , subsetSlot("writeSubset", "use the specified start and end")
+        , aborted(false) {
 
     this->filenameSlot << new core::param::FilePathParam(
         "", megamol::core::param::FilePathParam::Flag_File_ToBeCreatedWithRestrExts, {"mmpld"});
@@ -43,9 +53,19 @@ MMPLDWriter::MMPLDWriter()
 #endif
     verPar->SetTypePair(102, "1.2");
     verPar->SetTypePair(103, "1.3");
+    verPar->SetTypePair(mmpld::COMPRESSED_VERSION, "1.4 (compressed)");
     this->versionSlot.SetParameter(verPar);
     this->MakeSlotAvailable(&this->versionSlot);
 
+    this->positionToleranceSlot << new core::param::FloatParam(0.0f, 0.0f);
+    this->MakeSlotAvailable(&this->positionToleranceSlot);
+
+    this->colourToleranceSlot << new core::param::FloatParam(0.0f, 0.0f);
+    this->MakeSlotAvailable(&this->colourToleranceSlot);
+
+    this->pipelineDepthSlot << new core::param::IntParam(4, 1);
+    this->MakeSlotAvailable(&this->pipelineDepthSlot);
+
     this->startFrameSlot << new core::param::IntParam(0);
     this->MakeSlotAvailable(&startFrameSlot);
     this->endFrameSlot << new core::param::IntParam(0);
@@ -70,6 +90,7 @@ MMPLDWriter::~MMPLDWriter() {
  * MMPLDWriter::create
  */
 bool MMPLDWriter::create() {
+    this->registerExportTimers();
     return true;
 }
 
@@ -77,7 +98,9 @@ bool MMPLDWriter::create() {
 /*
  * MMPLDWriter::release
  */
-void MMPLDWriter::release() {}
+void MMPLDWriter::release() {
+    this->releaseExportTimers();
+}
 
 
 /*
@@ -172,33 +195,41 @@ bool MMPLDWriter::run() {
     ASSERT_WRITEOUT(cbox.PeekBounds(), 6 * 4);
 
     UINT64 seekTable = static_cast<UINT64>(file.Tell());
-    UINT64 frameOffset = 0;
-    for (UINT32 i = 0; i <= frameCnt; i++) {
-        ASSERT_WRITEOUT(&frameOffset, 8);
+    std::vector<UINT64> frameOffsets(frameCnt + 1, 0);
+    ASSERT_WRITEOUT(frameOffsets.data(), frameOffsets.size() * 8);
+    mpdc->Unlock();
+
+    // frames are fetched and serialized here, the I/O thread writes them in order meanwhile
+    int const depth = this->pipelineDepthSlot.Param<core::param::IntParam>()->Value();
+    PipelinedFileWriter writer(file, static_cast<size_t>(std::max(depth, 1)));
+    this->aborted.store(false);
+    this->beginExport(theEnd - theStart);
+
+#define ABORT_PIPELINE(...)                           \
+    {                                                 \
+        Log::DefaultLog.WriteError(__VA_ARGS__);      \
+        writer.Finish();                              \
+        file.Close();                                 \
+        this->endExport();                            \
+        return false;                                 \
     }
 
-    mpdc->Unlock();
     for (UINT32 i = theStart; i < theEnd; i++) {
-        frameOffset = static_cast<UINT64>(file.Tell());
-        file.Seek(seekTable + (i - theStart) * 8);
-        ASSERT_WRITEOUT(&frameOffset, 8);
-        file.Seek(frameOffset);
-
-        Log::DefaultLog.WriteInfo("Started writing data frame %u\n", i);
+        if (this->aborted.load()) {
+            ABORT_PIPELINE("Writing aborted at data frame %u.\n", i);
+        }
+        frameOffsets[i - theStart] = writer.Position();
 
+        this->beginExportStage(ExportStage::FETCH);
         int missCnt = -9;
         do {
             mpdc->Unlock();
             mpdc->SetFrameID(i, true);
             if (!(*mpdc)(1)) {
-                Log::DefaultLog.WriteError("Cannot request frame %u. Abort.\n", i);
-                file.Close();
-                return false;
+                ABORT_PIPELINE("Cannot request frame %u. Abort.\n", i);
             }
             if (!(*mpdc)(0)) {
-                Log::DefaultLog.WriteError("Cannot get data frame %u. Abort.\n", i);
-                file.Close();
-                return false;
+                ABORT_PIPELINE("Cannot get data frame %u. Abort.\n", i);
             }
             if (mpdc->FrameID() != i) {
                 if ((missCnt % 10) == 0) {
@@ -208,25 +239,45 @@ bool MMPLDWriter::run() {
                 vislib::sys::Thread::Sleep(static_cast<DWORD>(1 + std::max<int>(missCnt, 0) * 100));
             }
         } while (mpdc->FrameID() != i);
+        this->endExportStage(ExportStage::FETCH);
 
-        if (!this->writeFrame(file, *mpdc)) {
-            mpdc->Unlock();
-            Log::DefaultLog.WriteError("Cannot write data frame %u. Abort.\n", i);
-            file.Close();
-            return false;
-        }
+        this->beginExportStage(ExportStage::SERIALIZE);
+        std::vector<UINT8> frame;
+        bool const serialized = this->writeFrame(frame, *mpdc);
         mpdc->Unlock();
+        this->endExportStage(ExportStage::SERIALIZE);
+        if (!serialized) {
+            ABORT_PIPELINE("Cannot write data frame %u. Abort.\n", i);
+        }
+
+        uint64_t const frameSize = frame.size();
+        this->beginExportStage(ExportStage::WAIT);
+        bool const pushed = writer.Push(std::move(frame));
+        this->endExportStage(ExportStage::WAIT);
+        if (!pushed) {
+            ABORT_PIPELINE("Write error in data frame %u. Abort.\n", i);
+        }
+        this->reportExportProgress(frameSize);
+    }
+    frameOffsets[frameCnt] = writer.Position();
+
+    this->beginExportStage(ExportStage::WAIT);
+    bool const flushed = writer.Finish();
+    this->endExportStage(ExportStage::WAIT);
+    if (!flushed) {
+        ABORT_PIPELINE("Write error while flushing data frames. Abort.\n");
     }
+#undef ABORT_PIPELINE
+    this->endExport();
 
-    frameOffset = static_cast<UINT64>(file.Tell());
-    file.Seek(seekTable + frameCnt * 8);
-    ASSERT_WRITEOUT(&frameOffset, 8);
+    file.Seek(seekTable);
+    ASSERT_WRITEOUT(frameOffsets.data(), frameOffsets.size() * 8);
 
     file.Seek(6); // set correct version to show that file is complete
     version = this->versionSlot.Param<core::param::EnumParam>()->Value();
     ASSERT_WRITEOUT(&version, 2);
 
-    file.Seek(frameOffset);
+    file.Seek(frameOffsets[frameCnt]);
 
     Log::DefaultLog.WriteInfo("Completed writing data\n");
     file.Close();
@@ -240,7 +291,16 @@ bool MMPLDWriter::run() {
  * MMPLDWriter::getCapabilities
  */
 bool MMPLDWriter::getCapabilities(core::DataWriterCtrlCall& call) {
-    call.SetAbortable(false);
+    call.SetAbortable(true);
+    return true;
+}
+
+
+/*
+ * MMPLDWriter::abort
+ */
+bool MMPLDWriter::abort() {
+    this->aborted.store(true);
     return true;
 }
 
@@ -248,16 +308,17 @@ bool MMPLDWriter::getCapabilities(core::DataWriterCtrlCall& call) {
 /*
  * MMPLDWriter::writeFrame
  */
-bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data) {
-#define ASSERT_WRITEOUT(A, S)                                   \
-    if (file.Write((A), (S)) != (S)) {                          \
-        Log::DefaultLog.WriteError("Write error %d", __LINE__); \
-        file.Close();                                           \
-        return false;                                           \
+bool MMPLDWriter::writeFrame(std::vector<UINT8>& out, geocalls::MultiParticleDataCall& data) {
+#define ASSERT_WRITEOUT(A, S)                               \
+    {                                                        \
+        auto const* b_ = reinterpret_cast<const UINT8*>(A); \
+        out.insert(out.end(), b_, b_ + (S));                 \
     }
     using megamol::core::utility::log::Log;
-    uint8_t const alpha = 255;
     int ver = this->versionSlot.Param<core::param::EnumParam>()->Value();
+    if (ver >= mmpld::COMPRESSED_VERSION) {
+        return this->writeCompressedFrame(out, data);
+    }
 
     // HAZARD for megamol up to fc4e784dae531953ad4cd3180f424605474dd18b this reads == 102
     // which means that many MMPLDs out there with version 103 are written wrongly (no timestamp)!
@@ -467,16 +528,21 @@ bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDat
                 break;
             }
         } else {
-            for (UINT64 i = 0; i < cnt; i++) {
-                ASSERT_WRITEOUT(vp, vs);
-                vp += vo;
-                if (ct != 0) {
-                    ASSERT_WRITEOUT(cp, cs);
-                    // warning: this only works since only one format is 3 bytes long, the illegal ct = 1
-                    if (cs == 3) { // the unaligned ct == 1, UINT8_RGB, will be silently upgraded to ct 2 / cs 4
-                        ASSERT_WRITEOUT(&alpha, 1);
+            // the unaligned ct == 1, UINT8_RGB, is silently upgraded to ct 2 / cs 4 by appending alpha
+            unsigned int const ds = (ct != 0) ? ((cs == 3) ? 4 : cs) : 0;
+            size_t const stride = vs + ds;
+            size_t const first = out.size();
+            out.resize(first + static_cast<size_t>(cnt * stride));
+            UINT8* dst = out.data() + first;
+#pragma omp parallel for
+            for (int64_t i = 0; i < static_cast<int64_t>(cnt); i++) {
+                UINT8* d = dst + i * stride;
+                std::memcpy(d, vp + i * vo, vs);
+                if (ds != 0) {
+                    std::memcpy(d + vs, cp + i * co, cs);
+                    if (cs == 3) {
+                        d[vs + 3] = 255;
                     }
-                    cp += co;
                 }
             }
         }
@@ -499,4 +565,267 @@ bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDat
     return true;
 #undef ASSERT_WRITEOUT
 }
+
+
+/*
+ * MMPLDWriter::writeCompressedFrame
+ */
+bool MMPLDWriter::writeCompressedFrame(std::vector<UINT8>& out, geocalls::MultiParticleDataCall& data) {
+    using geocalls::MultiParticleDataCall;
+    using megamol::core::utility::log::Log;
+    float const posTolerance = this->positionToleranceSlot.Param<core::param::FloatParam>()->Value();
+    float const colTolerance = this->colourToleranceSlot.Param<core::param::FloatParam>()->Value();
+    UINT32 const chunkSize = mmpld::DEFAULT_CHUNK_SIZE;
+
+    /** Decoded data and header of one list */
+    struct List {
+        std::vector<UINT8> header;
+        std::vector<UINT8> raw;
+        std::vector<UINT8> ids;
+        unsigned int vs = 0, cs = 0, is = 0;
+        UINT8 vt = 0, ct = 0;
+        UINT64 cnt = 0;
+    };
+    /** One block to be compressed */
+    struct Task {
+        mmpld::Codec codec;
+        float tolerance;
+        const UINT8* src;
+        UINT64 count;
+        unsigned int elemSize;
+        unsigned int stride;
+        std::vector<UINT8> out;
+    };
+
+    UINT32 const listCnt = data.GetParticleListCount();
+    std::vector<List> lists(listCnt);
+    std::vector<std::vector<size_t>> listTasks(listCnt);
+    std::vector<Task> tasks;
+    UINT64 decodedSize = 0;
+
+    for (UINT32 li = 0; li < listCnt; li++) {
+        MultiParticleDataCall::Particles& points = data.AccessParticles(li);
+        List& l = lists[li];
+
+        switch (points.GetVertexDataType()) {
+        case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
+            l.vt = 1;
+            l.vs = 12;
+            break;
+        case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
+            l.vt = 2;
+            l.vs = 16;
+            break;
+        case MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
+            l.vt = 3;
+            l.vs = 6;
+            break;
+        case MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ:
+            l.vt = 4;
+            l.vs = 24;
+            break;
+        default:
+            l.vt = 0;
+            l.vs = 0;
+            break;
+        }
+        auto const colType = points.GetColourDataType();
+        if (l.vt != 0) {
+            // same conversions as the uncompressed versions: RGB gets alpha, doubles get aligned colours
+            switch (colType) {
+            case MultiParticleDataCall::Particles::COLDATA_UINT8_RGB:
+            case MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA:
+                l.ct = 2;
+                break;
+            case MultiParticleDataCall::Particles::COLDATA_FLOAT_I:
+                l.ct = 3;
+                break;
+            case MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB:
+                l.ct = 4;
+                break;
+            case MultiParticleDataCall::Particles::COLDATA_FLOAT_RGBA:
+                l.ct = 5;
+                break;
+            case MultiParticleDataCall::Particles::COLDATA_USHORT_RGBA:
+                l.ct = 6;
+                break;
+            case MultiParticleDataCall::Particles::COLDATA_DOUBLE_I:
+                l.ct = 7;
+                break;
+            default:
+                l.ct = 0;
+                break;
+            }
+            if ((l.vt == 4) && (l.ct < 5)) {
+                l.ct = (l.ct == 3) ? 7 : 6;
+            }
+        }
+        static const unsigned int colSizes[] = {0, 3, 4, 4, 12, 16, 8, 8};
+        l.cs = colSizes[l.ct];
+        UINT8 idt = 0;
+        if (l.vt != 0) {
+            if (points.GetIDDataType() == MultiParticleDataCall::Particles::IDDATA_UINT32) {
+                idt = 1;
+                l.is = 4;
+            } else if (points.GetIDDataType() == MultiParticleDataCall::Particles::IDDATA_UINT64) {
+                idt = 2;
+                l.is = 8;
+            }
+        }
+        l.cnt = (l.vt == 0) ? 0 : points.GetCount();
+
+        // list header
+        auto put = [&l](const void* p, size_t s) {
+            auto const* b = static_cast<const UINT8*>(p);
+            l.header.insert(l.header.end(), b, b + s);
+        };
+        UINT8 const reserved = 0;
+        put(&l.vt, 1);
+        put(&l.ct, 1);
+        put(&idt, 1);
+        put(&reserved, 1);
+        if ((l.vt == 1) || (l.vt == 3) || (l.vt == 4)) {
+            float const f = points.GetGlobalRadius();
+            put(&f, 4);
+        }
+        if (l.ct == 0) {
+            put(points.GetGlobalColour(), 4);
+        } else if ((l.ct == 3) || (l.ct == 7)) {
+            float f = points.GetMinColourIndexValue();
+            put(&f, 4);
+            f = points.GetMaxColourIndexValue();
+            put(&f, 4);
+        }
+        put(&l.cnt, 8);
+        put(points.GetBBox().PeekBounds(), 24);
+
+        if (l.cnt == 0) {
+            continue;
+        }
+
+        // interleaved vertex and colour data as the reader will decode it
+        unsigned int const stride = l.vs + l.cs;
+        l.raw.resize(static_cast<size_t>(l.cnt * stride));
+        const UINT8* vp = static_cast<const UINT8*>(points.GetVertexData());
+        const UINT8* cp = static_cast<const UINT8*>(points.GetColourData());
+        unsigned int const vo = std::max(points.GetVertexDataStride(), l.vs);
+        // indexed by the call colour type, not by the MMPLD colour type
+        static const unsigned int srcColSizes[] = {0, 3, 4, 12, 16, 4, 8, 8};
+        unsigned int const co = std::max(points.GetColourDataStride(), srcColSizes[colType]);
+        const unsigned char* gc = points.GetGlobalColour();
+        UINT8* raw = l.raw.data();
+        UINT8 const ct = l.ct;
+        unsigned int const vs = l.vs;
+#pragma omp parallel for
+        for (int64_t i = 0; i < static_cast<int64_t>(l.cnt); ++i) {
+            UINT8* dst = raw + i * stride;
+            std::memcpy(dst, vp + i * vo, vs);
+            dst += vs;
+            const UINT8* c = cp + i * co;
+            if ((ct == 6) && (colType != MultiParticleDataCall::Particles::COLDATA_USHORT_RGBA)) {
+                uint16_t colNew[4] = {65535, 65535, 65535, 65535};
+                if (colType == MultiParticleDataCall::Particles::COLDATA_NONE) {
+                    for (int k = 0; k < 4; ++k) {
+                        colNew[k] = static_cast<uint16_t>(gc[k] * 257);
+                    }
+                } else if (colType == MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB) {
+                    auto const* col = reinterpret_cast<const float*>(c);
+                    for (int k = 0; k < 3; ++k) {
+                        colNew[k] = static_cast<uint16_t>(col[k] * 65535.0f);
+                    }
+                } else {
+                    int const comps = (colType == MultiParticleDataCall::Particles::COLDATA_UINT8_RGBA) ? 4 : 3;
+                    for (int k = 0; k < comps; ++k) {
+                        colNew[k] = static_cast<uint16_t>(c[k] * 257);
+                    }
+                }
+                std::memcpy(dst, colNew, 8);
+            } else if ((ct == 7) && (colType == MultiParticleDataCall::Particles::COLDATA_FLOAT_I)) {
+                double const iNew = *reinterpret_cast<const float*>(c);
+                std::memcpy(dst, &iNew, 8);
+            } else if ((ct == 2) && (colType == MultiParticleDataCall::Particles::COLDATA_UINT8_RGB)) {
+                std::memcpy(dst, c, 3);
+                dst[3] = 255;
+            } else if (ct != 0) {
+                std::memcpy(dst, c, l.cs);
+            }
+        }
+        if (l.is > 0) {
+            l.ids.resize(static_cast<size_t>(l.cnt * l.is));
+            const UINT8* ip = static_cast<const UINT8*>(points.GetIDData());
+            unsigned int const io = std::max(points.GetIDDataStride(), l.is);
+            for (UINT64 i = 0; i < l.cnt; ++i) {
+                std::memcpy(l.ids.data() + i * l.is, ip + i * io, l.is);
+            }
+        }
+        decodedSize += l.cnt * (stride + l.is);
+
+        // blocks, in the order the reader expects them
+        for (UINT64 first = 0; first < l.cnt; first += chunkSize) {
+            UINT64 const n = std::min<UINT64>(chunkSize, l.cnt - first);
+            const UINT8* base = l.raw.data() + first * stride;
+            auto addTask = [&](mmpld::Codec codec, float tol, const UINT8* src, unsigned int elemSize,
+                               unsigned int elemStride) {
+                listTasks[li].push_back(tasks.size());
+                tasks.push_back(Task{codec, tol, src, n, elemSize, elemStride, {}});
+            };
+            if (l.vt == 3) {
+                addTask(mmpld::Codec::SHUFFLE_SNAPPY, 0.0f, base, l.vs, stride);
+            } else {
+                unsigned int const scalarSize = (l.vt == 4) ? 8 : 4;
+                for (unsigned int c = 0; c < l.vs / scalarSize; ++c) {
+                    addTask(mmpld::Codec::ZFP_ACCURACY, posTolerance, base + c * scalarSize, scalarSize, stride);
+                }
+            }
+            if ((l.ct == 3) || (l.ct == 7)) {
+                addTask(mmpld::Codec::ZFP_ACCURACY, colTolerance, base + l.vs, l.cs, stride);
+            } else if (l.ct != 0) {
+                addTask(mmpld::Codec::SHUFFLE_SNAPPY, 0.0f, base + l.vs, l.cs, stride);
+            }
+            if (l.is > 0) {
+                addTask(mmpld::Codec::SHUFFLE_SNAPPY, 0.0f, l.ids.data() + first * l.is, l.is, l.is);
+            }
+        }
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t t = 0; t < static_cast<int64_t>(tasks.size()); ++t) {
+        auto& task = tasks[t];
+        mmpld::EncodeBlock(task.codec, task.tolerance, task.src, task.count, task.elemSize, task.stride, task.out);
+    }
+
+    // frame header with the list offsets relative to the frame start
+    float const ts = data.GetTimeStamp();
+    std::vector<UINT64> listOffsets(listCnt + 1);
+    UINT64 offset = sizeof(float) + 2 * sizeof(UINT32) + sizeof(UINT64) + sizeof(UINT64) * listOffsets.size();
+    for (UINT32 li = 0; li < listCnt; li++) {
+        listOffsets[li] = offset;
+        offset += lists[li].header.size();
+        for (size_t t : listTasks[li]) {
+            offset += tasks[t].out.size();
+        }
+    }
+    listOffsets[listCnt] = offset;
+
+#define ASSERT_WRITEOUT(A, S)                               \
+    {                                                        \
+        auto const* b_ = reinterpret_cast<const UINT8*>(A); \
+        out.insert(out.end(), b_, b_ + (S));                 \
+    }
+    out.reserve(out.size() + static_cast<size_t>(offset));
+    ASSERT_WRITEOUT(&ts, 4);
+    ASSERT_WRITEOUT(&listCnt, 4);
+    ASSERT_WRITEOUT(&chunkSize, 4);
+    ASSERT_WRITEOUT(&decodedSize, 8);
+    ASSERT_WRITEOUT(listOffsets.data(), sizeof(UINT64) * listOffsets.size());
+    for (UINT32 li = 0; li < listCnt; li++) {
+        ASSERT_WRITEOUT(lists[li].header.data(), lists[li].header.size());
+        for (size_t t : listTasks[li]) {
+            ASSERT_WRITEOUT(tasks[t].out.data(), tasks[t].out.size());
+        }
+    }
+
+    return true;
+#undef ASSERT_WRITEOUT
+}
 } // namespace megamol::moldyn::io
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
@@ -84,16 +87,34 @@ protected:
      */
     bool getCapabilities(core::DataWriterCtrlCall& call) override;
 
+    /**
+     * Requests the running export to stop after the current frame.
+     *
+     * @return True
+     */
+    bool abort() override;
+
 private:
     /**
-     * Writes the data of one frame to the file
+     * Serializes the data of one frame
+     *
+     * @param out  Receives the serialized frame
+     * @param data The data of the current frame
+     *
+     * @return True on success
+     */
+    bool writeFrame(std::vector<UINT8>& out, geocalls::MultiParticleDataCall& data);
+
+    /**
+     * Serializes the data of one frame as compressed frame (version 1.4).
+     * The blocks of all lists are compressed in parallel.
      *
-     * @param file The output data file
+     * @param out  Receives the serialized frame
      * @param data The data of the current frame
      *
      * @return True on success
      */
-    bool writeFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data);
+    bool writeCompressedFrame(std::vector<UINT8>& out, geocalls::MultiParticleDataCall& data);
 
     /** The file name of the file to be written */
     core::param::ParamSlot filenameSlot;
@@ -101,12 +122,24 @@ private:
     /** The file format version to be written */
     core::param::ParamSlot versionSlot;
 
+    /** The absolute error bound of compressed positions and radii, 0 for lossless */
+    core::param::ParamSlot positionToleranceSlot;
+
+    /** The absolute error bound of compressed colour intensities, 0 for lossless */
+    core::param::ParamSlot colourToleranceSlot;
+
+    /** The number of serialized frames that may be queued for the I/O thread */
+    core::param::ParamSlot pipelineDepthSlot;
+
     core::param::ParamSlot startFrameSlot;
     core::param::ParamSlot endFrameSlot;
     core::param::ParamSlot subsetSlot;
 
     /** The slot asking for data */
     core::CallerSlot dataSlot;
+
+    /** Set by abort() to stop a running export */
+    std::atomic<bool> aborted;
 };
 
 
@@ -6,6 +6,7 @@
  */
 
 #include "io/MMSPDDataSource.h"
+#include "io/TextScanner.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/utility/log/Log.h"
@@ -27,6 +28,10 @@
 #include "vislib/sys/SystemInformation.h"
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/utils.h"
+#include <utility>
+#include <vector>
+
+#include <omp.h>
 
 using namespace megamol;
 using namespace megamol::moldyn::io;
@@ -471,27 +476,123 @@ void MMSPDDataSource::Frame::SetDirData(geocalls::MultiParticleDataCall& call, c
 }
 
 
+/**
+ * Appends 'size' bytes from 'src' to 'dst'.
+ */
+static void appendRaw(std::vector<char>& dst, const void* src, size_t size) {
+    const char* bytes = static_cast<const char*>(src);
+    dst.insert(dst.end(), bytes, bytes + size);
+}
+
+
 /*
  * MMSPDDataSource::Frame::loadFrameText
  */
 void MMSPDDataSource::Frame::loadFrameText(char* buffer, UINT64 size, const MMSPDHeader& header) {
     // We don't have to brother with unicode here, because there is no string data allowed.
     // All characters must be white space, line breaks, '>' and characters forming numbers (digits, dots, plus, minus, 'e').
-    vislib::sys::MemoryFile mem;
-    mem.Open(static_cast<void*>(buffer), static_cast<SIZE_T>(size), vislib::sys::File::READ_ONLY);
-    vislib::sys::ASCIIFileBuffer txt(vislib::sys::ASCIIFileBuffer::PARSING_WORDS);
-    if (!txt.LoadFile(mem))
-        throw vislib::Exception(__FILE__, __LINE__);
-
-    if (txt.Count() <= 0)
-        throw vislib::Exception("Unable to load frame data", __FILE__, __LINE__);
-    if (txt.Line(0).Count() < 2)
+    const char* const end = buffer + size;
+    const char* const dataBegin = text::NextLine(buffer, end);
+    const char* marker = text::SkipSpace(buffer, dataBegin);
+    marker = text::SkipSpace(text::SkipToken(marker, dataBegin), dataBegin);
+    UINT64 partCnt = 0;
+    if ((marker == dataBegin) || !text::ParseUInt64(marker, dataBegin, partCnt))
         throw vislib::Exception("Illegal time frame marker", __FILE__, __LINE__);
-    UINT64 partCnt = vislib::CharTraitsA::ParseUInt64(txt.Line(0).Word(1));
-    if (txt.Count() < partCnt + 1)
+
+    // The particle lines are split into blocks, which are parsed in parallel and appended in file order.
+    const std::vector<const char*> bounds = text::SplitLines(dataBegin, end, 4 * omp_get_max_threads());
+    const long long blockCnt = static_cast<long long>(bounds.size()) - 1;
+    std::vector<UINT64> firstLine(blockCnt + 1, 0);
+#pragma omp parallel for
+    for (long long bi = 0; bi < blockCnt; bi++) {
+        UINT64 lines = 0;
+        for (const char* p = bounds[bi]; p < bounds[bi + 1]; p = text::NextLine(p, bounds[bi + 1])) {
+            lines++;
+        }
+        firstLine[bi + 1] = lines;
+    }
+    for (long long bi = 0; bi < blockCnt; bi++) {
+        firstLine[bi + 1] += firstLine[bi];
+    }
+    if (firstLine[blockCnt] < partCnt)
         throw vislib::Exception("Data frame truncated", __FILE__, __LINE__);
 
     SIZE_T typeCnt = header.GetTypes().Count();
+    struct TextBlock {
+        std::vector<std::vector<char>> typeData;      // the particles of each type
+        std::vector<std::pair<UINT32, UINT64>> types; // the runs of particle types in file order
+        const char* error = nullptr;
+    };
+    std::vector<TextBlock> blocks(blockCnt);
+#pragma omp parallel for schedule(dynamic)
+    for (long long bi = 0; bi < blockCnt; bi++) {
+        TextBlock& block = blocks[bi];
+        block.typeData.resize(typeCnt);
+        const UINT64 lastLine = vislib::math::Min(firstLine[bi + 1], partCnt);
+        const char* p = bounds[bi];
+        for (UINT64 li = firstLine[bi]; (li < lastLine) && (block.error == nullptr); li++) {
+            const char* const lineEnd = text::NextLine(p, bounds[bi + 1]);
+            const char* w = text::SkipSpace(p, lineEnd);
+            p = lineEnd;
+
+            // the optional id and type columns
+            UINT64 id = 0;
+            INT64 type = 0;
+            if (header.HasIDs()) {
+                if (w == lineEnd) {
+                    block.error = "line truncated";
+                    break;
+                }
+                if (!text::ParseUInt64(w, lineEnd, id)) {
+                    block.error = "Illegal particle id encountered";
+                    break;
+                }
+                w = text::SkipSpace(w, lineEnd);
+            }
+            if (typeCnt > 1) {
+                if (w == lineEnd) {
+                    block.error = "line truncated";
+                    break;
+                }
+                if (!text::ParseInt(w, lineEnd, type) || (type < 0) || (type >= static_cast<INT64>(typeCnt))) {
+                    block.error = "Illegal type encountered";
+                    break;
+                }
+                w = text::SkipSpace(w, lineEnd);
+            }
+            std::vector<char>& data = block.typeData[static_cast<SIZE_T>(type)];
+            if (header.HasIDs()) {
+                appendRaw(data, &id, sizeof(id));
+            }
+            if (block.types.empty() || (block.types.back().first != static_cast<UINT32>(type))) {
+                block.types.emplace_back(static_cast<UINT32>(type), 0);
+            }
+            block.types.back().second++;
+
+            const auto& fields = header.GetTypes()[static_cast<SIZE_T>(type)].GetFields();
+            for (SIZE_T fi = 0; fi < fields.Count(); fi++) {
+                float val;
+                if (w == lineEnd) {
+                    block.error = "line truncated";
+                    break;
+                }
+                if (!text::ParseFloat(w, lineEnd, val)) {
+                    block.error = "Illegal value encountered";
+                    break;
+                }
+                w = text::SkipSpace(w, lineEnd);
+                if (fields[fi].GetType() == MMSPDHeader::Field::TYPE_BYTE) {
+                    val /= 255.0f;
+                }
+                appendRaw(data, &val, sizeof(val));
+            }
+        }
+    }
+    for (const TextBlock& block : blocks) {
+        if (block.error != nullptr)
+            throw vislib::Exception(block.error, __FILE__, __LINE__);
+    }
+
     vislib::PtrArray<vislib::RawStorageWriter> typeData;
     typeData.SetCount(typeCnt);
     for (SIZE_T i = 0; i < typeCnt; i++) {
@@ -506,55 +607,13 @@ void MMSPDDataSource::Frame::loadFrameText(char* buffer, UINT64 size, const MMSP
     UINT32 irdLastType = static_cast<UINT32>(typeCnt);
     UINT64 irdLastCount;
 
-    SIZE_T type = 0;
-    for (UINT64 pi = 0; pi < partCnt; pi++) {
-        const vislib::sys::ASCIIFileBuffer::LineBuffer& line = txt.Line(static_cast<SIZE_T>(1 + pi));
-        unsigned int off = 0;
-        if (typeCnt > 1) {
-            if (header.HasIDs()) {
-                if (line.Count() < 2)
-                    throw vislib::Exception("line truncated", __FILE__, __LINE__);
-                type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(1)));
-                if (type >= typeCnt)
-                    throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
-                typeData[type]->Write(vislib::CharTraitsA::ParseUInt64(line.Word(0)));
-                off = 2;
-            } else {
-                if (line.Count() < 1)
-                    throw vislib::Exception("line truncated", __FILE__, __LINE__);
-                type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(0)));
-                if (type >= typeCnt)
-                    throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
-                off = 1;
-            }
-        } else if (header.HasIDs()) {
-            // type remains 0
-            if (line.Count() < 1)
-                throw vislib::Exception("line truncated", __FILE__, __LINE__);
-            typeData[type]->Write(vislib::CharTraitsA::ParseUInt64(line.Word(0)));
-            off = 1;
+    for (const TextBlock& block : blocks) {
+        for (SIZE_T i = 0; i < block.typeData.size(); i++) {
+            typeData[i]->Write(block.typeData[i].data(), block.typeData[i].size());
         }
-
-        this->addIndexForReconstruction(
-            static_cast<UINT32>(type), idxRecDat, this->IndexReconstructionData(), irdLastType, irdLastCount);
-
-        SIZE_T fieldCnt = header.GetTypes()[type].GetFields().Count();
-        if (line.Count() < fieldCnt + off)
-            throw vislib::Exception("line truncated", __FILE__, __LINE__);
-
-        for (SIZE_T fi = 0; fi < fieldCnt; fi++) {
-            //float val = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(off + this->GetData()[type].FieldMap()[fi])));
-            //if (header.GetTypes()[type].GetFields()[this->GetData()[type].FieldMap()[fi]].GetType() ==
-            //    MMSPDHeader::Field::TYPE_BYTE) {
-            //    val /= 255.0f;
-            //}
-            float val = vislib::CharTraitsA::ParseDouble(line.Word(off + fi));
-            if (header.GetTypes()[type].GetFields()[fi].GetType() == MMSPDHeader::Field::TYPE_BYTE) {
-                val /= 255.0f;
-            }
-
-            //megamol::core::utility::log::Log::DefaultLog.WriteInfo("read: %f", val);
-            typeData[type]->Write(val);
+        for (const auto& run : block.types) {
+            this->addIndexForReconstruction(
+                run.first, idxRecDat, this->IndexReconstructionData(), irdLastType, irdLastCount, run.second);
         }
     }
 
@@ -748,13 +807,13 @@ void MMSPDDataSource::Frame::loadFrameBinaryBE(char* buffer, UINT64 size, const
  * MMSPDDataSource::Frame::addIndexForReconstruction
  */
 void MMSPDDataSource::Frame::addIndexForReconstruction(UINT32 type, class vislib::RawStorageWriter& wrtr,
-    class vislib::RawStorage& data, UINT32& lastType, UINT64& lastCount) {
+    class vislib::RawStorage& data, UINT32& lastType, UINT64& lastCount, UINT64 count) {
     unsigned char dat[10];
     unsigned int datLen;
 
     if (type != lastType) {
         lastType = type;
-        lastCount = 1;
+        lastCount = count;
         datLen = 10;
         if (!vislib::UIntRLEEncode(dat, datLen, type))
             throw vislib::Exception(__FILE__, __LINE__);
@@ -767,7 +826,7 @@ void MMSPDDataSource::Frame::addIndexForReconstruction(UINT32 type, class vislib
     } else {
         wrtr.SetPosition(wrtr.Position() - vislib::UIntRLELength(lastCount));
         datLen = 10;
-        lastCount++;
+        lastCount += count;
         if (!vislib::UIntRLEEncode(dat, datLen, lastCount))
             throw vislib::Exception(__FILE__, __LINE__);
         wrtr.Write(dat, datLen);
@@ -232,9 +232,10 @@ private:
          * @param data The index data store
          * @param lastType The type of the last particle added
          * @param lastCount The number of the last particles of 'lastType' added
+         * @param count The number of particles of 'type' to append
          */
         void addIndexForReconstruction(UINT32 type, class vislib::RawStorageWriter& wrtr,
-            class vislib::RawStorage& data, UINT32& lastType, UINT64& lastCount);
+            class vislib::RawStorage& data, UINT32& lastType, UINT64& lastCount, UINT64 count = 1);
     };
 
     /**
@@ -0,0 +1,260 @@
+/*
+ * TextScanner.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "TextScanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace megamol::moldyn::io::text {
+
+
+/** The exactly representable powers of ten */
+static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/** The number of decimal digits that always fit into 64 bits */
+static const int MAX_DIGITS = 19;
+
+
+/**
+ * Answer whether the eight characters in 'chunk' are all decimal digits.
+ */
+static inline bool isEightDigits(uint64_t chunk) {
+    return (((chunk & 0xF0F0F0F0F0F0F0F0ull) | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+            0x3333333333333333ull);
+}
+
+
+/**
+ * Answer the value of the eight digits in 'chunk', the first digit being the
+ * lowest byte. The digits are combined pairwise in three multiply steps.
+ */
+static inline uint32_t parseEightDigits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FFull;
+    const uint64_t mul1 = 0x000F424000000064ull; // 100 + (1000000ULL << 32)
+    const uint64_t mul2 = 0x0000271000000001ull; // 1 + (10000ULL << 32)
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+
+/**
+ * Answer whether the eight-digit scanning can be used, which assumes the
+ * first character of a chunk to be its lowest byte.
+ */
+static inline bool littleEndian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    ::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+
+/**
+ * Accumulates the digits at 'p' into 'mantissa', keeping at most MAX_DIGITS
+ * significant ones. Leading zeros are not significant.
+ *
+ * @param digits   The number of significant digits in 'mantissa'.
+ * @param dropped  Incremented for each significant digit that did not fit.
+ *
+ * @return The number of digits consumed.
+ */
+static inline size_t scanDigits(const char*& p, const char* end, uint64_t& mantissa, int& digits, int& dropped) {
+    static const bool swar = littleEndian();
+    const char* start = p;
+    if (mantissa == 0) {
+        while ((p < end) && (*p == '0'))
+            ++p;
+    }
+    if (swar) {
+        while ((end - p >= 8) && (digits + 8 <= MAX_DIGITS)) {
+            uint64_t chunk;
+            ::memcpy(&chunk, p, 8);
+            if (!isEightDigits(chunk))
+                break;
+            mantissa = mantissa * 100000000ull + parseEightDigits(chunk);
+            digits += 8;
+            p += 8;
+        }
+    }
+    while ((p < end) && (*p >= '0') && (*p <= '9')) {
+        if (digits < MAX_DIGITS) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa != 0)
+                ++digits;
+        } else {
+            ++dropped;
+        }
+        ++p;
+    }
+    return static_cast<size_t>(p - start);
+}
+
+
+/**
+ * Parses the token at 'p' with the C library.
+ */
+static bool parseFloatSlow(const char*& p, const char* end, float& value) {
+    char buf[128];
+    const char* tokEnd = SkipToken(p, end);
+    size_t len = static_cast<size_t>(tokEnd - p);
+    if ((len == 0) || (len >= sizeof(buf)))
+        return false;
+    ::memcpy(buf, p, len);
+    buf[len] = 0;
+    char* parsedEnd = nullptr;
+    double d = ::strtod(buf, &parsedEnd);
+    if (parsedEnd != buf + len)
+        return false;
+    value = static_cast<float>(d);
+    p = tokEnd;
+    return true;
+}
+
+
+/*
+ * NextLine
+ */
+const char* NextLine(const char* p, const char* end) {
+    if (p >= end)
+        return end;
+    const void* nl = ::memchr(p, '\n', static_cast<size_t>(end - p));
+    return (nl == nullptr) ? end : static_cast<const char*>(nl) + 1;
+}
+
+
+/*
+ * ParseFloat
+ */
+bool ParseFloat(const char*& p, const char* end, float& value) {
+    const char* s = p;
+    bool negative = false;
+    if ((s < end) && ((*s == '-') || (*s == '+'))) {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int dropped = 0;
+    int exponent = 0;
+    size_t consumed = scanDigits(s, end, mantissa, digits, dropped);
+    exponent += dropped;
+    if ((s < end) && (*s == '.')) {
+        ++s;
+        int fracDropped = 0;
+        size_t fracConsumed = scanDigits(s, end, mantissa, digits, fracDropped);
+        consumed += fracConsumed;
+        // every fractional digit kept in the mantissa scales it by ten, leading zeros included
+        exponent -= static_cast<int>(fracConsumed) - fracDropped;
+    }
+    if (consumed == 0)
+        return parseFloatSlow(p, end, value);
+
+    if ((s < end) && ((*s == 'e') || (*s == 'E'))) {
+        ++s;
+        bool expNegative = false;
+        if ((s < end) && ((*s == '-') || (*s == '+'))) {
+            expNegative = (*s == '-');
+            ++s;
+        }
+        if ((s >= end) || (*s < '0') || (*s > '9'))
+            return parseFloatSlow(p, end, value);
+        int e = 0;
+        while ((s < end) && (*s >= '0') && (*s <= '9')) {
+            if (e < 10000)
+                e = e * 10 + (*s - '0');
+            ++s;
+        }
+        exponent += expNegative ? -e : e;
+    }
+    if ((s < end) && !IsSpace(*s))
+        return parseFloatSlow(p, end, value);
+
+    double d = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+        if ((exponent < 0) && (exponent >= -22)) {
+            d /= POW10[-exponent];
+        } else if ((exponent > 0) && (exponent <= 22)) {
+            d *= POW10[exponent];
+        } else if (exponent != 0) {
+            d *= std::pow(10.0, exponent);
+        }
+    }
+    value = static_cast<float>(negative ? -d : d);
+    p = s;
+    return true;
+}
+
+
+/*
+ * ParseInt
+ */
+bool ParseInt(const char*& p, const char* end, INT64& value) {
+    const char* s = p;
+    bool negative = false;
+    if ((s < end) && ((*s == '-') || (*s == '+'))) {
+        negative = (*s == '-');
+        ++s;
+    }
+    UINT64 u;
+    if (!ParseUInt64(s, end, u))
+        return false;
+    value = negative ? -static_cast<INT64>(u) : static_cast<INT64>(u);
+    p = s;
+    return true;
+}
+
+
+/*
+ * ParseUInt64
+ */
+bool ParseUInt64(const char*& p, const char* end, UINT64& value) {
+    const char* s = p;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int dropped = 0;
+    if ((scanDigits(s, end, mantissa, digits, dropped) == 0) || (dropped > 0))
+        return false;
+    if ((s < end) && !IsSpace(*s))
+        return false;
+    value = mantissa;
+    p = s;
+    return true;
+}
+
+
+/*
+ * SplitLines
+ */
+std::vector<const char*> SplitLines(const char* begin, const char* end, size_t parts) {
+    std::vector<const char*> bounds;
+    bounds.push_back(begin);
+    parts = std::max<size_t>(parts, 1);
+    const size_t size = static_cast<size_t>(end - begin);
+    for (size_t i = 1; i < parts; ++i) {
+        const size_t offset = (size * i) / parts;
+        if (offset == 0) {
+            continue;
+        }
+        // starting one character early keeps a split point that already is a line start
+        const char* cut = NextLine(begin + offset - 1, end);
+        if ((cut > bounds.back()) && (cut < end)) {
+            bounds.push_back(cut);
+        }
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+} // namespace megamol::moldyn::io::text
@@ -0,0 +1,88 @@
+/*
+ * TextScanner.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "vislib/types.h"
+
+
+namespace megamol::moldyn::io::text {
+
+/**
+ * Answer whether 'c' separates tokens. Line breaks count as separators.
+ */
+inline bool IsSpace(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\v') || (c == '\f');
+}
+
+/**
+ * Skips all separators, including line breaks.
+ */
+inline const char* SkipSpace(const char* p, const char* end) {
+    while ((p < end) && IsSpace(*p))
+        ++p;
+    return p;
+}
+
+/**
+ * Skips separators within the current line, stops at the line break.
+ */
+inline const char* SkipBlanks(const char* p, const char* end) {
+    while ((p < end) && (*p != '\n') && IsSpace(*p))
+        ++p;
+    return p;
+}
+
+/**
+ * Skips the token at 'p'.
+ */
+inline const char* SkipToken(const char* p, const char* end) {
+    while ((p < end) && !IsSpace(*p))
+        ++p;
+    return p;
+}
+
+/**
+ * Answer the beginning of the line following the one 'p' is in, or 'end'.
+ */
+const char* NextLine(const char* p, const char* end);
+
+/**
+ * Parses the decimal floating-point number starting at 'p', which must not
+ * be preceded by separators. Plain numbers are scanned eight digits at a
+ * time, other spellings (e.g. "inf") fall back to the C library.
+ *
+ * @param p     The position of the number, advanced past it on success.
+ * @param end   The end of the buffer.
+ * @param value Receives the number.
+ *
+ * @return 'true' on success, 'false' if the token is not a number.
+ */
+bool ParseFloat(const char*& p, const char* end, float& value);
+
+/**
+ * Parses the decimal integer starting at 'p', see ParseFloat.
+ */
+bool ParseInt(const char*& p, const char* end, INT64& value);
+
+/**
+ * Parses the unsigned decimal integer starting at 'p', see ParseFloat.
+ */
+bool ParseUInt64(const char*& p, const char* end, UINT64& value);
+
+/**
+ * Splits [begin, end) into at most 'parts' ranges that start at the
+ * beginning of a line.
+ *
+ * @return The boundaries, i.e. the first entry is 'begin', the last one 'end'.
+ */
+std::vector<const char*> SplitLines(const char* begin, const char* end, size_t parts);
+
+} // namespace megamol::moldyn::io::text
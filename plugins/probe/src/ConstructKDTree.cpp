@@ -91,12 +91,12 @@ bool ConstructKDTree::createPointCloud(std::vector<std::string>& vars) {
 
     for (auto var : vars) {
         if (this->_formatSlot.Param<core::param::EnumParam>()->Value() == 0) {
-            auto x =
-                cd->getData(std::string(this->_xSlot.Param<core::param::FlexEnumParam>()->ValueString()))->GetAsFloat();
-            auto y =
-                cd->getData(std::string(this->_ySlot.Param<core::param::FlexEnumParam>()->ValueString()))->GetAsFloat();
-            auto z =
-                cd->getData(std::string(this->_zSlot.Param<core::param::FlexEnumParam>()->ValueString()))->GetAsFloat();
+            auto x = cd->getData(std::string(this->_xSlot.Param<core::param::FlexEnumParam>()->ValueString()))
+                         ->View<float>();
+            auto y = cd->getData(std::string(this->_ySlot.Param<core::param::FlexEnumParam>()->ValueString()))
+                         ->View<float>();
+            auto z = cd->getData(std::string(this->_zSlot.Param<core::param::FlexEnumParam>()->ValueString()))
+                         ->View<float>();
 
             auto xminmax = std::minmax_element(x.begin(), x.end());
             auto yminmax = std::minmax_element(y.begin(), y.end());
@@ -115,7 +115,7 @@ bool ConstructKDTree::createPointCloud(std::vector<std::string>& vars) {
             //               ->GetAsFloat();
             int coarse_factor = 30;
             auto xyz = cd->getData(std::string(this->_xyzSlot.Param<core::param::FlexEnumParam>()->ValueString()))
-                           ->GetAsDouble();
+                           ->View<double>();
             float xmin = std::numeric_limits<float>::max();
             float xmax = std::numeric_limits<float>::min();
             float ymin = std::numeric_limits<float>::max();
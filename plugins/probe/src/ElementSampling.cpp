@@ -130,7 +130,7 @@ bool ElementSampling::getData(core::Call& call) {
     if (celements->getDataHash() != _elements_cached_hash || _trigger_recalc) {
         if (!readElements())
             return false;
-        auto bbox = celements->getData("bbox")->GetAsFloat();
+        auto bbox = celements->getData("bbox")->View<float>();
         if (bbox.size() == 6) {
             _bbox.SetBoundingBox(bbox[0], bbox[1], bbox[2], bbox[3], bbox[4], bbox[5]);
         }
@@ -141,14 +141,16 @@ bool ElementSampling::getData(core::Call& call) {
 
     if (something_has_changed) {
         ++_version;
+        // interleaved positions are sampled in place, separate coordinates are interleaved into a local copy
         std::vector<float> raw_positions;
+        adios::TypedView<float> positions;
         if (this->_formatSlot.Param<core::param::EnumParam>()->Value() == 0) {
-            auto x =
-                cd->getData(std::string(this->_xSlot.Param<core::param::FlexEnumParam>()->ValueString()))->GetAsFloat();
-            auto y =
-                cd->getData(std::string(this->_ySlot.Param<core::param::FlexEnumParam>()->ValueString()))->GetAsFloat();
-            auto z =
-                cd->getData(std::string(this->_zSlot.Param<core::param::FlexEnumParam>()->ValueString()))->GetAsFloat();
+            auto x = cd->getData(std::string(this->_xSlot.Param<core::param::FlexEnumParam>()->ValueString()))
+                         ->View<float>();
+            auto y = cd->getData(std::string(this->_ySlot.Param<core::param::FlexEnumParam>()->ValueString()))
+                         ->View<float>();
+            auto z = cd->getData(std::string(this->_zSlot.Param<core::param::FlexEnumParam>()->ValueString()))
+                         ->View<float>();
             assert(x.size() == y.size());
             assert(y.size() == z.size());
             raw_positions.resize(x.size() * 3);
@@ -157,9 +159,10 @@ bool ElementSampling::getData(core::Call& call) {
                 raw_positions[3 * i + 1] = y[i];
                 raw_positions[3 * i + 2] = z[i];
             }
+            positions = adios::TypedView<float>(raw_positions.data(), raw_positions.size());
         } else {
             const std::string varname = std::string(_xyzSlot.Param<core::param::FlexEnumParam>()->ValueString());
-            raw_positions = cd->getData(varname)->GetAsFloat();
+            positions = cd->getData(varname)->View<float>();
         }
 
         //if (cd->getData(var_str)->getType() == "double") {
@@ -168,9 +171,9 @@ bool ElementSampling::getData(core::Call& call) {
 
         //} else
         //if (cd->getData(var_str)->getType() == "float") {
-        std::vector<float> data = cd->getData(var_str)->GetAsFloat();
+        auto data = cd->getData(var_str)->View<float>();
         placeProbes(_elements);
-        doScalarSampling(_elements, data, raw_positions);
+        doScalarSampling(_elements, data, positions);
         //}
     }
 
@@ -250,8 +253,8 @@ bool ElementSampling::readElements() {
     if (!(*celements)(0))
         return false;
 
-    auto elements = celements->getData("elements")->GetAsChar();
-    auto elements_offsets = celements->getData("elements_offsets")->GetAsUInt64();
+    auto elements = celements->getData("elements")->View<char>();
+    auto elements_offsets = celements->getData("elements_offsets")->View<uint64_t>();
     auto elements_shape = celements->getData("elements_offsets")->getShape();
 
     _elements.clear();
@@ -262,11 +265,11 @@ bool ElementSampling::readElements() {
         for (int j = 0; j < elements_shape[1]; ++j) {
             std::string current_element;
             if ((i == (elements_shape[0] - 1)) && (j == (elements_shape[1] - 1))) {
-                current_element =
-                    std::string(elements.begin() + elements_offsets[i * elements_shape[1] + j], elements.end());
+                current_element = std::string(
+                    elements.data() + elements_offsets[i * elements_shape[1] + j], elements.data() + elements.size());
             } else {
-                current_element = std::string(elements.begin() + elements_offsets[i * elements_shape[1] + j],
-                    elements.begin() + elements_offsets[i * elements_shape[1] + j + 1]);
+                current_element = std::string(elements.data() + elements_offsets[i * elements_shape[1] + j],
+                    elements.data() + elements_offsets[i * elements_shape[1] + j + 1]);
             }
             std::stringstream(current_element) >> _elements[i][j];
         }
@@ -17,6 +17,7 @@
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
+#include "mmadios/CallADIOSData.h"
 #include "mmcore/param/ParamSlot.h"
 #include "probe/ProbeCollection.h"
 #include <CGAL/Polygon_mesh_processing/shape_predicates.h>
@@ -94,8 +95,8 @@ private:
     bool readElements();
 
     template<typename T>
-    void doScalarSampling(const std::vector<std::vector<Surface_mesh>>& elements, const std::vector<T>& data,
-        const std::vector<T>& data_positions);
+    void doScalarSampling(const std::vector<std::vector<Surface_mesh>>& elements, adios::TypedView<T> data,
+        adios::TypedView<T> data_positions);
     void do_triangulation(Surface_mesh& mesh_);
     void placeProbes(const std::vector<std::vector<Surface_mesh>>& elements);
 
@@ -113,7 +114,7 @@ private:
 
 template<typename T>
 void ElementSampling::doScalarSampling(const std::vector<std::vector<Surface_mesh>>& elements,
-    const std::vector<T>& data, const std::vector<T>& data_positions) {
+    adios::TypedView<T> data, adios::TypedView<T> data_positions) {
 
     float global_min = std::numeric_limits<T>::max();
     float global_max = -std::numeric_limits<T>::max();
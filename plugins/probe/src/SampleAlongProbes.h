@@ -26,6 +26,8 @@
 #include "CGAL/Triangulation_vertex_base_3.h"
 #include "CGAL/Triangulation_vertex_base_with_info_3.h"
 
+#include <atomic>
+
 #include <glm/glm.hpp>
 
 namespace megamol {
@@ -93,8 +95,56 @@ protected:
     core::param::ParamSlot _vec_param_to_samplex_y;
     core::param::ParamSlot _vec_param_to_samplex_z;
     core::param::ParamSlot _vec_param_to_samplex_w;
-
 private:
+    /**
+     * Geometry of all probes in SoA layout, gathered once per sampling run so
+     * the parallel sampling loops neither copy nor modify the probe variants.
+     */
+    struct ProbeGeometry {
+        std::vector<float> pos_x, pos_y, pos_z;
+        std::vector<float> dir_x, dir_y, dir_z;
+        std::vector<float> end;
+
+        void resize(size_t count) {
+            for (auto* v : {&pos_x, &pos_y, &pos_z, &dir_x, &dir_y, &dir_z, &end}) {
+                v->resize(count);
+            }
+        }
+
+        /** Answer the point at the given distance along probe i */
+        inline glm::vec3 samplePoint(size_t i, float offset) const {
+            return glm::vec3(pos_x[i] + offset * dir_x[i], pos_y[i] + offset * dir_y[i], pos_z[i] + offset * dir_z[i]);
+        }
+    };
+
+    /**
+     * Converts all probes to ProbeType, sets their sample radius, and gathers
+     * their geometry and result buffers. Probes of other types are replaced by
+     * a ProbeType probe with the same geometry, IntProbes are skipped (nullptr
+     * result).
+     *
+     * @param samples_per_probe The number of samples along each probe.
+     * @param radius_scale      The sample radius relative to the sample step and radius factor.
+     * @param reset_own_radius  Also update the radius of probes that are ProbeType already.
+     * @param geometry          Receives the probe geometry.
+     * @param results           Receives the sampling result of each probe.
+     */
+    template<typename ProbeType>
+    void prepareProbes(int samples_per_probe, float radius_scale, bool reset_own_radius, ProbeGeometry& geometry,
+        std::vector<std::shared_ptr<typename ProbeType::SamplingResult>>& results);
+
+    /** Lock-free minimum of an atomic and a value */
+    static inline void atomicMin(std::atomic<float>& target, float value) {
+        float current = target.load(std::memory_order_relaxed);
+        while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    /** Lock-free maximum of an atomic and a value */
+    static inline void atomicMax(std::atomic<float>& target, float value) {
+        float current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
     template<typename T>
     void doScalarSampling(const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data);
 
@@ -138,24 +188,38 @@ private:
 };
 
 
-template<typename T>
-void SampleAlongPobes::doScalarSampling(
-    const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data) {
+template<typename ProbeType>
+void SampleAlongPobes::prepareProbes(int samples_per_probe, float radius_scale, bool reset_own_radius,
+    ProbeGeometry& geometry, std::vector<std::shared_ptr<typename ProbeType::SamplingResult>>& results) {
 
-    const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
+    const int32_t probe_count = static_cast<int32_t>(_probes->getProbeCount());
 
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = -std::numeric_limits<float>::max();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
+    geometry.resize(probe_count);
+    results.assign(probe_count, nullptr);
 
-        FloatProbe probe;
+    // each iteration only reads and replaces probe i, the collection itself is not resized
+#pragma omp parallel for
+    for (int32_t i = 0; i < probe_count; i++) {
 
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
+        ProbeType probe;
+        bool valid = true;
+
+        auto visitor = [&probe, &valid, i, samples_per_probe, sample_radius_factor, radius_scale, reset_own_radius,
+                           this](auto&& arg) {
             using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::Vec4Probe> ||
-                          std::is_same_v<T, probe::FloatDistributionProbe>) {
+            if constexpr (std::is_same_v<T, ProbeType>) {
+                probe = arg;
+
+                if (reset_own_radius) {
+                    auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
+                    probe.m_sample_radius = radius_scale * sample_step * sample_radius_factor;
+                    _probes->setProbe(i, probe);
+                }
+
+            } else if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::FloatProbe> ||
+                                 std::is_same_v<T, probe::Vec4Probe> ||
+                                 std::is_same_v<T, probe::FloatDistributionProbe>) {
 
                 probe.m_timestamp = arg.m_timestamp;
                 probe.m_value_name = arg.m_value_name;
@@ -166,176 +230,196 @@ void SampleAlongPobes::doScalarSampling(
                 probe.m_cluster_id = arg.m_cluster_id;
 
                 auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = 0.5 * sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
+                probe.m_sample_radius = radius_scale * sample_step * sample_radius_factor;
 
                 _probes->setProbe(i, probe);
 
-            } else if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                probe = arg;
-
             } else {
-                // unknown/incompatible probe type, throw error? do nothing?
+                // unknown/incompatible probe type, is not sampled
+                valid = false;
             }
         };
 
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = 0.5 * sample_step * sample_radius_factor;
-
-        std::shared_ptr<FloatProbe::SamplingResult> samples = probe.getSamplingResult();
-
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = -std::numeric_limits<float>::max();
-        float min_data = std::numeric_limits<float>::max();
-        float max_data = -std::numeric_limits<float>::max();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
+        std::visit(visitor, _probes->getGenericProbe(i));
 
-        for (int j = 0; j < samples_per_probe; j++) {
-
-            pcl::PointXYZ sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
-
-            std::vector<uint32_t> k_indices;
-            std::vector<float> k_distances;
-
-            auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
-            if (num_neighbors == 0) {
-                num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
-            }
+        geometry.pos_x[i] = probe.m_position[0];
+        geometry.pos_y[i] = probe.m_position[1];
+        geometry.pos_z[i] = probe.m_position[2];
+        geometry.dir_x[i] = probe.m_direction[0];
+        geometry.dir_y[i] = probe.m_direction[1];
+        geometry.dir_z[i] = probe.m_direction[2];
+        geometry.end[i] = probe.m_end;
 
-            // accumulate values
-            float value = 0;
-            for (int n = 0; n < num_neighbors; n++) {
-                auto distance_weight = k_distances[n] / radius;
-                value += data[k_indices[n]] * distance_weight;
-                min_data = std::min(min_data, static_cast<float>(data[k_indices[n]]));
-                max_data = std::max(max_data, static_cast<float>(data[k_indices[n]]));
-            } // end num_neighbors
-            value /= num_neighbors;
-            if (this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0) {
-                samples->samples[j] = value;
-            } else {
-                samples->samples[j] = max_data;
-            }
-            min_value = std::min(min_value, value);
-            max_value = std::max(max_value, value);
-            avg_value += value;
-        } // end num samples per probe
-        avg_value /= samples_per_probe;
-        if (this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0) {
-            samples->average_value = avg_value;
-            samples->max_value = max_value;
-            samples->min_value = min_value;
-        } else {
-            samples->average_value = max_data;
-            samples->max_value = max_data;
-            samples->min_value = max_data;
+        if (valid) {
+            results[i] = probe.getSamplingResult();
+            results[i]->samples.resize(samples_per_probe);
         }
-        global_min = std::min(global_min, samples->min_value);
-        global_max = std::max(global_max, samples->max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+    }
 }
 
+
 template<typename T>
-inline void SampleAlongPobes::doScalarDistributionSampling(
+void SampleAlongPobes::doScalarSampling(
     const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data) {
 
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
+    const bool average = this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0;
 
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = -std::numeric_limits<float>::max();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
-
-        FloatDistributionProbe probe;
-
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::FloatProbe> ||
-                          std::is_same_v<T, probe::Vec4Probe>) {
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<FloatProbe::SamplingResult>> results;
+    prepareProbes<FloatProbe>(samples_per_probe, 0.5f, false, geometry, results);
 
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(-std::numeric_limits<float>::max());
+#pragma omp parallel
+    {
+        // query buffers are reused for all samples of a thread
+        std::vector<uint32_t> k_indices;
+        std::vector<float> k_distances;
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = -std::numeric_limits<float>::max();
+
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); i++) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
+
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
+            auto radius = 0.5 * sample_step * sample_radius_factor;
+
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = -std::numeric_limits<float>::max();
+            float min_data = std::numeric_limits<float>::max();
+            float max_data = -std::numeric_limits<float>::max();
+            float avg_value = 0.0f;
 
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = 0.5 * sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
+            for (int j = 0; j < samples_per_probe; j++) {
 
-                _probes->setProbe(i, probe);
+                auto const p = geometry.samplePoint(i, j * sample_step);
+                pcl::PointXYZ sample_point;
+                sample_point.x = p.x;
+                sample_point.y = p.y;
+                sample_point.z = p.z;
 
-            } else if constexpr (std::is_same_v<T, probe::FloatDistributionProbe>) {
-                probe = arg;
+                auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
+                if (num_neighbors == 0) {
+                    num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
+                }
 
+                // accumulate values
+                float value = 0;
+                for (int n = 0; n < num_neighbors; n++) {
+                    auto distance_weight = k_distances[n] / radius;
+                    value += data[k_indices[n]] * distance_weight;
+                    min_data = std::min(min_data, static_cast<float>(data[k_indices[n]]));
+                    max_data = std::max(max_data, static_cast<float>(data[k_indices[n]]));
+                } // end num_neighbors
+                value /= num_neighbors;
+                if (average) {
+                    samples->samples[j] = value;
+                } else {
+                    samples->samples[j] = max_data;
+                }
+                min_value = std::min(min_value, value);
+                max_value = std::max(max_value, value);
+                avg_value += value;
+            } // end num samples per probe
+            avg_value /= samples_per_probe;
+            if (average) {
+                samples->average_value = avg_value;
+                samples->max_value = max_value;
+                samples->min_value = min_value;
             } else {
-                // unknown/incompatible probe type, throw error? do nothing?
+                samples->average_value = max_data;
+                samples->max_value = max_data;
+                samples->min_value = max_data;
             }
-        };
+            thread_min = std::min(thread_min, samples->min_value);
+            thread_max = std::max(thread_max, samples->max_value);
+        } // end for probes
 
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = 0.5 * sample_step * sample_radius_factor;
-
-        std::shared_ptr<FloatDistributionProbe::SamplingResult> samples = probe.getSamplingResult();
-
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = std::numeric_limits<float>::min();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
+}
 
-        for (int j = 0; j < samples_per_probe; j++) {
+template<typename T>
+inline void SampleAlongPobes::doScalarDistributionSampling(
+    const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data) {
 
-            pcl::PointXYZ sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
+    const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
+    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
-            std::vector<uint32_t> k_indices;
-            std::vector<float> k_distances;
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<FloatDistributionProbe::SamplingResult>> results;
+    prepareProbes<FloatDistributionProbe>(samples_per_probe, 0.5f, false, geometry, results);
 
-            auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
-            if (num_neighbors == 0) {
-                num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
-            }
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(-std::numeric_limits<float>::max());
+#pragma omp parallel
+    {
+        std::vector<uint32_t> k_indices;
+        std::vector<float> k_distances;
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = -std::numeric_limits<float>::max();
+
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); i++) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
+
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
+            auto radius = 0.5 * sample_step * sample_radius_factor;
+
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = std::numeric_limits<float>::min();
+            float avg_value = 0.0f;
+
+            for (int j = 0; j < samples_per_probe; j++) {
+
+                auto const p = geometry.samplePoint(i, j * sample_step);
+                pcl::PointXYZ sample_point;
+                sample_point.x = p.x;
+                sample_point.y = p.y;
+                sample_point.z = p.z;
+
+                auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
+                if (num_neighbors == 0) {
+                    num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
+                }
 
-            // accumulate values
-            float value = 0.0f;
-            float min_data = std::numeric_limits<float>::max();
-            float max_data = std::numeric_limits<float>::min();
-            for (int n = 0; n < num_neighbors; n++) {
-                value += data[k_indices[n]];
-                min_data = std::min(min_data, static_cast<float>(data[k_indices[n]]));
-                max_data = std::max(max_data, static_cast<float>(data[k_indices[n]]));
-            } // end num_neighbors
-            value /= num_neighbors;
-
-            samples->samples[j].mean = value;
-            samples->samples[j].lower_bound = min_data;
-            samples->samples[j].upper_bound = max_data;
-
-            min_value = std::min(min_value, min_data);
-            max_value = std::max(max_value, max_data);
-            avg_value += value;
-        } // end num samples per probe
-
-        global_min = std::min(global_min, min_value);
-        global_max = std::max(global_max, max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+                // accumulate values
+                float value = 0.0f;
+                float min_data = std::numeric_limits<float>::max();
+                float max_data = std::numeric_limits<float>::min();
+                for (int n = 0; n < num_neighbors; n++) {
+                    value += data[k_indices[n]];
+                    min_data = std::min(min_data, static_cast<float>(data[k_indices[n]]));
+                    max_data = std::max(max_data, static_cast<float>(data[k_indices[n]]));
+                } // end num_neighbors
+                value /= num_neighbors;
+
+                samples->samples[j].mean = value;
+                samples->samples[j].lower_bound = min_data;
+                samples->samples[j].upper_bound = max_data;
+
+                min_value = std::min(min_value, min_data);
+                max_value = std::max(max_value, max_data);
+                avg_value += value;
+            } // end num samples per probe
+
+            thread_min = std::min(thread_min, min_value);
+            thread_max = std::max(thread_max, max_value);
+        } // end for probes
+
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
 }
 
 template<typename T>
@@ -346,98 +430,52 @@ inline void SampleAlongPobes::doVectorSamling(const std::shared_ptr<pcl::KdTreeF
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
-
-        Vec4Probe probe;
-
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::FloatProbe> ||
-                          std::is_same_v<T, probe::FloatDistributionProbe>) {
-
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
-
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
-
-                _probes->setProbe(i, probe);
-
-            } else if constexpr (std::is_same_v<T, probe::Vec4Probe>) {
-                probe = arg;
-
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
-
-                _probes->setProbe(i, probe);
-
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
-            }
-        };
-
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = sample_step * sample_radius_factor;
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<Vec4Probe::SamplingResult>> results;
+    prepareProbes<Vec4Probe>(samples_per_probe, 1.0f, true, geometry, results);
 
-        std::shared_ptr<Vec4Probe::SamplingResult> samples = probe.getSamplingResult();
-
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = -std::numeric_limits<float>::max();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
+#pragma omp parallel
+    {
+        std::vector<uint32_t> k_indices;
+        std::vector<float> k_distances;
 
-        for (int j = 0; j < samples_per_probe; j++) {
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); i++) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
 
-            pcl::PointXYZ sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
+            auto radius = sample_step * sample_radius_factor;
 
-            std::vector<uint32_t> k_indices;
-            std::vector<float> k_distances;
+            for (int j = 0; j < samples_per_probe; j++) {
 
-            auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
-            if (num_neighbors == 0) {
-                num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
-            }
+                auto const p = geometry.samplePoint(i, j * sample_step);
+                pcl::PointXYZ sample_point;
+                sample_point.x = p.x;
+                sample_point.y = p.y;
+                sample_point.z = p.z;
 
+                auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
+                if (num_neighbors == 0) {
+                    num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
+                }
 
-            // accumulate values
-            float value_x = 0, value_y = 0, value_z = 0, value_w = 0;
-            for (int n = 0; n < num_neighbors; n++) {
-                value_x += data_x[k_indices[n]];
-                value_y += data_y[k_indices[n]];
-                value_z += data_z[k_indices[n]];
-                value_w += data_w[k_indices[n]];
-            } // end num_neighbors
-            samples->samples[j][0] = value_x / num_neighbors;
-            ;
-            samples->samples[j][1] = value_y / num_neighbors;
-            ;
-            samples->samples[j][2] = value_z / num_neighbors;
-            ;
-            samples->samples[j][3] = value_w / num_neighbors;
-            ;
-            //min_value = std::min(min_value, value);
-            //max_value = std::max(max_value, value);
-            //avg_value += value;
-        } // end num samples per probe
-        //avg_value /= samples_per_probe;
-        //samples->average_value = avg_value;
-        //samples->max_value = max_value;
-        //samples->min_value = min_value;
-    } // end for probes
+                // accumulate values
+                float value_x = 0, value_y = 0, value_z = 0, value_w = 0;
+                for (int n = 0; n < num_neighbors; n++) {
+                    value_x += data_x[k_indices[n]];
+                    value_y += data_y[k_indices[n]];
+                    value_z += data_z[k_indices[n]];
+                    value_w += data_w[k_indices[n]];
+                } // end num_neighbors
+                samples->samples[j][0] = value_x / num_neighbors;
+                samples->samples[j][1] = value_y / num_neighbors;
+                samples->samples[j][2] = value_z / num_neighbors;
+                samples->samples[j][3] = value_w / num_neighbors;
+            } // end num samples per probe
+        }     // end for probes
+    }
 }
 
 
@@ -466,112 +504,88 @@ void SampleAlongPobes::doTetrahedralSampling(
     }
 
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
-    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
-
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = std::numeric_limits<float>::lowest();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); ++i) {
-
-        FloatProbe probe;
 
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::Vec4Probe> ||
-                          std::is_same_v<T, probe::FloatDistributionProbe>) {
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<FloatProbe::SamplingResult>> results;
+    prepareProbes<FloatProbe>(samples_per_probe, 0.5f, false, geometry, results);
 
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
-
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = 0.5 * sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(std::numeric_limits<float>::lowest());
+#pragma omp parallel
+    {
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = std::numeric_limits<float>::lowest();
 
-                _probes->setProbe(i, probe);
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); ++i) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
 
-            } else if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                probe = arg;
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
 
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
-            }
-        };
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = std::numeric_limits<float>::lowest();
+            float avg_value = 0.0f;
 
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
+            // consecutive samples are close to each other, so the walk starts at the previous cell
+            typename Triangulation::Cell_handle hint;
 
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = 0.5 * sample_step * sample_radius_factor;
+            for (int j = 0; j < samples_per_probe; ++j) {
 
-        std::shared_ptr<FloatProbe::SamplingResult> samples = probe.getSamplingResult();
+                auto const p = geometry.samplePoint(i, static_cast<float>(j) * sample_step);
+                Point sample_point(p.x, p.y, p.z);
 
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = std::numeric_limits<float>::lowest();
-        /*float min_data = std::numeric_limits<float>::max();
-        float max_data = -std::numeric_limits<float>::max();*/
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
+                T val = std::numeric_limits<T>::signaling_NaN();
 
-        for (int j = 0; j < samples_per_probe; ++j) {
+                auto cell = tri.locate(sample_point, hint);
+                if (!tri.is_infinite(cell)) {
+                    hint = cell;
 
-            Point sample_point(probe.m_position[0] + static_cast<float>(j) * sample_step * probe.m_direction[0],
-                probe.m_position[1] + static_cast<float>(j) * sample_step * probe.m_direction[1],
-                probe.m_position[2] + static_cast<float>(j) * sample_step * probe.m_direction[2]);
+                    Tetrahedron tet_c = Tetrahedron(cell->vertex(0)->point(), cell->vertex(1)->point(),
+                        cell->vertex(2)->point(), cell->vertex(3)->point());
+                    Tetrahedron tet_0 = Tetrahedron(
+                        sample_point, cell->vertex(1)->point(), cell->vertex(2)->point(), cell->vertex(3)->point());
+                    Tetrahedron tet_1 = Tetrahedron(
+                        cell->vertex(0)->point(), sample_point, cell->vertex(2)->point(), cell->vertex(3)->point());
+                    Tetrahedron tet_2 = Tetrahedron(
+                        cell->vertex(0)->point(), cell->vertex(1)->point(), sample_point, cell->vertex(3)->point());
+                    Tetrahedron tet_3 = Tetrahedron(
+                        cell->vertex(0)->point(), cell->vertex(1)->point(), cell->vertex(2)->point(), sample_point);
 
-            T val = std::numeric_limits<T>::signaling_NaN();
+                    auto const V_c = tet_c.volume();
 
-            auto cell = tri.locate(sample_point);
-            if (!tri.is_infinite(cell)) {
-                Tetrahedron tet_c = Tetrahedron(cell->vertex(0)->point(), cell->vertex(1)->point(),
-                    cell->vertex(2)->point(), cell->vertex(3)->point());
-                Tetrahedron tet_0 = Tetrahedron(
-                    sample_point, cell->vertex(1)->point(), cell->vertex(2)->point(), cell->vertex(3)->point());
-                Tetrahedron tet_1 = Tetrahedron(
-                    cell->vertex(0)->point(), sample_point, cell->vertex(2)->point(), cell->vertex(3)->point());
-                Tetrahedron tet_2 = Tetrahedron(
-                    cell->vertex(0)->point(), cell->vertex(1)->point(), sample_point, cell->vertex(3)->point());
-                Tetrahedron tet_3 = Tetrahedron(
-                    cell->vertex(0)->point(), cell->vertex(1)->point(), cell->vertex(2)->point(), sample_point);
+                    auto const a_0 = tet_0.volume() / V_c;
+                    auto const a_1 = tet_1.volume() / V_c;
+                    auto const a_2 = tet_2.volume() / V_c;
+                    auto const a_3 = tet_3.volume() / V_c;
 
-                auto const V_c = tet_c.volume();
+                    auto const val_0 = cell->vertex(0)->info();
+                    auto const val_1 = cell->vertex(1)->info();
+                    auto const val_2 = cell->vertex(2)->info();
+                    auto const val_3 = cell->vertex(3)->info();
 
-                auto const V_0 = tet_0.volume();
-                auto const V_1 = tet_1.volume();
-                auto const V_2 = tet_2.volume();
-                auto const V_3 = tet_3.volume();
+                    val = a_0 * val_0 + a_1 * val_1 + a_2 * val_2 + a_3 * val_3;
+                }
+                samples->samples[j] = val;
 
-                auto const a_0 = V_0 / V_c;
-                auto const a_1 = V_1 / V_c;
-                auto const a_2 = V_2 / V_c;
-                auto const a_3 = V_3 / V_c;
+                min_value = std::min<decltype(min_value)>(min_value, val);
+                max_value = std::max<decltype(max_value)>(max_value, val);
+                avg_value += val;
+            } // end num samples per probe
 
-                auto const val_0 = cell->vertex(0)->info();
-                auto const val_1 = cell->vertex(1)->info();
-                auto const val_2 = cell->vertex(2)->info();
-                auto const val_3 = cell->vertex(3)->info();
+            avg_value /= samples_per_probe;
+            samples->average_value = avg_value;
+            samples->max_value = max_value;
+            samples->min_value = min_value;
+            thread_min = std::min(thread_min, samples->min_value);
+            thread_max = std::max(thread_max, samples->max_value);
+        } // end for probes
 
-                val = a_0 * val_0 + a_1 * val_1 + a_2 * val_2 + a_3 * val_3;
-            }
-            samples->samples[j] = val;
-
-            min_value = std::min<decltype(min_value)>(min_value, val);
-            max_value = std::max<decltype(max_value)>(max_value, val);
-            avg_value += val;
-        } // end num samples per probe
-
-        avg_value /= samples_per_probe;
-        samples->average_value = avg_value;
-        samples->max_value = max_value;
-        samples->min_value = min_value;
-        global_min = std::min(global_min, samples->min_value);
-        global_max = std::max(global_max, samples->max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
     _probes->shuffle_probes();
 }
 
@@ -597,141 +611,99 @@ inline void SampleAlongPobes::doTetrahedralVectorSamling(const std::shared_ptr<p
         auto const num_points = tree->getInputCloud()->points.size();
         auto const& cloud = tree->getInputCloud()->points;
         std::vector<std::pair<Point, InfoType>> points(num_points);
-        for (int i = 0; i < num_points; ++i) {
-
+#pragma omp parallel for
+        for (int64_t i = 0; i < static_cast<int64_t>(num_points); ++i) {
             pcl::PointXYZ const& p = cloud[i];
-            T const& val_x = data_x[i];
-            T const& val_y = data_y[i];
-            T const& val_z = data_z[i];
-            T const& val_w = data_w[i];
-
-            points[i] = std::make_pair(Point(p.x, p.y, p.z), std::array<T, 4>({val_x, val_y, val_z, val_w}));
+            points[i] = std::make_pair(Point(p.x, p.y, p.z), InfoType({data_x[i], data_y[i], data_z[i], data_w[i]}));
         }
         tri = Triangulation(points.cbegin(), points.cend());
     }
 
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
-    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
-
-    std::vector<char> invalid_probes(_probes->getProbeCount(), 1);
-
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = std::numeric_limits<float>::lowest();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); ++i) {
-
-        Vec4Probe probe;
-
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::FloatProbe> ||
-                          std::is_same_v<T, probe::FloatDistributionProbe>) {
-
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
 
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<Vec4Probe::SamplingResult>> results;
+    prepareProbes<Vec4Probe>(samples_per_probe, 1.0f, true, geometry, results);
 
-                _probes->setProbe(i, probe);
+    std::vector<char> invalid_probes(results.size(), 1);
 
-            } else if constexpr (std::is_same_v<T, probe::Vec4Probe>) {
-                probe = arg;
-
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
-
-                _probes->setProbe(i, probe);
-
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
-            }
-        };
-
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = 0.5 * sample_step * sample_radius_factor;
-
-        std::shared_ptr<Vec4Probe::SamplingResult> samples = probe.getSamplingResult();
-
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = std::numeric_limits<float>::lowest();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
-
-        for (int j = 0; j < samples_per_probe; ++j) {
-
-            Point sample_point(probe.m_position[0] + static_cast<float>(j) * sample_step * probe.m_direction[0],
-                probe.m_position[1] + static_cast<float>(j) * sample_step * probe.m_direction[1],
-                probe.m_position[2] + static_cast<float>(j) * sample_step * probe.m_direction[2]);
-
-            InfoType val = {std::numeric_limits<float>::signaling_NaN(), std::numeric_limits<float>::signaling_NaN(),
-                std::numeric_limits<float>::signaling_NaN(), std::numeric_limits<float>::signaling_NaN()};
-
-            auto cell = tri.locate(sample_point);
-            if (!tri.is_infinite(cell)) {
-                invalid_probes[i] = 0;
-
-                Tetrahedron tet_c = Tetrahedron(cell->vertex(0)->point(), cell->vertex(1)->point(),
-                    cell->vertex(2)->point(), cell->vertex(3)->point());
-                Tetrahedron tet_0 = Tetrahedron(
-                    sample_point, cell->vertex(1)->point(), cell->vertex(2)->point(), cell->vertex(3)->point());
-                Tetrahedron tet_1 = Tetrahedron(
-                    cell->vertex(0)->point(), sample_point, cell->vertex(2)->point(), cell->vertex(3)->point());
-                Tetrahedron tet_2 = Tetrahedron(
-                    cell->vertex(0)->point(), cell->vertex(1)->point(), sample_point, cell->vertex(3)->point());
-                Tetrahedron tet_3 = Tetrahedron(
-                    cell->vertex(0)->point(), cell->vertex(1)->point(), cell->vertex(2)->point(), sample_point);
-
-                auto const V_c = tet_c.volume();
-
-                auto const V_0 = tet_0.volume();
-                auto const V_1 = tet_1.volume();
-                auto const V_2 = tet_2.volume();
-                auto const V_3 = tet_3.volume();
-
-                auto const a_0 = V_0 / V_c;
-                auto const a_1 = V_1 / V_c;
-                auto const a_2 = V_2 / V_c;
-                auto const a_3 = V_3 / V_c;
-
-                auto const val_0 = cell->vertex(0)->info();
-                auto const val_1 = cell->vertex(1)->info();
-                auto const val_2 = cell->vertex(2)->info();
-                auto const val_3 = cell->vertex(3)->info();
-
-                std::get<0>(val) = a_0 * std::get<0>(val_0) + a_1 * std::get<0>(val_1) + a_2 * std::get<0>(val_2) +
-                                   a_3 * std::get<0>(val_3);
-                std::get<1>(val) = a_0 * std::get<1>(val_0) + a_1 * std::get<1>(val_1) + a_2 * std::get<1>(val_2) +
-                                   a_3 * std::get<1>(val_3);
-                std::get<2>(val) = a_0 * std::get<2>(val_0) + a_1 * std::get<2>(val_1) + a_2 * std::get<2>(val_2) +
-                                   a_3 * std::get<2>(val_3);
-                std::get<3>(val) = a_0 * std::get<3>(val_0) + a_1 * std::get<3>(val_1) + a_2 * std::get<3>(val_2) +
-                                   a_3 * std::get<3>(val_3);
-            }
-            std::array<float, 4> sample = {std::get<0>(val), std::get<1>(val), std::get<2>(val), std::get<3>(val)};
-            samples->samples[j] = sample;
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(std::numeric_limits<float>::lowest());
+#pragma omp parallel
+    {
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = std::numeric_limits<float>::lowest();
+
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); ++i) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
+
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
+
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = std::numeric_limits<float>::lowest();
+
+            // consecutive samples are close to each other, so the walk starts at the previous cell
+            typename Triangulation::Cell_handle hint;
+
+            for (int j = 0; j < samples_per_probe; ++j) {
+
+                auto const p = geometry.samplePoint(i, static_cast<float>(j) * sample_step);
+                Point sample_point(p.x, p.y, p.z);
+
+                InfoType val = {std::numeric_limits<float>::signaling_NaN(),
+                    std::numeric_limits<float>::signaling_NaN(), std::numeric_limits<float>::signaling_NaN(),
+                    std::numeric_limits<float>::signaling_NaN()};
+
+                auto cell = tri.locate(sample_point, hint);
+                if (!tri.is_infinite(cell)) {
+                    hint = cell;
+                    invalid_probes[i] = 0;
+
+                    Tetrahedron tet_c = Tetrahedron(cell->vertex(0)->point(), cell->vertex(1)->point(),
+                        cell->vertex(2)->point(), cell->vertex(3)->point());
+                    Tetrahedron tet_0 = Tetrahedron(
+                        sample_point, cell->vertex(1)->point(), cell->vertex(2)->point(), cell->vertex(3)->point());
+                    Tetrahedron tet_1 = Tetrahedron(
+                        cell->vertex(0)->point(), sample_point, cell->vertex(2)->point(), cell->vertex(3)->point());
+                    Tetrahedron tet_2 = Tetrahedron(
+                        cell->vertex(0)->point(), cell->vertex(1)->point(), sample_point, cell->vertex(3)->point());
+                    Tetrahedron tet_3 = Tetrahedron(
+                        cell->vertex(0)->point(), cell->vertex(1)->point(), cell->vertex(2)->point(), sample_point);
+
+                    auto const V_c = tet_c.volume();
+
+                    auto const a_0 = tet_0.volume() / V_c;
+                    auto const a_1 = tet_1.volume() / V_c;
+                    auto const a_2 = tet_2.volume() / V_c;
+                    auto const a_3 = tet_3.volume() / V_c;
+
+                    auto const& val_0 = cell->vertex(0)->info();
+                    auto const& val_1 = cell->vertex(1)->info();
+                    auto const& val_2 = cell->vertex(2)->info();
+                    auto const& val_3 = cell->vertex(3)->info();
+
+                    for (int c = 0; c < 4; ++c) {
+                        val[c] = a_0 * val_0[c] + a_1 * val_1[c] + a_2 * val_2[c] + a_3 * val_3[c];
+                    }
+                }
+                std::array<float, 4> sample = {val[0], val[1], val[2], val[3]};
+                samples->samples[j] = sample;
 
-            min_value = std::min(min_value, std::get<3>(sample));
-            max_value = std::max(max_value, std::get<3>(sample));
-            avg_value += std::get<3>(sample);
-        } // end num samples per probe
+                min_value = std::min(min_value, std::get<3>(sample));
+                max_value = std::max(max_value, std::get<3>(sample));
+            } // end num samples per probe
 
-        avg_value /= samples_per_probe;
+            thread_min = std::min(thread_min, min_value);
+            thread_max = std::max(thread_max, max_value);
+        } // end for probes
 
-        global_min = std::min(global_min, min_value);
-        global_max = std::max(global_max, max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
     _probes->erase_probes(invalid_probes);
     _probes->shuffle_probes();
 }
@@ -762,362 +734,266 @@ void SampleAlongPobes::doNearestNeighborSampling(
     }
 
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
-    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = std::numeric_limits<float>::lowest();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); ++i) {
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<FloatProbe::SamplingResult>> results;
+    prepareProbes<FloatProbe>(samples_per_probe, 0.5f, false, geometry, results);
 
-        FloatProbe probe;
-
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::Vec4Probe> ||
-                          std::is_same_v<T, probe::FloatDistributionProbe>) {
-
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
-
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = 0.5 * sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
-
-                _probes->setProbe(i, probe);
-
-            } else if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                probe = arg;
-
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
-            }
-        };
-
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(std::numeric_limits<float>::lowest());
+#pragma omp parallel
+    {
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = std::numeric_limits<float>::lowest();
 
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = 0.5 * sample_step * sample_radius_factor;
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); ++i) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
 
-        std::shared_ptr<FloatProbe::SamplingResult> samples = probe.getSamplingResult();
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
 
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = std::numeric_limits<float>::lowest();
-        /*float min_data = std::numeric_limits<float>::max();
-        float max_data = -std::numeric_limits<float>::max();*/
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
+            // consecutive samples are close to each other, so the walk starts at the previous cell
+            typename Triangulation::Cell_handle hint;
 
-        for (int j = 0; j < samples_per_probe; ++j) {
+            for (int j = 0; j < samples_per_probe; ++j) {
 
-            Point sample_point(probe.m_position[0] + static_cast<float>(j) * sample_step * probe.m_direction[0],
-                probe.m_position[1] + static_cast<float>(j) * sample_step * probe.m_direction[1],
-                probe.m_position[2] + static_cast<float>(j) * sample_step * probe.m_direction[2]);
+                auto const p = geometry.samplePoint(i, static_cast<float>(j) * sample_step);
+                Point sample_point(p.x, p.y, p.z);
 
-            T val = std::numeric_limits<T>::signaling_NaN();
+                T val = std::numeric_limits<T>::signaling_NaN();
 
-            auto cell = tri.locate(sample_point);
-            if (!tri.is_infinite(cell)) {
-                auto vertex = tri.nearest_vertex_in_cell(sample_point, cell);
+                auto cell = tri.locate(sample_point, hint);
+                if (!tri.is_infinite(cell)) {
+                    hint = cell;
+                    auto vertex = tri.nearest_vertex_in_cell(sample_point, cell);
 
-                val = vertex->info();
-            }
+                    val = vertex->info();
+                }
 
-            samples->samples[j] = val;
+                samples->samples[j] = val;
+            } // end num samples per probe
 
-            min_value = std::min<decltype(min_value)>(min_value, val);
-            max_value = std::max<decltype(max_value)>(max_value, val);
-            avg_value += val;
-        } // end num samples per probe
+            thread_min = std::min(thread_min, samples->min_value);
+            thread_max = std::max(thread_max, samples->max_value);
+        } // end for probes
 
-        avg_value /= samples_per_probe;
-        /*if (this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0) {
-            samples->average_value = avg_value;
-            samples->max_value = max_value;
-            samples->min_value = min_value;
-        } else {
-            samples->average_value = max_data;
-            samples->max_value = max_data;
-            samples->min_value = max_data;
-        }*/
-        global_min = std::min(global_min, samples->min_value);
-        global_max = std::max(global_max, samples->max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
 }
 
 template<typename T>
 void SampleAlongPobes::SampleAlongPobes::doVolumeRadiusSampling(T* data) {
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
+    const bool average = this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0;
 
     glm::vec3 origin = {_vol_metadata->Origin[0], _vol_metadata->Origin[1], _vol_metadata->Origin[2]};
     glm::vec3 spacing = {*_vol_metadata->SliceDists[0], *_vol_metadata->SliceDists[1], *_vol_metadata->SliceDists[2]};
-    float min_spacing = std::min(std::min(spacing.x, spacing.y), spacing.z);
+    const size_t res_y = _vol_metadata->Resolution[1];
+    const size_t res_z = _vol_metadata->Resolution[2];
 
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = -std::numeric_limits<float>::max();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<FloatProbe::SamplingResult>> results;
+    prepareProbes<FloatProbe>(samples_per_probe, 0.5f, false, geometry, results);
 
-        FloatProbe probe;
-
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::Vec4Probe>) {
-
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
-
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = 0.5 * sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
-
-                _probes->setProbe(i, probe);
-
-            } else if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                probe = arg;
-
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
-            }
-        };
-
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = 0.5 * sample_step * sample_radius_factor;
-        auto grid_radius = glm::vec3(radius) / spacing;
-        std::array<int, 3> num_grid_points_per_dim = {grid_radius.x * 2, grid_radius.y * 2, grid_radius.z * 2};
-
-        bool get_nearest = false;
-        for (int i = 0; i < num_grid_points_per_dim.size(); ++i) {
-            if (num_grid_points_per_dim[i] < 1) {
-                num_grid_points_per_dim[i] = 1;
-                get_nearest = true;
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(-std::numeric_limits<float>::max());
+    std::atomic<bool> non_finite(false);
+#pragma omp parallel
+    {
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = -std::numeric_limits<float>::max();
+
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); i++) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
+
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
+            auto radius = 0.5 * sample_step * sample_radius_factor;
+            auto grid_radius = glm::vec3(radius) / spacing;
+            std::array<int, 3> num_grid_points_per_dim = {static_cast<int>(grid_radius.x * 2),
+                static_cast<int>(grid_radius.y * 2), static_cast<int>(grid_radius.z * 2)};
+
+            bool get_nearest = false;
+            for (int d = 0; d < num_grid_points_per_dim.size(); ++d) {
+                if (num_grid_points_per_dim[d] < 1) {
+                    num_grid_points_per_dim[d] = 1;
+                    get_nearest = true;
+                }
             }
-        }
 
-        std::shared_ptr<FloatProbe::SamplingResult> samples = probe.getSamplingResult();
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = -std::numeric_limits<float>::max();
-        float min_data = std::numeric_limits<float>::max();
-        float max_data = -std::numeric_limits<float>::max();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
-
-
-        for (int j = 0; j < samples_per_probe; j++) {
-
-            glm::vec3 sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
-
-
-            // calculate in which cell (i,j,k) the point resides in
-            glm::vec3 grid_point = (sample_point - origin) / spacing;
-
-            glm::vec3 start = {std::roundf(grid_point.x - grid_radius.x), std::roundf(grid_point.y - grid_radius.y),
-                std::roundf(grid_point.z - grid_radius.z)};
-            auto end = grid_point + grid_radius;
-
-            float value = 0;
-            int num_samples = 0;
-            for (int k = 0; k < num_grid_points_per_dim[0]; ++k) {
-                for (int l = 0; l < num_grid_points_per_dim[1]; ++l) {
-                    for (int m = 0; m < num_grid_points_per_dim[2]; ++m) {
-                        auto pos = start + glm::vec3(k, l, m);
-                        auto dif = pos - grid_point;
-                        if ((std::abs(dif.x) <= grid_radius.x && std::abs(dif.y) <= grid_radius.y &&
-                                std::abs(dif.z) <= grid_radius.z) ||
-                            get_nearest) {
-                            int index =
-                                pos.z + _vol_metadata->Resolution[1] * (pos.y + _vol_metadata->Resolution[2] * pos.x);
-                            assert(index < _vol_metadata->Resolution[0] * _vol_metadata->Resolution[1] *
-                                               _vol_metadata->Resolution[2]);
-                            float current_data = data[index];
-                            value += current_data;
-                            min_data = std::min(min_data, current_data);
-                            max_data = std::max(max_data, current_data);
-
-                            num_samples++;
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = -std::numeric_limits<float>::max();
+            float min_data = std::numeric_limits<float>::max();
+            float max_data = -std::numeric_limits<float>::max();
+            float avg_value = 0.0f;
+
+            for (int j = 0; j < samples_per_probe; j++) {
+
+                glm::vec3 sample_point = geometry.samplePoint(i, j * sample_step);
+
+                // calculate in which cell (i,j,k) the point resides in
+                glm::vec3 grid_point = (sample_point - origin) / spacing;
+
+                glm::vec3 start = {std::roundf(grid_point.x - grid_radius.x),
+                    std::roundf(grid_point.y - grid_radius.y), std::roundf(grid_point.z - grid_radius.z)};
+
+                float value = 0;
+                int num_samples = 0;
+                for (int k = 0; k < num_grid_points_per_dim[0]; ++k) {
+                    for (int l = 0; l < num_grid_points_per_dim[1]; ++l) {
+                        for (int m = 0; m < num_grid_points_per_dim[2]; ++m) {
+                            auto pos = start + glm::vec3(k, l, m);
+                            auto dif = pos - grid_point;
+                            if ((std::abs(dif.x) <= grid_radius.x && std::abs(dif.y) <= grid_radius.y &&
+                                    std::abs(dif.z) <= grid_radius.z) ||
+                                get_nearest) {
+                                int index = pos.z + res_y * (pos.y + res_z * pos.x);
+                                assert(index < _vol_metadata->Resolution[0] * _vol_metadata->Resolution[1] *
+                                                   _vol_metadata->Resolution[2]);
+                                float current_data = data[index];
+                                value += current_data;
+                                min_data = std::min(min_data, current_data);
+                                max_data = std::max(max_data, current_data);
+
+                                num_samples++;
+                            }
                         }
                     }
                 }
+                if (value != 0)
+                    value /= num_samples;
+                if (average) {
+                    samples->samples[j] = value;
+                } else {
+                    samples->samples[j] = max_data;
+                }
+                min_value = std::min(min_value, value);
+                max_value = std::max(max_value, value);
+                avg_value += value;
             }
-            if (value != 0)
-                value /= num_samples;
-            if (this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0) {
-                samples->samples[j] = value;
+            if (avg_value != 0)
+                avg_value /= samples_per_probe;
+            if (!std::isfinite(avg_value)) {
+                non_finite = true;
+            }
+            if (average) {
+                samples->average_value = avg_value;
+                samples->max_value = max_value;
+                samples->min_value = min_value;
             } else {
-                samples->samples[j] = max_data;
+                samples->average_value = max_data;
+                samples->max_value = max_data;
+                samples->min_value = max_data;
             }
-            min_value = std::min(min_value, value);
-            max_value = std::max(max_value, value);
-            avg_value += value;
-        }
-        if (avg_value != 0)
-            avg_value /= samples_per_probe;
-        if (!std::isfinite(avg_value)) {
-            core::utility::log::Log::DefaultLog.WriteError("[SampleAlongProbes] Non-finite value in sampled.");
-        }
-        if (this->_weighting.Param<megamol::core::param::EnumParam>()->Value() == 0) {
-            samples->average_value = avg_value;
-            samples->max_value = max_value;
-            samples->min_value = min_value;
-        } else {
-            samples->average_value = max_data;
-            samples->max_value = max_data;
-            samples->min_value = max_data;
-        }
-        global_min = std::min(global_min, samples->min_value);
-        global_max = std::max(global_max, samples->max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+            thread_min = std::min(thread_min, samples->min_value);
+            thread_max = std::max(thread_max, samples->max_value);
+        } // end for probes
+
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    if (non_finite) {
+        core::utility::log::Log::DefaultLog.WriteError("[SampleAlongProbes] Non-finite value in sampled.");
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
 }
 
 template<typename T>
 void SampleAlongPobes::SampleAlongPobes::doVolumeTrilinSampling(T* data) {
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
-    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
     glm::vec3 origin = {_vol_metadata->Origin[0], _vol_metadata->Origin[1], _vol_metadata->Origin[2]};
     glm::vec3 spacing = {*_vol_metadata->SliceDists[0], *_vol_metadata->SliceDists[1], *_vol_metadata->SliceDists[2]};
-    float min_spacing = std::min(std::min(spacing.x, spacing.y), spacing.z);
+    const glm::vec3 max_grid = {static_cast<float>(_vol_metadata->Resolution[0] - 1),
+        static_cast<float>(_vol_metadata->Resolution[1] - 1), static_cast<float>(_vol_metadata->Resolution[2] - 1)};
+    const size_t res_y = _vol_metadata->Resolution[1];
+    const size_t res_z = _vol_metadata->Resolution[2];
+
+    auto const voxel = [data, res_y, res_z](size_t x, size_t y, size_t z) -> float {
+        return static_cast<float>(data[z + res_y * (y + res_z * x)]);
+    };
+
+    ProbeGeometry geometry;
+    std::vector<std::shared_ptr<FloatProbe::SamplingResult>> results;
+    prepareProbes<FloatProbe>(samples_per_probe, 0.5f, false, geometry, results);
+
+    std::atomic<float> global_min(std::numeric_limits<float>::max());
+    std::atomic<float> global_max(-std::numeric_limits<float>::max());
+    std::atomic<bool> non_finite(false);
+#pragma omp parallel
+    {
+        float thread_min = std::numeric_limits<float>::max();
+        float thread_max = -std::numeric_limits<float>::max();
 
-    float global_min = std::numeric_limits<float>::max();
-    float global_max = -std::numeric_limits<float>::max();
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
+#pragma omp for schedule(dynamic, 64)
+        for (int32_t i = 0; i < static_cast<int32_t>(results.size()); i++) {
+            auto const& samples = results[i];
+            if (samples == nullptr)
+                continue;
 
-        FloatProbe probe;
+            auto sample_step = geometry.end[i] / static_cast<float>(samples_per_probe);
 
-        auto visitor = [&probe, i, samples_per_probe, sample_radius_factor, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::Vec4Probe>) {
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = -std::numeric_limits<float>::max();
+            float avg_value = 0.0f;
 
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-                probe.m_cluster_id = arg.m_cluster_id;
+            for (int j = 0; j < samples_per_probe; j++) {
 
-                auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-                auto radius = 0.5 * sample_step * sample_radius_factor;
-                probe.m_sample_radius = radius;
+                // sample in grid coordinates, clamped to the volume
+                glm::vec3 grid_point = (geometry.samplePoint(i, j * sample_step) - origin) / spacing;
+                grid_point = glm::clamp(grid_point, glm::vec3(0.0f), max_grid);
 
-                _probes->setProbe(i, probe);
+                glm::vec3 const lower = glm::floor(grid_point);
+                glm::vec3 const upper = glm::min(lower + 1.0f, max_grid);
+                glm::vec3 const d = grid_point - lower;
 
-            } else if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                probe = arg;
+                auto const x0 = static_cast<size_t>(lower.x), x1 = static_cast<size_t>(upper.x);
+                auto const y0 = static_cast<size_t>(lower.y), y1 = static_cast<size_t>(upper.y);
+                auto const z0 = static_cast<size_t>(lower.z), z1 = static_cast<size_t>(upper.z);
 
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
+                auto c00 = voxel(x0, y0, z0) * (1 - d.x) + voxel(x1, y0, z0) * d.x;
+                auto c01 = voxel(x0, y0, z1) * (1 - d.x) + voxel(x1, y0, z1) * d.x;
+                auto c10 = voxel(x0, y1, z0) * (1 - d.x) + voxel(x1, y1, z0) * d.x;
+                auto c11 = voxel(x0, y1, z1) * (1 - d.x) + voxel(x1, y1, z1) * d.x;
+
+                auto c0 = c00 * (1 - d.y) + c10 * d.y;
+                auto c1 = c01 * (1 - d.y) + c11 * d.y;
+
+                auto value = c0 * (1 - d.z) + c1 * d.z;
+                samples->samples[j] = value;
+
+                min_value = std::min(min_value, value);
+                max_value = std::max(max_value, value);
+                avg_value += value;
+            }
+            if (avg_value != 0)
+                avg_value /= samples_per_probe;
+            if (!std::isfinite(avg_value)) {
+                non_finite = true;
             }
-        };
 
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-
-        std::shared_ptr<FloatProbe::SamplingResult> samples = probe.getSamplingResult();
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = -std::numeric_limits<float>::max();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
-
-
-        for (int j = 0; j < samples_per_probe; j++) {
-
-            glm::vec3 sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
-
-            auto xd = sample_point.x -
-                      std::floorf(sample_point.x) / (std::ceilf(sample_point.x) - std::floorf(sample_point.x));
-            auto yd = sample_point.y -
-                      std::floorf(sample_point.y) / (std::ceilf(sample_point.y) - std::floorf(sample_point.y));
-            auto zd = sample_point.z -
-                      std::floorf(sample_point.z) / (std::ceilf(sample_point.z) - std::floorf(sample_point.z));
-
-            auto c000 = data[static_cast<size_t>(std::floor(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::floor(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::floor(sample_point.x)))];
-            auto c001 = data[static_cast<size_t>(std::ceil(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::floor(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::floor(sample_point.x)))];
-            auto c010 = data[static_cast<size_t>(std::floor(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::ceil(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::floor(sample_point.x)))];
-            auto c011 = data[static_cast<size_t>(std::ceil(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::ceil(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::floor(sample_point.x)))];
-            auto c100 = data[static_cast<size_t>(std::floor(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::floor(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::ceil(sample_point.x)))];
-            auto c101 = data[static_cast<size_t>(std::ceil(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::floor(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::ceil(sample_point.x)))];
-            auto c110 = data[static_cast<size_t>(std::floor(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::ceil(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::ceil(sample_point.x)))];
-            auto c111 = data[static_cast<size_t>(std::ceil(sample_point.z)) +
-                             _vol_metadata->Resolution[1] *
-                                 (static_cast<size_t>(std::ceil(sample_point.y)) +
-                                     _vol_metadata->Resolution[2] * static_cast<size_t>(std::ceil(sample_point.x)))];
-
-            auto c00 = c000 * (1 - xd) + c100 * xd;
-            auto c01 = c001 * (1 - xd) + c101 * xd;
-            auto c10 = c010 * (1 - xd) + c110 * xd;
-            auto c11 = c011 * (1 - xd) + c111 * xd;
-
-            auto c0 = c00 * (1 - yd) + c10 * yd;
-            auto c1 = c01 * (1 - yd) + c11 * yd;
-
-            auto value = c0 * (1 - zd) + c1 * zd;
-            samples->samples[j] = value;
-
-            min_value = std::min(min_value, value);
-            max_value = std::max(max_value, value);
-            avg_value += value;
-        }
-        if (avg_value != 0)
-            avg_value /= samples_per_probe;
-        if (!std::isfinite(avg_value)) {
-            core::utility::log::Log::DefaultLog.WriteError("[SampleAlongProbes] Non-finite value in sampled.");
-        }
+            samples->average_value = avg_value;
+            samples->max_value = max_value;
+            samples->min_value = min_value;
 
-        samples->average_value = avg_value;
-        samples->max_value = max_value;
-        samples->min_value = min_value;
+            thread_min = std::min(thread_min, samples->min_value);
+            thread_max = std::max(thread_max, samples->max_value);
+        } // end for probes
 
-        global_min = std::min(global_min, samples->min_value);
-        global_max = std::max(global_max, samples->max_value);
-    } // end for probes
-    _probes->setGlobalMinMax(global_min, global_max);
+        atomicMin(global_min, thread_min);
+        atomicMax(global_max, thread_max);
+    }
+    if (non_finite) {
+        core::utility::log::Log::DefaultLog.WriteError("[SampleAlongProbes] Non-finite value in sampled.");
+    }
+    _probes->setGlobalMinMax(global_min.load(), global_max.load());
 }
 
 
@@ -7,8 +7,12 @@
 #include "SurfaceNets.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "geometry_calls/VolumetricDataCall.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
+#include <algorithm>
+#include <limits>
+#include <omp.h>
 
 namespace megamol {
 namespace probe {
@@ -20,7 +24,8 @@ SurfaceNets::SurfaceNets()
         , _deployMeshCall("deployMesh", "")
         , _deployNormalsCall("deployNormals", "")
         , _isoSlot("IsoValue", "")
-        , _faceTypeSlot("FaceType", "") {
+        , _faceTypeSlot("FaceType", "")
+        , _skipBricksSlot("SkipEmptyBricks", "Skips bricks of cells whose value range does not contain the iso value") {
 
     this->_isoSlot << new core::param::FloatParam(1.0f);
     this->_isoSlot.SetUpdateCallback(&SurfaceNets::isoChanged);
@@ -32,6 +37,9 @@ SurfaceNets::SurfaceNets()
     this->_faceTypeSlot << ep;
     this->MakeSlotAvailable(&this->_faceTypeSlot);
 
+    this->_skipBricksSlot << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->_skipBricksSlot);
+
     this->_deployMeshCall.SetCallback(
         mesh::CallMesh::ClassName(), mesh::CallMesh::FunctionName(0), &SurfaceNets::getData);
     this->_deployMeshCall.SetCallback(
@@ -63,6 +71,74 @@ bool SurfaceNets::InterfaceIsDirty() {
 }
 
 
+namespace {
+
+/** The surface cells of one layer of cells, in scan order */
+struct CellLayer {
+    // x + y * dims[0] of each cell
+    std::vector<uint32_t> cells;
+    // crossings of the edges 0, 1 and 2 of each cell, which own the faces
+    std::vector<uint8_t> crossings;
+    std::vector<std::array<float, 4>> vertices;
+    std::vector<std::array<float, 3>> normals;
+    std::array<float, 3> lower;
+    std::array<float, 3> upper;
+
+    CellLayer() {
+        lower.fill(std::numeric_limits<float>::max());
+        upper.fill(std::numeric_limits<float>::lowest());
+    }
+};
+
+} // namespace
+
+
+void SurfaceNets::calculateBricks() {
+    for (int i = 0; i < 3; ++i) {
+        _brick_dims[i] = (_dims[i] - 1 + _brick_size - 1) / _brick_size;
+    }
+    auto const brick_cnt = static_cast<size_t>(_brick_dims[0]) * _brick_dims[1] * _brick_dims[2];
+    _brick_min.resize(brick_cnt);
+    _brick_max.resize(brick_cnt);
+
+    auto const dims = _dims;
+    auto const brick_dims = _brick_dims;
+#pragma omp parallel for schedule(dynamic)
+    for (long long b = 0; b < static_cast<long long>(brick_cnt); ++b) {
+        std::array<uint32_t, 3> first;
+        first[0] = static_cast<uint32_t>(b % brick_dims[0]) * _brick_size;
+        first[1] = static_cast<uint32_t>((b / brick_dims[0]) % brick_dims[1]) * _brick_size;
+        first[2] = static_cast<uint32_t>(b / (static_cast<long long>(brick_dims[0]) * brick_dims[1])) * _brick_size;
+        // the samples of the cells of the brick, including their upper corners
+        std::array<uint32_t, 3> last;
+        for (int i = 0; i < 3; ++i) {
+            last[i] = std::min(first[i] + _brick_size, dims[i] - 1);
+        }
+        float lo = std::numeric_limits<float>::infinity();
+        float hi = -std::numeric_limits<float>::infinity();
+        for (uint32_t z = first[2]; z <= last[2]; ++z) {
+            for (uint32_t y = first[1]; y <= last[1]; ++y) {
+                float const* row =
+                    _data + (static_cast<size_t>(dims[0]) * dims[1] * z + static_cast<size_t>(dims[0]) * y);
+                for (uint32_t x = first[0]; x <= last[0]; ++x) {
+                    float const v = row[x];
+                    if (v != v) {
+                        // NaN is never above the iso value
+                        lo = -std::numeric_limits<float>::infinity();
+                        continue;
+                    }
+                    lo = std::min(lo, v);
+                    hi = std::max(hi, v);
+                }
+            }
+        }
+        _brick_min[b] = lo;
+        _brick_max[b] = hi;
+    }
+    _bricks_valid = true;
+}
+
+
 void SurfaceNets::calculateSurfaceNets() {
 
     _bboxs.Clear();
@@ -72,6 +148,9 @@ void SurfaceNets::calculateSurfaceNets() {
     _faces.clear();
     _triangles.clear();
 
+    if (_dims[0] < 2 || _dims[1] < 2 || _dims[2] < 2)
+        return;
+
     std::array<std::array<uint32_t, 3>, 8> cube_offsets;
     cube_offsets[0] = {0, 0, 0};
     cube_offsets[1] = {1, 0, 0};
@@ -109,231 +188,299 @@ void SurfaceNets::calculateSurfaceNets() {
 
     float const iso_value = this->_isoSlot.Param<core::param::FloatParam>()->Value();
 
-    std::vector<uint32_t> voxel_lookup(_dims[0] * _dims[1] * _dims[2]);
-    std::vector<uint32_t> voxel_filled;
-    voxel_filled.reserve(voxel_lookup.size());
-
-    std::vector<uint32_t> voxel_edge_crossings(_dims[0] * _dims[1] * _dims[2]);
+    bool const skip_bricks = this->_skipBricksSlot.Param<core::param::BoolParam>()->Value();
+    if (skip_bricks && !_bricks_valid) {
+        this->calculateBricks();
+    }
 
     auto dims = _dims;
 
-    auto const offset_now = [dims](
-                                uint32_t x, uint32_t y, uint32_t z) { return dims[0] * dims[1] * z + dims[0] * y + x; };
+    auto const offset_now = [dims](uint32_t x, uint32_t y, uint32_t z) {
+        return static_cast<size_t>(dims[0]) * dims[1] * z + static_cast<size_t>(dims[0]) * y + x;
+    };
+
+    auto const process_cell = [&](uint32_t x, uint32_t y, uint32_t z, CellLayer& layer) {
+        std::array<float, 8> sample_value;
+        uint32_t above = 0;
+        for (int c = 0; c < 8; ++c) {
+            auto const& corner = cube_offsets[c];
+            sample_value[c] = _data[offset_now(x + corner[0], y + corner[1], z + corner[2])];
+            above |= uint32_t(sample_value[c] > iso_value) << c;
+        }
+        // no edge crosses the iso value if all corners are on the same side
+        if (above == 0 || above == 0xFF)
+            return;
+
+        uint32_t edge_crossings = 0;
+
+        std::array<float, 3> center_of_mass = {0.0f, 0.0f, 0.0f};
+        float normalization = 0.0f;
+
+        // Compute edge crossings and center of mass
+        for (int i = 0; i < 12; ++i) {
+            uint32_t const idx_0 = edge_vertex_offsets[i * 2 + 0];
+            uint32_t const idx_1 = edge_vertex_offsets[i * 2 + 1];
+
+            auto const v_0 = sample_value[idx_0];
+            auto const v_1 = sample_value[idx_1];
+
+            auto edge_crossing = uint32_t(!((v_0 > iso_value) == (v_1 > iso_value)));
+            edge_crossings |= (edge_crossing << i);
+
+
+            if (edge_crossing == 1) {
+
+                float d = ((iso_value - v_0) / (v_1 - v_0));
+                std::array<float, 3> mix;
+                mix[0] = static_cast<float>(cube_offsets[idx_0][0]) * (1.0f - d) +
+                         static_cast<float>(cube_offsets[idx_1][0]) * d;
+                mix[1] = static_cast<float>(cube_offsets[idx_0][1]) * (1.0f - d) +
+                         static_cast<float>(cube_offsets[idx_1][1]) * d;
+                mix[2] = static_cast<float>(cube_offsets[idx_0][2]) * (1.0f - d) +
+                         static_cast<float>(cube_offsets[idx_1][2]) * d;
+                std::array<float, 3> intersect_pos;
+                intersect_pos[0] = static_cast<float>(x) + mix[0];
+                intersect_pos[1] = static_cast<float>(y) + mix[1];
+                intersect_pos[2] = static_cast<float>(z) + mix[2];
+                center_of_mass[0] += intersect_pos[0];
+                center_of_mass[1] += intersect_pos[1];
+                center_of_mass[2] += intersect_pos[2];
+                normalization += 1.0f;
+            }
+        } // for i < 12
+
+        if (normalization > 0.0f) {
+
+            center_of_mass[0] /= normalization;
+            center_of_mass[1] /= normalization;
+            center_of_mass[2] /= normalization;
+
+            std::array<float, 4> position;
+            position[0] = ((center_of_mass[0] / _dims[0]) * _dims[0] * _spacing[0]) + _volume_origin[0];
+            position[1] = ((center_of_mass[1] / _dims[1]) * _dims[1] * _spacing[1]) + _volume_origin[1];
+            position[2] = ((center_of_mass[2] / _dims[2]) * _dims[2] * _spacing[2]) + _volume_origin[2];
+            position[3] = 1.0f;
+            layer.vertices.push_back(position);
+            for (int i = 0; i < 3; ++i) {
+                layer.lower[i] = std::min(layer.lower[i], position[i]);
+                layer.upper[i] = std::max(layer.upper[i], position[i]);
+            }
+
+            layer.cells.push_back(x + dims[0] * y);
+            layer.crossings.push_back(static_cast<uint8_t>(edge_crossings & 0x7));
+
+            std::array<float, 3> normal;
+            normal[0] =
+                _data[offset_now(x >= _dims[0] - 1 ? x : x + 1, y, z)] - _data[offset_now(x < 1 ? x : x - 1, y, z)];
+            normal[1] =
+                _data[offset_now(x, y >= _dims[1] - 1 ? y : y + 1, z)] - _data[offset_now(x, y < 1 ? y : y - 1, z)];
+            normal[2] =
+                _data[offset_now(x, y, z >= _dims[2] - 1 ? z : z + 1)] - _data[offset_now(x, y, z < 1 ? z : z - 1)];
+            if (normal[0] <= 1e-6 && normal[1] <= 1e-6 && normal[2] <= 1e-6) {
+                normal[0] = _data[offset_now(x >= _dims[0] - 2 ? x : x + 2, y, z)] -
+                            _data[offset_now(x < 2 ? x : x - 2, y, z)];
+                normal[1] = _data[offset_now(x, y >= _dims[1] - 2 ? y : y + 2, z)] -
+                            _data[offset_now(x, y < 2 ? y : y - 2, z)];
+                normal[2] = _data[offset_now(x, y, z >= _dims[2] - 2 ? z : z + 2)] -
+                            _data[offset_now(x, y, z < 2 ? z : z - 2)];
+            }
+            auto const normal_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            normal[0] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+            normal[1] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+            normal[2] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+            layer.normals.push_back(normal);
+        }
+    };
 
-    for (uint32_t z = 0; z < _dims[2] - 1; z++) {
+    // extract the vertices of each layer of cells independently, in scan order
+    uint32_t const layer_cnt = _dims[2] - 1;
+    std::vector<CellLayer> layers(layer_cnt);
+#pragma omp parallel for schedule(dynamic)
+    for (long long lz = 0; lz < static_cast<long long>(layer_cnt); ++lz) {
+        auto const z = static_cast<uint32_t>(lz);
+        auto& layer = layers[z];
         for (uint32_t y = 0; y < _dims[1] - 1; y++) {
-            for (uint32_t x = 0; x < _dims[0] - 1; x++) {
-
-                std::array<float, 8> sample_value;
-                sample_value[0] =
-                    _data[offset_now(x + cube_offsets[0][0], y + cube_offsets[0][1], z + cube_offsets[0][2])];
-                sample_value[1] =
-                    _data[offset_now(x + cube_offsets[1][0], y + cube_offsets[1][1], z + cube_offsets[1][2])];
-                sample_value[2] =
-                    _data[offset_now(x + cube_offsets[2][0], y + cube_offsets[2][1], z + cube_offsets[2][2])];
-                sample_value[3] =
-                    _data[offset_now(x + cube_offsets[3][0], y + cube_offsets[3][1], z + cube_offsets[3][2])];
-                sample_value[4] =
-                    _data[offset_now(x + cube_offsets[4][0], y + cube_offsets[4][1], z + cube_offsets[4][2])];
-                sample_value[5] =
-                    _data[offset_now(x + cube_offsets[5][0], y + cube_offsets[5][1], z + cube_offsets[5][2])];
-                sample_value[6] =
-                    _data[offset_now(x + cube_offsets[6][0], y + cube_offsets[6][1], z + cube_offsets[6][2])];
-                sample_value[7] =
-                    _data[offset_now(x + cube_offsets[7][0], y + cube_offsets[7][1], z + cube_offsets[7][2])];
-
-                uint32_t edge_crossings = 0;
-
-                std::array<float, 3> center_of_mass = {0.0f, 0.0f, 0.0f};
-                float normalization = 0.0f;
-
-                // Compute edge crossings and center of mass
-                for (int i = 0; i < 12; ++i) {
-                    uint32_t const idx_0 = edge_vertex_offsets[i * 2 + 0];
-                    uint32_t const idx_1 = edge_vertex_offsets[i * 2 + 1];
-
-                    auto const v_0 = sample_value[idx_0];
-                    auto const v_1 = sample_value[idx_1];
-
-                    auto edge_crossing = uint32_t(!((v_0 > iso_value) == (v_1 > iso_value)));
-                    edge_crossings |= (edge_crossing << i);
-
-
-                    if (edge_crossing == 1) {
-
-                        float d = ((iso_value - v_0) / (v_1 - v_0));
-                        std::array<float, 3> mix;
-                        mix[0] = static_cast<float>(cube_offsets[idx_0][0]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][0]) * d;
-                        mix[1] = static_cast<float>(cube_offsets[idx_0][1]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][1]) * d;
-                        mix[2] = static_cast<float>(cube_offsets[idx_0][2]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][2]) * d;
-                        std::array<float, 3> intersect_pos;
-                        intersect_pos[0] = static_cast<float>(x) + mix[0];
-                        intersect_pos[1] = static_cast<float>(y) + mix[1];
-                        intersect_pos[2] = static_cast<float>(z) + mix[2];
-                        center_of_mass[0] += intersect_pos[0];
-                        center_of_mass[1] += intersect_pos[1];
-                        center_of_mass[2] += intersect_pos[2];
-                        normalization += 1.0f;
-                    }
-                } // for i < 12
-
-                voxel_edge_crossings[offset_now(x, y, z)] = edge_crossings;
-
-                if (normalization > 0.0f) {
-
-                    center_of_mass[0] /= normalization;
-                    center_of_mass[1] /= normalization;
-                    center_of_mass[2] /= normalization;
-
-                    std::array<float, 4> position;
-                    position[0] = ((center_of_mass[0] / _dims[0]) * _dims[0] * _spacing[0]) + _volume_origin[0];
-                    position[1] = ((center_of_mass[1] / _dims[1]) * _dims[1] * _spacing[1]) + _volume_origin[1];
-                    position[2] = ((center_of_mass[2] / _dims[2]) * _dims[2] * _spacing[2]) + _volume_origin[2];
-                    position[3] = 1.0f;
-                    _vertices.push_back(position);
-
-                    float eps = 0.005;
-                    vislib::math::Cuboid<float> point_box(position[0] - eps, position[1] - eps, position[2] - eps,
-                        position[0] + eps, position[1] + eps, position[2] + eps);
-
-                    auto bbox = _bboxs.BoundingBox();
-                    auto cbox = _bboxs.ClipBox();
-                    bbox.Union(point_box);
-                    cbox.Union(point_box);
-                    _bboxs.SetBoundingBox(bbox);
-                    _bboxs.SetClipBox(cbox);
-
-                    voxel_lookup[offset_now(x, y, z)] = _vertices.size() - 1;
-                    voxel_filled.push_back(offset_now(x, y, z));
-
-                    std::array<float, 3> normal;
-                    normal[0] = _data[offset_now(x >= _dims[0] - 1 ? x : x + 1, y, z)] -
-                                _data[offset_now(x < 1 ? x : x - 1, y, z)];
-                    normal[1] = _data[offset_now(x, y >= _dims[1] - 1 ? y : y + 1, z)] -
-                                _data[offset_now(x, y < 1 ? y : y - 1, z)];
-                    normal[2] = _data[offset_now(x, y, z >= _dims[2] - 1 ? z : z + 1)] -
-                                _data[offset_now(x, y, z < 1 ? z : z - 1)];
-                    if (normal[0] <= 1e-6 && normal[1] <= 1e-6 && normal[2] <= 1e-6) {
-                        normal[0] = _data[offset_now(x >= _dims[0] - 2 ? x : x + 2, y, z)] -
-                                    _data[offset_now(x < 2 ? x : x - 2, y, z)];
-                        normal[1] = _data[offset_now(x, y >= _dims[1] - 2 ? y : y + 2, z)] -
-                                    _data[offset_now(x, y < 2 ? y : y - 2, z)];
-                        normal[2] = _data[offset_now(x, y, z >= _dims[2] - 2 ? z : z + 2)] -
-                                    _data[offset_now(x, y, z < 2 ? z : z - 2)];
-                    }
-                    auto const normal_length =
-                        std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-                    normal[0] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    normal[1] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    normal[2] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    _normals.push_back(normal);
+            if (!skip_bricks) {
+                for (uint32_t x = 0; x < _dims[0] - 1; x++) {
+                    process_cell(x, y, z, layer);
                 }
-            } // for x
-        }     // for y
-    }         // for z
-    voxel_filled.shrink_to_fit();
-
-    auto const coordinateFromLinearIndex = [](uint32_t idx, uint32_t max_x, uint32_t max_y) {
-        std::array<uint32_t, 3> coords;
-        coords[0] = idx % (max_x);
-        idx /= (max_x);
-        coords[1] = idx % (max_y);
-        idx /= (max_y);
-        coords[2] = idx;
-        return coords;
-    };
+                continue;
+            }
+            size_t const brick_row =
+                (static_cast<size_t>(z / _brick_size) * _brick_dims[1] + y / _brick_size) * _brick_dims[0];
+            for (uint32_t bx = 0; bx < _brick_dims[0]; ++bx) {
+                if (!(_brick_min[brick_row + bx] <= iso_value && _brick_max[brick_row + bx] > iso_value))
+                    continue;
+                uint32_t const x_end = std::min(bx * _brick_size + _brick_size, _dims[0] - 1);
+                for (uint32_t x = bx * _brick_size; x < x_end; x++) {
+                    process_cell(x, y, z, layer);
+                }
+            }
+        } // for y
+    }     // for z
 
+    // the vertices of a layer follow those of the layers before
+    std::vector<uint32_t> layer_base(layer_cnt + 1, 0);
+    for (uint32_t z = 0; z < layer_cnt; ++z) {
+        layer_base[z + 1] = layer_base[z] + static_cast<uint32_t>(layers[z].vertices.size());
+    }
+    _vertices.resize(layer_base[layer_cnt]);
+    _normals.resize(layer_base[layer_cnt]);
+#pragma omp parallel for schedule(dynamic)
+    for (long long lz = 0; lz < static_cast<long long>(layer_cnt); ++lz) {
+        auto const& layer = layers[lz];
+        std::copy(layer.vertices.begin(), layer.vertices.end(), _vertices.begin() + layer_base[lz]);
+        std::copy(layer.normals.begin(), layer.normals.end(), _normals.begin() + layer_base[lz]);
+    }
 
-    for (auto id : voxel_filled) {
-        for (uint32_t i = 0; i < 3; ++i) {
-            auto const edge_crossing = 1 & (voxel_edge_crossings[id] >> i);
-            if (edge_crossing == 1) {
-                auto coords = coordinateFromLinearIndex(id, _dims[0], _dims[1]);
-                if (coords[0] > 0 && coords[1] > 0 && coords[2] > 0) {
-                    std::array<uint32_t, 4> indices;
-                    std::array<uint32_t, 3> triangle1;
-                    std::array<uint32_t, 3> triangle2;
-                    if (i == 0) {
-                        indices[0] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2] - 1)];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
-                        indices[3] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])]; // or just id
-                    } else if (i == 1) {
-                        indices[0] = voxel_lookup[offset_now(coords[0] - 1, coords[1] - 1, coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
-                        indices[3] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
-                    } else if (i == 2) {
-                        indices[0] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
-                        indices[3] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2] - 1)];
+    if (!_vertices.empty()) {
+        std::array<float, 3> lower = layers[0].lower;
+        std::array<float, 3> upper = layers[0].upper;
+        for (auto const& layer : layers) {
+            for (int i = 0; i < 3; ++i) {
+                lower[i] = std::min(lower[i], layer.lower[i]);
+                upper[i] = std::max(upper[i], layer.upper[i]);
+            }
+        }
+        float eps = 0.005;
+        vislib::math::Cuboid<float> point_box(
+            lower[0] - eps, lower[1] - eps, lower[2] - eps, upper[0] + eps, upper[1] + eps, upper[2] + eps);
+
+        auto bbox = _bboxs.BoundingBox();
+        auto cbox = _bboxs.ClipBox();
+        bbox.Union(point_box);
+        cbox.Union(point_box);
+        _bboxs.SetBoundingBox(bbox);
+        _bboxs.SetClipBox(cbox);
+    }
+
+    // connect the vertices of the cells around each crossed edge, slab by slab, looking up the vertex index of a
+    // cell in the dense index maps of the current and the previous layer
+    auto const layer_size = static_cast<size_t>(_dims[0]) * _dims[1];
+    int const slab_cnt = std::max(1, std::min(static_cast<int>(layer_cnt), 2 * omp_get_max_threads()));
+    std::vector<std::vector<std::array<uint32_t, 4>>> slab_faces(slab_cnt);
+#pragma omp parallel for schedule(dynamic)
+    for (int s = 0; s < slab_cnt; ++s) {
+        uint32_t const z_begin = static_cast<uint32_t>(static_cast<uint64_t>(layer_cnt) * s / slab_cnt);
+        uint32_t const z_end = static_cast<uint32_t>(static_cast<uint64_t>(layer_cnt) * (s + 1) / slab_cnt);
+        auto& faces = slab_faces[s];
+
+        std::vector<uint32_t> prev_lookup(layer_size, 0);
+        std::vector<uint32_t> lookup(layer_size, 0);
+        auto const fill = [&](std::vector<uint32_t>& map, uint32_t z, bool set) {
+            auto const& cells = layers[z].cells;
+            for (size_t k = 0; k < cells.size(); ++k) {
+                map[cells[k]] = set ? layer_base[z] + static_cast<uint32_t>(k) : 0;
+            }
+        };
+        if (z_begin > 0) {
+            fill(prev_lookup, z_begin - 1, true);
+        }
+
+        for (uint32_t z = z_begin; z < z_end; ++z) {
+            auto const& layer = layers[z];
+            fill(lookup, z, true);
+            if (z > 0) {
+                for (size_t k = 0; k < layer.cells.size(); ++k) {
+                    uint32_t const cell = layer.cells[k];
+                    uint32_t const x = cell % _dims[0];
+                    uint32_t const y = cell / _dims[0];
+                    if (x == 0 || y == 0)
+                        continue;
+                    for (uint32_t i = 0; i < 3; ++i) {
+                        if ((1 & (layer.crossings[k] >> i)) == 0)
+                            continue;
+                        std::array<uint32_t, 4> indices;
+                        if (i == 0) {
+                            indices[0] = lookup[cell - _dims[0]];
+                            indices[1] = prev_lookup[cell - _dims[0]];
+                            indices[2] = prev_lookup[cell];
+                            indices[3] = lookup[cell];
+                        } else if (i == 1) {
+                            indices[0] = lookup[cell - _dims[0] - 1];
+                            indices[1] = lookup[cell - _dims[0]];
+                            indices[2] = lookup[cell];
+                            indices[3] = lookup[cell - 1];
+                        } else {
+                            indices[0] = lookup[cell - 1];
+                            indices[1] = lookup[cell];
+                            indices[2] = prev_lookup[cell];
+                            indices[3] = prev_lookup[cell - 1];
+                        }
+                        faces.emplace_back(indices);
                     }
-                    triangle1[0] = indices[0];
-                    triangle1[1] = indices[1];
-                    triangle1[2] = indices[2];
-                    triangle2[0] = indices[0];
-                    triangle2[1] = indices[2];
-                    triangle2[2] = indices[3];
-
-                    // hack normals
-                    auto tangent = _vertices[indices[2]];
-                    auto bitangent = _vertices[indices[1]];
-
-                    tangent[0] -= _vertices[indices[0]][0];
-                    tangent[1] -= _vertices[indices[0]][1];
-                    tangent[2] -= _vertices[indices[0]][2];
-                    auto t_length =
-                        std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
-                    tangent[0] /= t_length;
-                    tangent[1] /= t_length;
-                    tangent[2] /= t_length;
-
-                    bitangent[0] -= _vertices[indices[0]][0];
-                    bitangent[1] -= _vertices[indices[0]][1];
-                    bitangent[2] -= _vertices[indices[0]][2];
-                    auto bt_length = std::sqrt(
-                        bitangent[0] * bitangent[0] + bitangent[1] * bitangent[1] + bitangent[2] * bitangent[2]);
-                    bitangent[0] /= bt_length;
-                    bitangent[1] /= bt_length;
-                    bitangent[2] /= bt_length;
-
-                    std::array<float, 3> normal;
-                    normal[0] = tangent[1] * bitangent[2] - tangent[2] * bitangent[1];
-                    normal[1] = tangent[2] * bitangent[0] - tangent[0] * bitangent[2];
-                    normal[2] = tangent[0] * bitangent[1] - tangent[1] * bitangent[0];
-                    auto n_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-                    normal[0] /= n_length;
-                    normal[1] /= n_length;
-                    normal[2] /= n_length;
-
-                    auto myDot = [](std::array<float, 3> const& v0, std::array<float, 3> const& v1) -> float {
-                        return (v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2]);
-                    };
-
-                    _normals[indices[0]] = myDot(_normals[indices[0]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-                    _normals[indices[1]] = myDot(_normals[indices[1]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-                    _normals[indices[2]] = myDot(_normals[indices[2]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-                    _normals[indices[3]] = myDot(_normals[indices[3]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-
-                    _faces.emplace_back(indices);
-                    _triangles.emplace_back(triangle1);
-                    _triangles.emplace_back(triangle2);
                 }
+                fill(prev_lookup, z - 1, false);
             }
-        } // for i < 3
-    }     // for voxel_filled
+            std::swap(prev_lookup, lookup);
+        }
+    }
+
+    size_t face_cnt = 0;
+    for (auto const& faces : slab_faces) {
+        face_cnt += faces.size();
+    }
+    _faces.reserve(face_cnt);
+    _triangles.reserve(2 * face_cnt);
+    for (auto& faces : slab_faces) {
+        _faces.insert(_faces.end(), faces.begin(), faces.end());
+        faces = std::vector<std::array<uint32_t, 4>>();
+    }
+
+    auto myDot = [](std::array<float, 3> const& v0, std::array<float, 3> const& v1) -> float {
+        return (v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2]);
+    };
+
+    // orienting the vertex normals along the faces depends on the face order, hence this stays sequential
+    for (auto const& indices : _faces) {
+        std::array<uint32_t, 3> triangle1;
+        std::array<uint32_t, 3> triangle2;
+        triangle1[0] = indices[0];
+        triangle1[1] = indices[1];
+        triangle1[2] = indices[2];
+        triangle2[0] = indices[0];
+        triangle2[1] = indices[2];
+        triangle2[2] = indices[3];
+
+        // hack normals
+        auto tangent = _vertices[indices[2]];
+        auto bitangent = _vertices[indices[1]];
+
+        tangent[0] -= _vertices[indices[0]][0];
+        tangent[1] -= _vertices[indices[0]][1];
+        tangent[2] -= _vertices[indices[0]][2];
+        auto t_length = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+        tangent[0] /= t_length;
+        tangent[1] /= t_length;
+        tangent[2] /= t_length;
+
+        bitangent[0] -= _vertices[indices[0]][0];
+        bitangent[1] -= _vertices[indices[0]][1];
+        bitangent[2] -= _vertices[indices[0]][2];
+        auto bt_length =
+            std::sqrt(bitangent[0] * bitangent[0] + bitangent[1] * bitangent[1] + bitangent[2] * bitangent[2]);
+        bitangent[0] /= bt_length;
+        bitangent[1] /= bt_length;
+        bitangent[2] /= bt_length;
+
+        std::array<float, 3> normal;
+        normal[0] = tangent[1] * bitangent[2] - tangent[2] * bitangent[1];
+        normal[1] = tangent[2] * bitangent[0] - tangent[0] * bitangent[2];
+        normal[2] = tangent[0] * bitangent[1] - tangent[1] * bitangent[0];
+        auto n_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        normal[0] /= n_length;
+        normal[1] /= n_length;
+        normal[2] /= n_length;
+
+        for (int c = 0; c < 4; ++c) {
+            _normals[indices[c]] = myDot(_normals[indices[c]], normal) > 0.0
+                                       ? normal
+                                       : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
+        }
+
+        _triangles.emplace_back(triangle1);
+        _triangles.emplace_back(triangle2);
+    } // for faces
 }
 
 bool SurfaceNets::getData(core::Call& call) {
@@ -358,6 +505,7 @@ bool SurfaceNets::getData(core::Call& call) {
     // get data from volumetric call
     if (cd->DataHash() != _old_datahash) {
         something_changed = true;
+        _bricks_valid = false;
         auto mesh_meta_data = cm->getMetaData();
         //mesh_meta_data.m_bboxs = cd->AccessBoundingBoxes();
         mesh_meta_data.m_frame_cnt = cd->GetAvailableFrames();
@@ -377,6 +525,7 @@ bool SurfaceNets::getData(core::Call& call) {
         if (cd->GetScalarType() == geocalls::FLOATING_POINT) {
             _data = static_cast<float*>(cd->GetData());
         } else if (cd->GetScalarType() == geocalls::UNSIGNED_INTEGER) {
+            _converted_data.clear();
             _converted_data.reserve(_dims[0] * _dims[1] * _dims[2]);
             auto c_data = static_cast<unsigned char*>(cd->GetData());
             for (uint32_t z = 0; z < _dims[2]; ++z) {
@@ -504,6 +653,7 @@ bool SurfaceNets::getNormalData(core::Call& call) {
 
     if (cd->DataHash() != _old_datahash) {
         something_changed = true;
+        _bricks_valid = false;
     }
 
     _dims[0] = cd->GetResolution(0);
@@ -64,6 +64,7 @@ protected:
 
     core::param::ParamSlot _isoSlot;
     core::param::ParamSlot _faceTypeSlot;
+    core::param::ParamSlot _skipBricksSlot;
 
 
 private:
@@ -71,6 +72,9 @@ private:
 
     void calculateSurfaceNets();
 
+    /** Computes the value range of each brick of cells, which only depends on the volume, not on the iso value. */
+    void calculateBricks();
+
     bool getMetaData(core::Call& call);
     bool getData(core::Call& call);
 
@@ -95,6 +99,13 @@ private:
     std::vector<float> _converted_data;
     float* _data;
 
+    // value range of bricks of _brick_size^3 cells, a brick without cells crossing the iso value is skipped
+    static constexpr uint32_t _brick_size = 8;
+    std::array<uint32_t, 3> _brick_dims;
+    std::vector<float> _brick_min;
+    std::vector<float> _brick_max;
+    bool _bricks_valid = false;
+
     // store surface
     std::vector<std::array<float, 4>> _vertices;
     std::vector<std::array<float, 3>> _normals;
@@ -6,12 +6,14 @@
  * Alle Rechte vorbehalten.
  */
 #include "SolventCounter.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/utility/log/Log.h"
 #include "protein_calls/PerAtomFloatCall.h"
 #include "vislib/assert.h"
 #include <cfloat>
 #include <climits>
+#include <future>
 #include <omp.h>
 
 
@@ -30,9 +32,13 @@ SolventCounter::SolventCounter()
         , molDataSlot("moldata", "The slot requesting molecular data")
         , solDataSlot("soldata", "The slot requesting solvent data")
         , radiusParam("radius", "The search radius for solvent molecules")
+        , incrementalParam("incremental", "Only process frames not seen yet instead of recomputing all frames")
+        , processedFrameCount(0)
+        , countRadius(0.0f)
         , minValue(0.0f)
         , midValue(0.0f)
-        , maxValue(0.0f) {
+        , maxValue(0.0f)
+        , datahash(0) {
     // the data out slot
     this->getDataSlot.SetCallback(PerAtomFloatCall::ClassName(),
         PerAtomFloatCall::FunctionName(PerAtomFloatCall::CallForGetFloat), &SolventCounter::getDataCallback);
@@ -47,6 +53,9 @@ SolventCounter::SolventCounter()
     // Radius parameter
     this->radiusParam.SetParameter(new param::FloatParam(3.0f, 0.1f));
     this->MakeSlotAvailable(&this->radiusParam);
+
+    this->incrementalParam.SetParameter(new param::BoolParam(true));
+    this->MakeSlotAvailable(&this->incrementalParam);
 }
 
 
@@ -71,7 +80,64 @@ bool SolventCounter::create() {
  * SolventCounter::release
  */
 void SolventCounter::release() {
-    // TODO clear data
+    this->solvent.Clear();
+    this->hitCount.clear();
+    this->frameProcessed.clear();
+    this->processedFrameCount = 0;
+}
+
+
+/*
+ * SolventCounter::loadFrame
+ */
+bool SolventCounter::loadFrame(
+    MolecularDataCall* mol, MolecularDataCall* sol, unsigned int frameID, FramePositions& out) {
+    mol->SetFrameID(frameID);
+    if (!(*mol)(MolecularDataCall::CallForGetData))
+        return false;
+    sol->SetFrameID(frameID);
+    if (!(*sol)(MolecularDataCall::CallForGetData)) {
+        mol->Unlock();
+        return false;
+    }
+    out.mol.assign(mol->AtomPositions(), mol->AtomPositions() + 3 * mol->AtomCount());
+    out.sol.assign(sol->AtomPositions(), sol->AtomPositions() + 3 * sol->AtomCount());
+    mol->Unlock();
+    sol->Unlock();
+    return true;
+}
+
+
+/*
+ * SolventCounter::countSolventNeighbours
+ */
+void SolventCounter::countSolventNeighbours(const FramePositions& frame, float radius) {
+    const unsigned int solCount = static_cast<unsigned int>(frame.sol.size() / 3);
+    const int molCount = static_cast<int>(std::min(frame.mol.size() / 3, this->hitCount.size()));
+    if (solCount == 0)
+        return;
+
+    // the grid must contain all solvent atoms, including those on the upper faces of their bounding box
+    const float* solPos = frame.sol.data();
+    vislib::math::Cuboid<float> bbox(solPos[0], solPos[1], solPos[2], solPos[0], solPos[1], solPos[2]);
+    for (unsigned int j = 1; j < solCount; j++) {
+        bbox.GrowToPoint(solPos[3 * j], solPos[3 * j + 1], solPos[3 * j + 2]);
+    }
+    bbox.Grow(radius);
+    this->solventGrid.SetPointData(solPos, solCount, bbox, radius);
+
+#pragma omp parallel
+    {
+        vislib::Array<unsigned int> neighbours;
+#pragma omp for schedule(dynamic, 256)
+        for (int i = 0; i < molCount; i++) {
+            neighbours.Clear();
+            this->solventGrid.FindNeighboursInRange(&frame.mol[3 * i], radius, neighbours);
+            if (!neighbours.IsEmpty()) {
+                this->hitCount[i]++;
+            }
+        }
+    }
 }
 
 
@@ -95,99 +161,108 @@ bool SolventCounter::getDataCallback(core::Call& call) {
         return false;
     if (!(*sol)(MolecularDataCall::CallForGetExtent))
         return false;
+    // read the radius once, it is used for every atom of every frame
+    const float radius = this->radiusParam.Param<param::FloatParam>()->Value();
 #if GET_ONE_TIMESTEP
     if (sol->FrameCount() != mol->FrameCount())
         return false;
-    mol->SetFrameID(dc->FrameID());
-    if (!(*mol)(MolecularDataCall::CallForGetData))
-        return false;
-    sol->SetFrameID(dc->FrameID());
-    if (!(*sol)(MolecularDataCall::CallForGetData))
-        return false;
 
-    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()) {
-        this->solvent.Clear();
-        this->solvent.SetCount(mol->AtomCount());
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
-        for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            molAtomPos.Set(
-                mol->AtomPositions()[3 * i], mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
-            this->solvent[i] = 0.0f;
-            for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                solAtomPos.Set(
-                    sol->AtomPositions()[3 * j], sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                // increase counter if the current solvent atom is within the given radius
-                if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                    this->solvent[i] = 1.0f;
-                }
-            }
+    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash() || this->countRadius != radius) {
+        FramePositions frame;
+        if (!loadFrame(mol, sol, dc->FrameID(), frame))
+            return false;
+        const unsigned int atomCount = static_cast<unsigned int>(frame.mol.size() / 3);
+        this->hitCount.assign(atomCount, 0);
+        this->countSolventNeighbours(frame, radius);
+
+        this->solvent.SetCount(atomCount);
+        for (unsigned int i = 0; i < atomCount; i++) {
+            // one if any solvent atom is within the given radius
+            this->solvent[i] = (this->hitCount[i] > 0) ? 1.0f : 0.0f;
         }
         this->datahash = mol->DataHash();
+        this->countRadius = radius;
     }
-    mol->Unlock();
-    sol->Unlock();
 #else
     // sol and mol must have the same number of frames
     if (sol->FrameCount() != mol->FrameCount())
         return false;
     unsigned int frameCount = mol->FrameCount();
-    // only recompute everything if this is necessary
-    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()) {
-        // load data once...
-        mol->SetFrameID(0);
-        if (!(*mol)(MolecularDataCall::CallForGetData))
-            return false;
-        sol->SetFrameID(0);
-        if (!(*sol)(MolecularDataCall::CallForGetData))
-            return false;
+    const bool incremental = this->incrementalParam.Param<param::BoolParam>()->Value();
+    this->incrementalParam.ResetDirty();
+
+    // only recompute everything if this is necessary, new frames are added to the counts in incremental mode.
+    // the counts are summed over the frames, so those of removed frames cannot be taken out again
+    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash() || this->countRadius != radius ||
+        (frameCount < this->frameProcessed.size()) || (!incremental && this->frameProcessed.size() != frameCount)) {
+        this->hitCount.assign(mol->AtomCount(), 0);
+        this->frameProcessed.assign(frameCount, false);
+        this->processedFrameCount = 0;
+        this->datahash = mol->DataHash();
+        this->countRadius = radius;
+    }
+    this->frameProcessed.resize(frameCount, false);
+
+    std::vector<unsigned int> pendingFrames;
+    for (unsigned int fID = 0; fID < frameCount; fID++) {
+        if (!this->frameProcessed[fID])
+            pendingFrames.push_back(fID);
+    }
+
+    if (!pendingFrames.empty()) {
         megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-            "Start recomputing solvent neighborhood information per atom...");
-        this->solvent.Clear();
-        this->solvent.SetCount(mol->AtomCount());
-        // set all values to zero
-        for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            this->solvent[i] = 0.0f;
+            "Start computing solvent neighborhood information per atom for %zu frames...", pendingFrames.size());
+
+        // the next frame is loaded while the current one is counted
+        FramePositions current, next;
+        if (!loadFrame(mol, sol, pendingFrames[0], current))
+            return false;
+        if (this->processedFrameCount == 0) {
+            this->hitCount.assign(current.mol.size() / 3, 0);
         }
-        this->minValue = FLT_MAX;
-        this->maxValue = FLT_MIN;
-        // loop over all frames
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
-        for (unsigned int fID = 0; fID < frameCount; fID++) {
+        for (size_t k = 0; k < pendingFrames.size(); k++) {
+            const unsigned int fID = pendingFrames[k];
             if (fID % 100 == 0)
                 megamol::core::utility::log::Log::DefaultLog.WriteInfo("Computing Frame %i", fID);
-            mol->SetFrameID(fID);
-            if (!(*mol)(MolecularDataCall::CallForGetData))
-                return false;
-            sol->SetFrameID(fID);
-            if (!(*sol)(MolecularDataCall::CallForGetData))
+
+            std::future<bool> prefetch;
+            if (k + 1 < pendingFrames.size()) {
+                prefetch = std::async(
+                    std::launch::async, &SolventCounter::loadFrame, mol, sol, pendingFrames[k + 1], std::ref(next));
+            }
+
+            if (current.mol.size() != 3 * this->hitCount.size()) {
+                if (prefetch.valid())
+                    prefetch.wait();
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    "SolventCounter: atom count of frame %u differs from the first frame", fID);
                 return false;
-            // loop over all molecule atoms and check for neighboring solvent atoms
-            for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-                molAtomPos.Set(
-                    mol->AtomPositions()[3 * i], mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
-                for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                    solAtomPos.Set(
-                        sol->AtomPositions()[3 * j], sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                    // increase counter if the current solvent atom is within the given radius
-                    if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                        this->solvent[i] += 1.0f;
-                        break;
-                    }
-                }
             }
-            this->datahash = mol->DataHash();
-            mol->Unlock();
-            sol->Unlock();
-        }
-        // normalize values
-        for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            this->solvent[i] /= static_cast<float>(frameCount);
-            this->minValue = vislib::math::Min(this->minValue, this->solvent[i]);
-            this->maxValue = vislib::math::Max(this->maxValue, this->solvent[i]);
+            this->countSolventNeighbours(current, radius);
+            this->frameProcessed[fID] = true;
+            this->processedFrameCount++;
+
+            if (prefetch.valid() && !prefetch.get())
+                return false;
+            std::swap(current, next);
         }
-        this->midValue = (this->maxValue - this->minValue) * 0.8f + this->minValue;
+    }
+
+    // normalize values
+    this->solvent.SetCount(this->hitCount.size());
+    this->minValue = FLT_MAX;
+    this->maxValue = FLT_MIN;
+    const float frameNorm =
+        (this->processedFrameCount > 0) ? 1.0f / static_cast<float>(this->processedFrameCount) : 0.0f;
+    for (unsigned int i = 0; i < this->hitCount.size(); i++) {
+        this->solvent[i] = static_cast<float>(this->hitCount[i]) * frameNorm;
+        this->minValue = vislib::math::Min(this->minValue, this->solvent[i]);
+        this->maxValue = vislib::math::Max(this->maxValue, this->solvent[i]);
+    }
+    this->midValue = (this->maxValue - this->minValue) * 0.8f + this->minValue;
+    if (!pendingFrames.empty()) {
         megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-            "Finished recomputing solvent neighborhood information per atom (%.3f, %.3f, %.3f).", this->minValue,
+            "Finished computing solvent neighborhood information per atom (%.3f, %.3f, %.3f).", this->minValue,
             this->midValue, this->maxValue);
     }
 #endif // GET_ONE_TIMESTEP
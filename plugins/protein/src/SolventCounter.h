@@ -12,8 +12,10 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
+#include "protein/GridNeighbourFinder.h"
 #include "protein_calls/MolecularDataCall.h"
 #include "vislib/Array.h"
+#include <vector>
 
 
 namespace megamol::protein {
@@ -89,6 +91,34 @@ private:
      */
     bool getDataCallback(core::Call& caller);
 
+    /** Atom positions of one frame, copied so the next frame can be loaded meanwhile */
+    struct FramePositions {
+        std::vector<float> mol;
+        std::vector<float> sol;
+    };
+
+    /**
+     * Loads a frame of both data sources and copies the atom positions.
+     *
+     * @param mol     The molecular data call.
+     * @param sol     The solvent data call.
+     * @param frameID The frame to load.
+     * @param out     Receives the positions.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    static bool loadFrame(protein_calls::MolecularDataCall* mol, protein_calls::MolecularDataCall* sol,
+        unsigned int frameID, FramePositions& out);
+
+    /**
+     * Increments the hit count of every molecule atom that has at least one
+     * solvent atom within the given radius.
+     *
+     * @param frame  The positions of the frame.
+     * @param radius The search radius.
+     */
+    void countSolventNeighbours(const FramePositions& frame, float radius);
+
     /** The slot for requesting data */
     core::CalleeSlot getDataSlot;
 
@@ -101,6 +131,24 @@ private:
     /** MSMS detail parameter */
     megamol::core::param::ParamSlot radiusParam;
 
+    /** Only process frames that were not processed yet instead of recomputing all */
+    megamol::core::param::ParamSlot incrementalParam;
+
+    /** The search grid over the solvent atoms of the current frame */
+    GridNeighbourFinder<float> solventGrid;
+
+    /** Number of processed frames each molecule atom had solvent atoms nearby */
+    std::vector<unsigned int> hitCount;
+
+    /** Marks the frames that contributed to 'hitCount' */
+    std::vector<bool> frameProcessed;
+
+    /** Number of set entries of 'frameProcessed' */
+    unsigned int processedFrameCount;
+
+    /** The radius 'hitCount' was computed with */
+    float countRadius;
+
     /** The array that stores the solvent around each atom */
     vislib::Array<float> solvent;
 
@@ -0,0 +1,325 @@
+#include "FBOCodec.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "snappy.h"
+
+
+namespace {
+
+constexpr size_t color_el_size = 4;
+
+constexpr size_t depth_el_size = 4;
+
+/** Quantized depth value reserved for the far plane, i.e. the background. */
+constexpr uint16_t depth_far = 0xFFFF;
+
+constexpr float depth_steps = 65534.0f;
+
+
+/** Copies the rows of tile 'r' of a frame of width 'width' into a contiguous buffer. */
+void gather(char const* frame, int width, int const r[4], size_t el_size, char* tile) {
+    auto const row = r[2] * el_size;
+    for (int y = 0; y < r[3]; ++y) {
+        std::memcpy(tile + y * row, frame + ((r[1] + y) * static_cast<size_t>(width) + r[0]) * el_size, row);
+    }
+}
+
+
+/** Answer whether tile 'r' is equal in both frames. */
+bool equal(char const* lhs, char const* rhs, int width, int const r[4], size_t el_size) {
+    auto const row = r[2] * el_size;
+    for (int y = 0; y < r[3]; ++y) {
+        auto const offset = ((r[1] + y) * static_cast<size_t>(width) + r[0]) * el_size;
+        if (std::memcmp(lhs + offset, rhs + offset, row) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** Appends the snappy-compressed 'data' to 'out' and answers the compressed size. */
+uint32_t compress(char const* data, size_t size, std::vector<char>& out) {
+    auto const pos = out.size();
+    out.resize(pos + snappy::MaxCompressedLength(size));
+    size_t comp_size = 0;
+    snappy::RawCompress(data, size, out.data() + pos, &comp_size);
+    out.resize(pos + comp_size);
+    return static_cast<uint32_t>(comp_size);
+}
+
+
+/** Uncompresses 'size' bytes at 'data' into 'out', which must end up with 'expected' bytes. */
+bool uncompress(char const* data, size_t size, size_t expected, std::vector<char>& out) {
+    size_t len = 0;
+    if (!snappy::GetUncompressedLength(data, size, &len) || (len != expected)) {
+        return false;
+    }
+    out.resize(len);
+    return snappy::RawUncompress(data, size, out.data());
+}
+
+
+/** Writes the contiguous 'tile' to tile 'r' of 'frame', XORing it with the content if 'delta' is set. */
+void scatter(char const* tile, int width, int const r[4], size_t el_size, bool delta, char* frame) {
+    auto const row = r[2] * el_size;
+    for (int y = 0; y < r[3]; ++y) {
+        auto dst = frame + ((r[1] + y) * static_cast<size_t>(width) + r[0]) * el_size;
+        auto src = tile + y * row;
+        if (delta) {
+            for (size_t i = 0; i < row; ++i) {
+                dst[i] ^= src[i];
+            }
+        } else {
+            std::memcpy(dst, src, row);
+        }
+    }
+}
+
+} // namespace
+
+
+void megamol::remote::FBOTileEncoder::Reset(void) {
+    this->key_ = true;
+    this->tiling_ = fbo_tiling{};
+}
+
+
+size_t megamol::remote::FBOTileEncoder::Update(
+    char const* color, char const* depth, fbo_tiling const& tiling, bool key) {
+    this->key_ = key || (tiling != this->tiling_);
+    this->tiling_ = tiling;
+    this->color_ = color;
+    this->depth_ = depth;
+
+    auto const pixels = static_cast<size_t>(tiling.width) * tiling.height;
+    if (this->key_) {
+        this->prev_color_.resize(pixels * color_el_size);
+        this->prev_depth_.resize(pixels * depth_el_size);
+        this->recon_color_.resize(pixels * color_el_size);
+        this->recon_depth_.resize(pixels * depth_el_size);
+    }
+
+    this->dirty_.clear();
+    int r[4];
+    for (uint32_t idx = 0; idx < static_cast<uint32_t>(tiling.count()); ++idx) {
+        tiling.rect(idx, r);
+        if (this->key_ || !equal(color, this->prev_color_.data(), tiling.width, r, color_el_size) ||
+            !equal(depth, this->prev_depth_.data(), tiling.width, r, depth_el_size)) {
+            this->dirty_.push_back(idx);
+        }
+    }
+
+    return this->dirty_.size();
+}
+
+
+uint32_t megamol::remote::FBOTileEncoder::Encode(fbo_color_codec color_codec, fbo_depth_codec depth_codec,
+    std::vector<char>& out, size_t& color_bytes, size_t& depth_bytes) {
+    auto const width = this->tiling_.width;
+    int r[4];
+
+    color_bytes = depth_bytes = 0;
+    for (auto const idx : this->dirty_) {
+        this->tiling_.rect(idx, r);
+        auto const pixels = static_cast<size_t>(r[2]) * r[3];
+
+        fbo_tile_header th{idx, color_codec, depth_codec, TILE_NONE, 0, 0};
+        auto const header_pos = out.size();
+        out.resize(header_pos + sizeof(fbo_tile_header));
+
+        this->packed_.resize(pixels * color_el_size);
+        gather(this->color_, width, r, color_el_size, this->packed_.data());
+        if (color_codec == COLOR_RGB565) {
+            // 5-6-5 bits per channel, alpha is dropped, the decoder restores it as opaque
+            this->scratch_.resize(pixels * sizeof(uint16_t));
+            auto const src = reinterpret_cast<unsigned char const*>(this->packed_.data());
+            auto const dst = reinterpret_cast<uint16_t*>(this->scratch_.data());
+            for (size_t i = 0; i < pixels; ++i) {
+                dst[i] = static_cast<uint16_t>(((src[4 * i] >> 3) << 11) | ((src[4 * i + 1] >> 2) << 5) |
+                                               (src[4 * i + 2] >> 3));
+            }
+            th.color_size = compress(this->scratch_.data(), this->scratch_.size(), out);
+        } else {
+            if (!this->key_) {
+                this->scratch_.resize(this->packed_.size());
+                gather(this->recon_color_.data(), width, r, color_el_size, this->scratch_.data());
+                for (size_t i = 0; i < this->packed_.size(); ++i) {
+                    this->packed_[i] ^= this->scratch_[i];
+                }
+                th.flags |= TILE_COLOR_DELTA;
+            }
+            th.color_size = compress(this->packed_.data(), this->packed_.size(), out);
+        }
+
+        this->packed_.resize(pixels * depth_el_size);
+        gather(this->depth_, width, r, depth_el_size, this->packed_.data());
+        if (depth_codec == DEPTH_QUANTIZED) {
+            // 16 bit fixed point relative to the depth range of the tile, the far plane is kept exactly
+            auto const src = reinterpret_cast<float const*>(this->packed_.data());
+            float lo = 1.0f, hi = 0.0f;
+            for (size_t i = 0; i < pixels; ++i) {
+                if (src[i] < 1.0f) {
+                    lo = std::min(lo, src[i]);
+                    hi = std::max(hi, src[i]);
+                }
+            }
+            if (hi < lo) {
+                hi = lo;
+            }
+            auto const scale = (hi > lo) ? depth_steps / (hi - lo) : 0.0f;
+            this->scratch_.resize(pixels * sizeof(uint16_t));
+            auto const dst = reinterpret_cast<uint16_t*>(this->scratch_.data());
+            for (size_t i = 0; i < pixels; ++i) {
+                dst[i] = (src[i] < 1.0f) ? static_cast<uint16_t>(std::lround((src[i] - lo) * scale)) : depth_far;
+            }
+            auto const pos = out.size();
+            out.resize(pos + 2 * sizeof(float));
+            std::memcpy(out.data() + pos, &lo, sizeof(float));
+            std::memcpy(out.data() + pos + sizeof(float), &hi, sizeof(float));
+            th.depth_size = 2 * sizeof(float) + compress(this->scratch_.data(), this->scratch_.size(), out);
+        } else {
+            if (!this->key_) {
+                this->scratch_.resize(this->packed_.size());
+                gather(this->recon_depth_.data(), width, r, depth_el_size, this->scratch_.data());
+                for (size_t i = 0; i < this->packed_.size(); ++i) {
+                    this->packed_[i] ^= this->scratch_[i];
+                }
+                th.flags |= TILE_DEPTH_DELTA;
+            }
+            th.depth_size = compress(this->packed_.data(), this->packed_.size(), out);
+        }
+
+        std::memcpy(out.data() + header_pos, &th, sizeof(fbo_tile_header));
+        color_bytes += th.color_size;
+        depth_bytes += th.depth_size;
+
+        // mirror what the receiver sees, lossy tiles differ from the input
+        auto const payload = out.data() + header_pos + sizeof(fbo_tile_header);
+        FBOTileDecoder::decodeTile(th, payload, payload + th.color_size, this->tiling_, this->recon_color_.data(),
+            this->recon_depth_.data(), this->scratch_);
+
+        auto const row_color = r[2] * color_el_size;
+        auto const row_depth = r[2] * depth_el_size;
+        for (int y = 0; y < r[3]; ++y) {
+            auto const offset = (r[1] + y) * static_cast<size_t>(width) + r[0];
+            std::memcpy(this->prev_color_.data() + offset * color_el_size, this->color_ + offset * color_el_size,
+                row_color);
+            std::memcpy(this->prev_depth_.data() + offset * depth_el_size, this->depth_ + offset * depth_el_size,
+                row_depth);
+        }
+    }
+
+    this->color_ = this->depth_ = nullptr;
+    return static_cast<uint32_t>(this->dirty_.size());
+}
+
+
+bool megamol::remote::FBOTileDecoder::Decode(
+    char const* data, size_t size, uint32_t tile_count, fbo_tiling const& tiling, bool key) {
+    if (tiling != this->tiling_) {
+        if (!key) {
+            return false;
+        }
+        auto const pixels = static_cast<size_t>(tiling.width) * tiling.height;
+        this->tiling_ = tiling;
+        this->color_.assign(pixels * color_el_size, 0);
+        this->depth_.assign(pixels * depth_el_size, 0);
+    }
+
+    auto ptr = data;
+    auto const end = data + size;
+    for (uint32_t t = 0; t < tile_count; ++t) {
+        fbo_tile_header th;
+        if (static_cast<size_t>(end - ptr) < sizeof(fbo_tile_header)) {
+            return false;
+        }
+        std::memcpy(&th, ptr, sizeof(fbo_tile_header));
+        ptr += sizeof(fbo_tile_header);
+        if ((th.index >= static_cast<uint32_t>(tiling.count())) ||
+            (static_cast<size_t>(end - ptr) < static_cast<size_t>(th.color_size) + th.depth_size) ||
+            (key && (th.flags != TILE_NONE))) {
+            return false;
+        }
+        if (!decodeTile(th, ptr, ptr + th.color_size, tiling, this->color_.data(), this->depth_.data(),
+                this->scratch_)) {
+            return false;
+        }
+        ptr += th.color_size + th.depth_size;
+    }
+
+    return ptr == end;
+}
+
+
+bool megamol::remote::FBOTileDecoder::decodeTile(fbo_tile_header const& th, char const* color_data,
+    char const* depth_data, fbo_tiling const& tiling, char* color, char* depth, std::vector<char>& scratch) {
+    int r[4];
+    tiling.rect(th.index, r);
+    auto const pixels = static_cast<size_t>(r[2]) * r[3];
+
+    switch (th.color_codec) {
+    case COLOR_SNAPPY:
+        if (!uncompress(color_data, th.color_size, pixels * color_el_size, scratch)) {
+            return false;
+        }
+        scatter(scratch.data(), tiling.width, r, color_el_size, (th.flags & TILE_COLOR_DELTA) != 0, color);
+        break;
+    case COLOR_RGB565: {
+        if (!uncompress(color_data, th.color_size, pixels * sizeof(uint16_t), scratch)) {
+            return false;
+        }
+        auto const src = reinterpret_cast<uint16_t const*>(scratch.data());
+        for (int y = 0; y < r[3]; ++y) {
+            auto dst = reinterpret_cast<unsigned char*>(color) +
+                       ((r[1] + y) * static_cast<size_t>(tiling.width) + r[0]) * color_el_size;
+            for (int x = 0; x < r[2]; ++x) {
+                auto const p = src[y * r[2] + x];
+                auto const red = (p >> 11) & 0x1F, green = (p >> 5) & 0x3F, blue = p & 0x1F;
+                dst[4 * x] = static_cast<unsigned char>((red << 3) | (red >> 2));
+                dst[4 * x + 1] = static_cast<unsigned char>((green << 2) | (green >> 4));
+                dst[4 * x + 2] = static_cast<unsigned char>((blue << 3) | (blue >> 2));
+                dst[4 * x + 3] = static_cast<unsigned char>(0xFF);
+            }
+        }
+    } break;
+    default:
+        return false;
+    }
+
+    switch (th.depth_codec) {
+    case DEPTH_SNAPPY:
+        if (!uncompress(depth_data, th.depth_size, pixels * depth_el_size, scratch)) {
+            return false;
+        }
+        scatter(scratch.data(), tiling.width, r, depth_el_size, (th.flags & TILE_DEPTH_DELTA) != 0, depth);
+        break;
+    case DEPTH_QUANTIZED: {
+        float lo, hi;
+        if (th.depth_size < 2 * sizeof(float)) {
+            return false;
+        }
+        std::memcpy(&lo, depth_data, sizeof(float));
+        std::memcpy(&hi, depth_data + sizeof(float), sizeof(float));
+        if (!uncompress(depth_data + 2 * sizeof(float), th.depth_size - 2 * sizeof(float),
+                pixels * sizeof(uint16_t), scratch)) {
+            return false;
+        }
+        auto const src = reinterpret_cast<uint16_t const*>(scratch.data());
+        auto const step = (hi - lo) / depth_steps;
+        for (int y = 0; y < r[3]; ++y) {
+            auto dst = reinterpret_cast<float*>(depth) + (r[1] + y) * static_cast<size_t>(tiling.width) + r[0];
+            for (int x = 0; x < r[2]; ++x) {
+                auto const q = src[y * r[2] + x];
+                dst[x] = (q == depth_far) ? 1.0f : lo + q * step;
+            }
+        }
+    } break;
+    default:
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "FBOProto.h"
+
+namespace megamol {
+namespace remote {
+
+enum fbo_color_codec : uint8_t { COLOR_SNAPPY = 0, COLOR_RGB565 };
+
+enum fbo_depth_codec : uint8_t { DEPTH_SNAPPY = 0, DEPTH_QUANTIZED };
+
+/** Codec selection of the transmitter */
+enum fbo_codec_mode : int { CODEC_LOSSLESS = 0, CODEC_LOSSY, CODEC_ADAPTIVE };
+
+enum fbo_tile_flags : uint16_t { TILE_NONE = 0, TILE_COLOR_DELTA = 1, TILE_DEPTH_DELTA = 2 };
+
+/**
+ * Record preceding the payload of each transmitted tile. The color payload
+ * follows the record immediately, the depth payload follows the color
+ * payload.
+ */
+struct fbo_tile_header {
+    // index of the tile in row-major order
+    uint32_t index;
+    // codec of the color payload
+    uint8_t color_codec;
+    // codec of the depth payload
+    uint8_t depth_codec;
+    // fbo_tile_flags
+    uint16_t flags;
+    // size of the color payload
+    uint32_t color_size;
+    // size of the depth payload
+    uint32_t depth_size;
+};
+
+/**
+ * Partitioning of a RGBAu8/Df frame into square tiles.
+ */
+struct fbo_tiling {
+    int width = 0;
+    int height = 0;
+    int tile_size = 0;
+
+    int tiles_x() const {
+        return (width + tile_size - 1) / tile_size;
+    }
+
+    int tiles_y() const {
+        return (height + tile_size - 1) / tile_size;
+    }
+
+    int count() const {
+        return tile_size > 0 ? tiles_x() * tiles_y() : 0;
+    }
+
+    /** Answer the pixel rectangle [x, y, w, h] of tile 'idx'. */
+    void rect(uint32_t idx, int r[4]) const {
+        r[0] = static_cast<int>(idx % tiles_x()) * tile_size;
+        r[1] = static_cast<int>(idx / tiles_x()) * tile_size;
+        r[2] = std::min(tile_size, width - r[0]);
+        r[3] = std::min(tile_size, height - r[1]);
+    }
+
+    bool operator==(fbo_tiling const& rhs) const {
+        return width == rhs.width && height == rhs.height && tile_size == rhs.tile_size;
+    }
+
+    bool operator!=(fbo_tiling const& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * Encodes the tiles of a frame that changed since the previous frame.
+ *
+ * The encoder mirrors the image the decoder reconstructs, so lossless tiles
+ * can be sent as XOR deltas against it even if neighbouring tiles or earlier
+ * versions of the same tile were sent with a lossy codec. Dirty tiles are
+ * detected against the previous input frame, hence a tile that is not
+ * touched by the renderer is not resent, whatever codec it was sent with.
+ */
+class FBOTileEncoder {
+public:
+    /** Forget the reference frame, the next frame is a key frame. */
+    void Reset(void);
+
+    /**
+     * Compares a new frame to the previous one.
+     *
+     * @param color  RGBAu8 pixels of the frame, must stay valid until Encode.
+     * @param depth  Df pixels of the frame, must stay valid until Encode.
+     * @param tiling The layout of the frame.
+     * @param key    Force a key frame, i.e. send all tiles without delta.
+     *
+     * @return The number of tiles that need to be sent.
+     */
+    size_t Update(char const* color, char const* depth, fbo_tiling const& tiling, bool key);
+
+    /**
+     * Appends the tiles found by Update to 'out' and makes the frame the
+     * new reference.
+     *
+     * @return The number of tiles written.
+     */
+    uint32_t Encode(fbo_color_codec color_codec, fbo_depth_codec depth_codec, std::vector<char>& out,
+        size_t& color_bytes, size_t& depth_bytes);
+
+    /** Answer whether the last Update produced a key frame. */
+    bool IsKey(void) const {
+        return key_;
+    }
+
+    fbo_tiling const& Tiling(void) const {
+        return tiling_;
+    }
+
+private:
+    std::vector<char> prev_color_;
+    std::vector<char> prev_depth_;
+    std::vector<char> recon_color_;
+    std::vector<char> recon_depth_;
+    std::vector<uint32_t> dirty_;
+    std::vector<char> scratch_;
+    std::vector<char> packed_;
+    char const* color_ = nullptr;
+    char const* depth_ = nullptr;
+    fbo_tiling tiling_;
+    bool key_ = true;
+};
+
+/**
+ * Applies the tiles written by FBOTileEncoder to the reconstructed frame.
+ */
+class FBOTileDecoder {
+public:
+    /**
+     * Decodes 'tile_count' tiles from 'data'.
+     *
+     * @param key Whether the tiles form a key frame, which resets the frame.
+     *
+     * @return 'false' if the payload is malformed, the frame must not be
+     *         used as a reference afterwards.
+     */
+    bool Decode(char const* data, size_t size, uint32_t tile_count, fbo_tiling const& tiling, bool key);
+
+    std::vector<char> const& Color(void) const {
+        return color_;
+    }
+
+    std::vector<char> const& Depth(void) const {
+        return depth_;
+    }
+
+private:
+    friend class FBOTileEncoder;
+
+    /** Decodes a single tile into the tile rectangle of 'color' and 'depth'. */
+    static bool decodeTile(fbo_tile_header const& th, char const* color_data, char const* depth_data,
+        fbo_tiling const& tiling, char* color, char* depth, std::vector<char>& scratch);
+
+    std::vector<char> color_;
+    std::vector<char> depth_;
+    std::vector<char> scratch_;
+    fbo_tiling tiling_;
+};
+
+} // end namespace remote
+} // end namespace megamol
@@ -1,5 +1,7 @@
 #include "FBOCommFabric.h"
 
+#include <thread>
+
 #ifdef MEGAMOL_USE_MPI
 #include <mpi.h>
 #endif // MEGAMOL_USE_MPI
@@ -41,10 +43,14 @@ bool megamol::remote::MPICommFabric::Send(std::vector<char> const& buf, send_typ
 bool megamol::remote::MPICommFabric::Recv(std::vector<char>& buf, recv_type const type) {
 #ifdef MEGAMOL_USE_MPI
     MPI_Status stat;
-    buf.resize(recv_count_);
     // TODO this is wrong. mpiprovider gives you the correct comm
-    auto status = MPI_Recv(buf.data(), recv_count_, MPI_CHAR, source_rank_, 0, MPI_COMM_WORLD, &stat);
+    // the size of the pending message is not known in advance
+    if (MPI_Probe(source_rank_, 0, MPI_COMM_WORLD, &stat) != MPI_SUCCESS) {
+        return false;
+    }
     MPI_Get_count(&stat, MPI_CHAR, &recv_count_);
+    buf.resize(recv_count_);
+    auto status = MPI_Recv(buf.data(), recv_count_, MPI_CHAR, source_rank_, 0, MPI_COMM_WORLD, &stat);
     return status == MPI_SUCCESS;
 #else
     return false;
@@ -52,6 +58,29 @@ bool megamol::remote::MPICommFabric::Recv(std::vector<char>& buf, recv_type cons
 }
 
 
+bool megamol::remote::MPICommFabric::Poll(std::chrono::milliseconds timeout) {
+#ifdef MEGAMOL_USE_MPI
+    // MPI has no timed probe, test for a pending message until the deadline passed
+    auto const deadline = std::chrono::steady_clock::now() + timeout;
+    do {
+        int flag = 0;
+        MPI_Status stat;
+        // TODO this is wrong. mpiprovider gives you the correct comm
+        if (MPI_Iprobe(source_rank_, 0, MPI_COMM_WORLD, &flag, &stat) != MPI_SUCCESS) {
+            return false;
+        }
+        if (flag) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
+#else
+    return false;
+#endif // MEGAMOL_USE_MPI
+}
+
+
 bool megamol::remote::MPICommFabric::Disconnect() {
     return true;
 }
@@ -120,6 +149,16 @@ bool megamol::remote::ZMQCommFabric::Recv(std::vector<char>& buf, recv_type cons
 }
 
 
+bool megamol::remote::ZMQCommFabric::Poll(std::chrono::milliseconds timeout) {
+    zmq_pollitem_t item{this->socket_.handle(), 0, ZMQ_POLLIN, 0};
+    auto const ret = zmq_poll(&item, 1, static_cast<long>(timeout.count()));
+    if (ret < 0) {
+        throw zmq::error_t();
+    }
+    return (ret > 0) && ((item.revents & ZMQ_POLLIN) != 0);
+}
+
+
 bool megamol::remote::ZMQCommFabric::Disconnect() {
     // if (this->socket_.connected()) {
     if (!this->address_.empty()) {
@@ -170,6 +209,11 @@ bool megamol::remote::FBOCommFabric::Recv(std::vector<char>& buf, recv_type cons
 }
 
 
+bool megamol::remote::FBOCommFabric::Poll(std::chrono::milliseconds timeout) {
+    return this->pimpl_->Poll(timeout);
+}
+
+
 bool megamol::remote::FBOCommFabric::Disconnect() {
     return this->pimpl_->Disconnect();
 }
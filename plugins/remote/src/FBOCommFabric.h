@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <vector>
 #ifdef MEGAMOL_USE_MPI
@@ -21,6 +22,8 @@ public:
     virtual bool Bind(std::string const& address) = 0;
     virtual bool Send(std::vector<char> const& buf, send_type const type = ST_UNDEF) = 0;
     virtual bool Recv(std::vector<char>& buf, recv_type const type = RT_UNDEF) = 0;
+    /** Waits at most 'timeout' for a message and answers whether one is pending */
+    virtual bool Poll(std::chrono::milliseconds timeout) = 0;
     virtual bool Disconnect(void) = 0;
     virtual ~AbstractCommFabric(void) = default;
 };
@@ -36,6 +39,7 @@ public:
     bool Bind(std::string const& address) override;
     bool Send(std::vector<char> const& buf, send_type const type = ST_UNDEF) override;
     bool Recv(std::vector<char>& buf, recv_type const type = RT_UNDEF) override;
+    bool Poll(std::chrono::milliseconds timeout) override;
     bool Disconnect() override;
     virtual ~MPICommFabric(void);
 
@@ -63,6 +67,7 @@ public:
     bool Bind(std::string const& address) override;
     bool Send(std::vector<char> const& buf, send_type const type = ST_UNDEF) override;
     bool Recv(std::vector<char>& buf, recv_type const type = RT_UNDEF) override;
+    bool Poll(std::chrono::milliseconds timeout) override;
     bool Disconnect(void) override;
     virtual ~ZMQCommFabric(void);
 
@@ -103,6 +108,8 @@ public:
 
     bool Recv(std::vector<char>& buf, recv_type const type = RT_UNDEF) override;
 
+    bool Poll(std::chrono::milliseconds timeout) override;
+
     bool Disconnect(void) override;
 
     virtual ~FBOCommFabric(void) = default;
@@ -1,5 +1,8 @@
 #include "FBOCompositor2.h"
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 
@@ -7,6 +10,7 @@
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/ButtonParam.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmcore/param/StringParam.h"
 #include "mmcore/utility/ResourceWrapper.h"
@@ -14,7 +18,7 @@
 #include "mmcore/view/CallRender3DGL.h"
 #include "mmcore/view/Camera_2.h"
 
-#include "snappy.h"
+#include "FBOCodec.h"
 
 #include "vislib/Exception.h"
 #include <exception>
@@ -35,6 +39,8 @@ megamol::remote::FBOCompositor2::FBOCompositor2()
               "Required to be set for cinematic rendering. If true, rendering is skipped until frame for requested "
               "camera "
               "and time is received."}
+        , logStatisticsSlot_{"logStatistics", "Log bandwidth and latency of each render node once per second"}
+        , statisticsFileSlot_{"statisticsFile", "CSV file the bandwidth and latency of each render node is appended to"}
         , close_future_{close_promise_.get_future()}
         , fbo_msg_write_{new std::vector<fbo_msg_t>}
         , fbo_msg_recv_{new std::vector<fbo_msg_t>}
@@ -70,6 +76,11 @@ megamol::remote::FBOCompositor2::FBOCompositor2()
 
     renderOnlyRequestedFramesSlot_ << new megamol::core::param::BoolParam(false);
     this->MakeSlotAvailable(&renderOnlyRequestedFramesSlot_);
+    logStatisticsSlot_ << new megamol::core::param::BoolParam(false);
+    this->MakeSlotAvailable(&logStatisticsSlot_);
+    statisticsFileSlot_ << new megamol::core::param::FilePathParam(
+        "", megamol::core::param::FilePathParam::FilePathFlags_::Flag_File_ToBeCreated);
+    this->MakeSlotAvailable(&statisticsFileSlot_);
 }
 
 
@@ -395,9 +406,13 @@ bool megamol::remote::FBOCompositor2::initThreads() {
 }
 
 
-void megamol::remote::FBOCompositor2::receiverJob(
-    FBOCommFabric& comm, core::utility::sys::FutureReset<fbo_msg_t>* fbo_msg_future, std::future<bool>&& close) {
+void megamol::remote::FBOCompositor2::receiverJob(FBOCommFabric& comm, size_t node,
+    core::utility::sys::FutureReset<fbo_msg_t>* fbo_msg_future, std::future<bool>&& close) {
     try {
+        // the frame reconstructed from the tiles of this node and its id, which the transmitter encodes against
+        FBOTileDecoder decoder;
+        id_t held_frame_id = invalid_frame_id;
+
         while (!shutdown_) {
             auto const status = close.wait_for(std::chrono::milliseconds(1));
             if (status == std::future_status::ready)
@@ -405,6 +420,9 @@ void megamol::remote::FBOCompositor2::receiverJob(
 
             // send a request for data
             std::vector<char> buf{'r', 'e', 'q'};
+            buf.insert(buf.end(), reinterpret_cast<char const*>(&held_frame_id),
+                reinterpret_cast<char const*>(&held_frame_id) + sizeof(id_t));
+            auto const request_time = std::chrono::steady_clock::now();
             try {
 #if _DEBUG
                 megamol::core::utility::log::Log::DefaultLog.WriteInfo("FBOCompositor2: Sending request\n");
@@ -452,51 +470,62 @@ void megamol::remote::FBOCompositor2::receiverJob(
                     "FBOCompositor2: Exception during recv in 'receiverJob'\n");
             }
 
+            auto const reply_time = std::chrono::steady_clock::now();
+            if (buf.size() < sizeof(fbo_msg_header_t)) {
+                continue;
+            }
             fbo_msg_header_t header;
-            char* buf_ptr = buf.data();
-            std::copy(buf_ptr, buf_ptr + sizeof(fbo_msg_header_t), reinterpret_cast<char*>(&header));
-            buf_ptr += sizeof(fbo_msg_header_t);
-            size_t fbo_depth_size;
-            auto vol =
-                (header.updated_area[2] - header.updated_area[0]) * (header.updated_area[3] - header.updated_area[1]);
-            size_t fbo_col_size = fbo_depth_size = static_cast<size_t>(vol);
-            fbo_col_size *= static_cast<size_t>(col_buf_el_size_);
-            fbo_depth_size *= static_cast<size_t>(depth_buf_el_size_);
-
-            if (header.depth_buf_size <= 1 || header.color_buf_size <= 1) {
+            std::copy(buf.data(), buf.data() + sizeof(fbo_msg_header_t), reinterpret_cast<char*>(&header));
+
+            fbo_tiling tiling;
+            tiling.width = header.screen_area[2] - header.screen_area[0];
+            tiling.height = header.screen_area[3] - header.screen_area[1];
+            tiling.tile_size = static_cast<int>(header.tile_size);
+            if (tiling.width <= 0 || tiling.height <= 0 || tiling.tile_size <= 0) {
 #if _DEBUG
                 megamol::core::utility::log::Log::DefaultLog.WriteWarn(
-                    "FBOCompositor2: Bad size for alloc color/depth; col_buf size: %d; col_comp_buf size: %d; "
-                    "depth_buf size: %d; depth_comp_buf size: %d;\n",
-                    fbo_col_size, header.color_buf_size, fbo_depth_size, header.depth_buf_size);
+                    "FBOCompositor2: Got message without image from node %zu\n", node);
 #endif
                 continue;
             }
 
-            std::vector<char> col_buf(fbo_col_size);
-            std::vector<char> col_comp_buf(header.color_buf_size);
-            std::copy(buf_ptr, buf_ptr + header.color_buf_size, col_comp_buf.begin());
-            buf_ptr += header.color_buf_size;
-            std::vector<char> depth_buf(fbo_depth_size);
-            std::vector<char> depth_comp_buf(header.depth_buf_size);
-            std::copy(buf_ptr, buf_ptr + header.depth_buf_size, depth_comp_buf.begin());
-
-            // snappy uncompress
-            snappy::RawUncompress(col_comp_buf.data(), col_comp_buf.size(), col_buf.data());
-            snappy::RawUncompress(depth_comp_buf.data(), depth_comp_buf.size(), depth_buf.data());
+            auto const key = header.base_frame_id == invalid_frame_id;
+            if ((!key && (header.base_frame_id != held_frame_id)) ||
+                !decoder.Decode(buf.data() + sizeof(fbo_msg_header_t), buf.size() - sizeof(fbo_msg_header_t),
+                    header.tile_count, tiling, key)) {
+                megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                    "FBOCompositor2: Could not decode frame %u of node %zu, requesting key frame\n", header.frame_id,
+                    node);
+                held_frame_id = invalid_frame_id;
+                continue;
+            }
+            held_frame_id = header.frame_id;
+            auto const decode_time = std::chrono::steady_clock::now();
 
-            /*std::vector<char> col_buf(fbo_col_size);
-            std::copy(buf_ptr, buf_ptr + fbo_col_size, col_buf.begin());
-            buf_ptr += fbo_col_size;
-            std::vector<char> depth_buf(fbo_depth_size);
-            std::copy(buf_ptr, buf_ptr + fbo_depth_size, depth_buf.begin());*/
+            std::vector<char> col_buf(decoder.Color());
+            std::vector<char> depth_buf(decoder.Depth());
 
 #ifdef _DEBUG
             megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-                "FBOCompositor2: Got message with col_buf size %d and depth_buf size %d\n", col_buf.size(),
-                depth_buf.size());
+                "FBOCompositor2: Got message with %u tiles, color payload %zu and depth payload %zu\n",
+                header.tile_count, header.color_buf_size, header.depth_buf_size);
 #endif
 
+            {
+                std::lock_guard<std::mutex> statistics_guard(this->statistics_guard_);
+                if (node < this->statistics_.size()) {
+                    auto& stats = this->statistics_[node];
+                    stats.messages += 1;
+                    stats.key_frames += key ? 1 : 0;
+                    stats.tiles += header.tile_count;
+                    stats.bytes += buf.size();
+                    stats.raw_bytes += col_buf.size() + depth_buf.size();
+                    stats.latency += std::chrono::duration<double, std::milli>(reply_time - request_time).count();
+                    stats.encode_time += header.encode_time / 1000.0;
+                    stats.decode_time += std::chrono::duration<double, std::milli>(decode_time - reply_time).count();
+                }
+            }
+
             auto const msg = fbo_msg{std::move(header), std::move(col_buf), std::move(depth_buf)};
 
             while (!shutdown_) {
@@ -536,6 +565,12 @@ void megamol::remote::FBOCompositor2::receiverJob(
 void megamol::remote::FBOCompositor2::collectorJob(std::vector<FBOCommFabric>&& comms) {
     try {
         auto const num_jobs = comms.size();
+        {
+            std::lock_guard<std::mutex> statistics_guard(this->statistics_guard_);
+            this->statistics_.assign(num_jobs, node_statistics{});
+        }
+        auto const collect_start = std::chrono::steady_clock::now();
+        auto report_start = collect_start;
         // initialize threads
         std::vector<std::thread> jobs;
         std::vector<core::utility::sys::FutureReset<fbo_msg_t>> fbo_msg_futures(num_jobs);
@@ -546,7 +581,7 @@ void megamol::remote::FBOCompositor2::collectorJob(std::vector<FBOCommFabric>&&
             auto close_sig_fut = close_sig.get_future();
             recv_close_sig.emplace_back(std::move(close_sig));
             // fbo_msg_futures.emplace_back();
-            jobs.emplace_back(&FBOCompositor2::receiverJob, this, std::ref(comm), fbo_msg_futures[i].GetPtr(),
+            jobs.emplace_back(&FBOCompositor2::receiverJob, this, std::ref(comm), i, fbo_msg_futures[i].GetPtr(),
                 std::move(close_sig_fut));
             i += 1;
         }
@@ -653,6 +688,13 @@ void megamol::remote::FBOCompositor2::collectorJob(std::vector<FBOCommFabric>&&
 #endif
 
             this->swapBuffers();
+
+            auto const now = std::chrono::steady_clock::now();
+            auto const report_interval = std::chrono::duration<double>(now - report_start).count();
+            if (report_interval >= 1.0) {
+                this->reportStatistics(report_interval, std::chrono::duration<double>(now - collect_start).count());
+                report_start = now;
+            }
         }
 
         // deinitialization
@@ -670,6 +712,51 @@ void megamol::remote::FBOCompositor2::collectorJob(std::vector<FBOCommFabric>&&
 }
 
 
+void megamol::remote::FBOCompositor2::reportStatistics(double seconds, double timestamp) {
+    std::vector<node_statistics> statistics;
+    {
+        std::lock_guard<std::mutex> statistics_guard(this->statistics_guard_);
+        statistics.resize(this->statistics_.size());
+        std::swap(statistics, this->statistics_);
+    }
+
+    auto const log = this->logStatisticsSlot_.Param<megamol::core::param::BoolParam>()->Value();
+    auto const path = this->statisticsFileSlot_.Param<megamol::core::param::FilePathParam>()->Value();
+    std::ofstream file;
+    if (!path.empty()) {
+        auto const exists = std::filesystem::exists(path);
+        file.open(path, std::ios::app);
+        if (!file) {
+            megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                "FBOCompositor2: Could not open statistics file %s\n", path.string().c_str());
+        } else if (!exists) {
+            file << "time,node,fps,key_frames,tiles_per_frame,mbytes_per_s,compression_ratio,latency_ms,"
+                    "encode_ms,decode_ms\n";
+        }
+    }
+
+    for (size_t node = 0; node < statistics.size(); ++node) {
+        auto const& stats = statistics[node];
+        auto const messages = static_cast<double>(std::max<size_t>(stats.messages, 1));
+        auto const fps = stats.messages / seconds;
+        auto const mbytes_per_s = stats.bytes / seconds / (1024.0 * 1024.0);
+        auto const ratio = stats.bytes > 0 ? static_cast<double>(stats.raw_bytes) / stats.bytes : 0.0;
+        if (log) {
+            megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+                "FBOCompositor2: Node %zu: %.1f fps, %.2f MB/s, ratio %.1f, %.1f tiles/frame, latency %.2f ms "
+                "(encode %.2f ms, decode %.2f ms)\n",
+                node, fps, mbytes_per_s, ratio, stats.tiles / messages, stats.latency / messages,
+                stats.encode_time / messages, stats.decode_time / messages);
+        }
+        if (file) {
+            file << timestamp << "," << node << "," << fps << "," << stats.key_frames << "," << stats.tiles / messages
+                 << "," << mbytes_per_s << "," << ratio << "," << stats.latency / messages << ","
+                 << stats.encode_time / messages << "," << stats.decode_time / messages << "\n";
+        }
+    }
+}
+
+
 void megamol::remote::FBOCompositor2::registerJob(std::vector<std::string>& addresses) {
     try {
         int const numNodes = this->numRendernodesSlot_.Param<megamol::core::param::IntParam>()->Value();
@@ -75,8 +75,8 @@ private:
         data_has_changed_.store(true);
     }
 
-    void receiverJob(
-        FBOCommFabric& comm, core::utility::sys::FutureReset<fbo_msg_t>* fbo_msg_future, std::future<bool>&& close);
+    void receiverJob(FBOCommFabric& comm, size_t node, core::utility::sys::FutureReset<fbo_msg_t>* fbo_msg_future,
+        std::future<bool>&& close);
 
     void collectorJob(std::vector<FBOCommFabric>&& comms);
 
@@ -94,6 +94,9 @@ private:
 
     bool startCallback(megamol::core::param::ParamSlot& p);
 
+    /** Logs and writes the statistics gathered over the last 'seconds' and resets them */
+    void reportStatistics(double seconds, double timestamp);
+
     static void RGBAtoRGB(std::vector<char> const& rgba, std::vector<unsigned char>& rgb);
 
     megamol::core::CalleeSlot provide_img_slot_;
@@ -124,6 +127,26 @@ private:
 
     megamol::core::param::ParamSlot renderOnlyRequestedFramesSlot_;
 
+    megamol::core::param::ParamSlot logStatisticsSlot_;
+
+    megamol::core::param::ParamSlot statisticsFileSlot_;
+
+    /** Transmission statistics of a render node */
+    struct node_statistics {
+        size_t messages = 0;
+        size_t key_frames = 0;
+        size_t tiles = 0;
+        size_t bytes = 0;
+        size_t raw_bytes = 0;
+        double latency = 0.0;
+        double encode_time = 0.0;
+        double decode_time = 0.0;
+    };
+
+    std::vector<node_statistics> statistics_;
+
+    std::mutex statistics_guard_;
+
     // megamol::core::utility::gl::FramebufferObject fbo_;
 
     std::thread collector_thread_;
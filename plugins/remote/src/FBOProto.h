@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <vector>
 
 
 namespace megamol {
@@ -87,6 +89,9 @@ using data_ptr = char*;
 
 using id_t = unsigned int;
 
+/** Frame id of a key frame's base, i.e. the message does not depend on a previous frame. */
+constexpr id_t invalid_frame_id = std::numeric_limits<id_t>::max();
+
 struct fbo_msg_header {
     // node id
     id_t node_id;
@@ -112,6 +117,14 @@ struct fbo_msg_header {
     size_t color_buf_size;
     // depth buf size
     size_t depth_buf_size;
+    // edge length of the tiles
+    unsigned int tile_size;
+    // number of tiles in the message
+    unsigned int tile_count;
+    // frame the tiles are encoded against, invalid_frame_id for key frames
+    id_t base_frame_id;
+    // time spent on encoding in microseconds
+    unsigned int encode_time;
 };
 
 using fbo_msg_header_t = fbo_msg_header;
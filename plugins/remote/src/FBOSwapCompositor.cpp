@@ -0,0 +1,365 @@
+#include "FBOSwapCompositor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#ifdef MEGAMOL_USE_MPI
+#include <mpi.h>
+#endif // MEGAMOL_USE_MPI
+
+#include "mmcore/utility/log/Log.h"
+
+
+megamol::remote::FBOSwapCompositor::~FBOSwapCompositor(void) {
+    this->Shutdown();
+}
+
+
+bool megamol::remote::FBOSwapCompositor::Init(FBOCommFabric::commtype type, int rank,
+    std::vector<std::string> const& peers, int radix, std::chrono::milliseconds timeout) {
+    this->Shutdown();
+
+    int size = static_cast<int>(peers.size());
+    if (type == FBOCommFabric::MPI_COMM) {
+#ifdef MEGAMOL_USE_MPI
+        int world_size = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+        size = (size > 0) ? std::min(size, world_size) : world_size;
+#else
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "FBOSwapCompositor: MPI communicator requested but MegaMol was built without MPI\n");
+        return false;
+#endif // MEGAMOL_USE_MPI
+    }
+    if ((size < 1) || (rank < 0) || (rank >= size)) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "FBOSwapCompositor: Rank %d is not within the %d peers\n", rank, size);
+        return false;
+    }
+
+    this->type_ = type;
+    this->rank_ = rank;
+    this->timeout_ = timeout;
+    this->radices_ = factorize(size, radix);
+    this->peers_.resize(size);
+
+    try {
+        if (type == FBOCommFabric::MPI_COMM) {
+            for (int p = 0; p < size; ++p) {
+                if (p != rank) {
+                    this->peers_[p] = std::make_unique<FBOCommFabric>(std::make_unique<MPICommFabric>(p, p));
+                }
+            }
+        } else {
+            // bind to all interfaces unless the address names a non-tcp endpoint
+            auto address = peers[rank];
+            auto const port = address.rfind(':');
+            if ((address.compare(0, 6, "tcp://") == 0) && (port != std::string::npos)) {
+                address = std::string{"tcp://*"} + address.substr(port);
+            }
+            this->inbox_ =
+                std::make_unique<FBOCommFabric>(std::make_unique<ZMQCommFabric>(zmq::socket_type::pull));
+            this->inbox_->Bind(address);
+            for (int p = 0; p < size; ++p) {
+                if (p != rank) {
+                    this->peers_[p] =
+                        std::make_unique<FBOCommFabric>(std::make_unique<ZMQCommFabric>(zmq::socket_type::push));
+                    this->peers_[p]->Connect(peers[p]);
+                }
+            }
+        }
+    } catch (zmq::error_t const& e) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "FBOSwapCompositor: Could not connect to peers: %s\n", e.what());
+        this->Shutdown();
+        return false;
+    }
+
+    this->size_ = size;
+    std::string radices;
+    for (auto const k : this->radices_) {
+        radices += (radices.empty() ? "" : "x") + std::to_string(k);
+    }
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "FBOSwapCompositor: Rank %d of %d compositing with radices %s\n", rank, size, radices.c_str());
+    return true;
+}
+
+
+void megamol::remote::FBOSwapCompositor::Shutdown(void) {
+    for (auto& peer : this->peers_) {
+        if (peer != nullptr) {
+            peer->Disconnect();
+        }
+    }
+    this->peers_.clear();
+    if (this->inbox_ != nullptr) {
+        this->inbox_->Disconnect();
+        this->inbox_.reset();
+    }
+    this->stash_.clear();
+    this->radices_.clear();
+    this->size_ = 0;
+}
+
+
+bool megamol::remote::FBOSwapCompositor::Composite(
+    std::vector<char>& color, std::vector<char>& depth, int width, int height) {
+    if (!this->IsInitialized()) {
+        return false;
+    }
+
+    auto const pixels = static_cast<uint32_t>(width) * static_cast<uint32_t>(height);
+    if ((color.size() < pixels * sizeof(uint32_t)) || (depth.size() < pixels * sizeof(float))) {
+        return false;
+    }
+    ++this->frame_;
+
+    // pieces of an aborted frame can never match again, those of this frame may have arrived early
+    this->stash_.erase(std::remove_if(this->stash_.begin(), this->stash_.end(),
+                           [this](std::vector<char> const& b) { return this->isStale(b); }),
+        this->stash_.end());
+
+    std::vector<char> buf;
+    uint32_t begin = 0, end = pixels;
+    int stride = 1;
+    for (uint32_t round = 0; round < this->radices_.size(); ++round) {
+        auto const k = this->radices_[round];
+        auto const digit = (this->rank_ / stride) % k;
+        auto const group = this->rank_ - digit * stride;
+        auto const n = end - begin;
+        auto piece = [&](int j) { return begin + static_cast<uint32_t>((static_cast<uint64_t>(n) * j) / k); };
+
+        // round-robin schedule of pairwise exchanges, the lower digit sends first to keep blocking sends apart
+        for (int r = 0; r < k; ++r) {
+            auto const other = (r - digit + k) % k;
+            if (other == digit) {
+                continue;
+            }
+            auto const peer = group + other * stride;
+            auto const send_piece = [&]() {
+                auto const offset = piece(other);
+                return this->send(peer, round, offset, piece(other + 1) - offset, color.data(), depth.data());
+            };
+            auto const recv_piece = [&]() {
+                if (!this->recv(peer, round, buf)) {
+                    return false;
+                }
+                swap_msg_header header;
+                std::memcpy(&header, buf.data(), sizeof(swap_msg_header));
+                if ((header.offset != piece(digit)) || (header.offset + header.count != piece(digit + 1))) {
+                    return false;
+                }
+                auto const payload = buf.data() + sizeof(swap_msg_header);
+                MergeDepth(reinterpret_cast<uint32_t*>(color.data()) + header.offset,
+                    reinterpret_cast<float*>(depth.data()) + header.offset,
+                    reinterpret_cast<uint32_t const*>(payload),
+                    reinterpret_cast<float const*>(payload + header.count * sizeof(uint32_t)), header.count);
+                return true;
+            };
+            if (digit < other) {
+                if (!send_piece() || !recv_piece()) {
+                    return false;
+                }
+            } else {
+                if (!recv_piece() || !send_piece()) {
+                    return false;
+                }
+            }
+        }
+
+        auto const next_begin = piece(digit);
+        end = piece(digit + 1);
+        begin = next_begin;
+        stride *= k;
+    }
+
+    // gather the pieces on rank 0
+    auto const gather = static_cast<uint32_t>(this->radices_.size());
+    if (this->rank_ != 0) {
+        return this->send(0, gather, begin, end - begin, color.data(), depth.data());
+    }
+    for (int peer = 1; peer < this->size_; ++peer) {
+        if (!this->recv(peer, gather, buf)) {
+            return false;
+        }
+        swap_msg_header header;
+        std::memcpy(&header, buf.data(), sizeof(swap_msg_header));
+        if (header.offset + header.count > pixels) {
+            return false;
+        }
+        auto const payload = buf.data() + sizeof(swap_msg_header);
+        std::memcpy(color.data() + header.offset * sizeof(uint32_t), payload, header.count * sizeof(uint32_t));
+        std::memcpy(depth.data() + header.offset * sizeof(float), payload + header.count * sizeof(uint32_t),
+            header.count * sizeof(float));
+    }
+    return true;
+}
+
+
+void megamol::remote::FBOSwapCompositor::MergeDepth(
+    uint32_t* color, float* depth, uint32_t const* in_color, float const* in_depth, size_t count) {
+    size_t i = 0;
+#if defined(__AVX__)
+    for (; i + 8 <= count; i += 8) {
+        auto const d = _mm256_loadu_ps(depth + i);
+        auto const e = _mm256_loadu_ps(in_depth + i);
+        auto const closer = _mm256_cmp_ps(e, d, _CMP_LT_OQ);
+        auto const c = _mm256_loadu_ps(reinterpret_cast<float const*>(color + i));
+        auto const f = _mm256_loadu_ps(reinterpret_cast<float const*>(in_color + i));
+        _mm256_storeu_ps(depth + i, _mm256_blendv_ps(d, e, closer));
+        _mm256_storeu_ps(reinterpret_cast<float*>(color + i), _mm256_blendv_ps(c, f, closer));
+    }
+#endif
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    for (; i + 4 <= count; i += 4) {
+        auto const d = _mm_loadu_ps(depth + i);
+        auto const e = _mm_loadu_ps(in_depth + i);
+        auto const closer = _mm_cmplt_ps(e, d);
+        auto const mask = _mm_castps_si128(closer);
+        auto const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(color + i));
+        auto const f = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in_color + i));
+        _mm_storeu_ps(depth + i, _mm_or_ps(_mm_and_ps(closer, e), _mm_andnot_ps(closer, d)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(color + i),
+            _mm_or_si128(_mm_and_si128(mask, f), _mm_andnot_si128(mask, c)));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (in_depth[i] < depth[i]) {
+            depth[i] = in_depth[i];
+            color[i] = in_color[i];
+        }
+    }
+}
+
+
+std::vector<int> megamol::remote::FBOSwapCompositor::factorize(int size, int radix) {
+    // prime factors, merged greedily into groups not exceeding the radix; larger primes form a group on their own
+    std::vector<int> primes;
+    for (int p = 2; p * p <= size; ++p) {
+        while (size % p == 0) {
+            primes.push_back(p);
+            size /= p;
+        }
+    }
+    if (size > 1) {
+        primes.push_back(size);
+    }
+
+    std::vector<int> radices;
+    for (auto it = primes.rbegin(); it != primes.rend(); ++it) {
+        auto merged = false;
+        for (auto& k : radices) {
+            if (k * *it <= radix) {
+                k *= *it;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            radices.push_back(*it);
+        }
+    }
+    return radices;
+}
+
+
+bool megamol::remote::FBOSwapCompositor::send(
+    int peer, uint32_t round, uint32_t offset, uint32_t count, char const* color, char const* depth) {
+    swap_msg_header header{this->frame_, round, static_cast<uint32_t>(this->rank_), offset, count};
+    std::vector<char> buf(sizeof(swap_msg_header) + count * (sizeof(uint32_t) + sizeof(float)));
+    std::memcpy(buf.data(), &header, sizeof(swap_msg_header));
+    std::memcpy(buf.data() + sizeof(swap_msg_header), color + offset * sizeof(uint32_t), count * sizeof(uint32_t));
+    std::memcpy(buf.data() + sizeof(swap_msg_header) + count * sizeof(uint32_t), depth + offset * sizeof(float),
+        count * sizeof(float));
+    try {
+        if (this->peers_[peer]->Send(buf, send_type::SEND)) {
+            return true;
+        }
+    } catch (zmq::error_t const& e) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "FBOSwapCompositor: Exception during send to rank %d: %s\n", peer, e.what());
+        return false;
+    }
+    megamol::core::utility::log::Log::DefaultLog.WriteError("FBOSwapCompositor: Send to rank %d failed\n", peer);
+    return false;
+}
+
+
+bool megamol::remote::FBOSwapCompositor::recv(int peer, uint32_t round, std::vector<char>& buf) {
+    if (this->type_ == FBOCommFabric::MPI_COMM) {
+        // MPI delivers the messages of a peer in order
+        if (!this->peers_[peer]->Poll(this->timeout_)) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError(
+                "FBOSwapCompositor: Rank %d did not answer in round %u\n", peer, round);
+            return false;
+        }
+        if (this->peers_[peer]->Recv(buf, recv_type::RECV) && this->matches(buf, peer, round)) {
+            return true;
+        }
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "FBOSwapCompositor: Unexpected message from rank %d in round %u\n", peer, round);
+        return false;
+    }
+
+    for (auto it = this->stash_.begin(); it != this->stash_.end(); ++it) {
+        if (this->matches(*it, peer, round)) {
+            buf = std::move(*it);
+            this->stash_.erase(it);
+            return true;
+        }
+    }
+
+    auto const deadline = std::chrono::steady_clock::now() + this->timeout_;
+    try {
+        for (auto now = std::chrono::steady_clock::now(); now < deadline; now = std::chrono::steady_clock::now()) {
+            // round up, a zero timeout would only check for pending messages
+            auto const remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            if (!this->inbox_->Poll(remaining) || !this->inbox_->Recv(buf, recv_type::RECV)) {
+                continue;
+            }
+            if (this->matches(buf, peer, round)) {
+                return true;
+            }
+            // pieces of later rounds or frames may arrive early, those of earlier frames are outdated
+            if (!this->isStale(buf)) {
+                this->stash_.push_back(std::move(buf));
+            }
+        }
+    } catch (zmq::error_t const& e) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError(
+            "FBOSwapCompositor: Exception during recv from rank %d: %s\n", peer, e.what());
+        return false;
+    }
+
+    megamol::core::utility::log::Log::DefaultLog.WriteError(
+        "FBOSwapCompositor: Rank %d did not answer in round %u\n", peer, round);
+    return false;
+}
+
+
+bool megamol::remote::FBOSwapCompositor::matches(std::vector<char> const& buf, int peer, uint32_t round) const {
+    if (buf.size() < sizeof(swap_msg_header)) {
+        return false;
+    }
+    swap_msg_header header;
+    std::memcpy(&header, buf.data(), sizeof(swap_msg_header));
+    return (header.frame == this->frame_) && (header.round == round) &&
+           (header.sender == static_cast<uint32_t>(peer)) &&
+           (buf.size() == sizeof(swap_msg_header) + header.count * (sizeof(uint32_t) + sizeof(float)));
+}
+
+
+bool megamol::remote::FBOSwapCompositor::isStale(std::vector<char> const& buf) const {
+    if (buf.size() < sizeof(swap_msg_header)) {
+        return true;
+    }
+    swap_msg_header header;
+    std::memcpy(&header, buf.data(), sizeof(swap_msg_header));
+    return static_cast<int32_t>(header.frame - this->frame_) < 0;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FBOCommFabric.h"
+
+namespace megamol {
+namespace remote {
+
+/**
+ * Header of the image pieces exchanged during swap compositing.
+ */
+struct swap_msg_header {
+    // composite call the piece belongs to
+    uint32_t frame;
+    // round of the exchange, the number of rounds denotes the final gather
+    uint32_t round;
+    // rank of the sender
+    uint32_t sender;
+    // first pixel of the piece
+    uint32_t offset;
+    // number of pixels, followed by as many RGBAu8 and Df values
+    uint32_t count;
+};
+
+/**
+ * Sort-last depth compositing of the RGBAu8/Df frames of several render
+ * nodes with radix-k, which is binary-swap if all radices are 2.
+ *
+ * The node count is factored into radices no larger than the requested one.
+ * In each round the nodes form groups of k, split the pixel range they are
+ * responsible for into k pieces, exchange the pieces and merge the received
+ * ones by depth test, so every node ends up with 1/N of the image and every
+ * node sends and receives about one image in total. Finally, the pieces are
+ * gathered on rank 0. The depth test is order-independent, hence pieces are
+ * merged in the order of arrival.
+ *
+ * The peers are reached through FBOCommFabric, either via ZMQ, where every
+ * rank binds a pull socket at its address and pushes to the others, or via
+ * MPI ranks. Using ipc:// or tcp://127.0.0.1 addresses, all ranks can run as
+ * local processes.
+ */
+class FBOSwapCompositor {
+public:
+    FBOSwapCompositor(void) = default;
+
+    FBOSwapCompositor(FBOSwapCompositor const& rhs) = delete;
+
+    FBOSwapCompositor& operator=(FBOSwapCompositor const& rhs) = delete;
+
+    ~FBOSwapCompositor(void);
+
+    /**
+     * Connects to the peers.
+     *
+     * @param type    The communicator to use.
+     * @param rank    The rank of this node, ignored for MPI.
+     * @param peers   The ZMQ addresses of all ranks in rank order, for MPI only the number of entries counts, an
+     *                empty list uses all ranks of MPI_COMM_WORLD.
+     * @param radix   The maximum group size per round, 2 selects binary-swap.
+     * @param timeout The time to wait for a peer before giving up on a frame.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool Init(FBOCommFabric::commtype type, int rank, std::vector<std::string> const& peers, int radix,
+        std::chrono::milliseconds timeout);
+
+    /** Disconnects from the peers. */
+    void Shutdown(void);
+
+    /**
+     * Composites the frames of all ranks. On rank 0, 'color' and 'depth'
+     * hold the composited frame afterwards, on the other ranks their content
+     * is undefined.
+     *
+     * @return 'true' on success, 'false' if a peer did not answer in time.
+     */
+    bool Composite(std::vector<char>& color, std::vector<char>& depth, int width, int height);
+
+    bool IsInitialized(void) const {
+        return this->size_ > 0;
+    }
+
+    int Rank(void) const {
+        return this->rank_;
+    }
+
+    int Size(void) const {
+        return this->size_;
+    }
+
+    /**
+     * Merges 'count' pixels by depth test, the incoming pixel wins if it is
+     * strictly closer.
+     */
+    static void MergeDepth(
+        uint32_t* color, float* depth, uint32_t const* in_color, float const* in_depth, size_t count);
+
+private:
+    /** Answer the radices of the rounds for 'size' ranks with groups of at most 'radix' ranks. */
+    static std::vector<int> factorize(int size, int radix);
+
+    /** Sends pixels [offset, offset + count) of the frame to 'peer'. */
+    bool send(int peer, uint32_t round, uint32_t offset, uint32_t count, char const* color, char const* depth);
+
+    /** Receives the piece of 'round' sent by 'peer'. */
+    bool recv(int peer, uint32_t round, std::vector<char>& buf);
+
+    /** Answer whether 'buf' is the piece of the current frame from 'peer' in 'round'. */
+    bool matches(std::vector<char> const& buf, int peer, uint32_t round) const;
+
+    /** Answer whether 'buf' belongs to a frame before the current one. */
+    bool isStale(std::vector<char> const& buf) const;
+
+    FBOCommFabric::commtype type_ = FBOCommFabric::ZMQ_COMM;
+
+    int rank_ = 0;
+
+    int size_ = 0;
+
+    std::vector<int> radices_;
+
+    std::chrono::milliseconds timeout_{0};
+
+    uint32_t frame_ = 0;
+
+    /** One channel per peer, used for sending with ZMQ and for both directions with MPI */
+    std::vector<std::unique_ptr<FBOCommFabric>> peers_;
+
+    /** The pull socket all ZMQ peers push to */
+    std::unique_ptr<FBOCommFabric> inbox_;
+
+    /** Messages that arrived on 'inbox_' before they were expected */
+    std::vector<std::vector<char>> stash_;
+};
+
+} // end namespace remote
+} // end namespace megamol
@@ -1,11 +1,12 @@
 #include "FBOTransmitter2.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <sstream>
 
 #include "glad/glad.h"
 
-#include "snappy.h"
-
 #include "mmcore/utility/log/Log.h"
 
 #include "cluster/mpi/MpiCall.h"
@@ -38,6 +39,18 @@ megamol::remote::FBOTransmitter2::FBOTransmitter2()
         , handshake_port_slot_{"handshakePort", "Port for zmq handshake"}
         , reconnect_slot_{"reconnect", "Reconnect comm threads"}
         , tiled_slot_("tiledDisplay", "True if rendering on a tiled display")
+        , tile_size_slot_{"tileSize", "Edge length of the tiles checked for changes"}
+        , color_codec_slot_{"colorCodec", "Codec for the color tiles"}
+        , depth_codec_slot_{"depthCodec", "Codec for the depth tiles"}
+        , frame_budget_slot_{"frameBudget", "Size of a frame in KB above which adaptive codecs become lossy"}
+        , swap_slot_{"swapComposite", "Composite the FBOs of all render nodes by binary-swap/radix-k before rank 0 "
+                                      "transmits the result"}
+        , swap_comm_slot_{"swapCommunicator", "Select the communicator between the render nodes"}
+        , swap_rank_slot_{"swapRank", "Rank of this render node for ZMQ swap compositing"}
+        , swap_peers_slot_{"swapPeers", "Addresses of all render nodes in rank order separated by ';', for MPI an "
+                                        "empty list uses all ranks"}
+        , swap_radix_slot_{"swapRadix", "Maximum number of render nodes exchanging pieces per round, 2 is binary-swap"}
+        , swap_timeout_slot_{"swapTimeout", "Time in ms to wait for another render node before dropping a frame"}
 #ifdef MEGAMOL_USE_MPI
         , callRequestMpi("requestMpi", "Requests initialisation of MPI and the communicator for the view.")
         , toggle_aggregate_slot_{"aggregate", "Toggle whether to aggregate and composite FBOs prior to transmission"}
@@ -46,12 +59,14 @@ megamol::remote::FBOTransmitter2::FBOTransmitter2()
         , aggregate_{false}
         , frame_id_{0}
         , thread_stop_{false}
-        , fbo_msg_read_{new fbo_msg_header_t}
-        , fbo_msg_send_{new fbo_msg_header_t}
+        , fbo_msg_read_{new fbo_msg_header_t{}}
+        , fbo_msg_send_{new fbo_msg_header_t{}}
         , color_buf_read_{new std::vector<char>}
         , depth_buf_read_{new std::vector<char>}
         , color_buf_send_{new std::vector<char>}
         , depth_buf_send_{new std::vector<char>}
+        , encoded_frame_id_{invalid_frame_id}
+        , bytes_per_pixel_{2.0f, 1.0f, 2.0f, 1.0f}
         , col_buf_el_size_{4}
         , depth_buf_el_size_{4}
         , connected_{false}
@@ -90,6 +105,39 @@ megamol::remote::FBOTransmitter2::FBOTransmitter2()
 
     tiled_slot_ << new megamol::core::param::BoolParam(false);
     this->MakeSlotAvailable(&tiled_slot_);
+
+    tile_size_slot_ << new megamol::core::param::IntParam(64, 8, 1024);
+    this->MakeSlotAvailable(&tile_size_slot_);
+    auto color_ep = new megamol::core::param::EnumParam(CODEC_ADAPTIVE);
+    color_ep->SetTypePair(CODEC_LOSSLESS, "Snappy");
+    color_ep->SetTypePair(CODEC_LOSSY, "RGB565");
+    color_ep->SetTypePair(CODEC_ADAPTIVE, "Adaptive");
+    color_codec_slot_ << color_ep;
+    this->MakeSlotAvailable(&color_codec_slot_);
+    auto depth_ep = new megamol::core::param::EnumParam(CODEC_ADAPTIVE);
+    depth_ep->SetTypePair(CODEC_LOSSLESS, "Snappy");
+    depth_ep->SetTypePair(CODEC_LOSSY, "Quantized");
+    depth_ep->SetTypePair(CODEC_ADAPTIVE, "Adaptive");
+    depth_codec_slot_ << depth_ep;
+    this->MakeSlotAvailable(&depth_codec_slot_);
+    frame_budget_slot_ << new megamol::core::param::IntParam(4096, 1);
+    this->MakeSlotAvailable(&frame_budget_slot_);
+
+    swap_slot_ << new megamol::core::param::BoolParam(false);
+    this->MakeSlotAvailable(&swap_slot_);
+    auto swap_ep = new megamol::core::param::EnumParam(FBOCommFabric::ZMQ_COMM);
+    swap_ep->SetTypePair(FBOCommFabric::ZMQ_COMM, "ZMQ");
+    swap_ep->SetTypePair(FBOCommFabric::MPI_COMM, "MPI");
+    swap_comm_slot_ << swap_ep;
+    this->MakeSlotAvailable(&swap_comm_slot_);
+    swap_rank_slot_ << new megamol::core::param::IntParam(0, 0);
+    this->MakeSlotAvailable(&swap_rank_slot_);
+    swap_peers_slot_ << new megamol::core::param::StringParam{""};
+    this->MakeSlotAvailable(&swap_peers_slot_);
+    swap_radix_slot_ << new megamol::core::param::IntParam(4, 2);
+    this->MakeSlotAvailable(&swap_radix_slot_);
+    swap_timeout_slot_ << new megamol::core::param::IntParam(5000, 1);
+    this->MakeSlotAvailable(&swap_timeout_slot_);
 }
 
 
@@ -108,20 +156,28 @@ bool megamol::remote::FBOTransmitter2::create() {
 
 void megamol::remote::FBOTransmitter2::release() {
     shutdownThreads();
+    swap_.Shutdown();
 }
 
 
 void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::AbstractView* view) {
 
+    // with swap compositing, only rank 0 talks to the compositor
+    bool const swap = this->initSwap();
+    bool const transmit = !swap || (this->swap_.Rank() == 0);
+
 #ifdef MEGAMOL_USE_MPI
-    if (!this->render_comp_img_slot_.Param<core::param::BoolParam>()->Value()) {
+    bool const aggregate = aggregate_ && !swap;
+    if (!this->render_comp_img_slot_.Param<core::param::BoolParam>()->Value() && transmit) {
         initThreads();
 #if _DEBUG
         megamol::core::utility::log::Log::DefaultLog.WriteInfo("FBOTransmitter2: initThreads ... Done");
 #endif
     }
 #else
-    initThreads();
+    if (transmit) {
+        initThreads();
+    }
 #endif
 
     if (!this->validViewport) {
@@ -157,6 +213,12 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
         std::vector<char> col_buf_tile(tile_width * tile_height * col_buf_el_size_);
         std::vector<char> depth_buf_tile(tile_width * tile_height * depth_buf_el_size_);
 
+        if (swap) {
+            // pixels outside of the tile must not win the depth test
+            auto const far_plane = reinterpret_cast<float*>(depth_buf.data());
+            std::fill(far_plane, far_plane + width * height, 1.0f);
+        }
+
         glReadPixels(0, 0, tile_width, tile_height, GL_RGBA, GL_UNSIGNED_BYTE, col_buf_tile.data());
         glReadPixels(0, 0, tile_width, tile_height, GL_DEPTH_COMPONENT, GL_FLOAT, depth_buf_tile.data());
 
@@ -180,12 +242,23 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
     megamol::core::utility::log::Log::DefaultLog.WriteInfo("FBOTransmitter2: readFBO ... Done");
 #endif
 
+    if (swap) {
+        if (!this->swap_.Composite(col_buf, depth_buf, width, height)) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError(
+                "FBOTransmitter2: Swap compositing failed, dropping frame\n");
+            return;
+        }
+        if (!transmit) {
+            return;
+        }
+    }
+
 
 #ifdef MEGAMOL_USE_MPI
     IceTUByte* icet_col_buf = reinterpret_cast<IceTUByte*>(col_buf.data());
     IceTFloat* icet_depth_buf = reinterpret_cast<IceTFloat*>(depth_buf.data());
 
-    if (aggregate_) {
+    if (aggregate) {
 #if _DEBUG
         megamol::core::utility::log::Log::DefaultLog.WriteInfo(
             "FBOTransmitter2: Simple IceT commit at rank %d\n", mpiRank);
@@ -217,7 +290,7 @@ void megamol::remote::FBOTransmitter2::AfterRender(megamol::core::view::Abstract
         }
     }
 
-    if ((aggregate_ && mpiRank == 0) || !aggregate_) {
+    if ((aggregate && mpiRank == 0) || !aggregate) {
 #endif // MEGAMOL_USE_MPI
 
 
@@ -320,58 +393,58 @@ void megamol::remote::FBOTransmitter2::transmitterJob() {
             {
                 std::lock_guard<std::mutex> send_lock(this->buffer_send_guard_);
 
-                //#ifdef MEGAMOL_USE_MPI
-                //            IceTUByte* icet_col_buf = nullptr;
-                //            IceTFloat* icet_depth_buf = nullptr;
-                //            if (aggregate_) {
-                //#if _DEBUG
-                //                megamol::core::utility::log::Log::DefaultLog.WriteInfo("FBOTransmitter2: Complex IceT commit at rank
-                //                %d\n", rank_);
-                //#endif
-                //                std::array<IceTFloat, 4> backgroundColor = {0, 0, 0, 0};
-                //                auto const icet_comp_image = icetCompositeImage(this->color_buf_send_->data(),
-                //                    this->depth_buf_send_->data(), nullptr, nullptr, nullptr, backgroundColor.data());
-                //#if _DEBUG
-                //                megamol::core::utility::log::Log::DefaultLog.WriteInfo("FBOTransmitter2: Recieved IceT image at rank
-                //                %d\n", rank_);
-                //#endif
-                //                icet_col_buf = icetImageGetColorub(icet_comp_image);
-                //                icet_depth_buf = icetImageGetDepthf(icet_comp_image);
-                //            }
-                //#endif
-
-                // snappy compression
-                std::vector<char> col_comp_buf(snappy::MaxCompressedLength(this->color_buf_send_->size()));
-                std::vector<char> depth_comp_buf(snappy::MaxCompressedLength(this->depth_buf_send_->size()));
+                // the compositor names the frame it holds, tiles are sent relative to it if it is our reference
+                id_t base_frame_id = invalid_frame_id;
+                if ((buf.size() >= 3 + sizeof(id_t)) && (buf[0] == 'r')) {
+                    std::copy(buf.data() + 3, buf.data() + 3 + sizeof(id_t), reinterpret_cast<char*>(&base_frame_id));
+                }
+
+                auto const encode_start = std::chrono::steady_clock::now();
+                fbo_tiling tiling;
+                tiling.width = fbo_msg_send_->screen_area[2] - fbo_msg_send_->screen_area[0];
+                tiling.height = fbo_msg_send_->screen_area[3] - fbo_msg_send_->screen_area[1];
+                tiling.tile_size = this->tile_size_slot_.Param<megamol::core::param::IntParam>()->Value();
+                auto const pixels = static_cast<size_t>(tiling.width) * tiling.height;
+                if ((this->color_buf_send_->size() != pixels * col_buf_el_size_) ||
+                    (this->depth_buf_send_->size() != pixels * depth_buf_el_size_)) {
+                    // nothing rendered yet
+                    tiling.width = tiling.height = 0;
+                }
+
+                auto const key = (base_frame_id == invalid_frame_id) || (base_frame_id != this->encoded_frame_id_);
+                auto const dirty_tiles = this->encoder_.Update(
+                    this->color_buf_send_->data(), this->depth_buf_send_->data(), tiling, key);
+                fbo_color_codec color_codec;
+                fbo_depth_codec depth_codec;
+                this->selectCodecs(dirty_tiles, tiling, color_codec, depth_codec);
+
+                // compose message from header and tiles
                 size_t col_comp_size = 0;
                 size_t depth_comp_size = 0;
-
-                // if (aggregate_) {
-                //    snappy::RawCompress(reinterpret_cast<char*>(icet_col_buf), this->color_buf_send_->size(),
-                //        col_comp_buf.data(), &col_comp_size);
-                //    snappy::RawCompress(reinterpret_cast<char*>(icet_depth_buf), this->depth_buf_send_->size(),
-                //        depth_comp_buf.data(), &depth_comp_size);
-                //} else {
-                snappy::RawCompress(
-                    this->color_buf_send_->data(), this->color_buf_send_->size(), col_comp_buf.data(), &col_comp_size);
-                snappy::RawCompress(this->depth_buf_send_->data(), this->depth_buf_send_->size(), depth_comp_buf.data(),
-                    &depth_comp_size);
-                //}
+                buf.resize(sizeof(fbo_msg_header_t));
+                auto const tile_count = this->encoder_.Encode(color_codec, depth_codec, buf, col_comp_size,
+                    depth_comp_size);
+                this->encoded_frame_id_ = fbo_msg_send_->frame_id;
+
+                if (tile_count > 0) {
+                    auto const encoded = static_cast<float>(tile_count) * tiling.tile_size * tiling.tile_size;
+                    auto& color_bpp = this->bytes_per_pixel_[color_codec];
+                    auto& depth_bpp = this->bytes_per_pixel_[2 + depth_codec];
+                    color_bpp = 0.75f * color_bpp + 0.25f * (col_comp_size / encoded);
+                    depth_bpp = 0.75f * depth_bpp + 0.25f * (depth_comp_size / encoded);
+                }
 
                 fbo_msg_send_->color_buf_size = col_comp_size;
                 fbo_msg_send_->depth_buf_size = depth_comp_size;
-                // compose message from header, color_buf, and depth_buf
-                buf.resize(sizeof(fbo_msg_header_t) + col_comp_size + depth_comp_size);
+                fbo_msg_send_->tile_size = tiling.tile_size;
+                fbo_msg_send_->tile_count = tile_count;
+                fbo_msg_send_->base_frame_id = this->encoder_.IsKey() ? invalid_frame_id : base_frame_id;
+                fbo_msg_send_->encode_time = static_cast<unsigned int>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - encode_start)
+                        .count());
                 std::copy(reinterpret_cast<char*>(&(*fbo_msg_send_)),
                     reinterpret_cast<char*>(&(*fbo_msg_send_)) + sizeof(fbo_msg_header_t), buf.data());
-                /*std::copy(
-                    this->color_buf_send_->begin(), this->color_buf_send_->end(), buf.data() +
-                sizeof(fbo_msg_header_t)); std::copy(this->depth_buf_send_->begin(), this->depth_buf_send_->end(),
-                    buf.data() + sizeof(fbo_msg_header_t) + this->color_buf_send_->size());*/
-                std::copy(
-                    col_comp_buf.data(), col_comp_buf.data() + col_comp_size, buf.data() + sizeof(fbo_msg_header_t));
-                std::copy(depth_comp_buf.data(), depth_comp_buf.data() + depth_comp_size,
-                    buf.data() + sizeof(fbo_msg_header_t) + col_comp_size);
 
                 // send data
                 try {
@@ -402,6 +475,67 @@ void megamol::remote::FBOTransmitter2::transmitterJob() {
 }
 
 
+void megamol::remote::FBOTransmitter2::selectCodecs(
+    size_t tiles, fbo_tiling const& tiling, fbo_color_codec& color_codec, fbo_depth_codec& depth_codec) const {
+    auto const color_mode = this->color_codec_slot_.Param<megamol::core::param::EnumParam>()->Value();
+    auto const depth_mode = this->depth_codec_slot_.Param<megamol::core::param::EnumParam>()->Value();
+    color_codec = (color_mode == CODEC_LOSSY) ? COLOR_RGB565 : COLOR_SNAPPY;
+    depth_codec = (depth_mode == CODEC_LOSSY) ? DEPTH_QUANTIZED : DEPTH_SNAPPY;
+
+    // estimate the message size from the compression ratios seen so far, depth precision is given up first
+    auto const budget = this->frame_budget_slot_.Param<megamol::core::param::IntParam>()->Value() * 1024.0f;
+    auto const pixels = static_cast<float>(tiles) * tiling.tile_size * tiling.tile_size;
+    auto estimate = [&]() {
+        return pixels * (this->bytes_per_pixel_[color_codec] + this->bytes_per_pixel_[2 + depth_codec]);
+    };
+    if ((depth_mode == CODEC_ADAPTIVE) && (estimate() > budget)) {
+        depth_codec = DEPTH_QUANTIZED;
+    }
+    if ((color_mode == CODEC_ADAPTIVE) && (estimate() > budget)) {
+        color_codec = COLOR_RGB565;
+    }
+}
+
+
+bool megamol::remote::FBOTransmitter2::initSwap() {
+    using megamol::core::param::IntParam;
+
+    if (!this->swap_slot_.Param<megamol::core::param::BoolParam>()->Value()) {
+        if (this->swap_.IsInitialized()) {
+            this->swap_.Shutdown();
+        }
+        return false;
+    }
+
+    auto const dirty = this->swap_slot_.IsDirty() || this->swap_comm_slot_.IsDirty() ||
+                       this->swap_rank_slot_.IsDirty() || this->swap_peers_slot_.IsDirty() ||
+                       this->swap_radix_slot_.IsDirty() || this->swap_timeout_slot_.IsDirty();
+    if (!dirty) {
+        return this->swap_.IsInitialized();
+    }
+    this->swap_slot_.ResetDirty();
+    this->swap_comm_slot_.ResetDirty();
+    this->swap_rank_slot_.ResetDirty();
+    this->swap_peers_slot_.ResetDirty();
+    this->swap_radix_slot_.ResetDirty();
+    this->swap_timeout_slot_.ResetDirty();
+
+    std::vector<std::string> peers;
+    std::stringstream ss(std::string(T2A(this->swap_peers_slot_.Param<megamol::core::param::StringParam>()->Value())));
+    std::string peer;
+    while (std::getline(ss, peer, ';')) {
+        if (!peer.empty()) {
+            peers.push_back(peer);
+        }
+    }
+
+    return this->swap_.Init(
+        static_cast<FBOCommFabric::commtype>(this->swap_comm_slot_.Param<megamol::core::param::EnumParam>()->Value()),
+        this->swap_rank_slot_.Param<IntParam>()->Value(), peers, this->swap_radix_slot_.Param<IntParam>()->Value(),
+        std::chrono::milliseconds(this->swap_timeout_slot_.Param<IntParam>()->Value()));
+}
+
+
 bool megamol::remote::FBOTransmitter2::triggerButtonClicked(megamol::core::param::ParamSlot& slot) {
     // happy trigger finger hit button action happened
     using megamol::core::utility::log::Log;
@@ -618,7 +752,8 @@ bool megamol::remote::FBOTransmitter2::initThreads() {
 #endif
 #ifdef MEGAMOL_USE_MPI
 
-        if ((aggregate_ && mpiRank == 0) || !aggregate_) {
+        bool const aggregate = aggregate_ && !this->swap_.IsInitialized();
+        if ((aggregate && mpiRank == 0) || !aggregate) {
 #ifdef _DEBUG
             megamol::core::utility::log::Log::DefaultLog.WriteInfo("FBOTransmitter2: Connecting rank %d\n", mpiRank);
 #endif
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <memory>
@@ -10,8 +11,10 @@
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
 
+#include "FBOCodec.h"
 #include "FBOCommFabric.h"
 #include "FBOProto.h"
+#include "FBOSwapCompositor.h"
 #include "mmcore/CallerSlot.h"
 #include "mmstd/view/AbstractView.h"
 #include "vislib/graphics/gl/FramebufferObject.h"
@@ -96,6 +99,22 @@ private:
 
     bool shutdownThreads();
 
+    /**
+     * Chooses the codecs for 'tiles' dirty tiles of 'tiling'. Adaptive
+     * codecs fall back to lossy compression if the frame is expected to
+     * exceed the frame budget.
+     */
+    void selectCodecs(size_t tiles, fbo_tiling const& tiling, fbo_color_codec& color_codec,
+        fbo_depth_codec& depth_codec) const;
+
+    /**
+     * (Re-)initialises the swap compositor if it is enabled and its
+     * parameters changed.
+     *
+     * @return 'true' if frames are to be swap-composited, 'false' otherwise.
+     */
+    bool initSwap();
+
     megamol::core::param::ParamSlot address_slot_;
 
     megamol::core::param::ParamSlot commSelectSlot_;
@@ -114,6 +133,29 @@ private:
 
     megamol::core::param::ParamSlot tiled_slot_;
 
+    megamol::core::param::ParamSlot tile_size_slot_;
+
+    megamol::core::param::ParamSlot color_codec_slot_;
+
+    megamol::core::param::ParamSlot depth_codec_slot_;
+
+    megamol::core::param::ParamSlot frame_budget_slot_;
+
+    megamol::core::param::ParamSlot swap_slot_;
+
+    megamol::core::param::ParamSlot swap_comm_slot_;
+
+    megamol::core::param::ParamSlot swap_rank_slot_;
+
+    megamol::core::param::ParamSlot swap_peers_slot_;
+
+    megamol::core::param::ParamSlot swap_radix_slot_;
+
+    megamol::core::param::ParamSlot swap_timeout_slot_;
+
+    /** Composites the frames of all render nodes before rank 0 transmits them, only used in AfterRender */
+    FBOSwapCompositor swap_;
+
     bool aggregate_;
 
 #ifdef MEGAMOL_USE_MPI
@@ -161,6 +203,15 @@ private:
 
     std::unique_ptr<std::vector<char>> depth_buf_send_;
 
+    /** Encodes the dirty tiles of the send buffers, only used by the transmitter thread */
+    FBOTileEncoder encoder_;
+
+    /** The frame the encoder reference holds */
+    id_t encoded_frame_id_;
+
+    /** Encoded bytes per pixel of the color codecs followed by the depth codecs */
+    std::array<float, 4> bytes_per_pixel_;
+
     std::unique_ptr<AbstractCommFabric> comm_impl_;
 
     std::unique_ptr<FBOCommFabric> comm_;
@@ -0,0 +1,171 @@
+/*
+ * SwapCompositorTest.cpp
+ *
+ * Composites random frames of several local processes with FBOSwapCompositor
+ * and compares the result on rank 0 with a serial depth composite of the same
+ * frames.
+ *
+ * Usage: remote_swap_compositor_test [ranks [base port]]
+ *        The launcher starts one process per rank communicating via ZMQ on
+ *        tcp://127.0.0.1, each running
+ *        remote_swap_compositor_test --rank <rank> <ranks> <base port>
+ *
+ *        mpiexec -n <ranks> remote_swap_compositor_test --mpi
+ *        Uses the MPI ranks instead if MegaMol was built with MPI.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef MEGAMOL_USE_MPI
+#include <mpi.h>
+#endif // MEGAMOL_USE_MPI
+
+#include "FBOSwapCompositor.h"
+
+using megamol::remote::FBOCommFabric;
+using megamol::remote::FBOSwapCompositor;
+
+namespace {
+
+/** Odd sizes so that the pieces of the rounds do not divide evenly */
+constexpr int width = 67;
+constexpr int height = 43;
+
+constexpr int frames = 3;
+
+constexpr int max_ranks = 16;
+
+/**
+ * Fills the frame of 'rank'. The depth values of all ranks are distinct and
+ * exactly representable, hence the composite does not depend on the order
+ * the pieces are merged in.
+ */
+void makeFrame(int rank, int ranks, int frame, std::vector<char>& color, std::vector<char>& depth) {
+    constexpr uint32_t levels = 1u << 18;
+    std::mt19937 rng(static_cast<uint32_t>(rank * 7919 + frame * 104729 + 1));
+    std::uniform_int_distribution<uint32_t> dist(0, levels - 1);
+    auto const pixels = static_cast<size_t>(width) * height;
+    color.resize(pixels * sizeof(uint32_t));
+    depth.resize(pixels * sizeof(float));
+    auto c = reinterpret_cast<uint32_t*>(color.data());
+    auto d = reinterpret_cast<float*>(depth.data());
+    for (size_t i = 0; i < pixels; ++i) {
+        c[i] = rng();
+        d[i] = static_cast<float>(dist(rng) * ranks + rank) / static_cast<float>(levels * ranks);
+    }
+}
+
+int runRank(FBOCommFabric::commtype type, int rank, int ranks, int port) {
+    // binary-swap, radix-4 and direct-send, each on its own ports to not rebind the previous ones
+    int failed = 0;
+    int pass = 0;
+    for (auto const radix : {2, 4, ranks}) {
+        std::vector<std::string> peers;
+        if (type == FBOCommFabric::ZMQ_COMM) {
+            for (int r = 0; r < ranks; ++r) {
+                peers.push_back("tcp://127.0.0.1:" + std::to_string(port + pass * ranks + r));
+            }
+        }
+        ++pass;
+
+        FBOSwapCompositor compositor;
+        if (!compositor.Init(type, rank, peers, radix, std::chrono::milliseconds(10000))) {
+            std::fprintf(stderr, "rank %d: init with radix %d failed\n", rank, radix);
+            return EXIT_FAILURE;
+        }
+
+        std::vector<char> color, depth, ref_color, ref_depth, in_color, in_depth;
+        for (int frame = 0; frame < frames; ++frame) {
+            makeFrame(rank, ranks, frame, color, depth);
+            if (!compositor.Composite(color, depth, width, height)) {
+                std::fprintf(stderr, "rank %d: composite with radix %d failed in frame %d\n", rank, radix, frame);
+                return EXIT_FAILURE;
+            }
+            if (rank != 0) {
+                continue;
+            }
+
+            makeFrame(0, ranks, frame, ref_color, ref_depth);
+            for (int r = 1; r < ranks; ++r) {
+                makeFrame(r, ranks, frame, in_color, in_depth);
+                FBOSwapCompositor::MergeDepth(reinterpret_cast<uint32_t*>(ref_color.data()),
+                    reinterpret_cast<float*>(ref_depth.data()), reinterpret_cast<uint32_t const*>(in_color.data()),
+                    reinterpret_cast<float const*>(in_depth.data()), static_cast<size_t>(width) * height);
+            }
+            if ((ref_color != color) || (ref_depth != depth)) {
+                std::fprintf(stderr, "radix %d: frame %d differs from the serial composite\n", radix, frame);
+                ++failed;
+            }
+        }
+        if ((type == FBOCommFabric::ZMQ_COMM) && (rank != 0)) {
+            // the sockets do not linger, give the last piece for rank 0 time to leave before closing them
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+        compositor.Shutdown();
+    }
+
+    if ((rank == 0) && (failed == 0)) {
+        std::printf("%d ranks: composites match the serial composite\n", ranks);
+    }
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    if ((argc == 5) && (std::strcmp(argv[1], "--rank") == 0)) {
+        return runRank(FBOCommFabric::ZMQ_COMM, std::atoi(argv[2]), std::atoi(argv[3]), std::atoi(argv[4]));
+    }
+
+    if ((argc == 2) && (std::strcmp(argv[1], "--mpi") == 0)) {
+#ifdef MEGAMOL_USE_MPI
+        int rank = 0, ranks = 0;
+        MPI_Init(&argc, &argv);
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+        auto const ret = runRank(FBOCommFabric::MPI_COMM, rank, ranks, 0);
+        MPI_Finalize();
+        return ret;
+#else
+        std::fprintf(stderr, "built without MPI\n");
+        return EXIT_FAILURE;
+#endif // MEGAMOL_USE_MPI
+    }
+
+    auto const ranks = (argc > 1) ? std::atoi(argv[1]) : 4;
+    auto const port = (argc > 2) ? std::atoi(argv[2]) : 35500;
+    if ((ranks < 1) || (ranks > max_ranks)) {
+        std::fprintf(stderr, "ranks must be within [1, %d]\n", max_ranks);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<int> results(ranks, EXIT_FAILURE);
+    std::vector<std::thread> launchers;
+    for (int r = 0; r < ranks; ++r) {
+        launchers.emplace_back([&results, r, ranks, port, exe = std::string{argv[0]}]() {
+            auto const cmd = "\"" + exe + "\" --rank " + std::to_string(r) + " " + std::to_string(ranks) + " " +
+                             std::to_string(port);
+            results[r] = std::system(cmd.c_str());
+        });
+    }
+    for (auto& l : launchers) {
+        l.join();
+    }
+
+    for (int r = 0; r < ranks; ++r) {
+        if (results[r] != 0) {
+            std::fprintf(stderr, "rank %d failed\n", r);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
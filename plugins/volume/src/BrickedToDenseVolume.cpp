@@ -0,0 +1,280 @@
+/*
+ * BrickedToDenseVolume.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "BrickedToDenseVolume.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mmcore/param/IntParam.h"
+
+#include "mmcore/utility/log/Log.h"
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::BrickedToDenseVolume
+ */
+megamol::volume::BrickedToDenseVolume::BrickedToDenseVolume()
+        : frameID((std::numeric_limits<unsigned int>::max)())
+        , hash((std::numeric_limits<std::size_t>::max)())
+        , level((std::numeric_limits<unsigned int>::max)())
+        , paramLevel("level", "The level of detail to be assembled, -1 selects the finest one within the budget.")
+        , paramMemoryBudget("memoryBudget", "The maximum size of the dense volume in MB.")
+        , slotIn("in", "The input slot providing the bricked volume.")
+        , slotOut("out", "The output slot providing the dense volume.") {
+    using geocalls::BrickedVolumetricDataCall;
+    using geocalls::VolumetricDataCall;
+
+    this->slotIn.SetCompatibleCall<core::factories::CallAutoDescription<BrickedVolumetricDataCall>>();
+    this->MakeSlotAvailable(&this->slotIn);
+
+    this->slotOut.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA), &BrickedToDenseVolume::onGetData);
+    this->slotOut.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_EXTENTS), &BrickedToDenseVolume::onGetExtents);
+    this->slotOut.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_METADATA), &BrickedToDenseVolume::onGetMetadata);
+    this->slotOut.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_START_ASYNC), &BrickedToDenseVolume::onUnsupported);
+    this->slotOut.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_STOP_ASYNC), &BrickedToDenseVolume::onUnsupported);
+    this->slotOut.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_TRY_GET_DATA), &BrickedToDenseVolume::onUnsupported);
+    this->MakeSlotAvailable(&this->slotOut);
+
+    this->paramLevel << new core::param::IntParam(-1, -1);
+    this->MakeSlotAvailable(&this->paramLevel);
+
+    this->paramMemoryBudget << new core::param::IntParam(2048, 1);
+    this->MakeSlotAvailable(&this->paramMemoryBudget);
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::~BrickedToDenseVolume
+ */
+megamol::volume::BrickedToDenseVolume::~BrickedToDenseVolume() {
+    this->Release();
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::create
+ */
+bool megamol::volume::BrickedToDenseVolume::create() {
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::onGetData
+ */
+bool megamol::volume::BrickedToDenseVolume::onGetData(core::Call& call) {
+    using geocalls::BrickedVolumetricDataCall;
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    auto dst = dynamic_cast<VolumetricDataCall*>(&call);
+    auto src = this->slotIn.CallAs<BrickedVolumetricDataCall>();
+
+    if (dst == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs received a wrong request.",
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA), BrickedToDenseVolume::ClassName());
+        return false;
+    }
+
+    if (src == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs has a wrong source.",
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA), BrickedToDenseVolume::ClassName());
+        return false;
+    }
+
+    unsigned int level = 0;
+    if (!this->updateMetadata(dst->FrameID(), level)) {
+        return false;
+    }
+
+    if ((this->frameID != src->FrameID()) || (this->hash != src->DataHash()) || (this->level != level)) {
+        const auto& l = src->GetLevel(level);
+        const auto voxelSize = src->GetVoxelSize();
+        const auto cntBricks = l.Bricks[0] * l.Bricks[1] * l.Bricks[2];
+
+        this->request.resize(cntBricks);
+        for (std::size_t i = 0; i < cntBricks; ++i) {
+            this->request[i] = l.FirstBrick + i;
+        }
+        src->SetRequest(this->request.data(), this->request.size());
+        if (!(*src)(BrickedVolumetricDataCall::IDX_GET_BRICKS)) {
+            Log::DefaultLog.WriteError("%hs failed to call %hs.", BrickedToDenseVolume::ClassName(),
+                BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_BRICKS));
+            return false;
+        }
+
+        this->data.resize(l.Resolution[0] * l.Resolution[1] * l.Resolution[2] * voxelSize);
+        bool complete = true;
+#pragma omp parallel for reduction(&& : complete)
+        for (std::int64_t i = 0; i < static_cast<std::int64_t>(cntBricks); ++i) {
+            const auto& brick = src->GetBrickData(i);
+            if (brick != nullptr) {
+                BrickedVolumetricDataCall::CopyBrickToGrid(
+                    src->GetBrick(this->request[i]), brick->data(), voxelSize, this->data.data(), l.Resolution);
+            } else {
+                complete = false;
+            }
+        }
+        if (!complete) {
+            Log::DefaultLog.WriteError(
+                "%hs did not receive all bricks of level %u.", BrickedToDenseVolume::ClassName(), level);
+            return false;
+        }
+
+        this->frameID = src->FrameID();
+        this->hash = src->DataHash();
+        this->level = level;
+    }
+
+    dst->SetData(this->data.data());
+    dst->SetMetadata(&this->metadata);
+    dst->SetFrameCount(src->FrameCount());
+    dst->SetFrameID(this->frameID);
+    dst->SetDataHash(this->hash ^ (this->level + 0x9e3779b9 + (this->hash << 6) + (this->hash >> 2)));
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::onGetExtents
+ */
+bool megamol::volume::BrickedToDenseVolume::onGetExtents(core::Call& call) {
+    using geocalls::BrickedVolumetricDataCall;
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    auto dst = dynamic_cast<VolumetricDataCall*>(&call);
+    auto src = this->slotIn.CallAs<BrickedVolumetricDataCall>();
+
+    if (dst == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs received a wrong request.",
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_EXTENTS), BrickedToDenseVolume::ClassName());
+        return false;
+    }
+
+    if (src == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs has a wrong source.",
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_EXTENTS), BrickedToDenseVolume::ClassName());
+        return false;
+    }
+
+    src->SetFrameID(dst->FrameID());
+    if (!(*src)(BrickedVolumetricDataCall::IDX_GET_EXTENTS)) {
+        Log::DefaultLog.WriteError("%hs failed to call %hs.", BrickedToDenseVolume::ClassName(),
+            BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_EXTENTS));
+        return false;
+    }
+
+    dst->AccessBoundingBoxes() = src->AccessBoundingBoxes();
+    dst->SetFrameCount(src->FrameCount());
+    dst->SetDataHash(src->DataHash());
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::onGetMetadata
+ */
+bool megamol::volume::BrickedToDenseVolume::onGetMetadata(core::Call& call) {
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    auto dst = dynamic_cast<VolumetricDataCall*>(&call);
+    if (dst == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs received a wrong request.",
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_METADATA), BrickedToDenseVolume::ClassName());
+        return false;
+    }
+
+    unsigned int level = 0;
+    if (!this->updateMetadata(dst->FrameID(), level)) {
+        return false;
+    }
+
+    auto src = this->slotIn.CallAs<geocalls::BrickedVolumetricDataCall>();
+    dst->SetMetadata(&this->metadata);
+    dst->SetFrameCount(src->FrameCount());
+    dst->SetFrameID(src->FrameID());
+    dst->SetDataHash(src->DataHash() ^ (level + 0x9e3779b9 + (src->DataHash() << 6) + (src->DataHash() >> 2)));
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::onUnsupported
+ */
+bool megamol::volume::BrickedToDenseVolume::onUnsupported(core::Call& call) {
+    return false;
+}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::release
+ */
+void megamol::volume::BrickedToDenseVolume::release() {}
+
+
+/*
+ * megamol::volume::BrickedToDenseVolume::updateMetadata
+ */
+bool megamol::volume::BrickedToDenseVolume::updateMetadata(unsigned int frame, unsigned int& level) {
+    using core::param::IntParam;
+    using geocalls::BrickedVolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    auto src = this->slotIn.CallAs<BrickedVolumetricDataCall>();
+    if (src == nullptr) {
+        Log::DefaultLog.WriteError("Call %hs of %hs has a wrong source.",
+            BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_DATA),
+            BrickedToDenseVolume::ClassName());
+        return false;
+    }
+
+    src->SetFrameID(frame, true);
+    if (!(*src)(BrickedVolumetricDataCall::IDX_GET_DATA) || (src->GetMetadata() == nullptr) ||
+        (src->GetLevelCount() == 0)) {
+        Log::DefaultLog.WriteError("%hs failed to call %hs.", BrickedToDenseVolume::ClassName(),
+            BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_DATA));
+        return false;
+    }
+
+    const auto requested = this->paramLevel.Param<IntParam>()->Value();
+    if (requested >= 0) {
+        level = (std::min)(static_cast<unsigned int>(requested), src->GetLevelCount() - 1);
+    } else {
+        const auto budget = static_cast<std::size_t>(this->paramMemoryBudget.Param<IntParam>()->Value()) << 20;
+        for (level = 0; level + 1 < src->GetLevelCount(); ++level) {
+            const auto& r = src->GetLevel(level).Resolution;
+            if (r[0] * r[1] * r[2] * src->GetVoxelSize() <= budget) {
+                break;
+            }
+        }
+    }
+
+    this->metadata = *src->GetMetadata();
+    const auto& l = src->GetLevel(level);
+    for (int a = 0; a < 3; ++a) {
+        // the extents are preserved, the slices of the coarser level are farther apart
+        this->metadata.Resolution[a] = l.Resolution[a];
+        if (l.Resolution[a] > 1) {
+            this->metadata.SliceDists[a][0] = this->metadata.Extents[a] / static_cast<float>(l.Resolution[a] - 1);
+        }
+    }
+
+    if ((level != this->level) && (level > 0)) {
+        Log::DefaultLog.WriteInfo("%hs assembles level %u with %zu x %zu x %zu voxels.",
+            BrickedToDenseVolume::ClassName(), level, l.Resolution[0], l.Resolution[1], l.Resolution[2]);
+    }
+    return true;
+}
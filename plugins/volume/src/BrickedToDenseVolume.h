@@ -0,0 +1,82 @@
+/*
+ * BrickedToDenseVolume.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry_calls/BrickedVolumetricDataCall.h"
+#include "geometry_calls/VolumetricDataCall.h"
+#include "geometry_calls/VolumetricMetadataStore.h"
+
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+
+
+namespace megamol::volume {
+
+/**
+ * Assembles a dense volume from the bricks of a single level of detail,
+ * which allows for feeding bricked data into all modules consuming a
+ * VolumetricDataCall. Unless a level is selected explicitly, the finest
+ * level that fits into the memory budget is used.
+ */
+class BrickedToDenseVolume : public core::Module {
+
+public:
+    static inline constexpr const char* ClassName() {
+        return "BrickedToDenseVolume";
+    }
+
+    static inline constexpr const char* Description() {
+        return "Assembles a dense volume from one level of detail of a bricked volume.";
+    }
+
+    static inline constexpr bool IsAvailable() {
+        return true;
+    }
+
+    BrickedToDenseVolume();
+
+    ~BrickedToDenseVolume() override;
+
+protected:
+    bool create() override;
+
+    bool onGetData(core::Call& call);
+
+    bool onGetExtents(core::Call& call);
+
+    bool onGetMetadata(core::Call& call);
+
+    bool onUnsupported(core::Call& call);
+
+    void release() override;
+
+private:
+    /**
+     * Retrieves the brick table of 'frame', selects the level to be
+     * assembled and derives its metadata.
+     */
+    bool updateMetadata(unsigned int frame, unsigned int& level);
+
+    std::vector<std::uint8_t> data;
+    unsigned int frameID;
+    std::size_t hash;
+    unsigned int level;
+    geocalls::VolumetricMetadataStore metadata;
+    core::param::ParamSlot paramLevel;
+    core::param::ParamSlot paramMemoryBudget;
+    std::vector<std::size_t> request;
+    core::CallerSlot slotIn;
+    core::CalleeSlot slotOut;
+};
+
+} // namespace megamol::volume
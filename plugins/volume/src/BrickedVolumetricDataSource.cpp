@@ -0,0 +1,916 @@
+/*
+ * BrickedVolumetricDataSource.cpp
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "BrickedVolumetricDataSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#include "zlib.h"
+
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+
+#include "mmcore/utility/log/Log.h"
+
+
+namespace {
+
+typedef megamol::geocalls::BrickedVolumetricDataCall::Brick Brick;
+typedef megamol::geocalls::BrickedVolumetricDataCall::Level Level;
+
+/** Identifies brick files. */
+constexpr char brickFileMagic[8] = {'M', 'M', 'B', 'R', 'I', 'C', 'K', 'S'};
+
+/** The version of the brick file layout. */
+constexpr uint32_t brickFileVersion = 1;
+
+/**
+ * Header of a brick file. It is followed by the per-brick and per-component
+ * minima of all frames, the maxima of all frames and, starting at
+ * 'dataOffset', the voxels of all bricks of all frames.
+ */
+#pragma pack(push, 1)
+struct BrickFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t brickSize;
+    uint32_t components;
+    uint32_t scalarLength;
+    uint32_t frames;
+    uint32_t levels;
+    uint64_t resolution[3];
+    uint64_t fingerprint;
+    uint64_t dataOffset;
+};
+#pragma pack(pop)
+
+/** Answer whether the machine stores scalars little endian. */
+inline bool isLittleEndian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+/** Reverses the byte order of 'cnt' scalars of 'size' bytes each. */
+void swapBytes(uint8_t* data, size_t cnt, size_t size) {
+    for (size_t i = 0; i < cnt; ++i, data += size) {
+        std::reverse(data, data + size);
+    }
+}
+
+/**
+ * Writes the z-slices of one level of a frame into the brick file, tracks
+ * the value ranges of the bricks and hands the downsampled slices to the
+ * writer of the next level.
+ */
+template<class T>
+class LevelWriter {
+public:
+    LevelWriter(std::ofstream& file, const std::vector<Level>& levels, const std::vector<Brick>& bricks,
+        const std::vector<uint64_t>& brickOffsets, size_t brickSize, uint64_t frameStart, unsigned int level,
+        size_t components, double* minValues, double* maxValues, LevelWriter* next)
+            : file(file)
+            , level(levels[level])
+            , bricks(bricks)
+            , brickOffsets(brickOffsets)
+            , frameStart(frameStart)
+            , brickSize(brickSize)
+            , components(components)
+            , minValues(minValues)
+            , maxValues(maxValues)
+            , next(next) {}
+
+    /**
+     * Adds the slice 'z' of the level, slices must be added in order.
+     */
+    void AddSlice(const T* slice, size_t z) {
+        const size_t sx = this->level.Resolution[0];
+        const size_t sy = this->level.Resolution[1];
+        const size_t bz = z / this->brickSize;
+        const size_t zl = z % this->brickSize;
+        const int64_t cntBricks = static_cast<int64_t>(this->level.Bricks[0] * this->level.Bricks[1]);
+
+        // the part of the slice in each brick of the row is contiguous in the brick
+        this->scratch.resize(sx * sy * this->components);
+#pragma omp parallel for schedule(dynamic)
+        for (int64_t b = 0; b < cntBricks; ++b) {
+            const size_t bx = b % this->level.Bricks[0];
+            const size_t by = b / this->level.Bricks[0];
+            const size_t idx = this->brickIndex(bx, by, bz);
+            const Brick& brick = this->bricks[idx];
+            T* dst = this->scratch.data() + this->sliceOffset(bx, by, brick) * this->components;
+            double* mins = this->minValues + idx * this->components;
+            double* maxs = this->maxValues + idx * this->components;
+            for (size_t y = 0; y < brick.Resolution[1]; ++y) {
+                const T* src = slice + ((brick.Origin[1] + y) * sx + brick.Origin[0]) * this->components;
+                const size_t cnt = brick.Resolution[0] * this->components;
+                for (size_t i = 0; i < cnt; ++i) {
+                    const double v = static_cast<double>(src[i]);
+                    const size_t c = i % this->components;
+                    mins[c] = std::min(mins[c], v);
+                    maxs[c] = std::max(maxs[c], v);
+                }
+                std::memcpy(dst, src, cnt * sizeof(T));
+                dst += cnt;
+            }
+        }
+
+        for (size_t by = 0; by < this->level.Bricks[1]; ++by) {
+            for (size_t bx = 0; bx < this->level.Bricks[0]; ++bx) {
+                const size_t idx = this->brickIndex(bx, by, bz);
+                const Brick& brick = this->bricks[idx];
+                const size_t bytes = brick.Resolution[0] * brick.Resolution[1] * this->components * sizeof(T);
+                const T* src = this->scratch.data() + this->sliceOffset(bx, by, brick) * this->components;
+                this->file.seekp(this->frameStart + this->brickOffsets[idx] + zl * bytes);
+                this->file.write(reinterpret_cast<const char*>(src), bytes);
+            }
+        }
+
+        if (this->next != nullptr) {
+            const bool isLast = (z + 1 == this->level.Resolution[2]);
+            if ((z % 2) == 1) {
+                this->downsample(this->pending.data(), slice, z / 2);
+            } else if (isLast) {
+                this->downsample(slice, slice, z / 2);
+            } else {
+                this->pending.assign(slice, slice + sx * sy * this->components);
+            }
+        }
+    }
+
+private:
+    inline size_t brickIndex(size_t bx, size_t by, size_t bz) const {
+        return this->level.FirstBrick + bx + (by + bz * this->level.Bricks[1]) * this->level.Bricks[0];
+    }
+
+    /** Answer the first voxel of the part of 'brick' in the reordered slice. */
+    inline size_t sliceOffset(size_t bx, size_t by, const Brick& brick) const {
+        return by * this->brickSize * this->level.Resolution[0] + bx * this->brickSize * brick.Resolution[1];
+    }
+
+    /** Averages 2x2x2 voxels of two consecutive slices into slice 'z' of the next level. */
+    void downsample(const T* lower, const T* upper, size_t z) {
+        const size_t sx = this->level.Resolution[0];
+        const size_t sy = this->level.Resolution[1];
+        const size_t nx = (sx + 1) / 2;
+        const int64_t ny = static_cast<int64_t>((sy + 1) / 2);
+        const size_t comps = this->components;
+        this->downsampled.resize(nx * ny * comps);
+#pragma omp parallel for
+        for (int64_t y = 0; y < ny; ++y) {
+            const size_t y0 = 2 * y;
+            const size_t y1 = std::min(y0 + 1, sy - 1);
+            for (size_t x = 0; x < nx; ++x) {
+                const size_t x0 = 2 * x;
+                const size_t x1 = std::min(x0 + 1, sx - 1);
+                for (size_t c = 0; c < comps; ++c) {
+                    double sum = 0.0;
+                    for (const T* s : {lower, upper}) {
+                        sum += static_cast<double>(s[(y0 * sx + x0) * comps + c]);
+                        sum += static_cast<double>(s[(y0 * sx + x1) * comps + c]);
+                        sum += static_cast<double>(s[(y1 * sx + x0) * comps + c]);
+                        sum += static_cast<double>(s[(y1 * sx + x1) * comps + c]);
+                    }
+                    sum /= 8.0;
+                    if (std::is_integral<T>::value) {
+                        sum = std::round(sum);
+                    }
+                    this->downsampled[(y * nx + x) * comps + c] = static_cast<T>(sum);
+                }
+            }
+        }
+        this->next->AddSlice(this->downsampled.data(), z);
+    }
+
+    std::ofstream& file;
+    const Level& level;
+    const std::vector<Brick>& bricks;
+    const std::vector<uint64_t>& brickOffsets;
+    uint64_t frameStart;
+    size_t brickSize;
+    size_t components;
+    double* minValues;
+    double* maxValues;
+    LevelWriter* next;
+    std::vector<T> scratch;
+    std::vector<T> pending;
+    std::vector<T> downsampled;
+};
+
+} // namespace
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::BrickedVolumetricDataSource
+ */
+megamol::volume::BrickedVolumetricDataSource::BrickedVolumetricDataSource()
+        : core::Module()
+        , brickSize(0)
+        , cacheBudget(0)
+        , cacheBytes(0)
+        , dataHash(0)
+        , dataOffset(0)
+        , fileInfo(nullptr)
+        , frameBytes(0)
+        , paramBrickSize("BrickSize", "The edge length of the bricks in voxels.")
+        , paramCacheSize("CacheSize", "The maximum size of the brick cache in MB.")
+        , paramFileName("FileName", "The path to the dat file to be loaded.")
+        , paramPrefetch("Prefetch", "Loads the bricks that will probably be requested next in the background.")
+        , prefetchStop(false)
+        , slotGetData("GetData", "Slot for requesting data from the source.") {
+    using geocalls::BrickedVolumetricDataCall;
+
+    auto enumParam = new core::param::EnumParam(64);
+    enumParam->SetTypePair(16, "16");
+    enumParam->SetTypePair(32, "32");
+    enumParam->SetTypePair(64, "64");
+    enumParam->SetTypePair(128, "128");
+    this->paramBrickSize.SetParameter(enumParam);
+    this->MakeSlotAvailable(&this->paramBrickSize);
+
+    this->paramCacheSize.SetParameter(new core::param::IntParam(1024, 16));
+    this->MakeSlotAvailable(&this->paramCacheSize);
+
+    this->paramFileName.SetParameter(new core::param::FilePathParam(""));
+    this->MakeSlotAvailable(&this->paramFileName);
+
+    this->paramPrefetch.SetParameter(new core::param::BoolParam(true));
+    this->MakeSlotAvailable(&this->paramPrefetch);
+
+    this->slotGetData.SetCallback(BrickedVolumetricDataCall::ClassName(),
+        BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_EXTENTS),
+        &BrickedVolumetricDataSource::onGetExtents);
+    this->slotGetData.SetCallback(BrickedVolumetricDataCall::ClassName(),
+        BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_DATA),
+        &BrickedVolumetricDataSource::onGetData);
+    this->slotGetData.SetCallback(BrickedVolumetricDataCall::ClassName(),
+        BrickedVolumetricDataCall::FunctionName(BrickedVolumetricDataCall::IDX_GET_BRICKS),
+        &BrickedVolumetricDataSource::onGetBricks);
+    this->MakeSlotAvailable(&this->slotGetData);
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::~BrickedVolumetricDataSource
+ */
+megamol::volume::BrickedVolumetricDataSource::~BrickedVolumetricDataSource() {
+    this->Release();
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::create
+ */
+bool megamol::volume::BrickedVolumetricDataSource::create() {
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::release
+ */
+void megamol::volume::BrickedVolumetricDataSource::release() {
+    this->stopPrefetching();
+    this->resetCache();
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    if (this->fileInfo != nullptr) {
+        ::datRaw_freeInfo(this->fileInfo);
+        SAFE_DELETE(this->fileInfo);
+    }
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::onGetBricks
+ */
+bool megamol::volume::BrickedVolumetricDataSource::onGetBricks(core::Call& call) {
+    using megamol::core::utility::log::Log;
+
+    auto& c = dynamic_cast<BrickedCall&>(call);
+    if (!this->openDataSet() || !this->openBrickFile()) {
+        return false;
+    }
+    const unsigned int frame = std::min<unsigned int>(c.FrameID(), this->fileInfo->timeSteps - 1);
+
+    {
+        std::lock_guard<std::mutex> lock(this->cacheLock);
+        this->cacheBudget = static_cast<size_t>(this->paramCacheSize.Param<core::param::IntParam>()->Value()) << 20;
+        this->prefetchQueue.clear();
+    }
+
+    std::vector<BrickedCall::BrickData> data;
+    data.reserve(c.GetRequestCount());
+    for (size_t i = 0; i < c.GetRequestCount(); ++i) {
+        const size_t idx = c.GetRequestedBrick(i);
+        if (idx >= this->bricks.size()) {
+            Log::DefaultLog.WriteError("%hs: brick %zu requested, but there are only %zu bricks.",
+                BrickedVolumetricDataSource::ClassName(), idx, this->bricks.size());
+            return false;
+        }
+        data.push_back(this->getBrick(this->file, frame, idx));
+        if (data.back() == nullptr) {
+            Log::DefaultLog.WriteError("%hs: reading brick %zu of frame %u failed.",
+                BrickedVolumetricDataSource::ClassName(), idx, frame);
+            return false;
+        }
+    }
+    c.SetBrickData(std::move(data));
+    c.SetFrameID(frame);
+    c.SetDataHash(this->dataHash);
+
+    if (this->prefetchThread.joinable()) {
+        std::lock_guard<std::mutex> lock(this->cacheLock);
+        if (c.GetPrefetchCount() > 0) {
+            for (size_t i = 0; i < c.GetPrefetchCount(); ++i) {
+                if (c.GetPrefetchBrick(i) < this->bricks.size()) {
+                    this->prefetchQueue.emplace_back(frame, c.GetPrefetchBrick(i));
+                }
+            }
+        } else if (frame + 1 < static_cast<unsigned int>(this->fileInfo->timeSteps)) {
+            // without a hint, expect the same bricks of the next frame during playback
+            for (size_t i = 0; i < c.GetRequestCount(); ++i) {
+                this->prefetchQueue.emplace_back(frame + 1, c.GetRequestedBrick(i));
+            }
+        }
+        this->prefetchEvent.notify_one();
+    }
+
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::onGetData
+ */
+bool megamol::volume::BrickedVolumetricDataSource::onGetData(core::Call& call) {
+    auto& c = dynamic_cast<BrickedCall&>(call);
+    if (!this->openDataSet() || !this->openBrickFile()) {
+        return false;
+    }
+    const unsigned int frame = std::min<unsigned int>(c.FrameID(), this->fileInfo->timeSteps - 1);
+    const size_t comps = this->metadata.Components;
+
+    std::copy_n(this->frameMin.begin() + frame * comps, comps, this->metadataMin.begin());
+    std::copy_n(this->frameMax.begin() + frame * comps, comps, this->metadataMax.begin());
+
+    const size_t tableOffset = static_cast<size_t>(frame) * this->bricks.size() * comps;
+    c.SetMetadata(&this->metadata);
+    c.SetBrickTable(this->brickSize, this->levels.data(), static_cast<unsigned int>(this->levels.size()),
+        this->bricks.data(), this->bricks.size(), this->minValues.data() + tableOffset,
+        this->maxValues.data() + tableOffset);
+    c.SetFrameCount(this->fileInfo->timeSteps);
+    c.SetFrameID(frame);
+    c.SetDataHash(this->dataHash);
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::onGetExtents
+ */
+bool megamol::volume::BrickedVolumetricDataSource::onGetExtents(core::Call& call) {
+    auto& c = dynamic_cast<BrickedCall&>(call);
+    if (!this->openDataSet()) {
+        return false;
+    }
+
+    const float* o = this->metadata.Origin;
+    const float* e = this->metadata.Extents;
+    c.AccessBoundingBoxes().Clear();
+    c.AccessBoundingBoxes().SetObjectSpaceBBox(o[0], o[1], o[2], o[0] + e[0], o[1] + e[1], o[2] + e[2]);
+    c.AccessBoundingBoxes().SetObjectSpaceClipBox(c.AccessBoundingBoxes().ObjectSpaceBBox());
+    c.SetFrameCount(this->fileInfo->timeSteps);
+    c.SetDataHash(this->dataHash);
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::buildBrickFile
+ */
+bool megamol::volume::BrickedVolumetricDataSource::buildBrickFile(const std::filesystem::path& path) {
+    using megamol::core::utility::log::Log;
+
+    switch (this->fileInfo->dataFormat) {
+    case DR_FORMAT_CHAR:
+        return this->buildBrickFile<DR_CHAR>(path);
+    case DR_FORMAT_UCHAR:
+        return this->buildBrickFile<DR_UCHAR>(path);
+    case DR_FORMAT_SHORT:
+        return this->buildBrickFile<DR_SHORT>(path);
+    case DR_FORMAT_USHORT:
+        return this->buildBrickFile<DR_USHORT>(path);
+    case DR_FORMAT_INT:
+        return this->buildBrickFile<DR_INT>(path);
+    case DR_FORMAT_UINT:
+        return this->buildBrickFile<DR_UINT>(path);
+    case DR_FORMAT_LONG:
+        return this->buildBrickFile<DR_LONG>(path);
+    case DR_FORMAT_ULONG:
+        return this->buildBrickFile<DR_ULONG>(path);
+    case DR_FORMAT_FLOAT:
+        return this->buildBrickFile<DR_FLOAT>(path);
+    case DR_FORMAT_DOUBLE:
+        return this->buildBrickFile<DR_DOUBLE>(path);
+    default:
+        Log::DefaultLog.WriteError("%hs does not support scalars of format %hs.",
+            BrickedVolumetricDataSource::ClassName(), ::datRaw_getDataFormatName(this->fileInfo->dataFormat));
+        return false;
+    }
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::buildBrickFile
+ */
+template<class T>
+bool megamol::volume::BrickedVolumetricDataSource::buildBrickFile(const std::filesystem::path& path) {
+    using megamol::core::utility::log::Log;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const size_t comps = this->metadata.Components;
+    const unsigned int frames = this->fileInfo->timeSteps;
+    const size_t tableSize = static_cast<size_t>(frames) * this->bricks.size() * comps;
+    const size_t sliceSize = this->metadata.Resolution[0] * this->metadata.Resolution[1] * comps;
+
+    BrickFileHeader header;
+    std::memcpy(header.magic, brickFileMagic, sizeof(header.magic));
+    header.version = brickFileVersion;
+    header.brickSize = static_cast<uint32_t>(this->brickSize);
+    header.components = static_cast<uint32_t>(comps);
+    header.scalarLength = sizeof(T);
+    header.frames = frames;
+    header.levels = static_cast<uint32_t>(this->levels.size());
+    for (int a = 0; a < 3; ++a) {
+        header.resolution[a] = this->metadata.Resolution[a];
+    }
+    header.fingerprint = this->fingerprint();
+    header.dataOffset = sizeof(BrickFileHeader) + 2 * tableSize * sizeof(double);
+
+    Log::DefaultLog.WriteInfo("%hs: building brick file %s with %zu bricks per frame ...",
+        BrickedVolumetricDataSource::ClassName(), path.generic_u8string().c_str(), this->bricks.size());
+
+    // write to a temporary file first, so an interrupted build is never mistaken for a brick file
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    std::error_code ec;
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        Log::DefaultLog.WriteError("%hs: cannot create brick file %s.", BrickedVolumetricDataSource::ClassName(),
+            tmpPath.generic_u8string().c_str());
+        return false;
+    }
+
+    std::vector<double> mins(tableSize, std::numeric_limits<double>::max());
+    std::vector<double> maxs(tableSize, std::numeric_limits<double>::lowest());
+    std::vector<T> slice(sliceSize);
+    const unsigned int sliceBytes = static_cast<unsigned int>(sliceSize * sizeof(T));
+    const bool swap = (this->fileInfo->byteOrder == DR_LITTLE_ENDIAN) != isLittleEndian();
+    gzFile raw = nullptr;
+    bool ok = true;
+
+    for (unsigned int f = 0; (f < frames) && ok; ++f) {
+        // a single raw file holds all frames consecutively and is read as one stream
+        if ((raw == nullptr) || this->fileInfo->multiDataFiles) {
+            std::string rawName(this->fileInfo->dataFileName);
+            if (this->fileInfo->multiDataFiles) {
+                char* n = ::getMultifileFilename(this->fileInfo, f);
+                rawName = (n != nullptr) ? n : "";
+                ::free(n);
+            }
+            if (raw != nullptr) {
+                ::gzclose(raw);
+            }
+            raw = ::gzopen(rawName.c_str(), "rb");
+            if ((raw == nullptr) || (::gzseek(raw, this->fileInfo->dataOffset, SEEK_SET) < 0)) {
+                Log::DefaultLog.WriteError("%hs: cannot read raw file %hs.", BrickedVolumetricDataSource::ClassName(),
+                    rawName.c_str());
+                ok = false;
+                break;
+            }
+        }
+
+        const size_t tableOffset = static_cast<size_t>(f) * this->bricks.size() * comps;
+        std::vector<std::unique_ptr<LevelWriter<T>>> writers(this->levels.size());
+        for (size_t l = this->levels.size(); l-- > 0;) {
+            writers[l] = std::make_unique<LevelWriter<T>>(out, this->levels, this->bricks, this->brickOffsets,
+                this->brickSize, header.dataOffset + f * this->frameBytes, static_cast<unsigned int>(l), comps,
+                mins.data() + tableOffset, maxs.data() + tableOffset,
+                (l + 1 < this->levels.size()) ? writers[l + 1].get() : nullptr);
+        }
+
+        for (size_t z = 0; z < this->metadata.Resolution[2]; ++z) {
+            if (::gzread(raw, slice.data(), sliceBytes) != static_cast<int>(sliceBytes)) {
+                Log::DefaultLog.WriteError("%hs: raw data of frame %u ends at slice %zu.",
+                    BrickedVolumetricDataSource::ClassName(), f, z);
+                ok = false;
+                break;
+            }
+            if (swap) {
+                swapBytes(reinterpret_cast<uint8_t*>(slice.data()), sliceSize, sizeof(T));
+            }
+            writers[0]->AddSlice(slice.data(), z);
+        }
+        ok = ok && out.good();
+
+        Log::DefaultLog.WriteInfo(
+            "%hs: bricked frame %u of %u.", BrickedVolumetricDataSource::ClassName(), f + 1, frames);
+    }
+    if (raw != nullptr) {
+        ::gzclose(raw);
+    }
+
+    if (ok) {
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(mins.data()), mins.size() * sizeof(double));
+        out.write(reinterpret_cast<const char*>(maxs.data()), maxs.size() * sizeof(double));
+        ok = out.good();
+        if (!ok) {
+            Log::DefaultLog.WriteError("%hs: writing brick file %s failed.", BrickedVolumetricDataSource::ClassName(),
+                tmpPath.generic_u8string().c_str());
+        }
+    }
+    out.close();
+
+    if (ok) {
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            Log::DefaultLog.WriteError("%hs: cannot move brick file to %s: %s",
+                BrickedVolumetricDataSource::ClassName(), path.generic_u8string().c_str(), ec.message().c_str());
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+    Log::DefaultLog.WriteInfo("%hs: building the brick file took %.1f s.", BrickedVolumetricDataSource::ClassName(),
+        duration.count());
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::brickFilePath
+ */
+std::filesystem::path megamol::volume::BrickedVolumetricDataSource::brickFilePath() const {
+    auto retval = this->paramFileName.Param<core::param::FilePathParam>()->Value();
+    retval += ".bricks";
+    return retval;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::buildBrickTable
+ */
+void megamol::volume::BrickedVolumetricDataSource::buildBrickTable() {
+    const size_t bs = this->brickSize;
+    const size_t voxelSize = this->metadata.ScalarLength * this->metadata.Components;
+
+    this->levels.clear();
+    this->bricks.clear();
+    this->brickOffsets.clear();
+    this->frameBytes = 0;
+
+    size_t res[3] = {this->metadata.Resolution[0], this->metadata.Resolution[1], this->metadata.Resolution[2]};
+    while (true) {
+        BrickedCall::Level level;
+        for (int a = 0; a < 3; ++a) {
+            level.Resolution[a] = res[a];
+            level.Bricks[a] = (res[a] + bs - 1) / bs;
+        }
+        level.FirstBrick = this->bricks.size();
+
+        for (size_t z = 0; z < level.Bricks[2]; ++z) {
+            for (size_t y = 0; y < level.Bricks[1]; ++y) {
+                for (size_t x = 0; x < level.Bricks[0]; ++x) {
+                    BrickedCall::Brick brick;
+                    brick.Level = static_cast<unsigned int>(this->levels.size());
+                    const size_t pos[3] = {x, y, z};
+                    for (int a = 0; a < 3; ++a) {
+                        brick.Origin[a] = pos[a] * bs;
+                        brick.Resolution[a] = std::min(bs, res[a] - brick.Origin[a]);
+                    }
+                    this->bricks.push_back(brick);
+                    this->brickOffsets.push_back(this->frameBytes);
+                    this->frameBytes += brick.Resolution[0] * brick.Resolution[1] * brick.Resolution[2] * voxelSize;
+                }
+            }
+        }
+        this->levels.push_back(level);
+
+        if ((res[0] <= bs) && (res[1] <= bs) && (res[2] <= bs)) {
+            break;
+        }
+        for (int a = 0; a < 3; ++a) {
+            res[a] = (res[a] + 1) / 2;
+        }
+    }
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::fingerprint
+ */
+uint64_t megamol::volume::BrickedVolumetricDataSource::fingerprint() const {
+    uint64_t retval = 14695981039346656037ull;
+    auto mix = [&retval](uint64_t v) {
+        retval ^= v;
+        retval *= 1099511628211ull;
+    };
+
+    const unsigned int cntFiles = this->fileInfo->multiDataFiles ? this->fileInfo->timeSteps : 1;
+    for (unsigned int f = 0; f < cntFiles; ++f) {
+        std::string rawName(this->fileInfo->dataFileName);
+        if (this->fileInfo->multiDataFiles) {
+            char* n = ::getMultifileFilename(this->fileInfo, f);
+            rawName = (n != nullptr) ? n : "";
+            ::free(n);
+        }
+        std::error_code ec;
+        mix(std::filesystem::file_size(rawName, ec));
+        mix(static_cast<uint64_t>(std::filesystem::last_write_time(rawName, ec).time_since_epoch().count()));
+    }
+    return retval;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::getBrick
+ */
+megamol::geocalls::BrickedVolumetricDataCall::BrickData megamol::volume::BrickedVolumetricDataSource::getBrick(
+    std::ifstream& file, unsigned int frame, size_t brick) {
+    const BrickKey key = static_cast<BrickKey>(frame) * this->bricks.size() + brick;
+
+    {
+        std::lock_guard<std::mutex> lock(this->cacheLock);
+        auto it = this->cache.find(key);
+        if (it != this->cache.end()) {
+            this->lru.splice(this->lru.begin(), this->lru, it->second.lru);
+            return it->second.data;
+        }
+    }
+
+    const auto& b = this->bricks[brick];
+    const size_t size = b.Resolution[0] * b.Resolution[1] * b.Resolution[2] * this->metadata.ScalarLength *
+                        this->metadata.Components;
+    auto data = std::make_shared<std::vector<uint8_t>>(size);
+    file.seekg(this->dataOffset + frame * this->frameBytes + this->brickOffsets[brick]);
+    file.read(reinterpret_cast<char*>(data->data()), size);
+    if (!file) {
+        file.clear();
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->cacheLock);
+    auto it = this->cache.find(key);
+    if (it != this->cache.end()) {
+        // the other thread was faster
+        this->lru.splice(this->lru.begin(), this->lru, it->second.lru);
+        return it->second.data;
+    }
+    this->lru.push_front(key);
+    this->cache[key] = CacheEntry{data, this->lru.begin()};
+    this->cacheBytes += size;
+
+    // consumers may still hold evicted bricks, which are freed as soon as they release them
+    while ((this->cacheBytes > this->cacheBudget) && (this->lru.size() > 1)) {
+        auto victim = this->cache.find(this->lru.back());
+        this->cacheBytes -= victim->second.data->size();
+        this->cache.erase(victim);
+        this->lru.pop_back();
+    }
+    return data;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::openBrickFile
+ */
+bool megamol::volume::BrickedVolumetricDataSource::openBrickFile() {
+    using megamol::core::utility::log::Log;
+
+    if (this->file.is_open()) {
+        return true;
+    }
+
+    this->brickSize = static_cast<size_t>(this->paramBrickSize.Param<core::param::EnumParam>()->Value());
+    this->buildBrickTable();
+    const size_t comps = this->metadata.Components;
+    const unsigned int frames = this->fileInfo->timeSteps;
+    const size_t tableSize = static_cast<size_t>(frames) * this->bricks.size() * comps;
+    const auto path = this->brickFilePath();
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        this->file.open(path, std::ios::binary);
+        BrickFileHeader header;
+        bool valid = false;
+        if (this->file.is_open()) {
+            this->file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            valid = this->file.good() && (std::memcmp(header.magic, brickFileMagic, sizeof(header.magic)) == 0) &&
+                    (header.version == brickFileVersion) && (header.brickSize == this->brickSize) &&
+                    (header.components == comps) && (header.scalarLength == this->metadata.ScalarLength) &&
+                    (header.frames == frames) && (header.levels == this->levels.size()) &&
+                    (header.resolution[0] == this->metadata.Resolution[0]) &&
+                    (header.resolution[1] == this->metadata.Resolution[1]) &&
+                    (header.resolution[2] == this->metadata.Resolution[2]) &&
+                    (header.fingerprint == this->fingerprint());
+        }
+        if (valid) {
+            this->minValues.resize(tableSize);
+            this->maxValues.resize(tableSize);
+            this->file.read(reinterpret_cast<char*>(this->minValues.data()), tableSize * sizeof(double));
+            this->file.read(reinterpret_cast<char*>(this->maxValues.data()), tableSize * sizeof(double));
+            this->dataOffset = header.dataOffset;
+            valid = this->file.good();
+        }
+        if (valid) {
+            break;
+        }
+
+        this->file.close();
+        if ((attempt > 0) || !this->buildBrickFile(path)) {
+            Log::DefaultLog.WriteError("%hs: no valid brick file %s available.",
+                BrickedVolumetricDataSource::ClassName(), path.generic_u8string().c_str());
+            return false;
+        }
+    }
+
+    // the value range of a frame is the one of its full-resolution bricks
+    const size_t cntLevel0 = this->levels[0].Bricks[0] * this->levels[0].Bricks[1] * this->levels[0].Bricks[2];
+    this->frameMin.assign(frames * comps, std::numeric_limits<double>::max());
+    this->frameMax.assign(frames * comps, std::numeric_limits<double>::lowest());
+    for (unsigned int f = 0; f < frames; ++f) {
+        for (size_t b = 0; b < cntLevel0; ++b) {
+            for (size_t c = 0; c < comps; ++c) {
+                const size_t i = (f * this->bricks.size() + b) * comps + c;
+                this->frameMin[f * comps + c] = std::min(this->frameMin[f * comps + c], this->minValues[i]);
+                this->frameMax[f * comps + c] = std::max(this->frameMax[f * comps + c], this->maxValues[i]);
+            }
+        }
+    }
+
+    if (this->paramPrefetch.Param<core::param::BoolParam>()->Value()) {
+        this->prefetchStop = false;
+        this->prefetchThread = std::thread(&BrickedVolumetricDataSource::prefetchLoop, this);
+    }
+
+    Log::DefaultLog.WriteInfo("%hs: opened brick file %s with %zu levels of %zu^3 bricks.",
+        BrickedVolumetricDataSource::ClassName(), path.generic_u8string().c_str(), this->levels.size(),
+        this->brickSize);
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::openDataSet
+ */
+bool megamol::volume::BrickedVolumetricDataSource::openDataSet() {
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    if (!this->paramFileName.IsDirty() && !this->paramBrickSize.IsDirty() && !this->paramPrefetch.IsDirty()) {
+        return (this->fileInfo != nullptr);
+    }
+    this->paramFileName.ResetDirty();
+    this->paramBrickSize.ResetDirty();
+    this->paramPrefetch.ResetDirty();
+
+    this->stopPrefetching();
+    this->resetCache();
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    ++this->dataHash;
+
+    if (this->fileInfo == nullptr) {
+        this->fileInfo = new DatRawFileInfo();
+    } else {
+        ::datRaw_freeInfo(this->fileInfo);
+    }
+
+    const auto fileName = this->paramFileName.Param<core::param::FilePathParam>()->Value().generic_u8string();
+    if (::datRaw_readHeader(fileName.c_str(), this->fileInfo, nullptr) == 0) {
+        Log::DefaultLog.WriteError("%hs: failed to read and parse dat file %hs.",
+            BrickedVolumetricDataSource::ClassName(), fileName.c_str());
+        SAFE_DELETE(this->fileInfo);
+        return false;
+    }
+    if ((this->fileInfo->gridType != DR_GRID_CARTESIAN) || (this->fileInfo->dimensions != 3)) {
+        Log::DefaultLog.WriteError(
+            "%hs supports three-dimensional cartesian grids only.", BrickedVolumetricDataSource::ClassName());
+        ::datRaw_freeInfo(this->fileInfo);
+        SAFE_DELETE(this->fileInfo);
+        return false;
+    }
+
+    this->metadata.GridType = VolumetricDataCall::GridType::CARTESIAN;
+    this->metadata.Components = this->fileInfo->numComponents;
+    this->metadata.ScalarLength = ::datRaw_getFormatSize(this->fileInfo->dataFormat);
+    this->metadata.NumberOfFrames = this->fileInfo->timeSteps;
+    switch (this->fileInfo->dataFormat) {
+    case DR_FORMAT_CHAR:
+    case DR_FORMAT_SHORT:
+    case DR_FORMAT_INT:
+    case DR_FORMAT_LONG:
+        this->metadata.ScalarType = VolumetricDataCall::ScalarType::SIGNED_INTEGER;
+        break;
+    case DR_FORMAT_UCHAR:
+    case DR_FORMAT_USHORT:
+    case DR_FORMAT_UINT:
+    case DR_FORMAT_ULONG:
+        this->metadata.ScalarType = VolumetricDataCall::ScalarType::UNSIGNED_INTEGER;
+        break;
+    case DR_FORMAT_HALF:
+    case DR_FORMAT_FLOAT:
+    case DR_FORMAT_DOUBLE:
+        this->metadata.ScalarType = VolumetricDataCall::ScalarType::FLOATING_POINT;
+        break;
+    default:
+        this->metadata.ScalarType = VolumetricDataCall::ScalarType::UNKNOWN;
+        break;
+    }
+    for (int a = 0; a < 3; ++a) {
+        this->metadata.Resolution[a] = this->fileInfo->resolution[a];
+        this->metadata.SliceDists[a] = this->fileInfo->sliceDist + a;
+        this->metadata.IsUniform[a] = true;
+        this->metadata.Origin[a] = this->fileInfo->origin[a];
+        this->metadata.Extents[a] =
+            this->fileInfo->sliceDist[a] * static_cast<float>(this->fileInfo->resolution[a] - 1);
+    }
+
+    this->metadataMin.assign(this->metadata.Components, 0.0);
+    this->metadataMax.assign(this->metadata.Components, 0.0);
+    this->metadata.MinValues = this->metadataMin.data();
+    this->metadata.MaxValues = this->metadataMax.data();
+
+    Log::DefaultLog.WriteInfo("%hs: loaded dat file %hs with %zu x %zu x %zu voxels.",
+        BrickedVolumetricDataSource::ClassName(), fileName.c_str(), this->metadata.Resolution[0],
+        this->metadata.Resolution[1], this->metadata.Resolution[2]);
+    return true;
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::prefetchLoop
+ */
+void megamol::volume::BrickedVolumetricDataSource::prefetchLoop() {
+    std::ifstream stream(this->brickFilePath(), std::ios::binary);
+
+    while (true) {
+        std::pair<unsigned int, size_t> next;
+        {
+            std::unique_lock<std::mutex> lock(this->cacheLock);
+            this->prefetchEvent.wait(lock, [this]() { return this->prefetchStop || !this->prefetchQueue.empty(); });
+            if (this->prefetchStop) {
+                break;
+            }
+            next = this->prefetchQueue.front();
+            this->prefetchQueue.pop_front();
+        }
+        this->getBrick(stream, next.first, next.second);
+    }
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::resetCache
+ */
+void megamol::volume::BrickedVolumetricDataSource::resetCache() {
+    std::lock_guard<std::mutex> lock(this->cacheLock);
+    this->cache.clear();
+    this->lru.clear();
+    this->cacheBytes = 0;
+    this->prefetchQueue.clear();
+}
+
+
+/*
+ * megamol::volume::BrickedVolumetricDataSource::stopPrefetching
+ */
+void megamol::volume::BrickedVolumetricDataSource::stopPrefetching() {
+    if (this->prefetchThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(this->cacheLock);
+            this->prefetchStop = true;
+        }
+        this->prefetchEvent.notify_all();
+        this->prefetchThread.join();
+    }
+}
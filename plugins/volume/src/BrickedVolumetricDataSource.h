@@ -0,0 +1,282 @@
+/*
+ * BrickedVolumetricDataSource.h
+ *
+ * Copyright (C) 2024 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "datRaw.h"
+
+#include "geometry_calls/BrickedVolumetricDataCall.h"
+
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+
+namespace megamol::volume {
+
+/**
+ * Provides dat/raw volumes that do not fit into memory as bricks on
+ * several levels of detail.
+ *
+ * On first use, the raw data is streamed slice by slice into a brick file
+ * next to the dat file, which stores the bricks of all levels of all frames
+ * together with their value ranges. Afterwards, bricks are paged in from
+ * the brick file on request and kept in an LRU cache of limited size. A
+ * background thread prefetches the bricks the consumer announced or, if it
+ * did not, the requested bricks of the next frame.
+ */
+class BrickedVolumetricDataSource : public core::Module {
+
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static inline const char* ClassName() {
+        return "BrickedVolumetricDataSource";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static inline const char* Description() {
+        return "Out-of-core data source providing bricks of dat/raw-encoded volumetric data.";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static inline bool IsAvailable() {
+        return true;
+    }
+
+    /**
+     * Initialises a new instance.
+     */
+    BrickedVolumetricDataSource();
+
+    /**
+     * Finalises an instance.
+     */
+    ~BrickedVolumetricDataSource() override;
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool create() override;
+
+    /**
+     * Implementation of 'Release'.
+     */
+    void release() override;
+
+    /**
+     * Delivers the voxels of the requested bricks.
+     *
+     * @param call The calling call.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool onGetBricks(core::Call& call);
+
+    /**
+     * Delivers the metadata and the brick table of the requested frame.
+     *
+     * @param call The calling call.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool onGetData(core::Call& call);
+
+    /**
+     * Delivers the data extents.
+     *
+     * @param call The calling call.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool onGetExtents(core::Call& call);
+
+private:
+    /** Identifies a brick of a frame in the cache. */
+    typedef uint64_t BrickKey;
+
+    /** Typedef for the brick table. */
+    typedef geocalls::BrickedVolumetricDataCall BrickedCall;
+
+    /** A cached brick and its position in the LRU list. */
+    struct CacheEntry {
+        BrickedCall::BrickData data;
+        std::list<BrickKey>::iterator lru;
+    };
+
+    /**
+     * Builds the brick file from the raw data.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool buildBrickFile(const std::filesystem::path& path);
+
+    /**
+     * Builds the brick file for scalars of type T.
+     */
+    template<class T>
+    bool buildBrickFile(const std::filesystem::path& path);
+
+    /**
+     * Answers the location of the brick file of the current data set.
+     */
+    std::filesystem::path brickFilePath() const;
+
+    /**
+     * Computes the levels of detail and the brick table for the current
+     * resolution and brick size.
+     */
+    void buildBrickTable();
+
+    /**
+     * Answers a fingerprint of the raw files, which invalidates brick files
+     * of modified data sets.
+     */
+    uint64_t fingerprint() const;
+
+    /**
+     * Answers the brick from the cache or loads it from the brick file.
+     *
+     * @param file  The brick file to read from if the brick is not cached.
+     * @param frame The frame.
+     * @param brick The index of the brick.
+     *
+     * @return The voxels or nullptr if reading failed.
+     */
+    BrickedCall::BrickData getBrick(std::ifstream& file, unsigned int frame, size_t brick);
+
+    /**
+     * Makes sure the brick file is valid and its table is loaded, building
+     * the file if necessary.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool openBrickFile();
+
+    /**
+     * Loads the data set named by 'paramFileName' if it changed.
+     *
+     * @return 'true' if a data set is available, 'false' otherwise.
+     */
+    bool openDataSet();
+
+    /** Body of the prefetching thread. */
+    void prefetchLoop();
+
+    /** Removes all bricks from the cache and cancels pending prefetches. */
+    void resetCache();
+
+    /** Stops the prefetching thread. */
+    void stopPrefetching();
+
+    /** The edge length of the bricks of the loaded brick file. */
+    size_t brickSize;
+
+    /** The brick table of all levels. */
+    std::vector<BrickedCall::Brick> bricks;
+
+    /** The offsets of the bricks within the voxels of a frame. */
+    std::vector<uint64_t> brickOffsets;
+
+    /** The LRU cache of bricks. */
+    std::unordered_map<BrickKey, CacheEntry> cache;
+
+    /** The maximum number of bytes in 'cache'. */
+    size_t cacheBudget;
+
+    /** The number of bytes in 'cache'. */
+    size_t cacheBytes;
+
+    /** Guards 'cache', 'lru', 'cacheBudget', 'cacheBytes' and 'prefetchQueue'. */
+    std::mutex cacheLock;
+
+    /** Hash for the data set. */
+    size_t dataHash;
+
+    /** The offset of the voxels of the first frame in the brick file. */
+    uint64_t dataOffset;
+
+    /** The content of the dat file. */
+    DatRawFileInfo* fileInfo;
+
+    /** The stream the calling thread reads bricks from. */
+    std::ifstream file;
+
+    /** The size of all bricks of one frame in bytes. */
+    uint64_t frameBytes;
+
+    /** The value ranges of all frames, per component. */
+    std::vector<double> frameMin, frameMax;
+
+    /** The levels of detail. */
+    std::vector<BrickedCall::Level> levels;
+
+    /** The keys of the cached bricks, most recently used first. */
+    std::list<BrickKey> lru;
+
+    /** The metadata of the current frame. */
+    geocalls::VolumetricDataCall::Metadata metadata;
+
+    /** The value ranges of the current frame that 'metadata' points to. */
+    std::vector<double> metadataMin, metadataMax;
+
+    /** The value ranges of all bricks of all frames, per component. */
+    std::vector<double> minValues, maxValues;
+
+    /** The edge length of the bricks of newly built brick files. */
+    core::param::ParamSlot paramBrickSize;
+
+    /** The maximum size of the brick cache in MB. */
+    core::param::ParamSlot paramCacheSize;
+
+    /** The path to the dat file. */
+    core::param::ParamSlot paramFileName;
+
+    /** Enables prefetching of bricks. */
+    core::param::ParamSlot paramPrefetch;
+
+    /** Wakes the prefetching thread. */
+    std::condition_variable prefetchEvent;
+
+    /** Bricks to be prefetched, in order of priority. */
+    std::deque<std::pair<unsigned int, size_t>> prefetchQueue;
+
+    /** The prefetching thread. */
+    std::thread prefetchThread;
+
+    /** Asks the prefetching thread to exit. */
+    bool prefetchStop;
+
+    /** The slot that requests the data. */
+    core::CalleeSlot slotGetData;
+};
+
+} // namespace megamol::volume
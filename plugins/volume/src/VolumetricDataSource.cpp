@@ -7,6 +7,8 @@
 
 #include "VolumetricDataSource.h"
 
+#include <climits>
+
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
@@ -36,6 +38,7 @@
 megamol::volume::VolumetricDataSource::VolumetricDataSource()
         : Base()
         , dataHash(-234895)
+        , lastFrameID(UINT_MAX)
         , fileInfo(nullptr)
         , loaderThread(VolumetricDataSource::loadAsync)
         , paramAsyncSleep("AsyncSleep", "The time in milliseconds that the loader sleeps between two frames.")
@@ -426,7 +429,7 @@ bool megamol::volume::VolumetricDataSource::onGetData(core::Call& call) {
 
     VolumetricDataCall& c = dynamic_cast<VolumetricDataCall&>(call);
 
-    if (c.DataHash() != this->dataHash) {
+    if ((c.DataHash() != this->dataHash) || (c.FrameID() != this->lastFrameID)) {
         try {
             /* Evaluate parameter changes. */
             bool isAsync = this->paramLoadAsync.Param<BoolParam>()->Value();
@@ -446,6 +449,7 @@ bool megamol::volume::VolumetricDataSource::onGetData(core::Call& call) {
 
             /* Do the actual work. */
             c.SetDataHash(this->dataHash);
+            this->lastFrameID = c.FrameID();
 
             /* Sanity check. */
             if (this->fileInfo == nullptr) {
@@ -341,6 +341,9 @@ private:
     /** Hash for the data set. */
     unsigned int dataHash;
 
+    /** The frame last requested via onGetData, which is skipped if asked for again with the current hash. */
+    unsigned int lastFrameID;
+
     /** Wakes the loader thread after there was nothing to do. */
     vislib::sys::Event evtStartLoading;
 